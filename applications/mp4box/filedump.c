@@ -4712,7 +4712,6 @@ GF_Err rip_mpd(const char *mpd_src, const char *output_dir)
 	GF_DownloadSession *sess;
 	u32 i, connect_time, reply_time, download_time, req_hdr_size, rsp_hdr_size;
 	GF_Err e;
-	GF_DOMParser *mpd_parser=NULL;
 	GF_MPD *mpd=NULL;
 	GF_MPD_Period *period;
 	GF_MPD_AdaptationSet *as;
@@ -4761,18 +4760,8 @@ GF_Err rip_mpd(const char *mpd_src, const char *output_dir)
 	GF_LOG(GF_LOG_DEBUG, GF_LOG_APP, ("GET Header size %d - Reply header size %d\n", req_hdr_size, rsp_hdr_size));
 	GF_LOG(GF_LOG_DEBUG, GF_LOG_APP, ("GET time: Connect Time %d - Reply Time %d - Download Time %d\n", connect_time, reply_time, download_time));
 
-	mpd_parser = gf_xml_dom_new();
-	e = gf_xml_dom_parse(mpd_parser, szName, NULL, NULL);
-
-	if (e != GF_OK) {
-		gf_xml_dom_del(mpd_parser);
-		GF_LOG(GF_LOG_ERROR, GF_LOG_APP, ("Error parsing MPD %s : %s\n", mpd_src, gf_error_to_string(e)));
-		return e;
-	}
 	mpd = gf_mpd_new();
-	e = gf_mpd_init_from_dom(gf_xml_dom_get_root(mpd_parser), mpd, mpd_src);
-	gf_xml_dom_del(mpd_parser);
-	mpd_parser=NULL;
+	e = gf_mpd_init_from_file(szName, mpd, mpd_src);
 	if (e) {
 		GF_LOG(GF_LOG_ERROR, GF_LOG_APP, ("Error initializing MPD %s : %s\n", mpd_src, gf_error_to_string(e)));
 		goto err_exit;
@@ -136,6 +136,7 @@ LOCAL_SRC_FILES := \
 	../../../../src/evg/raster_565.c \
 	../../../../src/evg/raster_argb.c\
 	../../../../src/evg/raster_rgb.c \
+	../../../../src/evg/raster_simd.c \
 	../../../../src/evg/raster_yuv.c \
 	../../../../src/evg/stencil.c \
 	../../../../src/evg/surface.c \
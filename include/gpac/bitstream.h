@@ -161,6 +161,16 @@ Reads a large integer coded on a number of bit bigger than 32.
  */
 u64 gf_bs_read_long_int(GF_BitStream *bs, u32 nBits);
 /*!
+\brief exp-golomb code reading
+
+Reads an unsigned exp-golomb code using the memory fast path. If this is not possible (file bitstream, near end of buffer or broken code), the bitstream is left untouched and the caller must use the regular bit reading functions.
+\param bs the target bitstream
+\param val set to the decoded value
+\param nb_bits set to the number of bits of the code
+\return GF_TRUE if the code was read, GF_FALSE otherwise
+ */
+Bool gf_bs_read_ue_fast(GF_BitStream *bs, u32 *val, u32 *nb_bits);
+/*!
 \brief float reading
 
 Reads a float coded as IEEE 32 bit format.
@@ -520,6 +520,19 @@ GF_Err gf_dash_group_get_next_segment_location(GF_DashClient *dash, u32 group_id
 */
 GF_Err gf_dash_group_next_seg_info(GF_DashClient *dash, u32 group_idx, u32 dependent_representation_index, const char **seg_name, u32 *seg_number, GF_Fraction64 *seg_time, u32 *seg_dur_ms, const char **init_segment);
 
+/*! gets the location of an upcoming media segment in the active representation of the group, without modifying the group state. This is used to prefetch segments ahead of the current one
+\param dash the target dash client
+\param group_idx the 0-based index of the target group
+\param offset 0-based position of the segment after the last segment queued for download
+\param url set to the URL of the segment, to be freed by the caller
+\param start_range set to the start byte offset in the segment (optional, may be NULL)
+\param end_range set to the end byte offset in the segment (optional, may be NULL)
+\param seg_dur_ms set to the segment duration in ms (optional, may be NULL)
+\param bandwidth set to the bandwidth in bits per second of the representation (optional, may be NULL)
+\return GF_EOS if the segment is not known or not yet available, GF_BUFFER_TOO_SMALL if the segment would exceed the buffer or could not be downloaded in time at the measured rate (only checked when the consumer buffer holds at least one segment), GF_NOT_SUPPORTED if the group state does not allow prefetching (reverse playback, local files, scalable or low latency HLS groups, pending switch) or error if any
+*/
+GF_Err gf_dash_group_get_upcoming_segment(GF_DashClient *dash, u32 group_idx, u32 offset, char **url, u64 *start_range, u64 *end_range, u32 *seg_dur_ms, u32 *bandwidth);
+
 /*! checks if loop was detected in playback. This is mostly used for broadcast (eMBMS, ROUTE) based on pcap replay.
 \param dash the target dash client
 \param group_idx the 0-based index of the target group
@@ -522,6 +522,28 @@ Checks if last session fetch has been skiped due to rate limitation
  */
 Bool gf_dm_sess_is_regulated(GF_DownloadSession *sess);
 
+/*!
+\brief Checks if input data is buffered
+
+Checks if data received on the session socket is buffered in the session or in the TLS layer, in which case the socket may not be signaled as readable
+\param sess the download session object
+\return GF_TRUE if input data is buffered
+ */
+Bool gf_dm_sess_has_buffered_input(GF_DownloadSession *sess);
+
+/*!
+\brief sends a file range on a server session
+
+Sends a byte range of a file on the session socket without copying it through user space. This is only available for plain TCP HTTP/1.1 sessions; the file position is not modified.
+\param sess the download session object
+\param file the file to send from
+\param offset the offset in bytes of the first byte to send
+\param size the number of bytes to send
+\param written set to the number of bytes sent, which may be less than size in non-blocking mode or at end of file
+\return error if any, GF_NOT_SUPPORTED for TLS or HTTP/2 sessions or if zero-copy send is not available for this file or platform, in which case the data must be sent using \ref gf_dm_sess_send
+ */
+GF_Err gf_dm_sess_send_file(GF_DownloadSession *sess, FILE *file, u64 offset, u32 size, u32 *written);
+
 /*!
 \brief sets download manager max rate per session
 
@@ -565,6 +587,20 @@ Get header sizes and times stats for the session
  */
 GF_Err gf_dm_sess_get_header_sizes_and_times(GF_DownloadSession *sess, u32 *req_hdr_size, u32 *rsp_hdr_size, u32 *connect_time, u32 *reply_time, u32 *download_time);
 
+/*!
+\brief Get connection stats for the download manager
+
+Get connection stats for the download manager. HTTP/1.1 connections of destroyed sessions are kept alive (see -dm-pool) and reused by new sessions to the same server, port and scheme.
+\param dm the download manager object
+\param nb_connects number of connections established. May be NULL.
+\param nb_reused number of times an idle connection was reused by a new session. May be NULL.
+\param nb_idle number of idle connections currently kept. May be NULL.
+\param nb_evicted number of idle connections closed because of timeout, pool size or remote close. May be NULL.
+\param connect_time cumulated connection time in micro seconds of all established connections. May be NULL.
+\return error code if any
+ */
+GF_Err gf_dm_get_connection_stats(GF_DownloadManager *dm, u32 *nb_connects, u32 *nb_reused, u32 *nb_idle, u32 *nb_evicted, u64 *connect_time);
+
 /*!
 \brief Forces session to use memory storage
 
@@ -200,7 +200,9 @@ typedef enum
 	/*! In this mode, the scheduler uses locks for packet and property queues even if single-threaded (test mode) */
 	GF_FS_SCHEDULER_LOCK_FORCE,
 	/*! In this mode, the scheduler uses direct dispatch and no threads, trying to nest task calls within task calls */
-	GF_FS_SCHEDULER_DIRECT
+	GF_FS_SCHEDULER_DIRECT,
+	/*! In this mode, the scheduler does not use locks for packet and property queues, and each thread has its own task list. Filter tasks are posted to the task list of the thread which last processed the filter, and idle threads steal tasks from other threads. Defaults to lock-free if no threads are used */
+	GF_FS_SCHEDULER_WORK_STEAL
 } GF_FilterSchedulerType;
 
 /*! Filter session flags */
@@ -4452,6 +4454,23 @@ The packet has by default no DTS, no CTS, no duration framing set to full frame
 */
 GF_FilterPacket *gf_filter_pck_new_shared(GF_FilterPid *PID, const u8 *data, u32 data_size, gf_fsess_packet_destructor destruct);
 
+/*! Same as \ref gf_filter_pck_new_shared with a context for the packet destructor.
+The context is not a packet property: it is never copied to other packets and cannot be modified by other filters.
+\param PID the target output PID
+\param data the data block to dispatch
+\param data_size the size of the data block to dispatch
+\param destruct the callback function used to destroy the packet when no longer used - may be NULL
+\param destruct_ctx the context of the destructor, retrieved using \ref gf_filter_pck_get_destructor_ctx
+\return new packet or NULL if allocation error or not an output PID
+*/
+GF_FilterPacket *gf_filter_pck_new_shared_ctx(GF_FilterPid *PID, const u8 *data, u32 data_size, gf_fsess_packet_destructor destruct, void *destruct_ctx);
+
+/*! Gets the destructor context of a packet created with \ref gf_filter_pck_new_shared_ctx. This is typically called from the packet destructor, and may be called after the filter creating the packet is finalized
+\param pck the target packet
+\return the destructor context, or NULL if none or if the packet is an input packet
+*/
+void *gf_filter_pck_get_destructor_ctx(GF_FilterPacket *pck);
+
 /*! Allocates a new packet on the output PID referencing data of some input packet.
 The packet has by default no DTS, no CTS, no duration framing set to full frame (start=end=1) and all other flags set to 0 (including SAP type).
 \param PID the target output PID
@@ -611,6 +611,7 @@ enum
 #define GF_ISOM_BS_COOKIE_CLONE_TRACK	(1<<3)
 #define GF_ISOM_BS_COOKIE_IN_UDTA		(1<<4)
 #define GF_ISOM_BS_COOKIE_NO_DECOMP		(1<<5)
+#define GF_ISOM_BS_COOKIE_LAZY_TABLES	(1<<6)
 
 
 #ifndef GPAC_DISABLE_ISOM
@@ -1001,6 +1002,8 @@ typedef struct
 
 	u8 *(*sample_alloc_cbk)(u32 size, void *cbk);
 	void *sample_alloc_udta;
+	//if set, samples are returned as pointers in the file mapping whenever possible
+	Bool zero_copy;
 
 #ifndef GPAC_DISABLE_ISOM_WRITE
 	u64 first_dts_chunk;
@@ -1195,6 +1198,40 @@ typedef struct
 	u32 sampleDelta;
 } GF_SttsEntry;
 
+/*sample table payload (stts, ctts, stsz, stco, co64) left in the file at parse time, entries being fetched on demand by windows*/
+typedef struct
+{
+	//movie owning the table, NULL until the moov is fully parsed
+	GF_ISOFile *mov;
+	//bitstream the table was parsed from, only used before the table is bound to its movie
+	GF_BitStream *bs;
+	//position and remaining size of the box payload, used for full loading
+	u64 box_pos, box_size;
+	//position of the first entry
+	u64 entries_pos;
+	//first entry and number of entries in window
+	u32 first, count;
+	//window of decoded entries
+	u8 *buf;
+	//set once table statistics (max size, max delta, ...) have been computed
+	Bool stats_done;
+} GF_LazyTable;
+
+/*run-length index of stts/ctts/stsc entries for random access, built lazily in read mode*/
+typedef struct
+{
+	//number of indexed entries
+	u32 nb_entries, alloc_entries;
+	//max number of entries allowed by the memory budget
+	u32 max_entries;
+	//set if the table exceeds the budget
+	Bool disabled;
+	//first sample number of each entry
+	u32 *first_sample;
+	//first DTS of each entry, stts only
+	u64 *first_dts;
+} GF_SampleTableIndex;
+
 typedef struct
 {
 	GF_ISOM_FULL_BOX
@@ -1210,6 +1247,8 @@ typedef struct
 	u32 r_FirstSampleInEntry;
 	u32 r_currentEntryIndex;
 	u64 r_CurrentDTS;
+	GF_SampleTableIndex *r_index;
+	GF_LazyTable *lazy;
 	//when removing samples, this is the DTS of first sample after all removed samples
 	u64 cumulated_start_dts;
 
@@ -1239,6 +1278,8 @@ typedef struct
 	/*Cache for read*/
 	u32 r_currentEntryIndex;
 	u32 r_FirstSampleInEntry;
+	GF_SampleTableIndex *r_index;
+	GF_LazyTable *lazy;
 
 	s32 max_cts_delta;
 	s32 min_neg_cts_offset;
@@ -1679,6 +1720,8 @@ static const u8 GF_ISOM_IPOD_EXT[][16] = { { 0x6B, 0x68, 0x40, 0xF2, 0x5F, 0x24,
 
 Bool gf_isom_is_nalu_based_entry(GF_MediaBox *mdia, GF_SampleEntryBox *_entry);
 GF_Err gf_isom_nalu_sample_rewrite(GF_MediaBox *mdia, GF_ISOSample *sample, u32 sampleNumber, GF_MPEGVisualSampleEntryBox *entry);
+/*returns GF_TRUE if gf_isom_nalu_sample_rewrite will never modify the sample payload for this entry*/
+Bool gf_isom_nalu_sample_rewrite_is_passthrough(GF_MediaBox *mdia, GF_MPEGVisualSampleEntryBox *entry);
 
 typedef struct __full_video_sample_entry GF_GenericVisualSampleEntryBox;
 
@@ -1980,6 +2023,7 @@ typedef struct
 	u32 max_size;
 	u64 total_size;
 	u32 total_samples;
+	GF_LazyTable *lazy;
 } GF_SampleSizeBox;
 
 typedef struct
@@ -1988,6 +2032,7 @@ typedef struct
 	u32 nb_entries;
 	u32 alloc_size;
 	u32 *offsets;
+	GF_LazyTable *lazy;
 } GF_ChunkOffsetBox;
 
 typedef struct
@@ -1996,6 +2041,7 @@ typedef struct
 	u32 nb_entries;
 	u32 alloc_size;
 	u64 *offsets;
+	GF_LazyTable *lazy;
 } GF_ChunkLargeOffsetBox;
 
 typedef struct
@@ -2019,6 +2065,7 @@ typedef struct
 	u32 firstSampleInCurrentChunk;
 	u32 currentChunk;
 	u32 ghostNumber;
+	GF_SampleTableIndex *r_index;
 
 	u32 w_lastSampleNumber;
 	u32 w_lastChunkNumber;
@@ -2221,6 +2268,8 @@ typedef struct
 
 	u32 r_last_chunk_num, r_last_sample_num, r_last_offset_in_chunk;
 	u8 patch_piff_psec;
+	//set once random access indexing has been set up for this table
+	Bool r_index_init;
 } GF_SampleTableBox;
 
 GF_Err stbl_AppendTrafMap(GF_ISOFile *mov, GF_SampleTableBox *stbl, Bool is_seg_start, u64 seg_start_offset, u64 frag_start_offset, u64 tfdt, u8 *moof_template, u32 moof_template_size, u64 sidx_start, u64 sidx_end, u32 nb_pack_samples);
@@ -4090,6 +4139,8 @@ typedef struct
 
 /*regular file IO*/
 #define GF_ISOM_DATA_FILE         0x01
+/*File Mapping object, read-only mode on complete files (no download)*/
+#define GF_ISOM_DATA_FILE_MAPPING 0x02
 /*External file object. Needs implementation*/
 #define GF_ISOM_DATA_FILE_EXTERN  0x03
 /*regular memory IO*/
@@ -4163,6 +4214,11 @@ GF_DataMap *gf_isom_fdm_new(const char *sPath, u8 mode);
 void gf_isom_fdm_del(GF_FileDataMap *ptr);
 u32 gf_isom_fdm_get_data(GF_FileDataMap *ptr, u8 *buffer, u32 bufferLength, u64 fileOffset, GF_BlobRangeStatus *range_status);
 
+/*File mapping data map, returns NULL if file mapping is not supported*/
+GF_DataMap *gf_isom_fmo_new(const char *sPath, u8 mode);
+void gf_isom_fmo_del(GF_FileMappingDataMap *ptr);
+u32 gf_isom_fmo_get_data(GF_FileMappingDataMap *ptr, u8 *buffer, u32 bufferLength, u64 fileOffset, GF_BlobRangeStatus *range_status);
+
 #ifndef GPAC_DISABLE_ISOM_WRITE
 GF_DataMap *gf_isom_fdm_new_temp(const char *sTempPath);
 #endif
@@ -4267,6 +4323,8 @@ struct __tag_isom {
 	u64 current_top_box_start;
 
 	Bool signal_frag_bounds;
+	//sample tables are parsed on demand
+	Bool lazy_tables;
 	Bool sample_groups_in_traf;
 	u32 FragmentsFlags;
 
@@ -4424,6 +4482,29 @@ GF_Err stbl_GetSampleShadow(GF_ShadowSyncBox *stsh, u32 *sampleNumber, u32 *sync
 GF_Err stbl_GetPaddingBits(GF_PaddingBitsBox *padb, u32 SampleNumber, u8 *PadBits);
 GF_Err stbl_GetSampleDepType(GF_SampleDependencyTypeBox *stbl, u32 SampleNumber, u32 *isLeading, u32 *dependsOn, u32 *dependedOn, u32 *redundant);
 
+/*sets up lazy random access indexing of stts/ctts/stsc - only valid for files opened in read mode, where tables are only appended to*/
+void stbl_index_setup(GF_SampleTableBox *stbl);
+/*discards indexed entries, to call whenever existing table entries are modified or removed in read mode*/
+void stbl_index_reset(GF_SampleTableBox *stbl);
+/*destroys a table index*/
+void stbl_index_del(GF_SampleTableIndex *idx);
+
+/*creates a lazy table for a box payload if enabled on the bitstream, and skips the entries - returns NULL if the table shall be parsed*/
+GF_LazyTable *gf_isom_lazy_table_new(GF_Box *s, GF_BitStream *bs, u64 box_pos, u32 nb_entries, u32 entry_size);
+void gf_isom_lazy_table_del(GF_LazyTable *lt);
+/*fully loads the entries of a lazy stts, ctts, stsz, stco or co64 box - no-op for other boxes*/
+GF_Err gf_isom_box_lazy_load(GF_Box *s);
+/*binds the lazy tables of the movie once parsed, or loads them if the movie is fragmented*/
+GF_Err gf_isom_lazy_tables_setup(GF_ISOFile *mov);
+/*computes max size, max delta and co of lazy tables, scanning the file*/
+void stbl_lazy_stats(GF_SampleTableBox *stbl);
+/*safety check on sample tables: gets info for the last sample, returns an error if the tables are invalid*/
+GF_Err stbl_check_last_sample(GF_SampleTableBox *stbl);
+/*get entries from stts/ctts and chunk offsets, fetching them from file for lazy tables*/
+GF_SttsEntry *stts_get_entry(GF_TimeToSampleBox *stts, u32 idx);
+GF_DttsEntry *ctts_get_entry(GF_CompositionOffsetBox *ctts, u32 idx);
+GF_Err stbl_GetChunkOffset(GF_SampleTableBox *stbl, u32 chunkNumber, u64 *offset);
+
 
 /*unpack sample2chunk and chunk offset so that we have 1 sample per chunk (edition mode only)*/
 GF_Err stbl_UnpackOffsets(GF_SampleTableBox *stbl);
@@ -598,6 +598,8 @@ typedef struct
 	u32 duration;
 	/*! read API only - set to GF_TRUE if sample data is corrupted*/
 	u32 corrupted;
+	/*! read API only - set to GF_TRUE if sample data points to the file mapping, see \ref gf_isom_set_zero_copy. The data shall not be modified nor freed, and is only valid until the file is closed*/
+	u32 mapped;
 } GF_ISOSample;
 
 
@@ -798,6 +800,21 @@ If the movie is successfully loaded (isom_file non-NULL), BytesMissing is zero
 */
 GF_Err gf_isom_open_progressive_ex(const char *fileName, u64 start_range, u64 end_range, Bool enable_frag_templates, GF_ISOFile **isom_file, u64 *BytesMissing, u32 *topBoxType);
 
+/*! same as  \ref gf_isom_open_progressive but with lazy parsing of sample tables
+
+Large time to sample, composition offset, sample size and chunk offset tables are not loaded when parsing the movie box; their entries are read from the file by windows when samples are accessed. This reduces opening time and memory usage for long movies. Tables are fully loaded if the movie is fragmented, or when the movie is written or dumped.
+Only local files are parsed in lazy mode, other resources are opened as with \ref gf_isom_open_progressive.
+
+\param fileName the name of the local file or cache to open
+\param start_range only loads starting from indicated byte range
+\param end_range loading stops at indicated byte range
+\param enable_frag_templates loads fragment and segment boundaries in an internal table
+\param isom_file pointer set to the opened file if success
+\param BytesMissing is set to the predicted number of bytes missing for the file to be loaded
+\return error if any
+*/
+GF_Err gf_isom_open_progressive_lazy(const char *fileName, u64 start_range, u64 end_range, Bool enable_frag_templates, GF_ISOFile **isom_file, u64 *BytesMissing);
+
 /*! retrieves number of bytes missing.
 if requesting a sample fails with error GF_ISOM_INCOMPLETE_FILE, use this function
 to get the number of bytes missing to retrieve the sample
@@ -1803,6 +1820,20 @@ Bool gf_isom_is_external_track(GF_ISOFile *isom_file, u32 trackNumber, GF_ISOTra
 */
 GF_Err gf_isom_switch_source(GF_ISOFile *isom_file, const char *url);
 
+/*! switches the movie data map to a read-only memory mapping of the source file. This is only possible for complete local files opened in read mode
+\param isom_file the target ISO file
+\return error if any, GF_NOT_SUPPORTED if file mapping cannot be used for this file
+*/
+GF_Err gf_isom_enable_file_mapping(GF_ISOFile *isom_file);
+
+/*! enables zero-copy sample fetching for a track. When enabled and the file uses a memory mapping (see \ref gf_isom_enable_file_mapping), samples which do not need any rewriting (padding, NAL unit or text rewrite, ...) are returned with their data pointing to the file mapping rather than copied, and their mapped flag set
+\param isom_file the target ISO file
+\param trackNumber the target track
+\param enable if GF_TRUE, enables zero-copy mode
+\return error if any
+*/
+GF_Err gf_isom_set_zero_copy(GF_ISOFile *isom_file, u32 trackNumber, Bool enable);
+
 #ifndef GPAC_DISABLE_ISOM_DUMP
 
 /*! dumps file structures into XML trace file
@@ -151,6 +151,8 @@ typedef struct
 {
 	/*! list of entries*/
 	GF_List *entries;
+	/*! internal, serialized S elements kept across live MPD updates*/
+	void *print_cache;
 } GF_MPD_SegmentTimeline;
 
 /*! Byte range info*/
@@ -669,6 +671,8 @@ typedef struct {
 	char *m3u8_var_name;
 	/*! temp file for m3u8 generation*/
 	FILE *m3u8_var_file;
+	/*! internal, serialized segment entries of the variant playlist kept across live updates*/
+	void *m3u8_cache;
 
 	/*! for m3u8: 0: not encrypted, 1: full segment, 2: CENC*/
 	u8 crypto_type;
@@ -909,6 +913,10 @@ typedef struct {
 	GF_List *base_URLs;
 	/*! list of strings */
 	GF_List *locations;
+	/*! MPD patch location, NULL if none*/
+	char *patch_location;
+	/*! validity of the patch location in seconds after the MPD is fetched, 0 if unlimited*/
+	u32 patch_ttl;
 	/*! list of Metrics */
 	GF_List *metrics;
 	/*! list of GF_MPD_Period */
@@ -916,6 +924,8 @@ typedef struct {
 
 	/*! set during parsing, to set during authoring, won't be freed by GPAC*/
 	const char *xml_namespace;
+	/*! segment URLs and timeline entries pending during SAX loading - GPAC internal*/
+	GF_List *sax_segments;
 
 	/*! UTC timing desc if any */
 	GF_List *utc_timings;
@@ -977,6 +987,21 @@ typedef struct {
 \return error if any
 */
 GF_Err gf_mpd_init_from_dom(GF_XMLNode *root, GF_MPD *mpd, const char *base_url);
+/*! parses an MPD file without building its full DOM: segment URLs and segment timeline entries are parsed while loading the document and never stored as XML nodes, which keeps memory usage low for manifests with large segment lists
+\param file name of the MPD file to load
+\param mpd MPD structure to fill
+\param base_url base URL of the MPD document
+\return error if any, GF_URL_ERROR if the file cannot be read or is not a well-formed XML document
+*/
+GF_Err gf_mpd_init_from_file(const char *file, GF_MPD *mpd, const char *base_url);
+/*! applies an MPD patch document to an MPD. The patch shall apply to the MPD (matching mpdId and originalPublishTime), and the MPD publishTime is set to the patch publishTime.
+Operations are applied on the MPD structure, without reparsing the MPD. Only the restricted XPath selectors used by MPD patches are supported (absolute element paths with attribute or position predicates, optionally ending with an attribute), and only on elements updated in live sessions: MPD attributes, Location, PatchLocation, Period elements and their \@start and \@duration, SegmentTimeline and S elements and attributes of SegmentTemplate or SegmentList at Period, AdaptationSet or Representation level. Representations can only be selected by \@id. Other operations return GF_NOT_SUPPORTED
+\param mpd MPD structure to update
+\param patch root of the patch DOM
+\param removed_periods if not NULL, periods removed or replaced by the patch are moved to this list instead of being destroyed, and shall be destroyed by the caller using \ref gf_mpd_period_free
+\return error if any, GF_EOS if the patch has no operation. Operations preceding a failed operation are applied
+*/
+GF_Err gf_mpd_apply_patch(GF_MPD *mpd, GF_XMLNode *patch, GF_List *removed_periods);
 /*! parses an MPD Period element (and subtree) from DOM
 \param root root of DOM parsing result
 \param mpd MPD structure to fill
@@ -1291,6 +1316,10 @@ void gf_mpd_representation_free(void *_item);
 /*! creates a new GF_MPD_SegmentTimeline
 \return the new segment timeline*/
 GF_MPD_SegmentTimeline *gf_mpd_segmentimeline_new();
+/*! deletes a GF_MPD_SegmentTimeline structure (type-casted to void *)
+\param _item the GF_MPD_SegmentTimeline to free
+*/
+void gf_mpd_segment_timeline_free(void *_item);
 
 /*! DASHer cues information*/
 typedef struct
@@ -697,6 +697,14 @@ typedef struct
 	GF_M2TS_MetadataPointerDescriptor *metadata_pointer_descriptor;
 	/*! continuity counter check for pure PCR PIDs*/
 	s16 pcr_cc;
+	/*! set if packets of this program are queued until \ref gf_m2ts_process_program is called, see split_programs in \ref GF_M2TS_Demuxer*/
+	Bool split;
+	/*! queued packets - private to the demuxer*/
+	struct __m2ts_queued_pck *pending;
+	/*! number of queued packets*/
+	u32 nb_pending;
+	/*! number of allocated queued packets - private to the demuxer*/
+	u32 alloc_pending;
 
 	void *user;
 } GF_M2TS_Program;
@@ -1185,6 +1193,8 @@ struct tag_m2ts_demux
 
 	/*! raw demux mode */
 	GF_M2TSRawMode raw_mode;
+	/*! if set, packets of programs made of PES streams only are queued per program by \ref gf_m2ts_process_data rather than processed*/
+	Bool split_programs;
 };
 
 //! @endcond
@@ -1227,6 +1237,15 @@ GF_Err gf_m2ts_set_pes_framing(GF_M2TS_PES *pes, GF_M2TSPesFraming mode);
 */
 GF_Err gf_m2ts_process_data(GF_M2TS_Demuxer *demux, u8 *data, u32 data_size);
 
+/*! processes packets queued for a program when split_programs is set on the demultiplexer. PES reassembly and framing, PCR and adaptation field parsing of the program are done in this call, PAT/PMT and other sections are always processed by \ref gf_m2ts_process_data.
+
+Different programs can be processed at the same time from different threads, in which case the demultiplexer event callback must be thread-safe for events of different programs. This function must not be called concurrently with any other function of the demultiplexer.
+\param demux the target MPEG-2 TS demultiplexer
+\param program the target MPEG-2 TS program
+\return error if any
+*/
+GF_Err gf_m2ts_process_program(GF_M2TS_Demuxer *demux, GF_M2TS_Program *program);
+
 /*! initializes DSM-CC object carousel reception
 \param demux the target MPEG-2 TS demultiplexer
 */
@@ -1533,6 +1552,10 @@ typedef struct __m2ts_section {
 	u8 *data;
 	/*! section size*/
 	u32 length;
+	/*! TS packets carrying the section, formatted at first send - only the continuity counter is set when sending*/
+	u8 *packets;
+	/*! number of TS packets carrying the section*/
+	u32 nb_packets;
 } GF_M2TS_Mux_Section;
 
 /*! MPEG-2 TS muxer table*/
@@ -1883,6 +1906,8 @@ struct __m2ts_mux {
 	u64 last_pts;
 	/*! last PID (used when dashing to build sidx)*/
 	u32 last_pid;
+	/*! if set, packets are written in this buffer rather than in dst_pck*/
+	u8 *pck_buffer;
 };
 
 /*! default refresh rate for PSI data*/
@@ -1984,6 +2009,12 @@ typedef enum
 \return packet produced or NULL if error or idle
 */
 const u8 *gf_m2ts_mux_process(GF_M2TS_Mux *muxer, GF_M2TSMuxState *status, u32 *usec_till_next);
+
+/*! sets the buffer in which the next packets are produced, avoiding a copy of each packet by the caller
+\param muxer the target MPEG-2 TS multiplexer
+\param buffer buffer of at least 188 bytes receiving the next packet, or NULL to use the multiplexer internal buffer
+*/
+void gf_m2ts_mux_set_packet_buffer(GF_M2TS_Mux *muxer, u8 *buffer);
 /*! gets the system clock of the multiplexer (time elapsed since start)
 \param muxer the target MPEG-2 TS multiplexer
 \return system clock of the multiplexer in milliseconds
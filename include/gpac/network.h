@@ -503,6 +503,19 @@ Sends a buffer on the socket. The socket must be in a bound or connected mode. T
  */
 GF_Err gf_sk_send_ex(GF_Socket *sock, const u8 *buffer, u32 length, u32 *written);
 
+/*!
+\brief file data emission
+
+Sends a range of a file on a TCP socket without copying data in user space (sendfile). This is only available on Linux and Android, for regular files (not File IO wrappers) and regular TCP sockets. As with \ref gf_sk_send_ex, the number of bytes written may be less than requested for non-blocking sockets, or if the end of the file is reached
+\param sock the socket object
+\param file the file to send - the file position is not modified
+\param offset offset in the file of the first byte to send
+\param length number of bytes to send
+\param written set to number of written bytes - may be NULL
+\return error if any, GF_NOT_SUPPORTED if zero-copy cannot be used for this socket or file
+ */
+GF_Err gf_sk_send_file(GF_Socket *sock, FILE *file, u64 offset, u32 length, u32 *written);
+
 
 /*!
 \brief data reception
@@ -731,6 +744,16 @@ Creates a new socket group
  */
 GF_SockGroup *gf_sk_group_new();
 /*!
+Creates a new socket group, possibly using epoll
+
+When epoll is used, only sockets signaled as ready are checked at each \ref gf_sk_group_select call, regardless of the number of sockets in the group. The events to watch are set per socket using \ref gf_sk_group_sock_set_mode (read by default) and the mode passed to \ref gf_sk_group_select is ignored.
+
+If epoll is not available, the group uses poll or select as with \ref gf_sk_group_new
+\param use_epoll if GF_TRUE, use epoll (Linux only)
+\return socket group object
+ */
+GF_SockGroup *gf_sk_group_new_ex(Bool use_epoll);
+/*!
 Deletes a socket group
 \param sg socket group object
  */
@@ -766,6 +789,14 @@ Checks if given socket is selected and can be read. This shall be called after g
  */
 Bool gf_sk_group_sock_is_set(GF_SockGroup *sg, GF_Socket *sk, GF_SockSelectMode mode);
 
+/*!
+Sets the events to watch for a socket in an epoll-based group. This has no effect for other groups
+\param sg socket group object
+\param sk socket object registered with the group
+\param mode the events to watch
+ */
+void gf_sk_group_sock_set_mode(GF_SockGroup *sg, GF_Socket *sk, GF_SockSelectMode mode);
+
 /*! @} */
 #endif //GPAC_DISABLE_NETWORK
 
@@ -278,6 +278,34 @@ Sets the thread execution priority level.
  */
 void gf_th_set_priority(GF_Thread *th, s32 priority);
 /*!
+\brief thread CPU affinity
+
+Restricts the set of cores a thread may run on.
+\param th the thread object, or NULL for the calling thread
+\param cores array of core indexes the thread may run on
+\param nb_cores number of core indexes in the array
+\return error if any, GF_NOT_SUPPORTED if not supported on this platform
+ */
+GF_Err gf_th_set_affinity(GF_Thread *th, const u32 *cores, u32 nb_cores);
+/*!
+\brief thread CPU affinity query
+
+Gets the set of cores a thread may run on.
+\param th the thread object, or NULL for the calling thread
+\param cores array receiving the core indexes the thread may run on
+\param nb_cores set to the number of entries in the array, set to the number of core indexes written
+\return error if any, GF_NOT_SUPPORTED if not supported on this platform
+ */
+GF_Err gf_th_get_affinity(GF_Thread *th, u32 *cores, u32 *nb_cores);
+/*!
+\brief NUMA node of a core
+
+Gets the NUMA node a core belongs to.
+\param core the core index
+\return the NUMA node index of the core, or -1 if unknown
+ */
+s32 gf_th_get_core_numa_node(u32 core);
+/*!
 \brief current thread ID
 
 Gets the ID of the current thread the caller is in.
@@ -432,6 +460,9 @@ typedef void * GF_Thread;
 #define gf_th_stop(_th)
 #define gf_th_status(_th) GF_THREAD_STATUS_DEAD
 #define gf_th_set_priority(_th, _priority)
+#define gf_th_set_affinity(_th, _cores, _nb_cores) GF_NOT_SUPPORTED
+#define gf_th_get_affinity(_th, _cores, _nb_cores) GF_NOT_SUPPORTED
+#define gf_th_get_core_numa_node(_core) -1
 #define gf_th_id() 0
 
 #ifdef GPAC_CONFIG_ANDROID
@@ -4,6 +4,9 @@
 
 #define unittest(suffix) void test_##suffix(void)
 
+//benchmarks are opt-in: they only run, and print their timings, when GPAC_UT_BENCH is set in the environment
+#define ut_bench_enabled() (getenv("GPAC_UT_BENCH") ? GF_TRUE : GF_FALSE)
+
 extern int checks_passed;
 extern int checks_failed;
 
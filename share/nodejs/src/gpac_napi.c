@@ -5046,6 +5046,7 @@ static napi_status InitConstants(napi_env env, napi_value exports)
 	DEF_CONST(GF_FS_SCHEDULER_LOCK_FREE_X)
 	DEF_CONST(GF_FS_SCHEDULER_LOCK_FORCE)
 	DEF_CONST(GF_FS_SCHEDULER_DIRECT)
+	DEF_CONST(GF_FS_SCHEDULER_WORK_STEAL)
 
 	DEF_CONST(GF_FS_FLAG_LOAD_META)
 	DEF_CONST(GF_FS_FLAG_NON_BLOCKING)
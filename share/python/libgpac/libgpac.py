@@ -1079,6 +1079,9 @@ GF_FS_SCHEDULER_LOCK_FORCE=3
 ##\hideinitializer
 ##see \ref GF_FS_SCHEDULER_DIRECT
 GF_FS_SCHEDULER_DIRECT=4
+##\hideinitializer
+##see \ref GF_FS_SCHEDULER_WORK_STEAL
+GF_FS_SCHEDULER_WORK_STEAL=5
 
 #session flags
 ##\hideinitializer
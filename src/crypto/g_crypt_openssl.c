@@ -29,11 +29,17 @@
 #ifdef GPAC_HAS_SSL
 #include <openssl/aes.h>
 #include <openssl/modes.h>
+#include <openssl/evp.h>
 
 #include <math.h>
 
+/*CBC and CTR use the EVP interface, which selects the hardware-accelerated AES implementations (AES-NI, ARMv8 crypto)
+and processes several blocks per call whenever the mode allows it (CTR and CBC decryption)*/
+
 typedef struct {
-	AES_KEY enc_key, dec_key;
+	EVP_CIPHER_CTX *enc, *dec;
+	//set when the EVP context chaining value matches previous_ciphertext
+	Bool enc_sync, dec_sync;
 
 	u8 block[AES_BLOCK_SIZE];
 	u8 padded_input[AES_BLOCK_SIZE]; // use only when the input length is inferior to the algo block size
@@ -49,29 +55,42 @@ GF_Err gf_crypt_init_openssl_cbc(GF_Crypt* td, void *key, const void *iv)
 		GF_SAFEALLOC(ctx, Openssl_ctx_cbc);
 		if (ctx == NULL) return GF_OUT_OF_MEM;
 		td->context = ctx;
+		ctx->enc = EVP_CIPHER_CTX_new();
+		ctx->dec = EVP_CIPHER_CTX_new();
+		if (!ctx->enc || !ctx->dec) return GF_OUT_OF_MEM;
 	}
 	
 	if (iv != NULL) {
 		memcpy(ctx->previous_ciphertext, iv, AES_BLOCK_SIZE);
+		ctx->enc_sync = ctx->dec_sync = GF_FALSE;
 	}
 	return GF_OK;
 }
 
 void gf_crypt_deinit_openssl_cbc(GF_Crypt* td)
 {
+	Openssl_ctx_cbc* ctx = (Openssl_ctx_cbc*)td->context;
+	if (!ctx) return;
+	if (ctx->enc) EVP_CIPHER_CTX_free(ctx->enc);
+	if (ctx->dec) EVP_CIPHER_CTX_free(ctx->dec);
+	ctx->enc = ctx->dec = NULL;
 }
 
 void gf_set_key_openssl_cbc(GF_Crypt* td, void *key)
 {
 	Openssl_ctx_cbc* ctx = (Openssl_ctx_cbc*)td->context;
-	AES_set_encrypt_key(key, 128, &(ctx->enc_key));
-	AES_set_decrypt_key(key, 128, &(ctx->dec_key));
+	EVP_EncryptInit_ex(ctx->enc, EVP_aes_128_cbc(), NULL, key, ctx->previous_ciphertext);
+	EVP_CIPHER_CTX_set_padding(ctx->enc, 0);
+	EVP_DecryptInit_ex(ctx->dec, EVP_aes_128_cbc(), NULL, key, ctx->previous_ciphertext);
+	EVP_CIPHER_CTX_set_padding(ctx->dec, 0);
+	ctx->enc_sync = ctx->dec_sync = GF_TRUE;
 }
 
 GF_Err gf_crypt_set_IV_openssl_cbc(GF_Crypt* td, const u8 *iv, u32 iv_size)
 {
 	Openssl_ctx_cbc* ctx = (Openssl_ctx_cbc*)td->context;
 	memcpy(ctx->previous_ciphertext, iv, iv_size);
+	ctx->enc_sync = ctx->dec_sync = GF_FALSE;
 	return GF_OK;
 }
 
@@ -85,20 +104,39 @@ GF_Err gf_crypt_get_IV_openssl_cbc(GF_Crypt* td, u8 *iv, u32 *iv_size)
 
 GF_Err gf_crypt_crypt_openssl_cbc(GF_Crypt* td, u8 *plaintext, u32 len, u32 aes_crypt_type) {
 	Openssl_ctx_cbc* ctx = (Openssl_ctx_cbc*)td->context;
-	u32 iteration;
-	AES_KEY *key = aes_crypt_type ? &ctx->enc_key : &ctx->dec_key;
-	u32 numberOfIterations = len / AES_BLOCK_SIZE;
-	if (numberOfIterations * AES_BLOCK_SIZE < len) numberOfIterations++;
+	EVP_CIPHER_CTX *evp = aes_crypt_type ? ctx->enc : ctx->dec;
+	u32 full_len = len - (len % AES_BLOCK_SIZE);
+	int out_len;
 
-	for (iteration = 0; iteration < numberOfIterations; ++iteration) {
-		if (len - iteration*AES_BLOCK_SIZE < AES_BLOCK_SIZE) {
-			memset(ctx->padded_input, 0, AES_BLOCK_SIZE);
-			memcpy(ctx->padded_input, plaintext, len - iteration*AES_BLOCK_SIZE);
-			AES_cbc_encrypt(plaintext + iteration*AES_BLOCK_SIZE, ctx->block, AES_BLOCK_SIZE, key, ctx->previous_ciphertext, aes_crypt_type);
-			memcpy(plaintext + iteration*AES_BLOCK_SIZE, ctx->block, len - iteration*AES_BLOCK_SIZE);
-		} else {
-			AES_cbc_encrypt(plaintext + iteration*AES_BLOCK_SIZE, plaintext + iteration*AES_BLOCK_SIZE, AES_BLOCK_SIZE, key, ctx->previous_ciphertext, aes_crypt_type);
-		}
+	if (aes_crypt_type ? !ctx->enc_sync : !ctx->dec_sync) {
+		EVP_CipherInit_ex(evp, NULL, NULL, NULL, ctx->previous_ciphertext, aes_crypt_type ? 1 : 0);
+	}
+	//chaining of the other direction no longer matches previous_ciphertext
+	ctx->enc_sync = aes_crypt_type ? GF_TRUE : GF_FALSE;
+	ctx->dec_sync = aes_crypt_type ? GF_FALSE : GF_TRUE;
+
+	if (full_len) {
+		//in-place decryption, keep last cipher block for chaining
+		if (!aes_crypt_type)
+			memcpy(ctx->previous_ciphertext, plaintext + full_len - AES_BLOCK_SIZE, AES_BLOCK_SIZE);
+
+		if (!EVP_CipherUpdate(evp, plaintext, &out_len, plaintext, full_len) || (out_len != (int) full_len))
+			return GF_IO_ERR;
+
+		if (aes_crypt_type)
+			memcpy(ctx->previous_ciphertext, plaintext + full_len - AES_BLOCK_SIZE, AES_BLOCK_SIZE);
+	}
+	//last partial block is zero-padded
+	if (len > full_len) {
+		memset(ctx->padded_input, 0, AES_BLOCK_SIZE);
+		memcpy(ctx->padded_input, plaintext + full_len, len - full_len);
+		memcpy(ctx->block, ctx->padded_input, AES_BLOCK_SIZE);
+
+		if (!EVP_CipherUpdate(evp, ctx->block, &out_len, ctx->block, AES_BLOCK_SIZE))
+			return GF_IO_ERR;
+		memcpy(plaintext + full_len, ctx->block, len - full_len);
+
+		memcpy(ctx->previous_ciphertext, aes_crypt_type ? ctx->block : ctx->padded_input, AES_BLOCK_SIZE);
 	}
 	return GF_OK;
 }
@@ -114,20 +152,33 @@ GF_Err gf_crypt_decrypt_openssl_cbc(GF_Crypt* td, u8 *ciphertext, u32 len)
 }
 
 typedef struct {
-	AES_KEY key;
+	EVP_CIPHER_CTX *evp;
+	//set when the EVP context counter no longer matches iv
+	Bool reset_iv;
 
 	u8 cyphered_iv[16];
 	u8 iv[16];
 	unsigned int c_counter_pos;
 } Openssl_ctx_ctr;
 
+//128-bit big endian counter increment, as done by CRYPTO_ctr128_encrypt
+static void gf_crypt_ctr_add(u8 *counter, u64 nb_blocks)
+{
+	s32 i;
+	for (i=15; (i>=0) && nb_blocks; i--) {
+		nb_blocks += counter[i];
+		counter[i] = (u8) (nb_blocks & 0xFF);
+		nb_blocks >>= 8;
+	}
+}
 
 /** CTR STUFF **/
 
 void gf_set_key_openssl_ctr(GF_Crypt* td, void *key)
 {
 	Openssl_ctx_ctr* ctx = (Openssl_ctx_ctr*)td->context;
-	AES_set_encrypt_key(key, 128, &(ctx->key));
+	EVP_EncryptInit_ex(ctx->evp, EVP_aes_128_ctr(), NULL, key, ctx->iv);
+	ctx->reset_iv = GF_FALSE;
 }
 
 GF_Err gf_crypt_set_IV_openssl_ctr(GF_Crypt* td, const u8 *iv, u32 iv_size)
@@ -137,6 +188,7 @@ GF_Err gf_crypt_set_IV_openssl_ctr(GF_Crypt* td, const u8 *iv, u32 iv_size)
 	ctx->c_counter_pos = ((u8*)iv)[0];
 	memcpy(ctx->iv, &((u8*)iv)[1], iv_size - 1);
 	memset(ctx->cyphered_iv, 0, 16);
+	ctx->reset_iv = GF_TRUE;
 	return GF_OK;
 }
 
@@ -159,10 +211,13 @@ GF_Err gf_crypt_init_openssl_ctr(GF_Crypt* td, void *key, const void *iv)
 		if (!ctx) return GF_OUT_OF_MEM;
 
 		td->context = ctx;
+		ctx->evp = EVP_CIPHER_CTX_new();
+		if (!ctx->evp) return GF_OUT_OF_MEM;
 	}
 	ctx->c_counter_pos = 0;
 	if (iv != NULL) {
 		memcpy(ctx->iv, &((u8*)iv)[0], AES_BLOCK_SIZE);
+		ctx->reset_iv = GF_TRUE;
 	}
 
 	return GF_OK;
@@ -170,14 +225,50 @@ GF_Err gf_crypt_init_openssl_ctr(GF_Crypt* td, void *key, const void *iv)
 
 void gf_crypt_deinit_openssl_ctr(GF_Crypt* td)
 {
+	Openssl_ctx_ctr* ctx = (Openssl_ctx_ctr*)td->context;
+	if (ctx && ctx->evp) EVP_CIPHER_CTX_free(ctx->evp);
+	if (ctx) ctx->evp = NULL;
 }
 
+/*same state handling as CRYPTO_ctr128_encrypt: iv is the next counter block and cyphered_iv the key stream of the current block,
+c_counter_pos bytes of which are already used. Whole blocks go through EVP, whose internal counter is kept equal to iv*/
 GF_Err gf_crypt_crypt_openssl_ctr(GF_Crypt* td, u8 *plaintext, u32 len)
 {
 	Openssl_ctx_ctr* ctx = (Openssl_ctx_ctr*)td->context;
+	u32 full_len;
+	int out_len;
+
+	//remaining key stream of current block
+	while (ctx->c_counter_pos && len) {
+		*plaintext++ ^= ctx->cyphered_iv[ctx->c_counter_pos];
+		ctx->c_counter_pos = (ctx->c_counter_pos + 1) % AES_BLOCK_SIZE;
+		len--;
+	}
+	if (!len) return GF_OK;
 
-	CRYPTO_ctr128_encrypt(plaintext, plaintext, len, &ctx->key, ctx->iv, ctx->cyphered_iv, &ctx->c_counter_pos, (block128_f)AES_encrypt);
-
+	if (ctx->reset_iv) {
+		EVP_EncryptInit_ex(ctx->evp, NULL, NULL, NULL, ctx->iv);
+		ctx->reset_iv = GF_FALSE;
+	}
+	full_len = len - (len % AES_BLOCK_SIZE);
+	if (full_len) {
+		if (!EVP_EncryptUpdate(ctx->evp, plaintext, &out_len, plaintext, full_len) || (out_len != (int) full_len))
+			return GF_IO_ERR;
+		gf_crypt_ctr_add(ctx->iv, full_len / AES_BLOCK_SIZE);
+		plaintext += full_len;
+		len -= full_len;
+	}
+	//last partial block, keep key stream for next call
+	if (len) {
+		u32 i;
+		memset(ctx->cyphered_iv, 0, AES_BLOCK_SIZE);
+		if (!EVP_EncryptUpdate(ctx->evp, ctx->cyphered_iv, &out_len, ctx->cyphered_iv, AES_BLOCK_SIZE))
+			return GF_IO_ERR;
+		gf_crypt_ctr_add(ctx->iv, 1);
+		for (i=0; i<len; i++)
+			plaintext[i] ^= ctx->cyphered_iv[i];
+		ctx->c_counter_pos = len;
+	}
 	return GF_OK;
 }
 
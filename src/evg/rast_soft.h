@@ -236,6 +236,28 @@ void evg_gradient_precompute(EVG_BaseGradient *grad, GF_EVGSurface *surf);
 void evg_radial_init(EVG_RadialGradient *_this);
 void evg_texture_init(GF_EVGStencil *p, GF_EVGSurface *surf);
 
+/*span kernels (SSE2/NEON when available), bit-exact with the per-pixel blending code*/
+/*weight pattern size in bytes, multiple of 16 and of 1, 3 and 4 bytes pixel sizes*/
+#define EVG_SPAN_PATTERN	48
+/*minimum run length in pixels for which span kernels are used*/
+#define EVG_SPAN_MIN_RUN	16
+
+typedef struct
+{
+	u16 w_dst[EVG_SPAN_PATTERN];
+	u16 w_col[EVG_SPAN_PATTERN];
+} EVG_SpanBlend;
+
+/*sets up constant color blending of pixels of pix_size bytes with color pix - byte at keep_idx (if >=0) is left untouched*/
+void evg_span_blend_setup(EVG_SpanBlend *sb, const u8 *pix, u32 pix_size, s32 keep_idx, u32 alpha);
+/*blends nb_bytes of dst, dst must start on a pixel boundary - each byte is set to dst + mul255(alpha, col - dst)*/
+void evg_span_blend(u8 *dst, u32 nb_bytes, EVG_SpanBlend *sb);
+/*fills nb_bytes of dst with pixel pix of pix_size bytes*/
+void evg_span_fill(u8 *dst, u32 nb_bytes, const u8 *pix, u32 pix_size);
+/*blends constant color pix (32 bits, memory order) with given alpha over count ARGB pixels in source over mode
+groups of opaque destination pixels are blended with vector code*/
+void evg_span_blend_argb(u8 *dst, u32 count, const u8 *pix, u32 idx_a, u32 alpha);
+
 void evg_argb_fill_const(s32 y, s32 count, EVG_Span *spans, GF_EVGSurface *surf, EVGRasterCtx *rctx);
 void evg_argb_fill_const_a(s32 y, s32 count, EVG_Span *spans, GF_EVGSurface *surf, EVGRasterCtx *rctx);
 void evg_argb_fill_var(s32 y, s32 count, EVG_Span *spans, GF_EVGSurface *surf, EVGRasterCtx *rctx);
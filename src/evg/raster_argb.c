@@ -168,6 +168,20 @@ GFINLINE static void overmask_argb_const_run(u32 src, u8 *dst, s32 dst_pitch_x,
 	s32 srcg = GF_COL_G(src);
 	s32 srcb = GF_COL_B(src);
 
+	if ((dst_pitch_x==4) && (count>=EVG_SPAN_MIN_RUN) && (surf->comp_mode==GF_EVG_SRC_OVER)) {
+		u8 pix[4];
+		pix[surf->idx_a] = const_srca;
+		pix[surf->idx_r] = srcr;
+		pix[surf->idx_g] = srcg;
+		pix[surf->idx_b] = srcb;
+		//opaque source, overwrite
+		if (const_srca==0xFF)
+			evg_span_fill(dst, 4*count, pix, 4);
+		else
+			evg_span_blend_argb(dst, count, pix, surf->idx_a, const_srca);
+		return;
+	}
+
 	while (count) {
 		s32 srca = const_srca;
 		s32 dsta = dst[surf->idx_a];
@@ -391,6 +405,18 @@ GFINLINE static void overmask_rgbx_const_run(u32 src, u8 *dst, s32 dst_pitch_x,
 	u32 srcr = mul255(srca, ((src >> 16) & 0xff)) ;
 	u32 srcg = mul255(srca, ((src >> 8) & 0xff)) ;
 	u32 srcb = mul255(srca, ((src) & 0xff)) ;
+
+	if ((dst_pitch_x==4) && (count>=EVG_SPAN_MIN_RUN)) {
+		EVG_SpanBlend sb;
+		u8 pix[4];
+		pix[surf->idx_r] = srcr;
+		pix[surf->idx_g] = srcg;
+		pix[surf->idx_b] = srcb;
+		//idx_a is the X byte, left untouched
+		evg_span_blend_setup(&sb, pix, 4, surf->idx_a, srca);
+		evg_span_blend(dst, 4*count, &sb);
+		return;
+	}
 	while (count) {
 		u32 dstc;
 		dstc = dst[surf->idx_r];
@@ -444,6 +470,9 @@ void evg_rgbx_fill_const(s32 y, s32 count, EVG_Span *spans, GF_EVGSurface *surf,
 		if (spana != 0xFF) {
 			fin = (spana<<24) | col_no_a;
 			overmask_rgbx_const_run(fin, dst + x, surf->pitch_x, len, surf);
+		} else if ((surf->pitch_x==4) && (len>=EVG_SPAN_MIN_RUN)) {
+			//full alpha blend sets the color and keeps the X byte
+			overmask_rgbx_const_run(col | 0xFF000000, dst + x, surf->pitch_x, len, surf);
 		} else {
 			while (len--) {
 				dst[x+surf->idx_r] = r;
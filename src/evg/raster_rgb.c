@@ -64,6 +64,17 @@ static void overmask_rgb_const_run(u32 src, u8 *dst, s32 dst_pitch_x, u32 count,
 	s32 srcg = (src >> 8) & 0xff;
 	s32 srcb = (src) & 0xff;
 
+	if ((dst_pitch_x==3) && (count>=EVG_SPAN_MIN_RUN)) {
+		EVG_SpanBlend sb;
+		u8 pix[3];
+		pix[surf->idx_r] = srcr;
+		pix[surf->idx_g] = srcg;
+		pix[surf->idx_b] = srcb;
+		evg_span_blend_setup(&sb, pix, 3, -1, srca);
+		evg_span_blend(dst, 3*count, &sb);
+		return;
+	}
+
 	while (count) {
 		s32 dstr = dst[surf->idx_r];
 		s32 dstg = dst[surf->idx_g];
@@ -115,6 +126,12 @@ void evg_rgb_fill_const(s32 y, s32 count, EVG_Span *spans, GF_EVGSurface *surf,
 			a = mul255(0xFF, spans[i].coverage);
 			fin = (a<<24) | col_no_a;
 			overmask_rgb_const_run(fin, p, surf->pitch_x, len, surf);
+		} else if (surf->pitch_x==3) {
+			u8 pix[3];
+			pix[surf->idx_r] = r;
+			pix[surf->idx_g] = g;
+			pix[surf->idx_b] = b;
+			evg_span_fill((u8 *) p, 3*len, pix, 3);
 		} else {
 			while (len--) {
 				p[surf->idx_r] = r;
@@ -245,6 +262,12 @@ static void overmask_grey(u32 src, char *dst, u32 alpha, u32 grey_type)
 
 static void overmask_grey_const_run(u8 srca, u8 srcc, char *dst, s32 dst_pitch_x, u32 count)
 {
+	if ((dst_pitch_x==1) && (count>=EVG_SPAN_MIN_RUN)) {
+		EVG_SpanBlend sb;
+		evg_span_blend_setup(&sb, &srcc, 1, -1, srca);
+		evg_span_blend((u8 *) dst, count, &sb);
+		return;
+	}
 	while (count) {
 		u8 dstc = *(dst);
 		*dst = (u8) mul255(srca, srcc - dstc) + dstc;
@@ -290,6 +313,8 @@ void evg_grey_fill_const(s32 y, s32 count, EVG_Span *spans, GF_EVGSurface *surf,
 		if (spans[i].coverage != 0xFF) {
 			a = mul255(0xFF, spans[i].coverage);
 			overmask_grey_const_run(a, c, p, surf->pitch_x, len);
+		} else if (surf->pitch_x==1) {
+			memset(p, c, len);
 		} else {
 			while (len--) {
 				*(p) = c;
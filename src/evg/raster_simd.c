@@ -0,0 +1,230 @@
+/*
+ *			GPAC - Multimedia Framework C SDK
+ *
+ *			Authors: GPAC contributors
+ *			Copyright (c) GPAC contributors 2026
+ *					All rights reserved
+ *
+ *  This file is part of GPAC / software 2D rasterizer
+ *
+ *  GPAC is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  GPAC is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *
+ *
+ */
+
+#include "rast_soft.h"
+
+#ifndef GPAC_DISABLE_EVG
+
+/*
+	Span fill and blend kernels for 8-bit planar and packed formats
+
+	All kernels produce results identical to the per-pixel blending code of the raster backends:
+	- constant blend: dst = dst + mul255(alpha, col - dst), rewritten as (dst*(255-alpha) + col*(alpha+1)) >> 8, which never exceeds 16 bits
+	- ARGB over opaque destination: dst = (col*alpha + dst*(255-alpha)) / 255, with exact division by 255 for values up to 255*255
+	- ARGB over non-opaque destination: per-pixel source over blending
+*/
+
+#if defined(WIN32) && !defined(__GNUC__) && (defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP>=2)))
+# include <intrin.h>
+# define EVG_SPAN_SSE2
+#elif defined(__SSE2__)
+# include <emmintrin.h>
+# define EVG_SPAN_SSE2
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+# include <arm_neon.h>
+# define EVG_SPAN_NEON
+#endif
+
+void evg_span_blend_setup(EVG_SpanBlend *sb, const u8 *pix, u32 pix_size, s32 keep_idx, u32 alpha)
+{
+	u32 i, j;
+	for (i=0; i<EVG_SPAN_PATTERN; i+=pix_size) {
+		for (j=0; j<pix_size; j++) {
+			if ((s32) j == keep_idx) {
+				sb->w_dst[i+j] = 256;
+				sb->w_col[i+j] = 0;
+			} else {
+				sb->w_dst[i+j] = 255 - alpha;
+				sb->w_col[i+j] = pix[j] * (alpha + 1);
+			}
+		}
+	}
+}
+
+static void span_blend_c(u8 *dst, u32 nb_bytes, EVG_SpanBlend *sb, u32 offset)
+{
+	while (nb_bytes) {
+		*dst = (u8) ( ((u32) *dst * sb->w_dst[offset] + sb->w_col[offset]) >> 8);
+		dst++;
+		offset++;
+		if (offset==EVG_SPAN_PATTERN) offset = 0;
+		nb_bytes--;
+	}
+}
+
+void evg_span_blend(u8 *dst, u32 nb_bytes, EVG_SpanBlend *sb)
+{
+	u32 k=0;
+#if defined(EVG_SPAN_SSE2)
+	u32 i;
+	__m128i wd[6], wc[6];
+	__m128i zero = _mm_setzero_si128();
+	for (i=0; i<6; i++) {
+		wd[i] = _mm_loadu_si128((const __m128i *) &sb->w_dst[8*i]);
+		wc[i] = _mm_loadu_si128((const __m128i *) &sb->w_col[8*i]);
+	}
+	while (nb_bytes >= 16) {
+		__m128i d = _mm_loadu_si128((const __m128i *) dst);
+		__m128i lo = _mm_unpacklo_epi8(d, zero);
+		__m128i hi = _mm_unpackhi_epi8(d, zero);
+		lo = _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(lo, wd[2*k]), wc[2*k]), 8);
+		hi = _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(hi, wd[2*k+1]), wc[2*k+1]), 8);
+		_mm_storeu_si128((__m128i *) dst, _mm_packus_epi16(lo, hi));
+		dst += 16;
+		nb_bytes -= 16;
+		k = (k==2) ? 0 : k+1;
+	}
+#elif defined(EVG_SPAN_NEON)
+	u32 i;
+	uint16x8_t wd[6], wc[6];
+	for (i=0; i<6; i++) {
+		wd[i] = vld1q_u16(&sb->w_dst[8*i]);
+		wc[i] = vld1q_u16(&sb->w_col[8*i]);
+	}
+	while (nb_bytes >= 16) {
+		uint8x16_t d = vld1q_u8(dst);
+		uint16x8_t lo = vmlaq_u16(wc[2*k], vmovl_u8(vget_low_u8(d)), wd[2*k]);
+		uint16x8_t hi = vmlaq_u16(wc[2*k+1], vmovl_u8(vget_high_u8(d)), wd[2*k+1]);
+		vst1q_u8(dst, vcombine_u8(vshrn_n_u16(lo, 8), vshrn_n_u16(hi, 8)));
+		dst += 16;
+		nb_bytes -= 16;
+		k = (k==2) ? 0 : k+1;
+	}
+#endif
+	span_blend_c(dst, nb_bytes, sb, 16*k);
+}
+
+void evg_span_fill(u8 *dst, u32 nb_bytes, const u8 *pix, u32 pix_size)
+{
+	u8 pattern[EVG_SPAN_PATTERN];
+	u32 i;
+	for (i=0; i<EVG_SPAN_PATTERN; i+=pix_size) {
+		memcpy(pattern+i, pix, pix_size);
+	}
+	//fixed size copies are turned into vector stores by the compiler
+	while (nb_bytes >= EVG_SPAN_PATTERN) {
+		memcpy(dst, pattern, EVG_SPAN_PATTERN);
+		dst += EVG_SPAN_PATTERN;
+		nb_bytes -= EVG_SPAN_PATTERN;
+	}
+	if (nb_bytes)
+		memcpy(dst, pattern, nb_bytes);
+}
+
+static GFINLINE s32
+mul255(s32 a, s32 b)
+{
+	return ((a+1) * b) >> 8;
+}
+
+static GFINLINE Bool argb_group_opaque(u8 *dst, u32 idx_a)
+{
+	return ((dst[idx_a] & dst[4+idx_a] & dst[8+idx_a] & dst[12+idx_a]) == 0xFF) ? GF_TRUE : GF_FALSE;
+}
+
+//source over blending of a single pixel, as done by the ARGB raster backend
+static GFINLINE void argb_blend_pixel(u8 *dst, const u8 *pix, u32 idx_a, s32 srca)
+{
+	u32 i;
+	s32 dsta = dst[idx_a];
+	if ((dsta != 0) && (srca != 0xFF)) {
+		s32 final_a = dsta + srca - mul255(dsta, srca);
+		if (!final_a) return;
+		for (i=0; i<4; i++) {
+			s32 res;
+			if (i==idx_a) continue;
+			res = (pix[i]*srca + dst[i]*(dsta-srca)) / final_a;
+			if (res<0) res=0;
+			dst[i] = (u8) res;
+		}
+		dst[idx_a] = (u8) final_a;
+	} else {
+		memcpy(dst, pix, 4);
+		dst[idx_a] = (u8) srca;
+	}
+}
+
+void evg_span_blend_argb(u8 *dst, u32 count, const u8 *pix, u32 idx_a, u32 alpha)
+{
+	u32 i;
+	u16 w_dst[8], w_col[8];
+#if defined(EVG_SPAN_SSE2)
+	__m128i zero, one, wd, wc;
+#elif defined(EVG_SPAN_NEON)
+	uint16x8_t one, wd, wc;
+#endif
+
+	//alpha byte: (255*alpha + 255*(255-alpha)) / 255 = 255
+	for (i=0; i<8; i++) {
+		u32 c = ((i%4) == idx_a) ? 255 : pix[i%4];
+		w_dst[i] = 255 - alpha;
+		w_col[i] = c * alpha;
+	}
+#if defined(EVG_SPAN_SSE2)
+	zero = _mm_setzero_si128();
+	one = _mm_set1_epi16(1);
+	wd = _mm_loadu_si128((const __m128i *) w_dst);
+	wc = _mm_loadu_si128((const __m128i *) w_col);
+#elif defined(EVG_SPAN_NEON)
+	one = vdupq_n_u16(1);
+	wd = vld1q_u16(w_dst);
+	wc = vld1q_u16(w_col);
+#endif
+
+	while (count) {
+		//groups of 4 opaque destination pixels
+		if ((count >= 4) && argb_group_opaque(dst, idx_a)) {
+#if defined(EVG_SPAN_SSE2)
+			__m128i d = _mm_loadu_si128((const __m128i *) dst);
+			__m128i lo = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(d, zero), wd), wc);
+			__m128i hi = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(d, zero), wd), wc);
+			//x/255 = (x + 1 + (x>>8)) >> 8 for x <= 255*255
+			lo = _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(lo, one), _mm_srli_epi16(lo, 8)), 8);
+			hi = _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(hi, one), _mm_srli_epi16(hi, 8)), 8);
+			_mm_storeu_si128((__m128i *) dst, _mm_packus_epi16(lo, hi));
+#elif defined(EVG_SPAN_NEON)
+			uint8x16_t d = vld1q_u8(dst);
+			uint16x8_t lo = vmlaq_u16(wc, vmovl_u8(vget_low_u8(d)), wd);
+			uint16x8_t hi = vmlaq_u16(wc, vmovl_u8(vget_high_u8(d)), wd);
+			lo = vshrq_n_u16(vaddq_u16(vaddq_u16(lo, one), vshrq_n_u16(lo, 8)), 8);
+			hi = vshrq_n_u16(vaddq_u16(vaddq_u16(hi, one), vshrq_n_u16(hi, 8)), 8);
+			vst1q_u8(dst, vcombine_u8(vmovn_u16(lo), vmovn_u16(hi)));
+#else
+			for (i=0; i<16; i++) {
+				dst[i] = (u8) ( ((u32) dst[i] * w_dst[i%8] + w_col[i%8]) / 255);
+			}
+#endif
+			dst += 16;
+			count -= 4;
+			continue;
+		}
+		argb_blend_pixel(dst, pix, idx_a, alpha);
+		dst += 4;
+		count--;
+	}
+}
+
+#endif //GPAC_DISABLE_EVG
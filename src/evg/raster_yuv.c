@@ -273,6 +273,12 @@ static void overmask_yuv420p(u8 col_a, u8 cy, char *dst, u32 alpha)
 
 static void overmask_yuv420p_const_run(u8 a, u8 val, u8 *ptr, u32 count, short x)
 {
+	if (count>=EVG_SPAN_MIN_RUN) {
+		EVG_SpanBlend sb;
+		evg_span_blend_setup(&sb, &val, 1, -1, a);
+		evg_span_blend(ptr, count, &sb);
+		return;
+	}
 	while (count) {
 		u8 dst = *(ptr);
 		*ptr = (u8) mul255(a, val - dst) + dst;
@@ -357,10 +363,7 @@ void evg_yuv420p_fill_const(s32 y, s32 count, EVG_Span *spans, GF_EVGSurface *su
 			overmask_yuv420p_const_run((u8)a, cy, s_pY, len, 0);
 			memset(surf_uv_alpha + spans[i].x, (u8)a, len);
 		} else  {
-			while (len--) {
-				*(s_pY) = cy;
-				s_pY ++;
-			}
+			memset(s_pY, cy, len);
 			memset(surf_uv_alpha + spans[i].x, 0xFF, spans[i].len);
 		}
 	}
@@ -943,14 +946,9 @@ void evg_yuv444p_fill_const(s32 y, s32 count, EVG_Span *spans, GF_EVGSurface *su
 			overmask_yuv420p_const_run((u8)a, cu, s_pU, len, 0);
 			overmask_yuv420p_const_run((u8)a, cv, s_pV, len, 0);
 		} else  {
-			while (len--) {
-				*(s_pY) = cy;
-				s_pY ++;
-				*(s_pU) = cu;
-				s_pU ++;
-				*(s_pV) = cv;
-				s_pV ++;
-			}
+			memset(s_pY, cy, len);
+			memset(s_pU, cu, len);
+			memset(s_pV, cv, len);
 		}
 	}
 }
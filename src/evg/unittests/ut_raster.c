@@ -0,0 +1,143 @@
+#include "tests.h"
+#include "../raster_simd.c"
+#include <gpac/path2d.h>
+
+#define EVG_TEST_SIZE	1024
+
+static u32 evg_test_rand(u32 *seed)
+{
+	*seed = (*seed) * 1103515245 + 12345;
+	return (*seed >> 8) & 0xFFFFFF;
+}
+
+//per-pixel blending as done by the raster backends
+static u8 evg_ref_blend(u32 a, s32 c, s32 d)
+{
+	return (u8) ((((s32) a + 1) * (c - d)) >> 8) + d;
+}
+
+unittest(evg_span_blend_exact)
+{
+	u8 dst[EVG_TEST_SIZE], ref[EVG_TEST_SIZE];
+	u32 i, j, seed=3, nb_fail=0;
+	u32 pix_sizes[] = {1, 3, 4};
+
+	for (i=0; i<3*256; i++) {
+		EVG_SpanBlend sb;
+		u8 pix[4];
+		u32 ps = pix_sizes[i%3];
+		u32 alpha = i/3;
+		s32 keep = (ps==4) ? (s32) (i%4) : -1;
+		u32 nb_pix = (evg_test_rand(&seed) % (EVG_TEST_SIZE/4 - 1)) + 1;
+
+		for (j=0; j<4; j++) pix[j] = (u8) evg_test_rand(&seed);
+		for (j=0; j<EVG_TEST_SIZE; j++) dst[j] = ref[j] = (u8) evg_test_rand(&seed);
+
+		for (j=0; j<nb_pix*ps; j++) {
+			if ((s32) (j%ps) == keep) continue;
+			ref[j] = evg_ref_blend(alpha, pix[j%ps], ref[j]);
+		}
+		evg_span_blend_setup(&sb, pix, ps, keep, alpha);
+		evg_span_blend(dst, nb_pix*ps, &sb);
+		if (memcmp(dst, ref, EVG_TEST_SIZE)) nb_fail++;
+	}
+	assert_equal(nb_fail, 0);
+}
+
+//source over blending of one ARGB pixel as done by the raster backend
+static void evg_ref_blend_argb(u8 *dst, const u8 *pix, u32 idx_a, s32 srca)
+{
+	u32 j;
+	s32 dsta = dst[idx_a];
+	if (dsta && (srca != 0xFF)) {
+		s32 final_a = dsta + srca - (((dsta+1) * srca) >> 8);
+		for (j=0; j<4; j++) {
+			s32 res;
+			if (j==idx_a) continue;
+			res = (pix[j]*srca + dst[j]*(dsta-srca)) / final_a;
+			dst[j] = (u8) ((res<0) ? 0 : res);
+		}
+		dst[idx_a] = (u8) final_a;
+	} else {
+		for (j=0; j<4; j++) dst[j] = (j==idx_a) ? (u8) srca : pix[j];
+	}
+}
+
+//runs of opaque destination pixels mixed with transparent and semi-transparent ones, at any position in the run
+unittest(evg_span_blend_argb_exact)
+{
+	u8 dst[EVG_TEST_SIZE], ref[EVG_TEST_SIZE];
+	u32 i, j, seed=5, nb_fail=0;
+
+	for (i=0; i<4*256; i++) {
+		u8 pix[4];
+		u32 alpha = i/4, idx_a = i%4;
+		u32 count = 1 + evg_test_rand(&seed) % (EVG_TEST_SIZE/4 - 1);
+		//probability of a non-opaque destination pixel
+		u32 mix = evg_test_rand(&seed) % 4;
+
+		for (j=0; j<4; j++) pix[j] = (u8) evg_test_rand(&seed);
+		for (j=0; j<EVG_TEST_SIZE; j++) dst[j] = ref[j] = (u8) evg_test_rand(&seed);
+		for (j=0; j<EVG_TEST_SIZE/4; j++) {
+			u8 a = 0xFF;
+			if (mix && !(evg_test_rand(&seed) % (4*mix))) a = (u8) (evg_test_rand(&seed) % 3 ? evg_test_rand(&seed) : 0);
+			dst[4*j+idx_a] = ref[4*j+idx_a] = a;
+		}
+		for (j=0; j<count; j++)
+			evg_ref_blend_argb(ref + 4*j, pix, idx_a, alpha);
+
+		evg_span_blend_argb(dst, count, pix, idx_a, alpha);
+		if (memcmp(dst, ref, EVG_TEST_SIZE)) nb_fail++;
+	}
+	assert_equal(nb_fail, 0);
+}
+
+//not a pass/fail test: fills a semi-transparent full frame rectangle on 1080p surfaces
+unittest(evg_raster_bench)
+{
+	u32 i, j, w=1920, h=1080;
+	u8 *data;
+	GF_Path *path;
+	GF_EVGSurface *surf;
+	GF_EVGStencil *sten;
+	struct {
+		GF_PixelFormat pf;
+		u32 bpp;
+		const char *name;
+	} formats[] = {
+		{GF_PIXEL_ARGB, 4, "argb"},
+		{GF_PIXEL_RGBX, 4, "rgbx"},
+		{GF_PIXEL_RGB, 3, "rgb"},
+		{GF_PIXEL_GREYSCALE, 1, "grey"},
+		{GF_PIXEL_YUV, 1, "yuv420p"},
+		{GF_PIXEL_YUV444, 1, "yuv444p"},
+	};
+
+	if (!ut_bench_enabled()) return;
+
+	data = gf_malloc(w*h*4);
+	path = gf_path_new();
+	surf = gf_evg_surface_new(GF_FALSE);
+	sten = gf_evg_stencil_new(GF_STENCIL_SOLID);
+	gf_path_add_rect(path, 0, 0, INT2FIX(w), -INT2FIX(h));
+	gf_evg_stencil_set_brush_color(sten, 0x80FF8040);
+	for (i=0; i<GF_ARRAY_LENGTH(formats); i++) {
+		u64 now;
+		GF_Err e;
+		//opaque destination
+		memset(data, 0xFF, w*h*4);
+		e = gf_evg_surface_attach_to_buffer(surf, data, w, h, formats[i].bpp, w*formats[i].bpp, formats[i].pf);
+		assert_equal(e, GF_OK);
+		if (e) continue;
+		gf_evg_surface_set_path(surf, path);
+
+		now = gf_sys_clock_high_res();
+		for (j=0; j<10; j++)
+			gf_evg_surface_fill(surf, sten);
+		printf("%s %u us ", formats[i].name, (u32) (gf_sys_clock_high_res() - now) / 10);
+	}
+	gf_evg_stencil_delete(sten);
+	gf_evg_surface_delete(surf);
+	gf_path_del(path);
+	gf_free(data);
+}
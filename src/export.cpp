@@ -250,6 +250,7 @@
 #pragma comment (linker, EXPORT_SYMBOL(gf_bs_del) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_bs_read_bit) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_bs_read_int) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_bs_read_ue_fast) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_bs_read_long_int) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_bs_read_u8) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_bs_read_u16) )
@@ -306,6 +307,9 @@
 #pragma comment (linker, EXPORT_SYMBOL(gf_th_stop) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_th_status) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_th_set_priority) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_th_set_affinity) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_th_get_affinity) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_th_get_core_numa_node) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_th_id) )
 
 /* Lock */
@@ -332,6 +336,7 @@
 #pragma comment (linker, EXPORT_SYMBOL(gf_sk_bind) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_sk_connect) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_sk_send) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_sk_send_file) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_sk_receive) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_sk_listen) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_sk_accept) )
@@ -345,6 +350,14 @@
 #pragma comment (linker, EXPORT_SYMBOL(gf_sk_is_multicast_address) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_sk_receive_no_select) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_sk_set_usec_wait) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_sk_group_new) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_sk_group_new_ex) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_sk_group_del) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_sk_group_register) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_sk_group_unregister) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_sk_group_select) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_sk_group_sock_is_set) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_sk_group_sock_set_mode) )
 
 #pragma comment (linker, EXPORT_SYMBOL(gf_url_is_local) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_url_get_absolute_path) )
@@ -473,10 +486,13 @@
 #pragma comment (linker, EXPORT_SYMBOL(gf_dm_sess_mime_type) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_dm_sess_get_header) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_dm_sess_get_header_sizes_and_times) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_dm_get_connection_stats) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_dm_sess_enum_headers) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_dm_sess_set_max_rate) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_dm_sess_get_max_rate) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_dm_sess_is_regulated) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_dm_sess_has_buffered_input) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_dm_sess_send_file) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_dm_new) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_dm_del) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_dm_set_data_rate) )
@@ -806,6 +822,7 @@
 #pragma comment (linker, EXPORT_SYMBOL(gf_isom_new_xml_subtitle_description) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_isom_xml_subtitle_get_description) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_isom_open_progressive) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_isom_open_progressive_lazy) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_isom_get_missing_bytes) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_isom_freeze_order) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_isom_set_inplace_padding) )
@@ -1013,6 +1030,8 @@
 #pragma comment (linker, EXPORT_SYMBOL(gf_isom_is_track_referenced) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_isom_is_external_track) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_isom_switch_source) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_isom_enable_file_mapping) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_isom_set_zero_copy) )
 
 # ifndef GPAC_DISABLE_ISOM_DUMP
 #pragma comment (linker, EXPORT_SYMBOL(gf_isom_dump) )
@@ -2078,6 +2097,7 @@
 #pragma comment (linker, EXPORT_SYMBOL(gf_m2ts_demux_new) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_m2ts_demux_del) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_m2ts_process_data) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_m2ts_process_program) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_m2ts_reset_parsers) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_m2ts_reset_parsers_for_program) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_m2ts_set_pes_framing) )
@@ -2106,6 +2126,7 @@
 #pragma comment (linker, EXPORT_SYMBOL(gf_m2ts_program_stream_add) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_m2ts_mux_update_config) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_m2ts_mux_process) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_m2ts_mux_set_packet_buffer) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_m2ts_get_sys_clock) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_m2ts_get_ts_clock) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_m2ts_mux_use_single_au_pes_mode) )
@@ -2119,7 +2140,14 @@
 /* M3U8 & MPD related functions */
 #pragma comment (linker, EXPORT_SYMBOL(gf_mpd_new) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_mpd_init_from_dom) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_mpd_init_from_file) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_mpd_apply_patch) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_mpd_del) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_mpd_period_new) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_mpd_period_free) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_mpd_adaptation_set_new) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_mpd_representation_new) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_mpd_segmentimeline_new) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_m3u8_to_mpd) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_mpd_smooth_to_mpd) )
 
@@ -2129,6 +2157,7 @@
 #pragma comment (linker, EXPORT_SYMBOL(gf_m3u8_parse_master_playlist) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_mpd_write) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_mpd_write_file) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_mpd_write_m3u8_master_playlist) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_mpd_get_base_url_count) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_mpd_resolve_url) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_mpd_get_duration) )
@@ -2252,6 +2281,7 @@
 #pragma comment (linker, EXPORT_SYMBOL(gf_dash_is_in_setup) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_dash_group_discard_segment) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_dash_group_get_next_segment_location) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_dash_group_get_upcoming_segment) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_dash_set_group_done) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_dash_in_period_setup) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_dash_seek) )
@@ -2628,6 +2658,8 @@
 #pragma comment (linker, EXPORT_SYMBOL(gf_filter_pck_new_alloc_destructor ) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_filter_pck_new_shared_internal ) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_filter_pck_new_shared ) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_filter_pck_new_shared_ctx ) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_filter_pck_get_destructor_ctx ) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_filter_pck_new_ref ) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_filter_pck_new_ref_destructor ) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_filter_pck_new_frame_interface) )
@@ -333,7 +333,6 @@ GF_Filter *gf_filter_new(GF_FilterSession *fsess, const GF_FilterRegister *freg,
 
 	if (! (filter->session->flags & GF_FS_FLAG_NO_RESERVOIR)) {
 		filter->pcks_shared_reservoir = gf_fq_new(filter->pcks_mx);
-		filter->pcks_alloc_reservoir = gf_fq_new(filter->pcks_mx);
 		filter->pcks_inst_reservoir = gf_fq_new(filter->pcks_mx);
 	}
 
@@ -681,8 +680,6 @@ void gf_filter_del(GF_Filter *filter)
 		gf_fq_del(filter->pcks_shared_reservoir, gf_void_del);
 	if (filter->pcks_inst_reservoir)
 		gf_fq_del(filter->pcks_inst_reservoir, gf_void_del);
-	if (filter->pcks_alloc_reservoir)
-		gf_fq_del(filter->pcks_alloc_reservoir, gf_filterpacket_del);
 
 	gf_mx_del(filter->pcks_mx);
 	if (filter->tasks_mx)
@@ -73,81 +73,121 @@ GF_Err gf_filter_pck_merge_properties(GF_FilterPacket *pck_src, GF_FilterPacket
 	return gf_filter_pck_merge_properties_filter(pck_src, pck_dst, NULL, NULL);
 }
 
-typedef struct
+//get size class of a packet: class N holds blocks in [2^(N+GF_PCK_ARENA_MIN_LOG2), 2^(N+GF_PCK_ARENA_MIN_LOG2+1)[
+static u32 gf_filter_pck_arena_class(u32 size)
+{
+	u32 log2 = 0;
+	while (size >>= 1) log2++;
+	if (log2 <= GF_PCK_ARENA_MIN_LOG2) return 0;
+	log2 -= GF_PCK_ARENA_MIN_LOG2;
+	if (log2 >= GF_PCK_ARENA_NB_CLASSES) return GF_PCK_ARENA_NB_CLASSES-1;
+	return log2;
+}
+
+static GF_FilterPckArena *gf_filter_pck_arena_new(GF_FilterPid *pid)
+{
+	u32 i;
+	GF_FilterPckArena *arena;
+	GF_SAFEALLOC(arena, GF_FilterPckArena);
+	if (!arena) return NULL;
+	for (i=0; i<GF_PCK_ARENA_NB_CLASSES; i++) {
+		arena->classes[i] = gf_fq_new(pid->filter->pcks_mx);
+		if (!arena->classes[i]) {
+			gf_filter_pck_arena_del(arena);
+			return NULL;
+		}
+	}
+	arena->max_footprint = pid->filter->session->pck_arena_max_size;
+	return arena;
+}
+
+void gf_filter_pck_arena_del(GF_FilterPckArena *arena)
 {
-	u32 data_size;
-	GF_FilterPacket *pck;
-	GF_FilterPacket *closest;
-} GF_PckQueueEnum;
+	u32 i;
+	for (i=0; i<GF_PCK_ARENA_NB_CLASSES; i++) {
+		if (arena->classes[i])
+			gf_fq_del(arena->classes[i], gf_filterpacket_del);
+	}
+	gf_free(arena);
+}
 
-static void pck_queue_enum(void *udta, void *item)
+//returns GF_TRUE if the packet was stored in the arena, GF_FALSE if the caller must destroy it
+static Bool gf_filter_pck_arena_recycle(GF_FilterPid *pid, GF_FilterPacket *pck)
 {
-	GF_PckQueueEnum *enum_state = (GF_PckQueueEnum *) udta;
-	GF_FilterPacket *cur = (GF_FilterPacket *) item;
+	u32 footprint, nb_pck, max_pck;
+	GF_FilterPckArena *arena = pid->arena;
+	if (!arena) return GF_FALSE;
 
-	if (cur->alloc_size >= enum_state->data_size) {
-		if (!enum_state->pck || (enum_state->pck->alloc_size > cur->alloc_size)) {
-			enum_state->pck = cur;
-		}
-	}
-	else if (!enum_state->closest) enum_state->closest = cur;
-	//small data blocks, find smaller one
-	else if (enum_state->data_size<1000) {
-		if (enum_state->closest->alloc_size > cur->alloc_size) enum_state->closest = cur;
+	//file PIDs only keep a single buffer
+	max_pck = (pid->stream_type==GF_STREAM_FILE) ? 1 : GF_PCK_ARENA_MAX_PCK;
+	nb_pck = safe_int_inc(&arena->nb_pck);
+	safe_int_add(&arena->footprint, pck->alloc_size);
+	footprint = arena->footprint;
+	//a single packet may exceed the memory cap, so that large frames are still recycled
+	if ((nb_pck > max_pck)
+		|| ((nb_pck>1) && (footprint > arena->max_footprint))
+		|| gf_fq_res_add(arena->classes[gf_filter_pck_arena_class(pck->alloc_size)], pck)
+	) {
+		safe_int_sub(&arena->footprint, pck->alloc_size);
+		safe_int_dec(&arena->nb_pck);
+		safe_int_inc(&arena->nb_evictions);
+		return GF_FALSE;
 	}
-	//otherwise find largest one below our target size
-	else if (enum_state->closest->alloc_size < cur->alloc_size) enum_state->closest = cur;
+	//not atomic, only used for stats
+	if (footprint > arena->peak_footprint)
+		arena->peak_footprint = footprint;
+	return GF_TRUE;
 }
 
 static GF_FilterPacket *gf_filter_pck_new_alloc_internal(GF_FilterPid *pid, u32 data_size, u8 **data)
 {
 	GF_FilterPacket *pck=NULL;
-	GF_FilterPacket *closest=NULL;
-	u32 count, max_reservoir_size;
 
 	if (PID_IS_INPUT(pid)) {
 		GF_LOG(GF_LOG_ERROR, GF_LOG_FILTER, ("Attempt to allocate a packet on an input PID in filter %s\n", pid->filter->name));
 		return NULL;
 	}
 
-	count = gf_fq_count(pid->filter->pcks_alloc_reservoir);
-
-	if (count) {
-		//don't let reservoir grow too large (may happen if burst of packets are stored/consumed in the upper chain)
-		while (count>30) {
-			GF_FilterPacket *head_pck = gf_fq_pop(pid->filter->pcks_alloc_reservoir);
-			gf_free(head_pck->data);
-			gf_free(head_pck);
-			count--;
-		}
-
-		GF_PckQueueEnum pck_enum_state;
-		memset(&pck_enum_state, 0, sizeof(GF_PckQueueEnum));
-		pck_enum_state.data_size = data_size;
-		gf_fq_enum(pid->filter->pcks_alloc_reservoir, pck_queue_enum, &pck_enum_state);
-		pck = pck_enum_state.pck;
-		closest = pck_enum_state.closest;
+	if (!pid->arena && !(pid->filter->session->flags & GF_FS_FLAG_NO_RESERVOIR)) {
+		pid->arena = gf_filter_pck_arena_new(pid);
 	}
 
-	//stop allocating after a while - TODO we for sure can design a better algo...
-	max_reservoir_size = pid->num_destinations ? 10 : 1;
-	//if pid is file, force 1 max
-	if (!pck && (pid->stream_type==GF_STREAM_FILE))
-		max_reservoir_size = 1;
-
-	if (!pck && (count>=max_reservoir_size)) {
-		if (!closest) return NULL;
-		closest->alloc_size = data_size;
-		closest->data = gf_realloc(closest->data, closest->alloc_size);
-		if (!closest->data) {
-			gf_free(closest);
-			GF_LOG(GF_LOG_ERROR, GF_LOG_FILTER, ("Failed to allocate new packet on PID %s of filter %s\n", pid->name, pid->filter->name));
-			return NULL;
-		}
-		pck = closest;
+	//only the filter owning the PID pops from the arena, other filters only push to it
+	if (pid->arena) {
+		GF_FilterPckArena *arena = pid->arena;
+		u32 cls = gf_filter_pck_arena_class(data_size);
+		pck = gf_fq_pop(arena->classes[cls]);
+		//blocks in the same class may be smaller than requested size
+		if (pck && (pck->alloc_size < data_size)) {
+			char *new_data = gf_realloc(pck->data, data_size);
+			safe_int_sub(&arena->footprint, pck->alloc_size);
+			safe_int_dec(&arena->nb_pck);
+			if (!new_data) {
+				gf_filterpacket_del(pck);
+				GF_LOG(GF_LOG_ERROR, GF_LOG_FILTER, ("Failed to allocate new packet on PID %s of filter %s\n", pid->name, pid->filter->name));
+				return NULL;
+			}
+			pck->data = new_data;
+			pck->alloc_size = data_size;
+			arena->nb_misses++;
 #ifdef GPAC_MEMORY_TRACKING
-		pid->filter->session->nb_realloc_pck++;
+			pid->filter->session->nb_realloc_pck++;
 #endif
+		} else if (pck) {
+			safe_int_sub(&arena->footprint, pck->alloc_size);
+			safe_int_dec(&arena->nb_pck);
+			arena->nb_hits++;
+		}
+		//any block in the next class is large enough
+		else if (cls+1 < GF_PCK_ARENA_NB_CLASSES) {
+			pck = gf_fq_pop(arena->classes[cls+1]);
+			if (pck) {
+				safe_int_sub(&arena->footprint, pck->alloc_size);
+				safe_int_dec(&arena->nb_pck);
+				arena->nb_hits++;
+			}
+		}
+		if (!pck) arena->nb_misses++;
 	}
 
 	if (!pck) {
@@ -166,20 +206,6 @@ static GF_FilterPacket *gf_filter_pck_new_alloc_internal(GF_FilterPid *pid, u32
 #ifdef GPAC_MEMORY_TRACKING
 		pid->filter->session->nb_alloc_pck+=2;
 #endif
-	} else {
-		//pop first item and swap pointers. We can safely do this since this filter
-		//is the only one accessing the queue in pop mode, all others are just pushing to it
-		//this may however imply that we don't get the best matching block size if new packets
-		//were added to the list
-
-		GF_FilterPacket *head_pck = gf_fq_pop(pid->filter->pcks_alloc_reservoir);
-		char *pck_data = pck->data;
-		u32 alloc_size = pck->alloc_size;
-		pck->data = head_pck->data;
-		pck->alloc_size = head_pck->alloc_size;
-		head_pck->data = pck_data;
-		head_pck->alloc_size = alloc_size;
-		pck = head_pck;
 	}
 
 	pck->pck = pck;
@@ -197,6 +223,27 @@ GF_FilterPacket *gf_filter_pck_new_alloc(GF_FilterPid *pid, u32 data_size, u8 **
 	return gf_filter_pck_new_alloc_internal(pid, data_size, data);
 }
 
+//discard all recycled packets of the filter, used when the filter moves to another NUMA node so that
+//new packets memory is allocated (first touched) by a thread of the new node
+void gf_filter_pck_reservoir_reset(GF_Filter *filter)
+{
+	u32 i, j, count;
+	gf_mx_p(filter->tasks_mx);
+	count = gf_list_count(filter->output_pids);
+	for (i=0; i<count; i++) {
+		GF_FilterPid *pid = gf_list_get(filter->output_pids, i);
+		if (!pid->arena) continue;
+		for (j=0; j<GF_PCK_ARENA_NB_CLASSES; j++) {
+			GF_FilterPacket *pck;
+			while ((pck = gf_fq_pop(pid->arena->classes[j]))) {
+				safe_int_sub(&pid->arena->footprint, pck->alloc_size);
+				gf_filterpacket_del(pck);
+			}
+		}
+	}
+	gf_mx_v(filter->tasks_mx);
+}
+
 static GF_FilterPacket *gf_filter_pck_new_dangling_packet(GF_FilterPacket *cached_pck, u32 data_length)
 {
 	GF_FilterPacket *dst;
@@ -464,6 +511,7 @@ GF_FilterPacket *gf_filter_pck_new_shared_internal(GF_FilterPid *pid, const u8 *
 	pck->data = (char *) data;
 	pck->data_length = data_size;
 	pck->destructor = destruct;
+	pck->destructor_ctx = NULL;
 	pck->filter_owns_mem = 1;
 	if (!intern_pck) {
 		safe_int_inc(&pid->nb_shared_packets_out);
@@ -483,6 +531,21 @@ GF_FilterPacket *gf_filter_pck_new_shared(GF_FilterPid *pid, const u8 *data, u32
 	return gf_filter_pck_new_shared_internal(pid, data, data_size, destruct, GF_FALSE);
 }
 
+GF_EXPORT
+GF_FilterPacket *gf_filter_pck_new_shared_ctx(GF_FilterPid *pid, const u8 *data, u32 data_size, gf_fsess_packet_destructor destruct, void *destruct_ctx)
+{
+	GF_FilterPacket *pck = gf_filter_pck_new_shared_internal(pid, data, data_size, destruct, GF_FALSE);
+	if (pck) pck->destructor_ctx = destruct_ctx;
+	return pck;
+}
+
+GF_EXPORT
+void *gf_filter_pck_get_destructor_ctx(GF_FilterPacket *pck)
+{
+	if (!pck || PCK_IS_INPUT(pck)) return NULL;
+	return pck->destructor_ctx;
+}
+
 GF_EXPORT
 GF_FilterPacket *gf_filter_pck_new_ref_destructor(GF_FilterPid *pid, u32 data_offset, u32 data_size, GF_FilterPacket *reference, gf_fsess_packet_destructor destruct)
 {
@@ -704,7 +767,7 @@ void gf_filter_packet_destroy(GF_FilterPacket *pck)
 			gf_free(pck);
 		}
 	} else {
-		if (!pid->filter || gf_fq_res_add(pid->filter->pcks_alloc_reservoir, pck)) {
+		if (!pid->filter || !gf_filter_pck_arena_recycle(pid, pck)) {
 			if (pck->data) gf_free(pck->data);
 			gf_free(pck);
 		}
@@ -1284,6 +1347,7 @@ GF_Err gf_filter_pck_send_internal(GF_FilterPacket *pck, Bool from_filter)
 					inst->pck->reference_count = 0;
 					inst->pck->reference = NULL;
 					inst->pck->destructor = NULL;
+					inst->pck->destructor_ctx = NULL;
 					inst->pck->frame_ifce = NULL;
 					if (pck->props) {
 						GF_Err e;
@@ -1456,6 +1520,7 @@ GF_Err gf_filter_pck_ref_props(GF_FilterPacket **pck)
 	npck->data = NULL;
 	npck->filter_owns_mem = 0;
 	npck->destructor = NULL;
+	npck->destructor_ctx = NULL;
 	gf_filter_pck_reset_props(npck, pid);
 	npck->info = srcpck->info;
 	npck->info.flags |= GF_PCKF_PROPS_REFERENCE;
@@ -5824,6 +5824,9 @@ void gf_filter_pid_del(GF_FilterPid *pid)
 			gf_props_del(pid->infos);
 		}
 	}
+	if (pid->arena)
+		gf_filter_pck_arena_del(pid->arena);
+
 	if (pid->name) gf_free(pid->name);
 	gf_free(pid);
 }
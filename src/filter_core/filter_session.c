@@ -37,6 +37,82 @@ struct _gf_ft_mgr *gf_font_manager_new();
 void gf_font_manager_del(struct _gf_ft_mgr *fm);
 #endif
 
+//get number of tasks in secondary task lists (shared list and per-thread lists in work-stealing mode)
+static u32 gf_fs_secondary_tasks_count(GF_FilterSession *fsess)
+{
+	u32 nb_tasks = gf_fq_count(fsess->tasks);
+#ifndef GPAC_DISABLE_THREADS
+	if (fsess->work_steal) {
+		u32 i, count = gf_list_count(fsess->threads);
+		for (i=0; i<count; i++) {
+			GF_SessionThread *sth = gf_list_get(fsess->threads, i);
+			nb_tasks += gf_fq_count(sth->tasks);
+		}
+	}
+#endif
+	return nb_tasks;
+}
+
+//post a task to the secondary task list. In work-stealing mode, filter tasks are posted to the task list of the thread
+//the filter is pinned to or of the thread which last processed the filter, so that filter data stays hot in that thread cache
+static void gf_fs_push_secondary_task(GF_FilterSession *fsess, GF_FSTask *task)
+{
+#ifndef GPAC_DISABLE_THREADS
+	if (fsess->work_steal && task->filter) {
+		u32 th_idx = task->filter->restrict_th_idx ? task->filter->restrict_th_idx : task->filter->last_th_idx;
+		if (th_idx) {
+			GF_SessionThread *sth = gf_list_get(fsess->threads, th_idx-1);
+			if (sth && sth->tasks) {
+				gf_fq_add(sth->tasks, task);
+				return;
+			}
+		}
+	}
+#endif
+	gf_fq_add(fsess->tasks, task);
+}
+
+//get next task from the secondary task lists. In work-stealing mode, the thread task list is checked first, then the shared list,
+//then the task lists of other threads
+static GF_FSTask *gf_fs_pop_secondary_task(GF_FilterSession *fsess, GF_SessionThread *sess_thread, u32 thid)
+{
+	GF_FSTask *task;
+#ifndef GPAC_DISABLE_THREADS
+	u32 i, count, pass;
+	if (!fsess->work_steal)
+		return gf_fq_pop(fsess->tasks);
+
+	if (sess_thread->tasks) {
+		task = gf_fq_pop(sess_thread->tasks);
+		if (task) return task;
+	}
+	task = gf_fq_pop(fsess->tasks);
+	if (task) return task;
+
+	//steal from other threads, starting with the thread following us
+	//if threads are pinned to different NUMA nodes, first try stealing from threads on our node
+	count = gf_list_count(fsess->threads);
+	for (pass=fsess->numa_aware ? 0 : 1; pass<2; pass++) {
+		for (i=0; i<count; i++) {
+			GF_SessionThread *sth = gf_list_get(fsess->threads, (thid+i) % count);
+			if (sth == sess_thread) continue;
+			if (!pass && (sth->numa_node != sess_thread->numa_node)) continue;
+			task = gf_fq_pop(sth->tasks);
+			if (task) {
+				sess_thread->nb_steals++;
+				//same numbering as session stats: main thread is 1, thread at index N in the list is N+2
+				GF_LOG(GF_LOG_DEBUG, GF_LOG_SCHEDULER, ("Thread %u stole task %s::%s from thread %u\n", thid+1, task->filter ? task->filter->name : "none", task->log_name, 2 + (thid+i) % count));
+				return task;
+			}
+		}
+	}
+	return NULL;
+#else
+	task = gf_fq_pop(fsess->tasks);
+	return task;
+#endif
+}
+
 static GFINLINE void gf_fs_sema_io(GF_FilterSession *fsess, Bool notify, Bool main)
 {
 	//we don't use sema on emscripten, we always give control back to main caller or pthread
@@ -60,7 +136,7 @@ static GFINLINE void gf_fs_sema_io(GF_FilterSession *fsess, Bool notify, Bool ma
 			nb_tasks = 1;
 			//no active threads, count number of tasks. If no posted tasks we are likely at the end of the session, don't block, rather use a sem_wait 
 			if (!fsess->active_threads)
-			 	nb_tasks = gf_fq_count(fsess->main_thread_tasks) + gf_fq_count(fsess->tasks);
+			 	nb_tasks = gf_fq_count(fsess->main_thread_tasks) + gf_fs_secondary_tasks_count(fsess);
 
 			//if main semaphore, keep track that we are going to sleep
 			if (main) {
@@ -204,6 +280,74 @@ static Bool fs_check_locales(void *__self, const char *locales_parent_path, cons
 #include <emscripten/threading.h>
 #endif
 
+#ifndef GPAC_DISABLE_THREADS
+//assign core sets to session threads, thread N (main thread being thread 0) is pinned to set N modulo the number of sets
+//a set is either a core index or a range of core indexes "first-last"
+static void gf_fs_setup_thread_cores(GF_FilterSession *fsess, const char *core_sets)
+{
+	u32 i, nb_sets=0, nb_alloc=0, count;
+	u32 *sets = NULL;
+	u32 first_node = 0;
+	char *str = gf_strdup(core_sets);
+	char *cur = str;
+
+	while (cur && cur[0]) {
+		u32 start, end;
+		char *sep = strchr(cur, ',');
+		if (sep) sep[0] = 0;
+		if (sscanf(cur, "%u-%u", &start, &end)!=2) {
+			if (sscanf(cur, "%u", &start)!=1) {
+				GF_LOG(GF_LOG_ERROR, GF_LOG_SCHEDULER, ("Invalid core set %s, ignoring thread pinning\n", cur));
+				nb_sets = 0;
+				break;
+			}
+			end = start;
+		}
+		if (end<start) {
+			u32 tmp = start;
+			start = end;
+			end = tmp;
+		}
+		if (nb_sets+1 > nb_alloc) {
+			nb_alloc = nb_alloc ? 2*nb_alloc : 8;
+			sets = gf_realloc(sets, sizeof(u32)*2*nb_alloc);
+		}
+		sets[2*nb_sets] = start;
+		sets[2*nb_sets+1] = end;
+		nb_sets++;
+		if (!sep) break;
+		cur = sep+1;
+	}
+	gf_free(str);
+
+	count = gf_list_count(fsess->threads);
+	for (i=0; nb_sets && (i<=count); i++) {
+		u32 j, start, end;
+		GF_SessionThread *sth = i ? gf_list_get(fsess->threads, i-1) : &fsess->main_th;
+		//don't pin the caller thread in non-blocking mode
+		if (!i && fsess->non_blocking) continue;
+
+		start = sets[2*(i % nb_sets)];
+		end = sets[2*(i % nb_sets) + 1];
+		sth->nb_cores = end - start + 1;
+		sth->cores = gf_malloc(sizeof(u32) * sth->nb_cores);
+		for (j=0; j<sth->nb_cores; j++)
+			sth->cores[j] = start + j;
+
+		//a set spanning several NUMA nodes has no node
+		sth->numa_node = 1 + gf_th_get_core_numa_node(start);
+		for (j=1; sth->numa_node && (j<sth->nb_cores); j++) {
+			if (1 + gf_th_get_core_numa_node(sth->cores[j]) != sth->numa_node)
+				sth->numa_node = 0;
+		}
+		if (!sth->numa_node) continue;
+		if (!first_node) first_node = sth->numa_node;
+		else if (first_node != sth->numa_node) fsess->numa_aware = GF_TRUE;
+	}
+	if (sets) gf_free(sets);
+}
+#endif
+
 GF_EXPORT
 GF_FilterSession *gf_fs_new(s32 nb_threads, GF_FilterSchedulerType sched_type, GF_FilterSessionFlags flags, const char *blacklist)
 {
@@ -211,6 +355,7 @@ GF_FilterSession *gf_fs_new(s32 nb_threads, GF_FilterSchedulerType sched_type, G
 	Bool gf_sys_has_filter_global_args();
 	Bool gf_sys_has_filter_global_meta_args();
 	u32 i;
+	u64 arena_size;
 	GF_FilterSession *fsess, *a_sess;
 
 	GF_SAFEALLOC(fsess, GF_FilterSession);
@@ -307,6 +452,7 @@ GF_FilterSession *gf_fs_new(s32 nb_threads, GF_FilterSchedulerType sched_type, G
 			nb_threads=0;
 		}
 		fsess->use_locks = (sched_type==GF_FS_SCHEDULER_LOCK) ? GF_TRUE : GF_FALSE;
+		fsess->work_steal = (sched_type==GF_FS_SCHEDULER_WORK_STEAL) ? GF_TRUE : GF_FALSE;
 	} else
 #endif
 	{
@@ -364,8 +510,18 @@ GF_FilterSession *gf_fs_new(s32 nb_threads, GF_FilterSchedulerType sched_type, G
 			continue;
 		}
 		sess_thread->fsess = fsess;
+		if (fsess->work_steal) {
+			//each thread list has its own mutex, only contended when posting from another thread or stealing
+			sess_thread->tasks_mx = gf_mx_new("ThreadTasksList");
+			sess_thread->tasks = gf_fq_new(sess_thread->tasks_mx);
+		}
 		gf_list_add(fsess->threads, sess_thread);
 	}
+
+	opt = gf_opts_get_key("core", "th-cores");
+	//also done without secondary threads, to pin the main thread
+	if (opt)
+		gf_fs_setup_thread_cores(fsess, opt);
 #endif
 
 	gf_fs_set_separators(fsess, NULL);
@@ -403,6 +559,9 @@ GF_FilterSession *gf_fs_new(s32 nb_threads, GF_FilterSchedulerType sched_type, G
 	fsess->default_pid_buffer_max_us = gf_opts_get_int("core", "buffer-gen");
 	fsess->decoder_pid_buffer_max_us = gf_opts_get_int("core", "buffer-dec");
 	fsess->default_pid_buffer_max_units = gf_opts_get_int("core", "buffer-units");
+	//arena footprint is tracked with 32-bit atomics, clamp
+	arena_size = 1000 * (u64) gf_opts_get_int("core", "pck-arena");
+	fsess->pck_arena_max_size = (u32) MIN(arena_size, GF_INT_MAX);
 	fsess->max_resolve_chain_len = 6;
 	fsess->auto_inc_nums = gf_list_new();
 	if (gf_opts_get_bool("core", "check-props"))
@@ -541,6 +700,7 @@ GF_FilterSession *gf_fs_new_defaults(GF_FilterSessionFlags inflags)
 	else if (!strcmp(opt, "direct")) sched_type = GF_FS_SCHEDULER_DIRECT;
 	else if (!strcmp(opt, "free")) sched_type = GF_FS_SCHEDULER_LOCK_FREE;
 	else if (!strcmp(opt, "freex")) sched_type = GF_FS_SCHEDULER_LOCK_FREE_X;
+	else if (!strcmp(opt, "steal")) sched_type = GF_FS_SCHEDULER_WORK_STEAL;
 	else {
 		GF_LOG(GF_LOG_ERROR, GF_LOG_FILTER, ("Unrecognized scheduler type %s\n", opt));
 		return NULL;
@@ -821,11 +981,19 @@ void gf_fs_del(GF_FilterSession *fsess)
 		while (gf_list_count(fsess->threads)) {
 			GF_SessionThread *sess_th = gf_list_pop_back(fsess->threads);
 			gf_th_del(sess_th->th);
+			if (sess_th->tasks)
+				gf_fq_del(sess_th->tasks, gf_task_del);
+			if (sess_th->tasks_mx)
+				gf_mx_del(sess_th->tasks_mx);
+			if (sess_th->cores)
+				gf_free(sess_th->cores);
 			gf_free(sess_th);
 		}
 		gf_list_del(fsess->threads);
 	}
 #endif
+	if (fsess->main_th.cores)
+		gf_free(fsess->main_th.cores);
 
 	if (fsess->prop_maps_reservoir)
 		gf_fq_del(fsess->prop_maps_reservoir, gf_propmap_del);
@@ -1063,7 +1231,7 @@ void gf_fs_post_task_ex(GF_FilterSession *fsess, gf_fs_task_callback task_fun, G
 			gf_fs_sema_io(fsess, GF_TRUE, GF_TRUE);
 		} else {
 			gf_assert(task->run_task);
-			gf_fq_add(fsess->tasks, task);
+			gf_fs_push_secondary_task(fsess, task);
 			gf_fs_sema_io(fsess, GF_TRUE, GF_FALSE);
 		}
 	}
@@ -1547,6 +1715,18 @@ void gf_fs_print_debug_info(GF_FilterSession *fsess, GF_SessionDebugFlag dbg_fla
 			i=0;
 			gf_fq_enum(fsess->tasks, print_task_list, &i);
 		}
+#ifndef GPAC_DISABLE_THREADS
+		if (fsess->work_steal) {
+			count = gf_list_count(fsess->threads);
+			for (i=0; i<count; i++) {
+				u32 j=0;
+				GF_SessionThread *sth = gf_list_get(fsess->threads, i);
+				if (!gf_fq_count(sth->tasks)) continue;
+				fprintf(stderr, "Thread %u tasks:\n", i+2);
+				gf_fq_enum(sth->tasks, print_task_list, &j);
+			}
+		}
+#endif
 	}
 
 	if (dbg_flags & GF_FS_DEBUG_FILTERS) {
@@ -1690,6 +1870,15 @@ static u32 gf_fs_thread_proc(GF_SessionThread *sess_thread)
 #ifndef GPAC_DISABLE_REMOTERY
 		gf_rmt_set_thread_name(sess_thread->rmt_name);
 #endif
+		//the main thread is pinned for the duration of gf_fs_run only
+		if (sess_thread->nb_cores && thid) {
+			if (gf_th_set_affinity(NULL, sess_thread->cores, sess_thread->nb_cores)==GF_OK) {
+				GF_LOG(GF_LOG_INFO, GF_LOG_SCHEDULER, ("Thread %s pinned to cores %u-%u (NUMA node %d)\n", sys_thid, sess_thread->cores[0], sess_thread->cores[sess_thread->nb_cores-1], (s32) sess_thread->numa_node - 1));
+			} else {
+				//don't prefer same-node steals if we couldn't pin threads
+				fsess->numa_aware = GF_FALSE;
+			}
+		}
 	}
 
 #ifndef GPAC_DISABLE_REMOTERY
@@ -1751,10 +1940,10 @@ static u32 gf_fs_thread_proc(GF_SessionThread *sess_thread)
 					task = gf_fq_pop(fsess->main_thread_tasks);
 				}
 				if (!task) {
-					task = gf_fq_pop(fsess->tasks);
+					task = gf_fs_pop_secondary_task(fsess, sess_thread, thid);
 					//if task is blocking, don't use it, let a secondary thread deal with it
 					if (task && task->blocking) {
-						gf_fq_add(fsess->tasks, task);
+						gf_fs_push_secondary_task(fsess, task);
 						task = NULL;
 						gf_fs_sema_io(fsess, GF_TRUE, GF_FALSE);
 					}
@@ -1769,7 +1958,7 @@ static u32 gf_fs_thread_proc(GF_SessionThread *sess_thread)
 				}
 #endif
 			} else {
-				task = gf_fq_pop(fsess->tasks);
+				task = gf_fs_pop_secondary_task(fsess, sess_thread, thid);
 				if (task && (task->force_main || (task->filter && task->filter->nb_main_thread_forced) ) ) {
 					//post to main
 					gf_fq_add(fsess->main_thread_tasks, task);
@@ -1843,7 +2032,7 @@ static u32 gf_fs_thread_proc(GF_SessionThread *sess_thread)
 
 			//no pending tasks and first time main task queue is empty, flush to detect if we
 			//are indeed done
-			if (!fsess->tasks_pending && !fsess->tasks_in_process && !sess_thread->has_seen_eot && !gf_fq_count(fsess->tasks)) {
+			if (!fsess->tasks_pending && !fsess->tasks_in_process && !sess_thread->has_seen_eot && !gf_fs_secondary_tasks_count(fsess)) {
 				//maybe last task, force a notify to check if we are truly done
 				sess_thread->has_seen_eot = GF_TRUE;
 				//not main thread and some tasks pending on main, notify only ourselves
@@ -1900,16 +2089,19 @@ static u32 gf_fs_thread_proc(GF_SessionThread *sess_thread)
 		current_filter = task->filter;
 
 		//unless task was explicitly forced to main (pid init mostly), reschedule if filter is not on desired thread
+		//or if filter is bound to another NUMA node
 		if (current_filter && !task->force_main
-			&& current_filter->restrict_th_idx
-			&& (thid != current_filter->restrict_th_idx)
+			&& ((current_filter->restrict_th_idx && (thid != current_filter->restrict_th_idx))
+				|| (!current_filter->restrict_th_idx && fsess->numa_aware && sess_thread->numa_node
+					&& current_filter->numa_node && (current_filter->numa_node != sess_thread->numa_node))
+			)
 		) {
 			//reschedule task to secondary list
 			if (!task->notified) {
 				task->notified = GF_TRUE;
 				safe_int_inc(&fsess->tasks_pending);
 			}
-			gf_fq_add(fsess->tasks, task);
+			gf_fs_push_secondary_task(fsess, task);
 			gf_fs_sema_io(fsess, GF_TRUE, GF_FALSE);
 #ifndef GPAC_DISABLE_LOG
 			gf_log_pop_extra(current_filter->logs);
@@ -2109,7 +2301,7 @@ static u32 gf_fs_thread_proc(GF_SessionThread *sess_thread)
 							}
 						} else {
 							pending_tasks = gf_fq_count(fsess->main_thread_tasks);
-							gf_fq_add(fsess->tasks, task);
+							gf_fs_push_secondary_task(fsess, task);
 							//we are not the main thread and we are reposting to the secondary task list, don't notify/wait for the sema, just retry
 							//we are not sure to get a task from secondary list at next iteration, but the end of thread check will make
 							//sure we renotify secondary sema if some tasks are still pending
@@ -2151,6 +2343,21 @@ static u32 gf_fs_thread_proc(GF_SessionThread *sess_thread)
 			gf_assert(!current_filter->in_process);
 			current_filter->in_process = GF_TRUE;
 			current_filter->process_th_id = gf_th_id();
+			//remember which thread processed the filter last, tasks for this filter will be posted on this thread
+			if (fsess->work_steal)
+				current_filter->last_th_idx = thid;
+
+			//bind filter to the NUMA node of the first pinned thread processing it
+			if (fsess->numa_aware && sess_thread->numa_node && (current_filter->numa_node != sess_thread->numa_node)) {
+				//filter moved to another NUMA node (main thread or restricted thread task), discard recycled packets so that new packets are allocated on this node
+				if (current_filter->numa_node) {
+					current_filter->nb_numa_migrations++;
+					safe_int_inc(&fsess->nb_numa_migrations);
+					gf_filter_pck_reservoir_reset(current_filter);
+					GF_LOG(GF_LOG_DEBUG, GF_LOG_SCHEDULER, ("Thread %s: filter %s migrated from NUMA node %u to node %u\n", sys_thid, current_filter->name, current_filter->numa_node-1, sess_thread->numa_node-1));
+				}
+				current_filter->numa_node = sess_thread->numa_node;
+			}
 		}
 
 		sess_thread->nb_tasks++;
@@ -2331,12 +2538,12 @@ static u32 gf_fs_thread_proc(GF_SessionThread *sess_thread)
 #ifndef GPAC_DISABLE_THREADS
 					//FIXME, we sometimes miss a sema notify resulting in secondary tasks being locked
 					//until we find the cause, notify secondary sema if non-main-thread tasks are scheduled and we are the only task in main
-					if (use_main_sema && (thid==0) && fsess->threads && (gf_fq_count(fsess->main_thread_tasks)==1) && gf_fq_count(fsess->tasks)) {
+					if (use_main_sema && (thid==0) && fsess->threads && (gf_fq_count(fsess->main_thread_tasks)==1) && gf_fs_secondary_tasks_count(fsess)) {
 						gf_fs_sema_io(fsess, GF_TRUE, GF_FALSE);
 					}
 #endif
 				} else {
-					gf_fq_add(fsess->tasks, task);
+					gf_fs_push_secondary_task(fsess, task);
 				}
 				gf_fs_sema_io(fsess, GF_TRUE, use_main_sema);
 			}
@@ -2375,7 +2582,7 @@ static u32 gf_fs_thread_proc(GF_SessionThread *sess_thread)
 			current_filter->in_process = GF_FALSE;
 		}
 		//not requeuing and first time we have an empty task queue, flush to detect if we are indeed done
-		if (!current_filter && !fsess->tasks_pending && !sess_thread->has_seen_eot && !gf_fq_count(fsess->tasks)) {
+		if (!current_filter && !fsess->tasks_pending && !sess_thread->has_seen_eot && !gf_fs_secondary_tasks_count(fsess)) {
 			//if not the main thread, or if main thread and task list is empty, enter end of session probing mode
 			if (thid || !gf_fq_count(fsess->main_thread_tasks) ) {
 				//maybe last task, force a notify to check if we are truly done. We only tag "session done" for the non-main
@@ -2471,6 +2678,24 @@ GF_Err gf_fs_run(GF_FilterSession *fsess)
 #endif
 
 
+#ifndef GPAC_DISABLE_THREADS
+	//pin the caller thread for this run only and restore its affinity once done
+	u32 *orig_cores = NULL, nb_orig_cores = 0;
+	if (fsess->main_th.nb_cores && !fsess->non_blocking) {
+		nb_orig_cores = GF_FS_MAX_CORES;
+		orig_cores = gf_malloc(sizeof(u32)*nb_orig_cores);
+		if (gf_th_get_affinity(NULL, orig_cores, &nb_orig_cores) != GF_OK)
+			nb_orig_cores = 0;
+		if (nb_orig_cores && (gf_th_set_affinity(NULL, fsess->main_th.cores, fsess->main_th.nb_cores)==GF_OK)) {
+			GF_LOG(GF_LOG_INFO, GF_LOG_SCHEDULER, ("Main thread pinned to cores %u-%u (NUMA node %d)\n", fsess->main_th.cores[0], fsess->main_th.cores[fsess->main_th.nb_cores-1], (s32) fsess->main_th.numa_node - 1));
+		} else {
+			//don't touch affinity if we cannot restore it
+			nb_orig_cores = 0;
+			fsess->numa_aware = GF_FALSE;
+		}
+	}
+#endif
+
 	//run main thread - for emscripten, we only call if no pending threads
 #ifdef GPAC_CONFIG_EMSCRIPTEN
 	if (!fsess->pending_threads)
@@ -2479,6 +2704,13 @@ GF_Err gf_fs_run(GF_FilterSession *fsess)
 		gf_fs_thread_proc(&fsess->main_th);
 	}
 
+#ifndef GPAC_DISABLE_THREADS
+	if (nb_orig_cores)
+		gf_th_set_affinity(NULL, orig_cores, nb_orig_cores);
+	if (orig_cores)
+		gf_free(orig_cores);
+#endif
+
 	//non blocking mode init, don't wait for other threads
 	if (fsess->non_blocking) {
 		fsess->non_blocking = 2;
@@ -2666,7 +2898,7 @@ GF_Err gf_fs_stop(GF_FilterSession *fsess)
 		if (gf_fq_count(fsess->main_thread_tasks))
 			continue;
 
-		if (count && (count == fsess->nb_threads_stopped) && gf_fq_count(fsess->tasks) ) {
+		if (count && (count == fsess->nb_threads_stopped) && gf_fs_secondary_tasks_count(fsess) ) {
 			continue;
 		}
 		break;
@@ -2793,10 +3025,16 @@ void gf_fs_print_stats(GF_FilterSession *fsess)
 		for (k=0; k<opids; k++) {
 			GF_FilterPid *pid = gf_list_get(f->output_pids, k);
 			GF_LOG(GF_LOG_INFO, GF_LOG_APP, ("\t\t* output PID %s: %d packets sent\n", pid->name, pid->nb_pck_sent));
+			if (pid->arena) {
+				GF_LOG(GF_LOG_INFO, GF_LOG_APP, ("\t\t  packet arena: "LLU" hits "LLU" misses %u evictions - footprint %u bytes (peak %u bytes)\n", pid->arena->nb_hits, pid->arena->nb_misses, pid->arena->nb_evictions, pid->arena->footprint, pid->arena->peak_footprint));
+			}
 		}
 		if (f->nb_errors) {
 			GF_LOG(GF_LOG_INFO, GF_LOG_APP, ("\t\t%d errors while processing\n", f->nb_errors));
 		}
+		if (f->nb_numa_migrations) {
+			GF_LOG(GF_LOG_INFO, GF_LOG_APP, ("\t\t%d NUMA node migrations\n", f->nb_numa_migrations));
+		}
 #endif
 
 		gf_mx_v(f->tasks_mx);
@@ -2821,13 +3059,23 @@ void gf_fs_print_stats(GF_FilterSession *fsess)
 	for (i=0; i<count; i++) {
 		GF_SessionThread *s = gf_list_get(fsess->threads, i);
 
-		GF_LOG(GF_LOG_INFO, GF_LOG_APP, ("\tThread %u: run_time "LLU" us active_time "LLU" us nb_tasks "LLU"\n", i+2, s->run_time, s->active_time, s->nb_tasks));
+		GF_LOG(GF_LOG_INFO, GF_LOG_APP, ("\tThread %u: run_time "LLU" us active_time "LLU" us nb_tasks "LLU, i+2, s->run_time, s->active_time, s->nb_tasks));
+		if (fsess->work_steal) {
+			GF_LOG(GF_LOG_INFO, GF_LOG_APP, (" nb_steals "LLU, s->nb_steals));
+		}
+		if (s->numa_node) {
+			GF_LOG(GF_LOG_INFO, GF_LOG_APP, (" NUMA node %u", s->numa_node-1));
+		}
+		GF_LOG(GF_LOG_INFO, GF_LOG_APP, ("\n"));
 
 		run_time+=s->run_time;
 		active_time+=s->active_time;
 		nb_tasks+=s->nb_tasks;
 	}
 	GF_LOG(GF_LOG_INFO, GF_LOG_APP, ("\nTotal: run_time "LLU" us active_time "LLU" us nb_tasks "LLU"\n", run_time, active_time, nb_tasks));
+	if (fsess->numa_aware) {
+		GF_LOG(GF_LOG_INFO, GF_LOG_APP, ("Filters NUMA node migrations: %u\n", fsess->nb_numa_migrations));
+	}
 #endif
 }
 
@@ -4267,7 +4515,7 @@ Bool gf_fs_is_last_task(GF_FilterSession *fsess)
 	if (!fsess) return GF_TRUE;
 	if (fsess->tasks_pending>1) return GF_FALSE;
 	if (gf_fq_count(fsess->main_thread_tasks)) return GF_FALSE;
-	if (gf_fq_count(fsess->tasks)) return GF_FALSE;
+	if (gf_fs_secondary_tasks_count(fsess)) return GF_FALSE;
 	if (fsess->non_blocking && fsess->tasks_in_process) return GF_FALSE;
 	return GF_TRUE;
 }
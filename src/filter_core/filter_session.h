@@ -127,6 +127,7 @@ typedef void (*gf_destruct_fun)(void *cbck);
 
 //calls gf_free on p, used for LFQ / lists destructors
 void gf_void_del(void *p);
+void gf_filterpacket_del(void *p);
 
 typedef struct __gf_filter_pid_inst GF_FilterPidInst;
 
@@ -254,6 +255,8 @@ struct __gf_filter_pck
 	//for allocated memory packets
 	u32 alloc_size;
 	gf_fsess_packet_destructor destructor;
+	//context of the destructor, set by the filter creating the packet
+	void *destructor_ctx;
 	//for packet reference  packets (sharing data from other packets)
 	struct __gf_filter_pck *reference;
 
@@ -325,6 +328,8 @@ void gf_fs_post_task_class(GF_FilterSession *fsess, gf_fs_task_callback task_fun
 
 void gf_filter_pid_send_event_downstream(GF_FSTask *task);
 
+//max number of cores saved when querying thread affinity
+#define GF_FS_MAX_CORES	1024
 
 typedef struct __gf_fs_thread
 {
@@ -336,9 +341,21 @@ typedef struct __gf_fs_thread
 
 	Bool has_seen_eot; //set when no more tasks in global queue
 
+	//task list of this thread in work-stealing mode, NULL otherwise
+	GF_FilterQueue *tasks;
+	GF_Mutex *tasks_mx;
+
+	//cores this thread is pinned to, NULL if not pinned
+	u32 *cores;
+	u32 nb_cores;
+	//NUMA node of the thread + 1, 0 if unknown or if the cores span several nodes
+	u32 numa_node;
+
 	u64 nb_tasks;
 	u64 run_time;
 	u64 active_time;
+	//number of tasks taken from other threads task lists
+	u64 nb_steals;
 
 #ifndef GPAC_DISABLE_REMOTERY
 	u32 rmt_tasks;
@@ -380,6 +397,11 @@ struct __gf_filter_session
 	u32 flags;
 	Bool use_locks;
 	Bool direct_mode;
+	//per-thread task lists with task stealing
+	Bool work_steal;
+	//session threads are pinned to cores spanning several NUMA nodes
+	Bool numa_aware;
+	volatile u32 nb_numa_migrations;
 	volatile u32 tasks_in_process;
 	Bool requires_solved_graph;
 	//non blocking session mode:
@@ -469,6 +491,8 @@ struct __gf_filter_session
 
 	u32 default_pid_buffer_max_us, decoder_pid_buffer_max_us;
 	u32 default_pid_buffer_max_units;
+	//max memory in bytes kept for packet recycling per PID
+	u32 pck_arena_max_size;
 
 #ifdef GPAC_MEMORY_TRACKING
 	Bool check_allocs;
@@ -649,6 +673,11 @@ struct __gf_filter
 	//set to true when the filter is being processed by a thread
 	volatile Bool in_process;
 	u32 process_th_id, restrict_th_idx;
+	//index (1-based) of the last secondary thread which processed this filter, used in work-stealing mode
+	u32 last_th_idx;
+	//NUMA node + 1 the filter is bound to, 0 if none. Set by the first pinned thread processing the filter
+	u32 numa_node;
+	u32 nb_numa_migrations;
 	//user data for the filter implementation
 	void *filter_udta;
 
@@ -674,8 +703,6 @@ struct __gf_filter
 	u32 num_output_pids;
 	u32 num_out_pids_not_connected;
 
-	//reservoir for packets with allocated memory
-	GF_FilterQueue *pcks_alloc_reservoir;
 	//reservoir for packets with shared memory
 	GF_FilterQueue *pcks_shared_reservoir;
 	//reservoir for packets instances - the ones stored in the pid destination(s) with shared memory
@@ -1057,6 +1084,8 @@ struct __gf_filter_pid
 	volatile Bool props_changed_since_connect;
 	//number of shared packets (shared, frame interfaces or reference) still out there
 	volatile u32 nb_shared_packets_out;
+	//recycled packets with allocated memory, created on first packet allocation
+	struct __gf_filter_pck_arena *arena;
 
 	GF_PropertyMap *infos;
 	
@@ -1211,6 +1240,32 @@ void gf_filter_sess_reset_graph(GF_FilterSession *fsess, const GF_FilterRegister
 Bool gf_fs_ui_event(GF_FilterSession *session, GF_Event *uievt);
 
 GF_Err gf_filter_pck_send_internal(GF_FilterPacket *pck, Bool from_filter);
+void gf_filter_pck_reservoir_reset(GF_Filter *filter);
+
+//packets with allocated memory are recycled per PID in power-of-two size classes
+//class N holds packets with allocated size in [2^(N+GF_PCK_ARENA_MIN_LOG2), 2^(N+GF_PCK_ARENA_MIN_LOG2+1)[, first class holding all smaller packets
+#define GF_PCK_ARENA_MIN_LOG2	6
+#define GF_PCK_ARENA_NB_CLASSES	26
+//max number of packets kept per arena, file PIDs only keep one
+#define GF_PCK_ARENA_MAX_PCK	30
+
+typedef struct __gf_filter_pck_arena
+{
+	GF_FilterQueue *classes[GF_PCK_ARENA_NB_CLASSES];
+	//bytes of packet memory currently kept in the arena - concurrent inc/dec
+	volatile u32 footprint;
+	u32 peak_footprint;
+	//max bytes kept in the arena, packets released above this limit are destroyed unless the arena is empty
+	u32 max_footprint;
+	//number of packets currently kept in the arena - concurrent inc/dec
+	volatile u32 nb_pck;
+	//only modified by the thread allocating packets
+	u64 nb_hits, nb_misses;
+	//number of released packets destroyed because the arena was full - concurrent inc
+	volatile u32 nb_evictions;
+} GF_FilterPckArena;
+
+void gf_filter_pck_arena_del(GF_FilterPckArena *arena);
 
 void gf_filter_pid_send_event_internal(GF_FilterPid *pid, GF_FilterEvent *evt, Bool force_downstream);
 
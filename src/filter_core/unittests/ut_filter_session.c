@@ -0,0 +1,272 @@
+#include "tests.h"
+#include "../filter_session.h"
+
+#define FS_TEST_CHAINS	16
+#define FS_TEST_THREADS	4
+#define FS_TEST_PCKS	500
+
+//FS_TEST_CHAINS source -> filter -> sink chains, returns the number of packets consumed by the sinks
+static u64 fs_test_run(GF_FilterSchedulerType sched, u32 nb_threads, u32 nb_pck, u64 *duration, u64 *nb_steals)
+{
+	u32 i, count;
+	u64 now, nb_recv=0;
+	char szArgs[100];
+	GF_Err e;
+	GF_FilterSession *fs = gf_fs_new(nb_threads, sched, 0, NULL);
+	if (!fs) return 0;
+
+	gf_fs_register_test_filters(fs);
+	sprintf(szArgs, "UTSource:max_pck=%d", nb_pck);
+	for (i=0; i<FS_TEST_CHAINS; i++) {
+		GF_Filter *src, *f, *sink;
+		src = gf_fs_load_filter(fs, szArgs, &e);
+		f = gf_fs_load_filter(fs, "UTFilter", &e);
+		sink = gf_fs_load_filter(fs, "UTSink", &e);
+		if (!src || !f || !sink) break;
+		gf_filter_set_source(f, src, NULL);
+		gf_filter_set_source(sink, f, NULL);
+	}
+	now = gf_sys_clock_high_res();
+	e = gf_fs_run(fs);
+	*duration = gf_sys_clock_high_res() - now;
+	if (e>GF_OK) e = GF_OK;
+
+	count = gf_fs_get_filters_count(fs);
+	for (i=0; i<count; i++) {
+		GF_FilterStats stats;
+		if (gf_fs_get_filter_stats(fs, i, &stats)) continue;
+		if (stats.filter_alias) continue;
+		if (!strcmp(stats.reg_name, "UTSink"))
+			nb_recv += stats.nb_pck_processed;
+	}
+	*nb_steals = 0;
+	count = gf_list_count(fs->threads);
+	for (i=0; i<count; i++) {
+		GF_SessionThread *sth = gf_list_get(fs->threads, i);
+		*nb_steals += sth->nb_steals;
+	}
+	gf_fs_del(fs);
+	return (e==GF_OK) ? nb_recv : 0;
+}
+
+//more filter chains than threads, all packets must reach the sinks and the session must not hang
+unittest(fs_sched_steal_stress)
+{
+	u64 duration, nb_steals;
+	assert_equal(fs_test_run(GF_FS_SCHEDULER_WORK_STEAL, FS_TEST_THREADS, FS_TEST_PCKS, &duration, &nb_steals), FS_TEST_CHAINS*FS_TEST_PCKS);
+	//single thread: no secondary queue, nothing to steal from
+	assert_equal(fs_test_run(GF_FS_SCHEDULER_WORK_STEAL, 0, FS_TEST_PCKS, &duration, &nb_steals), FS_TEST_CHAINS*FS_TEST_PCKS);
+	assert_equal(nb_steals, 0);
+}
+
+//not a pass/fail test beyond packet counts: lock-free shared queue vs per-thread queues with stealing
+unittest(fs_sched_steal_bench)
+{
+	u64 t_lf, t_steal, nb_steals, nb_pck;
+
+	if (!ut_bench_enabled()) return;
+
+	nb_pck = fs_test_run(GF_FS_SCHEDULER_LOCK_FREE, FS_TEST_THREADS, 10*FS_TEST_PCKS, &t_lf, &nb_steals);
+	assert_equal(nb_pck, FS_TEST_CHAINS*10*FS_TEST_PCKS);
+	nb_pck = fs_test_run(GF_FS_SCHEDULER_WORK_STEAL, FS_TEST_THREADS, 10*FS_TEST_PCKS, &t_steal, &nb_steals);
+	assert_equal(nb_pck, FS_TEST_CHAINS*10*FS_TEST_PCKS);
+	printf("(%d chains %d threads: lock-free "LLU" ms, steal "LLU" ms, "LLU" steals) ", FS_TEST_CHAINS, FS_TEST_THREADS, t_lf/1000, t_steal/1000, nb_steals);
+}
+
+#define FS_AFFINITY_FILTERS	8
+#define FS_AFFINITY_CALLS	50
+
+typedef struct
+{
+	u32 nb_calls;
+	u32 cores[GF_FS_MAX_CORES];
+} FSAffinityCtx;
+//filter private data is freed with the session
+static u32 fs_aff_core;
+static volatile u32 fs_aff_nb_calls, fs_aff_nb_pinned;
+
+//checks the affinity of the thread running the filter at each call
+static GF_Err fs_affinity_process(GF_Filter *filter)
+{
+	u32 nb_cores = GF_FS_MAX_CORES;
+	FSAffinityCtx *ctx = gf_filter_get_udta(filter);
+	if (ctx->nb_calls == FS_AFFINITY_CALLS) return GF_EOS;
+	ctx->nb_calls++;
+	safe_int_inc(&fs_aff_nb_calls);
+	if ((gf_th_get_affinity(NULL, ctx->cores, &nb_cores)==GF_OK) && (nb_cores==1) && (ctx->cores[0]==fs_aff_core))
+		safe_int_inc(&fs_aff_nb_pinned);
+	gf_filter_post_process_task(filter);
+	return GF_OK;
+}
+
+static GF_Err fs_affinity_initialize(GF_Filter *filter)
+{
+	gf_filter_post_process_task(filter);
+	return GF_OK;
+}
+
+static GF_FilterRegister FSAffinityRegister = {
+	.name = "UTAffinity",
+	GF_FS_SET_DESCRIPTION("Thread affinity test filter")
+	.private_size = sizeof(FSAffinityCtx),
+	.flags = GF_FS_REG_EXPLICIT_ONLY,
+	.initialize = fs_affinity_initialize,
+	.process = fs_affinity_process,
+};
+
+//all session threads, main thread included, are pinned while the session runs, and the caller thread
+//affinity is restored once the session is done
+unittest(fs_th_cores_pinning)
+{
+	u32 i, nb_before=GF_FS_MAX_CORES, nb_after=GF_FS_MAX_CORES;
+	u32 *before = gf_malloc(sizeof(u32)*GF_FS_MAX_CORES);
+	u32 *after = gf_malloc(sizeof(u32)*GF_FS_MAX_CORES);
+
+	//in-memory config for the th-cores option
+	gf_sys_init(GF_MemTrackerNone, "0");
+	if (gf_th_get_affinity(NULL, before, &nb_before) == GF_OK) {
+		u32 nb_threads;
+		char szCore[20];
+		//pin all threads on the first core we may run on
+		fs_aff_core = before[0];
+		sprintf(szCore, "%u", fs_aff_core);
+		gf_opts_set_key("core", "th-cores", szCore);
+		for (nb_threads=0; nb_threads<=FS_TEST_THREADS; nb_threads+=FS_TEST_THREADS) {
+			GF_Err e;
+			GF_FilterSession *fs = gf_fs_new(nb_threads, GF_FS_SCHEDULER_LOCK_FREE, 0, NULL);
+			assert_not_null(fs);
+			if (!fs) break;
+			gf_fs_add_filter_register(fs, &FSAffinityRegister);
+			for (i=0; i<FS_AFFINITY_FILTERS; i++) {
+				GF_Filter *f = gf_fs_load_filter(fs, "UTAffinity", &e);
+				assert_not_null(f);
+			}
+			fs_aff_nb_calls = fs_aff_nb_pinned = 0;
+			gf_fs_run(fs);
+			assert_equal(gf_list_count(fs->threads), nb_threads);
+			gf_fs_del(fs);
+
+			assert_equal(fs_aff_nb_calls, FS_AFFINITY_FILTERS*FS_AFFINITY_CALLS);
+			assert_equal(fs_aff_nb_pinned, fs_aff_nb_calls);
+
+			assert_equal(gf_th_get_affinity(NULL, after, &nb_after), GF_OK);
+			assert_equal(nb_after, nb_before);
+			for (i=0; (i<nb_before) && (i<nb_after); i++)
+				assert_equal(after[i], before[i]);
+			nb_after = GF_FS_MAX_CORES;
+		}
+		gf_opts_set_key("core", "th-cores", NULL);
+	}
+	gf_free(before);
+	gf_free(after);
+	gf_sys_close();
+}
+
+#define FS_ARENA_MAX_PCK	40
+
+typedef struct
+{
+	u32 stream_type, pck_size, nb_pck;
+	u32 nb_kept, footprint, nb_evictions;
+	u64 nb_hits;
+} FSArenaTest;
+static FSArenaTest fs_arena_test;
+
+//allocates and discards a burst of packets on a new PID, then allocates one more packet
+static GF_Err fs_arena_initialize(GF_Filter *filter)
+{
+	u32 i;
+	u8 *data;
+	GF_FilterPacket *pck, *pcks[FS_ARENA_MAX_PCK];
+	GF_FilterPid *pid = gf_filter_pid_new(filter);
+	gf_filter_pid_set_property(pid, GF_PROP_PID_STREAM_TYPE, &PROP_UINT(fs_arena_test.stream_type));
+	//stream type is only copied to the PID when connecting, we don't connect
+	pid->stream_type = fs_arena_test.stream_type;
+
+	for (i=0; i<fs_arena_test.nb_pck; i++)
+		pcks[i] = gf_filter_pck_new_alloc(pid, fs_arena_test.pck_size, &data);
+	for (i=0; i<fs_arena_test.nb_pck; i++)
+		gf_filter_pck_discard(pcks[i]);
+
+	fs_arena_test.nb_kept = pid->arena->nb_pck;
+	fs_arena_test.footprint = pid->arena->footprint;
+	fs_arena_test.nb_evictions = pid->arena->nb_evictions;
+	pck = gf_filter_pck_new_alloc(pid, fs_arena_test.pck_size, &data);
+	fs_arena_test.nb_hits = pid->arena->nb_hits;
+	gf_filter_pck_discard(pck);
+	return GF_OK;
+}
+
+static GF_Err fs_arena_process(GF_Filter *filter)
+{
+	return GF_EOS;
+}
+
+static GF_FilterRegister FSArenaRegister = {
+	.name = "UTArena",
+	GF_FS_SET_DESCRIPTION("Packet arena test")
+	.flags = GF_FS_REG_EXPLICIT_ONLY,
+	.initialize = fs_arena_initialize,
+	.process = fs_arena_process,
+};
+
+static void fs_arena_run(const char *arena_kb, u32 stream_type, u32 pck_size, u32 nb_pck)
+{
+	GF_Err e;
+	GF_FilterSession *fs;
+	memset(&fs_arena_test, 0, sizeof(FSArenaTest));
+	fs_arena_test.stream_type = stream_type;
+	fs_arena_test.pck_size = pck_size;
+	fs_arena_test.nb_pck = nb_pck;
+	gf_opts_set_key("core", "pck-arena", arena_kb);
+	fs = gf_fs_new(0, GF_FS_SCHEDULER_LOCK_FREE, 0, NULL);
+	gf_opts_set_key("core", "pck-arena", NULL);
+	if (!fs) return;
+	gf_fs_add_filter_register(fs, &FSArenaRegister);
+	gf_fs_load_filter(fs, "UTArena", &e);
+	gf_fs_run(fs);
+	gf_fs_del(fs);
+}
+
+unittest(fs_pck_arena)
+{
+	GF_FilterSession *fs;
+
+	//in-memory config for the pck-arena option
+	gf_sys_init(GF_MemTrackerNone, "0");
+
+	//default cap is small
+	fs = gf_fs_new(0, GF_FS_SCHEDULER_LOCK_FREE, 0, NULL);
+	assert_equal(fs->pck_arena_max_size, 4096000);
+	gf_fs_del(fs);
+	//no 32-bit wrap for large values
+	gf_opts_set_key("core", "pck-arena", "5000000");
+	fs = gf_fs_new(0, GF_FS_SCHEDULER_LOCK_FREE, 0, NULL);
+	gf_opts_set_key("core", "pck-arena", NULL);
+	assert_equal(fs->pck_arena_max_size, GF_INT_MAX);
+	gf_fs_del(fs);
+
+	//memory cap: 10 x 1000 bytes in a 4 kB arena
+	fs_arena_run("4", GF_STREAM_VISUAL, 1000, 10);
+	assert_equal(fs_arena_test.nb_kept, 4);
+	assert_equal(fs_arena_test.footprint, 4000);
+	assert_equal(fs_arena_test.nb_evictions, 6);
+	assert_equal(fs_arena_test.nb_hits, 1);
+
+	//packet count cap
+	fs_arena_run("4096", GF_STREAM_VISUAL, 100, FS_ARENA_MAX_PCK);
+	assert_equal(fs_arena_test.nb_kept, GF_PCK_ARENA_MAX_PCK);
+	assert_equal(fs_arena_test.nb_evictions, FS_ARENA_MAX_PCK - GF_PCK_ARENA_MAX_PCK);
+
+	//a single packet larger than the cap is still kept
+	fs_arena_run("4", GF_STREAM_VISUAL, 100000, 3);
+	assert_equal(fs_arena_test.nb_kept, 1);
+	assert_equal(fs_arena_test.footprint, 100000);
+	assert_equal(fs_arena_test.nb_hits, 1);
+
+	//file PIDs keep a single buffer
+	fs_arena_run("4096", GF_STREAM_FILE, 1000, 10);
+	assert_equal(fs_arena_test.nb_kept, 1);
+	assert_equal(fs_arena_test.nb_evictions, 9);
+	gf_sys_close();
+}
@@ -188,12 +188,25 @@ void gf_filter_pid_force_single_link(GF_FilterPid *pid);
 //prevent filter cloning in pid link
 void gf_filter_pid_disable_clone(GF_FilterPid *pid);
 
+//additional manifest generated from the segments of the main manifest
+typedef struct
+{
+	GF_FilterPid *opid;
+	GF_Filter *dst;
+	char *path;
+	Bool is_m3u8;
+	u8 last_signature[GF_SHA1_DIGEST_SIZE];
+	//BaseURL and profile extension of this manifest from altbase and altpx, NULL to use the main ones
+	const char *base;
+	const char *profX;
+} DasherAltManifest;
+
 typedef struct
 {
 	u32 bs_switch, profile, spd, cp, ntp;
 	s32 subs_sidx;
 	s32 buf, timescale;
-	Bool sfile, sseg, no_sar, mix_codecs, stl, tpl, align, sap, no_frag_def, sidx, split, hlsc, strict_cues, force_flush, last_seg_merge, keep_ts;
+	Bool sfile, sseg, no_sar, mix_codecs, stl, tpl, align, indep, sap, no_frag_def, sidx, split, hlsc, strict_cues, force_flush, last_seg_merge, keep_ts;
 	u32 mha_compat, sflush;
 	u32 strict_sap;
 	u32 pssh;
@@ -218,6 +231,7 @@ typedef struct
 	Double refresh, tsb, subdur;
 	u64 *_p_gentime, *_p_mpdtime;
 	Bool cmpd, dual, sreg, ttml_agg;
+	GF_PropStringList altm, altbase, altpx;
 	char *styp;
 	Bool sigfrag;
 	u32 sbound, pswitch;
@@ -246,6 +260,10 @@ typedef struct
 	GF_Filter *alt_dst;
 	Bool opid_alt_m3u8;
 
+	//alternate manifests from altm option, and the HLS one if any
+	GF_List *alt_manifests;
+	DasherAltManifest *alt_hls;
+
 	GF_MPD *mpd;
 
 	GF_DasherPeriod *current_period, *next_period;
@@ -391,6 +409,11 @@ typedef struct _dash_stream
 
 	u32 nb_rep, nb_rep_done;
 	Double set_seg_duration;
+	//indep mode: duration of each segment for the first rep of the set producing it
+	Double *set_seg_durs;
+	u32 nb_set_seg_durs;
+	//indep mode: timeline of non-first rep in set, moved to the rep at period end if segments are not aligned
+	GF_MPD_SegmentTimeline *indep_tl;
 
 	//repID for this stream, generated if not found
 	char *rep_id;
@@ -588,6 +611,7 @@ static GF_Err dasher_get_audio_info_with_m4a_sbr_ps(GF_DashStream *ds, const GF_
 
 static void dasher_ensure_outpath(GF_DasherCtx *ctx)
 {
+	u32 i, count;
 	if (!ctx->out_path) {
 		ctx->out_path = gf_filter_pid_get_destination(ctx->opid);
 		if (!ctx->out_path) {
@@ -614,6 +638,11 @@ static void dasher_ensure_outpath(GF_DasherCtx *ctx)
 		gf_filter_pid_set_property(ctx->opid, GF_PROP_PID_URL, &PROP_STRING(ctx->out_path) );
 	if (ctx->opid_alt)
 		gf_filter_pid_set_property(ctx->opid_alt, GF_PROP_PID_URL, &PROP_STRING(ctx->out_path_alt) );
+	count = gf_list_count(ctx->alt_manifests);
+	for (i=0; i<count; i++) {
+		DasherAltManifest *am = gf_list_get(ctx->alt_manifests, i);
+		gf_filter_pid_set_property(am->opid, GF_PROP_PID_URL, &PROP_STRING(am->path) );
+	}
 }
 
 
@@ -917,6 +946,89 @@ static Bool dasher_template_use_source_url(const char *template)
 	return GF_FALSE;
 }
 
+//creates an output for a manifest listed in altm, sharing the segments of the main manifest
+static DasherAltManifest *dasher_new_alt_manifest(GF_Filter *filter, GF_DasherCtx *ctx, u32 idx)
+{
+	GF_Err e;
+	char szSRC[100];
+	char *out_path;
+	GF_Filter *dst;
+	DasherAltManifest *am;
+	Bool is_m3u8 = GF_FALSE;
+	char *mpath = ctx->out_path ? ctx->out_path : ctx->mname;
+	const char *name = ctx->altm.vals[idx];
+	const char *base = ((idx < ctx->altbase.nb_items) && ctx->altbase.vals[idx][0]) ? ctx->altbase.vals[idx] : NULL;
+	const char *profX = ((idx < ctx->altpx.nb_items) && ctx->altpx.vals[idx][0]) ? ctx->altpx.vals[idx] : NULL;
+	char *ext = gf_file_ext_start(name);
+
+	//segment URLs are relative to the main manifest, so the alternate one must be in the same directory
+	if (strchr(name, '/') || strchr(name, '\\') || strstr(name, "://")) {
+		GF_LOG(GF_LOG_ERROR, GF_LOG_DASH, ("[Dasher] Alternate manifest %s is not in the directory of the main manifest, ignoring\n", name));
+		return NULL;
+	}
+	if (!mpath) {
+		GF_LOG(GF_LOG_WARNING, GF_LOG_DASH, ("[Dasher] Cannot guess output location when explicitly loaded, ignoring alternate manifest %s"
+			"\n\tUse --mname=URL to specify output location\n", name));
+		return NULL;
+	}
+	if (ext && !stricmp(ext, ".m3u8"))
+		is_m3u8 = GF_TRUE;
+	//variant playlists are written by the HLS manifest PID, only one is allowed
+	if (is_m3u8 && ctx->do_m3u8) {
+		GF_LOG(GF_LOG_WARNING, GF_LOG_DASH, ("[Dasher] HLS manifest already generated, ignoring alternate manifest %s\n", name));
+		return NULL;
+	}
+	if (is_m3u8 && (base || profX)) {
+		GF_LOG(GF_LOG_WARNING, GF_LOG_DASH, ("[Dasher] BaseURL and profiles are not used in HLS, ignoring them for alternate manifest %s\n", name));
+		base = profX = NULL;
+	}
+
+	//alternate manifest is relative to the main one so that segment URLs are the same
+	if (!strncmp(mpath, "gfio://", 7)) {
+		GF_FileIO *gfio = gf_fileio_from_url(mpath);
+		if (!gfio) return NULL;
+		out_path = gf_strdup(gf_fileio_factory(gfio, name));
+	} else {
+		out_path = gf_url_concatenate(mpath, name);
+	}
+	if (!out_path) return NULL;
+
+	dst = gf_filter_connect_destination(filter, out_path, &e);
+	if (e) {
+		GF_LOG(GF_LOG_ERROR, GF_LOG_DASH, ("[Dasher] Couldn't create alternate manifest output %s: %s\n", out_path, gf_error_to_string(e) ));
+		gf_free(out_path);
+		return NULL;
+	}
+	GF_SAFEALLOC(am, DasherAltManifest);
+	if (!am) {
+		gf_free(out_path);
+		return NULL;
+	}
+	am->dst = dst;
+	am->path = out_path;
+	am->is_m3u8 = is_m3u8;
+	am->base = base;
+	am->profX = profX;
+	gf_list_add(ctx->alt_manifests, am);
+
+	//same as dual mode, only connect the new pid to the new destination
+	gf_filter_reset_source(dst);
+	snprintf(szSRC, 100, "MuxSrc%cdasher_%p", gf_filter_get_sep(filter, GF_FS_SEP_NAME), dst);
+	gf_filter_set_source(dst, filter, szSRC);
+
+	am->opid = gf_filter_pid_new(filter);
+	gf_filter_pid_set_name(am->opid, "MANIFEST_ALT");
+	//only link to the new destination, never to a clone of the main one
+	gf_filter_pid_disable_clone(am->opid);
+
+	//mux source of the new pid is set once its properties are copied
+	snprintf(szSRC, 100, "dasher_%p", ctx);
+	gf_filter_pid_set_property(ctx->opid, GF_PROP_PID_MUX_SRC, &PROP_STRING(szSRC) );
+
+	if (is_m3u8) ctx->alt_hls = am;
+	return am;
+}
+
 static GF_Err dasher_configure_pid(GF_Filter *filter, GF_FilterPid *pid, Bool is_remove)
 {
 	Bool period_switch = GF_FALSE;
@@ -947,15 +1059,23 @@ static GF_Err dasher_configure_pid(GF_Filter *filter, GF_FilterPid *pid, Bool is
 	}
 	ctx->check_connections = GF_TRUE;
 	if (!ctx->opid && !ctx->gencues) {
-		u32 i, nb_opids = ctx->dual ? 2 : 1;
+		u32 i, nb_main = ctx->dual ? 2 : 1;
+		u32 nb_opids = nb_main + ctx->altm.nb_items;
 		for (i=0; i < nb_opids; i++) {
 			char *segext=NULL;
 			char *force_ext=NULL;
 			GF_FilterPid *opid=NULL;
+			DasherAltManifest *am=NULL;
 			if (i==0) {
 				ctx->opid = gf_filter_pid_new(filter);
 				gf_filter_pid_set_name(ctx->opid, "MANIFEST");
 				opid = ctx->opid;
+			} else if (i>=nb_main) {
+				am = dasher_new_alt_manifest(filter, ctx, i-nb_main);
+				if (am) {
+					opid = am->opid;
+					force_ext = am->is_m3u8 ? "m3u8" : "mpd";
+				}
 			} else if (!ctx->alt_dst && (ctx->out_path || ctx->mname)) {
 				char szSRC[100];
 				GF_FileIO *gfio = NULL;
@@ -1024,6 +1144,12 @@ static GF_Err dasher_configure_pid(GF_Filter *filter, GF_FilterPid *pid, Bool is
 
 			//copy properties at init or reconfig
 			gf_filter_pid_copy_properties(opid, pid);
+			//copy resets all properties, restore mux source of alternate manifests
+			if (am || (opid==ctx->opid_alt)) {
+				char szSRC[100];
+				snprintf(szSRC, 100, "dasher_%p", am ? am->dst : ctx->alt_dst);
+				gf_filter_pid_set_property(opid, GF_PROP_PID_MUX_SRC, &PROP_STRING(szSRC) );
+			}
 			gf_filter_pid_set_property(opid, GF_PROP_PID_DECODER_CONFIG, NULL);
 			gf_filter_pid_set_property(opid, GF_PROP_PID_DECODER_CONFIG_ENHANCEMENT, NULL);
 			gf_filter_pid_set_property(opid, GF_PROP_PID_CODECID, NULL);
@@ -1064,7 +1190,9 @@ static GF_Err dasher_configure_pid(GF_Filter *filter, GF_FilterPid *pid, Bool is
 						gf_filter_pid_disable_clone(opid);
 
 					//override URL/path when loaded dynamically in case output filter(s) do not set a manifest name
-					char *path = (opid==ctx->opid_alt) ? ctx->out_path_alt : ctx->out_path;
+					char *path = ctx->out_path;
+					if (opid==ctx->opid_alt) path = ctx->out_path_alt;
+					else if (am) path = am->path;
 					gf_filter_pid_set_property(opid, GF_PROP_PID_URL, path ? &PROP_STRING(path) : NULL );
 					gf_filter_pid_set_property(opid, GF_PROP_PID_FILEPATH, path ? &PROP_STRING(path) : NULL );
 				}
@@ -1793,10 +1921,15 @@ static GF_Err dasher_configure_pid(GF_Filter *filter, GF_FilterPid *pid, Bool is
 			ds->opid = NULL;
 		}
 		if (ctx->is_eos) {
+			u32 i;
 			ctx->is_eos = GF_FALSE;
 			gf_filter_pid_discard_block(ctx->opid);
 			if (ctx->opid_alt)
 			gf_filter_pid_discard_block(ctx->opid_alt);
+			for (i=0; i<gf_list_count(ctx->alt_manifests); i++) {
+				DasherAltManifest *am = gf_list_get(ctx->alt_manifests, i);
+				gf_filter_pid_discard_block(am->opid);
+			}
 		}
 		ds->rep_init = GF_FALSE;
 		ds->presentation_time_offset = 0;
@@ -1875,26 +2008,10 @@ static void	dasher_check_chaining(GF_DasherCtx *ctx, char *scheme_id, char *url)
 }
 
 
-static GF_Err dasher_update_mpd(GF_DasherCtx *ctx)
+//builds the profiles attribute of the MPD, appending prof_ext or replacing the default profiles if prof_ext starts with '+'
+static char *dasher_get_profiles(GF_DasherCtx *ctx, const char *prof_ext)
 {
 	char profiles_string[GF_MAX_PATH];
-	GF_XMLAttribute *cenc_att = NULL;
-	GF_XMLAttribute *xlink_att = NULL;
-	GF_XMLAttribute *ck_att = NULL;
-
-	u32 i, count=gf_list_count(ctx->mpd->x_attributes);
-	for (i=0; i<count; i++) {
-		GF_XMLAttribute * att = gf_list_get(ctx->mpd->x_attributes, i);
-		if (!strcmp(att->name, "xmlns:cenc")) cenc_att = att;
-		if (!strcmp(att->name, "xmlns:xlink")) xlink_att = att;
-		if (!strcmp(att->name, "xmlns:ck")) ck_att = att;
-	}
-	if (ctx->dmode==GF_MPD_TYPE_DYNAMIC) {
-		ctx->mpd->type = GF_MPD_TYPE_DYNAMIC;
-	} else {
-		ctx->mpd->type = GF_MPD_TYPE_STATIC;
-		ctx->mpd->availabilityStartTime = 0;
-	}
 
 	Bool is_m2ts = (ctx->muxtype==DASHER_MUX_TS) ? GF_TRUE : GF_FALSE;
 	if (ctx->profile==GF_DASH_PROFILE_LIVE) {
@@ -1928,22 +2045,38 @@ static GF_Err dasher_update_mpd(GF_DasherCtx *ctx)
 		strncat(profiles_string+offset, ",urn:mpeg:dash:profile:cmaf:2019", GF_MAX_PATH-offset-1);
 	}
 
-	if (ctx->profX) {
-		if (ctx->profX[0] == '+') {
-			if (ctx->mpd->profiles) gf_free(ctx->mpd->profiles);
-			ctx->mpd->profiles = gf_strdup(ctx->profX+1);
-			ctx->mpd->profiles = gf_strdup(ctx->profX+1);
-		} else {
-			char profiles_w_ext[GF_MAX_PATH+256];
-			sprintf(profiles_w_ext, "%s,%s", profiles_string, ctx->profX);
-			if (ctx->mpd->profiles) gf_free(ctx->mpd->profiles);
-			ctx->mpd->profiles = gf_strdup(profiles_w_ext);
-		}
+	if (prof_ext) {
+		if (prof_ext[0] == '+') return gf_strdup(prof_ext+1);
+		char profiles_w_ext[GF_MAX_PATH+256];
+		snprintf(profiles_w_ext, GF_MAX_PATH+256, "%s,%s", profiles_string, prof_ext);
+		return gf_strdup(profiles_w_ext);
+	}
+	return gf_strdup(profiles_string);
+}
+
+static GF_Err dasher_update_mpd(GF_DasherCtx *ctx)
+{
+	GF_XMLAttribute *cenc_att = NULL;
+	GF_XMLAttribute *xlink_att = NULL;
+	GF_XMLAttribute *ck_att = NULL;
+
+	u32 i, count=gf_list_count(ctx->mpd->x_attributes);
+	for (i=0; i<count; i++) {
+		GF_XMLAttribute * att = gf_list_get(ctx->mpd->x_attributes, i);
+		if (!strcmp(att->name, "xmlns:cenc")) cenc_att = att;
+		if (!strcmp(att->name, "xmlns:xlink")) xlink_att = att;
+		if (!strcmp(att->name, "xmlns:ck")) ck_att = att;
+	}
+	if (ctx->dmode==GF_MPD_TYPE_DYNAMIC) {
+		ctx->mpd->type = GF_MPD_TYPE_DYNAMIC;
 	} else {
-		if (ctx->mpd->profiles) gf_free(ctx->mpd->profiles);
-		ctx->mpd->profiles = gf_strdup(profiles_string);
+		ctx->mpd->type = GF_MPD_TYPE_STATIC;
+		ctx->mpd->availabilityStartTime = 0;
 	}
 
+	if (ctx->mpd->profiles) gf_free(ctx->mpd->profiles);
+	ctx->mpd->profiles = dasher_get_profiles(ctx, ctx->profX);
+
 	if (ctx->use_cenc && !cenc_att) {
 		cenc_att = gf_xml_dom_create_attribute("xmlns:cenc", "urn:mpeg:cenc:2013");
 		gf_list_add(ctx->mpd->x_attributes, cenc_att);
@@ -5440,7 +5573,7 @@ static GF_Err dasher_write_index(GF_DasherCtx *ctx, GF_FilterPid *opid)
 }
 
 
-static GF_Err dasher_write_and_send_manifest(GF_DasherCtx *ctx, u64 last_period_dur, Bool do_m3u8, Bool m3u8_second_pass, GF_FilterPid *opid, char *alt_name)
+static GF_Err dasher_write_and_send_manifest(GF_DasherCtx *ctx, u64 last_period_dur, Bool do_m3u8, Bool m3u8_second_pass, GF_FilterPid *opid, char *alt_name, u8 *alt_signature)
 {
 	void *last_signature;
 	u8 sig[GF_SHA1_DIGEST_SIZE];
@@ -5495,7 +5628,9 @@ static GF_Err dasher_write_and_send_manifest(GF_DasherCtx *ctx, u64 last_period_
 	}
 
 	gf_sha1_file_ptr(tmp, sig);
-	if (do_m3u8) {
+	if (alt_signature) {
+		last_signature = (void *) alt_signature;
+	} else if (do_m3u8) {
 		last_signature = (void *) m3u8_second_pass ? ctx->last_hls2_signature : ctx->last_hls_signature;
 	} else {
 		last_signature = (void *) ctx->last_mpd_signature;
@@ -5511,6 +5646,36 @@ static GF_Err dasher_write_and_send_manifest(GF_DasherCtx *ctx, u64 last_period_
 	return GF_OK;
 }
 
+//writes an alternate MPD with its own BaseURL and profiles, the rest of the MPD being shared with the main one
+static GF_Err dasher_write_alt_mpd(GF_DasherCtx *ctx, u64 last_period_dur, DasherAltManifest *am)
+{
+	GF_Err e;
+	GF_MPD_BaseURL base;
+	GF_List *base_URLs = ctx->mpd->base_URLs;
+	char *profiles = ctx->mpd->profiles;
+
+	if (am->base) {
+		memset(&base, 0, sizeof(GF_MPD_BaseURL));
+		base.URL = (char *) am->base;
+		ctx->mpd->base_URLs = gf_list_new();
+		gf_list_add(ctx->mpd->base_URLs, &base);
+	}
+	if (am->profX)
+		ctx->mpd->profiles = dasher_get_profiles(ctx, am->profX);
+
+	e = dasher_write_and_send_manifest(ctx, last_period_dur, GF_FALSE, GF_FALSE, am->opid, NULL, am->last_signature);
+
+	if (am->base) {
+		gf_list_del(ctx->mpd->base_URLs);
+		ctx->mpd->base_URLs = base_URLs;
+	}
+	if (am->profX) {
+		gf_free(ctx->mpd->profiles);
+		ctx->mpd->profiles = profiles;
+	}
+	return e;
+}
+
 static void dasher_update_dyn_bitrates(GF_DasherCtx *ctx)
 {
 	u32 i, count = gf_list_count(ctx->current_period->streams);
@@ -5612,7 +5777,7 @@ GF_Err dasher_send_manifest(GF_Filter *filter, GF_DasherCtx *ctx, Bool for_mpd_o
 			if (max_opid>1) {
 				do_m3u8 = ctx->opid_alt_m3u8 ? GF_FALSE : GF_TRUE;
 			} else {
-				do_m3u8 = ctx->do_m3u8;
+				do_m3u8 = ctx->alt_hls ? GF_FALSE : ctx->do_m3u8;
 			}
 			opid = ctx->opid;
 		} else {
@@ -5624,11 +5789,25 @@ GF_Err dasher_send_manifest(GF_Filter *filter, GF_DasherCtx *ctx, Bool for_mpd_o
 		}
 		if ((ctx->llhls==3) && do_m3u8)
 			ctx->mpd->force_llhls_mode = 1;
-		e = dasher_write_and_send_manifest(ctx, last_period_dur, do_m3u8, GF_FALSE, opid, NULL);
+		e = dasher_write_and_send_manifest(ctx, last_period_dur, do_m3u8, GF_FALSE, opid, NULL, NULL);
 		if (e) return e;
 
 		ctx->mpd->force_llhls_mode = 0;
 	}
+	//alternate manifests, describing the same segments
+	for (i=0; i<gf_list_count(ctx->alt_manifests); i++) {
+		DasherAltManifest *am = gf_list_get(ctx->alt_manifests, i);
+		if (am->is_m3u8) {
+			if (for_mpd_only) continue;
+			if (ctx->llhls==3)
+				ctx->mpd->force_llhls_mode = 1;
+			e = dasher_write_and_send_manifest(ctx, last_period_dur, GF_TRUE, GF_FALSE, am->opid, NULL, NULL);
+			ctx->mpd->force_llhls_mode = 0;
+		} else {
+			e = dasher_write_alt_mpd(ctx, last_period_dur, am);
+		}
+		if (e) return e;
+	}
 
 	if (ctx->current_period->period)
 		ctx->current_period->period->duration = last_period_dur;
@@ -5652,7 +5831,8 @@ GF_Err dasher_send_manifest(GF_Filter *filter, GF_DasherCtx *ctx, Bool for_mpd_o
 		GF_MPD_Representation *rep;
 		GF_FilterPid *opid;
 		gf_assert(period);
-		if (ctx->opid_alt_m3u8) opid = ctx->opid_alt;
+		if (ctx->alt_hls) opid = ctx->alt_hls->opid;
+		else if (ctx->opid_alt_m3u8) opid = ctx->opid_alt;
 		else opid = ctx->opid;
 
 resend:
@@ -5699,15 +5879,16 @@ resend:
 		if ((ctx->llhls==3) && !m3u8_second_pass && ctx->out_path) {
 			char *sep;
 			char szAltName[GF_MAX_PATH];
-			strcpy(szAltName, ctx->out_path);
+			char *hls_path = ctx->alt_hls ? ctx->alt_hls->path : ctx->out_path;
+			strcpy(szAltName, hls_path);
 			sep = gf_file_ext_start(szAltName);
 			if (sep) sep[0] = 0;
 			strcat(szAltName, "_IF");
-			sep = gf_file_ext_start(ctx->out_path);
+			sep = gf_file_ext_start(hls_path);
 			if (sep) strcat(szAltName, sep);
 
 			ctx->mpd->force_llhls_mode = 2;
-			e = dasher_write_and_send_manifest(ctx, last_period_dur, GF_TRUE, GF_TRUE, ctx->opid, szAltName);
+			e = dasher_write_and_send_manifest(ctx, last_period_dur, GF_TRUE, GF_TRUE, ctx->alt_hls ? opid : ctx->opid, szAltName, NULL);
 			if (e) return e;
 
 			m3u8_second_pass = GF_TRUE;
@@ -5755,6 +5936,11 @@ static void dasher_reset_stream(GF_Filter *filter, GF_DashStream *ds, Bool is_de
 	ds->pending_segment_urls = NULL;
 	if (ds->pending_segment_states) gf_list_del(ds->pending_segment_states);
 	ds->pending_segment_states = NULL;
+	if (ds->set_seg_durs) gf_free(ds->set_seg_durs);
+	ds->set_seg_durs = NULL;
+	ds->nb_set_seg_durs = 0;
+	if (ds->indep_tl) gf_mpd_segment_timeline_free(ds->indep_tl);
+	ds->indep_tl = NULL;
 
 	if (is_destroy) {
 		if (ds->cues) gf_free(ds->cues);
@@ -5991,25 +6177,15 @@ static GF_Err dasher_reload_context(GF_Filter *filter, GF_DasherCtx *ctx)
 	GF_Err e;
 	Bool last_period_active = GF_FALSE;
 	u32 i, j, k, nb_p, nb_as, nb_rep, count;
-	GF_DOMParser *mpd_parser;
 
 	ctx->first_context_load = GF_FALSE;
 
 	if (!gf_file_exists(ctx->state)) return GF_OK;
 
 	/* parse the MPD */
-	mpd_parser = gf_xml_dom_new();
-	e = gf_xml_dom_parse(mpd_parser, ctx->state, NULL, NULL);
-
-	if (e != GF_OK) {
-		GF_LOG(GF_LOG_ERROR, GF_LOG_DASH, ("[Dasher] Cannot parse MPD state %s: %s\n", ctx->state, gf_xml_dom_get_error(mpd_parser) ));
-		gf_xml_dom_del(mpd_parser);
-		return GF_URL_ERROR;
-	}
 	if (ctx->mpd) gf_mpd_del(ctx->mpd);
 	ctx->mpd = gf_mpd_new();
-	e = gf_mpd_init_from_dom(gf_xml_dom_get_root(mpd_parser), ctx->mpd, ctx->state);
-	gf_xml_dom_del(mpd_parser);
+	e = gf_mpd_init_from_file(ctx->state, ctx->mpd, ctx->state);
 	//test mode, strip URL path
 	if (gf_sys_is_test_mode()) {
 		count = gf_list_count(ctx->mpd->program_infos);
@@ -6901,6 +7077,11 @@ static GF_Err dasher_setup_period(GF_Filter *filter, GF_DasherCtx *ctx, GF_DashS
 	ctx->min_cts_period.num = 0;
 	ctx->min_cts_period.den = 0;
 
+	if (ctx->indep && (ctx->forward_mode || ctx->do_index || ctx->from_index)) {
+		GF_LOG(GF_LOG_WARNING, GF_LOG_DASH, ("[Dasher] `indep` not supported in forward or index modes, disabling\n"));
+		ctx->indep = GF_FALSE;
+	}
+
 	count = gf_list_count(ctx->current_period->streams);
 	//setup representations
 	for (i=0; i<count; i++) {
@@ -7248,6 +7429,13 @@ static GF_Err dasher_setup_period(GF_Filter *filter, GF_DasherCtx *ctx, GF_DashS
 
 				gf_list_add(ds->set->representations, a_ds->rep);
 				ds->nb_rep++;
+				//independent reps cannot truncate other reps in the set to the shortest one, require identical known durations
+				if (ctx->indep && ctx->check_dur
+					&& (!ds->duration.num || (ds->duration.num * a_ds->duration.den != a_ds->duration.num * ds->duration.den))
+				) {
+					GF_LOG(GF_LOG_WARNING, GF_LOG_DASH, ("[Dasher] Input durations unknown or not matching in adaptation set, disabling `indep`\n"));
+					ctx->indep = GF_FALSE;
+				}
 				//add non-conditional adaptation set descriptors
 				dasher_add_descriptors(&ds->set->x_children, a_ds->p_as_any_desc);
 			} else if (ds->as_id && (ds->as_id==a_ds->as_id)){
@@ -7550,8 +7738,12 @@ static void dasher_insert_timeline_entry(GF_DasherCtx *ctx, GF_DashStream *ds, B
 		pto = gf_timestamp_rescale(pto, ds->timescale, ds->mpd_timescale);
 	}
 	seg_align = (ds->set->segment_alignment || ds->set->subsegment_alignment) ? GF_TRUE : GF_FALSE;
+	//independent reps, first rep always feeds the set timeline, other reps keep their own until period end
+	if (ctx->indep) {
+		seg_align = GF_TRUE;
+	}
 	//not first and segment alignment, ignore
-	if (!is_first && seg_align && !is_ll_anouncement) {
+	else if (!is_first && seg_align && !is_ll_anouncement) {
 		return;
 	}
 	if (ctx->do_index) {
@@ -7561,8 +7753,13 @@ static void dasher_insert_timeline_entry(GF_DasherCtx *ctx, GF_DashStream *ds, B
 
 	if (!ds->stl) return;
 
+	if (ctx->indep && !is_first) {
+		if (!ds->indep_tl)
+			ds->indep_tl = gf_mpd_segmentimeline_new();
+		tl = ds->indep_tl;
+	}
 	//no segment alignment store in each rep
-	if (!seg_align) {
+	else if (!seg_align) {
 		GF_MPD_SegmentTimeline **p_tl=NULL;
 		if (!ds->rep) {
 			GF_LOG(GF_LOG_ERROR, GF_LOG_DASH, ("[Dasher] failed to store timeline entry, no representation assigned !\n"));
@@ -7831,6 +8028,68 @@ static void dasher_set_timeline_parts(GF_DasherCtx *ctx, GF_DashStream *ds, GF_D
 	gf_list_add(stl->entries, new_ent);
 }
 
+//independent reps: check segment duration against the first rep of the set having produced this segment
+static void dasher_check_indep_alignment(GF_DasherCtx *ctx, GF_DashStream *ds, GF_DashStream *set_ds, Double seg_duration)
+{
+	Double diff;
+	u32 idx = ds->seg_number - ds->startNumber;
+
+	if (idx >= set_ds->nb_set_seg_durs) {
+		u32 nb_alloc = MAX(idx+1, 2*set_ds->nb_set_seg_durs);
+		set_ds->set_seg_durs = gf_realloc(set_ds->set_seg_durs, sizeof(Double) * nb_alloc);
+		if (!set_ds->set_seg_durs) {
+			set_ds->nb_set_seg_durs = 0;
+			return;
+		}
+		memset(set_ds->set_seg_durs + set_ds->nb_set_seg_durs, 0, sizeof(Double) * (nb_alloc - set_ds->nb_set_seg_durs));
+		set_ds->nb_set_seg_durs = nb_alloc;
+	}
+	if (!set_ds->set_seg_durs[idx]) {
+		set_ds->set_seg_durs[idx] = seg_duration;
+		return;
+	}
+	diff = set_ds->set_seg_durs[idx] - seg_duration;
+	if (ABS(diff) <= 0.001) return;
+
+	if (set_ds->set->segment_alignment || set_ds->set->subsegment_alignment) {
+		GF_LOG(GF_LOG_WARNING, GF_LOG_DASH, ("[Dasher] Segments are not aligned across representations: first rep segment duration %g but new segment duration %g for the same segment %d\n", set_ds->set_seg_durs[idx], seg_duration, ds->seg_number));
+	}
+	if (ctx->profile != GF_DASH_PROFILE_FULL) {
+		set_ds->set->segment_alignment = GF_FALSE;
+		set_ds->set->subsegment_alignment = GF_FALSE;
+		ctx->profile = GF_DASH_PROFILE_FULL;
+		GF_LOG(GF_LOG_WARNING, GF_LOG_DASH, ("[Dasher] No segment alignment, switching to full profile\n"));
+	}
+}
+
+//independent reps: all reps are done, keep set timeline if segments are aligned, otherwise move timelines to reps
+static void dasher_assemble_indep_timelines(GF_DasherCtx *ctx)
+{
+	u32 i, count = gf_list_count(ctx->current_period->streams);
+	for (i=0; i<count; i++) {
+		GF_MPD_SegmentTimeline **p_tl = NULL;
+		GF_DashStream *ds = gf_list_get(ctx->current_period->streams, i);
+		if (!ds->indep_tl) continue;
+
+		if (ds->set && ds->rep && !ds->set->segment_alignment && !ds->set->subsegment_alignment) {
+			//move set timeline to first rep and clone it for other reps
+			dasher_copy_segment_timelines(ctx, ds->set);
+			if (ctx->tpl) {
+				if (ds->rep->segment_template) p_tl = &ds->rep->segment_template->segment_timeline;
+			} else {
+				if (ds->rep->segment_list) p_tl = &ds->rep->segment_list->segment_timeline;
+			}
+		}
+		if (p_tl) {
+			if (*p_tl) gf_mpd_segment_timeline_free(*p_tl);
+			*p_tl = ds->indep_tl;
+		} else {
+			gf_mpd_segment_timeline_free(ds->indep_tl);
+		}
+		ds->indep_tl = NULL;
+	}
+}
+
 static void dasher_flush_segment(GF_DasherCtx *ctx, GF_DashStream *ds, Bool is_last_in_period)
 {
 	u32 i, count;
@@ -7920,7 +8179,9 @@ static void dasher_flush_segment(GF_DasherCtx *ctx, GF_DashStream *ds, Bool is_l
 			}
 		}
 
-		if (ctx->align) {
+		if (ctx->indep) {
+			dasher_check_indep_alignment(ctx, base_ds, set_ds, seg_duration);
+		} else if (ctx->align) {
 			if (!set_ds->nb_rep_done || !set_ds->set_seg_duration) {
 				set_ds->set_seg_duration = seg_duration;
 			} else {
@@ -7953,7 +8214,7 @@ static void dasher_flush_segment(GF_DasherCtx *ctx, GF_DashStream *ds, Bool is_l
 
 		ds_log = ds;
 	} else {
-		if (ctx->align) {
+		if (ctx->align && !ctx->indep) {
 			set_ds->nb_rep_done++;
 			if (set_ds->nb_rep_done < set_ds->nb_rep) return;
 
@@ -7995,7 +8256,7 @@ static void dasher_flush_segment(GF_DasherCtx *ctx, GF_DashStream *ds, Bool is_l
 	for (i=0; i<count; i++) {
 		ds = gf_list_get(ctx->current_period->streams, i);
 		//reset all in set if segment alignment
-		if (ctx->align) {
+		if (ctx->align && !ctx->indep) {
 			if (ds->set != set_ds->set) continue;
 		} else {
 			//otherwise reset only media components for this rep
@@ -8095,7 +8356,7 @@ static void dasher_flush_segment(GF_DasherCtx *ctx, GF_DashStream *ds, Bool is_l
 			ds = gf_list_get(ctx->current_period->streams, i);
 
 			if (ds->done) {
-				if (ds->set->udta == set_ds)
+				if ((ds->set->udta == set_ds) && !ctx->indep)
 					set_ds->nb_rep_done++;
 			} else if (ctx->check_dur && !ds->force_rep_end) {
 				ds->force_rep_end = gf_timestamp_rescale(ds_done->first_cts_in_next_seg, ds_done->timescale, ds->timescale );
@@ -9509,8 +9770,10 @@ static GF_Err dasher_process(GF_Filter *filter)
 
 			//perform regulation of inputs to avoid dashing one stream faster than the others
 			//this is needed when inputs are not realtime and we have text streams for which we must decide
-			//if we insert empty segments
-			if (!base_ds->segment_started && ctx->min_segment_start_time) {
+			//if we insert empty segments - in indep mode, only text streams are regulated
+			if (!base_ds->segment_started && ctx->min_segment_start_time
+				&& (!ctx->indep || (ds->stream_type==GF_STREAM_TEXT))
+			) {
 				orig_cts = cts;
 				if (ds->split_dur_next)
 					cts += ds->split_dur_next;
@@ -10289,6 +10552,8 @@ static GF_Err dasher_process(GF_Filter *filter)
 	}
 	gf_filter_prevent_blocking(filter, GF_FALSE);
 	ctx->force_period_switch = GF_FALSE;
+	if (ctx->indep)
+		dasher_assemble_indep_timelines(ctx);
 	//done with this period, do period switch - this will update the MPD if needed
 	e = dasher_switch_period(filter, ctx);
 	//no more periods
@@ -10465,6 +10730,10 @@ static Bool dasher_process_event(GF_Filter *filter, const GF_FilterEvent *evt)
 		gf_filter_pid_set_eos(ctx->opid);
 		if (ctx->opid_alt)
 			gf_filter_pid_set_eos(ctx->opid_alt);
+		for (i=0; i<gf_list_count(ctx->alt_manifests); i++) {
+			DasherAltManifest *am = gf_list_get(ctx->alt_manifests, i);
+			gf_filter_pid_set_eos(am->opid);
+		}
 		return GF_TRUE;
 	}
 
@@ -10839,6 +11108,7 @@ static GF_Err dasher_initialize(GF_Filter *filter)
 	ctx->explicit_mode = !gf_filter_is_dynamic(filter);
 	ctx->pids = gf_list_new();
 	ctx->postponed_pids = gf_list_new();
+	ctx->alt_manifests = gf_list_new();
 	ctx->tpl_records = gf_list_new();
 	if (!ctx->initext && (ctx->muxtype==DASHER_MUX_AUTO))
 		ctx->muxtype = DASHER_MUX_ISOM;
@@ -10891,6 +11161,11 @@ static GF_Err dasher_initialize(GF_Filter *filter)
 	if (!ctx->sap || ctx->sigfrag || ctx->cues)
 		ctx->sbound = DASHER_BOUNDS_OUT;
 
+	if (ctx->indep && ((ctx->dmode!=GF_DASH_STATIC) || ctx->state || ctx->subdur || !ctx->align)) {
+		GF_LOG(GF_LOG_WARNING, GF_LOG_DASH, ("[Dasher] `indep` only applies to aligned static sessions without context, disabling\n"));
+		ctx->indep = GF_FALSE;
+	}
+
 	if ((ctx->tsb>=0) && (ctx->dmode!=GF_DASH_STATIC))
 		ctx->purge_segments = GF_TRUE;
 
@@ -10945,6 +11220,12 @@ static void dasher_finalize(GF_Filter *filter)
 	gf_free(ctx->next_period);
 	if (ctx->out_path) gf_free(ctx->out_path);
 	if (ctx->out_path_alt) gf_free(ctx->out_path_alt);
+	while (gf_list_count(ctx->alt_manifests)) {
+		DasherAltManifest *am = gf_list_pop_back(ctx->alt_manifests);
+		gf_free(am->path);
+		gf_free(am);
+	}
+	gf_list_del(ctx->alt_manifests);
 	gf_list_del(ctx->postponed_pids);
 #ifndef GPAC_DISABLE_CRYPTO
 	if (ctx->cinfo) gf_crypt_info_del(ctx->cinfo);
@@ -11012,6 +11293,7 @@ static const GF_FilterArgs DasherArgs[] =
 	{ OFFS(sseg), "single segment is used", GF_PROP_BOOL, "false", NULL, GF_FS_ARG_HINT_ADVANCED},
 	{ OFFS(sfile), "use a single file for all segments (default in on_demand)", GF_PROP_BOOL, "false", NULL, GF_FS_ARG_HINT_ADVANCED},
 	{ OFFS(align), "enable segment time alignment between representations", GF_PROP_BOOL, "true", NULL, GF_FS_ARG_HINT_ADVANCED},
+	{ OFFS(indep), "segment representations independently in static mode, checking segment alignment and assembling segment timelines at the end of each period rather than waiting for all representations at each segment boundary", GF_PROP_BOOL, "false", NULL, GF_FS_ARG_HINT_EXPERT},
 	{ OFFS(sap), "enable splitting segments at SAP boundaries", GF_PROP_BOOL, "true", NULL, 0},
 	{ OFFS(mix_codecs), "enable mixing different codecs in an adaptation set", GF_PROP_BOOL, "false", NULL, GF_FS_ARG_HINT_EXPERT},
 	{ OFFS(ntp), "insert/override NTP clock at the beginning of each segment\n"
@@ -11100,6 +11382,9 @@ static const GF_FilterArgs DasherArgs[] =
 	{ OFFS(cmpd), "skip line feed and spaces in MPD XML for compactness", GF_PROP_BOOL, "false", NULL, GF_FS_ARG_HINT_EXPERT},
 	{ OFFS(styp), "indicate the 4CC to use for styp boxes when using ISOBMFF output", GF_PROP_STRING, NULL, NULL, GF_FS_ARG_HINT_EXPERT},
 	{ OFFS(dual), "indicate to produce both MPD and M3U files", GF_PROP_BOOL, NULL, NULL, GF_FS_ARG_HINT_ADVANCED},
+	{ OFFS(altm), "list of additional manifests generated from the same segments, in the directory of the main manifest (see filter help)", GF_PROP_STRING_LIST, NULL, NULL, GF_FS_ARG_HINT_ADVANCED},
+	{ OFFS(altbase), "list of base URLs of the manifests in [-altm](), an empty entry keeps the base URLs of the main manifest", GF_PROP_STRING_LIST, NULL, NULL, GF_FS_ARG_HINT_ADVANCED},
+	{ OFFS(altpx), "list of profile extensions of the manifests in [-altm](), with the same syntax as [-profX](), an empty entry keeps the profiles of the main manifest", GF_PROP_STRING_LIST, NULL, NULL, GF_FS_ARG_HINT_ADVANCED},
 	{ OFFS(sigfrag), "use manifest generation only mode", GF_PROP_BOOL, NULL, NULL, GF_FS_ARG_HINT_ADVANCED},
 	{ OFFS(_p_gentime), "pointer to u64 holding the ntp clock in ms of next DASH generation in live mode", GF_PROP_POINTER, NULL, NULL, GF_FS_ARG_HINT_HIDE},
 	{ OFFS(_p_mpdtime), "pointer to u64 holding the mpd time in ms of the last generated segment", GF_PROP_POINTER, NULL, NULL, GF_FS_ARG_HINT_HIDE},
@@ -11435,6 +11720,13 @@ GF_FilterRegister DasherRegister = {
 "EX gpac -i SRC -o URL1:OPTS1 -o URL2:OPTS1\n"
 "This will create one dasher (with options OPTS1) for the URL1 and one dasher (with options OPTS1) for URL2.\n"
 "This allows dashing to multiple outputs with different formats, dash durations, etc.\n"
+"Each dasher produces its own segments, so the media is multiplexed once per output. When outputs only differ by manifest format or name, use [-dual]() or [-altm]() to produce all manifests from a single set of segments.\n"
+"EX gpac -i SRC -o live.mpd:altm=live.m3u8,live_cdn.mpd\n"
+"This will create a single set of segments described by `live.mpd`, `live_cdn.mpd` and the HLS playlists `live.m3u8`.\n"
+"The alternate manifest names are resolved against the main manifest URL and cannot contain a directory, so that segment URLs stay valid. At most one HLS manifest can be generated.\n"
+"Each alternate MPD can use its own MPD BaseURL and profile extension, set in the same order as [-altm]() by [-altbase]() and [-altpx]().\n"
+"EX gpac -i SRC -o live.mpd:altm=live.m3u8,live_cdn.mpd:altbase=,http://cdn.example.com/live/\n"
+"This will additionally set the MPD BaseURL of `live_cdn.mpd` to the CDN location.\n"
 "\n"
 "It can be useful to redirect all the filter outputs to several sinks, for example to push through ROUTE and through HTTP the same segments.\n"
 "In order to do this, the filter MUST be explicitly loaded and all options related to dash and MP4 must be set either globally or on the dasher filter.\n"
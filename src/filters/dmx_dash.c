@@ -88,7 +88,7 @@ typedef struct
 	u32 use_bmin;
 	char *query;
 	Bool noxlink, split_as, noseek, groupsel, bsmerge;
-	u32 lowlat;
+	u32 lowlat, prefetch;
 
 	GF_FilterPid *mpd_pid;
 	GF_Filter *filter;
@@ -150,6 +150,17 @@ typedef struct
 	char *relative_url; // Relative string to inject before <BaseURL> if keep_base_url is set to inject
 } GF_DASHDmxCtx;
 
+#ifdef GPAC_USE_DOWNLOADER
+typedef struct __dashdmx_prefetch
+{
+	char *url;
+	u64 start_range, end_range;
+	GF_DownloadSession *sess;
+	//set once the segment has been sent to the source filter
+	Bool used;
+} DashDmxPrefetch;
+#endif
+
 typedef struct
 {
 	GF_DASHDmxCtx *ctx;
@@ -168,6 +179,9 @@ typedef struct
 
 #ifdef GPAC_USE_DOWNLOADER
 	GF_DownloadSession *sess;
+	//upcoming segments being fetched ahead of the source filter
+	GF_List *prefetch;
+	struct __dashdmx_prefetch *cur_prefetch;
 #endif
 	Bool is_timestamp_based, pto_setup;
 	Bool prev_is_init_segment, init_from_media;
@@ -202,6 +216,9 @@ typedef struct
 } GF_DASHGroup;
 
 static void dashdmx_notify_group_quality(GF_DASHDmxCtx *ctx, GF_DASHGroup *group);
+#ifdef GPAC_USE_DOWNLOADER
+static void dashdmx_prefetch_reset(GF_DASHGroup *group);
+#endif
 
 static void dashdmx_set_string_list_prop(GF_FilterPacket *ref, u32 prop_name, GF_List **str_list)
 {
@@ -1268,6 +1285,9 @@ GF_Err dashdmx_io_on_dash_event(GF_DASHFileIO *dashio, GF_DASHEventType dash_evt
 			}
 			if (group->template) gf_free(group->template);
 			if (group->current_url) gf_free(group->current_url);
+#ifdef GPAC_USE_DOWNLOADER
+			if (group->prefetch) dashdmx_prefetch_reset(group);
+#endif
 			gf_free(group);
 			gf_dash_set_group_udta(ctx->dash, i, NULL);
 		}
@@ -2370,6 +2390,11 @@ static GF_Err dashdmx_initialize(GF_Filter *filter)
 	ctx->filter = filter;
 	ctx->dm = gf_filter_get_download_manager(filter);
 	if (!ctx->dm) return GF_SERVICE_ERROR;
+	//segments fetched ahead are handed to the source filter through the downloader cache
+	if (ctx->prefetch && gf_opts_get_bool("core", "no-cache")) {
+		GF_LOG(GF_LOG_WARNING, GF_LOG_DASH, ("[DASHDmx] HTTP cache disabled, ignoring prefetch\n"));
+		ctx->prefetch = 0;
+	}
 
 	ctx->dash_io.udta = ctx;
 	ctx->dash_io.delete_cache_file = dashdmx_io_delete_cache_file;
@@ -2804,6 +2829,9 @@ static Bool dashdmx_process_event(GF_Filter *filter, const GF_FilterEvent *fevt)
 		group->is_playing = GF_FALSE;
 		group->prev_is_init_segment = GF_FALSE;
 		group->init_from_media = GF_FALSE;
+#ifdef GPAC_USE_DOWNLOADER
+		if (group->prefetch) dashdmx_prefetch_reset(group);
+#endif
 		if (ctx->nb_playing) {
 			ctx->initial_play = GF_FALSE;
 			group->force_seg_switch = GF_TRUE;
@@ -2934,10 +2962,155 @@ static void dashdmx_notify_group_quality(GF_DASHDmxCtx *ctx, GF_DASHGroup *group
 
 GF_Err gf_dash_group_push_tfrf(GF_DashClient *dash, u32 idx, void *tfrf, u32 timescale);
 
+#ifdef GPAC_USE_DOWNLOADER
+static Bool dashdmx_prefetch_done(DashDmxPrefetch *pf)
+{
+	GF_NetIOStatus status;
+	gf_dm_sess_get_stats(pf->sess, NULL, NULL, NULL, NULL, NULL, &status);
+	return (status>=GF_NETIO_DATA_TRANSFERED) ? GF_TRUE : GF_FALSE;
+}
+
+static void dashdmx_prefetch_del(GF_DASHGroup *group, DashDmxPrefetch *pf, Bool discard)
+{
+	gf_list_del_item(group->prefetch, pf);
+	if (group->cur_prefetch == pf) group->cur_prefetch = NULL;
+	//segment was not consumed, drop its cache entry
+	if (discard) {
+		if (!dashdmx_prefetch_done(pf))
+			gf_dm_sess_abort(pf->sess);
+		gf_dm_delete_cached_file_entry_session(pf->sess, pf->url, GF_TRUE);
+	}
+	gf_dm_sess_del(pf->sess);
+	gf_free(pf->url);
+	gf_free(pf);
+}
+
+static void dashdmx_prefetch_reset(GF_DASHGroup *group)
+{
+	while (gf_list_count(group->prefetch)) {
+		DashDmxPrefetch *pf = gf_list_last(group->prefetch);
+		//the source filter may be reading from this download, let it complete
+		dashdmx_prefetch_del(group, pf, pf->used ? GF_FALSE : GF_TRUE);
+	}
+	gf_list_del(group->prefetch);
+	group->prefetch = NULL;
+}
+
+//returns GF_TRUE if the segment about to be sent to the source filter is still being fetched ahead
+static Bool dashdmx_prefetch_pending(GF_DASHGroup *group, const char *url, u64 start_range, u64 end_range)
+{
+	u32 i=0;
+	DashDmxPrefetch *pf;
+	while ((pf = gf_list_enum(group->prefetch, &i))) {
+		if (pf->used) continue;
+		if ((pf->start_range!=start_range) || (pf->end_range!=end_range) || strcmp(pf->url, url)) continue;
+		return dashdmx_prefetch_done(pf) ? GF_FALSE : GF_TRUE;
+	}
+	return GF_FALSE;
+}
+
+//returns GF_TRUE if the segment about to be sent to the source filter was fetched ahead
+static Bool dashdmx_prefetch_use(GF_DASHGroup *group, const char *url, u64 start_range, u64 end_range)
+{
+	u32 i;
+	DashDmxPrefetch *pf;
+	i=0;
+	while ((pf = gf_list_enum(group->prefetch, &i))) {
+		//previous segment is consumed, release the download once done
+		if (pf->used && dashdmx_prefetch_done(pf)) {
+			dashdmx_prefetch_del(group, pf, GF_FALSE);
+			i--;
+		}
+	}
+	group->cur_prefetch = NULL;
+	i=0;
+	while ((pf = gf_list_enum(group->prefetch, &i))) {
+		if (pf->used) continue;
+		if ((pf->start_range!=start_range) || (pf->end_range!=end_range) || strcmp(pf->url, url)) continue;
+		//failed download, let the source filter fetch the segment
+		if (dashdmx_prefetch_done(pf) && (gf_dm_sess_last_error(pf->sess)!=GF_OK)) {
+			dashdmx_prefetch_del(group, pf, GF_TRUE);
+			return GF_FALSE;
+		}
+		pf->used = GF_TRUE;
+		group->cur_prefetch = pf;
+		return GF_TRUE;
+	}
+	return GF_FALSE;
+}
+
+static void dashdmx_prefetch_update(GF_DASHDmxCtx *ctx, GF_DASHGroup *group)
+{
+	u32 i;
+	DashDmxPrefetch *pf;
+	GF_List *window;
+	if (!ctx->prefetch || group->in_is_cryptfile) return;
+
+	if (!group->prefetch) group->prefetch = gf_list_new();
+	window = gf_list_new();
+	for (i=0; i<ctx->prefetch; i++) {
+		u32 j;
+		char *url;
+		u64 start_range, end_range;
+		Bool found = GF_FALSE;
+		//stop at the first segment not available, outside the buffer or not allowed by the group state
+		GF_Err e = gf_dash_group_get_upcoming_segment(ctx->dash, group->idx, i, &url, &start_range, &end_range, NULL, NULL);
+		if (e) break;
+
+		j=0;
+		while ((pf = gf_list_enum(group->prefetch, &j))) {
+			if (pf->used || (pf->start_range!=start_range) || (pf->end_range!=end_range) || strcmp(pf->url, url)) continue;
+			found = GF_TRUE;
+			break;
+		}
+		if (found) {
+			gf_list_add(window, pf);
+			gf_free(url);
+			continue;
+		}
+		GF_SAFEALLOC(pf, DashDmxPrefetch);
+		if (!pf) {
+			gf_free(url);
+			break;
+		}
+		pf->url = url;
+		pf->start_range = start_range;
+		pf->end_range = end_range;
+		pf->sess = gf_dm_sess_new(ctx->dm, url, GF_NETIO_SESSION_PERSISTENT | (ctx->segstore ? 0 : GF_NETIO_SESSION_MEMORY_CACHE), NULL, NULL, &e);
+		if (pf->sess && (start_range || end_range))
+			e = gf_dm_sess_set_range(pf->sess, start_range, end_range, GF_TRUE);
+		if (!pf->sess || e) {
+			GF_LOG(GF_LOG_WARNING, GF_LOG_DASH, ("[DASHDmx] group %d failed to prefetch segment %s: %s\n", group->idx, url, gf_error_to_string(e) ));
+			if (pf->sess) gf_dm_sess_del(pf->sess);
+			gf_free(pf->url);
+			gf_free(pf);
+			break;
+		}
+		gf_dm_sess_set_netcap_id(pf->sess, gf_filter_get_netcap_id(ctx->filter));
+		gf_dm_sess_process(pf->sess);
+		GF_LOG(GF_LOG_DEBUG, GF_LOG_DASH, ("[DASHDmx] group %d prefetching segment %s\n", group->idx, url));
+		gf_list_add(group->prefetch, pf);
+		gf_list_add(window, pf);
+	}
+
+	//discard segments no longer ahead of the current one (representation switch, seek)
+	i=0;
+	while ((pf = gf_list_enum(group->prefetch, &i))) {
+		if (pf->used) continue;
+		if (gf_list_find(window, pf)<0) {
+			GF_LOG(GF_LOG_DEBUG, GF_LOG_DASH, ("[DASHDmx] group %d discarding prefetched segment %s\n", group->idx, pf->url));
+			dashdmx_prefetch_del(group, pf, GF_TRUE);
+			i--;
+		}
+	}
+	gf_list_del(window);
+}
+#endif
+
 static void dashdmx_update_group_stats(GF_DASHDmxCtx *ctx, GF_DASHGroup *group)
 {
 	u32 bytes_per_sec = 0;
-	u64 file_size = 0;
+	u64 file_size = 0, us_since_start;
 	u32 dep_rep_idx;
 	const GF_PropertyValue *p;
 	GF_PropertyEntry *pe=NULL;
@@ -2948,7 +3121,6 @@ static void dashdmx_update_group_stats(GF_DASHDmxCtx *ctx, GF_DASHGroup *group)
 
 	p = gf_filter_get_info(group->seg_filter_src, GF_PROP_PID_FILE_CACHED, &pe);
 	if (!p || !p->value.boolean) {
-		u64 us_since_start = 0;
 		u64 down_bytes = 0;
 		u32 bits_per_sec = 0;
 		u32 now = gf_sys_clock();
@@ -2992,7 +3164,21 @@ static void dashdmx_update_group_stats(GF_DASHDmxCtx *ctx, GF_DASHGroup *group)
 	else
 		dep_rep_idx = group->current_dependent_rep_idx;
 
-	gf_dash_group_store_stats(ctx->dash, group->idx, dep_rep_idx, bytes_per_sec, file_size, broadcast_flag, gf_sys_clock_high_res() - group->us_at_seg_start);
+	us_since_start = gf_sys_clock_high_res() - group->us_at_seg_start;
+#ifdef GPAC_USE_DOWNLOADER
+	//segment fetched ahead, the source filter only read it from cache: use the rate of the actual download
+	if (group->cur_prefetch) {
+		u64 pf_size=0;
+		u32 pf_rate=0;
+		gf_dm_sess_get_stats(group->cur_prefetch->sess, NULL, NULL, &pf_size, NULL, &pf_rate, NULL);
+		if (pf_size && pf_rate) {
+			file_size = pf_size;
+			bytes_per_sec = pf_rate;
+			us_since_start = pf_size * 1000000 / pf_rate;
+		}
+	}
+#endif
+	gf_dash_group_store_stats(ctx->dash, group->idx, dep_rep_idx, bytes_per_sec, file_size, broadcast_flag, us_since_start);
 
 	p = gf_filter_get_info(group->seg_filter_src, GF_PROP_PID_FILE_CACHED, &pe);
 	if (p && p->value.boolean)
@@ -3119,6 +3305,18 @@ fetch_next:
 		return;
 	}
 
+#ifdef GPAC_USE_DOWNLOADER
+	//the cache entry of a prefetched segment has a single writer, wait for its download to complete before switching
+	if (group->prefetch && !seg_disabled && (!next_url_init_or_switch_segment || group->init_switch_seg_sent)
+		&& dashdmx_prefetch_pending(group, next_url, start_range, end_range)
+	) {
+		group->seg_was_not_ready = GF_TRUE;
+		group->stats_uploaded = GF_TRUE;
+		gf_filter_ask_rt_reschedule(ctx->filter, 1000);
+		return;
+	}
+#endif
+
 	if (!has_scalable_next) {
 		group->next_dependent_rep_idx = 0;
 	} else {
@@ -3213,7 +3411,15 @@ fetch_next:
 	evt.seek.start_offset = start_range;
 	evt.seek.end_offset = end_range;
 	evt.seek.is_init_segment = GF_FALSE;
+#ifdef GPAC_USE_DOWNLOADER
+	//segment fetched ahead, read it from cache without revalidation
+	if (group->prefetch && dashdmx_prefetch_use(group, next_url, start_range, end_range))
+		evt.seek.skip_cache_expiration = GF_TRUE;
+#endif
 	gf_filter_send_event(group->seg_filter_src, &evt, GF_FALSE);
+#ifdef GPAC_USE_DOWNLOADER
+	dashdmx_prefetch_update(ctx, group);
+#endif
 }
 
 static GF_Err dashin_abort(GF_DASHDmxCtx *ctx)
@@ -3662,6 +3868,7 @@ static const GF_FilterArgs DASHDmxArgs[] =
 		"- no: disable low latency\n"
 		"- strict: strict respect of AST offset in low latency\n"
 		"- early: allow fetching segments earlier than their AST in low latency when input PID is empty", GF_PROP_UINT, "early", "no|strict|early", GF_FS_ARG_HINT_EXPERT},
+	{ OFFS(prefetch), "number of upcoming media segments of each group to download concurrently with the current one, limited by the buffer and the measured download rate (0 disables prefetching)", GF_PROP_UINT, "0", NULL, GF_FS_ARG_HINT_EXPERT},
 	{ OFFS(forward), "segment forwarding mode\n"
 		"- none: regular DASH read\n"
 		"- file: do not demultiplex files and forward them as file PIDs (imply `segstore=mem`)\n"
@@ -63,6 +63,34 @@ typedef struct {
 	Bool is_loc;
 } GF_M2TS_Prop_TEMIInfo;
 
+typedef struct _m2tsdmx_worker M2TSDmxWorker;
+
+//demuxer event recorded by a worker thread
+typedef struct
+{
+	u32 type;
+	union {
+		GF_M2TS_PES_PCK pck;
+		GF_M2TS_TemiLocationDescriptor temi_l;
+		GF_M2TS_TemiTimecodeDescriptor temi_t;
+	} u;
+	//payload or URL location in the program event data
+	u32 data_offset, data_len;
+	u64 frag_offset;
+} M2TSDmxEvent;
+
+//state of a program processed in parallel
+typedef struct
+{
+	//events recorded by the worker, sent once all programs are processed
+	M2TSDmxEvent *evts;
+	u32 nb_evts, alloc_evts;
+	u8 *data;
+	u32 data_size, data_alloc;
+	//last PCR stream, duration is estimated once all events are sent
+	GF_M2TS_ES *pcr_stream;
+} M2TSDmxProg;
+
 enum
 {
 	DMX_TUNE_DONE=0,
@@ -77,6 +105,7 @@ typedef struct
 	const char *temi_url;
 	Bool dsmcc, seeksrc, sigfrag, dvbtxt;
 	Double index;
+	s32 nbth;
 
 	GF_Filter *filter;
 	GF_FilterPid *ipid;
@@ -105,8 +134,25 @@ typedef struct
 
 	Bool is_dash;
 	u32 nb_stopped_at_init;
+
+	//parallel processing of programs
+	M2TSDmxWorker *workers;
+	u32 nb_workers;
+	GF_Semaphore *workers_done;
+	Bool workers_run, split_run, split_replay;
+	//programs with pending packets and next one to process
+	GF_List *split_progs;
+	u32 next_prog;
+	GF_List *prog_states;
 } GF_M2TSDmxCtx;
 
+struct _m2tsdmx_worker
+{
+	GF_M2TSDmxCtx *ctx;
+	GF_Thread *th;
+	GF_Semaphore *start;
+};
+
 static void m2tsdmx_prop_free(GF_M2TS_Prop *prop) {
 
 	if (prop->type == M2TS_ID3) {
@@ -135,14 +181,14 @@ static void m2tsdmx_estimate_duration(GF_M2TSDmxCtx *ctx, GF_M2TS_ES *stream)
 	if (!ctx->first_pcr_found) {
 		ctx->first_pcr_found = stream->program->last_pcr_value;
 		ctx->pcr_pid = stream->pid;
-		ctx->nb_pck_at_pcr = ctx->ts->pck_number;
+		ctx->nb_pck_at_pcr = stream->program->last_pcr_value_pck_number;
 		return;
 	}
 	if (ctx->pcr_pid != stream->pid) return;
 	if (stream->program->last_pcr_value < ctx->first_pcr_found) {
 		ctx->first_pcr_found = stream->program->last_pcr_value;
 		ctx->pcr_pid = stream->pid;
-		ctx->nb_pck_at_pcr = ctx->ts->pck_number;
+		ctx->nb_pck_at_pcr = stream->program->last_pcr_value_pck_number;
 		return;
 	}
 	if (stream->program->last_pcr_value - ctx->first_pcr_found <= 2*27000000)
@@ -151,7 +197,7 @@ static void m2tsdmx_estimate_duration(GF_M2TSDmxCtx *ctx, GF_M2TS_ES *stream)
 	changed = GF_FALSE;
 
 	pck_dur = (Double) (stream->program->last_pcr_value - ctx->first_pcr_found);
-	pck_dur /= (ctx->ts->pck_number - ctx->nb_pck_at_pcr);
+	pck_dur /= (stream->program->last_pcr_value_pck_number - ctx->nb_pck_at_pcr);
 	pck_dur /= 27000;
 
 	pck_dur *= ctx->file_size;
@@ -163,7 +209,7 @@ static void m2tsdmx_estimate_duration(GF_M2TSDmxCtx *ctx, GF_M2TS_ES *stream)
 	}
 	ctx->first_pcr_found = stream->program->last_pcr_value;
 	ctx->pcr_pid = stream->pid;
-	ctx->nb_pck_at_pcr = ctx->ts->pck_number;
+	ctx->nb_pck_at_pcr = stream->program->last_pcr_value_pck_number;
 	GF_LOG(GF_LOG_DEBUG, GF_LOG_CONTAINER, ("[M2TSDmx] Estimated duration based on instant bitrate: %g sec\n", pck_dur/1000));
 
 	if (changed) {
@@ -736,7 +782,20 @@ static void m2tdmx_merge_props(GF_FilterPid *pid, GF_M2TS_ES *stream, GF_FilterP
 	}
 }
 
-static void m2tsdmx_send_packet(GF_M2TSDmxCtx *ctx, GF_M2TS_PES_PCK *pck)
+static u64 m2tsdmx_get_frag_offset(GF_M2TSDmxCtx *ctx, GF_M2TS_PES *stream)
+{
+	u64 pat_offset;
+	if (stream->flags & GF_M2TS_ES_IS_PES) {
+		pat_offset = stream->before_last_pes_start_pn;
+		if (pat_offset>stream->before_last_pat_pn)
+			pat_offset = stream->before_last_pat_pn;
+	} else {
+		pat_offset = ctx->ts->last_pat_start_num;
+	}
+	return pat_offset * (ctx->ts->prefix_present ? 192 : 188);
+}
+
+static void m2tsdmx_send_packet(GF_M2TSDmxCtx *ctx, GF_M2TS_PES_PCK *pck, u64 frag_offset)
 {
 	GF_FilterPid *opid;
 	GF_FilterPacket *dst_pck;
@@ -838,22 +897,101 @@ static void m2tsdmx_send_packet(GF_M2TSDmxCtx *ctx, GF_M2TS_PES_PCK *pck)
 		gf_filter_pck_set_property(dst_pck, GF_PROP_PCK_CUE_START, &PROP_BOOL(GF_TRUE));
 	}
 	if (ctx->sigfrag) {
-		u64 pat_offset;
-
-		if (pck->stream->flags & GF_M2TS_ES_IS_PES) {
-			pat_offset = pck->stream->before_last_pes_start_pn;
-			if (pat_offset>pck->stream->before_last_pat_pn)
-				pat_offset = pck->stream->before_last_pat_pn;
-		} else {
-			pat_offset = ctx->ts->last_pat_start_num;
-		}
-		pat_offset *= (ctx->ts->prefix_present ? 192 : 188);
-		gf_filter_pck_set_property(dst_pck, GF_PROP_PCK_FRAG_RANGE, &PROP_FRAC64_INT(pat_offset, 0));
+		gf_filter_pck_set_property(dst_pck, GF_PROP_PCK_FRAG_RANGE, &PROP_FRAC64_INT(frag_offset, 0));
 	}
 	gf_filter_pck_send(dst_pck);
 	ctx->nb_stop_pending = 0;
 }
 
+//events of programs processed in parallel are only recorded by the worker threads, no filter API is called
+//the recorded events are sent from the filter thread in program order once all workers are done
+static void m2tsdmx_record_event(GF_M2TSDmxCtx *ctx, u32 evt_type, void *param)
+{
+	M2TSDmxProg *sp;
+	M2TSDmxEvent *evt;
+	GF_M2TS_Program *prog = NULL;
+	const u8 *data = NULL;
+	u32 data_len = 0;
+
+	switch (evt_type) {
+	case GF_M2TS_EVT_PES_PCK:
+	case GF_M2TS_EVT_PES_PCR:
+	case GF_M2TS_EVT_ID3:
+		if ((evt_type != GF_M2TS_EVT_ID3) && ctx->mux_tune_state) return;
+		prog = ((GF_M2TS_PES_PCK *) param)->stream->program;
+		if (evt_type != GF_M2TS_EVT_PES_PCR) {
+			data = ((GF_M2TS_PES_PCK *) param)->data;
+			data_len = ((GF_M2TS_PES_PCK *) param)->data_len;
+		}
+		break;
+	case GF_M2TS_EVT_TEMI_LOCATION:
+	{
+		GF_M2TS_TemiLocationDescriptor *temi_l = (GF_M2TS_TemiLocationDescriptor *)param;
+		if ((temi_l->pid<8192) && ctx->ts->ess[temi_l->pid])
+			prog = ctx->ts->ess[temi_l->pid]->program;
+		if (temi_l->external_URL) {
+			data = temi_l->external_URL;
+			data_len = (u32) strlen(temi_l->external_URL) + 1;
+		}
+	}
+		break;
+	case GF_M2TS_EVT_TEMI_TIMECODE:
+	{
+		GF_M2TS_TemiTimecodeDescriptor *temi_t = (GF_M2TS_TemiTimecodeDescriptor *)param;
+		if ((temi_t->pid<8192) && ctx->ts->ess[temi_t->pid])
+			prog = ctx->ts->ess[temi_t->pid]->program;
+	}
+		break;
+	//other events are not sent for programs processed in parallel
+	default:
+		return;
+	}
+	//not assigned to a PID, ignored when sent
+	if (!prog || !prog->user) return;
+	sp = prog->user;
+
+	if (sp->nb_evts == sp->alloc_evts) {
+		u32 new_alloc = sp->alloc_evts ? 2*sp->alloc_evts : 64;
+		evt = gf_realloc(sp->evts, sizeof(M2TSDmxEvent) * new_alloc);
+		if (!evt) goto err_exit;
+		sp->evts = evt;
+		sp->alloc_evts = new_alloc;
+	}
+	if (sp->data_size + data_len > sp->data_alloc) {
+		u32 new_alloc = MAX(2*sp->data_alloc, sp->data_size + data_len);
+		u8 *new_data = gf_realloc(sp->data, new_alloc);
+		if (!new_data) goto err_exit;
+		sp->data = new_data;
+		sp->data_alloc = new_alloc;
+	}
+	evt = &sp->evts[sp->nb_evts];
+	sp->nb_evts++;
+	evt->type = evt_type;
+	switch (evt_type) {
+	case GF_M2TS_EVT_TEMI_LOCATION:
+		evt->u.temi_l = *(GF_M2TS_TemiLocationDescriptor *)param;
+		break;
+	case GF_M2TS_EVT_TEMI_TIMECODE:
+		evt->u.temi_t = *(GF_M2TS_TemiTimecodeDescriptor *)param;
+		break;
+	default:
+		evt->u.pck = *(GF_M2TS_PES_PCK *)param;
+		break;
+	}
+	evt->data_offset = sp->data_size;
+	evt->data_len = data_len;
+	if (data_len) memcpy(sp->data + sp->data_size, data, data_len);
+	sp->data_size += data_len;
+	//parser state at the time of the event
+	evt->frag_offset = 0;
+	if ((evt_type==GF_M2TS_EVT_PES_PCK) && ctx->sigfrag)
+		evt->frag_offset = m2tsdmx_get_frag_offset(ctx, evt->u.pck.stream);
+	return;
+
+err_exit:
+	GF_LOG(GF_LOG_ERROR, GF_LOG_CONTAINER, ("[M2TSDmx] Failed to record event for program %d, discarding\n", prog->number));
+}
+
 static GF_M2TS_ES *m2tsdmx_get_m4sys_stream(GF_M2TSDmxCtx *ctx, u32 m4sys_es_id)
 {
 	u32 i, j, count, count2;
@@ -992,6 +1130,11 @@ static void m2tsdmx_on_event(GF_M2TS_Demuxer *ts, u32 evt_type, void *param)
 	GF_Filter *filter = (GF_Filter *) ts->user;
 	GF_M2TSDmxCtx *ctx = gf_filter_get_udta(filter);
 
+	if (ctx->split_run) {
+		m2tsdmx_record_event(ctx, evt_type, param);
+		return;
+	}
+
 	switch (evt_type) {
 	case GF_M2TS_EVT_PAT_UPDATE:
 		break;
@@ -1039,7 +1182,7 @@ static void m2tsdmx_on_event(GF_M2TS_Demuxer *ts, u32 evt_type, void *param)
 		break;
 	case GF_M2TS_EVT_PES_PCK:
 		if (ctx->mux_tune_state) break;
-		m2tsdmx_send_packet(ctx, param);
+		m2tsdmx_send_packet(ctx, param, ctx->sigfrag ? m2tsdmx_get_frag_offset(ctx, ((GF_M2TS_PES_PCK *) param)->stream) : 0);
 		break;
 	case GF_M2TS_EVT_SL_PCK: /* DMB specific */
 		if (ctx->mux_tune_state) break;
@@ -1055,7 +1198,10 @@ static void m2tsdmx_on_event(GF_M2TS_Demuxer *ts, u32 evt_type, void *param)
 
 		gf_fatal_assert(pck->stream);
 		if (!ctx->sigfrag && ctx->index) {
-			m2tsdmx_estimate_duration(ctx, (GF_M2TS_ES *) pck->stream);
+			if (ctx->split_replay)
+				((M2TSDmxProg *) pck->stream->program->user)->pcr_stream = (GF_M2TS_ES *) pck->stream;
+			else
+				m2tsdmx_estimate_duration(ctx, (GF_M2TS_ES *) pck->stream);
 		}
 
 		if (ctx->map_time_on_prog_id && (ctx->map_time_on_prog_id==pck->stream->program->number)) {
@@ -1374,6 +1520,7 @@ static GF_Err m2tsdmx_configure_pid(GF_Filter *filter, GF_FilterPid *pid, Bool i
 		ctx->is_file = GF_TRUE;
 		if (stream) {
 			ctx->ts->seek_mode = GF_TRUE;
+			ctx->ts->split_programs = GF_FALSE;
 			ctx->ts->on_event = m2tsdmx_on_event_duration_probe;
 			while (!gf_feof(stream)) {
 				char buf[1880];
@@ -1386,6 +1533,7 @@ static GF_Err m2tsdmx_configure_pid(GF_Filter *filter, GF_FilterPid *pid, Bool i
 			ctx->ts = gf_m2ts_demux_new();
 			ctx->ts->on_event = m2tsdmx_on_event;
 			ctx->ts->user = filter;
+			ctx->ts->split_programs = (ctx->nb_workers>1) ? GF_TRUE : GF_FALSE;
 		}
 	} else if (!p) {
 		GF_FilterEvent evt;
@@ -1583,6 +1731,188 @@ static Bool m2tsdmx_process_event(GF_Filter *filter, const GF_FilterEvent *com)
 
 
 
+//sends events recorded for a program processed in parallel
+static void m2tsdmx_send_events(GF_M2TSDmxCtx *ctx, M2TSDmxProg *sp)
+{
+	u32 i;
+	for (i=0; i<sp->nb_evts; i++) {
+		M2TSDmxEvent *evt = &sp->evts[i];
+		switch (evt->type) {
+		case GF_M2TS_EVT_PES_PCK:
+			evt->u.pck.data = sp->data + evt->data_offset;
+			m2tsdmx_send_packet(ctx, &evt->u.pck, evt->frag_offset);
+			break;
+		case GF_M2TS_EVT_ID3:
+			evt->u.pck.data = sp->data + evt->data_offset;
+			m2tsdmx_on_event(ctx->ts, evt->type, &evt->u.pck);
+			break;
+		case GF_M2TS_EVT_TEMI_LOCATION:
+			evt->u.temi_l.external_URL = evt->data_len ? (const char *) sp->data + evt->data_offset : NULL;
+			m2tsdmx_on_event(ctx->ts, evt->type, &evt->u.temi_l);
+			break;
+		default:
+			m2tsdmx_on_event(ctx->ts, evt->type, &evt->u);
+			break;
+		}
+	}
+	sp->nb_evts = 0;
+	sp->data_size = 0;
+}
+
+static void m2tsdmx_run_programs(GF_M2TSDmxCtx *ctx)
+{
+	u32 count = gf_list_count(ctx->split_progs);
+	while (1) {
+		GF_M2TS_Program *prog;
+		u32 idx = (u32) safe_int_inc(&ctx->next_prog) - 1;
+		if (idx >= count) break;
+		prog = gf_list_get(ctx->split_progs, idx);
+		gf_m2ts_process_program(ctx->ts, prog);
+	}
+}
+
+static u32 m2tsdmx_worker_thread(void *par)
+{
+	M2TSDmxWorker *wk = par;
+	GF_M2TSDmxCtx *ctx = wk->ctx;
+	while (1) {
+		gf_sema_wait(wk->start);
+		if (!ctx->workers_run) break;
+		m2tsdmx_run_programs(ctx);
+		gf_sema_notify(ctx->workers_done, 1);
+	}
+	return 0;
+}
+
+static void m2tsdmx_del_workers(GF_M2TSDmxCtx *ctx)
+{
+	u32 i;
+	if (!ctx->workers) return;
+
+	ctx->workers_run = GF_FALSE;
+	for (i=1; i<ctx->nb_workers; i++) {
+		gf_sema_notify(ctx->workers[i].start, 1);
+	}
+	for (i=1; i<ctx->nb_workers; i++) {
+		M2TSDmxWorker *wk = &ctx->workers[i];
+		gf_th_stop(wk->th);
+		gf_th_del(wk->th);
+		gf_sema_del(wk->start);
+	}
+	gf_free(ctx->workers);
+	ctx->workers = NULL;
+	ctx->nb_workers = 0;
+	if (ctx->workers_done) gf_sema_del(ctx->workers_done);
+	ctx->workers_done = NULL;
+}
+
+static GF_Err m2tsdmx_setup_workers(GF_M2TSDmxCtx *ctx)
+{
+	u32 i, nb_threads = 0;
+#ifndef GPAC_DISABLE_THREADS
+	if (!gf_opts_get_bool("core", "no-mx")) {
+		if (ctx->nbth < 0) {
+			GF_SystemRTInfo rti;
+			gf_sys_get_rti(0, &rti, 0);
+			if (rti.nb_cores>1) nb_threads = rti.nb_cores-1;
+		} else {
+			nb_threads = ctx->nbth;
+		}
+	}
+#endif
+	if (!nb_threads) return GF_OK;
+
+	ctx->workers = gf_malloc(sizeof(M2TSDmxWorker) * (nb_threads+1));
+	if (!ctx->workers) return GF_OUT_OF_MEM;
+	memset(ctx->workers, 0, sizeof(M2TSDmxWorker) * (nb_threads+1));
+	ctx->nb_workers = 1;
+	ctx->workers[0].ctx = ctx;
+	ctx->workers_run = GF_TRUE;
+	ctx->workers_done = gf_sema_new(nb_threads, 0);
+	if (!ctx->workers_done) nb_threads = 0;
+
+	for (i=1; i<=nb_threads; i++) {
+		char szName[100];
+		M2TSDmxWorker *wk = &ctx->workers[i];
+		sprintf(szName, "m2tsdmx_%d", i);
+		wk->ctx = ctx;
+		wk->th = gf_th_new(szName);
+		wk->start = gf_sema_new(1, 0);
+		if (!wk->th || !wk->start || gf_th_run(wk->th, m2tsdmx_worker_thread, wk)) {
+			if (wk->th) gf_th_del(wk->th);
+			if (wk->start) gf_sema_del(wk->start);
+			wk->th = NULL;
+			wk->start = NULL;
+			break;
+		}
+		ctx->nb_workers++;
+	}
+	ctx->split_progs = gf_list_new();
+	ctx->prog_states = gf_list_new();
+	if (!ctx->split_progs || !ctx->prog_states) return GF_OUT_OF_MEM;
+	if (ctx->nb_workers>1) {
+		GF_LOG(GF_LOG_INFO, GF_LOG_CONTAINER, ("[M2TSDmx] Processing programs using %d threads\n", ctx->nb_workers));
+	}
+	return GF_OK;
+}
+
+//process packets queued by the demuxer for programs carrying only PES streams
+static void m2tsdmx_process_programs(GF_M2TSDmxCtx *ctx)
+{
+	u32 i, count, nb_run, nb_wake;
+
+	gf_list_reset(ctx->split_progs);
+	count = gf_list_count(ctx->ts->programs);
+	for (i=0; i<count; i++) {
+		GF_M2TS_Program *prog = gf_list_get(ctx->ts->programs, i);
+		if (!prog->nb_pending) continue;
+		if (!prog->user) {
+			M2TSDmxProg *sp;
+			GF_SAFEALLOC(sp, M2TSDmxProg);
+			if (!sp) {
+				gf_m2ts_process_program(ctx->ts, prog);
+				continue;
+			}
+			gf_list_add(ctx->prog_states, sp);
+			prog->user = sp;
+		}
+		gf_list_add(ctx->split_progs, prog);
+	}
+	nb_run = gf_list_count(ctx->split_progs);
+	if (!nb_run) return;
+
+	//nothing to parallelize, packets are sent directly
+	if (nb_run==1) {
+		gf_m2ts_process_program(ctx->ts, gf_list_get(ctx->split_progs, 0));
+		return;
+	}
+
+	ctx->split_run = GF_TRUE;
+	ctx->next_prog = 0;
+	nb_wake = MIN(nb_run, ctx->nb_workers) - 1;
+	for (i=1; i<=nb_wake; i++) {
+		gf_sema_notify(ctx->workers[i].start, 1);
+	}
+	m2tsdmx_run_programs(ctx);
+	for (i=0; i<nb_wake; i++) {
+		gf_sema_wait(ctx->workers_done);
+	}
+	ctx->split_run = GF_FALSE;
+
+	ctx->split_replay = GF_TRUE;
+	for (i=0; i<nb_run; i++) {
+		GF_M2TS_Program *prog = gf_list_get(ctx->split_progs, i);
+		M2TSDmxProg *sp = prog->user;
+		m2tsdmx_send_events(ctx, sp);
+		if (sp->pcr_stream) {
+			m2tsdmx_estimate_duration(ctx, sp->pcr_stream);
+			sp->pcr_stream = NULL;
+		}
+	}
+	ctx->split_replay = GF_FALSE;
+}
+
+
 static GF_Err m2tsdmx_initialize(GF_Filter *filter)
 {
 	GF_M2TSDmxCtx *ctx = gf_filter_get_udta(filter);
@@ -1597,6 +1927,12 @@ static GF_Err m2tsdmx_initialize(GF_Filter *filter)
 	if (ctx->dsmcc) {
 		gf_m2ts_demux_dmscc_init(ctx->ts);
 	}
+	if (ctx->nbth) {
+		GF_Err e = m2tsdmx_setup_workers(ctx);
+		if (e) return e;
+		if (ctx->nb_workers>1)
+			ctx->ts->split_programs = GF_TRUE;
+	}
 
 	return GF_OK;
 }
@@ -1605,8 +1941,19 @@ static GF_Err m2tsdmx_initialize(GF_Filter *filter)
 static void m2tsdmx_finalize(GF_Filter *filter)
 {
 	GF_M2TSDmxCtx *ctx = gf_filter_get_udta(filter);
+	m2tsdmx_del_workers(ctx);
 	if (ctx->ts) gf_m2ts_demux_del(ctx->ts);
 
+	if (ctx->prog_states) {
+		while (gf_list_count(ctx->prog_states)) {
+			M2TSDmxProg *sp = gf_list_pop_back(ctx->prog_states);
+			if (sp->evts) gf_free(sp->evts);
+			if (sp->data) gf_free(sp->data);
+			gf_free(sp);
+		}
+		gf_list_del(ctx->prog_states);
+	}
+	if (ctx->split_progs) gf_list_del(ctx->split_progs);
 }
 
 #define M2TS_MAX_LOOPS	50
@@ -1677,8 +2024,11 @@ restart:
 	}
 
 	data = gf_filter_pck_get_data(pck, &size);
-	if (data && size)
+	if (data && size) {
 		gf_m2ts_process_data(ctx->ts, (char*) data, size);
+		if (ctx->ts->split_programs)
+			m2tsdmx_process_programs(ctx);
+	}
 
 	gf_filter_pid_drop_packet(ctx->ipid);
 
@@ -1731,6 +2081,7 @@ static const GF_FilterArgs M2TSDmxArgs[] =
 	{ OFFS(sigfrag), "signal segment boundaries on output packets for DASH or HLS sources", GF_PROP_BOOL, "false", NULL, GF_FS_ARG_HINT_ADVANCED},
 	{ OFFS(dvbtxt), "export DVB teletext streams", GF_PROP_BOOL, "false", NULL, GF_FS_ARG_HINT_EXPERT},
 	{ OFFS(index), "indexing window length", GF_PROP_DOUBLE, "1.0", NULL, GF_FS_ARG_HINT_HIDE},
+	{ OFFS(nbth), "number of threads used to process programs in parallel, 0 disables parallel processing and -1 uses all cores minus one", GF_PROP_SINT, "0", NULL, GF_FS_ARG_HINT_EXPERT},
 	{0}
 };
 
@@ -1738,7 +2089,12 @@ static const GF_FilterArgs M2TSDmxArgs[] =
 GF_FilterRegister M2TSDmxRegister = {
 	.name = "m2tsdmx",
 	GF_FS_SET_DESCRIPTION("MPEG-2 TS demultiplexer")
-	GF_FS_SET_HELP("This filter demultiplexes MPEG-2 Transport Stream files/data into a set of media PIDs and frames.")
+	GF_FS_SET_HELP("This filter demultiplexes MPEG-2 Transport Stream files/data into a set of media PIDs and frames.\n"
+	"\n"
+	"When [-nbth]() is not 0, programs carrying only PES streams are processed in parallel, each program being handled by a single thread. "
+	"PAT, PMT and other sections are still processed sequentially, and packets of each program are dispatched in order once all programs are processed for the current input block.\n"
+	"In this mode, packets of different programs are no longer interleaved as in the source multiplex, and TDT time mapping may be off by one input block.\n"
+	)
 	.private_size = sizeof(GF_M2TSDmxCtx),
 	.initialize = m2tsdmx_initialize,
 	.finalize = m2tsdmx_finalize,
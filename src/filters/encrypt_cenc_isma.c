@@ -30,6 +30,7 @@
 #include <gpac/base_coding.h>
 #include <gpac/download.h>
 #include <gpac/xml.h>
+#include <gpac/thread.h>
 #include <gpac/internal/isomedia_dev.h>
 
 #include <gpac/internal/media_dev.h>
@@ -69,6 +70,34 @@ typedef struct
 	u32 clear, encrypted;
 } OBURange;
 
+//range of sample data to encrypt with a given key
+typedef struct
+{
+	u32 offset, size;
+	u32 key_idx;
+	//cbcs with constant IV, IV is reset before the range
+	Bool reset_IV;
+} CENCCryptRange;
+
+//encryption of one sample, possibly deferred to worker threads
+typedef struct
+{
+	//packet to send, data is encrypted in place
+	GF_FilterPacket *pck;
+	u8 *output;
+	//ranges to encrypt, none if the packet is only sent
+	CENCCryptRange *ranges;
+	u32 nb_ranges, alloc_ranges;
+	//keys and IVs at sample start, crypt contexts not used
+	CENC_MKey *keys;
+	u32 nb_keys, alloc_keys;
+	Bool ctr_mode;
+	u32 crypt_byte_block, skip_byte_block;
+	GF_Err e;
+} CENCJob;
+
+typedef struct _cenc_worker CENCWorker;
+
 typedef struct
 {
 	Bool passthrough;
@@ -142,13 +171,39 @@ typedef struct
 	const char *cfile;
 	Bool allc, bk_stats, bk_skip;
 
+	s32 nbth;
+
 	//internal
 	GF_CryptInfo *cinfo;
 
 	GF_List *streams;
 	GF_BitStream *bs_w, *bs_r;
+
+	//gathered blocks for pattern encryption
+	u8 *pattern_buf;
+	u32 pattern_buf_size;
+
+	//samples encrypted in parallel, sent in order once all workers are done
+	CENCJob *jobs;
+	u32 nb_jobs, alloc_jobs, next_job, max_jobs;
+	CENCWorker *workers;
+	u32 nb_workers;
+	GF_Semaphore *workers_done;
+	Bool workers_run;
 } GF_CENCEncCtx;
 
+struct _cenc_worker
+{
+	GF_CENCEncCtx *ctx;
+	GF_Thread *th;
+	GF_Semaphore *start;
+	//per-worker crypt contexts, for CBC [0] and CTR [1]
+	CENC_MKey *keys[2];
+	u32 nb_keys[2];
+	u8 *pattern_buf;
+	u32 pattern_buf_size;
+};
+
 
 static GF_Err isma_enc_configure(GF_CENCEncCtx *ctx, GF_CENCStream *cstr, Bool is_isma, const char *scheme_uri, const char *kms_uri)
 {
@@ -1693,6 +1748,342 @@ static u32 cenc_get_clear_bytes(GF_CENCStream *cstr, GF_BitStream *plaintext_bs,
 }
 #endif
 
+//number of bytes encrypted in a range using crypt_byte_block / skip_byte_block pattern
+static u32 cenc_pattern_crypt_size(u32 size, u32 crypt_byte_block, u32 skip_byte_block)
+{
+	u32 stride = 16 * (crypt_byte_block + skip_byte_block);
+	u32 rem = size % stride;
+	return (size / stride) * 16 * crypt_byte_block + MIN(rem, 16 * crypt_byte_block);
+}
+
+static GF_Err cenc_crypt_range(CENC_MKey *key, CENCCryptRange *range, u8 *output, u32 crypt_byte_block, u32 skip_byte_block, u8 **pattern_buf, u32 *pattern_buf_size)
+{
+	GF_Err e;
+	u32 pos, res, nb_bytes, done;
+
+	if (range->reset_IV)
+		gf_crypt_set_IV(key->crypt, key->IV, 16);
+
+	if (!crypt_byte_block || !skip_byte_block)
+		return gf_crypt_encrypt(key->crypt, output + range->offset, range->size);
+
+	//pattern encryption: the key stream (CTR) or block chaining (CBC) only covers encrypted blocks,
+	//gather them to encrypt in one call rather than one call per 16*crypt_byte_block bytes
+	nb_bytes = cenc_pattern_crypt_size(range->size, crypt_byte_block, skip_byte_block);
+	if (*pattern_buf_size < nb_bytes) {
+		*pattern_buf = gf_realloc(*pattern_buf, nb_bytes);
+		if (! *pattern_buf) {
+			*pattern_buf_size = 0;
+			return GF_OUT_OF_MEM;
+		}
+		*pattern_buf_size = nb_bytes;
+	}
+	pos = range->offset;
+	res = range->size;
+	done = 0;
+	while (res) {
+		u32 to_crypt = (res >= 16*crypt_byte_block) ? 16*crypt_byte_block : res;
+		memcpy(*pattern_buf + done, output + pos, to_crypt);
+		done += to_crypt;
+		if (res >= 16 * (crypt_byte_block + skip_byte_block)) {
+			pos += 16 * (crypt_byte_block + skip_byte_block);
+			res -= 16 * (crypt_byte_block + skip_byte_block);
+		} else {
+			res = 0;
+		}
+	}
+	e = gf_crypt_encrypt(key->crypt, *pattern_buf, nb_bytes);
+	if (e) return e;
+
+	pos = range->offset;
+	res = range->size;
+	done = 0;
+	while (res) {
+		u32 to_crypt = (res >= 16*crypt_byte_block) ? 16*crypt_byte_block : res;
+		memcpy(output + pos, *pattern_buf + done, to_crypt);
+		done += to_crypt;
+		if (res >= 16 * (crypt_byte_block + skip_byte_block)) {
+			pos += 16 * (crypt_byte_block + skip_byte_block);
+			res -= 16 * (crypt_byte_block + skip_byte_block);
+		} else {
+			res = 0;
+		}
+	}
+	return GF_OK;
+}
+
+static GF_Err cenc_crypt_job(CENCJob *job, CENC_MKey *keys, u8 **pattern_buf, u32 *pattern_buf_size)
+{
+	u32 i;
+	for (i=0; i<job->nb_ranges; i++) {
+		CENCCryptRange *range = &job->ranges[i];
+		GF_Err e = cenc_crypt_range(&keys[range->key_idx], range, job->output, job->crypt_byte_block, job->skip_byte_block, pattern_buf, pattern_buf_size);
+		if (e) return e;
+	}
+	return GF_OK;
+}
+
+static GF_Err cenc_job_add_range(CENCJob *job, u32 offset, u32 size, u32 key_idx, Bool reset_IV)
+{
+	CENCCryptRange *range;
+	if (!size) return GF_OK;
+	if (job->nb_ranges == job->alloc_ranges) {
+		u32 alloc = job->alloc_ranges ? 2*job->alloc_ranges : 10;
+		CENCCryptRange *ranges = gf_realloc(job->ranges, sizeof(CENCCryptRange) * alloc);
+		if (!ranges) return GF_OUT_OF_MEM;
+		job->ranges = ranges;
+		job->alloc_ranges = alloc;
+	}
+	range = &job->ranges[job->nb_ranges];
+	range->offset = offset;
+	range->size = size;
+	range->key_idx = key_idx;
+	range->reset_IV = reset_IV;
+	job->nb_ranges++;
+	return GF_OK;
+}
+
+//returns the next job slot, only queued once nb_jobs is incremented
+static CENCJob *cenc_get_job(GF_CENCEncCtx *ctx)
+{
+	CENCJob *job;
+	if (ctx->nb_jobs == ctx->alloc_jobs) {
+		u32 alloc = ctx->alloc_jobs ? 2*ctx->alloc_jobs : 8;
+		CENCJob *jobs = gf_realloc(ctx->jobs, sizeof(CENCJob) * alloc);
+		if (!jobs) return NULL;
+		memset(jobs + ctx->alloc_jobs, 0, sizeof(CENCJob) * (alloc - ctx->alloc_jobs));
+		ctx->jobs = jobs;
+		ctx->alloc_jobs = alloc;
+	}
+	job = &ctx->jobs[ctx->nb_jobs];
+	job->pck = NULL;
+	job->output = NULL;
+	job->nb_ranges = 0;
+	job->nb_keys = 0;
+	job->e = GF_OK;
+	return job;
+}
+
+//sends packet, or queues it after the samples being encrypted in parallel
+static GF_Err cenc_send_packet(GF_CENCEncCtx *ctx, GF_FilterPacket *pck)
+{
+	CENCJob *job;
+	if (!ctx->nb_jobs) return gf_filter_pck_send(pck);
+
+	job = cenc_get_job(ctx);
+	if (!job) {
+		gf_filter_pck_discard(pck);
+		return GF_OUT_OF_MEM;
+	}
+	job->pck = pck;
+	ctx->nb_jobs++;
+	return GF_OK;
+}
+
+//samples can be encrypted independently of the previous ones unless using CBC with per-sample IVs, where the IV is the last cipher block of the previous sample
+static Bool cenc_can_defer(GF_CENCEncCtx *ctx, GF_CENCStream *cstr)
+{
+	u32 i, nb_keys;
+	if (ctx->nb_workers<2) return GF_FALSE;
+	//SAES inserts emulation prevention bytes after encryption
+	if (cstr->is_saes) return GF_FALSE;
+	if (cstr->ctr_mode) return GF_TRUE;
+	nb_keys = cstr->multi_key ? cstr->tci->nb_keys : 1;
+	for (i=0; i<nb_keys; i++) {
+		if (cstr->tci->keys[i].IV_size) return GF_FALSE;
+	}
+	return GF_TRUE;
+}
+
+//sets the CTR state reached after encrypting nb_bytes from the sample IV, then computes next sample IV
+static void cenc_advance_IV(CENC_MKey *key, u8 IV_size, u64 nb_bytes)
+{
+	char next_IV[17];
+	u64 nb_blocks = (nb_bytes + 15) / 16;
+	s32 i;
+
+	memcpy(next_IV+1, key->IV, 16);
+	for (i=16; (i>0) && nb_blocks; i--) {
+		nb_blocks += (u8) next_IV[i];
+		next_IV[i] = (char) (nb_blocks & 0xFF);
+		nb_blocks >>= 8;
+	}
+	next_IV[0] = (char) (nb_bytes % 16);
+	gf_crypt_set_IV(key->crypt, next_IV, 17);
+	cenc_resync_IV(key->crypt, key->IV, IV_size);
+}
+
+static GF_Err cenc_run_job(CENCWorker *wk, CENCJob *job)
+{
+	u32 i, mode = job->ctr_mode ? 1 : 0;
+	CENC_MKey *keys;
+
+	if (!job->nb_ranges) return GF_OK;
+
+	if (wk->nb_keys[mode] < job->nb_keys) {
+		keys = gf_realloc(wk->keys[mode], sizeof(CENC_MKey) * job->nb_keys);
+		if (!keys) return GF_OUT_OF_MEM;
+		memset(keys + wk->nb_keys[mode], 0, sizeof(CENC_MKey) * (job->nb_keys - wk->nb_keys[mode]));
+		wk->keys[mode] = keys;
+		wk->nb_keys[mode] = job->nb_keys;
+	}
+	keys = wk->keys[mode];
+	for (i=0; i<job->nb_keys; i++) {
+		GF_Err e;
+		if (!keys[i].crypt) {
+			keys[i].crypt = gf_crypt_open(GF_AES_128, job->ctr_mode ? GF_CTR : GF_CBC);
+			if (!keys[i].crypt) return GF_IO_ERR;
+		}
+		memcpy(keys[i].key, job->keys[i].key, 16);
+		memcpy(keys[i].IV, job->keys[i].IV, 16);
+		e = gf_crypt_init(keys[i].crypt, keys[i].key, keys[i].IV);
+		if (e) {
+			//context is destroyed upon init failure
+			keys[i].crypt = NULL;
+			return e;
+		}
+	}
+	return cenc_crypt_job(job, keys, &wk->pattern_buf, &wk->pattern_buf_size);
+}
+
+static void cenc_run_jobs(CENCWorker *wk)
+{
+	GF_CENCEncCtx *ctx = wk->ctx;
+	while (1) {
+		CENCJob *job;
+		u32 idx = (u32) safe_int_inc(&ctx->next_job) - 1;
+		if (idx >= ctx->nb_jobs) break;
+		job = &ctx->jobs[idx];
+		job->e = cenc_run_job(wk, job);
+	}
+}
+
+static u32 cenc_worker_thread(void *par)
+{
+	CENCWorker *wk = par;
+	GF_CENCEncCtx *ctx = wk->ctx;
+	while (1) {
+		gf_sema_wait(wk->start);
+		if (!ctx->workers_run) break;
+		cenc_run_jobs(wk);
+		gf_sema_notify(ctx->workers_done, 1);
+	}
+	return 0;
+}
+
+//encrypts queued samples and sends all queued packets in order
+static GF_Err cenc_flush_jobs(GF_CENCEncCtx *ctx)
+{
+	GF_Err e = GF_OK;
+	u32 i, nb_wake;
+	if (!ctx->nb_jobs) return GF_OK;
+
+	ctx->next_job = 0;
+	nb_wake = MIN(ctx->nb_jobs, ctx->nb_workers) - 1;
+	for (i=1; i<=nb_wake; i++) {
+		gf_sema_notify(ctx->workers[i].start, 1);
+	}
+	cenc_run_jobs(&ctx->workers[0]);
+	for (i=0; i<nb_wake; i++) {
+		gf_sema_wait(ctx->workers_done);
+	}
+
+	for (i=0; i<ctx->nb_jobs; i++) {
+		CENCJob *job = &ctx->jobs[i];
+		if (!e && job->e) {
+			e = job->e;
+			GF_LOG(GF_LOG_ERROR, GF_LOG_MEDIA, ("[CENC] Error encrypting packet: %s\n", gf_error_to_string(e) ));
+		}
+		//drop all packets after the first error
+		if (e) gf_filter_pck_discard(job->pck);
+		else gf_filter_pck_send(job->pck);
+		job->pck = NULL;
+	}
+	ctx->nb_jobs = 0;
+	return e;
+}
+
+static void cenc_del_workers(GF_CENCEncCtx *ctx)
+{
+	u32 i, j;
+	if (!ctx->workers) return;
+
+	ctx->workers_run = GF_FALSE;
+	for (i=1; i<ctx->nb_workers; i++) {
+		gf_sema_notify(ctx->workers[i].start, 1);
+	}
+	for (i=0; i<ctx->nb_workers; i++) {
+		CENCWorker *wk = &ctx->workers[i];
+		if (wk->th) {
+			gf_th_stop(wk->th);
+			gf_th_del(wk->th);
+		}
+		if (wk->start) gf_sema_del(wk->start);
+		for (j=0; j<2; j++) {
+			while (wk->nb_keys[j]) {
+				wk->nb_keys[j]--;
+				if (wk->keys[j][wk->nb_keys[j]].crypt) gf_crypt_close(wk->keys[j][wk->nb_keys[j]].crypt);
+			}
+			if (wk->keys[j]) gf_free(wk->keys[j]);
+		}
+		if (wk->pattern_buf) gf_free(wk->pattern_buf);
+	}
+	gf_free(ctx->workers);
+	ctx->workers = NULL;
+	ctx->nb_workers = 0;
+	if (ctx->workers_done) gf_sema_del(ctx->workers_done);
+	ctx->workers_done = NULL;
+}
+
+static GF_Err cenc_setup_workers(GF_CENCEncCtx *ctx)
+{
+	u32 i, nb_threads = 0;
+#ifndef GPAC_DISABLE_THREADS
+	if (!gf_opts_get_bool("core", "no-mx")) {
+		if (ctx->nbth < 0) {
+			GF_SystemRTInfo rti;
+			gf_sys_get_rti(0, &rti, 0);
+			if (rti.nb_cores>1) nb_threads = rti.nb_cores-1;
+		} else {
+			nb_threads = ctx->nbth;
+		}
+	}
+#endif
+	if (!nb_threads) return GF_OK;
+
+	ctx->workers = gf_malloc(sizeof(CENCWorker) * (nb_threads+1));
+	if (!ctx->workers) return GF_OUT_OF_MEM;
+	memset(ctx->workers, 0, sizeof(CENCWorker) * (nb_threads+1));
+	ctx->nb_workers = 1;
+	ctx->workers[0].ctx = ctx;
+	ctx->workers_run = GF_TRUE;
+	ctx->workers_done = gf_sema_new(nb_threads, 0);
+	if (!ctx->workers_done) nb_threads = 0;
+
+	for (i=1; i<=nb_threads; i++) {
+		char szName[100];
+		CENCWorker *wk = &ctx->workers[i];
+		sprintf(szName, "cecrypt_%d", i);
+		wk->ctx = ctx;
+		wk->th = gf_th_new(szName);
+		wk->start = gf_sema_new(1, 0);
+		if (!wk->th || !wk->start || gf_th_run(wk->th, cenc_worker_thread, wk)) {
+			if (wk->th) gf_th_del(wk->th);
+			if (wk->start) gf_sema_del(wk->start);
+			wk->th = NULL;
+			wk->start = NULL;
+			break;
+		}
+		ctx->nb_workers++;
+	}
+	//a few samples per thread to balance uneven sample sizes
+	ctx->max_jobs = 4 * ctx->nb_workers;
+	if (ctx->nb_workers>1) {
+		GF_LOG(GF_LOG_INFO, GF_LOG_MEDIA, ("[CENC] Encrypting samples using %d threads\n", ctx->nb_workers));
+	}
+	return GF_OK;
+}
+
 static GF_Err cenc_encrypt_packet(GF_CENCEncCtx *ctx, GF_CENCStream *cstr, GF_FilterPacket *pck)
 {
 	GF_BitStream *sai_bs;
@@ -1709,7 +2100,8 @@ static GF_Err cenc_encrypt_packet(GF_CENCEncCtx *ctx, GF_CENCStream *cstr, GF_Fi
 	u32 subsample_idx = 0;
 	u32 nb_subs_crypted = 0;
 	u32 nb_sub_offset;
-	Bool multi_key;
+	Bool multi_key, defer;
+	CENCJob *job;
 
 	if (cstr->multi_key) {
 		nb_keys = cstr->tci->nb_keys;
@@ -1743,6 +2135,22 @@ static GF_Err cenc_encrypt_packet(GF_CENCEncCtx *ctx, GF_CENCStream *cstr, GF_Fi
 	}
 	if (!dst_pck) return GF_OUT_OF_MEM;
 
+	//encryption is done once the whole sample is parsed, possibly on another thread
+	job = cenc_get_job(ctx);
+	if (!job) {
+		gf_filter_pck_discard(dst_pck);
+		return GF_OUT_OF_MEM;
+	}
+	job->pck = dst_pck;
+	job->output = output;
+	job->ctr_mode = cstr->ctr_mode;
+	if (cstr->crypt_byte_block && cstr->skip_byte_block) {
+		job->crypt_byte_block = cstr->crypt_byte_block;
+		job->skip_byte_block = cstr->skip_byte_block;
+	} else {
+		job->crypt_byte_block = job->skip_byte_block = 0;
+	}
+
 	gf_filter_pck_set_crypt_flags(dst_pck, GF_FILTER_PCK_CRYPT);
 
 	if (!ctx->bs_r) ctx->bs_r = gf_bs_new(data, pck_size, GF_BITSTREAM_READ);
@@ -1774,12 +2182,12 @@ static GF_Err cenc_encrypt_packet(GF_CENCEncCtx *ctx, GF_CENCStream *cstr, GF_Fi
 			u32 num_frames_in_superframe = 0, superframe_index_size = 0;
 			u64 obu_size = 0;
 			u32 hdr_size = 0;
+			u64 pos;
 #else
 			struct {
 				int clear, encrypted;
 			} ranges[1];
 #endif
-			u64 pos;
 			u32 clear_bytes_at_end = 0;
 			u32 clear_bytes = 0;
 			u32 nb_ranges = 1;
@@ -2031,50 +2439,27 @@ static GF_Err cenc_encrypt_packet(GF_CENCEncCtx *ctx, GF_CENCStream *cstr, GF_Fi
 				if (nalu_size > clear_bytes) {
 					/*get encrypted data start*/
 					u32 cur_pos = (u32) gf_bs_get_position(ctx->bs_r);
+					//clear_bytes_at_end is 0 unless NALU-based cbcs without pattern (not defined in CENC)
+					//in this case, we must only encrypt a multiple of 16-byte blocks
+					u32 to_crypt = nalu_size - clear_bytes - clear_bytes_at_end;
+					//cbcs scheme with constant IV, reinit at each sub sample,
+					Bool reset_IV = (!cstr->ctr_mode && !cstr->tci->keys[key_idx].IV_size) ? GF_TRUE : GF_FALSE;
 
 					/*skip bytes of encrypted data*/
 					gf_bs_skip_bytes(ctx->bs_r, nalu_size - clear_bytes);
 
-					//cbcs scheme with constant IV, reinit at each sub sample,
-					if (!cstr->ctr_mode && !cstr->tci->keys[key_idx].IV_size)
-						gf_crypt_set_IV(cstr->keys[key_idx].crypt, cstr->keys[key_idx].IV, 16);
-
 					//pattern encryption
-					if (cstr->crypt_byte_block && cstr->skip_byte_block) {
-						u32 res = nalu_size - clear_bytes - clear_bytes_at_end;
-						pos = cur_pos;
+					if (job->crypt_byte_block) {
 						//don't use modulo in case we use fatal_assert
-						gf_assert((res / 16) * 16 == res);
-
-						while (res) {
-							u32 to_crypt = (res >= (u32) (16*cstr->crypt_byte_block)) ? 16*cstr->crypt_byte_block : res;
-
-							if (ctx->bk_skip)
-								e = GF_OK;
-							else
-								e = gf_crypt_encrypt(cstr->keys[key_idx].crypt, output+pos, to_crypt);
-
-							cstr->num_block_crypted += to_crypt/16;
-
-							if (res >= (u32) (16 * (cstr->crypt_byte_block + cstr->skip_byte_block))) {
-								pos += 16 * (cstr->crypt_byte_block + cstr->skip_byte_block);
-								res -= 16 * (cstr->crypt_byte_block + cstr->skip_byte_block);
-							} else {
-								res = 0;
-							}
-						}
+						gf_assert((to_crypt / 16) * 16 == to_crypt);
+						cstr->num_block_crypted += cenc_pattern_crypt_size(to_crypt, job->crypt_byte_block, job->skip_byte_block) / 16;
 					}
 					//full subsample encryption
 					else {
-						//clear_bytes_at_end is 0 unless NALU-based cbcs without pattern (not defined in CENC)
-						//in this case, we must only encrypt a multiple of 16-byte blocks
-						u32 to_crypt = nalu_size - clear_bytes - clear_bytes_at_end;
-						if (ctx->bk_skip)
-							e = GF_OK;
-						else
-							e = gf_crypt_encrypt(cstr->keys[key_idx].crypt, output+cur_pos, to_crypt);
 						cstr->num_block_crypted += to_crypt/16;
 					}
+					if (!ctx->bk_skip)
+						e = cenc_job_add_range(job, cur_pos, to_crypt, key_idx, reset_IV);
 				}
 
 
@@ -2166,10 +2551,8 @@ static GF_Err cenc_encrypt_packet(GF_CENCEncCtx *ctx, GF_CENCStream *cstr, GF_Fi
 		//CTR full sample
 		else if (cstr->ctr_mode) {
 			gf_bs_skip_bytes(ctx->bs_r, pck_size);
-			if (ctx->bk_skip)
-				e = GF_OK;
-			else
-				e = gf_crypt_encrypt(cstr->keys[0].crypt, output, pck_size);
+			if (!ctx->bk_skip)
+				e = cenc_job_add_range(job, 0, pck_size, 0, GF_FALSE);
 			cstr->num_block_crypted += pck_size/16;
 		}
 		//CBC full sample with padding
@@ -2181,16 +2564,11 @@ static GF_Err cenc_encrypt_packet(GF_CENCEncCtx *ctx, GF_CENCStream *cstr, GF_Fi
 
 			clear_trailing = (pck_size-clear_header) % 16;
 
-			//cbcs scheme with constant IV, reinit at each sample,
-			if (!cstr->tci->keys[0].IV_size)
-				gf_crypt_set_IV(cstr->keys[0].crypt, cstr->keys[0].IV, 16);
-
 			if (pck_size >= 16) {
 				u32 to_crypt = pck_size - clear_header - clear_trailing;
-				if (ctx->bk_skip)
-					e = GF_OK;
-				else
-					e = gf_crypt_encrypt(cstr->keys[0].crypt, output+clear_header, to_crypt);
+				//cbcs scheme with constant IV, reinit at each sample,
+				if (!ctx->bk_skip)
+					e = cenc_job_add_range(job, clear_header, to_crypt, 0, cstr->tci->keys[0].IV_size ? GF_FALSE : GF_TRUE);
 				cstr->num_block_crypted += to_crypt/16;
 			}
 			gf_bs_skip_bytes(ctx->bs_r, pck_size);
@@ -2211,9 +2589,50 @@ static GF_Err cenc_encrypt_packet(GF_CENCEncCtx *ctx, GF_CENCStream *cstr, GF_Fi
 		gf_bs_write_u32(sai_bs, prev_entry_bytes_crypt);
 		sai_size += sai_size_sub;
 	}
-	if (cstr->ctr_mode) {
-		for (i=0; i<nb_keys; i++) {
-			cenc_resync_IV(cstr->keys[i].crypt, cstr->keys[i].IV, cstr->tci->keys[i].IV_size);
+
+	defer = cenc_can_defer(ctx, cstr);
+	if (defer) {
+		//keys and IVs of this sample for the worker
+		if (job->alloc_keys < nb_keys) {
+			CENC_MKey *keys = gf_realloc(job->keys, sizeof(CENC_MKey) * nb_keys);
+			if (!keys) {
+				gf_filter_pck_discard(dst_pck);
+				gf_bs_del(sai_bs);
+				return GF_OUT_OF_MEM;
+			}
+			job->keys = keys;
+			job->alloc_keys = nb_keys;
+		}
+		memcpy(job->keys, cstr->keys, sizeof(CENC_MKey) * nb_keys);
+		job->nb_keys = nb_keys;
+
+		//compute next sample IV from the number of bytes encrypted with each key
+		if (cstr->ctr_mode) {
+			for (i=0; i<nb_keys; i++) {
+				u32 j;
+				u64 nb_bytes = 0;
+				for (j=0; j<job->nb_ranges; j++) {
+					CENCCryptRange *range = &job->ranges[j];
+					if (range->key_idx != i) continue;
+					if (job->crypt_byte_block)
+						nb_bytes += cenc_pattern_crypt_size(range->size, job->crypt_byte_block, job->skip_byte_block);
+					else
+						nb_bytes += range->size;
+				}
+				cenc_advance_IV(&cstr->keys[i], cstr->tci->keys[i].IV_size, nb_bytes);
+			}
+		}
+	} else {
+		GF_Err e = cenc_crypt_job(job, cstr->keys, &ctx->pattern_buf, &ctx->pattern_buf_size);
+		if (e) {
+			gf_filter_pck_discard(dst_pck);
+			gf_bs_del(sai_bs);
+			return e;
+		}
+		if (cstr->ctr_mode) {
+			for (i=0; i<nb_keys; i++) {
+				cenc_resync_IV(cstr->keys[i].crypt, cstr->keys[i].IV, cstr->tci->keys[i].IV_size);
+			}
 		}
 	}
 
@@ -2430,8 +2849,11 @@ static GF_Err cenc_encrypt_packet(GF_CENCEncCtx *ctx, GF_CENCStream *cstr, GF_Fi
 		}
 	}
 
-	gf_filter_pck_send(dst_pck);
-	return GF_OK;
+	if (defer) {
+		ctx->nb_jobs++;
+		return GF_OK;
+	}
+	return cenc_send_packet(ctx, dst_pck);
 }
 
 static GF_Err cenc_process(GF_CENCEncCtx *ctx, GF_CENCStream *cstr, GF_FilterPacket *pck)
@@ -2525,8 +2947,7 @@ static GF_Err cenc_process(GF_CENCEncCtx *ctx, GF_CENCStream *cstr, GF_FilterPac
 			gf_filter_pck_set_property(dst_pck, GF_PROP_PCK_CENC_SAI, &PROP_DATA_NO_COPY(sai, sai_size) );
 
 		gf_filter_pck_set_crypt_flags(dst_pck, signal_sai ? GF_FILTER_PCK_CRYPT : 0);
-		gf_filter_pck_send(dst_pck);
-		return GF_OK;
+		return cenc_send_packet(ctx, dst_pck);
 	}
 
 	cstr->pssh_template_plus_one = 0;
@@ -2612,6 +3033,9 @@ static GF_Err cenc_process(GF_CENCEncCtx *ctx, GF_CENCStream *cstr, GF_FilterPac
 
 		if (key_changed) {
 			char *hls_info;
+			//PID properties apply to packets sent after the change
+			e = cenc_flush_jobs(ctx);
+			if (e) return e;
 			GF_CryptKeyInfo *ki = &cstr->tci->keys[cstr->kidx];
 			u8 key_info[40];
 			u32 key_info_size = 20;
@@ -2646,36 +3070,48 @@ static GF_Err cenc_process(GF_CENCEncCtx *ctx, GF_CENCStream *cstr, GF_FilterPac
 static GF_Err cenc_enc_process(GF_Filter *filter)
 {
 	GF_CENCEncCtx *ctx = (GF_CENCEncCtx *)gf_filter_get_udta(filter);
+	GF_Err e;
 	u32 i, nb_eos, count = gf_list_count(ctx->streams);
 
 	nb_eos = 0;
 	for (i=0; i<count; i++) {
-		GF_Err e = GF_OK;
 		GF_CENCStream *cstr = gf_list_get(ctx->streams, i);
-		GF_FilterPacket *pck = gf_filter_pid_get_packet(cstr->ipid);
-		if (!pck) {
-			if (gf_filter_pid_is_eos(cstr->ipid)) {
-				gf_filter_pid_set_eos(cstr->opid);
-				nb_eos++;
+		//when samples are encrypted in parallel, fetch packets until enough samples are queued
+		while (1) {
+			GF_Err e = GF_OK;
+			GF_FilterPacket *pck = gf_filter_pid_get_packet(cstr->ipid);
+			if (!pck) {
+				if (gf_filter_pid_is_eos(cstr->ipid)) {
+					e = cenc_flush_jobs(ctx);
+					if (e) return e;
+					gf_filter_pid_set_eos(cstr->opid);
+					nb_eos++;
+				}
+				break;
 			}
-			continue;
-		}
 
-		if (cstr->passthrough) {
-			gf_filter_pck_forward(pck, cstr->opid);
-		}
-		else if (cstr->isma_oma) {
-			e = isma_process(ctx, cstr, pck);
-		} else if (cstr->is_adobe) {
-	 		e = adobe_process(ctx, cstr, pck);
-		} else {
-			e = cenc_process(ctx, cstr, pck);
-		}
-		gf_filter_pid_drop_packet(cstr->ipid);
-		cstr->nb_pck++;
+			if (cstr->passthrough) {
+				gf_filter_pck_forward(pck, cstr->opid);
+			}
+			else if (cstr->isma_oma) {
+				e = isma_process(ctx, cstr, pck);
+			} else if (cstr->is_adobe) {
+				e = adobe_process(ctx, cstr, pck);
+			} else {
+				e = cenc_process(ctx, cstr, pck);
+			}
+			gf_filter_pid_drop_packet(cstr->ipid);
+			cstr->nb_pck++;
 
-		if (e) return e;
+			if (e) {
+				cenc_flush_jobs(ctx);
+				return e;
+			}
+			if (!ctx->nb_jobs || (ctx->nb_jobs >= ctx->max_jobs)) break;
+		}
 	}
+	e = cenc_flush_jobs(ctx);
+	if (e) return e;
 	if (nb_eos==count) return GF_EOS;
 
 	return GF_OK;
@@ -2695,11 +3131,14 @@ static GF_Err cenc_enc_initialize(GF_Filter *filter)
 	}
 
 	ctx->streams = gf_list_new();
+	if (ctx->nbth)
+		return cenc_setup_workers(ctx);
 	return GF_OK;
 }
 
 static void cenc_enc_finalize(GF_Filter *filter)
 {
+	u32 i;
 	u64 num_block_crypted = 0;
 	GF_CENCEncCtx *ctx = (GF_CENCEncCtx *)gf_filter_get_udta(filter);
 	if (ctx->cinfo) gf_crypt_info_del(ctx->cinfo);
@@ -2711,6 +3150,13 @@ static void cenc_enc_finalize(GF_Filter *filter)
 	gf_list_del(ctx->streams);
 	if (ctx->bs_w) gf_bs_del(ctx->bs_w);
 	if (ctx->bs_r) gf_bs_del(ctx->bs_r);
+	cenc_del_workers(ctx);
+	for (i=0; i<ctx->alloc_jobs; i++) {
+		if (ctx->jobs[i].ranges) gf_free(ctx->jobs[i].ranges);
+		if (ctx->jobs[i].keys) gf_free(ctx->jobs[i].keys);
+	}
+	if (ctx->jobs) gf_free(ctx->jobs);
+	if (ctx->pattern_buf) gf_free(ctx->pattern_buf);
 	if (ctx->bk_stats) {
 		fprintf(stdout, "16-byte Blocks encrypted "LLU"\n", num_block_crypted);
 	}
@@ -2734,6 +3180,7 @@ static const GF_FilterArgs GF_CENCEncArgs[] =
 	{ OFFS(allc), "throw error if no DRM config file is found for a PID", GF_PROP_BOOL, NULL, NULL, 0},
 	{ OFFS(bk_stats), "print number of encrypted blocks to stdout upon exit", GF_PROP_BOOL, NULL, NULL, 0},
 	{ OFFS(bk_skip), "skip encryption but performs all other tasks (test mode)", GF_PROP_BOOL, NULL, NULL, GF_FS_ARG_HINT_EXPERT},
+	{ OFFS(nbth), "number of threads used to encrypt samples in parallel, 0 disables parallel encryption and -1 uses all cores minus one", GF_PROP_SINT, "0", NULL, GF_FS_ARG_HINT_EXPERT},
 	{0}
 };
 
@@ -2746,6 +3193,10 @@ GF_FilterRegister CENCEncRegister = {
 	"When the DRM config file is set per PID, the first `CrypTrack` in the DRM config file with the same ID is used, otherwise the first `CrypTrack` is used (regardless of the `CrypTrack` ID).\n"
 	"When the DRM config file is set globally (not per PID), the first `CrypTrack` in the DRM config file with the same ID is used, otherwise the first `CrypTrack` with ID 0 or not set is used.\n"
 	"If no DRM config file is defined for a given PID, this PID will not be encrypted, or an error will be thrown if [-allc]() is specified.\n"
+	"\n"
+	"When [-nbth]() is not 0, samples of CENC and CENS streams, and of CBCS streams using a constant IV, are encrypted in parallel. "
+	"Samples are still parsed sequentially and packets are dispatched in order once the pending samples are encrypted. "
+	"CBC streams using per-sample IVs, SAES, ISMA and Adobe streams are always encrypted sequentially.\n"
 	)
 	.private_size = sizeof(GF_CENCEncCtx),
 	.max_extra_pids=-1,
@@ -27,6 +27,18 @@
 
 #ifndef GPAC_DISABLE_EVG
 #include <gpac/evg.h>
+#include <gpac/thread.h>
+
+#if defined(WIN32) && !defined(__GNUC__) && (defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP>=2)))
+# include <intrin.h>
+# define EVGS_SSE2
+#elif defined(__SSE2__)
+# include <emmintrin.h>
+# define EVGS_SSE2
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+# include <arm_neon.h>
+# define EVGS_NEON
+#endif
 
 enum
 {
@@ -35,6 +47,47 @@ enum
 	EVGS_KEEPAR_NOSRC,
 };
 
+enum
+{
+	EVGS_MODE_EVG=0,
+	EVGS_MODE_SEP,
+};
+
+//polyphase filter for one direction: for each output sample, index of first source sample and nb_taps weights in 14-bit fixed point
+typedef struct
+{
+	u32 size, nb_taps;
+	s32 *pos;
+	s16 *weights;
+} EVGSFilter;
+
+//pixel format layout as seen by the separable scaler
+typedef struct
+{
+	Bool is_yuv;
+	//8 or 10, 10-bit samples are stored as little-endian 16-bit words
+	u32 depth;
+	//log2 of chroma subsampling factors
+	u32 sub_x, sub_y;
+	u32 nb_planes;
+	//plane index, offset and step (in samples) of Y/R, U/G, V/B and A components - plane is -1 if component is absent
+	s32 plane[4];
+	u32 off[4], step[4];
+	//packed RGB with padding byte, off[3] gives its position
+	Bool has_x;
+} EVGSFormat;
+
+typedef struct
+{
+	EVGSFilter fh, fv;
+	u32 src_plane, src_off, src_step, src_depth;
+	//component (0: Y, 1: U, 2: V) computed from packed RGB source rows before scaling, -1 if none
+	s32 to_yuv;
+	u32 dst_plane, dst_off, dst_step, dst_depth, dst_w, dst_h;
+} EVGSComp;
+
+typedef struct _evgs_worker EVGSWorker;
+
 typedef struct
 {
 	//options
@@ -55,16 +108,722 @@ typedef struct
 
 	GF_Fraction ar;
 	Bool passthrough, fullrange;
+	u32 cmx;
 	u32 offset_w, offset_h;
 
 	GF_EVGSurface *surf;
 	GF_EVGStencil *tx;
 	GF_Path *path;
+
+	//separable scaler
+	u32 mode;
+	Bool use_sep, sep_fill_alpha, sep_to_rgb, sep_run;
+	EVGSFormat sep_if, sep_of;
+	EVGSComp sep_comps[4];
+	u32 sep_nb_comps, sep_i_uv_h, sep_o_stride_uv, sep_o_uv_h;
+	//YUV to RGB: Y offset, Y scale, Cr to R, Cb to G, Cr to G, Cb to B - RGB to YUV: R, G, B weights and offset for each component
+	s32 sep_y2r[6];
+	s32 sep_r2y[3][4];
+	EVGSWorker *sep_workers;
+	u32 sep_nb_workers;
+	GF_Semaphore *sep_done;
+	//planes of the frame being processed
+	const u8 *sep_src[3];
+	u8 *sep_dst[3];
+	u32 sep_src_stride[3], sep_dst_stride[3];
 } EVGScaleCtx;
 
+struct _evgs_worker
+{
+	EVGScaleCtx *ctx;
+	GF_Thread *th;
+	GF_Semaphore *start;
+	u32 slice;
+	//per component: ring buffer of horizontally scaled source rows with their source row index, and vertically scaled output line
+	s16 *rows[4];
+	s32 *row_idx[4];
+	u16 *lines[4];
+	const s16 **row_ptrs;
+	//packed RGB source row converted to Y, U or V
+	u8 *conv;
+};
+
 u32 gf_evg_stencil_get_pixel_fast(GF_EVGStencil *st, s32 x, s32 y);
 u64 gf_evg_stencil_get_pixel_wide_fast(GF_EVGStencil *st, s32 x, s32 y);
 
+static Bool evgs_sep_format(u32 pfmt, EVGSFormat *f)
+{
+	u32 i, pix_size=4;
+	s32 idx_r=0, idx_g=1, idx_b=2, idx_a=-1, idx_x=-1;
+
+	memset(f, 0, sizeof(EVGSFormat));
+	f->depth = 8;
+	f->plane[3] = -1;
+	switch (pfmt) {
+	case GF_PIXEL_YUV:
+	case GF_PIXEL_YVU:
+	case GF_PIXEL_YUV_10:
+	case GF_PIXEL_YUV422:
+	case GF_PIXEL_YUV422_10:
+	case GF_PIXEL_YUV444:
+	case GF_PIXEL_YUV444_10:
+		f->nb_planes = 3;
+		for (i=0; i<3; i++) {
+			f->plane[i] = i;
+			f->step[i] = 1;
+		}
+		if (pfmt==GF_PIXEL_YVU) {
+			f->plane[1] = 2;
+			f->plane[2] = 1;
+		}
+		break;
+	case GF_PIXEL_NV12:
+	case GF_PIXEL_NV21:
+	case GF_PIXEL_NV12_10:
+	case GF_PIXEL_NV21_10:
+		f->nb_planes = 2;
+		f->step[0] = 1;
+		f->plane[1] = f->plane[2] = 1;
+		f->step[1] = f->step[2] = 2;
+		if ((pfmt==GF_PIXEL_NV21) || (pfmt==GF_PIXEL_NV21_10))
+			f->off[1] = 1;
+		else
+			f->off[2] = 1;
+		break;
+	case GF_PIXEL_RGB: pix_size = 3; break;
+	case GF_PIXEL_BGR: pix_size = 3; idx_r=2; idx_b=0; break;
+	case GF_PIXEL_RGBA: idx_a=3; break;
+	case GF_PIXEL_BGRA: idx_r=2; idx_b=0; idx_a=3; break;
+	case GF_PIXEL_ARGB: idx_a=0; idx_r=1; idx_g=2; idx_b=3; break;
+	case GF_PIXEL_ABGR: idx_a=0; idx_r=3; idx_g=2; idx_b=1; break;
+	case GF_PIXEL_RGBX: idx_x=3; break;
+	case GF_PIXEL_BGRX: idx_r=2; idx_b=0; idx_x=3; break;
+	case GF_PIXEL_XRGB: idx_x=0; idx_r=1; idx_g=2; idx_b=3; break;
+	case GF_PIXEL_XBGR: idx_x=0; idx_r=3; idx_g=2; idx_b=1; break;
+	default:
+		return GF_FALSE;
+	}
+
+	switch (pfmt) {
+	case GF_PIXEL_YUV_10:
+	case GF_PIXEL_NV12_10:
+	case GF_PIXEL_NV21_10:
+		f->sub_y = 1;
+		//fallthrough
+	case GF_PIXEL_YUV422_10:
+		f->sub_x = 1;
+		//fallthrough
+	case GF_PIXEL_YUV444_10:
+#ifdef GPAC_BIG_ENDIAN
+		return GF_FALSE;
+#endif
+		f->depth = 10;
+		f->is_yuv = GF_TRUE;
+		return GF_TRUE;
+	case GF_PIXEL_YUV:
+	case GF_PIXEL_YVU:
+	case GF_PIXEL_NV12:
+	case GF_PIXEL_NV21:
+		f->sub_y = 1;
+		//fallthrough
+	case GF_PIXEL_YUV422:
+		f->sub_x = 1;
+		//fallthrough
+	case GF_PIXEL_YUV444:
+		f->is_yuv = GF_TRUE;
+		return GF_TRUE;
+	default:
+		break;
+	}
+	//packed RGB
+	f->nb_planes = 1;
+	f->off[0] = idx_r;
+	f->off[1] = idx_g;
+	f->off[2] = idx_b;
+	if (idx_a>=0) {
+		f->plane[3] = 0;
+		f->off[3] = idx_a;
+	} else if (idx_x>=0) {
+		f->has_x = GF_TRUE;
+		f->off[3] = idx_x;
+	}
+	for (i=0; i<4; i++)
+		f->step[i] = pix_size;
+	return GF_TRUE;
+}
+
+static Double evgs_kernel(Double x, Bool hq)
+{
+	if (x<0) x = -x;
+	if (!hq) return (x<1) ? 1-x : 0;
+	//Catmull-Rom
+	if (x<1) return 1.5*x*x*x - 2.5*x*x + 1;
+	if (x<2) return -0.5*x*x*x + 2.5*x*x - 4*x + 2;
+	return 0;
+}
+
+static GF_Err evgs_filter_setup(EVGSFilter *f, u32 src_size, u32 dst_size, Bool hq)
+{
+	u32 i, k, nb_taps, win_taps;
+	Double *wtmp;
+	Double scale = (Double) src_size / dst_size;
+	//when downscaling, stretch the kernel over the source samples to avoid aliasing
+	Double fscale = MAX(scale, 1.0);
+	Double support = (hq ? 2.0 : 1.0) * fscale;
+
+	nb_taps = (src_size==dst_size) ? 1 : (u32) ceil(2*support);
+	//edge samples are repeated, so we never need more taps than source samples
+	win_taps = MIN(nb_taps, src_size);
+
+	f->size = dst_size;
+	f->nb_taps = win_taps;
+	f->pos = gf_realloc(f->pos, sizeof(s32) * dst_size);
+	f->weights = gf_realloc(f->weights, sizeof(s16) * dst_size * win_taps);
+	wtmp = gf_malloc(sizeof(Double) * win_taps);
+	if (!f->pos || !f->weights || !wtmp) {
+		if (wtmp) gf_free(wtmp);
+		return GF_OUT_OF_MEM;
+	}
+
+	for (i=0; i<dst_size; i++) {
+		s16 *w = f->weights + i*win_taps;
+		Double sum = 0;
+		s32 isum = 0;
+		u32 max_k = 0;
+		Double center = (i + 0.5) * scale - 0.5;
+		s32 start = (s32) floor(center - support) + 1;
+		s32 first = start;
+
+		if (nb_taps==1) {
+			f->pos[i] = i;
+			w[0] = 1<<14;
+			continue;
+		}
+		if (first + (s32) win_taps > (s32) src_size) first = src_size - win_taps;
+		if (first<0) first = 0;
+
+		memset(wtmp, 0, sizeof(Double) * win_taps);
+		for (k=0; k<nb_taps; k++) {
+			s32 x = start + (s32) k;
+			Double v = evgs_kernel((x - center) / fscale, hq);
+			if (x<0) x = 0;
+			else if (x >= (s32) src_size) x = src_size-1;
+			wtmp[x - first] += v;
+			sum += v;
+		}
+		for (k=0; k<win_taps; k++) {
+			w[k] = (s16) floor(wtmp[k] * (1<<14) / sum + 0.5);
+			isum += w[k];
+			if (w[k] > w[max_k]) max_k = k;
+		}
+		//make sure weights sum to 1
+		w[max_k] += (1<<14) - isum;
+		f->pos[i] = first;
+	}
+	gf_free(wtmp);
+	return GF_OK;
+}
+
+static void evgs_filter_reset(EVGSFilter *f)
+{
+	if (f->pos) gf_free(f->pos);
+	if (f->weights) gf_free(f->weights);
+	memset(f, 0, sizeof(EVGSFilter));
+}
+
+//horizontal pass, output samples use 14 bits whatever the source depth
+//the tap count is a constant for the common cases so that the compiler can unroll the inner loop
+#define EVGS_HSCALE(_type, _nb_taps) \
+	for (i=0; i<f->size; i++) { \
+		const _type *s = ((const _type *) src) + f->pos[i]*step; \
+		s32 sum = round; \
+		for (k=0; k<_nb_taps; k++) \
+			sum += s[k*step] * w[k]; \
+		dst[i] = (s16) (sum >> depth); \
+		w += _nb_taps; \
+	}
+
+#define EVGS_HSCALE_TAPS(_type) \
+	switch (nb_taps) { \
+	case 2: EVGS_HSCALE(_type, 2) break; \
+	case 3: EVGS_HSCALE(_type, 3) break; \
+	case 4: EVGS_HSCALE(_type, 4) break; \
+	default: EVGS_HSCALE(_type, nb_taps) break; \
+	}
+
+static void evgs_hscale(const u8 *src, u32 depth, u32 step, s16 *dst, EVGSFilter *f)
+{
+	u32 i, k, nb_taps = f->nb_taps;
+	s32 round = 1 << (depth-1);
+	const s16 *w = f->weights;
+
+	if (depth>8) {
+		EVGS_HSCALE_TAPS(u16)
+	} else {
+		EVGS_HSCALE_TAPS(u8)
+	}
+}
+#undef EVGS_HSCALE_TAPS
+#undef EVGS_HSCALE
+
+//vertical pass on 14-bit rows, output clamped to the destination depth
+static void evgs_vscale(const s16 **rows, const s16 *w, u32 nb_taps, u16 *dst, u32 width, u32 depth)
+{
+	u32 x=0, k;
+	u32 shift = 28 - depth;
+	s32 round = 1 << (shift-1);
+	s32 max_val = (1<<depth) - 1;
+
+#if defined(EVGS_SSE2)
+	__m128i vround = _mm_set1_epi32(round);
+	__m128i vshift = _mm_cvtsi32_si128(shift);
+	__m128i vmax = _mm_set1_epi16(max_val);
+	__m128i zero = _mm_setzero_si128();
+	for (; x+8<=width; x+=8) {
+		__m128i lo = vround;
+		__m128i hi = vround;
+		for (k=0; k<nb_taps; k+=2) {
+			__m128i b = zero;
+			u32 w1 = 0;
+			__m128i a = _mm_loadu_si128((const __m128i *) (rows[k]+x));
+			if (k+1<nb_taps) {
+				b = _mm_loadu_si128((const __m128i *) (rows[k+1]+x));
+				w1 = (u16) w[k+1];
+			}
+			//interleave two rows and their weights so that madd computes r0*w0 + r1*w1 on 32 bits
+			__m128i wk = _mm_set1_epi32((s32) ((u16) w[k] | (w1<<16)) );
+			lo = _mm_add_epi32(lo, _mm_madd_epi16(_mm_unpacklo_epi16(a, b), wk));
+			hi = _mm_add_epi32(hi, _mm_madd_epi16(_mm_unpackhi_epi16(a, b), wk));
+		}
+		lo = _mm_sra_epi32(lo, vshift);
+		hi = _mm_sra_epi32(hi, vshift);
+		lo = _mm_packs_epi32(lo, hi);
+		lo = _mm_min_epi16(_mm_max_epi16(lo, zero), vmax);
+		_mm_storeu_si128((__m128i *) (dst+x), lo);
+	}
+#elif defined(EVGS_NEON)
+	int32x4_t vshift = vdupq_n_s32(- (s32) shift);
+	uint16x8_t vmax = vdupq_n_u16(max_val);
+	for (; x+8<=width; x+=8) {
+		int32x4_t lo = vdupq_n_s32(round);
+		int32x4_t hi = vdupq_n_s32(round);
+		for (k=0; k<nb_taps; k++) {
+			int16x8_t a = vld1q_s16(rows[k]+x);
+			lo = vmlal_n_s16(lo, vget_low_s16(a), w[k]);
+			hi = vmlal_n_s16(hi, vget_high_s16(a), w[k]);
+		}
+		lo = vshlq_s32(lo, vshift);
+		hi = vshlq_s32(hi, vshift);
+		vst1q_u16(dst+x, vminq_u16(vcombine_u16(vqmovun_s32(lo), vqmovun_s32(hi)), vmax));
+	}
+#endif
+	for (; x<width; x++) {
+		s32 sum = round;
+		for (k=0; k<nb_taps; k++)
+			sum += rows[k][x] * w[k];
+		sum >>= shift;
+		if (sum<0) sum = 0;
+		else if (sum>max_val) sum = max_val;
+		dst[x] = (u16) sum;
+	}
+}
+
+static void evgs_store_line(const u16 *line, u32 width, u8 *dst, u32 off, u32 step, u32 depth)
+{
+	u32 x;
+	if (depth>8) {
+		u16 *d = ((u16 *) dst) + off;
+		if (step==1) {
+			memcpy(d, line, sizeof(u16)*width);
+		} else {
+			for (x=0; x<width; x++) d[x*step] = line[x];
+		}
+		return;
+	}
+	dst += off;
+	if (step==1) {
+		for (x=0; x<width; x++) dst[x] = (u8) line[x];
+	} else {
+		for (x=0; x<width; x++) dst[x*step] = (u8) line[x];
+	}
+}
+
+//10-bit fixed point value to 8 bits
+#define EVGS_CLAMP_8(_v) ( ((_v)<0) ? 0 : ( ((_v)>>10) > 255 ? 255 : (u8) ((_v)>>10) ) )
+
+static void evgs_rgb_line_to_yuv(const u8 *src, u32 width, const EVGSFormat *f, const s32 *mx, u8 *dst)
+{
+	u32 x, step = f->step[0];
+	const u8 *pr = src + f->off[0];
+	const u8 *pg = src + f->off[1];
+	const u8 *pb = src + f->off[2];
+	for (x=0; x<width; x++) {
+		s32 v = mx[0] * pr[x*step] + mx[1] * pg[x*step] + mx[2] * pb[x*step] + mx[3];
+		dst[x] = EVGS_CLAMP_8(v);
+	}
+}
+
+static void evgs_yuv_line_to_rgb(const u16 *ly, const u16 *lu, const u16 *lv, u32 width, u8 *dst, const EVGSFormat *f, const s32 *mx)
+{
+	u32 x, step = f->step[0];
+	Bool has_a = ((f->plane[3]>=0) || f->has_x) ? GF_TRUE : GF_FALSE;
+	for (x=0; x<width; x++) {
+		s32 y = (ly[x] - mx[0]) * mx[1] + 512;
+		s32 cb = lu[x] - 128;
+		s32 cr = lv[x] - 128;
+		s32 r = y + mx[2] * cr;
+		s32 g = y - mx[3] * cb - mx[4] * cr;
+		s32 b = y + mx[5] * cb;
+		dst[f->off[0]] = EVGS_CLAMP_8(r);
+		dst[f->off[1]] = EVGS_CLAMP_8(g);
+		dst[f->off[2]] = EVGS_CLAMP_8(b);
+		if (has_a) dst[f->off[3]] = 0xFF;
+		dst += step;
+	}
+}
+
+static u16 *evgs_sep_line(EVGScaleCtx *ctx, EVGSWorker *wk, u32 idx, u32 y)
+{
+	EVGSComp *c = &ctx->sep_comps[idx];
+	u32 k, nb_taps = c->fv.nb_taps;
+	s32 start = c->fv.pos[y];
+
+	for (k=0; k<nb_taps; k++) {
+		s32 sy = start + (s32) k;
+		u32 slot = sy % nb_taps;
+		s16 *row = wk->rows[idx] + slot * c->dst_w;
+		//rows needed by consecutive output lines overlap, only scale new ones
+		if (wk->row_idx[idx][slot] != sy) {
+			const u8 *src = ctx->sep_src[c->src_plane] + sy * ctx->sep_src_stride[c->src_plane];
+			if (c->to_yuv>=0) {
+				evgs_rgb_line_to_yuv(src, ctx->i_w, &ctx->sep_if, ctx->sep_r2y[c->to_yuv], wk->conv);
+				evgs_hscale(wk->conv, 8, 1, row, &c->fh);
+			} else {
+				src += (c->src_depth>8) ? 2*c->src_off : c->src_off;
+				evgs_hscale(src, c->src_depth, c->src_step, row, &c->fh);
+			}
+			wk->row_idx[idx][slot] = sy;
+		}
+		wk->row_ptrs[k] = row;
+	}
+	evgs_vscale(wk->row_ptrs, c->fv.weights + y*nb_taps, nb_taps, wk->lines[idx], c->dst_w, c->dst_depth);
+	return wk->lines[idx];
+}
+
+static void evgs_sep_slice(EVGScaleCtx *ctx, EVGSWorker *wk)
+{
+	u32 i, x, y, y_end;
+	u32 nb_slices = ctx->sep_nb_workers;
+
+	for (i=0; i<ctx->sep_nb_comps; i++) {
+		memset(wk->row_idx[i], 0xFF, sizeof(s32) * ctx->sep_comps[i].fv.nb_taps);
+	}
+	if (ctx->sep_to_rgb) {
+		y_end = ctx->o_h * (wk->slice+1) / nb_slices;
+		for (y = ctx->o_h * wk->slice / nb_slices; y<y_end; y++) {
+			u16 *ly = evgs_sep_line(ctx, wk, 0, y);
+			u16 *lu = evgs_sep_line(ctx, wk, 1, y);
+			u16 *lv = evgs_sep_line(ctx, wk, 2, y);
+			evgs_yuv_line_to_rgb(ly, lu, lv, ctx->o_w, ctx->sep_dst[0] + y*ctx->sep_dst_stride[0], &ctx->sep_of, ctx->sep_y2r);
+		}
+		return;
+	}
+	for (i=0; i<ctx->sep_nb_comps; i++) {
+		EVGSComp *c = &ctx->sep_comps[i];
+		y_end = c->dst_h * (wk->slice+1) / nb_slices;
+		for (y = c->dst_h * wk->slice / nb_slices; y<y_end; y++) {
+			u16 *line = evgs_sep_line(ctx, wk, i, y);
+			evgs_store_line(line, c->dst_w, ctx->sep_dst[c->dst_plane] + y*ctx->sep_dst_stride[c->dst_plane], c->dst_off, c->dst_step, c->dst_depth);
+		}
+	}
+	if (!ctx->sep_fill_alpha) return;
+
+	y_end = ctx->o_h * (wk->slice+1) / nb_slices;
+	for (y = ctx->o_h * wk->slice / nb_slices; y<y_end; y++) {
+		u8 *dst = ctx->sep_dst[0] + y*ctx->sep_dst_stride[0] + ctx->sep_of.off[3];
+		for (x=0; x<ctx->o_w; x++)
+			dst[x*ctx->sep_of.step[0]] = 0xFF;
+	}
+}
+
+static u32 evgs_sep_thread(void *par)
+{
+	EVGSWorker *wk = par;
+	EVGScaleCtx *ctx = wk->ctx;
+	while (1) {
+		gf_sema_wait(wk->start);
+		if (!ctx->sep_run) break;
+		evgs_sep_slice(ctx, wk);
+		gf_sema_notify(ctx->sep_done, 1);
+	}
+	return 0;
+}
+
+static void evgs_sep_del_workers(EVGScaleCtx *ctx)
+{
+	u32 i, j;
+	if (!ctx->sep_workers) return;
+
+	ctx->sep_run = GF_FALSE;
+	for (i=1; i<ctx->sep_nb_workers; i++) {
+		gf_sema_notify(ctx->sep_workers[i].start, 1);
+	}
+	for (i=0; i<ctx->sep_nb_workers; i++) {
+		EVGSWorker *wk = &ctx->sep_workers[i];
+		if (wk->th) {
+			gf_th_stop(wk->th);
+			gf_th_del(wk->th);
+		}
+		if (wk->start) gf_sema_del(wk->start);
+		for (j=0; j<4; j++) {
+			if (wk->rows[j]) gf_free(wk->rows[j]);
+			if (wk->row_idx[j]) gf_free(wk->row_idx[j]);
+			if (wk->lines[j]) gf_free(wk->lines[j]);
+		}
+		if (wk->row_ptrs) gf_free((void *) wk->row_ptrs);
+		if (wk->conv) gf_free(wk->conv);
+	}
+	gf_free(ctx->sep_workers);
+	ctx->sep_workers = NULL;
+	ctx->sep_nb_workers = 0;
+	if (ctx->sep_done) gf_sema_del(ctx->sep_done);
+	ctx->sep_done = NULL;
+}
+
+static GF_Err evgs_sep_setup_workers(EVGScaleCtx *ctx)
+{
+	u32 i, j, max_taps=0;
+
+	if (!ctx->sep_workers) {
+		u32 nb_threads = 0;
+#ifndef GPAC_DISABLE_THREADS
+		if (!gf_opts_get_bool("core", "no-mx")) {
+			if ((s32) ctx->nbth < 0) {
+				GF_SystemRTInfo rti;
+				gf_sys_get_rti(0, &rti, 0);
+				if (rti.nb_cores>1) nb_threads = rti.nb_cores-1;
+			} else {
+				nb_threads = ctx->nbth;
+			}
+		}
+#endif
+		ctx->sep_workers = gf_malloc(sizeof(EVGSWorker) * (nb_threads+1));
+		if (!ctx->sep_workers) return GF_OUT_OF_MEM;
+		memset(ctx->sep_workers, 0, sizeof(EVGSWorker) * (nb_threads+1));
+		ctx->sep_nb_workers = 1;
+		ctx->sep_workers[0].ctx = ctx;
+		ctx->sep_run = GF_TRUE;
+		if (nb_threads) {
+			ctx->sep_done = gf_sema_new(nb_threads, 0);
+			if (!ctx->sep_done) nb_threads = 0;
+		}
+		for (i=1; i<=nb_threads; i++) {
+			char szName[100];
+			EVGSWorker *wk = &ctx->sep_workers[i];
+			sprintf(szName, "evgs_%d", i);
+			wk->ctx = ctx;
+			wk->slice = i;
+			wk->th = gf_th_new(szName);
+			wk->start = gf_sema_new(1, 0);
+			if (!wk->th || !wk->start || gf_th_run(wk->th, evgs_sep_thread, wk)) {
+				if (wk->th) gf_th_del(wk->th);
+				if (wk->start) gf_sema_del(wk->start);
+				wk->th = NULL;
+				wk->start = NULL;
+				break;
+			}
+			ctx->sep_nb_workers++;
+		}
+	}
+
+	for (i=0; i<ctx->sep_nb_comps; i++) {
+		if (max_taps < ctx->sep_comps[i].fv.nb_taps) max_taps = ctx->sep_comps[i].fv.nb_taps;
+	}
+	for (i=0; i<ctx->sep_nb_workers; i++) {
+		EVGSWorker *wk = &ctx->sep_workers[i];
+		for (j=0; j<ctx->sep_nb_comps; j++) {
+			EVGSComp *c = &ctx->sep_comps[j];
+			wk->rows[j] = gf_realloc(wk->rows[j], sizeof(s16) * c->dst_w * c->fv.nb_taps);
+			wk->row_idx[j] = gf_realloc(wk->row_idx[j], sizeof(s32) * c->fv.nb_taps);
+			wk->lines[j] = gf_realloc(wk->lines[j], sizeof(u16) * c->dst_w);
+			if (!wk->rows[j] || !wk->row_idx[j] || !wk->lines[j]) return GF_OUT_OF_MEM;
+		}
+		wk->row_ptrs = gf_realloc((void *) wk->row_ptrs, sizeof(s16 *) * max_taps);
+		wk->conv = gf_realloc(wk->conv, ctx->i_w);
+		if (!wk->row_ptrs || !wk->conv) return GF_OUT_OF_MEM;
+	}
+	return GF_OK;
+}
+
+//setup YUV<->RGB conversion for the matrix and range in use, returns GF_FALSE if the matrix is not supported
+static Bool evgs_sep_setup_matrix(EVGScaleCtx *ctx)
+{
+	u32 i;
+	Double kr, kb, kg, ys, cs;
+	switch (ctx->cmx) {
+	case GF_COLOR_MX_RGB:
+	case GF_COLOR_MX_UNSPECIFIED:
+	case GF_COLOR_MX_BT470BG:
+	case GF_COLOR_MX_SMPTE170M:
+		kr = 0.299; kb = 0.114;
+		break;
+	case GF_COLOR_MX_BT709:
+		kr = 0.2126; kb = 0.0722;
+		break;
+	case GF_COLOR_MX_SMPTE240M:
+		kr = 0.212; kb = 0.087;
+		break;
+	case GF_COLOR_MX_BT2020_NCL:
+		kr = 0.2627; kb = 0.0593;
+		break;
+	default:
+		return GF_FALSE;
+	}
+	kg = 1 - kr - kb;
+
+	if (ctx->sep_to_rgb) {
+		//expand limited range input
+		ys = ctx->fullrange ? 1.0 : 255.0/219;
+		cs = ctx->fullrange ? 1.0 : 255.0/224;
+		ctx->sep_y2r[0] = ctx->fullrange ? 0 : 16;
+		ctx->sep_y2r[1] = (s32) floor(1024 * ys + 0.5);
+		ctx->sep_y2r[2] = (s32) floor(1024 * cs * 2*(1-kr) + 0.5);
+		ctx->sep_y2r[3] = (s32) floor(1024 * cs * 2*kb*(1-kb)/kg + 0.5);
+		ctx->sep_y2r[4] = (s32) floor(1024 * cs * 2*kr*(1-kr)/kg + 0.5);
+		ctx->sep_y2r[5] = (s32) floor(1024 * cs * 2*(1-kb) + 0.5);
+	} else {
+		Double w[3][3];
+		//full range output only if requested
+		ys = ctx->ofr ? 1.0 : 219.0/255;
+		cs = ctx->ofr ? 1.0 : 224.0/255;
+		w[0][0] = ys*kr;
+		w[0][1] = ys*kg;
+		w[0][2] = ys*kb;
+		w[1][0] = -cs*kr / (2*(1-kb));
+		w[1][1] = -cs*kg / (2*(1-kb));
+		w[1][2] = cs/2;
+		w[2][0] = cs/2;
+		w[2][1] = -cs*kg / (2*(1-kr));
+		w[2][2] = -cs*kb / (2*(1-kr));
+		for (i=0; i<3; i++) {
+			ctx->sep_r2y[i][0] = (s32) floor(1024 * w[i][0] + 0.5);
+			ctx->sep_r2y[i][1] = (s32) floor(1024 * w[i][1] + 0.5);
+			ctx->sep_r2y[i][2] = (s32) floor(1024 * w[i][2] + 0.5);
+			ctx->sep_r2y[i][3] = ((i ? 128 : (ctx->ofr ? 0 : 16)) << 10) + 512;
+		}
+	}
+	return GF_TRUE;
+}
+
+//check if the separable scaler can be used for the current configuration and setup filters
+static Bool evgs_sep_setup(EVGScaleCtx *ctx)
+{
+	u32 i, size;
+	EVGSFormat *fi = &ctx->sep_if;
+	EVGSFormat *fo = &ctx->sep_of;
+
+	if (ctx->mode != EVGS_MODE_SEP) return GF_FALSE;
+	if (ctx->offset_w || ctx->offset_h) {
+		GF_LOG(GF_LOG_INFO, GF_LOG_MEDIA, ("[EVGS] Padding not supported by separable scaler, using EVG\n"));
+		return GF_FALSE;
+	}
+	if (!evgs_sep_format(ctx->i_pfmt, fi) || !evgs_sep_format(ctx->ofmt, fo)) {
+		GF_LOG(GF_LOG_INFO, GF_LOG_MEDIA, ("[EVGS] Conversion from %s to %s not supported by separable scaler, using EVG\n", gf_pixel_fmt_name(ctx->i_pfmt), gf_pixel_fmt_name(ctx->ofmt)));
+		return GF_FALSE;
+	}
+	gf_pixel_get_size_info(ctx->i_pfmt, ctx->i_w, ctx->i_h, &size, &ctx->i_stride, &ctx->i_stride_uv, NULL, &ctx->sep_i_uv_h);
+	ctx->sep_o_stride_uv = 0;
+	gf_pixel_get_size_info(ctx->ofmt, ctx->o_w, ctx->o_h, &size, &ctx->o_stride, &ctx->sep_o_stride_uv, NULL, &ctx->sep_o_uv_h);
+
+	ctx->sep_to_rgb = (fi->is_yuv && !fo->is_yuv) ? GF_TRUE : GF_FALSE;
+	if (fi->is_yuv != fo->is_yuv) {
+		if (!evgs_sep_setup_matrix(ctx)) {
+			GF_LOG(GF_LOG_WARNING, GF_LOG_MEDIA, ("[EVGS] Color matrix %s not supported by separable scaler, using EVG\n", gf_cicp_color_matrix_name(ctx->cmx)));
+			return GF_FALSE;
+		}
+	} else if (fi->is_yuv && ctx->ofr && !ctx->fullrange) {
+		GF_LOG(GF_LOG_WARNING, GF_LOG_MEDIA, ("[EVGS] Range expansion not supported by separable scaler, using EVG\n"));
+		return GF_FALSE;
+	}
+	ctx->sep_nb_comps = ((fi->plane[3]>=0) && (fo->plane[3]>=0)) ? 4 : 3;
+	ctx->sep_fill_alpha = (!fo->is_yuv && !ctx->sep_to_rgb && (ctx->sep_nb_comps==3) && ((fo->plane[3]>=0) || fo->has_x)) ? GF_TRUE : GF_FALSE;
+
+	for (i=0; i<ctx->sep_nb_comps; i++) {
+		EVGSComp *c = &ctx->sep_comps[i];
+		u32 sw = ctx->i_w, sh = ctx->i_h;
+		u32 dw = ctx->o_w, dh = ctx->o_h;
+		if (fi->is_yuv && (i==1 || i==2)) {
+			sw = (sw + (1<<fi->sub_x) - 1) >> fi->sub_x;
+			sh = (sh + (1<<fi->sub_y) - 1) >> fi->sub_y;
+		}
+		if (fo->is_yuv && (i==1 || i==2)) {
+			dw = (dw + (1<<fo->sub_x) - 1) >> fo->sub_x;
+			dh = (dh + (1<<fo->sub_y) - 1) >> fo->sub_y;
+		}
+		c->to_yuv = (!fi->is_yuv && fo->is_yuv) ? (s32) i : -1;
+		c->src_plane = (c->to_yuv>=0) ? 0 : fi->plane[i];
+		c->src_off = fi->off[i];
+		c->src_step = fi->step[i];
+		c->src_depth = (c->to_yuv>=0) ? 8 : fi->depth;
+		c->dst_w = dw;
+		c->dst_h = dh;
+		if (ctx->sep_to_rgb) {
+			c->dst_plane = c->dst_off = 0;
+			c->dst_step = 1;
+			c->dst_depth = 8;
+		} else {
+			c->dst_plane = fo->plane[i];
+			c->dst_off = fo->off[i];
+			c->dst_step = fo->step[i];
+			c->dst_depth = fo->depth;
+		}
+		if (evgs_filter_setup(&c->fh, sw, dw, ctx->hq) || evgs_filter_setup(&c->fv, sh, dh, ctx->hq))
+			return GF_FALSE;
+	}
+	if (evgs_sep_setup_workers(ctx))
+		return GF_FALSE;
+
+	GF_LOG(GF_LOG_INFO, GF_LOG_MEDIA, ("[EVGS] Using separable %s scaler with %d threads\n", ctx->hq ? "bicubic" : "bilinear", ctx->sep_nb_workers));
+	return GF_TRUE;
+}
+
+static void evgs_sep_get_planes(u8 *base, u32 stride, u32 stride_uv, u32 height, u32 uv_height, u32 nb_planes, u8 **planes, u32 *strides)
+{
+	planes[0] = base;
+	strides[0] = stride;
+	if (nb_planes<2) return;
+	planes[1] = base + stride*height;
+	strides[1] = stride_uv;
+	if (nb_planes<3) return;
+	planes[2] = planes[1] + stride_uv*uv_height;
+	strides[2] = stride_uv;
+}
+
+static GF_Err evgs_sep_process(EVGScaleCtx *ctx, const u8 *data, GF_FilterFrameInterface *frame_ifce, u8 *output)
+{
+	u32 i;
+	if (data) {
+		evgs_sep_get_planes((u8 *) data, ctx->i_stride, ctx->i_stride_uv, ctx->i_h, ctx->sep_i_uv_h, ctx->sep_if.nb_planes, (u8 **) ctx->sep_src, ctx->sep_src_stride);
+	} else if (frame_ifce && frame_ifce->get_plane) {
+		for (i=0; i<ctx->sep_if.nb_planes; i++) {
+			GF_Err e = frame_ifce->get_plane(frame_ifce, i, &ctx->sep_src[i], &ctx->sep_src_stride[i]);
+			if (e) return e;
+		}
+	} else {
+		return GF_NOT_SUPPORTED;
+	}
+	evgs_sep_get_planes(output, ctx->o_stride, ctx->sep_o_stride_uv, ctx->o_h, ctx->sep_o_uv_h, ctx->sep_of.nb_planes, ctx->sep_dst, ctx->sep_dst_stride);
+
+	for (i=1; i<ctx->sep_nb_workers; i++) {
+		gf_sema_notify(ctx->sep_workers[i].start, 1);
+	}
+	evgs_sep_slice(ctx, &ctx->sep_workers[0]);
+	for (i=1; i<ctx->sep_nb_workers; i++) {
+		gf_sema_wait(ctx->sep_done);
+	}
+	return GF_OK;
+}
+
 static GF_Err evgs_process(GF_Filter *filter)
 {
 	const char *data;
@@ -121,6 +880,14 @@ static GF_Err evgs_process(GF_Filter *filter)
 		}
 
 	GF_Err e;
+	if (ctx->use_sep) {
+		e = evgs_sep_process(ctx, data, frame_ifce, output);
+		CHK_EXIT("Failed to rescale frame");
+		gf_filter_pck_send(dst_pck);
+		gf_filter_pid_drop_packet(ctx->ipid);
+		return GF_OK;
+	}
+
 	e = gf_evg_surface_attach_to_buffer(ctx->surf, output, ctx->o_w, ctx->o_h, 0, ctx->o_stride, ctx->ofmt);
 	CHK_EXIT("Failed to create output surface");
 	//threading must be enabled once the surface is configured
@@ -238,6 +1005,8 @@ static GF_Err evgs_configure_pid(GF_Filter *filter, GF_FilterPid *pid, Bool is_r
 
 	p = gf_filter_pid_get_property(pid, GF_PROP_PID_COLR_RANGE);
 	if (p) fullrange = p->value.boolean;
+	p = gf_filter_pid_get_property(pid, GF_PROP_PID_COLR_MX);
+	ctx->cmx = p ? p->value.uint : GF_COLOR_MX_UNSPECIFIED;
 
 	//ctx->ofmt may be 0 if the filter is instantiated dynamically, we haven't yet been called for reconfigure
 	if (!w || !h || !ofmt) {
@@ -384,6 +1153,15 @@ static GF_Err evgs_configure_pid(GF_Filter *filter, GF_FilterPid *pid, Bool is_r
 		ctx->fullrange = fullrange;
 		GF_LOG(GF_LOG_INFO, GF_LOG_MEDIA, ("[EVGS] Setup rescaler from %dx%d fmt %s to %dx%d fmt %s\n", w, h, gf_pixel_fmt_name(ofmt), ctx->o_w, ctx->o_h, gf_pixel_fmt_name(ctx->ofmt)));
 	}
+	ctx->use_sep = ctx->passthrough ? GF_FALSE : evgs_sep_setup(ctx);
+	if (ctx->use_sep && ctx->sep_to_rgb) {
+		gf_filter_pid_set_property(ctx->opid, GF_PROP_PID_COLR_RANGE, NULL);
+		gf_filter_pid_set_property(ctx->opid, GF_PROP_PID_COLR_MX, NULL);
+	} else if (ctx->use_sep && !ctx->sep_if.is_yuv && ctx->sep_of.is_yuv) {
+		gf_filter_pid_set_property(ctx->opid, GF_PROP_PID_COLR_RANGE, ctx->ofr ? &PROP_BOOL(GF_TRUE) : NULL);
+		if (ctx->cmx == GF_COLOR_MX_RGB)
+			gf_filter_pid_set_property(ctx->opid, GF_PROP_PID_COLR_MX, &PROP_UINT(GF_COLOR_MX_SMPTE170M));
+	}
 
 	gf_filter_pid_set_property(ctx->opid, GF_PROP_PID_WIDTH, &PROP_UINT(ctx->o_w));
 	gf_filter_pid_set_property(ctx->opid, GF_PROP_PID_HEIGHT, &PROP_UINT(ctx->o_h));
@@ -433,10 +1211,17 @@ static GF_Err evgs_initialize(GF_Filter *filter)
 }
 static void evgs_finalize(GF_Filter *filter)
 {
+	u32 i;
 	EVGScaleCtx *ctx = gf_filter_get_udta(filter);
 	gf_evg_surface_delete(ctx->surf);
 	gf_evg_stencil_delete(ctx->tx);
 	gf_path_del(ctx->path);
+
+	evgs_sep_del_workers(ctx);
+	for (i=0; i<4; i++) {
+		evgs_filter_reset(&ctx->sep_comps[i].fh);
+		evgs_filter_reset(&ctx->sep_comps[i].fv);
+	}
 	return;
 }
 
@@ -473,7 +1258,11 @@ static GF_FilterArgs EVGSArgs[] =
 	{ OFFS(padclr), "clear color when aspect ration preservation is used", GF_PROP_STRING, "black", NULL, GF_FS_ARG_HINT_EXPERT},
 	{ OFFS(osar), "force output pixel aspect ratio", GF_PROP_FRACTION, "0/1", NULL, GF_FS_ARG_HINT_EXPERT},
 	{ OFFS(nbth), "number of threads to use, -1 means all cores", GF_PROP_SINT, "-1", NULL, GF_FS_ARG_HINT_EXPERT},
-	{ OFFS(hq), "use bilinear interpolation instead of closest pixel", GF_PROP_BOOL, "false", NULL, GF_FS_ARG_HINT_EXPERT},
+	{ OFFS(hq), "use bilinear interpolation instead of closest pixel (bicubic instead of bilinear in separable mode)", GF_PROP_BOOL, "false", NULL, GF_FS_ARG_HINT_EXPERT},
+	{ OFFS(mode), "rescaling mode\n"
+	"- evg: draw input frame as a texture on an EVG surface\n"
+	"- sep: use separable scaler and direct pixel format conversion when possible"
+	, GF_PROP_UINT, "evg", "evg|sep", GF_FS_ARG_HINT_EXPERT},
 
 	{0}
 };
@@ -511,6 +1300,10 @@ GF_FilterRegister EVGSRegister = {
 	"When sample aspect ratio is kept, the filter will:\n"
 	"- center the rescaled input frame on the output frame\n"
 	"- fill extra pixels with [-padclr]()\n"
+	"## Separable scaler\n"
+	"When [-mode=sep]() is set, the filter uses a separable polyphase scaler (bilinear, or bicubic if [-hq]() is set) and converts pixel formats without drawing, using [-nbth]() threads working on horizontal slices of the output.\n"
+	"This mode is only used between 8 or 10 bit planar and semi-planar YUV and 8 bit RGB formats, without padding; other configurations are handled by EVG.\n"
+	"YUV to RGB conversion uses the input color matrix and range, RGB to YUV conversion outputs limited range unless [-ofr]() is set. BT.601, BT.709, SMPTE 240M and BT.2020 non-constant luminance matrices are supported.\n"
 	)
 	.private_size = sizeof(EVGScaleCtx),
 	.args = EVGSArgs,
@@ -73,6 +73,7 @@ typedef struct
 	Bool sigfrag;
 	Bool nocrypt, strtxt, lightp;
 	u32 nodata;
+	Bool mmap, lazy;
 	u32 mstore_purge, mstore_samples, mstore_size;
 	s32 ctso;
 
@@ -137,6 +138,11 @@ typedef struct
 	GF_ISOFile *extkmov;
 	u32 extk_flags;
 	Bool extk;
+
+	//file mapping is used, samples are sent as shared packets when possible
+	Bool mmap_active;
+	//mapped movie, shared with packets pointing to the file mapping
+	struct __isom_mapping *mapping;
 } ISOMReader;
 
 typedef struct
@@ -60,6 +60,63 @@ static GFINLINE Bool isor_is_local(const char *url)
 }
 
 
+//movie using a file mapping, referenced by the reader and by each packet pointing to the mapping
+//the movie is closed when the last reference is released, which may happen after the filter is finalized
+typedef struct __isom_mapping
+{
+	GF_ISOFile *mov;
+	volatile u32 ref_count;
+} ISOMMapping;
+
+static void isoffin_mapping_unref(ISOMMapping *mapping)
+{
+	gf_assert(mapping->ref_count);
+	if (safe_int_dec(&mapping->ref_count)) return;
+	gf_isom_close(mapping->mov);
+	gf_free(mapping);
+}
+
+static void isoffin_check_mmap(ISOMReader *read)
+{
+	read->mmap_active = GF_FALSE;
+	if (!read->mmap || !read->mov || read->extern_mov || read->mem_load_mode) return;
+	//only for complete local non-fragmented files, segments are loaded on the fly with regular IO
+	if (!read->input_loaded || read->missing_bytes || read->start_range || read->end_range || read->frag_type) return;
+
+	if (gf_isom_enable_file_mapping(read->mov) == GF_OK) {
+		GF_SAFEALLOC(read->mapping, ISOMMapping);
+		if (!read->mapping) return;
+		read->mapping->mov = read->mov;
+		read->mapping->ref_count = 1;
+		read->mmap_active = GF_TRUE;
+	} else {
+		GF_LOG(GF_LOG_INFO, GF_LOG_CONTAINER, ("[IsoMedia] Cannot use file mapping for source, using regular file IO\n"));
+	}
+}
+
+static void isoffin_close_mov(ISOMReader *read)
+{
+	if (!read->mov) return;
+	//packets pointing to the file mapping may still be in use, movie is closed once they are all released
+	if (read->mapping) {
+		gf_assert(read->mapping->mov == read->mov);
+		isoffin_mapping_unref(read->mapping);
+		read->mapping = NULL;
+	} else {
+		gf_isom_close(read->mov);
+	}
+	read->mov = NULL;
+	read->mmap_active = GF_FALSE;
+}
+
+//called on any thread, possibly after the filter is finalized: only use the mapping attached to the packet
+static void isoffin_mapped_pck_del(GF_Filter *filter, GF_FilterPid *pid, GF_FilterPacket *pck)
+{
+	ISOMMapping *mapping = gf_filter_pck_get_destructor_ctx(pck);
+	if (mapping)
+		isoffin_mapping_unref(mapping);
+}
+
 static GF_Err isoffin_setup(GF_Filter *filter, ISOMReader *read, Bool input_is_eos)
 {
 	char *url;
@@ -141,7 +198,10 @@ static GF_Err isoffin_setup(GF_Filter *filter, ISOMReader *read, Bool input_is_e
 	}
 
 	read->missing_bytes = 0;
-	e = gf_isom_open_progressive(url, read->start_range, read->end_range, read->sigfrag, &read->mov, &read->missing_bytes);
+	if (read->lazy)
+		e = gf_isom_open_progressive_lazy(url, read->start_range, read->end_range, read->sigfrag, &read->mov, &read->missing_bytes);
+	else
+		e = gf_isom_open_progressive(url, read->start_range, read->end_range, read->sigfrag, &read->mov, &read->missing_bytes);
 
 	if (e == GF_ISOM_INCOMPLETE_FILE) {
 		if (input_is_eos) {
@@ -177,6 +237,8 @@ static GF_Err isoffin_setup(GF_Filter *filter, ISOMReader *read, Bool input_is_e
 	if (read->strtxt)
 		gf_isom_text_set_streaming_mode(read->mov, GF_TRUE);
 
+	isoffin_check_mmap(read);
+
 	gf_free(url);
 	e = isor_declare_objects(read);
 	if (e && (e!= GF_ISOM_INCOMPLETE_FILE)) {
@@ -206,8 +268,7 @@ static void isoffin_disconnect(ISOMReader *read)
 		isoffin_delete_channel(ch);
 	}
 
-	if (read->mov) gf_isom_close(read->mov);
-	read->mov = NULL;
+	isoffin_close_mov(read);
 
 	read->pid = NULL;
 }
@@ -327,7 +388,7 @@ static GF_Err isoffin_reconfigure(GF_Filter *filter, ISOMReader *read, const cha
 			}
 		}
 #endif
-		if (read->mov) gf_isom_close(read->mov);
+		isoffin_close_mov(read);
 		e = gf_isom_open_progressive(next_url, read->start_range, read->end_range, read->sigfrag, &read->mov, &read->missing_bytes);
 
 		//init seg not completely downloaded, retry at next packet
@@ -563,7 +624,7 @@ static void isoffin_finalize(GF_Filter *filter)
 	}
 	gf_list_del(read->channels);
 
-	if (!read->extern_mov && read->mov) gf_isom_close(read->mov);
+	if (!read->extern_mov) isoffin_close_mov(read);
 	read->mov = NULL;
 
 	if (read->mem_blob.data) gf_free(read->mem_blob.data);
@@ -1621,6 +1682,10 @@ static GF_Err isoffin_process(GF_Filter *filter)
 						pck = gf_filter_pck_new_alloc(ch->pid, ch->sample->dataLength, &data);
 
 					if (!pck) return GF_OUT_OF_MEM;
+				} else if (ch->sample->mapped) {
+					pck = gf_filter_pck_new_shared_ctx(ch->pid, ch->sample->data, ch->sample->dataLength, isoffin_mapped_pck_del, read->mapping);
+					if (!pck) return GF_OUT_OF_MEM;
+					safe_int_inc(&read->mapping->ref_count);
 				} else {
 					pck = gf_filter_pck_new_alloc(ch->pid, ch->sample->dataLength, &data);
 					if (!pck) return GF_OUT_OF_MEM;
@@ -1884,6 +1949,8 @@ static const GF_FilterArgs ISOFFInArgs[] =
 	"- yes: skip data loading\n"
 	"- fake: allocate sample but no data copy", GF_PROP_UINT, "no", "no|yes|fake", GF_FS_ARG_HINT_EXPERT},
 	{ OFFS(lightp), "load minimal set of properties", GF_PROP_BOOL, "false", NULL, GF_FS_ARG_HINT_EXPERT},
+	{ OFFS(mmap), "use memory mapping for complete local files and dispatch sample data without copy whenever possible", GF_PROP_BOOL, "false", NULL, GF_FS_ARG_HINT_EXPERT},
+	{ OFFS(lazy), "load large sample tables of local files on demand rather than when opening the file", GF_PROP_BOOL, "false", NULL, GF_FS_ARG_HINT_EXPERT},
 	{ OFFS(initseg), "local init segment name when input is a single ISOBMFF segment", GF_PROP_STRING, NULL, NULL, GF_FS_ARG_HINT_EXPERT},
 	{ OFFS(extk), "allow external track loading", GF_PROP_BOOL, "true", NULL, GF_FS_ARG_HINT_EXPERT},
 	{ OFFS(extkmov), "original mov pointer for external tracks", GF_PROP_POINTER, NULL, NULL, GF_FS_ARG_HINT_HIDE},
@@ -336,12 +336,16 @@ void isor_reader_get_sample(ISOMChannel *ch)
 		ch->track = ch->next_track;
 		if (!ch->owner->nodata)
 			gf_isom_set_sample_alloc(ch->owner->mov, ch->track, isor_sample_alloc, ch);
+		if (ch->owner->mmap_active)
+			gf_isom_set_zero_copy(ch->owner->mov, ch->track, GF_TRUE);
 		ch->next_track = 0;
 	}
 
 	if (ch->to_init) {
 		if (!ch->owner->nodata)
 			gf_isom_set_sample_alloc(ch->owner->mov, ch->track, isor_sample_alloc, ch);
+		if (ch->owner->mmap_active)
+			gf_isom_set_zero_copy(ch->owner->mov, ch->track, GF_TRUE);
 		init_reader(ch);
 		sample_desc_index = ch->last_sample_desc_index;
 	} else if (ch->speed < 0) {
@@ -1085,6 +1089,14 @@ void isor_reader_check_config(ISOMChannel *ch)
 
 		if (replace_nal) {
 			u32 move_size = ch->sample->dataLength - size - pos - nalu_len;
+			//payload is in the read-only file mapping, copy it to a new packet before modifying it
+			if (ch->sample->mapped) {
+				u8 *data = isor_sample_alloc(ch->sample->dataLength, ch);
+				if (!data) break;
+				memcpy(data, ch->sample->data, ch->sample->dataLength);
+				ch->sample->data = data;
+				ch->sample->mapped = 0;
+			}
 			isor_replace_nal(ch, ch->sample->data + pos + nalu_len, size, nal_type, &needs_reset);
 			if (move_size)
 				memmove(ch->sample->data + pos, ch->sample->data + pos + size + nalu_len, ch->sample->dataLength - size - pos - nalu_len);
@@ -321,6 +321,7 @@ typedef struct
 	u32 itags;
 	Double start;
 	u32 chapm;
+	Bool fpipe;
 
 
 	//internal
@@ -412,6 +413,13 @@ typedef struct
 	u32 last_block_in_segment;
 	u64 flush_idx_start_range, flush_idx_end_range;
 	Bool flush_llhas;
+	//events of the fragment being written in pipelined mode, sent once the last packet is consumed
+	GF_List *pending_evts;
+
+	//fragment build stats, in microseconds
+	u64 frag_build_start, frag_wait_start;
+	u64 frag_build_time, frag_build_max, frag_flush_time, frag_wait_time;
+	u32 nb_frags_built;
 
 	Bool has_def_vid, has_def_aud, has_def_txt;
 
@@ -5710,6 +5718,22 @@ static void mp4mux_send_output(GF_MP4MuxCtx *ctx)
 	}
 }
 
+static void mp4_mux_send_seg_event(GF_MP4MuxCtx *ctx, GF_FilterPid *pid, GF_FilterEvent *evt)
+{
+	//last packet of the fragment not yet consumed (pipelined mode), queue event
+	if (ctx->fpipe && ctx->seg_flush_state) {
+		GF_FilterEvent *an_evt;
+		if (!ctx->pending_evts) ctx->pending_evts = gf_list_new();
+		an_evt = gf_malloc(sizeof(GF_FilterEvent));
+		if (an_evt) {
+			*an_evt = *evt;
+			gf_list_add(ctx->pending_evts, an_evt);
+			return;
+		}
+	}
+	gf_filter_pid_send_event(pid, evt);
+}
+
 static void mp4_mux_flush_frag_llhas(GF_MP4MuxCtx *ctx)
 {
 	GF_FilterEvent evt;
@@ -5725,7 +5749,7 @@ static void mp4_mux_flush_frag_llhas(GF_MP4MuxCtx *ctx)
 	evt.frag_size.duration.den = ctx->frag_timescale;
 	evt.frag_size.independent = ctx->frag_has_intra;
 
-	gf_filter_pid_send_event(tkw->ipid, &evt);
+	mp4_mux_send_seg_event(ctx, tkw->ipid, &evt);
 
 	ctx->frag_offset += ctx->frag_size;
 	ctx->frag_size = 0;
@@ -5794,7 +5818,7 @@ static void mp4_mux_flush_seg(GF_MP4MuxCtx *ctx, Bool is_init, u64 idx_start_ran
 
 		evt.seg_size.idx_range_start = idx_start_range;
 		evt.seg_size.idx_range_end = idx_end_range;
-		gf_filter_pid_send_event(tkw->ipid, &evt);
+		mp4_mux_send_seg_event(ctx, tkw->ipid, &evt);
 
 		ctx->current_offset += ctx->current_size;
 		ctx->current_size = 0;
@@ -6255,6 +6279,7 @@ static GF_Err mp4_mux_start_fragment(GF_MP4MuxCtx *ctx, GF_FilterPacket *pck)
 	gf_isom_set_next_moof_number(ctx->file, ctx->msn);
 	ctx->msn += ctx->msninc;
 	ctx->min_cts_plus_one = 0;
+	ctx->frag_build_start = gf_sys_clock_high_res();
 
 	if (ctx->moof_first) flags |= GF_ISOM_FRAG_MOOF_FIRST;
 #ifdef GF_ENABLE_CTRN
@@ -6505,6 +6530,32 @@ static void mp4_process_id3(GF_MovieFragmentBox *moof, const GF_PropertyValue *e
 }
 #endif
 
+static void mp4_mux_frag_stats(GF_MP4MuxCtx *ctx, u64 flush_start)
+{
+	u64 now = gf_sys_clock_high_res();
+	u64 build_time = ctx->frag_build_start ? (now - ctx->frag_build_start) : 0;
+	ctx->frag_flush_time += now - flush_start;
+	ctx->frag_build_time += build_time;
+	if (build_time > ctx->frag_build_max) ctx->frag_build_max = build_time;
+	ctx->nb_frags_built++;
+	ctx->frag_build_start = 0;
+	GF_LOG(GF_LOG_DEBUG, GF_LOG_CONTAINER, ("[MP4Mux] Fragment %u built in "LLU" us (flush "LLU" us)\n", ctx->nb_frags_built, build_time, now - flush_start));
+}
+
+static void mp4_mux_flush_seg_events(GF_MP4MuxCtx *ctx);
+
+//in pipelined mode, check if the previous fragment is still being written: returns GF_TRUE if we must wait
+static Bool mp4_mux_wait_seg_flush(GF_MP4MuxCtx *ctx)
+{
+	if (!ctx->fpipe || !ctx->seg_flush_state) return GF_FALSE;
+	if (ctx->seg_flush_state==1) {
+		if (!ctx->frag_wait_start) ctx->frag_wait_start = gf_sys_clock_high_res();
+		return GF_TRUE;
+	}
+	mp4_mux_flush_seg_events(ctx);
+	return GF_FALSE;
+}
+
 static GF_Err mp4_mux_process_fragmented(GF_MP4MuxCtx *ctx)
 {
 #ifndef GPAC_DISABLE_ISOM_FRAGMENTS
@@ -6906,6 +6957,11 @@ static GF_Err mp4_mux_process_fragmented(GF_MP4MuxCtx *ctx)
 
 
 	if (nb_done==count) {
+		u64 flush_start;
+		//previous fragment still being written, we will be called again once done
+		if (mp4_mux_wait_seg_flush(ctx))
+			return GF_OK;
+
 		//nothing open (this happens when flushing segments/fragments)
 		if (!ctx->segment_started && !ctx->fragment_started)
 			goto check_eos;
@@ -6931,6 +6987,7 @@ static GF_Err mp4_mux_process_fragmented(GF_MP4MuxCtx *ctx)
 		}
 		ctx->adjusted_next_frag_start = ctx->next_frag_start;
 
+		flush_start = gf_sys_clock_high_res();
 		mp4mx_frag_box_patch(ctx);
 
 		//end of DASH segment
@@ -6960,12 +7017,13 @@ static GF_Err mp4_mux_process_fragmented(GF_MP4MuxCtx *ctx)
 			ctx->last_block_in_segment = 0;
 			if (e) return e;
 			flush_refs = GF_TRUE;
+			mp4_mux_frag_stats(ctx, flush_start);
 
 			GF_LOG(GF_LOG_DEBUG, GF_LOG_CONTAINER, ("[MP4Mux] Done writing segment %d - estimated next fragment times start %g end %g\n", ctx->dash_seg_num_plus_one - 1, ((Double)next_ref_ts)/ref_timescale, ((Double)ctx->next_frag_start)/ctx->cdur.den ));
 
 			if (ctx->dash_mode != MP4MX_DASH_VOD) {
-				//we need to wait for packet to be written
-				if (ctx->seg_flush_state) {
+				//we need to wait for packet to be written, unless pipelined in which case events are queued
+				if (ctx->seg_flush_state && !ctx->fpipe) {
 					ctx->flush_idx_start_range = offset + idx_start_range;
 					ctx->flush_idx_end_range = idx_end_range ? offset + idx_end_range : 0;
 					return GF_OK;
@@ -6991,6 +7049,7 @@ static GF_Err mp4_mux_process_fragmented(GF_MP4MuxCtx *ctx)
 		else if (!ctx->dash_mode || ((ctx->subs_sidx<0) && (ctx->dash_mode<MP4MX_DASH_VOD) && !ctx->cloned_sidx) ) {
 			gf_isom_flush_fragments(ctx->file, GF_FALSE);
 			flush_refs = GF_TRUE;
+			mp4_mux_frag_stats(ctx, flush_start);
 			//if not in dash and EOS marker is set, inject marker after each fragment
 			if (!ctx->dash_mode && ctx->eos_marker && ctx->fragment_started) {
 				u8 data[8];
@@ -7004,8 +7063,8 @@ static GF_Err mp4_mux_process_fragmented(GF_MP4MuxCtx *ctx)
 			}
 			GF_LOG(GF_LOG_DEBUG, GF_LOG_CONTAINER, ("[MP4Mux] Done writing fragment - next fragment start time %g\n", ((Double)ctx->next_frag_start)/ctx->cdur.den ));
 
-			//we need to wait for packet to be written
-			if (ctx->seg_flush_state) {
+			//we need to wait for packet to be written, unless pipelined in which case events are queued
+			if (ctx->seg_flush_state && !ctx->fpipe) {
 				if (ctx->llhas_mode) ctx->flush_llhas = GF_TRUE;
 				return GF_OK;
 			}
@@ -7043,6 +7102,8 @@ static GF_Err mp4_mux_process_fragmented(GF_MP4MuxCtx *ctx)
 
 check_eos:
 	if (count == nb_eos) {
+		if (mp4_mux_wait_seg_flush(ctx))
+			return GF_OK;
 		if (ctx->dash_mode==MP4MX_DASH_VOD) {
 			if (ctx->vodcache!=MP4MX_VODCACHE_ON) {
 				ctx->final_sidx_flush = GF_TRUE;
@@ -7387,6 +7448,10 @@ void mp4_mux_format_report(GF_MP4MuxCtx *ctx, u64 done, u64 total)
 			if (ctx->total_bytes_in) ohead =  ((Double) (ctx->total_bytes_out - ctx->total_bytes_in)*100 / ctx->total_bytes_in);
 
 			sprintf(szTmp, "done %d samples - bytes "LLU" in "LLU" out - overhead %02.02f%% (%02.02g B/sample)", ctx->total_samples, ctx->total_bytes_in, ctx->total_bytes_out, ohead, ((Double)(ctx->total_bytes_out-ctx->total_bytes_in))/ctx->total_samples);
+			if (ctx->nb_frags_built) {
+				gf_dynstrcat(&status, szTmp, NULL);
+				sprintf(szTmp, " - %u frags build avg "LLU" max "LLU" flush avg "LLU" us wait "LLU" ms", ctx->nb_frags_built, ctx->frag_build_time/ctx->nb_frags_built, ctx->frag_build_max, ctx->frag_flush_time/ctx->nb_frags_built, ctx->frag_wait_time/1000);
+			}
 			status_changed = GF_TRUE;
 			total_pc = 10000;
 
@@ -7410,6 +7475,10 @@ void mp4_mux_format_report(GF_MP4MuxCtx *ctx, u64 done, u64 total)
 			} else {
 				sprintf(szTmp, "mux frags %d next %02.3f", ctx->nb_frags, next);
 			}
+			if (ctx->nb_frags_built) {
+				gf_dynstrcat(&status, szTmp, NULL);
+				sprintf(szTmp, " build avg "LLU" max "LLU" us", ctx->frag_build_time/ctx->nb_frags_built, ctx->frag_build_max);
+			}
 		} else {
 			sprintf(szTmp, "%s", ((ctx->store==MP4MX_MODE_FLAT) || (ctx->store==MP4MX_MODE_FASTSTART)) ? "mux" : "import");
 		}
@@ -7493,7 +7562,8 @@ GF_Err mp4_mux_process(GF_Filter *filter)
 		if (gf_filter_connections_pending(filter))
 			return GF_OK;
 
-		if (ctx->seg_flush_state==1) return GF_OK;
+		//in pipelined mode, the next fragment is built while the previous one is being written
+		if ((ctx->seg_flush_state==1) && !ctx->fpipe) return GF_OK;
 		else if (ctx->seg_flush_state==2)
 			mp4_mux_flush_seg_events(ctx);
 
@@ -7653,6 +7723,21 @@ static GF_Err mp4_mux_on_data_patch(void *cbk, u8 *data, u32 block_size, u64 fil
 
 static void mp4_mux_flush_seg_events(GF_MP4MuxCtx *ctx)
 {
+	if (ctx->frag_wait_start) {
+		ctx->frag_wait_time += gf_sys_clock_high_res() - ctx->frag_wait_start;
+		ctx->frag_wait_start = 0;
+	}
+	//pipelined mode, fragment state has already been reset, only send queued events
+	if (ctx->fpipe) {
+		TrackWriter *tkw = gf_list_get(ctx->tracks, 0);
+		ctx->seg_flush_state = 0;
+		while (gf_list_count(ctx->pending_evts)) {
+			GF_FilterEvent *an_evt = gf_list_pop_front(ctx->pending_evts);
+			if (tkw) gf_filter_pid_send_event(tkw->ipid, an_evt);
+			gf_free(an_evt);
+		}
+		return;
+	}
 	if (ctx->flush_llhas) {
 		mp4_mux_flush_frag_llhas(ctx);
 	}
@@ -8373,6 +8458,11 @@ static void mp4_mux_finalize(GF_Filter *filter)
 		gf_filter_pck_unref(pckr);
 	}
 	gf_list_del(ctx->ref_pcks);
+	while (gf_list_count(ctx->pending_evts)) {
+		GF_FilterEvent *an_evt = gf_list_pop_back(ctx->pending_evts);
+		gf_free(an_evt);
+	}
+	gf_list_del(ctx->pending_evts);
 	if (ctx->bs_r) gf_bs_del(ctx->bs_r);
 	if (ctx->seg_name) gf_free(ctx->seg_name);
 	if (ctx->llhas_template) gf_free(ctx->llhas_template);
@@ -8555,6 +8645,7 @@ static const GF_FilterArgs MP4MuxArgs[] =
 	"- tiny: enabled and write reduced version if profile known and compatible", GF_PROP_UINT, "prof", "off|gen|prof|tiny", GF_FS_ARG_HINT_EXPERT},
 	{ OFFS(trunv1), "force using version 1 of trun regardless of media type or CMAF brand", GF_PROP_BOOL, "false", NULL, GF_FS_ARG_HINT_EXPERT},
 	{ OFFS(rsot), "inject redundant sample timing information when present", GF_PROP_BOOL, "false", NULL, GF_FS_ARG_HINT_EXPERT},
+	{ OFFS(fpipe), "pipeline fragment writing in segment sync mode: start building the next fragment without waiting for the previous one to be written, delaying segment size events until write is done. At most one fragment is pending and fragments are still built one after the other", GF_PROP_BOOL, "false", NULL, GF_FS_ARG_HINT_EXPERT},
 	{0}
 };
 
@@ -123,7 +123,6 @@ typedef struct
 
 	Bool check_pcr;
 	Bool update_mux;
-	char *pack_buffer;
 	u64 nb_pck;
 	Bool init_buffering;
 	u32 last_log_time;
@@ -1291,7 +1290,6 @@ static GF_Err tsmux_configure_pid(GF_Filter *filter, GF_FilterPid *pid, Bool is_
 			//use large pack buffer for dash unless not default value
 			if (ctx->nb_pack==4) {
 				ctx->nb_pack = 200;
-				ctx->pack_buffer = gf_realloc(ctx->pack_buffer, sizeof(u8)*188*ctx->nb_pack);
 			}
 			//in dash, force singel PES per AU, some demuxers have issues with PES packets with no ADTS headers (middle of a frame)
 			gf_m2ts_mux_use_single_au_pes_mode(ctx->mux, GF_M2TS_PACK_NONE);
@@ -1792,7 +1790,8 @@ static void ts_mux_on_packet_del(GF_Filter *filter, GF_FilterPid *pid, GF_Filter
 
 static GF_Err tsmux_process(GF_Filter *filter)
 {
-	u32 nb_pck_in_pack, nb_pck_in_call;
+	u32 nb_pck_in_pack, nb_pck_in_call, pack_size;
+	u8 *output;
 	GF_M2TSMuxState status;
 	u32 usec_till_next;
 	GF_FilterPacket *pck;
@@ -1901,45 +1900,43 @@ static GF_Err tsmux_process(GF_Filter *filter)
 
 	nb_pck_in_call = 0;
 	nb_pck_in_pack=0;
+	pack_size = ctx->nb_pack ? ctx->nb_pack : 1;
+	output = NULL;
 	while (1) {
 		u64 pck_ts;
-		u8 *output;
 		u32 osize;
 		Bool is_pack_flush = GF_FALSE;
-		const char *ts_pck;
+		const u8 *ts_pck;
 
+		//first TS packet of a pack is produced in the muxer buffer and copied, next ones are written directly in the output packet
+		gf_m2ts_mux_set_packet_buffer(ctx->mux, nb_pck_in_pack ? output + 188 * nb_pck_in_pack : NULL);
 		ts_pck = gf_m2ts_mux_process(ctx->mux, &status, &usec_till_next);
+		gf_m2ts_mux_set_packet_buffer(ctx->mux, NULL);
 		if (ts_pck == NULL) {
 			if (!nb_pck_in_pack)
 				break;
-			ts_pck = (const char *) ctx->pack_buffer;
+			gf_filter_pck_truncate(pck, nb_pck_in_pack * 188);
 			is_pack_flush = GF_TRUE;
 		} else {
 
 			tsmux_insert_sidx(ctx, GF_FALSE);
 
-			if (ctx->nb_pack>1) {
-				memcpy(ctx->pack_buffer + 188 * nb_pck_in_pack, ts_pck, 188);
-				nb_pck_in_pack++;
-
-				if (nb_pck_in_pack < ctx->nb_pack)
-					continue;
-
-				ts_pck = (const char *) ctx->pack_buffer;
-			} else {
-				nb_pck_in_pack = 1;
+			if (!nb_pck_in_pack) {
+				if (ctx->force_seg_sync) {
+					pck = gf_filter_pck_new_alloc_destructor(ctx->opid, 188 * pack_size, &output, ts_mux_on_packet_del);
+					if (pck) ctx->pending_packets++;
+				} else {
+					pck = gf_filter_pck_new_alloc(ctx->opid, 188 * pack_size, &output);
+				}
+				if (!pck) return GF_OUT_OF_MEM;
+				memcpy(output, ts_pck, 188);
 			}
+			nb_pck_in_pack++;
+			if (nb_pck_in_pack < pack_size)
+				continue;
 		}
 		osize = nb_pck_in_pack * 188;
-		if (ctx->force_seg_sync) {
-			pck = gf_filter_pck_new_alloc_destructor(ctx->opid, osize, &output, ts_mux_on_packet_del);
-			if (pck) ctx->pending_packets++;
-		} else {
-			pck = gf_filter_pck_new_alloc(ctx->opid, osize, &output);
-		}
-		if (!pck) return GF_OUT_OF_MEM;
-		
-		memcpy(output, ts_pck, osize);
+
 		gf_filter_pck_set_framing(pck, ctx->nb_pck ? ctx->next_is_start : GF_TRUE, (status==GF_M2TS_STATE_EOS) ? GF_TRUE : GF_FALSE);
 
 		if (ctx->next_is_start && ctx->dash_mode) {
@@ -2122,7 +2119,6 @@ static GF_Err tsmux_initialize(GF_Filter *filter)
 		ctx->init_buffering = GF_TRUE;
 	}
 	ctx->pids = gf_list_new();
-	if (ctx->nb_pack>1) ctx->pack_buffer = gf_malloc(sizeof(u8)*188*ctx->nb_pack);
 
 #ifdef GPAC_ENABLE_COVERAGE
 	if (gf_sys_is_cov_mode()) {
@@ -2152,7 +2148,6 @@ static void tsmux_finalize(GF_Filter *filter)
 	}
 	gf_list_del(ctx->pids);
 	gf_m2ts_mux_del(ctx->mux);
-	if (ctx->pack_buffer) gf_free(ctx->pack_buffer);
 	if (ctx->sidx_entries) gf_free(ctx->sidx_entries);
 	if (ctx->idx_bs) gf_bs_del(ctx->idx_bs);
 	if (ctx->cur_file_suffix) gf_free(ctx->cur_file_suffix);
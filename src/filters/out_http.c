@@ -113,8 +113,8 @@ typedef struct
 	char *js;
 #endif
 	GF_PropStringList rdirs;
-	Bool close, hold, quit, post, dlist, ice, reopen, blockio, cte, norange;
-	u32 block_size, maxc, maxp, timeout, hmode, sutc, cors, max_client_errors, max_async_buf, ka, zmax, maxs;
+	Bool close, hold, quit, post, dlist, ice, reopen, blockio, cte, norange, epoll, sendfile, cache_pre;
+	u32 block_size, maxc, maxp, timeout, hmode, sutc, cors, max_client_errors, max_async_buf, ka, zmax, maxs, cache_mem;
 	s32 max_cache_segs;
 	GF_PropStringList hdrs;
 	GF_PropUIntList port;
@@ -136,6 +136,14 @@ typedef struct
 
 	u32 nb_connections;
 	Bool had_connections;
+	//totals over closed connections
+	u64 tot_bytes, tot_zc_bytes, tot_send_us;
+	u32 tot_reqs;
+
+	//file cache, least recently used first
+	GF_List *cache;
+	u64 cache_size;
+	u32 cache_hits, cache_miss, cache_evicts;
 
 	GF_FilterCapability in_caps[2];
 	char szExt[10];
@@ -238,6 +246,19 @@ typedef struct
 	s64 end;
 } HTTByteRange;
 
+/*file cached in memory, shared by all sessions sending it*/
+typedef struct
+{
+	char *path;
+	u8 *data;
+	u32 size;
+	u64 modif_time;
+	//number of sessions using the entry
+	u32 nb_used;
+	//set when removed from cache while still in use
+	Bool do_remove;
+} HTTPCacheEntry;
+
 struct __httpout_session {
 	GF_HTTPOutCtx *ctx;
 
@@ -283,12 +304,20 @@ struct __httpout_session {
 	Bool is_h2;
 	Bool sub_sess_pending;
 	Bool canceled;
+	Bool is_tls;
+	//set once sendfile failed on this connection
+	Bool no_sendfile;
+
+	//connection stats, send time is counted from request start to last byte sent
+	u32 conn_nb_reqs;
+	u64 conn_bytes, conn_zc_bytes, conn_send_us;
 
 	Bool force_destroy;
 
 	HTTP_DIRInfo *dir_desc;
 
 	u8 *comp_data;
+	HTTPCacheEntry *cache_ent;
 
 #ifdef GPAC_HAS_QJS
 	JSValue obj;
@@ -321,6 +350,8 @@ typedef struct __gf_http_io
 	u32 nb_used;
 	GF_FileIO *fio;
 	Bool is_llhas_chunk, do_remove, is_static;
+	//last open for read or write, for memory cap
+	u64 last_used;
 } GF_HTTPFileIO;
 
 static void httpio_del(GF_HTTPFileIO *hio)
@@ -382,6 +413,45 @@ static Bool httpio_eof(GF_FileIO *fileio)
 	return GF_FALSE;
 }
 
+//memory cap across all inputs, drop least recently used segments first
+static void httpio_purge_mem(GF_HTTPOutCtx *ctx)
+{
+	u32 i, j, count;
+	u64 mem_size = 0;
+	if (!ctx->cache_mem) return;
+
+	count = gf_list_count(ctx->inputs);
+	for (i=0; i<count; i++) {
+		GF_HTTPOutInput *in = gf_list_get(ctx->inputs, i);
+		if (!in->mem_files) continue;
+		for (j=0; j<gf_list_count(in->mem_files); j++) {
+			GF_HTTPFileIO *hio = gf_list_get(in->mem_files, j);
+			mem_size += hio->size;
+		}
+	}
+	while (mem_size > ctx->cache_mem) {
+		GF_HTTPFileIO *oldest = NULL;
+		for (i=0; i<count; i++) {
+			GF_HTTPOutInput *in = gf_list_get(ctx->inputs, i);
+			if (!in->mem_files) continue;
+			for (j=0; j<gf_list_count(in->mem_files); j++) {
+				GF_HTTPFileIO *hio = gf_list_get(in->mem_files, j);
+				//static file (init seg, manifest), file being written or used, or LLHAS chunk
+				if (hio->is_static || hio->nb_used || hio->is_llhas_chunk || (hio->in && (hio->in->resource==(FILE *)hio->fio)))
+					continue;
+				if (!oldest || (hio->last_used < oldest->last_used))
+					oldest = hio;
+			}
+		}
+		if (!oldest) break;
+		GF_LOG(GF_LOG_DEBUG, GF_LOG_HTTP, ("[HTTPOutIO] remove %s, exceed max cache memory %u\n", gf_fileio_resource_url(oldest->fio), ctx->cache_mem));
+		mem_size -= oldest->size;
+		gf_list_del_item(oldest->in->mem_files, oldest);
+		httpio_del(oldest);
+		ctx->cache_evicts++;
+	}
+}
+
 static GF_FileIO *httpio_open(GF_FileIO *fileio_ref, const char *url, const char *mode, GF_Err *out_err)
 {
 	u32 i, count;
@@ -426,6 +496,7 @@ static GF_FileIO *httpio_open(GF_FileIO *fileio_ref, const char *url, const char
 			i--;
 			count--;
 		}
+		httpio_purge_mem(ioctx->in->ctx);
 		//keep active
 		return NULL;
 	}
@@ -443,6 +514,7 @@ static GF_FileIO *httpio_open(GF_FileIO *fileio_ref, const char *url, const char
 			*out_err = GF_OUT_OF_MEM;
 		}
 		ioctx->fio = gfio;
+		ioctx->last_used = gf_sys_clock_high_res();
 	}
 	if (!strcmp(mode, "rb")) {
 		GF_SAFEALLOC(ioctx, GF_HTTPFileIO);
@@ -453,6 +525,7 @@ static GF_FileIO *httpio_open(GF_FileIO *fileio_ref, const char *url, const char
 		//in read mode, the url given as parent is the gfio:// of the file
 		ioctx->parent = gf_fileio_get_udta(fileio_ref);
 		ioctx->parent->nb_used++;
+		ioctx->parent->last_used = gf_sys_clock_high_res();
 
 		gfio = gf_fileio_new((char *) gf_fileio_resource_url(fileio_ref), ioctx, httpio_open, httpio_seek, httpio_read, NULL, httpio_tell, httpio_eof, NULL);
 		if (!gfio) {
@@ -464,6 +537,149 @@ static GF_FileIO *httpio_open(GF_FileIO *fileio_ref, const char *url, const char
 	return gfio;
 }
 
+//buffer size used for a session, TLS sessions use complete TLS records (16k max payload)
+static u32 httpout_sess_block_size(GF_HTTPOutSession *sess)
+{
+	if (sess->is_tls)
+		return (sess->ctx->block_size + 16383) / 16384 * 16384;
+	return sess->ctx->block_size;
+}
+
+static void httpout_log_conn_stats(GF_HTTPOutSession *sess, Bool last_connection)
+{
+	GF_HTTPOutCtx *ctx = sess->ctx;
+	ctx->tot_reqs += sess->conn_nb_reqs;
+	ctx->tot_bytes += sess->conn_bytes;
+	ctx->tot_zc_bytes += sess->conn_zc_bytes;
+	ctx->tot_send_us += sess->conn_send_us;
+	if (!last_connection || !sess->conn_nb_reqs) return;
+
+	GF_LOG(GF_LOG_INFO, GF_LOG_HTTP, ("[HTTPOut] Connection from %s closed: %u requests - "LLU" bytes ("LLU" zero-copy) sent in %u ms at %g mbps\n",
+		sess->peer_address, sess->conn_nb_reqs, sess->conn_bytes, sess->conn_zc_bytes, (u32) (sess->conn_send_us/1000),
+		sess->conn_send_us ? ((Double) sess->conn_bytes * 8 / sess->conn_send_us) : 0));
+}
+
+static void httpout_cache_status(GF_HTTPOutCtx *ctx)
+{
+	char szStatus[200];
+	u32 nb_req = ctx->cache_hits + ctx->cache_miss;
+	if (!gf_filter_reporting_enabled(ctx->filter)) return;
+	snprintf(szStatus, 200, "cache: %u files "LLU" kB - hit ratio %u%% (%u/%u) - %u evictions",
+		gf_list_count(ctx->cache), ctx->cache_size/1000, nb_req ? (100*ctx->cache_hits/nb_req) : 0, ctx->cache_hits, nb_req, ctx->cache_evicts);
+	gf_filter_update_status(ctx->filter, -1, szStatus);
+}
+
+static void httpout_cache_del(HTTPCacheEntry *ent)
+{
+	gf_free(ent->path);
+	if (ent->data) gf_free(ent->data);
+	gf_free(ent);
+}
+
+//remove entry from cache, destroyed once no longer used
+static void httpout_cache_remove(GF_HTTPOutCtx *ctx, HTTPCacheEntry *ent)
+{
+	gf_list_del_item(ctx->cache, ent);
+	ctx->cache_size -= ent->size;
+	if (ent->nb_used) ent->do_remove = GF_TRUE;
+	else httpout_cache_del(ent);
+}
+
+static void httpout_cache_remove_path(GF_HTTPOutCtx *ctx, const char *path)
+{
+	u32 i, count = gf_list_count(ctx->cache);
+	for (i=0; i<count; i++) {
+		HTTPCacheEntry *ent = gf_list_get(ctx->cache, i);
+		if (strcmp(ent->path, path)) continue;
+		httpout_cache_remove(ctx, ent);
+		return;
+	}
+}
+
+//get cached file, loading it if needed - for_preload loads the file without using it, size may then be 0 (unknown)
+static HTTPCacheEntry *httpout_cache_get(GF_HTTPOutCtx *ctx, const char *path, u64 modif_time, u64 size, Bool for_preload)
+{
+	u32 i, count;
+	u8 *data;
+	u32 data_size;
+	HTTPCacheEntry *ent;
+	if (!ctx->cache || !path || !modif_time) return NULL;
+	//don't let a single file flush most of the cache
+	if (size > ctx->cache_mem/4) return NULL;
+	if (!size && !for_preload) return NULL;
+
+	count = gf_list_count(ctx->cache);
+	for (i=0; i<count; i++) {
+		ent = gf_list_get(ctx->cache, i);
+		if (strcmp(ent->path, path)) continue;
+		//file was modified
+		if ((ent->modif_time != modif_time) || (size && (ent->size != size))) {
+			httpout_cache_remove(ctx, ent);
+			break;
+		}
+		//move to most recently used
+		if (i+1<count) {
+			gf_list_rem(ctx->cache, i);
+			gf_list_add(ctx->cache, ent);
+		}
+		if (for_preload) return ent;
+		ent->nb_used++;
+		ctx->cache_hits++;
+		httpout_cache_status(ctx);
+		return ent;
+	}
+	if (!for_preload)
+		ctx->cache_miss++;
+
+	if (gf_file_load_data(path, &data, &data_size) != GF_OK) return NULL;
+	//file changed while loading
+	if (!data_size || (size && (data_size != size)) || (data_size > ctx->cache_mem/4)
+		|| (gf_file_modification_time(path) != modif_time)
+	) {
+		gf_free(data);
+		return NULL;
+	}
+	GF_SAFEALLOC(ent, HTTPCacheEntry);
+	if (!ent) {
+		gf_free(data);
+		return NULL;
+	}
+	ent->path = gf_strdup(path);
+	ent->data = data;
+	ent->size = data_size;
+	ent->modif_time = modif_time;
+	gf_list_add(ctx->cache, ent);
+	ctx->cache_size += data_size;
+	GF_LOG(GF_LOG_DEBUG, GF_LOG_HTTP, ("[HTTPOut] %s %s in cache (%u bytes)\n", for_preload ? "Preloading" : "Loading", path, data_size));
+
+	//purge least recently used files not in use
+	i = 0;
+	while ((ctx->cache_size > ctx->cache_mem) && (i+1 < gf_list_count(ctx->cache))) {
+		HTTPCacheEntry *old = gf_list_get(ctx->cache, i);
+		if (old->nb_used) {
+			i++;
+			continue;
+		}
+		GF_LOG(GF_LOG_DEBUG, GF_LOG_HTTP, ("[HTTPOut] Removing %s from cache\n", old->path));
+		httpout_cache_remove(ctx, old);
+		ctx->cache_evicts++;
+	}
+	if (!for_preload) ent->nb_used++;
+	httpout_cache_status(ctx);
+	return ent;
+}
+
+static void httpout_sess_release_cache(GF_HTTPOutSession *sess)
+{
+	HTTPCacheEntry *ent = sess->cache_ent;
+	if (!ent) return;
+	sess->cache_ent = NULL;
+	gf_assert(ent->nb_used);
+	ent->nb_used--;
+	if (!ent->nb_used && ent->do_remove)
+		httpout_cache_del(ent);
+}
+
 static void httpout_close_session(GF_HTTPOutSession *sess, GF_Err code)
 {
 	Bool last_connection = GF_TRUE;
@@ -479,6 +695,7 @@ static void httpout_close_session(GF_HTTPOutSession *sess, GF_Err code)
 			gf_dm_sess_flush_h2(sess->http_sess);
 		}
 	}
+	httpout_log_conn_stats(sess, last_connection);
 	if (last_connection) {
 		if (sess->ctx->nb_connections)
 			sess->ctx->nb_connections--;
@@ -1061,6 +1278,7 @@ GF_Err httpout_new_subsession(GF_HTTPOutSession *sess, u32 stream_id)
 	sub_sess->last_active_time = gf_sys_clock_high_res();
 	//mark the subsession as being h2 right away so that we can process it even if no pending data on socket (cf httpout_process_session)
 	sub_sess->is_h2 = GF_TRUE;
+	sub_sess->is_tls = sess->is_tls;
 	strcpy(sub_sess->peer_address, sess->peer_address);
 	sub_sess->http_sess = gf_dm_sess_new_subsession(sess->http_sess, stream_id, sub_sess, &e);
 	if (!sub_sess->http_sess) {
@@ -1648,6 +1866,7 @@ static void httpout_sess_io(void *usr_cbk, GF_NETIO_Parameter *parameter)
 		sess->path = full_path;
 		if (sess->resource) gf_fclose(sess->resource);
 		sess->resource = NULL;
+		httpout_sess_release_cache(sess);
 
 		if (sess->ctx->maxs && sess->content_length && (sess->content_length>sess->ctx->maxs)) {
 			char szTmp[100];
@@ -1694,7 +1913,7 @@ static void httpout_sess_io(void *usr_cbk, GF_NETIO_Parameter *parameter)
 			goto exit;
 		}
 		if (!sess->buffer) {
-			sess->buffer = gf_malloc(sizeof(u8)*sess->ctx->block_size);
+			sess->buffer = gf_malloc(sizeof(u8)*httpout_sess_block_size(sess));
 		}
 		if (gf_list_find(sess->ctx->active_sessions, sess)<0) {
 			gf_list_add(sess->ctx->active_sessions, sess);
@@ -1922,12 +2141,14 @@ static void httpout_sess_io(void *usr_cbk, GF_NETIO_Parameter *parameter)
 		sess->path = full_path;
 		if (sess->resource) gf_fclose(sess->resource);
 		sess->resource = NULL;
+		httpout_sess_release_cache(sess);
 		sess->file_pos = sess->file_size = 0;
 
 		if (sess->ctx->mem_url) {
 			e = GF_NOT_SUPPORTED;
 		}
 		else if (gf_file_exists(full_path)) {
+			if (sess->ctx->cache) httpout_cache_remove_path(sess->ctx, full_path);
 			e = gf_file_delete(full_path);
 
 			if (e) {
@@ -2013,6 +2234,7 @@ static void httpout_sess_io(void *usr_cbk, GF_NETIO_Parameter *parameter)
 			GF_FilterProbeScore probe_score=GF_FPROBE_NOT_SUPPORTED;
 
 			if (sess->resource) gf_fclose(sess->resource);
+			httpout_sess_release_cache(sess);
 			//no need to use gf_fopen_ex in mem mode, since the fullpath is the gfio:// URL of the mem resource
 			sess->resource = gf_fopen(full_path, "rb");
 			//we may not have the file if it is currently being created
@@ -2061,6 +2283,9 @@ static void httpout_sess_io(void *usr_cbk, GF_NETIO_Parameter *parameter)
 			} else if (sess->resource) {
 				//get file size, might be incomplete if file writing is in progress
 				sess->file_size = gf_fsize(sess->resource);
+				//regular file, send from cache if enabled
+				if (!sess->in_source && !sess->ctx->mem_url && (parameter->reply!=GF_HTTP_HEAD))
+					sess->cache_ent = httpout_cache_get(sess->ctx, full_path, modif_time, sess->file_size, GF_FALSE);
 			} else {
 				sess->file_size = 0;
 			}
@@ -2286,7 +2511,6 @@ static void httpout_sess_io(void *usr_cbk, GF_NETIO_Parameter *parameter)
 	if (sess->do_log) {
 		sess->req_id = ++sess->ctx->req_id;
 		sess->method_type = parameter->reply;
-		sess->req_start_time = gf_sys_clock_high_res();
 #ifndef GPAC_DISABLE_LOG
 		u32 log_level = (sess->reply_code>=400) ? GF_LOG_WARNING : GF_LOG_INFO;
 #endif
@@ -2301,6 +2525,8 @@ static void httpout_sess_io(void *usr_cbk, GF_NETIO_Parameter *parameter)
 
 	sess->nb_consecutive_errors = 0;
 	sess->canceled = GF_FALSE;
+	//also used for connection stats
+	sess->req_start_time = gf_sys_clock_high_res();
 	gf_assert(sess->reply_code);
 	e = gf_dm_sess_send_reply(sess->http_sess, sess->reply_code, response_body, response_body ? (u32) strlen(response_body) : 0, no_body);
 	sess->headers_done = GF_TRUE;
@@ -2308,7 +2534,7 @@ static void httpout_sess_io(void *usr_cbk, GF_NETIO_Parameter *parameter)
 
 	if (url) gf_free(url);
 	if (!sess->buffer) {
-		sess->buffer = gf_malloc(sizeof(u8)*sess->ctx->block_size);
+		sess->buffer = gf_malloc(sizeof(u8)*httpout_sess_block_size(sess));
 	}
 	if (response_body) {
 		gf_free(response_body);
@@ -2411,7 +2637,7 @@ exit:
 			sess->use_chunk_transfer=GF_TRUE;
 		}
 		if (!sess->buffer) {
-			sess->buffer = gf_malloc(sizeof(u8)*sess->ctx->block_size);
+			sess->buffer = gf_malloc(sizeof(u8)*httpout_sess_block_size(sess));
 		}
 		sess->is_h2 = gf_dm_sess_is_h2(sess->http_sess);
 	}
@@ -2794,6 +3020,7 @@ check_next_conn:
 #endif
 
 	sess->http_sess = gf_dm_sess_new_server(gf_filter_get_download_manager(ctx->filter), new_conn, ssl_c, httpout_sess_io, sess, !ctx->blockio, &e);
+	sess->is_tls = ssl_c ? GF_TRUE : GF_FALSE;
 	if (!sess->http_sess) {
 		gf_sk_del(new_conn);
 		GF_LOG(GF_LOG_INFO, GF_LOG_HTTP, ("[HTTPOut] Failed to create HTTP server session from %s: %s\n", sess->peer_address, gf_error_to_string(e) ));
@@ -3031,8 +3258,11 @@ static GF_Err httpout_initialize(GF_Filter *filter)
 	ctx->active_sessions = gf_list_new();
 	ctx->inputs = gf_list_new();
 	ctx->filter = filter;
+	//memory mode uses the memory cap on stored files
+	if (ctx->cache_mem && !ctx->mem_url)
+		ctx->cache = gf_list_new();
 	//used in both server and push modes
-	ctx->sg = gf_sk_group_new();
+	ctx->sg = gf_sk_group_new_ex((ctx->epoll && (ctx->hmode!=MODE_PUSH)) ? GF_TRUE : GF_FALSE);
 
 	if (ip)
 		ctx->ip = gf_strdup(ip);
@@ -3197,6 +3427,7 @@ static void httpout_del_session(GF_HTTPOutSession *s)
 	if (s->req_url) gf_free(s->req_url);
 	if (s->opid) gf_filter_pid_remove(s->opid);
 	if (s->resource) gf_fclose(s->resource);
+	httpout_sess_release_cache(s);
 	if (s->ranges) gf_free(s->ranges);
 
 #ifdef GPAC_HAS_QJS
@@ -3288,6 +3519,20 @@ static void httpout_finalize(GF_Filter *filter)
 	gf_list_del(ctx->sessions);
 	gf_list_del(ctx->active_sessions);
 
+	if (ctx->tot_reqs) {
+		GF_LOG(GF_LOG_INFO, GF_LOG_HTTP, ("[HTTPOut] Served %u requests - "LLU" bytes ("LLU" zero-copy) sent in %u ms\n", ctx->tot_reqs, ctx->tot_bytes, ctx->tot_zc_bytes, (u32) (ctx->tot_send_us/1000) ));
+	}
+	if (ctx->cache_hits || ctx->cache_miss || ctx->cache_evicts) {
+		GF_LOG(GF_LOG_INFO, GF_LOG_HTTP, ("[HTTPOut] Cache: %u hits %u misses %u evictions\n", ctx->cache_hits, ctx->cache_miss, ctx->cache_evicts));
+	}
+	if (ctx->cache) {
+		while (gf_list_count(ctx->cache)) {
+			HTTPCacheEntry *ent = gf_list_pop_back(ctx->cache);
+			httpout_cache_del(ent);
+		}
+		gf_list_del(ctx->cache);
+	}
+
 	while (gf_list_count(ctx->inputs)) {
 		GF_HTTPOutInput *in = gf_list_pop_back(ctx->inputs);
 		if (in->local_path) gf_free(in->local_path);
@@ -3474,6 +3719,7 @@ static void httpout_process_session(GF_Filter *filter, GF_HTTPOutCtx *ctx, GF_HT
 {
 	u32 read;
 	u64 to_read=0;
+	u8 *send_buf;
 	GF_Err e = GF_OK;
 	Bool file_in_progress, last_range;
 	Bool close_session = ctx->close;
@@ -3819,16 +4065,74 @@ resend:
 
 	if (to_read) {
 		u64 remain = to_read;
+		u32 block_size = httpout_sess_block_size(sess);
 		//rescedule asap while we send
 		ctx->next_wake_us = 1;
 
-		if (to_read > (u64) sess->ctx->block_size)
-			to_read = (u64) sess->ctx->block_size;
+		//plain TCP file transfer, send from the file without going through our buffer
+		if (ctx->sendfile && sess->resource && !sess->comp_data && !sess->cache_ent && !sess->no_sendfile
+			&& !sess->use_chunk_transfer && !sess->is_h2 && !sess->is_tls && !sess->cbk_throttle
+		) {
+			//don't push more than the socket buffer at once, this would stall on partial segments
+			if (to_read > (u64) block_size)
+				to_read = (u64) block_size;
+
+			e = gf_dm_sess_send_file(sess->http_sess, sess->resource, sess->file_pos, (u32) to_read, &read);
+			if (e==GF_NOT_SUPPORTED) {
+				GF_LOG(GF_LOG_DEBUG, GF_LOG_HTTP, ("[HTTPOut] sendfile not available for %s, using regular send\n", sess->path ? sess->path : sess->req_url));
+				sess->no_sendfile = GF_TRUE;
+				gf_fseek(sess->resource, sess->file_pos, SEEK_SET);
+				goto resend;
+			}
+			sess->last_active_time = gf_sys_clock_high_res();
+			sess->file_pos += read;
+			sess->nb_bytes += read;
+			sess->conn_zc_bytes += read;
 
+			if ((e==GF_IP_CONNECTION_CLOSED) || (e==GF_URL_REMOVED)) {
+				GF_LOG(GF_LOG_DEBUG, GF_LOG_HTTP, ("[HTTPOut] Connection to %s for %s closed\n", sess->peer_address, sess->path ? sess->path : sess->req_url));
+				httpout_mark_session_done(sess);
+				sess->canceled = GF_FALSE;
+				httpout_close_session(sess, e);
+				log_request_done(sess);
+				return;
+			}
+			//socket full, wait for next call
+			if (e==GF_IP_NETWORK_EMPTY)
+				return;
+			if (e) {
+				GF_LOG(GF_LOG_ERROR, GF_LOG_HTTP, ("[HTTPOut] Error sending data to %s for %s: %s\n", sess->peer_address, sess->path ? sess->path : sess->req_url, gf_error_to_string(e) ));
+				return;
+			}
+			//file being written and no data yet
+			if (!read)
+				return;
+
+			GF_LOG(GF_LOG_DEBUG, GF_LOG_HTTP, ("[HTTPOut] sending data to %s for %s: "LLU"/"LLU" bytes\n", sess->peer_address, sess->path ? sess->path : sess->req_url, sess->nb_bytes, sess->bytes_in_req));
+			if (!file_in_progress && last_range && (remain==read))
+				goto session_done;
+			goto resend;
+		}
+
+		if (to_read > (u64) block_size)
+			to_read = (u64) block_size;
+
+		send_buf = sess->buffer;
 		if (sess->comp_data) {
 			memcpy(sess->buffer, sess->comp_data+(u32)sess->file_pos, (u32) to_read);
 			read = (u32) to_read;
 		}
+		//cached file, send from cache memory
+		else if (sess->cache_ent) {
+			if (sess->file_pos + to_read > sess->cache_ent->size)
+				to_read = (sess->file_pos < sess->cache_ent->size) ? (sess->cache_ent->size - sess->file_pos) : 0;
+			if (!to_read) {
+				sess->last_active_time = gf_sys_clock_high_res();
+				return;
+			}
+			send_buf = sess->cache_ent->data + sess->file_pos;
+			read = (u32) to_read;
+		}
 		else if (sess->resource) {
 			read = (u32) gf_fread(sess->buffer, (u32) to_read, sess->resource);
 			//may happen when file writing is in progress
@@ -3847,10 +4151,10 @@ resend:
 			len = (u32) strlen(szHdr);
 
 			e = gf_dm_sess_send(sess->http_sess, szHdr, len);
-			e |= gf_dm_sess_send(sess->http_sess, sess->buffer, read);
+			e |= gf_dm_sess_send(sess->http_sess, send_buf, read);
 			e |= gf_dm_sess_send(sess->http_sess, "\r\n", 2);
 		} else {
-			e = gf_dm_sess_send(sess->http_sess, sess->buffer, read);
+			e = gf_dm_sess_send(sess->http_sess, send_buf, read);
 		}
 		sess->last_active_time = gf_sys_clock_high_res();
 
@@ -3899,6 +4203,10 @@ session_done:
 		close_session = GF_TRUE;
 
 	if (!sess->done) {
+		sess->conn_nb_reqs++;
+		sess->conn_bytes += sess->nb_bytes;
+		sess->conn_send_us += gf_sys_clock_high_res() - sess->req_start_time;
+
 		if (!sess->is_h2 && sess->use_chunk_transfer) {
 			gf_dm_sess_send(sess->http_sess, "0\r\n\r\n", 5);
 		} else {
@@ -3906,6 +4214,7 @@ session_done:
 		}
 		if (sess->resource) gf_fclose(sess->resource);
 		sess->resource = NULL;
+		httpout_sess_release_cache(sess);
 
 		if (sess->comp_data) gf_free(sess->comp_data);
 		sess->comp_data = NULL;
@@ -4149,6 +4458,7 @@ static Bool httpout_open_input(GF_HTTPOutCtx *ctx, GF_HTTPOutInput *in, const ch
 			}
 		}
 
+		if (ctx->cache) httpout_cache_remove_path(ctx, loc_path);
 		gf_file_delete(loc_path);
 		if (o_url) gf_free(o_url);
 		gf_free(loc_path);
@@ -4328,6 +4638,9 @@ static void httpout_close_input(GF_HTTPOutCtx *ctx, GF_HTTPOutInput *in)
 			if (in->resource) {
 				gf_fclose(in->resource);
 				in->resource = NULL;
+				//file is complete, clients will likely request it next
+				if (ctx->cache && ctx->cache_pre && !ctx->mem_url)
+					httpout_cache_get(ctx, in->local_path, gf_file_modification_time(in->local_path), 0, GF_TRUE);
 			}
 			in->skip_resource = SKIP_RES_NO;
 		} else {
@@ -4563,6 +4876,7 @@ static Bool httpout_input_write_ready(GF_HTTPOutCtx *ctx, GF_HTTPOutInput *in)
 			in->upload_sock = gf_dm_sess_get_socket(in->upload);
 			if (!in->upload_sock) return GF_FALSE;
 			gf_sk_group_register(ctx->sg, in->upload_sock);
+			gf_sk_group_sock_set_mode(ctx->sg, in->upload_sock, GF_SK_SELECT_BOTH);
 			gf_sk_group_select(ctx->sg, 10, GF_SK_SELECT_BOTH);
 			gf_sk_set_buffer_size(in->upload_sock, GF_FALSE, ctx->block_size);
 			gf_sk_set_buffer_size(in->upload_sock, GF_TRUE, ctx->block_size);
@@ -5205,6 +5519,14 @@ packet_done:
 		gf_filter_post_process_task(ctx->filter);
 }
 
+//session waiting for a request, nothing to do until data is received
+static Bool httpout_sess_is_idle(GF_HTTPOutSession *sess)
+{
+	if (sess->headers_done || sess->upload_type || sess->is_h2 || sess->force_destroy)
+		return GF_FALSE;
+	return GF_TRUE;
+}
+
 static GF_Err httpout_process(GF_Filter *filter)
 {
 	GF_Err e=GF_OK;
@@ -5226,6 +5548,10 @@ static GF_Err httpout_process(GF_Filter *filter)
 	ctx->next_wake_us = 50000;
 
 	e = gf_sk_group_select(ctx->sg, 10, GF_SK_SELECT_BOTH);
+	//in epoll mode idle sessions are not signaled, active sessions must be processed even if no socket is ready
+	if (ctx->epoll && (e==GF_IP_NETWORK_EMPTY))
+		e = GF_OK;
+
 	if ((e==GF_OK) && ctx->server_sock) {
 		//server mode, check pending connections
 		if (gf_sk_group_sock_is_set(ctx->sg, ctx->server_sock, GF_SK_SELECT_READ)) {
@@ -5260,10 +5586,25 @@ static GF_Err httpout_process(GF_Filter *filter)
 			//if true push, don't process
 			if (sess->in_source && !sess->file_in_progress) continue;
 
+			//TLS sessions and sessions with buffered data may have input not signaled on the socket
+			if (ctx->epoll && sess->http_sess && httpout_sess_is_idle(sess) && !sess->is_tls
+				&& !gf_sk_group_sock_is_set(ctx->sg, sess->socket, GF_SK_SELECT_READ)
+				&& !gf_dm_sess_has_buffered_input(sess->http_sess)
+				&& !gf_dm_sess_async_pending(sess->http_sess)
+			) {
+				//readiness is reported by epoll, no need to check again asap for the first request
+				if (!sess->done && (ctx->next_wake_us > 1000)) ctx->next_wake_us = 1000;
+				continue;
+			}
+
 			//regular download
 			if (sess->http_sess)
 				httpout_process_session(filter, ctx, sess);
 
+			//only watch for write when sending
+			if (ctx->epoll && sess->http_sess)
+				gf_sk_group_sock_set_mode(ctx->sg, sess->socket, httpout_sess_is_idle(sess) ? GF_SK_SELECT_READ : GF_SK_SELECT_BOTH);
+
 			//closed, remove - the session may have been closed previously but not removed from our list
 			if (! sess->http_sess) {
 				httpout_del_session(sess);
@@ -5288,13 +5629,14 @@ static GF_Err httpout_process(GF_Filter *filter)
 
 	if (ctx->timeout && ctx->server_sock) {
 		u32 nb_active=0;
+		u64 now = gf_sys_clock_high_res();
 		count = gf_list_count(ctx->active_sessions);
 		for (i=0; i<count; i++) {
 			u32 diff_sec;
 			GF_HTTPOutSession *sess = gf_list_get(ctx->active_sessions, i);
 			if (sess->http_sess) nb_active++;
 
-			diff_sec = (u32) (gf_sys_clock_high_res() - sess->last_active_time)/1000000;
+			diff_sec = (now > sess->last_active_time) ? (u32) (now - sess->last_active_time)/1000000 : 0;
 			if (diff_sec>ctx->timeout) {
 				GF_LOG(sess->done ? GF_LOG_INFO : GF_LOG_WARNING, GF_LOG_HTTP, ("[HTTPOut] Timeout for peer %s after %d sec, closing connection (last request %s)\n", sess->peer_address, diff_sec, sess->in_source ? sess->in_source->path : (sess->path ? sess->path : sess->req_url) ));
 
@@ -5416,6 +5758,8 @@ static const GF_FilterArgs HTTPOutArgs[] =
 	{ OFFS(close), "close HTTP connection after each request", GF_PROP_BOOL, "false", NULL, GF_FS_ARG_HINT_EXPERT},
 	{ OFFS(maxc), "maximum number of connections, 0 is unlimited", GF_PROP_UINT, "100", NULL, GF_FS_ARG_HINT_EXPERT},
 	{ OFFS(maxp), "maximum number of connections for one peer (0 is unlimited)", GF_PROP_UINT, "6", NULL, GF_FS_ARG_HINT_EXPERT},
+	{ OFFS(epoll), "use epoll in server mode (Linux only), idle connections are only processed when data is received", GF_PROP_BOOL, "false", NULL, GF_FS_ARG_HINT_EXPERT},
+	{ OFFS(sendfile), "use zero-copy sending (sendfile) for files served over plain TCP connections (Linux only)", GF_PROP_BOOL, "true", NULL, GF_FS_ARG_HINT_EXPERT},
 	{ OFFS(cache_control), "specify the `Cache-Control` string to add (`none` disable cache control and ETag)", GF_PROP_STRING, NULL, NULL, GF_FS_ARG_HINT_ADVANCED},
 	{ OFFS(hold), "hold packets until one client connects", GF_PROP_BOOL, "false", NULL, GF_FS_ARG_HINT_ADVANCED},
 	{ OFFS(hmode), "filter operation mode, ignored if [-wdir]() is set\n"
@@ -5437,6 +5781,8 @@ static const GF_FilterArgs HTTPOutArgs[] =
 	{ OFFS(ice), "insert ICE meta-data in response headers in sink mode", GF_PROP_BOOL, "false", NULL, GF_FS_ARG_HINT_EXPERT},
 	{ OFFS(max_client_errors), "force disconnection after specified number of consecutive errors from HTTTP 1.1 client (ignored in H/2 or when `close` is set)", GF_PROP_UINT, "20", NULL, GF_FS_ARG_HINT_EXPERT},
 	{ OFFS(max_cache_segs), "maximum number of segments cached per HAS quality (see filter help)", GF_PROP_SINT, "5", NULL, GF_FS_ARG_HINT_EXPERT},
+	{ OFFS(cache_mem), "maximum memory in bytes used for files cached or stored in memory, 0 means no limit and no cache (see filter help)", GF_PROP_UINT, "0", NULL, GF_FS_ARG_HINT_EXPERT},
+	{ OFFS(cache_pre), "load files produced by input PIDs in cache once written", GF_PROP_BOOL, "true", NULL, GF_FS_ARG_HINT_EXPERT},
 	{ OFFS(reopen), "in server mode with no read dir, accept requests on files already over but with input pid not in end of stream", GF_PROP_BOOL, "false", NULL, GF_FS_ARG_HINT_EXPERT},
 	{ OFFS(max_async_buf), "maximum async buffer size in bytes when sharing output over multiple connection without file IO", GF_PROP_UINT, "100000", NULL, GF_FS_ARG_HINT_EXPERT},
 	{ OFFS(blockio), "use blocking IO in push or source mode or in server mode with no read dir", GF_PROP_BOOL, "false", NULL, GF_FS_ARG_HINT_EXPERT},
@@ -5548,6 +5894,11 @@ GF_FilterRegister HTTPOutRegister = {
 		"- `MAX(N, time-shift depth)` files if stored locally and `N` is positive\n"
 		"- unlimited otherwise (files stored locally, `N` is positive and no time-shift info)\n"
 		"  \n"
+		"If [-cache_mem]() is set, the server keeps the most recently requested files of the read directories in memory up to the given size, "
+		"a file being shared by all clients requesting it. Files larger than a quarter of the cache are not cached. "
+		"When files are produced by input PIDs, they are loaded in the cache as soon as written unless [-cache_pre]() is not set.\n"
+		"In memory mode, [-cache_mem]() limits the size of all stored files, discarding the least recently used segments first.\n"
+		"  \n"
 		"# HTTP client sink\n"
 		"In this mode, the filter will upload input PIDs data to remote server using PUT (or POST if [-post]() is set).\n"
 		"This mode must be explicitly activated using [-hmode]().\n"
@@ -428,27 +428,37 @@ GF_Err naludmx_configure_pid(GF_Filter *filter, GF_FilterPid *pid, Bool is_remov
 	return GF_OK;
 }
 
+#define NALU_SCAN_BLOCK	4096
+
+//locates the next start code from the current position (offset) and positions the bitstream at the first byte of the NAL
 static u64 naludmx_next_start_code(GF_BitStream *bs, u64 offset, u64 fsize, u32 *sc_size)
 {
-	u32 pos=0, nb_zeros=0;
-	while (offset+pos<fsize) {
-		u8 b = gf_bs_read_u8(bs);
-		pos++;
-		switch (b) {
-		case 1:
-			//break at first 0xXX000001 or 0x00000001
-			if (nb_zeros>=2) {
-				*sc_size = (nb_zeros==2) ? 3 : 4;
-				return offset+pos;
-			}
-			nb_zeros = 0;
-			break;
-		case 0:
-			nb_zeros++;
-			break;
-		default:
-			nb_zeros=0;
+	u8 buf[NALU_SCAN_BLOCK];
+	u32 size = 0;
+	//file offset of buf[0]
+	u64 buf_pos = offset;
+
+	while (1) {
+		u32 pos, to_read = NALU_SCAN_BLOCK - size;
+		if (to_read > fsize - buf_pos - size)
+			to_read = (u32) (fsize - buf_pos - size);
+		if (!to_read || (gf_bs_read_data(bs, buf+size, to_read) != to_read))
 			break;
+		size += to_read;
+
+		pos = gf_media_nalu_next_start_code(buf, size, sc_size);
+		if (pos < size) {
+			u64 nal_start = buf_pos + pos + *sc_size;
+			gf_bs_seek(bs, nal_start);
+			//reset emulation prevention byte detection
+			gf_bs_enable_emulation_byte_removal(bs, GF_TRUE);
+			return nal_start;
+		}
+		//keep the last bytes, they may be the beginning of a start code
+		if (size > 3) {
+			memmove(buf, buf + size - 3, 3);
+			buf_pos += size - 3;
+			size = 3;
 		}
 	}
 	//eof
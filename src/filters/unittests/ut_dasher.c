@@ -0,0 +1,248 @@
+#include "tests.h"
+#include <gpac/filters.h>
+
+#define DASH_TEST_DIR	"ut_dasher"
+//4 segments of 1s per representation
+#define DASH_TEST_FRAMES	100
+
+typedef struct
+{
+	GF_FilterPid *opid;
+	u32 nb_frames;
+	u32 size, gop;
+} DashTestSource;
+
+static GF_Err dash_src_initialize(GF_Filter *filter)
+{
+	DashTestSource *ctx = gf_filter_get_udta(filter);
+	ctx->opid = gf_filter_pid_new(filter);
+	if (!ctx->opid) return GF_OUT_OF_MEM;
+	gf_filter_pid_set_property(ctx->opid, GF_PROP_PID_STREAM_TYPE, &PROP_UINT(GF_STREAM_VISUAL));
+	gf_filter_pid_set_property(ctx->opid, GF_PROP_PID_CODECID, &PROP_UINT(GF_CODECID_RAW));
+	gf_filter_pid_set_property(ctx->opid, GF_PROP_PID_PIXFMT, &PROP_UINT(GF_PIXEL_GREYSCALE));
+	gf_filter_pid_set_property(ctx->opid, GF_PROP_PID_WIDTH, &PROP_UINT(ctx->size));
+	gf_filter_pid_set_property(ctx->opid, GF_PROP_PID_HEIGHT, &PROP_UINT(ctx->size));
+	gf_filter_pid_set_property(ctx->opid, GF_PROP_PID_STRIDE, &PROP_UINT(ctx->size));
+	gf_filter_pid_set_property(ctx->opid, GF_PROP_PID_TIMESCALE, &PROP_UINT(25));
+	gf_filter_pid_set_property(ctx->opid, GF_PROP_PID_FPS, &PROP_FRAC_INT(25, 1));
+	gf_filter_pid_set_property(ctx->opid, GF_PROP_PID_DURATION, &PROP_FRAC64_INT(DASH_TEST_FRAMES, 25));
+	gf_filter_pid_set_property(ctx->opid, GF_PROP_PID_BITRATE, &PROP_UINT(ctx->size*ctx->size*25*8));
+	gf_filter_pid_set_property(ctx->opid, GF_PROP_PID_ID, &PROP_UINT(ctx->size));
+	return GF_OK;
+}
+
+static GF_Err dash_src_process(GF_Filter *filter)
+{
+	u8 *data;
+	GF_FilterPacket *pck;
+	DashTestSource *ctx = gf_filter_get_udta(filter);
+	if (ctx->nb_frames == DASH_TEST_FRAMES) {
+		gf_filter_pid_set_eos(ctx->opid);
+		return GF_EOS;
+	}
+	pck = gf_filter_pck_new_alloc(ctx->opid, ctx->size*ctx->size, &data);
+	if (!pck) return GF_OUT_OF_MEM;
+	memset(data, ctx->nb_frames, ctx->size*ctx->size);
+	gf_filter_pck_set_cts(pck, ctx->nb_frames);
+	gf_filter_pck_set_dts(pck, ctx->nb_frames);
+	gf_filter_pck_set_duration(pck, 1);
+	gf_filter_pck_set_sap(pck, (ctx->nb_frames % ctx->gop) ? GF_FILTER_SAP_NONE : GF_FILTER_SAP_1);
+	gf_filter_pck_send(pck);
+	ctx->nb_frames++;
+	return GF_OK;
+}
+
+#define OFFS(_n)	#_n, offsetof(DashTestSource, _n)
+static const GF_FilterArgs DashSrcArgs[] =
+{
+	{ OFFS(size), "frame width and height", GF_PROP_UINT, "16", NULL, 0},
+	{ OFFS(gop), "SAP interval in frames", GF_PROP_UINT, "1", NULL, 0},
+	{0}
+};
+
+static const GF_FilterCapability DashSrcCaps[] =
+{
+	CAP_UINT(GF_CAPS_OUTPUT, GF_PROP_PID_STREAM_TYPE, GF_STREAM_VISUAL),
+	CAP_UINT(GF_CAPS_OUTPUT, GF_PROP_PID_CODECID, GF_CODECID_RAW),
+};
+
+static GF_FilterRegister DashSrcRegister = {
+	.name = "UTDashSrc",
+	GF_FS_SET_DESCRIPTION("Raw video source for dasher tests")
+	.private_size = sizeof(DashTestSource),
+	.flags = GF_FS_REG_EXPLICIT_ONLY,
+	.args = DashSrcArgs,
+	SETCAPS(DashSrcCaps),
+	.initialize = dash_src_initialize,
+	.process = dash_src_process,
+};
+
+//dashes two representations 16x16 and 32x32 in one adaptation set, the 32x32 one having a SAP every gop2 frames
+//nb_mux, if set, receives the number of segment multiplexers used
+static GF_Err dash_test_run(const char *dst_args, u32 gop2, u32 *nb_mux)
+{
+	GF_Err e;
+	char szSrc[100];
+	GF_Filter *src1, *src2, *dst;
+	GF_FilterSession *fs = gf_fs_new(0, GF_FS_SCHEDULER_LOCK_FREE, 0, NULL);
+	if (!fs) return GF_OUT_OF_MEM;
+	gf_fs_add_filter_register(fs, &DashSrcRegister);
+	sprintf(szSrc, "UTDashSrc:size=32:gop=%u", gop2);
+	src1 = gf_fs_load_filter(fs, "UTDashSrc:size=16", &e);
+	src2 = gf_fs_load_filter(fs, szSrc, &e);
+	dst = gf_fs_load_destination(fs, dst_args, NULL, NULL, &e);
+	if (src1 && src2 && dst) {
+		gf_filter_set_source(dst, src1, NULL);
+		gf_filter_set_source(dst, src2, NULL);
+		e = gf_fs_run(fs);
+		if (e>GF_OK) e = GF_OK;
+		if (!e) e = gf_fs_get_last_connect_error(fs);
+		if (!e) e = gf_fs_get_last_process_error(fs);
+		if (nb_mux) {
+			u32 i, count = gf_fs_get_filters_count(fs);
+			*nb_mux = 0;
+			for (i=0; i<count; i++) {
+				GF_FilterStats stats;
+				if (gf_fs_get_filter_stats(fs, i, &stats)) continue;
+				if (stats.reg_name && !strcmp(stats.reg_name, "mp4mx")) (*nb_mux)++;
+			}
+		}
+	} else if (!e) {
+		e = GF_FILTER_NOT_FOUND;
+	}
+	gf_fs_del(fs);
+	return e;
+}
+
+//loads a manifest without its generator comment, which holds the wall clock
+static char *dash_test_load_manifest(const char *path)
+{
+	char *start, *end;
+	u8 *data = NULL;
+	u32 size = 0;
+	if (gf_file_load_data(path, &data, &size) != GF_OK) return NULL;
+	start = strstr((char *) data, "<!--");
+	end = start ? strstr(start, "-->") : NULL;
+	if (end) memmove(start, end+3, strlen(end+3)+1);
+	return (char *) data;
+}
+
+static u32 dash_test_count(const char *str, const char *pattern)
+{
+	u32 nb = 0;
+	while (str && (str = strstr(str, pattern))) {
+		nb++;
+		str += strlen(pattern);
+	}
+	return nb;
+}
+
+//dashes the source with and without indep and loads both manifests
+static Bool dash_test_indep(const char *args, u32 gop2, char **mpd_ref, char **mpd_indep)
+{
+	char szDst[GF_MAX_PATH];
+	*mpd_ref = *mpd_indep = NULL;
+
+	snprintf(szDst, GF_MAX_PATH, DASH_TEST_DIR"/ref/live.mpd:segdur=1:%s", args);
+	if (dash_test_run(szDst, gop2, NULL) != GF_OK) return GF_FALSE;
+	snprintf(szDst, GF_MAX_PATH, DASH_TEST_DIR"/indep/live.mpd:segdur=1:indep:%s", args);
+	if (dash_test_run(szDst, gop2, NULL) != GF_OK) return GF_FALSE;
+
+	*mpd_ref = dash_test_load_manifest(DASH_TEST_DIR"/ref/live.mpd");
+	*mpd_indep = dash_test_load_manifest(DASH_TEST_DIR"/indep/live.mpd");
+	gf_dir_cleanup(DASH_TEST_DIR);
+	return (*mpd_ref && *mpd_indep) ? GF_TRUE : GF_FALSE;
+}
+
+static void dash_test_free(char *mpd_ref, char *mpd_indep)
+{
+	if (mpd_ref) gf_free(mpd_ref);
+	if (mpd_indep) gf_free(mpd_indep);
+}
+
+//independent representations must produce the same manifest as lockstep segmentation,
+//and timelines must move to the representations when segments are not aligned
+unittest(dasher_indep_manifest)
+{
+	char *ref, *mpd;
+
+	gf_mkdir(DASH_TEST_DIR);
+	//aligned, template without timeline
+	assert_true(dash_test_indep("bs_switch=off", 1, &ref, &mpd));
+	assert_true(ref && mpd && !strcmp(ref, mpd));
+	dash_test_free(ref, mpd);
+
+	//aligned, timeline in the adaptation set
+	assert_true(dash_test_indep("stl", 1, &ref, &mpd));
+	assert_true(ref && mpd && !strcmp(ref, mpd));
+	assert_equal(dash_test_count(mpd, "<SegmentTimeline"), 1);
+	assert_equal(dash_test_count(mpd, "segmentAlignment=\"true\""), 1);
+	dash_test_free(ref, mpd);
+
+	//aligned, segment list with timeline
+	assert_true(dash_test_indep("stl:tpl=false", 1, &ref, &mpd));
+	assert_true(ref && mpd && !strcmp(ref, mpd));
+	dash_test_free(ref, mpd);
+
+	//not aligned: both modes fall back to full profile with one timeline per representation,
+	//the first segment of the second representation runs up to the SAP at frame 27
+	//(lockstep segmentation announces 25 and leaves a gap in the timeline)
+	assert_true(dash_test_indep("stl", 3, &ref, &mpd));
+	assert_equal(dash_test_count(ref, "urn:mpeg:dash:profile:full:2011"), 1);
+	assert_equal(dash_test_count(mpd, "urn:mpeg:dash:profile:full:2011"), 1);
+	assert_equal(dash_test_count(mpd, "<SegmentTimeline"), 2);
+	assert_equal(dash_test_count(mpd, "segmentAlignment=\"true\""), 0);
+	assert_equal(dash_test_count(mpd, "<S t=\"0\" d=\"25\" r=\"3\"/>"), 1);
+	assert_equal(dash_test_count(mpd, "<S t=\"0\" d=\"27\"/>"), 1);
+	assert_equal(dash_test_count(mpd, "<S t="), 2);
+	dash_test_free(ref, mpd);
+
+	gf_dir_cleanup(DASH_TEST_DIR);
+	gf_rmdir(DASH_TEST_DIR);
+}
+
+//alternate manifests describe the segments of the main one, each with its own BaseURL and profiles
+unittest(dasher_alt_manifests)
+{
+	u32 i, j, nb_mux=0;
+	char *mpd, *cdn, *m3u8[2];
+	char szSeg[GF_MAX_PATH];
+
+	gf_mkdir(DASH_TEST_DIR);
+	assert_equal(dash_test_run(DASH_TEST_DIR"/live.mpd:segdur=1:tpl=false:altm=live.m3u8,cdn.mpd,sub/bad.mpd"
+		":altbase=,http://cdn.example.com/live/:altpx=,+http://dashif.org/guidelines/cdn", 1, &nb_mux), GF_OK);
+	//one multiplexer per representation, not per manifest
+	assert_equal(nb_mux, 2);
+	assert_false(gf_file_exists(DASH_TEST_DIR"/sub/bad.mpd"));
+
+	mpd = dash_test_load_manifest(DASH_TEST_DIR"/live.mpd");
+	cdn = dash_test_load_manifest(DASH_TEST_DIR"/cdn.mpd");
+	m3u8[0] = dash_test_load_manifest(DASH_TEST_DIR"/live_1.m3u8");
+	m3u8[1] = dash_test_load_manifest(DASH_TEST_DIR"/live_2.m3u8");
+	assert_not_null(mpd);
+	assert_not_null(cdn);
+	assert_true(gf_file_exists(DASH_TEST_DIR"/live.m3u8"));
+	assert_equal(dash_test_count(mpd, "<BaseURL"), 0);
+	assert_equal(dash_test_count(cdn, "<BaseURL>http://cdn.example.com/live/</BaseURL>"), 1);
+	assert_equal(dash_test_count(cdn, "profiles=\"http://dashif.org/guidelines/cdn\""), 1);
+	assert_equal(dash_test_count(mpd, "guidelines/cdn"), 0);
+
+	//every segment is referenced by all manifests, with the same URL
+	for (i=0; i<2; i++) {
+		for (j=0; j<4; j++) {
+			snprintf(szSeg, GF_MAX_PATH, DASH_TEST_DIR"/PID1_dash%u_rep%u.m4s", j+1, i+1);
+			assert_true(gf_file_exists(szSeg));
+			snprintf(szSeg, GF_MAX_PATH, "media=\"PID1_dash%u_rep%u.m4s\"", j+1, i+1);
+			assert_equal(dash_test_count(mpd, szSeg), 1);
+			assert_equal(dash_test_count(cdn, szSeg), 1);
+			snprintf(szSeg, GF_MAX_PATH, "\nPID1_dash%u_rep%u.m4s\n", j+1, i+1);
+			assert_equal(dash_test_count(m3u8[i], szSeg), 1);
+		}
+		if (m3u8[i]) gf_free(m3u8[i]);
+	}
+	if (mpd) gf_free(mpd);
+	if (cdn) gf_free(cdn);
+
+	gf_dir_cleanup(DASH_TEST_DIR);
+	gf_rmdir(DASH_TEST_DIR);
+}
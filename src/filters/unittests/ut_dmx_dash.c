@@ -0,0 +1,454 @@
+#include "tests.h"
+#include <gpac/filters.h>
+#include <gpac/network.h>
+#include <gpac/thread.h>
+
+#define PF_TEST_DIR	"ut_dash_prefetch"
+#define PF_TEST_PORT	25600
+//10 segments of 1s per representation
+#define PF_TEST_FRAMES	250
+#define PF_TEST_SEGS	10
+#define PF_MAX_CONNS	20
+#define PF_MAX_REQS	200
+
+typedef struct
+{
+	GF_FilterPid *opid;
+	u32 nb_frames;
+	u32 size;
+} PFTestSource;
+
+static GF_Err pf_src_initialize(GF_Filter *filter)
+{
+	PFTestSource *ctx = gf_filter_get_udta(filter);
+	ctx->opid = gf_filter_pid_new(filter);
+	if (!ctx->opid) return GF_OUT_OF_MEM;
+	gf_filter_pid_set_property(ctx->opid, GF_PROP_PID_STREAM_TYPE, &PROP_UINT(GF_STREAM_VISUAL));
+	gf_filter_pid_set_property(ctx->opid, GF_PROP_PID_CODECID, &PROP_UINT(GF_CODECID_RAW));
+	gf_filter_pid_set_property(ctx->opid, GF_PROP_PID_PIXFMT, &PROP_UINT(GF_PIXEL_GREYSCALE));
+	gf_filter_pid_set_property(ctx->opid, GF_PROP_PID_WIDTH, &PROP_UINT(ctx->size));
+	gf_filter_pid_set_property(ctx->opid, GF_PROP_PID_HEIGHT, &PROP_UINT(ctx->size));
+	gf_filter_pid_set_property(ctx->opid, GF_PROP_PID_STRIDE, &PROP_UINT(ctx->size));
+	gf_filter_pid_set_property(ctx->opid, GF_PROP_PID_TIMESCALE, &PROP_UINT(25));
+	gf_filter_pid_set_property(ctx->opid, GF_PROP_PID_FPS, &PROP_FRAC_INT(25, 1));
+	gf_filter_pid_set_property(ctx->opid, GF_PROP_PID_BITRATE, &PROP_UINT(ctx->size*ctx->size*25*8));
+	gf_filter_pid_set_property(ctx->opid, GF_PROP_PID_ID, &PROP_UINT(ctx->size));
+	return GF_OK;
+}
+
+static GF_Err pf_src_process(GF_Filter *filter)
+{
+	u8 *data;
+	GF_FilterPacket *pck;
+	PFTestSource *ctx = gf_filter_get_udta(filter);
+	if (ctx->nb_frames == PF_TEST_FRAMES) {
+		gf_filter_pid_set_eos(ctx->opid);
+		return GF_EOS;
+	}
+	pck = gf_filter_pck_new_alloc(ctx->opid, ctx->size*ctx->size, &data);
+	if (!pck) return GF_OUT_OF_MEM;
+	memset(data, ctx->nb_frames, ctx->size*ctx->size);
+	gf_filter_pck_set_cts(pck, ctx->nb_frames);
+	gf_filter_pck_set_dts(pck, ctx->nb_frames);
+	gf_filter_pck_set_duration(pck, 1);
+	gf_filter_pck_set_sap(pck, GF_FILTER_SAP_1);
+	gf_filter_pck_send(pck);
+	ctx->nb_frames++;
+	return GF_OK;
+}
+
+#define OFFS(_n)	#_n, offsetof(PFTestSource, _n)
+static const GF_FilterArgs PFSrcArgs[] =
+{
+	{ OFFS(size), "frame width and height", GF_PROP_UINT, "16", NULL, 0},
+	{0}
+};
+
+static const GF_FilterCapability PFSrcCaps[] =
+{
+	CAP_UINT(GF_CAPS_OUTPUT, GF_PROP_PID_STREAM_TYPE, GF_STREAM_VISUAL),
+	CAP_UINT(GF_CAPS_OUTPUT, GF_PROP_PID_CODECID, GF_CODECID_RAW),
+};
+
+static GF_FilterRegister PFSrcRegister = {
+	.name = "UTPFSrc",
+	GF_FS_SET_DESCRIPTION("Raw video source for DASH prefetch test")
+	.private_size = sizeof(PFTestSource),
+	.flags = GF_FS_REG_EXPLICIT_ONLY,
+	.args = PFSrcArgs,
+	SETCAPS(PFSrcCaps),
+	.initialize = pf_src_initialize,
+	.process = pf_src_process,
+};
+
+//two representations 16x16 and 32x32 in one adaptation set, segments named <rep>_<number>.m4s
+static GF_Err pf_test_generate(void)
+{
+	GF_Err e;
+	GF_Filter *src1, *src2, *dst;
+	GF_FilterSession *fs = gf_fs_new(0, GF_FS_SCHEDULER_LOCK_FREE, 0, NULL);
+	if (!fs) return GF_OUT_OF_MEM;
+	gf_fs_add_filter_register(fs, &PFSrcRegister);
+	src1 = gf_fs_load_filter(fs, "UTPFSrc:size=16", &e);
+	src2 = gf_fs_load_filter(fs, "UTPFSrc:size=32", &e);
+	dst = gf_fs_load_destination(fs, PF_TEST_DIR"/live.mpd:segdur=1:bs_switch=off:template=$RepresentationID$_$Number$", NULL, NULL, &e);
+	if (src1 && src2 && dst) {
+		gf_filter_set_source(dst, src1, NULL);
+		gf_filter_set_source(dst, src2, NULL);
+		e = gf_fs_run(fs);
+		if (e>GF_OK) e = GF_OK;
+		if (!e) e = gf_fs_get_last_connect_error(fs);
+		if (!e) e = gf_fs_get_last_process_error(fs);
+	} else if (!e) {
+		e = GF_FILTER_NOT_FOUND;
+	}
+	gf_fs_del(fs);
+	return e;
+}
+
+typedef struct
+{
+	GF_Socket *sk;
+	char req[2000];
+	u32 req_size;
+	//segment request waiting for its reply time
+	char path[256];
+	u32 reply_time;
+} PFTestConn;
+
+//minimal HTTP/1.1 server delaying segment replies, so that concurrent downloads can be observed
+typedef struct
+{
+	GF_Socket *server;
+	u16 port;
+	GF_Mutex *mx;
+	Bool stop;
+	u32 delay;
+	PFTestConn conns[PF_MAX_CONNS];
+	//segment requests in arrival order
+	char *reqs[PF_MAX_REQS];
+	u32 nb_reqs;
+	u32 nb_pending, max_pending, nb_aborted;
+} PFTestServer;
+
+static void pf_server_reply(PFTestServer *srv, PFTestConn *c)
+{
+	char szPath[GF_MAX_PATH], szHdr[200];
+	u8 *data = NULL;
+	u32 size = 0;
+	snprintf(szPath, GF_MAX_PATH, PF_TEST_DIR"%s", c->path);
+	gf_file_load_data(szPath, &data, &size);
+	if (data)
+		sprintf(szHdr, "HTTP/1.1 200 OK\r\nContent-Length: %u\r\nContent-Type: application/octet-stream\r\nConnection: keep-alive\r\n\r\n", size);
+	else
+		sprintf(szHdr, "HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\nConnection: keep-alive\r\n\r\n");
+	gf_sk_set_block_mode(c->sk, GF_FALSE);
+	gf_sk_send(c->sk, (u8 *) szHdr, (u32) strlen(szHdr));
+	if (data) {
+		gf_sk_send(c->sk, data, size);
+		gf_free(data);
+	}
+	gf_sk_set_block_mode(c->sk, GF_TRUE);
+}
+
+static void pf_server_close(PFTestServer *srv, PFTestConn *c)
+{
+	if (c->path[0]) {
+		srv->nb_pending--;
+		srv->nb_aborted++;
+	}
+	gf_sk_del(c->sk);
+	memset(c, 0, sizeof(PFTestConn));
+}
+
+static void pf_server_conn(PFTestServer *srv, PFTestConn *c)
+{
+	char *sep;
+	u32 read = 0;
+	GF_Err e;
+	if (c->path[0]) {
+		if (gf_sys_clock() < c->reply_time) return;
+		pf_server_reply(srv, c);
+		gf_mx_p(srv->mx);
+		srv->nb_pending--;
+		gf_mx_v(srv->mx);
+		c->path[0] = 0;
+	}
+	e = gf_sk_receive_no_select(c->sk, (u8 *) c->req + c->req_size, 1999 - c->req_size, &read);
+	if ((e==GF_IP_CONNECTION_CLOSED) || (!read && (c->req_size==1999))) {
+		gf_mx_p(srv->mx);
+		pf_server_close(srv, c);
+		gf_mx_v(srv->mx);
+		return;
+	}
+	c->req_size += read;
+	c->req[c->req_size] = 0;
+	sep = strstr(c->req, "\r\n\r\n");
+	if (!sep) return;
+	if (!strncmp(c->req, "GET ", 4) || !strncmp(c->req, "HEAD ", 5)) {
+		char *path = strchr(c->req, ' ') + 1;
+		char *end = strchr(path, ' ');
+		if (end) end[0] = 0;
+		strncpy(c->path, path, 255);
+		if (strstr(c->path, ".m4s")) {
+			gf_mx_p(srv->mx);
+			if (srv->nb_reqs<PF_MAX_REQS)
+				srv->reqs[srv->nb_reqs++] = gf_strdup(c->path);
+			srv->nb_pending++;
+			if (srv->nb_pending > srv->max_pending) srv->max_pending = srv->nb_pending;
+			gf_mx_v(srv->mx);
+			c->reply_time = gf_sys_clock() + srv->delay;
+		} else {
+			//manifest and init segments are sent right away
+			pf_server_reply(srv, c);
+			c->path[0] = 0;
+		}
+	}
+	//requests are not pipelined by the downloader
+	c->req_size = 0;
+}
+
+static u32 pf_server_run(void *par)
+{
+	PFTestServer *srv = par;
+	while (!srv->stop) {
+		u32 i;
+		GF_Socket *sk = NULL;
+		if (gf_sk_accept(srv->server, &sk) == GF_OK) {
+			for (i=0; i<PF_MAX_CONNS; i++) {
+				if (srv->conns[i].sk) continue;
+				srv->conns[i].sk = sk;
+				gf_sk_set_block_mode(sk, GF_TRUE);
+				sk = NULL;
+				break;
+			}
+			if (sk) gf_sk_del(sk);
+		}
+		for (i=0; i<PF_MAX_CONNS; i++) {
+			if (srv->conns[i].sk) pf_server_conn(srv, &srv->conns[i]);
+		}
+		gf_sleep(1);
+	}
+	return 0;
+}
+
+static Bool pf_server_start(PFTestServer *srv, GF_Thread *th, u32 delay)
+{
+	memset(srv, 0, sizeof(PFTestServer));
+	srv->delay = delay;
+	for (srv->port=PF_TEST_PORT; srv->port<PF_TEST_PORT+100; srv->port++) {
+		srv->server = gf_sk_new(GF_SOCK_TYPE_TCP);
+		if (!srv->server) return GF_FALSE;
+		if (!gf_sk_bind(srv->server, "127.0.0.1", srv->port, NULL, 0, 0) && !gf_sk_listen(srv->server, PF_MAX_CONNS))
+			break;
+		gf_sk_del(srv->server);
+		srv->server = NULL;
+	}
+	if (!srv->server) return GF_FALSE;
+	gf_sk_set_block_mode(srv->server, GF_TRUE);
+	srv->mx = gf_mx_new("PFTestServer");
+	return (gf_th_run(th, pf_server_run, srv) == GF_OK) ? GF_TRUE : GF_FALSE;
+}
+
+static void pf_server_stop(PFTestServer *srv, GF_Thread *th)
+{
+	u32 i;
+	srv->stop = GF_TRUE;
+	gf_th_stop(th);
+	for (i=0; i<PF_MAX_CONNS; i++) {
+		if (srv->conns[i].sk) gf_sk_del(srv->conns[i].sk);
+	}
+	for (i=0; i<srv->nb_reqs; i++)
+		gf_free(srv->reqs[i]);
+	if (srv->server) gf_sk_del(srv->server);
+	if (srv->mx) gf_mx_del(srv->mx);
+}
+
+//filter private data is freed with the session
+static u32 pf_sink_buffer_ms;
+static u32 pf_nb_frames, pf_nb_errors;
+//size of the frames of each segment
+static u32 pf_seg_size[PF_TEST_SEGS];
+
+static GF_Err pf_sink_configure_pid(GF_Filter *filter, GF_FilterPid *pid, Bool is_remove)
+{
+	GF_FilterEvent evt;
+	if (is_remove) return GF_OK;
+	//buffer must be set before playback starts, dashin reads it when the group starts
+	if (pf_sink_buffer_ms) {
+		GF_FEVT_INIT(evt, GF_FEVT_BUFFER_REQ, pid);
+		evt.buffer_req.max_buffer_us = pf_sink_buffer_ms * 1000;
+		evt.buffer_req.pid_only = GF_TRUE;
+		gf_filter_pid_send_event(pid, &evt);
+	}
+	gf_filter_pid_init_play_event(pid, &evt, 0, 1.0, "UTPFSink");
+	gf_filter_pid_send_event(pid, &evt);
+	return GF_OK;
+}
+
+//frames must be received once and in order, all frames of a segment from the same representation
+static GF_Err pf_sink_process(GF_Filter *filter)
+{
+	u32 i, count = gf_filter_get_ipid_count(filter);
+	for (i=0; i<count; i++) {
+		GF_FilterPacket *pck;
+		GF_FilterPid *pid = gf_filter_get_ipid(filter, i);
+		while ((pck = gf_filter_pid_get_packet(pid))) {
+			u32 size, seg;
+			const u8 *data = gf_filter_pck_get_data(pck, &size);
+			if (!data || (gf_filter_pck_get_cts(pck) != pf_nb_frames) || (data[0] != (u8) pf_nb_frames)) {
+				pf_nb_errors++;
+			} else {
+				seg = pf_nb_frames / 25;
+				if (!pf_seg_size[seg]) pf_seg_size[seg] = size;
+				else if (pf_seg_size[seg] != size) pf_nb_errors++;
+			}
+			pf_nb_frames++;
+			gf_filter_pid_drop_packet(pid);
+		}
+	}
+	return GF_OK;
+}
+
+static const GF_FilterCapability PFSinkCaps[] =
+{
+	CAP_UINT(GF_CAPS_INPUT, GF_PROP_PID_STREAM_TYPE, GF_STREAM_VISUAL),
+	CAP_UINT(GF_CAPS_INPUT, GF_PROP_PID_CODECID, GF_CODECID_RAW),
+};
+
+static GF_FilterRegister PFSinkRegister = {
+	.name = "UTPFSink",
+	GF_FS_SET_DESCRIPTION("DASH prefetch test sink")
+	.flags = GF_FS_REG_EXPLICIT_ONLY,
+	.max_extra_pids = (u32) -1,
+	SETCAPS(PFSinkCaps),
+	.configure_pid = pf_sink_configure_pid,
+	.process = pf_sink_process,
+};
+
+static GF_Err pf_test_play(PFTestServer *srv, const char *dash_args)
+{
+	GF_Err e;
+	char szURL[GF_MAX_PATH];
+	GF_Filter *src, *dmx, *sink;
+	GF_FilterSession *fs = gf_fs_new(0, GF_FS_SCHEDULER_LOCK_FREE, 0, NULL);
+	if (!fs) return GF_OUT_OF_MEM;
+	pf_nb_frames = pf_nb_errors = 0;
+	memset(pf_seg_size, 0, sizeof(pf_seg_size));
+	gf_fs_add_filter_register(fs, &PFSinkRegister);
+	snprintf(szURL, GF_MAX_PATH, "http://127.0.0.1:%u/live.mpd", srv->port);
+	src = gf_fs_load_source(fs, szURL, NULL, NULL, &e);
+	snprintf(szURL, GF_MAX_PATH, "dashin:algo=none:start_with=min_bw:%s", dash_args);
+	dmx = gf_fs_load_filter(fs, szURL, &e);
+	sink = gf_fs_load_filter(fs, "UTPFSink", &e);
+	if (src && dmx && sink) {
+		gf_filter_set_source(dmx, src, NULL);
+		gf_filter_set_source(sink, dmx, NULL);
+		e = gf_fs_run(fs);
+		if (e>GF_OK) e = GF_OK;
+		if (!e) e = gf_fs_get_last_connect_error(fs);
+	} else if (!e) {
+		e = GF_FILTER_NOT_FOUND;
+	}
+	gf_fs_del(fs);
+	return e;
+}
+
+static u32 pf_test_count(PFTestServer *srv, const char *rep)
+{
+	u32 i, nb=0;
+	for (i=0; i<srv->nb_reqs; i++) {
+		if (!strncmp(srv->reqs[i]+1, rep, strlen(rep))) nb++;
+	}
+	return nb;
+}
+
+//no segment is requested twice
+static Bool pf_test_unique(PFTestServer *srv)
+{
+	u32 i, j;
+	for (i=0; i<srv->nb_reqs; i++) {
+		for (j=i+1; j<srv->nb_reqs; j++) {
+			if (!strcmp(srv->reqs[i], srv->reqs[j])) return GF_FALSE;
+		}
+	}
+	return GF_TRUE;
+}
+
+//plays the test content with the given sink buffer and dashin options, returns the number of concurrent segment downloads
+static u32 pf_test_window(u32 buffer_ms, const char *dash_args)
+{
+	u32 max_pending;
+	PFTestServer srv;
+	GF_Thread *th = gf_th_new("PFTestServer");
+	pf_sink_buffer_ms = buffer_ms;
+	assert_true(pf_server_start(&srv, th, 100));
+	assert_equal(pf_test_play(&srv, dash_args), GF_OK);
+	assert_equal(pf_nb_frames, PF_TEST_FRAMES);
+	assert_equal(pf_nb_errors, 0);
+	assert_equal(srv.nb_reqs, PF_TEST_SEGS);
+	assert_equal(pf_test_count(&srv, "1_"), PF_TEST_SEGS);
+	assert_true(pf_test_unique(&srv));
+	assert_equal(srv.nb_aborted, 0);
+	max_pending = srv.max_pending;
+	pf_server_stop(&srv, th);
+	gf_th_del(th);
+	return max_pending;
+}
+
+//prefetch window is the option value, reduced by the buffer left for segments after the one being downloaded
+unittest(dashin_prefetch_window)
+{
+	u32 max_pending;
+	assert_equal(pf_test_generate(), GF_OK);
+
+	//no prefetch: one segment at a time
+	assert_equal(pf_test_window(10000, "prefetch=0"), 1);
+	//large buffer: the current segment and the 3 next ones
+	max_pending = pf_test_window(10000, "prefetch=3");
+	assert_true(max_pending > 1);
+	assert_true(max_pending <= 4);
+	//3s of buffer: at most 2 segments ahead of the current one
+	max_pending = pf_test_window(3000, "prefetch=3");
+	assert_true(max_pending > 1);
+	assert_true(max_pending <= 3);
+	//2s of buffer: at most 1 segment ahead
+	assert_true(pf_test_window(2000, "prefetch=3") <= 2);
+
+	gf_dir_cleanup(PF_TEST_DIR);
+	gf_rmdir(PF_TEST_DIR);
+}
+
+//prefetched segments of the previous representation are dropped on quality switch, never delivered
+unittest(dashin_prefetch_switch)
+{
+	u32 i, nb_seg_1=0, nb_seg_2=0;
+	GF_Thread *th;
+	PFTestServer srv;
+
+	assert_equal(pf_test_generate(), GF_OK);
+	th = gf_th_new("PFTestServer");
+	pf_sink_buffer_ms = 10000;
+	assert_true(pf_server_start(&srv, th, 100));
+	//switch representation every 4 segments
+	assert_equal(pf_test_play(&srv, "prefetch=3:auto_switch=4"), GF_OK);
+	assert_equal(pf_nb_frames, PF_TEST_FRAMES);
+	assert_equal(pf_nb_errors, 0);
+	for (i=0; i<PF_TEST_SEGS; i++) {
+		//16x16 or 32x32 greyscale
+		if (pf_seg_size[i]==256) nb_seg_1++;
+		else if (pf_seg_size[i]==1024) nb_seg_2++;
+	}
+	assert_equal(nb_seg_1 + nb_seg_2, PF_TEST_SEGS);
+	assert_equal(pf_seg_size[0], 256);
+	assert_true(nb_seg_2 > 0);
+	//both representations were prefetched beyond what was played, and nothing was fetched twice
+	assert_true(pf_test_count(&srv, "1_") > nb_seg_1);
+	assert_true(pf_test_count(&srv, "2_") > nb_seg_2);
+	assert_true(pf_test_unique(&srv));
+
+	pf_server_stop(&srv, th);
+	gf_th_del(th);
+	gf_dir_cleanup(PF_TEST_DIR);
+	gf_rmdir(PF_TEST_DIR);
+}
@@ -0,0 +1,333 @@
+#include "tests.h"
+#include <gpac/filters.h>
+#include <gpac/constants.h>
+#include <gpac/bitstream.h>
+#include <gpac/mpeg4_odf.h>
+
+#define CENC_TEST_FRAMES	300
+#define CENC_TEST_CFG	"ut_cenc_par.xml"
+
+//baseline 16x16 SPS (poc type 2, 4-bit frame num) and CAVLC PPS with deblocking control
+static const u8 cenc_test_sps[] = {0x67, 0x42, 0xC0, 0x0A, 0xDA, 0x79};
+static const u8 cenc_test_pps[] = {0x68, 0xCE, 0x3C, 0x80};
+
+//filter private data is freed with the session
+//source samples are kept in emission order, to check the output is actually encrypted
+static GF_BitStream *cenc_test_src, *cenc_test_dst, *cenc_test_sai;
+static u32 cenc_test_nb_frames, cenc_test_nb_subs, cenc_test_iv_size;
+
+typedef struct
+{
+	GF_FilterPid *opid;
+	u32 nb_frames;
+	u32 seed;
+} CENCTestSource;
+
+static u32 cenc_test_rand(u32 *seed)
+{
+	*seed = (*seed) * 1103515245 + 12345;
+	return (*seed >> 8) & 0xFFFFFF;
+}
+
+static GF_Err cenc_src_initialize(GF_Filter *filter)
+{
+	u8 *dsi=NULL;
+	u32 dsi_size=0;
+	GF_NALUFFParam sps, pps;
+	GF_AVCConfig *avcc;
+	CENCTestSource *ctx = gf_filter_get_udta(filter);
+	ctx->seed = 0xCE4C;
+	ctx->opid = gf_filter_pid_new(filter);
+	if (!ctx->opid) return GF_OUT_OF_MEM;
+
+	avcc = gf_odf_avc_cfg_new();
+	if (!avcc) return GF_OUT_OF_MEM;
+	avcc->configurationVersion = 1;
+	avcc->AVCProfileIndication = cenc_test_sps[1];
+	avcc->profile_compatibility = cenc_test_sps[2];
+	avcc->AVCLevelIndication = cenc_test_sps[3];
+	avcc->nal_unit_size = 4;
+	sps.data = (u8 *) cenc_test_sps;
+	sps.size = sizeof(cenc_test_sps);
+	pps.data = (u8 *) cenc_test_pps;
+	pps.size = sizeof(cenc_test_pps);
+	gf_list_add(avcc->sequenceParameterSets, &sps);
+	gf_list_add(avcc->pictureParameterSets, &pps);
+	gf_odf_avc_cfg_write(avcc, &dsi, &dsi_size);
+	//parameter sets are not owned by the config
+	gf_list_reset(avcc->sequenceParameterSets);
+	gf_list_reset(avcc->pictureParameterSets);
+	gf_odf_avc_cfg_del(avcc);
+	if (!dsi) return GF_OUT_OF_MEM;
+
+	gf_filter_pid_set_property(ctx->opid, GF_PROP_PID_STREAM_TYPE, &PROP_UINT(GF_STREAM_VISUAL));
+	gf_filter_pid_set_property(ctx->opid, GF_PROP_PID_CODECID, &PROP_UINT(GF_CODECID_AVC));
+	gf_filter_pid_set_property(ctx->opid, GF_PROP_PID_DECODER_CONFIG, &PROP_DATA_NO_COPY(dsi, dsi_size));
+	gf_filter_pid_set_property(ctx->opid, GF_PROP_PID_WIDTH, &PROP_UINT(16));
+	gf_filter_pid_set_property(ctx->opid, GF_PROP_PID_HEIGHT, &PROP_UINT(16));
+	gf_filter_pid_set_property(ctx->opid, GF_PROP_PID_TIMESCALE, &PROP_UINT(25));
+	gf_filter_pid_set_property(ctx->opid, GF_PROP_PID_ID, &PROP_UINT(1));
+	return GF_OK;
+}
+
+//random payload without zero bytes, so that no start code or emulation prevention is needed
+static void cenc_src_write_payload(GF_BitStream *bs, u32 size, u32 *seed)
+{
+	while (size) {
+		gf_bs_write_u8(bs, 1 + cenc_test_rand(seed) % 255);
+		size--;
+	}
+}
+
+//samples made of an optional SEI and 1 to 4 IDR slices of random sizes, down to slices with less than one block of payload
+static GF_Err cenc_src_process(GF_Filter *filter)
+{
+	u8 *data, *nals;
+	u32 i, nb_slices, size, nals_size;
+	GF_BitStream *bs;
+	GF_FilterPacket *pck;
+	CENCTestSource *ctx = gf_filter_get_udta(filter);
+	if (ctx->nb_frames == CENC_TEST_FRAMES) {
+		gf_filter_pid_set_eos(ctx->opid);
+		return GF_EOS;
+	}
+	bs = gf_bs_new(NULL, 0, GF_BITSTREAM_WRITE);
+	if (cenc_test_rand(&ctx->seed) % 3 == 0) {
+		size = 2 + cenc_test_rand(&ctx->seed) % 30;
+		gf_bs_write_u32(bs, size);
+		gf_bs_write_u8(bs, GF_AVC_NALU_SEI);
+		cenc_src_write_payload(bs, size-1, &ctx->seed);
+	}
+	nb_slices = 1 + cenc_test_rand(&ctx->seed) % 4;
+	for (i=0; i<nb_slices; i++) {
+		GF_BitStream *nal_bs = gf_bs_new(NULL, 0, GF_BITSTREAM_WRITE);
+		gf_bs_write_u8(nal_bs, 0x60 | GF_AVC_NALU_IDR_SLICE);
+		//first_mb_in_slice=0, slice_type=I (7), pps_id=0, frame_num=0, idr_pic_id=0
+		gf_bs_write_int(nal_bs, 1, 1);
+		gf_bs_write_int(nal_bs, 8, 7);
+		gf_bs_write_int(nal_bs, 1, 1);
+		gf_bs_write_int(nal_bs, 0, 4);
+		gf_bs_write_int(nal_bs, 1, 1);
+		//no_output_of_prior_pics, long_term_reference, slice_qp_delta=0, disable_deblocking_filter_idc=1
+		gf_bs_write_int(nal_bs, 0, 2);
+		gf_bs_write_int(nal_bs, 1, 1);
+		gf_bs_write_int(nal_bs, 2, 3);
+		gf_bs_align(nal_bs);
+		size = cenc_test_rand(&ctx->seed) % 8;
+		if (size) size = 1 + cenc_test_rand(&ctx->seed) % ((size<3) ? 20 : 600);
+		cenc_src_write_payload(nal_bs, size, &ctx->seed);
+		nals = NULL;
+		nals_size = 0;
+		gf_bs_get_content(nal_bs, &nals, &nals_size);
+		gf_bs_del(nal_bs);
+		gf_bs_write_u32(bs, nals_size);
+		gf_bs_write_data(bs, nals, nals_size);
+		gf_free(nals);
+	}
+	nals = NULL;
+	nals_size = 0;
+	gf_bs_get_content(bs, &nals, &nals_size);
+	gf_bs_del(bs);
+
+	pck = gf_filter_pck_new_alloc(ctx->opid, nals_size, &data);
+	if (!pck) {
+		gf_free(nals);
+		return GF_OUT_OF_MEM;
+	}
+	memcpy(data, nals, nals_size);
+	gf_bs_write_u32(cenc_test_src, nals_size);
+	gf_bs_write_data(cenc_test_src, nals, nals_size);
+	gf_free(nals);
+	gf_filter_pck_set_cts(pck, ctx->nb_frames);
+	gf_filter_pck_set_dts(pck, ctx->nb_frames);
+	gf_filter_pck_set_duration(pck, 1);
+	gf_filter_pck_set_sap(pck, GF_FILTER_SAP_1);
+	gf_filter_pck_send(pck);
+	ctx->nb_frames++;
+	return GF_OK;
+}
+
+static const GF_FilterCapability CENCSrcCaps[] =
+{
+	CAP_UINT(GF_CAPS_OUTPUT, GF_PROP_PID_STREAM_TYPE, GF_STREAM_VISUAL),
+	CAP_UINT(GF_CAPS_OUTPUT, GF_PROP_PID_CODECID, GF_CODECID_AVC),
+};
+
+static GF_FilterRegister CENCSrcRegister = {
+	.name = "UTCENCSrc",
+	GF_FS_SET_DESCRIPTION("AVC source for parallel encryption test")
+	.private_size = sizeof(CENCTestSource),
+	.flags = GF_FS_REG_EXPLICIT_ONLY,
+	SETCAPS(CENCSrcCaps),
+	.initialize = cenc_src_initialize,
+	.process = cenc_src_process,
+};
+
+static GF_Err cenc_sink_configure_pid(GF_Filter *filter, GF_FilterPid *pid, Bool is_remove)
+{
+	GF_FilterEvent evt;
+	if (is_remove) return GF_OK;
+	gf_filter_pid_init_play_event(pid, &evt, 0, 1.0, "UTCENCSink");
+	gf_filter_pid_send_event(pid, &evt);
+	return GF_OK;
+}
+
+//stores payloads, and crypt flags and sample auxiliary info of each packet
+static GF_Err cenc_sink_process(GF_Filter *filter)
+{
+	GF_FilterPacket *pck;
+	GF_FilterPid *pid = gf_filter_get_ipid(filter, 0);
+	while ((pck = gf_filter_pid_get_packet(pid))) {
+		u32 size;
+		const u8 *data = gf_filter_pck_get_data(pck, &size);
+		const GF_PropertyValue *sai = gf_filter_pck_get_property(pck, GF_PROP_PCK_CENC_SAI);
+		gf_bs_write_u32(cenc_test_dst, size);
+		gf_bs_write_data(cenc_test_dst, data, size);
+		gf_bs_write_u32(cenc_test_sai, gf_filter_pck_get_crypt_flags(pck));
+		if (sai) {
+			gf_bs_write_u32(cenc_test_sai, sai->value.data.size);
+			gf_bs_write_data(cenc_test_sai, sai->value.data.ptr, sai->value.data.size);
+			//subsample count follows the IV
+			if (sai->value.data.size >= cenc_test_iv_size + 2)
+				cenc_test_nb_subs += (sai->value.data.ptr[cenc_test_iv_size]<<8) | sai->value.data.ptr[cenc_test_iv_size+1];
+		} else {
+			gf_bs_write_u32(cenc_test_sai, 0);
+		}
+		cenc_test_nb_frames++;
+		gf_filter_pid_drop_packet(pid);
+	}
+	return GF_OK;
+}
+
+static const GF_FilterCapability CENCSinkCaps[] =
+{
+	CAP_UINT(GF_CAPS_INPUT, GF_PROP_PID_STREAM_TYPE, GF_STREAM_ENCRYPTED),
+};
+
+static GF_FilterRegister CENCSinkRegister = {
+	.name = "UTCENCSink",
+	GF_FS_SET_DESCRIPTION("Parallel encryption test sink")
+	.flags = GF_FS_REG_EXPLICIT_ONLY,
+	SETCAPS(CENCSinkCaps),
+	.configure_pid = cenc_sink_configure_pid,
+	.process = cenc_sink_process,
+};
+
+typedef struct
+{
+	u8 *data, *sai;
+	u32 size, sai_size;
+	u32 nb_frames, nb_changed, nb_subs;
+} CENCTestResult;
+
+//encrypts the test samples with the given DRM config and number of threads
+static GF_Err cenc_test_run(const char *drm_cfg, u32 iv_size, s32 nbth, CENCTestResult *res)
+{
+	GF_Err e;
+	u8 *src=NULL;
+	u32 i, src_size=0;
+	char szArgs[200];
+	GF_Filter *f_src, *f_enc, *f_sink;
+	GF_FilterSession *fs;
+	FILE *cfg = gf_fopen(CENC_TEST_CFG, "wb");
+
+	memset(res, 0, sizeof(CENCTestResult));
+	if (!cfg) return GF_IO_ERR;
+	gf_fwrite(drm_cfg, (u32) strlen(drm_cfg), cfg);
+	gf_fclose(cfg);
+
+	fs = gf_fs_new(0, GF_FS_SCHEDULER_LOCK_FREE, 0, NULL);
+	if (!fs) return GF_OUT_OF_MEM;
+	cenc_test_nb_frames = cenc_test_nb_subs = 0;
+	cenc_test_iv_size = iv_size;
+	cenc_test_src = gf_bs_new(NULL, 0, GF_BITSTREAM_WRITE);
+	cenc_test_dst = gf_bs_new(NULL, 0, GF_BITSTREAM_WRITE);
+	cenc_test_sai = gf_bs_new(NULL, 0, GF_BITSTREAM_WRITE);
+	gf_fs_add_filter_register(fs, &CENCSrcRegister);
+	gf_fs_add_filter_register(fs, &CENCSinkRegister);
+	f_src = gf_fs_load_filter(fs, "UTCENCSrc", &e);
+	sprintf(szArgs, "cecrypt:cfile=%s:nbth=%d", CENC_TEST_CFG, nbth);
+	f_enc = gf_fs_load_filter(fs, szArgs, &e);
+	f_sink = gf_fs_load_filter(fs, "UTCENCSink", &e);
+	if (f_src && f_enc && f_sink) {
+		gf_filter_set_source(f_enc, f_src, NULL);
+		gf_filter_set_source(f_sink, f_enc, NULL);
+		e = gf_fs_run(fs);
+		if (e>GF_OK) e = GF_OK;
+		if (!e) e = gf_fs_get_last_connect_error(fs);
+		if (!e) e = gf_fs_get_last_process_error(fs);
+	} else if (!e) {
+		e = GF_FILTER_NOT_FOUND;
+	}
+	gf_fs_del(fs);
+
+	gf_bs_get_content(cenc_test_src, &src, &src_size);
+	gf_bs_get_content(cenc_test_dst, &res->data, &res->size);
+	gf_bs_get_content(cenc_test_sai, &res->sai, &res->sai_size);
+	gf_bs_del(cenc_test_src);
+	gf_bs_del(cenc_test_dst);
+	gf_bs_del(cenc_test_sai);
+	cenc_test_src = cenc_test_dst = cenc_test_sai = NULL;
+	res->nb_frames = cenc_test_nb_frames;
+	res->nb_subs = cenc_test_nb_subs;
+	//encryption is done in place, payloads only differ by their encrypted bytes
+	if (src && (src_size == res->size)) {
+		for (i=0; i<src_size; i++) {
+			if (src[i] != res->data[i]) res->nb_changed++;
+		}
+	}
+	if (src) gf_free(src);
+	gf_file_delete(CENC_TEST_CFG);
+	return e;
+}
+
+static void cenc_test_result_del(CENCTestResult *res)
+{
+	if (res->data) gf_free(res->data);
+	if (res->sai) gf_free(res->sai);
+}
+
+#define CENC_TEST_KEY	"<key KID=\"0x279926496a7f5d25da69f2b3b2799a7f\" value=\"0xccc0f2b3b279926496a7f5d25da692f6\"/>"
+
+static const struct {
+	const char *drm_cfg;
+	u32 iv_size;
+} cenc_test_cfgs[] =
+{
+	//CTR with 8-byte IVs, encrypted ranges not block-aligned so that the counter continues within a block across subsamples
+	{"<GPACDRM type=\"CENC AES-CTR\"><CrypTrack IV_size=\"8\" first_IV=\"0x0a610676cb88f302\" blockAlign=\"disable\">"CENC_TEST_KEY"</CrypTrack></GPACDRM>", 8},
+	//CTR with 16-byte IVs and default block alignment
+	{"<GPACDRM type=\"CENC AES-CTR\"><CrypTrack IV_size=\"16\" first_IV=\"0x0a610676cb88f302d10ac8bc66e039ed\">"CENC_TEST_KEY"</CrypTrack></GPACDRM>", 16},
+	//CTR pattern with 8-byte IVs
+	{"<GPACDRM type=\"CENC AES-CTR Pattern\"><CrypTrack IV_size=\"8\" first_IV=\"0x0a610676cb88f302\" crypt_byte_block=\"1\" skip_byte_block=\"9\">"CENC_TEST_KEY"</CrypTrack></GPACDRM>", 8},
+	//CBC pattern with 16-byte constant IV, trailing partial blocks left in the clear
+	{"<GPACDRM type=\"CENC AES-CBC Pattern\"><CrypTrack constant_IV=\"0x0a610676cb88f302d10ac8bc66e039ed\" crypt_byte_block=\"1\" skip_byte_block=\"9\">"CENC_TEST_KEY"</CrypTrack></GPACDRM>", 0},
+	//CBC pattern with 8-byte constant IV
+	{"<GPACDRM type=\"CENC AES-CBC Pattern\"><CrypTrack constant_IV=\"0x0a610676cb88f302\" crypt_byte_block=\"2\" skip_byte_block=\"8\">"CENC_TEST_KEY"</CrypTrack></GPACDRM>", 0},
+};
+
+//parallel encryption must produce the same samples and sample auxiliary info as sequential encryption
+unittest(cecrypt_parallel_same_output)
+{
+	u32 i;
+	for (i=0; i<GF_ARRAY_LENGTH(cenc_test_cfgs); i++) {
+		CENCTestResult seq, par;
+		assert_equal(cenc_test_run(cenc_test_cfgs[i].drm_cfg, cenc_test_cfgs[i].iv_size, 0, &seq), GF_OK);
+		assert_equal(cenc_test_run(cenc_test_cfgs[i].drm_cfg, cenc_test_cfgs[i].iv_size, 4, &par), GF_OK);
+
+		assert_equal(seq.nb_frames, CENC_TEST_FRAMES);
+		assert_equal(par.nb_frames, CENC_TEST_FRAMES);
+		assert_true(seq.nb_changed > 0);
+		assert_equal(seq.nb_changed, par.nb_changed);
+		//samples have several subsamples on average
+		assert_true(seq.nb_subs > CENC_TEST_FRAMES);
+
+		assert_equal(seq.size, par.size);
+		assert_true(seq.data && par.data && !memcmp(seq.data, par.data, seq.size));
+		assert_equal(seq.sai_size, par.sai_size);
+		assert_true(seq.sai && par.sai && !memcmp(seq.sai, par.sai, seq.sai_size));
+
+		cenc_test_result_del(&seq);
+		cenc_test_result_del(&par);
+	}
+}
@@ -0,0 +1,266 @@
+#include "tests.h"
+#include "../evg_rescale.c"
+
+#define EVGS_TEST_W	320
+#define EVGS_TEST_H	180
+
+static u32 evgs_test_rand(u32 *seed)
+{
+	*seed = (*seed) * 1103515245 + 12345;
+	return (*seed >> 8) & 0xFFFFFF;
+}
+
+static EVGScaleCtx *evgs_test_ctx_color(u32 ifmt, u32 iw, u32 ih, u32 ofmt, u32 ow, u32 oh, Bool hq, s32 nbth, u32 *isize, u32 *osize, Bool fullrange, Bool ofr, u32 cmx)
+{
+	EVGScaleCtx *ctx;
+	GF_SAFEALLOC(ctx, EVGScaleCtx);
+	if (!ctx) return NULL;
+	ctx->mode = EVGS_MODE_SEP;
+	ctx->fullrange = fullrange;
+	ctx->ofr = ofr;
+	ctx->cmx = cmx;
+	ctx->hq = hq;
+	ctx->nbth = (u32) nbth;
+	ctx->i_pfmt = ifmt;
+	ctx->i_w = iw;
+	ctx->i_h = ih;
+	ctx->ofmt = ofmt;
+	ctx->o_w = ow;
+	ctx->o_h = oh;
+	gf_pixel_get_size_info(ifmt, iw, ih, isize, &ctx->i_stride, &ctx->i_stride_uv, NULL, NULL);
+	gf_pixel_get_size_info(ofmt, ow, oh, osize, &ctx->o_stride, NULL, NULL, NULL);
+	if (!evgs_sep_setup(ctx)) {
+		gf_free(ctx);
+		return NULL;
+	}
+	return ctx;
+}
+
+static EVGScaleCtx *evgs_test_ctx(u32 ifmt, u32 iw, u32 ih, u32 ofmt, u32 ow, u32 oh, Bool hq, s32 nbth, u32 *isize, u32 *osize)
+{
+	return evgs_test_ctx_color(ifmt, iw, ih, ofmt, ow, oh, hq, nbth, isize, osize, GF_FALSE, GF_FALSE, GF_COLOR_MX_UNSPECIFIED);
+}
+
+static void evgs_test_del(EVGScaleCtx *ctx)
+{
+	u32 i;
+	evgs_sep_del_workers(ctx);
+	for (i=0; i<4; i++) {
+		evgs_filter_reset(&ctx->sep_comps[i].fh);
+		evgs_filter_reset(&ctx->sep_comps[i].fv);
+	}
+	gf_free(ctx);
+}
+
+static u8 *evgs_test_frame(u32 size, u32 seed)
+{
+	u32 i;
+	u8 *data = gf_malloc(size);
+	for (i=0; i<size; i++) data[i] = (u8) evgs_test_rand(&seed);
+	return data;
+}
+
+//same size conversions between 8-bit YUV layouts only move samples around
+unittest(evgs_sep_lossless)
+{
+	u32 isize, osize, msize, x, y, nb_fail=0;
+	u8 *src, *nv12, *back, *p10;
+	EVGScaleCtx *to_nv12 = evgs_test_ctx(GF_PIXEL_YUV, EVGS_TEST_W, EVGS_TEST_H, GF_PIXEL_NV12, EVGS_TEST_W, EVGS_TEST_H, GF_FALSE, 0, &isize, &osize);
+	EVGScaleCtx *to_yuv = evgs_test_ctx(GF_PIXEL_NV12, EVGS_TEST_W, EVGS_TEST_H, GF_PIXEL_YUV, EVGS_TEST_W, EVGS_TEST_H, GF_TRUE, 0, &msize, &msize);
+	EVGScaleCtx *to_10 = evgs_test_ctx(GF_PIXEL_YUV, EVGS_TEST_W, EVGS_TEST_H, GF_PIXEL_YUV_10, EVGS_TEST_W, EVGS_TEST_H, GF_FALSE, 0, &isize, &msize);
+	assert_true(to_nv12 && to_yuv && to_10);
+	if (!to_nv12 || !to_yuv || !to_10) return;
+
+	src = evgs_test_frame(isize, 1);
+	nv12 = gf_malloc(osize);
+	back = gf_malloc(isize);
+	p10 = gf_malloc(msize);
+	assert_equal(evgs_sep_process(to_nv12, src, NULL, nv12), GF_OK);
+	assert_equal(evgs_sep_process(to_yuv, nv12, NULL, back), GF_OK);
+	assert_equal(memcmp(src, back, isize), 0);
+
+	assert_equal(evgs_sep_process(to_10, src, NULL, p10), GF_OK);
+	for (y=0; y<EVGS_TEST_H; y++) {
+		for (x=0; x<EVGS_TEST_W; x++) {
+			u16 v = ((u16 *) p10)[y*EVGS_TEST_W + x];
+			if (v != src[y*EVGS_TEST_W + x]<<2) nb_fail++;
+		}
+	}
+	assert_equal(nb_fail, 0);
+
+	gf_free(src);
+	gf_free(nv12);
+	gf_free(back);
+	gf_free(p10);
+	evgs_test_del(to_nv12);
+	evgs_test_del(to_yuv);
+	evgs_test_del(to_10);
+}
+
+//filter weights must sum to one: a flat frame stays flat whatever the scaling factor
+unittest(evgs_sep_flat)
+{
+	u32 i, j, nb_fail=0;
+	u32 sizes[] = {17, 9, 160, 90, 640, 360, 1000, 7};
+	for (i=0; i<4; i++) {
+		u32 isize, osize;
+		u8 *src, *dst;
+		EVGScaleCtx *ctx = evgs_test_ctx(GF_PIXEL_RGBA, EVGS_TEST_W, EVGS_TEST_H, GF_PIXEL_RGB, sizes[2*i], sizes[2*i+1], i%2, 0, &isize, &osize);
+		assert_true(ctx!=NULL);
+		if (!ctx) continue;
+		src = gf_malloc(isize);
+		dst = gf_malloc(osize);
+		for (j=0; j<isize; j+=4) {
+			src[j] = 10;
+			src[j+1] = 128;
+			src[j+2] = 245;
+			src[j+3] = 0xFF;
+		}
+		evgs_sep_process(ctx, src, NULL, dst);
+		for (j=0; j<osize; j+=3) {
+			if ((dst[j]!=10) || (dst[j+1]!=128) || (dst[j+2]!=245)) nb_fail++;
+		}
+		gf_free(src);
+		gf_free(dst);
+		evgs_test_del(ctx);
+	}
+	assert_equal(nb_fail, 0);
+}
+
+unittest(evgs_sep_threads)
+{
+	u32 i, isize, osize;
+	u8 *src, *dst1, *dst2;
+	EVGScaleCtx *ctx1 = evgs_test_ctx(GF_PIXEL_YUV_10, 1280, 720, GF_PIXEL_BGRA, 1000, 562, GF_TRUE, 0, &isize, &osize);
+	EVGScaleCtx *ctx2 = evgs_test_ctx(GF_PIXEL_YUV_10, 1280, 720, GF_PIXEL_BGRA, 1000, 562, GF_TRUE, 3, &isize, &osize);
+	assert_true(ctx1 && ctx2);
+	if (!ctx1 || !ctx2) return;
+
+	src = evgs_test_frame(isize, 2);
+	//keep 10-bit samples in range
+	for (i=1; i<isize; i+=2) src[i] &= 0x3;
+	dst1 = gf_malloc(osize);
+	dst2 = gf_malloc(osize);
+	evgs_sep_process(ctx1, src, NULL, dst1);
+	evgs_sep_process(ctx2, src, NULL, dst2);
+	assert_equal(memcmp(dst1, dst2, osize), 0);
+
+	gf_free(src);
+	gf_free(dst1);
+	gf_free(dst2);
+	evgs_test_del(ctx1);
+	evgs_test_del(ctx2);
+}
+
+//convert a flat YUV 4:4:4 frame to RGB
+static Bool evgs_test_to_rgb(Bool fullrange, u32 cmx, u8 y, u8 u, u8 v, u8 *rgb)
+{
+	u32 isize, osize;
+	u8 *src, *dst;
+	EVGScaleCtx *ctx = evgs_test_ctx_color(GF_PIXEL_YUV444, 16, 16, GF_PIXEL_RGB, 16, 16, GF_FALSE, 0, &isize, &osize, fullrange, GF_FALSE, cmx);
+	if (!ctx) return GF_FALSE;
+	src = gf_malloc(isize);
+	dst = gf_malloc(osize);
+	memset(src, y, 256);
+	memset(src+256, u, 256);
+	memset(src+512, v, 256);
+	evgs_sep_process(ctx, src, NULL, dst);
+	memcpy(rgb, dst + 3*(8*16+8), 3);
+	gf_free(src);
+	gf_free(dst);
+	evgs_test_del(ctx);
+	return GF_TRUE;
+}
+
+//convert a flat RGB frame to YUV 4:4:4
+static Bool evgs_test_to_yuv(Bool ofr, u32 cmx, u8 r, u8 g, u8 b, u8 *yuv)
+{
+	u32 i, isize, osize;
+	u8 *src, *dst;
+	EVGScaleCtx *ctx = evgs_test_ctx_color(GF_PIXEL_RGB, 16, 16, GF_PIXEL_YUV444, 16, 16, GF_FALSE, 0, &isize, &osize, GF_FALSE, ofr, cmx);
+	if (!ctx) return GF_FALSE;
+	src = gf_malloc(isize);
+	dst = gf_malloc(osize);
+	for (i=0; i<isize; i+=3) {
+		src[i] = r;
+		src[i+1] = g;
+		src[i+2] = b;
+	}
+	evgs_sep_process(ctx, src, NULL, dst);
+	yuv[0] = dst[8*16+8];
+	yuv[1] = dst[256 + 8*16+8];
+	yuv[2] = dst[512 + 8*16+8];
+	gf_free(src);
+	gf_free(dst);
+	evgs_test_del(ctx);
+	return GF_TRUE;
+}
+
+//range and matrix of the input are used for YUV to RGB, ofr selects the range of YUV output
+unittest(evgs_sep_color)
+{
+	u8 c[3];
+
+	//limited range black and white
+	assert_true(evgs_test_to_rgb(GF_FALSE, GF_COLOR_MX_UNSPECIFIED, 16, 128, 128, c));
+	assert_true(!c[0] && !c[1] && !c[2]);
+	assert_true(evgs_test_to_rgb(GF_FALSE, GF_COLOR_MX_BT709, 235, 128, 128, c));
+	assert_true((c[0]==255) && (c[1]==255) && (c[2]==255));
+	//full range
+	assert_true(evgs_test_to_rgb(GF_TRUE, GF_COLOR_MX_UNSPECIFIED, 235, 128, 128, c));
+	assert_true((c[0]==235) && (c[1]==235) && (c[2]==235));
+	//R = Y + 2*(1-Kr)*Cr
+	assert_true(evgs_test_to_rgb(GF_TRUE, GF_COLOR_MX_SMPTE170M, 128, 128, 178, c));
+	assert_equal(c[0], 198);
+	assert_true(evgs_test_to_rgb(GF_TRUE, GF_COLOR_MX_BT709, 128, 128, 178, c));
+	assert_equal(c[0], 207);
+
+	assert_true(evgs_test_to_yuv(GF_FALSE, GF_COLOR_MX_UNSPECIFIED, 255, 255, 255, c));
+	assert_true((c[0]==235) && (c[1]==128) && (c[2]==128));
+	assert_true(evgs_test_to_yuv(GF_FALSE, GF_COLOR_MX_UNSPECIFIED, 0, 0, 0, c));
+	assert_true((c[0]==16) && (c[1]==128) && (c[2]==128));
+	assert_true(evgs_test_to_yuv(GF_TRUE, GF_COLOR_MX_UNSPECIFIED, 255, 255, 255, c));
+	assert_true((c[0]==255) && (c[1]==128) && (c[2]==128));
+	//pure blue: Cb = 128 + 0.5*255 in full range
+	assert_true(evgs_test_to_yuv(GF_TRUE, GF_COLOR_MX_BT709, 0, 0, 255, c));
+	assert_equal(c[0], 18);
+	assert_equal(c[1], 255);
+
+	//no separable conversion for unsupported matrices
+	assert_true(!evgs_test_to_rgb(GF_TRUE, GF_COLOR_MX_YCGCO, 128, 128, 128, c));
+}
+
+//not a pass/fail test: single-threaded 1080p to 720p conversions
+unittest(evgs_sep_bench)
+{
+	u32 i, j;
+	struct {
+		u32 ifmt, ofmt;
+		const char *name;
+	} convs[] = {
+		{GF_PIXEL_YUV, GF_PIXEL_YUV, "yuv->yuv"},
+		{GF_PIXEL_NV12, GF_PIXEL_RGBA, "nv12->rgba"},
+		{GF_PIXEL_RGBA, GF_PIXEL_YUV, "rgba->yuv"},
+		{GF_PIXEL_NV12_10, GF_PIXEL_YUV, "p010->yuv"},
+	};
+
+	if (!ut_bench_enabled()) return;
+
+	for (i=0; i<GF_ARRAY_LENGTH(convs); i++) {
+		u64 now;
+		u32 isize, osize;
+		u8 *src, *dst;
+		EVGScaleCtx *ctx = evgs_test_ctx(convs[i].ifmt, 1920, 1080, convs[i].ofmt, 1280, 720, GF_FALSE, 0, &isize, &osize);
+		assert_true(ctx!=NULL);
+		if (!ctx) continue;
+		src = evgs_test_frame(isize, 3);
+		dst = gf_malloc(osize);
+		now = gf_sys_clock_high_res();
+		for (j=0; j<10; j++)
+			evgs_sep_process(ctx, src, NULL, dst);
+		printf("%s %u us ", convs[i].name, (u32) (gf_sys_clock_high_res() - now) / 10);
+		gf_free(src);
+		gf_free(dst);
+		evgs_test_del(ctx);
+	}
+}
@@ -0,0 +1,158 @@
+#include "tests.h"
+#include <gpac/isomedia.h>
+#include <gpac/filters.h>
+
+#define MMAP_TEST_FILE	"ut_isoffin_mmap.mp4"
+#define MMAP_TEST_SAMPLES	20
+#define MMAP_TEST_SIZE	1000
+
+typedef struct
+{
+	GF_FilterPid *ipid;
+	GF_List *pcks;
+} MMapTestSink;
+//filter private data is freed with the session
+static u32 mmap_nb_contiguous, mmap_nb_valid, mmap_nb_udta;
+
+static void mmap_test_fill(u8 *data, u32 size, u32 idx)
+{
+	u32 i;
+	for (i=0; i<size; i++) data[i] = (u8) (idx*7 + i);
+}
+
+static Bool mmap_test_check(const u8 *data, u32 size, u32 idx)
+{
+	u32 i;
+	if (size != MMAP_TEST_SIZE) return GF_FALSE;
+	for (i=0; i<size; i++) {
+		if (data[i] != (u8) (idx*7 + i)) return GF_FALSE;
+	}
+	return GF_TRUE;
+}
+
+static Bool mmap_test_create(void)
+{
+	u32 i, track, di;
+	u8 data[MMAP_TEST_SIZE];
+	GF_GenericSampleDescription udesc;
+	GF_ISOSample samp;
+	GF_ISOFile *mov = gf_isom_open(MMAP_TEST_FILE, GF_ISOM_OPEN_WRITE, NULL);
+	if (!mov) return GF_FALSE;
+	track = gf_isom_new_track(mov, 1, GF_ISOM_MEDIA_VISUAL, 1000);
+	gf_isom_set_track_enabled(mov, track, GF_TRUE);
+	memset(&udesc, 0, sizeof(GF_GenericSampleDescription));
+	udesc.codec_tag = GF_4CC('u','t','m','m');
+	udesc.width = 320;
+	udesc.height = 240;
+	gf_isom_new_generic_sample_description(mov, track, NULL, NULL, &udesc, &di);
+	memset(&samp, 0, sizeof(GF_ISOSample));
+	samp.data = data;
+	samp.dataLength = MMAP_TEST_SIZE;
+	samp.IsRAP = SAP_TYPE_1;
+	for (i=0; i<MMAP_TEST_SAMPLES; i++) {
+		mmap_test_fill(data, MMAP_TEST_SIZE, i);
+		samp.DTS = i*40;
+		gf_isom_add_sample(mov, track, di, &samp);
+	}
+	return (gf_isom_close(mov)==GF_OK) ? GF_TRUE : GF_FALSE;
+}
+
+static GF_Err mmap_sink_configure_pid(GF_Filter *filter, GF_FilterPid *pid, Bool is_remove)
+{
+	GF_FilterEvent evt;
+	MMapTestSink *ctx = gf_filter_get_udta(filter);
+	if (is_remove) return GF_OK;
+	ctx->ipid = pid;
+	if (!ctx->pcks) ctx->pcks = gf_list_new();
+	gf_filter_pid_set_framing_mode(pid, GF_TRUE);
+	gf_filter_pid_init_play_event(pid, &evt, 0, 1.0, "UTMMapSink");
+	gf_filter_pid_send_event(pid, &evt);
+	return GF_OK;
+}
+
+//keep a reference to all packets, as a muxer or cache would do
+static GF_Err mmap_sink_process(GF_Filter *filter)
+{
+	MMapTestSink *ctx = gf_filter_get_udta(filter);
+	GF_FilterPacket *pck;
+	if (!ctx->ipid) return GF_OK;
+	while ((pck = gf_filter_pid_get_packet(ctx->ipid))) {
+		//the file mapping is carried by the packet destructor, not by a packet property
+		if (gf_filter_pck_get_property(pck, GF_PROP_PCK_UDTA))
+			mmap_nb_udta++;
+		gf_filter_pck_ref(&pck);
+		gf_list_add(ctx->pcks, pck);
+		gf_filter_pid_drop_packet(ctx->ipid);
+	}
+	if (gf_filter_pid_is_eos(ctx->ipid)) return GF_EOS;
+	return GF_OK;
+}
+
+//called after the demuxer is finalized, packet data must still be valid
+static void mmap_sink_finalize(GF_Filter *filter)
+{
+	u32 i;
+	const u8 *prev = NULL;
+	MMapTestSink *ctx = gf_filter_get_udta(filter);
+	if (!ctx->pcks) return;
+	for (i=0; i<gf_list_count(ctx->pcks); i++) {
+		u32 size;
+		GF_FilterPacket *pck = gf_list_get(ctx->pcks, i);
+		const u8 *data = gf_filter_pck_get_data(pck, &size);
+		if (mmap_test_check(data, size, i)) mmap_nb_valid++;
+		//samples are stored back to back in the file: mapped packets point to consecutive memory
+		if (prev && (data == prev + MMAP_TEST_SIZE)) mmap_nb_contiguous++;
+		prev = data;
+		gf_filter_pck_unref(pck);
+	}
+	gf_list_del(ctx->pcks);
+	ctx->pcks = NULL;
+}
+
+static const GF_FilterCapability MMapSinkCaps[] =
+{
+	CAP_UINT(GF_CAPS_INPUT, GF_PROP_PID_STREAM_TYPE, GF_STREAM_VISUAL),
+};
+
+static GF_FilterRegister MMapSinkRegister = {
+	.name = "UTMMapSink",
+	GF_FS_SET_DESCRIPTION("Zero-copy packet lifetime test sink")
+	.private_size = sizeof(MMapTestSink),
+	.flags = GF_FS_REG_EXPLICIT_ONLY,
+	SETCAPS(MMapSinkCaps),
+	.configure_pid = mmap_sink_configure_pid,
+	.process = mmap_sink_process,
+	.finalize = mmap_sink_finalize,
+};
+
+//mapped packets held past the demuxer finalize must keep the mapping alive
+unittest(isoffin_mmap_pck_lifetime)
+{
+	GF_Err e;
+	GF_FilterSession *fs;
+	GF_Filter *src, *dmx, *sink;
+
+	assert_true(mmap_test_create());
+	mmap_nb_contiguous = mmap_nb_valid = mmap_nb_udta = 0;
+
+	fs = gf_fs_new(0, GF_FS_SCHEDULER_LOCK_FREE, 0, NULL);
+	assert_not_null(fs);
+	if (!fs) return;
+	gf_fs_add_filter_register(fs, &MMapSinkRegister);
+	//filters are finalized in load order: demuxer before sink
+	src = gf_fs_load_filter(fs, "fin:src="MMAP_TEST_FILE, &e);
+	dmx = gf_fs_load_filter(fs, "mp4dmx:mmap", &e);
+	sink = gf_fs_load_filter(fs, "UTMMapSink", &e);
+	assert_true(src && dmx && sink);
+	if (src && dmx && sink) {
+		gf_filter_set_source(dmx, src, NULL);
+		gf_filter_set_source(sink, dmx, NULL);
+		gf_fs_run(fs);
+	}
+	gf_fs_del(fs);
+	gf_file_delete(MMAP_TEST_FILE);
+
+	assert_equal(mmap_nb_contiguous, MMAP_TEST_SAMPLES-1);
+	assert_equal(mmap_nb_udta, 0);
+	assert_equal(mmap_nb_valid, MMAP_TEST_SAMPLES);
+}
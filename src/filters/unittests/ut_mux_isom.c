@@ -0,0 +1,138 @@
+#include "tests.h"
+#include <gpac/filters.h>
+
+#define FPIPE_TEST_FRAMES	100
+#define FPIPE_TEST_W	16
+#define FPIPE_TEST_H	16
+
+typedef struct
+{
+	GF_FilterPid *opid;
+	u32 nb_frames;
+} FPipeTestSource;
+
+static GF_Err fpipe_src_initialize(GF_Filter *filter)
+{
+	FPipeTestSource *ctx = gf_filter_get_udta(filter);
+	ctx->opid = gf_filter_pid_new(filter);
+	if (!ctx->opid) return GF_OUT_OF_MEM;
+	gf_filter_pid_set_property(ctx->opid, GF_PROP_PID_STREAM_TYPE, &PROP_UINT(GF_STREAM_VISUAL));
+	gf_filter_pid_set_property(ctx->opid, GF_PROP_PID_CODECID, &PROP_UINT(GF_CODECID_RAW));
+	gf_filter_pid_set_property(ctx->opid, GF_PROP_PID_PIXFMT, &PROP_UINT(GF_PIXEL_GREYSCALE));
+	gf_filter_pid_set_property(ctx->opid, GF_PROP_PID_WIDTH, &PROP_UINT(FPIPE_TEST_W));
+	gf_filter_pid_set_property(ctx->opid, GF_PROP_PID_HEIGHT, &PROP_UINT(FPIPE_TEST_H));
+	gf_filter_pid_set_property(ctx->opid, GF_PROP_PID_STRIDE, &PROP_UINT(FPIPE_TEST_W));
+	gf_filter_pid_set_property(ctx->opid, GF_PROP_PID_TIMESCALE, &PROP_UINT(25));
+	gf_filter_pid_set_property(ctx->opid, GF_PROP_PID_FPS, &PROP_FRAC_INT(25, 1));
+	gf_filter_pid_set_property(ctx->opid, GF_PROP_PID_ID, &PROP_UINT(1));
+	return GF_OK;
+}
+
+static GF_Err fpipe_src_process(GF_Filter *filter)
+{
+	u8 *data;
+	GF_FilterPacket *pck;
+	FPipeTestSource *ctx = gf_filter_get_udta(filter);
+	if (ctx->nb_frames == FPIPE_TEST_FRAMES) {
+		gf_filter_pid_set_eos(ctx->opid);
+		return GF_EOS;
+	}
+	pck = gf_filter_pck_new_alloc(ctx->opid, FPIPE_TEST_W*FPIPE_TEST_H, &data);
+	if (!pck) return GF_OUT_OF_MEM;
+	memset(data, ctx->nb_frames, FPIPE_TEST_W*FPIPE_TEST_H);
+	gf_filter_pck_set_cts(pck, ctx->nb_frames);
+	gf_filter_pck_set_dts(pck, ctx->nb_frames);
+	gf_filter_pck_set_duration(pck, 1);
+	gf_filter_pck_set_sap(pck, GF_FILTER_SAP_1);
+	gf_filter_pck_send(pck);
+	ctx->nb_frames++;
+	return GF_OK;
+}
+
+static const GF_FilterCapability FPipeSrcCaps[] =
+{
+	CAP_UINT(GF_CAPS_OUTPUT, GF_PROP_PID_STREAM_TYPE, GF_STREAM_VISUAL),
+	CAP_UINT(GF_CAPS_OUTPUT, GF_PROP_PID_CODECID, GF_CODECID_RAW),
+};
+
+static GF_FilterRegister FPipeSrcRegister = {
+	.name = "UTFPipeSrc",
+	GF_FS_SET_DESCRIPTION("Raw video source for fragment pipelining test")
+	.private_size = sizeof(FPipeTestSource),
+	.flags = GF_FS_REG_EXPLICIT_ONLY,
+	SETCAPS(FPipeSrcCaps),
+	.initialize = fpipe_src_initialize,
+	.process = fpipe_src_process,
+};
+
+//segments the source as low-latency HLS parts in byte ranges with segment sync
+static GF_Err fpipe_test_run(const char *dir, Bool fpipe)
+{
+	GF_Err e;
+	char szDst[GF_MAX_PATH];
+	GF_Filter *src, *dst;
+	GF_FilterSession *fs = gf_fs_new(0, GF_FS_SCHEDULER_LOCK_FREE, 0, NULL);
+	if (!fs) return GF_OUT_OF_MEM;
+	gf_fs_add_filter_register(fs, &FPipeSrcRegister);
+	src = gf_fs_load_filter(fs, "UTFPipeSrc", &e);
+	sprintf(szDst, "%s/live.m3u8:segdur=0.8:cdur=0.2:llhls=br:seg_sync=yes:fpipe=%s", dir, fpipe ? "true" : "false");
+	dst = gf_fs_load_destination(fs, szDst, NULL, NULL, &e);
+	if (src && dst) {
+		gf_filter_set_source(dst, src, NULL);
+		e = gf_fs_run(fs);
+		if (e>GF_OK) e = GF_OK;
+		if (!e) e = gf_fs_get_last_connect_error(fs);
+		if (!e) e = gf_fs_get_last_process_error(fs);
+	} else if (!e) {
+		e = GF_FILTER_NOT_FOUND;
+	}
+	gf_fs_del(fs);
+	return e;
+}
+
+typedef struct
+{
+	const char *ref_dir;
+	u32 nb_files, nb_diff;
+} FPipeCompare;
+
+static Bool fpipe_test_compare(void *cbck, char *item_name, char *item_path, GF_FileEnumInfo *file_info)
+{
+	char szRef[GF_MAX_PATH];
+	u8 *data=NULL, *ref=NULL;
+	u32 size=0, ref_size=0;
+	FPipeCompare *cmp = (FPipeCompare *)cbck;
+	snprintf(szRef, GF_MAX_PATH, "%s/%s", cmp->ref_dir, item_name);
+	gf_file_load_data(item_path, &data, &size);
+	gf_file_load_data(szRef, &ref, &ref_size);
+	if (!data || !ref || (size != ref_size))
+		cmp->nb_diff++;
+	//init segments hold the track creation time, which is the wall clock of each run
+	else if (!strstr(item_name, "init.mp4") && memcmp(data, ref, size))
+		cmp->nb_diff++;
+	cmp->nb_files++;
+	if (data) gf_free(data);
+	if (ref) gf_free(ref);
+	return GF_FALSE;
+}
+
+//pipelined fragment writing must produce the same segments, parts and playlists as sequential writing
+unittest(mp4mx_fpipe_segments)
+{
+	FPipeCompare cmp;
+
+	assert_equal(fpipe_test_run("ut_fpipe_off", GF_FALSE), GF_OK);
+	assert_equal(fpipe_test_run("ut_fpipe_on", GF_TRUE), GF_OK);
+
+	memset(&cmp, 0, sizeof(FPipeCompare));
+	cmp.ref_dir = "ut_fpipe_off";
+	gf_enum_directory("ut_fpipe_on", GF_FALSE, fpipe_test_compare, &cmp, NULL);
+	//init segment, playlists and 5 segments
+	assert_true(cmp.nb_files >= 7);
+	assert_equal(cmp.nb_diff, 0);
+
+	gf_dir_cleanup("ut_fpipe_off");
+	gf_rmdir("ut_fpipe_off");
+	gf_dir_cleanup("ut_fpipe_on");
+	gf_rmdir("ut_fpipe_on");
+}
@@ -0,0 +1,473 @@
+#include "tests.h"
+#include <gpac/filters.h>
+#include <gpac/network.h>
+#ifndef WIN32
+#include <sys/resource.h>
+#endif
+
+#define HTTPOUT_TEST_DIR	"ut_httpout"
+#define HTTPOUT_TEST_SIZE	100000
+#define HTTPOUT_TEST_PORT	25500
+
+typedef struct
+{
+	GF_FilterSession *fs;
+	u16 port;
+	//last response body
+	u8 *body;
+	u32 body_size;
+} HTTPOutTest;
+
+static void httpout_test_fill(u8 *data, u32 size, u32 seed)
+{
+	u32 i;
+	for (i=0; i<size; i++) data[i] = (u8) (seed + i*7 + (i>>8));
+}
+
+static Bool httpout_test_write(const char *path, u32 size, u32 seed)
+{
+	u32 done;
+	FILE *f;
+	u8 *data = gf_malloc(size);
+	if (!data) return GF_FALSE;
+	httpout_test_fill(data, size, seed);
+	f = gf_fopen(path, "wb");
+	done = f ? (u32) gf_fwrite(data, size, f) : 0;
+	if (f) gf_fclose(f);
+	gf_free(data);
+	return (done==size) ? GF_TRUE : GF_FALSE;
+}
+
+static Bool httpout_test_check_data(const u8 *body, u32 body_size, u32 offset, u32 size, u32 seed)
+{
+	Bool ok;
+	u8 *data;
+	if (body_size != size) return GF_FALSE;
+	data = gf_malloc(offset+size);
+	if (!data) return GF_FALSE;
+	httpout_test_fill(data, offset+size, seed);
+	ok = memcmp(body, data+offset, size) ? GF_FALSE : GF_TRUE;
+	gf_free(data);
+	return ok;
+}
+
+static Bool httpout_test_check(HTTPOutTest *t, u32 offset, u32 size, u32 seed)
+{
+	return httpout_test_check_data(t->body, t->body_size, offset, size, seed);
+}
+
+//loads the server on the first free port, either serving the test directory (src NULL) or storing src in memory
+//the session runs in non-blocking mode and is pumped while waiting for responses
+static Bool httpout_test_start(HTTPOutTest *t, const char *args, const char *src)
+{
+	char szArgs[GF_MAX_PATH];
+	GF_Err e;
+	memset(t, 0, sizeof(HTTPOutTest));
+	for (t->port=HTTPOUT_TEST_PORT; t->port<HTTPOUT_TEST_PORT+100; t->port++) {
+		GF_Filter *f;
+		t->fs = gf_fs_new(0, GF_FS_SCHEDULER_LOCK_FREE, GF_FS_FLAG_NON_BLOCKING, NULL);
+		if (!t->fs) return GF_FALSE;
+		if (src) {
+			GF_Filter *in;
+			snprintf(szArgs, GF_MAX_PATH, "fin:src=%s", src);
+			in = gf_fs_load_filter(t->fs, szArgs, &e);
+			snprintf(szArgs, GF_MAX_PATH, "http://127.0.0.1:%u/%s:%s", t->port, gf_file_basename(src), args);
+			f = in ? gf_fs_load_destination(t->fs, szArgs, NULL, NULL, &e) : NULL;
+			if (f) gf_filter_set_source(f, in, NULL);
+		} else {
+			snprintf(szArgs, GF_MAX_PATH, "httpout:port=%u:ifce=127.0.0.1:%s", t->port, args);
+			f = gf_fs_load_filter(t->fs, szArgs, &e);
+		}
+		if (f) return GF_TRUE;
+		gf_fs_del(t->fs);
+		t->fs = NULL;
+	}
+	return GF_FALSE;
+}
+
+static void httpout_test_stop(HTTPOutTest *t)
+{
+	if (t->fs) gf_fs_del(t->fs);
+	if (t->body) gf_free(t->body);
+	memset(t, 0, sizeof(HTTPOutTest));
+}
+
+static GF_Socket *httpout_test_connect(HTTPOutTest *t)
+{
+	GF_Socket *sk = gf_sk_new(GF_SOCK_TYPE_TCP);
+	if (!sk) return NULL;
+	//the listen backlog accepts the connection before the server processes it
+	if (gf_sk_connect(sk, "127.0.0.1", t->port, NULL)) {
+		gf_sk_del(sk);
+		return NULL;
+	}
+	return sk;
+}
+
+static void httpout_test_send(GF_Socket *sk, const char *path, const char *range)
+{
+	char szReq[500];
+	snprintf(szReq, 500, "GET %s HTTP/1.1\r\nHost: 127.0.0.1\r\n%s%s%s\r\n", path, range ? "Range: " : "", range ? range : "", range ? "\r\n" : "");
+	gf_sk_send(sk, szReq, (u32) strlen(szReq));
+	gf_sk_set_block_mode(sk, GF_TRUE);
+}
+
+static GF_Socket *httpout_test_request(HTTPOutTest *t, const char *path, const char *range)
+{
+	GF_Socket *sk = httpout_test_connect(t);
+	if (sk) httpout_test_send(sk, path, range);
+	return sk;
+}
+
+//parses the response header if complete, returns the header size or 0
+static u32 httpout_test_parse_header(u8 *data, u32 size, u32 *status, u32 *body_size)
+{
+	u32 hdr_size;
+	char *sep, *cl;
+	data[size] = 0;
+	sep = strstr((char *) data, "\r\n\r\n");
+	if (!sep) return 0;
+	hdr_size = (u32) (sep + 4 - (char *) data);
+	if (!strncmp((char *) data, "HTTP/1.1 ", 9)) *status = atoi((char *) data+9);
+	sep[0] = 0;
+	cl = strstr((char *) data, "Content-Length: ");
+	if (cl) *body_size = atoi(cl+16);
+	sep[0] = '\r';
+	return hdr_size;
+}
+
+//pumps the session until the response is complete, returns the status code and stores the body
+static u32 httpout_test_response(HTTPOutTest *t, GF_Socket *sk)
+{
+	u32 size=0, alloc=0, status=0, hdr_size=0, body_size=0;
+	u8 *data = NULL;
+	u32 start = gf_sys_clock();
+	if (t->body) gf_free(t->body);
+	t->body = NULL;
+	t->body_size = 0;
+	if (!sk) return 0;
+
+	while (gf_sys_clock() - start < 10000) {
+		u32 read = 0;
+		GF_Err e;
+		gf_fs_run(t->fs);
+		if (size+10000 > alloc) {
+			alloc = size + 100000;
+			data = gf_realloc(data, alloc+1);
+			if (!data) break;
+		}
+		e = gf_sk_receive_no_select(sk, data+size, 10000, &read);
+		size += read;
+		if (!hdr_size && size)
+			hdr_size = httpout_test_parse_header(data, size, &status, &body_size);
+		if (hdr_size && (size >= hdr_size + body_size)) break;
+		if (e==GF_IP_CONNECTION_CLOSED) break;
+	}
+	gf_sk_del(sk);
+	if (!data) return 0;
+	if (hdr_size && (size >= hdr_size + body_size)) {
+		t->body = data;
+		t->body_size = body_size;
+		memmove(t->body, data+hdr_size, body_size);
+	} else {
+		gf_free(data);
+		status = 0;
+	}
+	return status;
+}
+
+static u32 httpout_test_get(HTTPOutTest *t, const char *path, const char *range)
+{
+	return httpout_test_response(t, httpout_test_request(t, path, range));
+}
+
+static void httpout_test_ranges(HTTPOutTest *t, const char *path, u32 *nb_fail)
+{
+	if ((httpout_test_get(t, path, NULL) != 200) || !httpout_test_check(t, 0, HTTPOUT_TEST_SIZE, 1)) (*nb_fail)++;
+	if ((httpout_test_get(t, path, "bytes=1000-5999") != 206) || !httpout_test_check(t, 1000, 5000, 1)) (*nb_fail)++;
+	if ((httpout_test_get(t, path, "bytes=99000-") != 206) || !httpout_test_check(t, 99000, 1000, 1)) (*nb_fail)++;
+}
+
+//byte ranges must be served identically with and without zero-copy sends
+//memory resources have no file descriptor, zero-copy is not supported for them and regular sends must be used
+unittest(httpout_sendfile_range)
+{
+	u32 nb_fail;
+	HTTPOutTest t;
+
+	gf_mkdir(HTTPOUT_TEST_DIR);
+	assert_true(httpout_test_write(HTTPOUT_TEST_DIR"/file.bin", HTTPOUT_TEST_SIZE, 1));
+
+	nb_fail = 0;
+	assert_true(httpout_test_start(&t, "rdirs="HTTPOUT_TEST_DIR":sendfile=true", NULL));
+	if (t.fs) httpout_test_ranges(&t, "/file.bin", &nb_fail);
+	httpout_test_stop(&t);
+	assert_equal(nb_fail, 0);
+
+	nb_fail = 0;
+	assert_true(httpout_test_start(&t, "rdirs="HTTPOUT_TEST_DIR":sendfile=false", NULL));
+	if (t.fs) httpout_test_ranges(&t, "/file.bin", &nb_fail);
+	httpout_test_stop(&t);
+	assert_equal(nb_fail, 0);
+
+	nb_fail = 0;
+	assert_true(httpout_test_start(&t, "rdirs=gmem:sendfile=true", HTTPOUT_TEST_DIR"/file.bin"));
+	if (t.fs) {
+		//files being stored are sent in chunk transfer mode without length, wait for the input to be done
+		u32 start = gf_sys_clock();
+		while ((gf_sys_clock() - start < 10000) && (httpout_test_get(&t, "/file.bin", NULL) != 200 || (t.body_size != HTTPOUT_TEST_SIZE)))
+			gf_sleep(1);
+		httpout_test_ranges(&t, "/file.bin", &nb_fail);
+	}
+	httpout_test_stop(&t);
+	assert_equal(nb_fail, 0);
+
+	gf_dir_cleanup(HTTPOUT_TEST_DIR);
+	gf_rmdir(HTTPOUT_TEST_DIR);
+}
+
+#define HTTPOUT_CACHE_SIZE	4000000
+
+typedef struct
+{
+	u32 nb_files, hits, nb_req, evicts;
+} HTTPOutCacheStats;
+
+//cache counters as reported in the server status
+static Bool httpout_test_cache_stats(HTTPOutTest *t, HTTPOutCacheStats *cs)
+{
+	u32 i, count = gf_fs_get_filters_count(t->fs);
+	memset(cs, 0, sizeof(HTTPOutCacheStats));
+	for (i=0; i<count; i++) {
+		u32 kb, ratio;
+		GF_FilterStats stats;
+		if (gf_fs_get_filter_stats(t->fs, i, &stats)) continue;
+		if (!stats.reg_name || strcmp(stats.reg_name, "httpout") || !stats.status) continue;
+		if (sscanf(stats.status, "cache: %u files %u kB - hit ratio %u%% (%u/%u) - %u evictions", &cs->nb_files, &kb, &ratio, &cs->hits, &cs->nb_req, &cs->evicts) == 6)
+			return GF_TRUE;
+	}
+	return GF_FALSE;
+}
+
+static Bool httpout_test_cache_check(HTTPOutTest *t, u32 hits, u32 nb_req, u32 evicts)
+{
+	HTTPOutCacheStats cs;
+	if (!httpout_test_cache_stats(t, &cs)) return GF_FALSE;
+	return ((cs.hits==hits) && (cs.nb_req==nb_req) && (cs.evicts==evicts)) ? GF_TRUE : GF_FALSE;
+}
+
+//gets the file and checks its content was generated with the given seed
+static Bool httpout_test_cache_get(HTTPOutTest *t, char name, u32 size, u32 seed)
+{
+	char szPath[20];
+	sprintf(szPath, "/%c.bin", name);
+	if (httpout_test_get(t, szPath, NULL) != 200) return GF_FALSE;
+	return httpout_test_check(t, 0, size, seed);
+}
+
+//least recently used files are evicted first, unless in use by a pending response
+static void httpout_test_cache_run(HTTPOutTest *t)
+{
+	u32 i;
+	GF_Socket *stalled;
+
+	//fill the cache, then use a: LRU order is b c d a
+	assert_true(httpout_test_cache_get(t, 'a', HTTPOUT_CACHE_SIZE, 1));
+	assert_true(httpout_test_cache_get(t, 'b', HTTPOUT_CACHE_SIZE, 2));
+	assert_true(httpout_test_cache_get(t, 'c', HTTPOUT_CACHE_SIZE, 3));
+	assert_true(httpout_test_cache_get(t, 'd', HTTPOUT_CACHE_SIZE, 4));
+	assert_true(httpout_test_cache_check(t, 0, 4, 0));
+	assert_true(httpout_test_cache_get(t, 'a', HTTPOUT_CACHE_SIZE, 1));
+	assert_true(httpout_test_cache_check(t, 1, 5, 0));
+
+	//e evicts b, a is still cached: c d e a
+	assert_true(httpout_test_cache_get(t, 'e', HTTPOUT_CACHE_SIZE, 5));
+	assert_true(httpout_test_cache_check(t, 1, 6, 1));
+	assert_true(httpout_test_cache_get(t, 'a', HTTPOUT_CACHE_SIZE, 1));
+	assert_true(httpout_test_cache_check(t, 2, 7, 1));
+	//b is reloaded and evicts c, which is reloaded and evicts d: e a b c
+	assert_true(httpout_test_cache_get(t, 'b', HTTPOUT_CACHE_SIZE, 2));
+	assert_true(httpout_test_cache_check(t, 2, 8, 2));
+	assert_true(httpout_test_cache_get(t, 'c', HTTPOUT_CACHE_SIZE, 3));
+	assert_true(httpout_test_cache_check(t, 2, 9, 3));
+
+	//a client not reading its response keeps a in use: e b c a
+	stalled = httpout_test_request(t, "/a.bin", NULL);
+	assert_not_null(stalled);
+	if (!stalled) return;
+	for (i=0; i<5000; i++) {
+		gf_fs_run(t->fs);
+		if (httpout_test_cache_check(t, 3, 10, 3)) break;
+		gf_sleep(1);
+	}
+	assert_true(httpout_test_cache_check(t, 3, 10, 3));
+	//a becomes the least recently used: a e b c
+	assert_true(httpout_test_cache_get(t, 'e', HTTPOUT_CACHE_SIZE, 5));
+	assert_true(httpout_test_cache_get(t, 'b', HTTPOUT_CACHE_SIZE, 2));
+	assert_true(httpout_test_cache_get(t, 'c', HTTPOUT_CACHE_SIZE, 3));
+	assert_true(httpout_test_cache_check(t, 6, 13, 3));
+	//d skips a in use and evicts e: a b c d
+	assert_true(httpout_test_cache_get(t, 'd', HTTPOUT_CACHE_SIZE, 4));
+	assert_true(httpout_test_cache_check(t, 6, 14, 4));
+	assert_true(httpout_test_cache_get(t, 'a', HTTPOUT_CACHE_SIZE, 1));
+	assert_true(httpout_test_cache_check(t, 7, 15, 4));
+
+	//a is modified while in use: its entry is removed from the cache and the new content is loaded
+	assert_true(httpout_test_write(HTTPOUT_TEST_DIR"/a.bin", HTTPOUT_CACHE_SIZE-1000, 9));
+	assert_true(httpout_test_cache_get(t, 'a', HTTPOUT_CACHE_SIZE-1000, 9));
+	assert_true(httpout_test_cache_check(t, 7, 16, 4));
+	//the pending response still uses the removed entry
+	assert_equal(httpout_test_response(t, stalled), 200);
+	assert_true(httpout_test_check(t, 0, HTTPOUT_CACHE_SIZE, 1));
+}
+
+//the cache holds 4 files, an entry removed while in use must remain valid until its response is done
+unittest(httpout_cache_lru)
+{
+	u32 i;
+	char szPath[GF_MAX_PATH];
+	HTTPOutTest t;
+
+	gf_mkdir(HTTPOUT_TEST_DIR);
+	for (i=0; i<5; i++) {
+		sprintf(szPath, HTTPOUT_TEST_DIR"/%c.bin", 'a'+i);
+		assert_true(httpout_test_write(szPath, HTTPOUT_CACHE_SIZE, i+1));
+	}
+	assert_true(httpout_test_start(&t, "rdirs="HTTPOUT_TEST_DIR":cache_mem=16000000", NULL));
+	if (t.fs) {
+		gf_fs_enable_reporting(t.fs, GF_TRUE);
+		httpout_test_cache_run(&t);
+	}
+	httpout_test_stop(&t);
+	gf_dir_cleanup(HTTPOUT_TEST_DIR);
+	gf_rmdir(HTTPOUT_TEST_DIR);
+}
+
+#define HTTPOUT_EPOLL_CLIENTS	200
+#define HTTPOUT_EPOLL_FILES	4
+#define HTTPOUT_EPOLL_SIZE	50000
+
+typedef struct
+{
+	GF_Socket *sk;
+	u8 *data;
+	u32 size, alloc, hdr_size, body_size, status;
+	u32 file_idx, nb_ok;
+	Bool pending;
+} HTTPOutTestClient;
+
+static void httpout_test_client_send(HTTPOutTestClient *c, u32 file_idx)
+{
+	char szPath[20];
+	c->file_idx = file_idx;
+	c->size = c->hdr_size = c->body_size = c->status = 0;
+	c->pending = GF_TRUE;
+	sprintf(szPath, "/%u.bin", file_idx);
+	httpout_test_send(c->sk, szPath, NULL);
+}
+
+//reads available data of a pending response, returns GF_TRUE once the response is complete and checked
+static Bool httpout_test_client_recv(HTTPOutTestClient *c)
+{
+	u32 read = 0;
+	if (!c->pending) return GF_TRUE;
+	if (c->size+HTTPOUT_EPOLL_SIZE > c->alloc) {
+		c->alloc = c->size + 2*HTTPOUT_EPOLL_SIZE;
+		c->data = gf_realloc(c->data, c->alloc+1);
+		if (!c->data) return GF_FALSE;
+	}
+	gf_sk_receive_no_select(c->sk, c->data+c->size, HTTPOUT_EPOLL_SIZE, &read);
+	c->size += read;
+	if (!c->hdr_size && c->size)
+		c->hdr_size = httpout_test_parse_header(c->data, c->size, &c->status, &c->body_size);
+	if (!c->hdr_size || (c->size < c->hdr_size + c->body_size)) return GF_FALSE;
+
+	if ((c->status==200) && httpout_test_check_data(c->data+c->hdr_size, c->body_size, 0, HTTPOUT_EPOLL_SIZE, c->file_idx+1))
+		c->nb_ok++;
+	c->pending = GF_FALSE;
+	return GF_TRUE;
+}
+
+//pumps the session until all pending responses are received
+static Bool httpout_test_clients_wait(HTTPOutTest *t, HTTPOutTestClient *clients, u32 nb_clients)
+{
+	u32 start = gf_sys_clock();
+	while (gf_sys_clock() - start < 20000) {
+		u32 i, nb_pending=0;
+		gf_fs_run(t->fs);
+		for (i=0; i<nb_clients; i++) {
+			if (!httpout_test_client_recv(&clients[i])) nb_pending++;
+		}
+		if (!nb_pending) return GF_TRUE;
+	}
+	return GF_FALSE;
+}
+
+//many persistent connections, half of them idle while the others are served, then all served on the same connections
+static void httpout_test_clients_run(const char *args, u32 nb_clients)
+{
+	u32 i, nb_ok=0;
+	HTTPOutTest t;
+	HTTPOutTestClient *clients;
+
+	assert_true(httpout_test_start(&t, args, NULL));
+	if (!t.fs) return;
+	clients = gf_malloc(sizeof(HTTPOutTestClient)*nb_clients);
+	if (!clients) {
+		httpout_test_stop(&t);
+		return;
+	}
+	memset(clients, 0, sizeof(HTTPOutTestClient)*nb_clients);
+	for (i=0; i<nb_clients; i++) {
+		clients[i].sk = httpout_test_connect(&t);
+		if (!clients[i].sk) break;
+		gf_sk_set_block_mode(clients[i].sk, GF_TRUE);
+	}
+	assert_equal(i, nb_clients);
+	if (i==nb_clients) {
+		//odd clients stay idle
+		for (i=0; i<nb_clients; i+=2)
+			httpout_test_client_send(&clients[i], i % HTTPOUT_EPOLL_FILES);
+		assert_true(httpout_test_clients_wait(&t, clients, nb_clients));
+
+		//idle connections become active, active ones send a second request
+		for (i=0; i<nb_clients; i++)
+			httpout_test_client_send(&clients[i], (i+1) % HTTPOUT_EPOLL_FILES);
+		assert_true(httpout_test_clients_wait(&t, clients, nb_clients));
+	}
+	for (i=0; i<nb_clients; i++) {
+		nb_ok += clients[i].nb_ok;
+		if (clients[i].sk) gf_sk_del(clients[i].sk);
+		if (clients[i].data) gf_free(clients[i].data);
+	}
+	gf_free(clients);
+	httpout_test_stop(&t);
+	assert_equal(nb_ok, nb_clients + nb_clients/2);
+}
+
+//concurrent clients on persistent connections must all be served, with and without epoll
+unittest(httpout_epoll_clients)
+{
+	u32 i, nb_clients = HTTPOUT_EPOLL_CLIENTS;
+	char szPath[GF_MAX_PATH];
+#ifndef WIN32
+	struct rlimit rl;
+	//each client uses two descriptors, client and server side, keep some for the test runner
+	if (!getrlimit(RLIMIT_NOFILE, &rl) && (rl.rlim_cur != RLIM_INFINITY)) {
+		u32 max_clients = (rl.rlim_cur > 64) ? (u32) (rl.rlim_cur - 64) / 2 : 0;
+		if (nb_clients > max_clients) nb_clients = max_clients & ~1;
+	}
+#endif
+
+	gf_mkdir(HTTPOUT_TEST_DIR);
+	for (i=0; i<HTTPOUT_EPOLL_FILES; i++) {
+		sprintf(szPath, HTTPOUT_TEST_DIR"/%u.bin", i);
+		assert_true(httpout_test_write(szPath, HTTPOUT_EPOLL_SIZE, i+1));
+	}
+	//connections all come from the same peer
+	httpout_test_clients_run("rdirs="HTTPOUT_TEST_DIR":maxc=0:maxp=0:epoll=true", nb_clients);
+	httpout_test_clients_run("rdirs="HTTPOUT_TEST_DIR":maxc=0:maxp=0:epoll=false", nb_clients);
+
+	gf_dir_cleanup(HTTPOUT_TEST_DIR);
+	gf_rmdir(HTTPOUT_TEST_DIR);
+}
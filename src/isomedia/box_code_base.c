@@ -35,6 +35,7 @@ void co64_box_del(GF_Box *s)
 	ptr = (GF_ChunkLargeOffsetBox *) s;
 	if (ptr == NULL) return;
 	if (ptr->offsets) gf_free(ptr->offsets);
+	if (ptr->lazy) gf_isom_lazy_table_del(ptr->lazy);
 	gf_free(ptr);
 }
 
@@ -42,6 +43,7 @@ GF_Err co64_box_read(GF_Box *s,GF_BitStream *bs)
 {
 	u32 entries;
 	GF_ChunkLargeOffsetBox *ptr = (GF_ChunkLargeOffsetBox *) s;
+	u64 box_pos = gf_bs_get_position(bs);
 	ptr->nb_entries = gf_bs_read_u32(bs);
 
 	ISOM_DECREASE_SIZE(ptr, 4)
@@ -50,6 +52,8 @@ GF_Err co64_box_read(GF_Box *s,GF_BitStream *bs)
 		GF_LOG(GF_LOG_ERROR, GF_LOG_CONTAINER, ("[iso file] Invalid number of entries %d in co64\n", ptr->nb_entries));
 		return GF_ISOM_INVALID_FILE;
 	}
+	ptr->lazy = gf_isom_lazy_table_new(s, bs, box_pos, ptr->nb_entries, 8);
+	if (ptr->lazy) return GF_OK;
 
 	ptr->offsets = (u64 *) gf_malloc(ptr->nb_entries * sizeof(u64) );
 	if (ptr->offsets == NULL) return GF_OUT_OF_MEM;
@@ -390,6 +394,8 @@ void ctts_box_del(GF_Box *s)
 {
 	GF_CompositionOffsetBox *ptr = (GF_CompositionOffsetBox *)s;
 	if (ptr->entries) gf_free(ptr->entries);
+	if (ptr->r_index) stbl_index_del(ptr->r_index);
+	if (ptr->lazy) gf_isom_lazy_table_del(ptr->lazy);
 	gf_free(ptr);
 }
 
@@ -400,6 +406,7 @@ GF_Err ctts_box_read(GF_Box *s, GF_BitStream *bs)
 	u32 i;
 	u32 sampleCount;
 	GF_CompositionOffsetBox *ptr = (GF_CompositionOffsetBox *)s;
+	u64 box_pos = gf_bs_get_position(bs);
 
 	ISOM_DECREASE_SIZE(ptr, 4);
 	ptr->nb_entries = gf_bs_read_u32(bs);
@@ -408,6 +415,8 @@ GF_Err ctts_box_read(GF_Box *s, GF_BitStream *bs)
 		GF_LOG(GF_LOG_ERROR, GF_LOG_CONTAINER, ("[iso file] Invalid number of entries %d in ctts\n", ptr->nb_entries));
 		return GF_ISOM_INVALID_FILE;
 	}
+	ptr->lazy = gf_isom_lazy_table_new(s, bs, box_pos, ptr->nb_entries, 8);
+	if (ptr->lazy) return GF_OK;
 
 	ptr->alloc_size = ptr->nb_entries;
 	ptr->entries = (GF_DttsEntry *)gf_malloc(sizeof(GF_DttsEntry)*ptr->alloc_size);
@@ -5353,12 +5362,11 @@ GF_Err stbl_box_read(GF_Box *s, GF_BitStream *bs)
 	if (ptr->SampleSize->sampleCount) {
 		if (!ptr->TimeToSample->nb_entries || !ptr->SampleToChunk->nb_entries)
 			return GF_ISOM_INVALID_FILE;
-		//safety check : get info for last sample, if error consider file is invalid
-		u64 sample_offset;
-		u32 di, chunk;
-		e = stbl_GetSampleInfos(ptr, ptr->SampleSize->sampleCount, &sample_offset, &chunk, &di, NULL);
-		if (e) return e;
-		e = stbl_GetSampleDTS(ptr->TimeToSample, ptr->SampleSize->sampleCount, &sample_offset);
+	}
+	//safety check : get info for last sample, if error consider file is invalid
+	//for lazy tables, this is done once the tables are bound to the movie
+	if (!ptr->TimeToSample->lazy && !ptr->SampleSize->lazy) {
+		e = stbl_check_last_sample(ptr);
 		if (e) return e;
 	}
 	u32 i, max_chunks=0;
@@ -5452,6 +5460,7 @@ void stco_box_del(GF_Box *s)
 	GF_ChunkOffsetBox *ptr = (GF_ChunkOffsetBox *)s;
 	if (ptr == NULL) return;
 	if (ptr->offsets) gf_free(ptr->offsets);
+	if (ptr->lazy) gf_isom_lazy_table_del(ptr->lazy);
 	gf_free(ptr);
 }
 
@@ -5460,6 +5469,7 @@ GF_Err stco_box_read(GF_Box *s, GF_BitStream *bs)
 {
 	u32 entries;
 	GF_ChunkOffsetBox *ptr = (GF_ChunkOffsetBox *)s;
+	u64 box_pos = gf_bs_get_position(bs);
 
 	ISOM_DECREASE_SIZE(ptr, 4);
 	ptr->nb_entries = gf_bs_read_u32(bs);
@@ -5467,6 +5477,8 @@ GF_Err stco_box_read(GF_Box *s, GF_BitStream *bs)
 		GF_LOG(GF_LOG_ERROR, GF_LOG_CONTAINER, ("[iso file] Invalid number of entries %d in stco\n", ptr->nb_entries));
 		return GF_ISOM_INVALID_FILE;
 	}
+	ptr->lazy = gf_isom_lazy_table_new(s, bs, box_pos, ptr->nb_entries, 4);
+	if (ptr->lazy) return GF_OK;
 
 	if (ptr->nb_entries) {
 		ptr->offsets = (u32 *) gf_malloc(ptr->nb_entries * sizeof(u32) );
@@ -5583,6 +5595,7 @@ void stsc_box_del(GF_Box *s)
 	GF_SampleToChunkBox *ptr = (GF_SampleToChunkBox *)s;
 	if (ptr == NULL) return;
 	if (ptr->entries) gf_free(ptr->entries);
+	if (ptr->r_index) stbl_index_del(ptr->r_index);
 	gf_free(ptr);
 }
 
@@ -5889,6 +5902,7 @@ void stsz_box_del(GF_Box *s)
 	GF_SampleSizeBox *ptr = (GF_SampleSizeBox *)s;
 	if (ptr == NULL) return;
 	if (ptr->sizes) gf_free(ptr->sizes);
+	if (ptr->lazy) gf_isom_lazy_table_del(ptr->lazy);
 	gf_free(ptr);
 }
 
@@ -5897,7 +5911,9 @@ GF_Err stsz_box_read(GF_Box *s, GF_BitStream *bs)
 {
 	u32 i, estSize;
 	GF_SampleSizeBox *ptr = (GF_SampleSizeBox *)s;
+	u64 box_pos;
 	if (ptr == NULL) return GF_BAD_PARAM;
+	box_pos = gf_bs_get_position(bs);
 
 	//support for CompactSizes
 	if (s->type == GF_ISOM_BOX_TYPE_STSZ) {
@@ -5944,6 +5960,8 @@ GF_Err stsz_box_read(GF_Box *s, GF_BitStream *bs)
 				GF_LOG(GF_LOG_ERROR, GF_LOG_CONTAINER, ("[iso file] Invalid number of entries %d in stsz\n", ptr->sampleCount));
 				return GF_ISOM_INVALID_FILE;
 			}
+			ptr->lazy = gf_isom_lazy_table_new(s, bs, box_pos, ptr->sampleCount, 4);
+			if (ptr->lazy) return GF_OK;
 			ptr->sizes = (u32 *) gf_malloc(ptr->sampleCount * sizeof(u32));
 			if (! ptr->sizes) return GF_OUT_OF_MEM;
 			ptr->alloc_size = ptr->sampleCount;
@@ -6140,6 +6158,8 @@ void stts_box_del(GF_Box *s)
 {
 	GF_TimeToSampleBox *ptr = (GF_TimeToSampleBox *)s;
 	if (ptr->entries) gf_free(ptr->entries);
+	if (ptr->r_index) stbl_index_del(ptr->r_index);
+	if (ptr->lazy) gf_isom_lazy_table_del(ptr->lazy);
 	gf_free(ptr);
 }
 
@@ -6149,6 +6169,7 @@ GF_Err stts_box_read(GF_Box *s, GF_BitStream *bs)
 	u32 i;
 	Bool logged=GF_FALSE;
 	GF_TimeToSampleBox *ptr = (GF_TimeToSampleBox *)s;
+	u64 box_pos = gf_bs_get_position(bs);
 
 #ifndef GPAC_DISABLE_ISOM_WRITE
 	ptr->w_LastDTS = 0;
@@ -6160,6 +6181,8 @@ GF_Err stts_box_read(GF_Box *s, GF_BitStream *bs)
 		GF_LOG(GF_LOG_ERROR, GF_LOG_CONTAINER, ("[iso file] Invalid number of entries %d in stts\n", ptr->nb_entries));
 		return GF_ISOM_INVALID_FILE;
 	}
+	ptr->lazy = gf_isom_lazy_table_new(s, bs, box_pos, ptr->nb_entries, 8);
+	if (ptr->lazy) return GF_OK;
 
 	ptr->alloc_size = ptr->nb_entries;
 	ptr->entries = gf_malloc(sizeof(GF_SttsEntry)*ptr->alloc_size);
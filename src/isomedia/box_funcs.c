@@ -2183,6 +2183,9 @@ GF_Err gf_isom_box_write(GF_Box *a, GF_BitStream *bs)
 		GF_LOG(GF_LOG_DEBUG, GF_LOG_CONTAINER, ("[iso file] Box %s disabled registry, skip write\n", gf_4cc_to_str(a->type)));
 		return GF_OK;
 	}
+	//tables not yet loaded from file
+	e = gf_isom_box_lazy_load(a);
+	if (e) return e;
 
 	GF_LOG(GF_LOG_DEBUG, GF_LOG_CONTAINER, ("[iso file] Box %s size %d write\n", gf_4cc_to_str(a->type), a->size));
 	e = gf_isom_box_write_listing(a, bs);
@@ -2206,6 +2209,8 @@ static GF_Err gf_isom_box_size_listing(GF_Box *a)
 		GF_LOG(GF_LOG_ERROR, GF_LOG_CONTAINER, ("[iso file] Size invalid box type %s without registry\n", gf_4cc_to_str(a->type) ));
 		return GF_ISOM_INVALID_FILE;
 	}
+	//tables not yet loaded from file
+	if (gf_isom_box_lazy_load(a)) return GF_IO_ERR;
 	a->size = 8;
 
 	if (a->type == GF_ISOM_BOX_TYPE_UUID) {
@@ -2378,6 +2383,7 @@ GF_Err gf_isom_box_dump(void *ptr, FILE * trace)
 		GF_LOG(GF_LOG_ERROR, GF_LOG_CONTAINER, ("[isom] trying to dump box %s not registered\n", gf_4cc_to_str(a->type) ));
 		return GF_ISOM_INVALID_FILE;
 	}
+	gf_isom_box_lazy_load(a);
 	a->registry->dump_fn(a, trace);
 	return GF_OK;
 }
@@ -28,9 +28,6 @@
 #include <gpac/thread.h>
 
 
-/*File Mapping object, read-only mode on complete files (no download)*/
-//#define GF_ISOM_DATA_FILE_MAPPING 0x02
-
 #ifndef GPAC_DISABLE_ISOM
 
 GF_BitStream *gf_bs_from_fd(int fd, u32 mode);
@@ -48,11 +45,9 @@ void gf_isom_datamap_del(GF_DataMap *ptr)
 	case GF_ISOM_DATA_MEM:
 		gf_isom_fdm_del((GF_FileDataMap *)ptr);
 		break;
-#if 0
 	case GF_ISOM_DATA_FILE_MAPPING:
 		gf_isom_fmo_del((GF_FileMappingDataMap *)ptr);
 		break;
-#endif
 	default:
 		if (ptr->bs) gf_bs_del(ptr->bs);
 		gf_free(ptr);
@@ -283,10 +278,8 @@ u32 gf_isom_datamap_get_data(GF_DataMap *map, u8 *buffer, u32 bufferLength, u64
 	case GF_ISOM_DATA_MEM:
 		return gf_isom_fdm_get_data((GF_FileDataMap *)map, buffer, bufferLength, Offset, is_corrupted);
 
-#if 0
 	case GF_ISOM_DATA_FILE_MAPPING:
 		return gf_isom_fmo_get_data((GF_FileMappingDataMap *)map, buffer, bufferLength, Offset, is_corrupted);
-#endif
 
 	default:
 		return 0;
@@ -604,11 +597,9 @@ Bool gf_isom_datamap_top_level_box_avail(GF_DataMap *map)
 	case GF_ISOM_DATA_MEM:
 		return gf_isom_fdm_check_top_level((GF_FileDataMap *)map);
 
-#if 0
 	case GF_ISOM_DATA_FILE_MAPPING:
 		if (gf_bs_available( ((GF_FileMappingDataMap*)map)->bs)) return GF_TRUE;
 		return GF_FALSE;
-#endif
 
 	default:
 		return 0;
@@ -659,8 +650,6 @@ GF_Err FDM_AddData(GF_FileDataMap *ptr, char *data, u32 dataSize)
 #endif	/*GPAC_DISABLE_ISOM_WRITE*/
 
 
-#if 0 //file mapping disabled
-
 #ifdef WIN32
 
 #include <windows.h>
@@ -670,6 +659,7 @@ GF_DataMap *gf_isom_fmo_new(const char *sPath, u8 mode)
 {
 	GF_FileMappingDataMap *tmp;
 	HANDLE fileH, fileMapH;
+	DWORD size_high=0, size_low;
 #ifdef _WIN32_WCE
 	unsigned short sWPath[MAX_PATH];
 #endif
@@ -705,8 +695,16 @@ GF_DataMap *gf_isom_fmo_new(const char *sPath, u8 mode)
 		return NULL;
 	}
 
-	tmp->file_size = GetFileSize(fileH, NULL);
-	if (tmp->file_size == 0xFFFFFFFF) {
+	size_low = GetFileSize(fileH, &size_high);
+	if ((size_low == INVALID_FILE_SIZE) && (GetLastError() != NO_ERROR)) {
+		CloseHandle(fileH);
+		gf_free(tmp->name);
+		gf_free(tmp);
+		return NULL;
+	}
+	tmp->file_size = ((u64) size_high << 32) | size_low;
+	//cannot map the entire file in 32 bit address space
+	if (!tmp->file_size || (tmp->file_size != (u64) (size_t) tmp->file_size)) {
 		CloseHandle(fileH);
 		gf_free(tmp->name);
 		gf_free(tmp);
@@ -751,35 +749,100 @@ void gf_isom_fmo_del(GF_FileMappingDataMap *ptr)
 	gf_free(ptr);
 }
 
+#elif defined(GPAC_HAS_FD)
 
-u32 gf_isom_fmo_get_data(GF_FileMappingDataMap *ptr, u8 *buffer, u32 bufferLength, u64 fileOffset, GF_BlobRangeStatus *is_corrupted)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+GF_DataMap *gf_isom_fmo_new(const char *sPath, u8 mode)
 {
-	//can we seek till that point ???
-	if (fileOffset > ptr->file_size) return 0;
+	GF_FileMappingDataMap *tmp;
+	struct stat st;
+	void *map;
+	s32 fd;
 
-	//we do only read operations, so trivial
-	memcpy(buffer, ptr->byte_map + fileOffset, bufferLength);
-	return bufferLength;
+	//only in read only, and only for regular files
+	if (mode != GF_ISOM_DATA_MAP_READ) return NULL;
+	if (!strncmp(sPath, "gmem://", 7) || !strncmp(sPath, "gfio://", 7)) return NULL;
+
+	fd = gf_fd_open(sPath, O_RDONLY | O_BINARY, S_IRUSR | S_IWUSR);
+	if (fd<0) return NULL;
+
+	if (fstat(fd, &st) || !S_ISREG(st.st_mode) || !st.st_size
+		//cannot map the entire file in 32 bit address space
+		|| ((u64) st.st_size != (u64) (size_t) st.st_size)
+	) {
+		close(fd);
+		return NULL;
+	}
+	map = mmap(NULL, (size_t) st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	//the mapping stays valid once the descriptor is closed
+	close(fd);
+	if (map == MAP_FAILED) {
+		GF_LOG(GF_LOG_DEBUG, GF_LOG_CONTAINER, ("[IsoMedia] Failed to map file %s: %s\n", sPath, strerror(errno)));
+		return NULL;
+	}
+#ifdef MADV_SEQUENTIAL
+	madvise(map, (size_t) st.st_size, MADV_SEQUENTIAL);
+#endif
+
+	GF_SAFEALLOC(tmp, GF_FileMappingDataMap);
+	if (!tmp) {
+		munmap(map, (size_t) st.st_size);
+		return NULL;
+	}
+	tmp->type = GF_ISOM_DATA_FILE_MAPPING;
+	tmp->mode = mode;
+	tmp->name = gf_strdup(sPath);
+	tmp->file_size = (u64) st.st_size;
+	tmp->byte_map = (u8 *) map;
+	tmp->bs = gf_bs_new(tmp->byte_map, tmp->file_size, GF_BITSTREAM_READ);
+	if (!tmp->bs) {
+		gf_isom_fmo_del(tmp);
+		return NULL;
+	}
+	return (GF_DataMap *)tmp;
+}
+
+void gf_isom_fmo_del(GF_FileMappingDataMap *ptr)
+{
+	if (!ptr || (ptr->type != GF_ISOM_DATA_FILE_MAPPING)) return;
+
+	if (ptr->bs) gf_bs_del(ptr->bs);
+	if (ptr->byte_map) munmap(ptr->byte_map, (size_t) ptr->file_size);
+	if (ptr->name) gf_free(ptr->name);
+	gf_free(ptr);
 }
 
 #else
 
 GF_DataMap *gf_isom_fmo_new(const char *sPath, u8 mode)
 {
-	return gf_isom_fdm_new(sPath, mode);
+	return NULL;
 }
 
 void gf_isom_fmo_del(GF_FileMappingDataMap *ptr)
 {
-	gf_isom_fdm_del((GF_FileDataMap *)ptr);
 }
 
+#endif
+
 u32 gf_isom_fmo_get_data(GF_FileMappingDataMap *ptr, u8 *buffer, u32 bufferLength, u64 fileOffset, GF_BlobRangeStatus *is_corrupted)
 {
-	return gf_isom_fdm_get_data((GF_FileDataMap *)ptr, buffer, bufferLength, fileOffset, is_corrupted);
+	if (is_corrupted)
+		*is_corrupted = GF_BLOB_RANGE_VALID;
+
+	//can we seek till that point ???
+	if (fileOffset > ptr->file_size) return 0;
+	if (fileOffset + bufferLength > ptr->file_size)
+		bufferLength = (u32) (ptr->file_size - fileOffset);
+
+	//we do only read operations, so trivial
+	memcpy(buffer, ptr->byte_map + fileOffset, bufferLength);
+	ptr->curPos = fileOffset + bufferLength;
+	return bufferLength;
 }
 
-#endif //win32
-#endif //file mapping disabled
 
 #endif /*GPAC_DISABLE_ISOM*/
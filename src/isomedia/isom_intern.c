@@ -355,7 +355,8 @@ static void convert_compact_sample_groups(GF_List *child_boxes, GF_List *sampleG
 static GF_Err gf_isom_parse_movie_boxes_internal(GF_ISOFile *mov, u32 *boxType, u64 *bytesMissing, Bool progressive_mode)
 {
 	GF_Box *a;
-	u64 top_start, mdat_end=0;
+	u64 top_start, mdat_end=0, cookie=0;
+	Bool lazy_parse;
 	GF_Err e = GF_OK;
 
 #ifndef	GPAC_DISABLE_ISOM_FRAGMENTS
@@ -381,8 +382,19 @@ static GF_Err gf_isom_parse_movie_boxes_internal(GF_ISOFile *mov, u32 *boxType,
 		GF_LOG(GF_LOG_DEBUG, GF_LOG_CONTAINER, ("[iso file] Parsing a top-level box at position %d\n", mov->current_top_box_start));
 #endif
 
+		//sample tables payload is read back from the file when needed, only for local files
+		lazy_parse = GF_FALSE;
+		if (mov->lazy_tables && !mov->moov && (mov->movieFileMap->type==GF_ISOM_DATA_FILE) && !mov->movieFileMap->use_blob) {
+			cookie = gf_bs_get_cookie(mov->movieFileMap->bs);
+			gf_bs_set_cookie(mov->movieFileMap->bs, cookie | GF_ISOM_BS_COOKIE_LAZY_TABLES);
+			lazy_parse = GF_TRUE;
+		}
+
 		e = gf_isom_parse_root_box(&a, mov->movieFileMap->bs, boxType, bytesMissing, progressive_mode);
 
+		if (lazy_parse)
+			gf_bs_set_cookie(mov->movieFileMap->bs, cookie);
+
 		if (e >= 0) {
 			//safety check, should never happen
 			if (!a) return GF_ISOM_INVALID_FILE;
@@ -438,6 +450,11 @@ static GF_Err gf_isom_parse_movie_boxes_internal(GF_ISOFile *mov, u32 *boxType,
 			e = gf_list_add(mov->TopBoxes, a);
 			if (e) return e;
 
+			if (mov->lazy_tables) {
+				e = gf_isom_lazy_tables_setup(mov);
+				if (e) return e;
+			}
+
             if (!mov->moov->mvhd) {
 				if (mov->moov->has_cmvd!=2) {
 					GF_LOG(GF_LOG_ERROR, GF_LOG_CONTAINER, ("[iso file] Missing MovieHeaderBox\n"));
@@ -109,7 +109,7 @@ GF_EXPORT
 void gf_isom_sample_del(GF_ISOSample **samp)
 {
 	if (!samp || ! *samp) return;
-	if ((*samp)->data && (*samp)->dataLength) gf_free((*samp)->data);
+	if ((*samp)->data && (*samp)->dataLength && !(*samp)->mapped) gf_free((*samp)->data);
 	gf_free(*samp);
 	*samp = NULL;
 }
@@ -427,8 +427,7 @@ static GF_Err isom_create_init_from_mem(const char *fileName, GF_ISOFile *file)
 					File Opening in streaming mode
 			the file map is regular (through FILE handles)
 **************************************************************/
-GF_EXPORT
-GF_Err gf_isom_open_progressive_ex(const char *fileName, u64 start_range, u64 end_range, Bool enable_frag_bounds, GF_ISOFile **the_file, u64 *BytesMissing, u32 *outBoxType)
+static GF_Err isom_open_progressive(const char *fileName, u64 start_range, u64 end_range, Bool enable_frag_bounds, Bool lazy_tables, GF_ISOFile **the_file, u64 *BytesMissing, u32 *outBoxType)
 {
 	GF_Err e;
 	GF_ISOFile *movie;
@@ -444,6 +443,7 @@ GF_Err gf_isom_open_progressive_ex(const char *fileName, u64 start_range, u64 en
 	movie->fileName = gf_strdup(fileName);
 	movie->openMode = GF_ISOM_OPEN_READ;
 	movie->signal_frag_bounds = enable_frag_bounds;
+	movie->lazy_tables = lazy_tables;
 
 #ifndef GPAC_DISABLE_ISOM_WRITE
 	movie->editFileMap = NULL;
@@ -495,10 +495,22 @@ GF_Err gf_isom_open_progressive_ex(const char *fileName, u64 start_range, u64 en
 	return GF_OK;
 }
 
+GF_EXPORT
+GF_Err gf_isom_open_progressive_ex(const char *fileName, u64 start_range, u64 end_range, Bool enable_frag_bounds, GF_ISOFile **the_file, u64 *BytesMissing, u32 *outBoxType)
+{
+	return isom_open_progressive(fileName, start_range, end_range, enable_frag_bounds, GF_FALSE, the_file, BytesMissing, outBoxType);
+}
+
 GF_EXPORT
 GF_Err gf_isom_open_progressive(const char *fileName, u64 start_range, u64 end_range, Bool enable_frag_bounds, GF_ISOFile **the_file, u64 *BytesMissing)
 {
-	return gf_isom_open_progressive_ex(fileName, start_range, end_range, enable_frag_bounds, the_file, BytesMissing, NULL);
+	return isom_open_progressive(fileName, start_range, end_range, enable_frag_bounds, GF_FALSE, the_file, BytesMissing, NULL);
+}
+
+GF_EXPORT
+GF_Err gf_isom_open_progressive_lazy(const char *fileName, u64 start_range, u64 end_range, Bool enable_frag_bounds, GF_ISOFile **the_file, u64 *BytesMissing)
+{
+	return isom_open_progressive(fileName, start_range, end_range, enable_frag_bounds, GF_TRUE, the_file, BytesMissing, NULL);
 }
 
 void gf_bs_untruncate(GF_BitStream *bs);
@@ -1782,10 +1794,12 @@ GF_EXPORT
 u32 gf_isom_get_constant_sample_duration(GF_ISOFile *the_file, u32 trackNumber)
 {
 	GF_TrackBox *trak;
+	GF_SttsEntry *ent;
 	trak = gf_isom_get_track_from_file(the_file, trackNumber);
 	if (!trak || !trak->Media || !trak->Media->information || !trak->Media->information->sampleTable || !trak->Media->information->sampleTable->TimeToSample) return 0;
 	if (trak->Media->information->sampleTable->TimeToSample->nb_entries != 1) return 0;
-	return trak->Media->information->sampleTable->TimeToSample->entries[0].sampleDelta;
+	ent = stts_get_entry(trak->Media->information->sampleTable->TimeToSample, 0);
+	return ent ? ent->sampleDelta : 0;
 }
 
 GF_EXPORT
@@ -1804,8 +1818,8 @@ Bool gf_isom_enable_raw_pack(GF_ISOFile *the_file, u32 trackNumber, u32 pack_num
 	//and sample duration of 1
 	if (!trak->Media->information || !trak->Media->information->sampleTable || !trak->Media->information->sampleTable->TimeToSample) return GF_FALSE;
 	if (trak->Media->information->sampleTable->TimeToSample->nb_entries != 1) return GF_FALSE;
-	if (!trak->Media->information->sampleTable->TimeToSample->entries) return GF_FALSE;
-	if (trak->Media->information->sampleTable->TimeToSample->entries[0].sampleDelta != 1) return GF_FALSE;
+	GF_SttsEntry *ent = stts_get_entry(trak->Media->information->sampleTable->TimeToSample, 0);
+	if (!ent || (ent->sampleDelta != 1)) return GF_FALSE;
 	//and sample with constant size
 	if (!trak->Media->information->sampleTable->SampleSize || !trak->Media->information->sampleTable->SampleSize->sampleSize) return GF_FALSE;
 	trak->pack_num_samples = pack_num_samples;
@@ -1868,7 +1882,9 @@ u32 gf_isom_has_time_offset(GF_ISOFile *the_file, u32 trackNumber)
 	//return true at the first offset found
 	ctts = trak->Media->information->sampleTable->CompositionOffset;
 	for (i=0; i<ctts->nb_entries; i++) {
-		if (ctts->entries[i].decodingOffset && ctts->entries[i].sampleCount) return ctts->version ? 2 : 1;
+		GF_DttsEntry *ent = ctts_get_entry(ctts, i);
+		if (!ent) break;
+		if (ent->decodingOffset && ent->sampleCount) return ctts->version ? 2 : 1;
 	}
 	return 0;
 }
@@ -1939,7 +1955,7 @@ GF_ISOSample *gf_isom_get_sample_ex(GF_ISOFile *the_file, u32 trackNumber, u32 s
 	if (!sampleNumber) return NULL;
 	if (static_sample) {
 		samp = static_sample;
-		if (static_sample->dataLength && !static_sample->alloc_size)
+		if (static_sample->dataLength && !static_sample->alloc_size && !static_sample->mapped)
 			static_sample->alloc_size = static_sample->dataLength;
 
 		if ((static_sample != trak->Media->extracted_samp) && trak->sample_alloc_cbk)
@@ -1956,7 +1972,7 @@ GF_ISOSample *gf_isom_get_sample_ex(GF_ISOFile *the_file, u32 trackNumber, u32 s
 #endif
 
 	e = Media_GetSample(trak->Media, sampleNumber, &samp, &descIndex, GF_FALSE, data_offset, ext_realloc);
-	if (static_sample && !static_sample->alloc_size)
+	if (static_sample && !static_sample->alloc_size && !static_sample->mapped)
 		static_sample->alloc_size = static_sample->dataLength;
 
 	if (e) {
@@ -2015,6 +2031,7 @@ u32 gf_isom_get_max_sample_size(GF_ISOFile *the_file, u32 trackNumber)
 	GF_TrackBox *trak = gf_isom_get_track_from_file(the_file, trackNumber);
 	if (!trak || !trak->Media || !trak->Media->information || !trak->Media->information->sampleTable || !trak->Media->information->sampleTable->SampleSize) return 0;
 
+	stbl_lazy_stats(trak->Media->information->sampleTable);
 	return trak->Media->information->sampleTable->SampleSize->max_size;
 }
 
@@ -2027,6 +2044,7 @@ u32 gf_isom_get_avg_sample_size(GF_ISOFile *the_file, u32 trackNumber)
 	if ( trak->Media->information->sampleTable->SampleSize->sampleSize)
 		return trak->Media->information->sampleTable->SampleSize->sampleSize;
 
+	stbl_lazy_stats(trak->Media->information->sampleTable);
 	if (!trak->Media->information->sampleTable->SampleSize->total_samples) return 0;
 	return (u32) (trak->Media->information->sampleTable->SampleSize->total_size / trak->Media->information->sampleTable->SampleSize->total_samples);
 }
@@ -2037,6 +2055,7 @@ u32 gf_isom_get_max_sample_delta(GF_ISOFile *the_file, u32 trackNumber)
 	GF_TrackBox *trak = gf_isom_get_track_from_file(the_file, trackNumber);
 	if (!trak || !trak->Media || !trak->Media->information || !trak->Media->information->sampleTable || !trak->Media->information->sampleTable->TimeToSample) return 0;
 
+	stbl_lazy_stats(trak->Media->information->sampleTable);
 	return trak->Media->information->sampleTable->TimeToSample->max_ts_delta;
 }
 
@@ -2049,9 +2068,11 @@ u32 gf_isom_get_avg_sample_delta(GF_ISOFile *the_file, u32 trackNumber)
 	GF_TimeToSampleBox *stts = trak->Media->information->sampleTable->TimeToSample;
 	u32 i, nb_ent = 0, min = 0;
 	for (i=0; i<stts->nb_entries; i++) {
-		if (!nb_ent || nb_ent < stts->entries[i].sampleCount) {
-			min = stts->entries[i].sampleDelta;
-			nb_ent = stts->entries[i].sampleCount;
+		GF_SttsEntry *ent = stts_get_entry(stts, i);
+		if (!ent) break;
+		if (!nb_ent || nb_ent < ent->sampleCount) {
+			min = ent->sampleDelta;
+			nb_ent = ent->sampleCount;
 		}
 	}
 	return min;
@@ -2064,6 +2085,7 @@ u32 gf_isom_get_max_sample_cts_offset(GF_ISOFile *the_file, u32 trackNumber)
 	GF_TrackBox *trak = gf_isom_get_track_from_file(the_file, trackNumber);
 	if (!trak || !trak->Media || !trak->Media->information || !trak->Media->information->sampleTable || !trak->Media->information->sampleTable->CompositionOffset) return 0;
 
+	stbl_lazy_stats(trak->Media->information->sampleTable);
 	return trak->Media->information->sampleTable->CompositionOffset->max_cts_delta;
 }
 
@@ -2168,6 +2190,8 @@ u32 gf_isom_get_sample_from_dts(GF_ISOFile *the_file, u32 trackNumber, u64 dts)
 	if (!trak) return 0;
 
 	stbl = trak->Media->information->sampleTable;
+	if (the_file->openMode == GF_ISOM_OPEN_READ)
+		stbl_index_setup(stbl);
 
 	e = stbl_findEntryForTime(stbl, dts, 1, &sampleNumber, &prevSampleNumber);
 	if (e) return 0;
@@ -2197,6 +2221,8 @@ GF_Err gf_isom_get_sample_for_media_time(GF_ISOFile *the_file, u32 trackNumber,
 	if (!trak) return GF_BAD_PARAM;
 
 	stbl = trak->Media->information->sampleTable;
+	if (the_file->openMode == GF_ISOM_OPEN_READ)
+		stbl_index_setup(stbl);
 
 #ifndef	GPAC_DISABLE_ISOM_FRAGMENTS
 	if (desiredTime < trak->dts_at_seg_start) {
@@ -2312,7 +2338,7 @@ GF_Err gf_isom_get_sample_for_media_time(GF_ISOFile *the_file, u32 trackNumber,
 	if (e) {
 		if (!static_sample)
 			gf_isom_sample_del(sample);
-		else if (! (*sample)->alloc_size && (*sample)->data && (*sample)->dataLength )
+		else if (! (*sample)->alloc_size && (*sample)->data && (*sample)->dataLength && !(*sample)->mapped)
 		 	(*sample)->alloc_size =  (*sample)->dataLength;
 
 		return e;
@@ -2347,7 +2373,7 @@ GF_Err gf_isom_get_sample_for_media_time(GF_ISOFile *the_file, u32 trackNumber,
 		shadow->dataLength = 0;
 		gf_isom_sample_del(&shadow);
 	}
-	if (static_sample && ! (*sample)->alloc_size )
+	if (static_sample && ! (*sample)->alloc_size && !(*sample)->mapped)
 		 (*sample)->alloc_size =  (*sample)->dataLength;
 
 	return GF_OK;
@@ -3002,9 +3028,11 @@ GF_Err gf_isom_get_fragment_defaults(GF_ISOFile *the_file, u32 trackNumber,
 	if (defaultDuration) {
 		maxValue = value = 0;
 		for (i=0; i<stbl->TimeToSample->nb_entries; i++) {
-			if (stbl->TimeToSample->entries[i].sampleCount>maxValue) {
-				value = stbl->TimeToSample->entries[i].sampleDelta;
-				maxValue = stbl->TimeToSample->entries[i].sampleCount;
+			GF_SttsEntry *ent = stts_get_entry(stbl->TimeToSample, i);
+			if (!ent) return GF_ISOM_INVALID_FILE;
+			if (ent->sampleCount>maxValue) {
+				value = ent->sampleDelta;
+				maxValue = ent->sampleCount;
 			}
 		}
 		*defaultDuration = value;
@@ -3215,6 +3243,7 @@ GF_Err gf_isom_purge_samples(GF_ISOFile *the_file, u32 trackNumber, u32 nb_sampl
 	stbl_RemoveChunk(stbl, 1, nb_samples);
 	stbl_RemoveRedundant(stbl, 1, nb_samples);
 	stbl_RemoveRAPs(stbl, nb_samples);
+	stbl_index_reset(stbl);
 
 	//purge saiz and saio
 	if (trak->sample_encryption && trak->sample_encryption->cenc_saiz) {
@@ -3292,6 +3321,7 @@ static void gf_isom_recreate_tables(GF_TrackBox *trak)
 	GF_Box *a;
 	GF_SampleTableBox *stbl = trak->Media->information->sampleTable;
 
+	stbl_index_reset(stbl);
 	if (stbl->ChunkOffset) {
 		if (stbl->ChunkOffset->type==GF_ISOM_BOX_TYPE_CO64) {
 			GF_ChunkLargeOffsetBox *co64 = (GF_ChunkLargeOffsetBox *)stbl->ChunkOffset;
@@ -4128,6 +4158,7 @@ u64 gf_isom_get_media_data_size(GF_ISOFile *movie, u32 trackNumber)
 	if (!tk) return 0;
 	stsz = tk->Media->information->sampleTable->SampleSize;
 	if (!stsz) return 0;
+	stbl_lazy_stats(tk->Media->information->sampleTable);
 	if ( (movie->openMode==GF_ISOM_OPEN_READ) && stsz->total_size
 #ifndef GPAC_DISABLE_ISOM_FRAGMENTS
 		&& !movie->moov->mvex
@@ -4136,6 +4167,9 @@ u64 gf_isom_get_media_data_size(GF_ISOFile *movie, u32 trackNumber)
 		return stsz->total_size;
 	}
 	if (stsz->sampleSize) return stsz->sampleSize*stsz->sampleCount;
+	//lazy table, total size is computed by the stats scan
+	if (stsz->lazy) return stsz->total_size;
+	if (!stsz->sizes) return 0;
 	size = 0;
 	for (i=0; i<stsz->sampleCount; i++) size += stsz->sizes[i];
 #ifndef GPAC_DISABLE_ISOM_FRAGMENTS
@@ -6293,10 +6327,7 @@ GF_Err gf_isom_get_chunk_info(GF_ISOFile *movie, u32 trackNumber, u32 chunk_num,
 	if (first_sample_num) *first_sample_num = nb_samples;
 	if (sample_desc_idx) *sample_desc_idx = sample_desc_index;
 	if (chunk_offset) {
-		if (stco)
-			*chunk_offset = stco->offsets[chunk_num-1];
-		else
-			*chunk_offset = co64->offsets[chunk_num-1];
+		return stbl_GetChunkOffset(trak->Media->information->sampleTable, chunk_num, chunk_offset);
 	}
 	return GF_OK;
 }
@@ -6607,6 +6638,7 @@ s32 gf_isom_get_min_negative_cts_offset(GF_ISOFile *the_file, u32 trackNumber, G
 		if (query_mode==GF_ISOM_MIN_NEGCTTS_CLSG) return 0;
 	}
 	if (!trak->Media->information->sampleTable->CompositionOffset) return 0;
+	stbl_lazy_stats(trak->Media->information->sampleTable);
 	return trak->Media->information->sampleTable->CompositionOffset->min_neg_cts_offset;
 }
 
@@ -6620,6 +6652,52 @@ GF_Err gf_isom_switch_source(GF_ISOFile *the_file, const char *new_file)
 	return gf_isom_datamap_new(new_file, NULL, GF_ISOM_DATA_MAP_READ_ONLY, &the_file->movieFileMap);
 }
 
+GF_EXPORT
+GF_Err gf_isom_enable_file_mapping(GF_ISOFile *the_file)
+{
+	u32 i, count;
+	GF_DataMap *map;
+	if (!the_file || !the_file->movieFileMap || !the_file->fileName) return GF_BAD_PARAM;
+	if (the_file->openMode != GF_ISOM_OPEN_READ) return GF_BAD_PARAM;
+	if (the_file->movieFileMap->type == GF_ISOM_DATA_FILE_MAPPING) return GF_OK;
+	if (the_file->movieFileMap->type != GF_ISOM_DATA_FILE) return GF_NOT_SUPPORTED;
+	//blob-based or partial file
+	if (((GF_FileDataMap *)the_file->movieFileMap)->blob || the_file->read_byte_offset || the_file->bytes_removed)
+		return GF_NOT_SUPPORTED;
+
+	map = gf_isom_fmo_new(the_file->fileName, GF_ISOM_DATA_MAP_READ);
+	if (!map) return GF_NOT_SUPPORTED;
+	//file was truncated to a byte range or modified since opened
+	if (gf_bs_get_size(map->bs) != gf_bs_get_size(the_file->movieFileMap->bs)) {
+		gf_isom_datamap_del(map);
+		return GF_NOT_SUPPORTED;
+	}
+	gf_bs_seek(map->bs, gf_bs_get_position(the_file->movieFileMap->bs));
+	map->curPos = the_file->movieFileMap->curPos;
+
+	//self-contained tracks use the movie data map
+	count = the_file->moov ? gf_list_count(the_file->moov->trackList) : 0;
+	for (i=0; i<count; i++) {
+		GF_TrackBox *trak = gf_list_get(the_file->moov->trackList, i);
+		if (trak->Media && trak->Media->information && (trak->Media->information->dataHandler == the_file->movieFileMap))
+			trak->Media->information->dataHandler = map;
+	}
+	gf_isom_datamap_del(the_file->movieFileMap);
+	the_file->movieFileMap = map;
+	GF_LOG(GF_LOG_DEBUG, GF_LOG_CONTAINER, ("[IsoMedia] Using memory mapping for file %s\n", the_file->fileName));
+	return GF_OK;
+}
+
+GF_EXPORT
+GF_Err gf_isom_set_zero_copy(GF_ISOFile *the_file, u32 trackNumber, Bool enable)
+{
+	GF_TrackBox *trak;
+	trak = gf_isom_get_track_from_file(the_file, trackNumber);
+	if (!trak) return GF_BAD_PARAM;
+	trak->zero_copy = enable;
+	return GF_OK;
+}
+
 GF_EXPORT
 GF_Err gf_isom_get_sample_references(GF_ISOFile *the_file, u32 trackNumber, u32 sampleNumber, u32 *ID, u32 *nb_refs, const u32 **refs)
 {
@@ -99,7 +99,7 @@ static GF_Err gf_isom_get_3gpp_audio_esd(GF_SampleTableBox *stbl, u32 type, GF_G
 		memset(szName, 0, 80);
 		strcpy(szName, "QCELP-13K(GPAC-emulated)");
 		gf_bs_write_data(bs, szName, 80);
-		ent = stbl->TimeToSample->nb_entries ? &stbl->TimeToSample->entries[0] : NULL;
+		ent = stts_get_entry(stbl->TimeToSample, 0);
 		sample_rate = entry->samplerate_hi;
 		block_size = (ent && ent->sampleDelta) ? ent->sampleDelta : 160;
 		gf_bs_write_u16_le(bs, 8*sample_size*sample_rate/block_size);
@@ -468,6 +468,27 @@ Bool Media_IsSampleSyncShadow(GF_ShadowSyncBox *stsh, u32 sampleNumber)
 	return 0;
 }
 
+//check if sample payload may be rewritten once read, in which case it cannot point to the file mapping
+static Bool Media_SampleNeedsRewrite(GF_MediaBox *mdia, GF_SampleEntryBox *entry)
+{
+	if (mdia->mediaTrack->padding_bytes) return GF_TRUE;
+
+	if (mdia->handler->handlerType == GF_ISOM_MEDIA_OD) {
+		return mdia->mediaTrack->moov->mov->disable_odf_translate ? GF_FALSE : GF_TRUE;
+	}
+	if (gf_isom_is_nalu_based_entry(mdia, entry)) {
+		if (gf_isom_is_encrypted_entry(entry->type)) return GF_FALSE;
+		return gf_isom_nalu_sample_rewrite_is_passthrough(mdia, (GF_MPEGVisualSampleEntryBox *)entry) ? GF_FALSE : GF_TRUE;
+	}
+	if (mdia->mediaTrack->moov->mov->convert_streaming_text
+		&& ((mdia->handler->handlerType == GF_ISOM_MEDIA_TEXT) || (mdia->handler->handlerType == GF_ISOM_MEDIA_SCENE) || (mdia->handler->handlerType == GF_ISOM_MEDIA_SUBT))
+		&& (entry->type == GF_ISOM_BOX_TYPE_TX3G || entry->type == GF_ISOM_BOX_TYPE_TEXT)
+	) {
+		return GF_TRUE;
+	}
+	return GF_FALSE;
+}
+
 GF_Err Media_GetSample(GF_MediaBox *mdia, u32 sampleNumber, GF_ISOSample **samp, u32 *sIDX, Bool no_data, u64 *out_offset, Bool ext_realloc)
 {
 	GF_Err e;
@@ -488,6 +509,10 @@ GF_Err Media_GetSample(GF_MediaBox *mdia, u32 sampleNumber, GF_ISOSample **samp,
 	//the data info
 	if (!sIDX && !no_data) return GF_BAD_PARAM;
 
+	//tables are only appended to in read mode, allow random access indexing
+	if (!mdia->information->sampleTable->r_index_init && (mdia->mediaTrack->moov->mov->openMode == GF_ISOM_OPEN_READ))
+		stbl_index_setup(mdia->information->sampleTable);
+
 	e = stbl_GetSampleInfos(mdia->information->sampleTable, sampleNumber, &offset, &chunkNumber, &sdesc_idx, &stsc_entry);
 	if (e) return e;
 	if (sIDX) (*sIDX) = sdesc_idx;
@@ -496,6 +521,13 @@ GF_Err Media_GetSample(GF_MediaBox *mdia, u32 sampleNumber, GF_ISOSample **samp,
 	if (!samp ) return GF_OK;
 
 	(*samp)->corrupted = 0;
+	//previous payload was pointing to the file mapping, do not reuse it
+	if ((*samp)->mapped) {
+		(*samp)->data = NULL;
+		(*samp)->dataLength = 0;
+		(*samp)->alloc_size = 0;
+		(*samp)->mapped = 0;
+	}
 	if (mdia->information->sampleTable->TimeToSample) {
 		//get the DTS
 		e = stbl_GetSampleDTS_and_Duration(mdia->information->sampleTable->TimeToSample, sampleNumber, &(*samp)->DTS, &(*samp)->duration);
@@ -616,6 +648,37 @@ GF_Err Media_GetSample(GF_MediaBox *mdia, u32 sampleNumber, GF_ISOSample **samp,
 			data_size *= left_in_chunk;
 			(*samp)->nb_pack = left_in_chunk;
 		}
+
+		//zero-copy mode, point to the file mapping
+		if (mdia->mediaTrack->zero_copy
+			&& (mdia->information->dataHandler->type == GF_ISOM_DATA_FILE_MAPPING)
+			&& !Media_SampleNeedsRewrite(mdia, entry)
+		) {
+			GF_FileMappingDataMap *fmap = (GF_FileMappingDataMap *) mdia->information->dataHandler;
+			if (offset + data_size > fmap->file_size) {
+				mdia->BytesMissing = offset + data_size - fmap->file_size;
+				return GF_ISOM_INCOMPLETE_FILE;
+			}
+			//buffer owned by the sample, otherwise owned by the allocator callback
+			if ((*samp)->data && (*samp)->alloc_size && !ext_realloc)
+				gf_free((*samp)->data);
+
+			(*samp)->data = fmap->byte_map + offset;
+			(*samp)->dataLength = data_size;
+			(*samp)->alloc_size = 0;
+			(*samp)->mapped = 1;
+			mdia->BytesMissing = 0;
+
+			//SAP detection only inspects the payload
+			if (gf_isom_is_nalu_based_entry(mdia, entry)) {
+				GF_ISOSAPType gf_isom_nalu_get_sample_sap(GF_MediaBox *mdia, u32 sampleNumber, GF_ISOSample *sample, GF_MPEGVisualSampleEntryBox *entry);
+				GF_ISOSAPType sap = gf_isom_nalu_get_sample_sap(mdia, sampleNumber, *samp, (GF_MPEGVisualSampleEntryBox *)entry);
+				if (sap && ! (*samp)->IsRAP) (*samp)->IsRAP = sap;
+				else if (!gf_sys_old_arch_compat() && ((*samp)->IsRAP < sap)) (*samp)->IsRAP = sap;
+			}
+			return GF_OK;
+		}
+
 		if (! (*samp)->data)
 			(*samp)->alloc_size = 0;
 
@@ -2068,8 +2068,7 @@ void gf_isom_meta_restore_items_ref(GF_ISOFile *movie, GF_MetaBox *meta)
 				GF_Err e;
 				u32 chunk, di, samp_size;
 				u64 samp_offset;
-				samp_size = stsz->sampleSize ? stsz->sampleSize : stsz->sizes[k];
-				if (samp_size != entry->extent_length)
+				if (stbl_GetSampleSize(stsz, k+1, &samp_size) || (samp_size != entry->extent_length))
 					continue;
 
 				e = stbl_GetSampleInfos(trak->Media->information->sampleTable, k+1, &samp_offset, &chunk, &di, NULL);
@@ -27,6 +27,537 @@
 
 #ifndef GPAC_DISABLE_ISOM
 
+//lazy tables: tables with less entries are always parsed
+#define LAZY_MIN_ENTRIES	1024
+//number of entries fetched at once from lazy tables
+#define LAZY_WINDOW		4096
+
+GF_LazyTable *gf_isom_lazy_table_new(GF_Box *s, GF_BitStream *bs, u64 box_pos, u32 nb_entries, u32 entry_size)
+{
+	u64 pos, size;
+	GF_LazyTable *lt;
+	if (!(gf_bs_get_cookie(bs) & GF_ISOM_BS_COOKIE_LAZY_TABLES)) return NULL;
+	if (nb_entries < LAZY_MIN_ENTRIES) return NULL;
+	//let the parser report the error
+	size = (u64) nb_entries * entry_size;
+	if (size > s->size) return NULL;
+
+	GF_SAFEALLOC(lt, GF_LazyTable);
+	if (!lt) return NULL;
+	pos = gf_bs_get_position(bs);
+	lt->bs = bs;
+	lt->box_pos = box_pos;
+	lt->box_size = s->size + (pos - box_pos);
+	lt->entries_pos = pos;
+	gf_bs_skip_bytes(bs, size);
+	s->size -= size;
+	return lt;
+}
+
+void gf_isom_lazy_table_del(GF_LazyTable *lt)
+{
+	if (!lt) return;
+	if (lt->buf) gf_free(lt->buf);
+	gf_free(lt);
+}
+
+static GF_BitStream *lazy_table_bs(GF_LazyTable *lt)
+{
+	//the movie file map may be changed after parsing (file mapping)
+	if (lt->mov) return lt->mov->movieFileMap ? lt->mov->movieFileMap->bs : NULL;
+	return lt->bs;
+}
+
+//loads the window containing entry idx and returns the entry position in window, or -1 if error
+static s32 lazy_table_fetch(GF_Box *s, GF_LazyTable *lt, u32 idx, u32 nb_entries, u32 entry_size)
+{
+	u32 i, first, count, read;
+	u64 pos;
+	GF_BitStream *bs;
+
+	if (idx >= nb_entries) return -1;
+	if (lt->count && (idx >= lt->first) && (idx < lt->first + lt->count))
+		return idx - lt->first;
+
+	bs = lazy_table_bs(lt);
+	if (!bs) return -1;
+	if (!lt->buf) {
+		lt->buf = gf_malloc(LAZY_WINDOW * 8);
+		if (!lt->buf) return -1;
+	}
+	first = idx - idx % LAZY_WINDOW;
+	count = MIN(LAZY_WINDOW, nb_entries - first);
+
+	//tables are read from the movie file map which is shared with sample reading, restore position
+	pos = gf_bs_get_position(bs);
+	gf_bs_seek(bs, lt->entries_pos + (u64) first * entry_size);
+	read = gf_bs_read_data(bs, lt->buf, count * entry_size);
+	gf_bs_seek(bs, pos);
+	if (read != count * entry_size) {
+		lt->count = 0;
+		GF_LOG(GF_LOG_ERROR, GF_LOG_CONTAINER, ("[iso file] Failed to read %s entries %u to %u from file\n", gf_4cc_to_str(s->type), first, first+count-1));
+		return -1;
+	}
+	lt->first = first;
+	lt->count = count;
+
+	//convert in place to native endianness
+	if (s->type == GF_ISOM_BOX_TYPE_CO64) {
+		u64 *vals = (u64 *) lt->buf;
+		for (i=0; i<count; i++) {
+			u8 *p = lt->buf + 8*i;
+			vals[i] = ((u64) GF_4CC(p[0], p[1], p[2], p[3]) << 32) | GF_4CC(p[4], p[5], p[6], p[7]);
+		}
+	} else {
+		u32 *vals = (u32 *) lt->buf;
+		u32 nb_words = count * entry_size / 4;
+		for (i=0; i<nb_words; i++) {
+			u8 *p = lt->buf + 4*i;
+			vals[i] = GF_4CC(p[0], p[1], p[2], p[3]);
+		}
+	}
+
+	//same fixes as when parsing the box
+	if (s->type == GF_ISOM_BOX_TYPE_STTS) {
+		GF_SttsEntry *ents = (GF_SttsEntry *) lt->buf;
+		for (i=0; i<count; i++) {
+			if (ents[i].sampleDelta) continue;
+			if ((first+i+1 < nb_entries) || (ents[i].sampleCount>1))
+				ents[i].sampleDelta = 1;
+		}
+	} else if ((s->type == GF_ISOM_BOX_TYPE_CTTS) && !((GF_CompositionOffsetBox *)s)->version) {
+		GF_DttsEntry *ents = (GF_DttsEntry *) lt->buf;
+		for (i=0; i<count; i++) {
+			if (ents[i].decodingOffset <= INT_MIN) ents[i].decodingOffset = 0;
+		}
+	}
+	return idx - first;
+}
+
+GF_SttsEntry *stts_get_entry(GF_TimeToSampleBox *stts, u32 idx)
+{
+	s32 pos;
+	if (!stts->lazy) return (idx < stts->nb_entries) ? &stts->entries[idx] : NULL;
+	pos = lazy_table_fetch((GF_Box *) stts, stts->lazy, idx, stts->nb_entries, 8);
+	if (pos<0) return NULL;
+	return &((GF_SttsEntry *) stts->lazy->buf)[pos];
+}
+
+GF_DttsEntry *ctts_get_entry(GF_CompositionOffsetBox *ctts, u32 idx)
+{
+	s32 pos;
+	if (!ctts->lazy) return (idx < ctts->nb_entries) ? &ctts->entries[idx] : NULL;
+	pos = lazy_table_fetch((GF_Box *) ctts, ctts->lazy, idx, ctts->nb_entries, 8);
+	if (pos<0) return NULL;
+	return &((GF_DttsEntry *) ctts->lazy->buf)[pos];
+}
+
+GF_Err stbl_GetChunkOffset(GF_SampleTableBox *stbl, u32 chunkNumber, u64 *offset)
+{
+	s32 pos;
+	*offset = 0;
+	if (!chunkNumber || !stbl->ChunkOffset) return GF_ISOM_INVALID_FILE;
+
+	if (stbl->ChunkOffset->type == GF_ISOM_BOX_TYPE_STCO) {
+		GF_ChunkOffsetBox *stco = (GF_ChunkOffsetBox *)stbl->ChunkOffset;
+		if (stco->nb_entries < chunkNumber) return GF_ISOM_INVALID_FILE;
+		if (stco->lazy) {
+			pos = lazy_table_fetch((GF_Box *) stco, stco->lazy, chunkNumber-1, stco->nb_entries, 4);
+			if (pos<0) return GF_IO_ERR;
+			*offset = ((u32 *) stco->lazy->buf)[pos];
+			return GF_OK;
+		}
+		if (!stco->offsets) return GF_ISOM_INVALID_FILE;
+		*offset = (u64) stco->offsets[chunkNumber - 1];
+	} else {
+		GF_ChunkLargeOffsetBox *co64 = (GF_ChunkLargeOffsetBox *)stbl->ChunkOffset;
+		if (co64->nb_entries < chunkNumber) return GF_ISOM_INVALID_FILE;
+		if (co64->lazy) {
+			pos = lazy_table_fetch((GF_Box *) co64, co64->lazy, chunkNumber-1, co64->nb_entries, 8);
+			if (pos<0) return GF_IO_ERR;
+			*offset = ((u64 *) co64->lazy->buf)[pos];
+			return GF_OK;
+		}
+		if (!co64->offsets) return GF_ISOM_INVALID_FILE;
+		*offset = co64->offsets[chunkNumber - 1];
+	}
+	return GF_OK;
+}
+
+GF_Err gf_isom_box_lazy_load(GF_Box *s)
+{
+	GF_Err e;
+	u64 pos, size, cookie;
+	GF_LazyTable *lt, **p_lt;
+	GF_BitStream *bs;
+
+	if (!s) return GF_OK;
+	switch (s->type) {
+	case GF_ISOM_BOX_TYPE_STTS:
+		p_lt = &((GF_TimeToSampleBox *)s)->lazy;
+		if (*p_lt && (*p_lt)->stats_done) ((GF_TimeToSampleBox *)s)->max_ts_delta = 0;
+		break;
+	case GF_ISOM_BOX_TYPE_CTTS:
+		p_lt = &((GF_CompositionOffsetBox *)s)->lazy;
+		if (*p_lt && (*p_lt)->stats_done) {
+			((GF_CompositionOffsetBox *)s)->max_cts_delta = 0;
+			((GF_CompositionOffsetBox *)s)->min_neg_cts_offset = 0;
+		}
+		break;
+	case GF_ISOM_BOX_TYPE_STSZ:
+		p_lt = &((GF_SampleSizeBox *)s)->lazy;
+		if (*p_lt && (*p_lt)->stats_done) {
+			((GF_SampleSizeBox *)s)->max_size = 0;
+			((GF_SampleSizeBox *)s)->total_size = 0;
+			((GF_SampleSizeBox *)s)->total_samples = 0;
+		}
+		break;
+	case GF_ISOM_BOX_TYPE_STCO:
+		p_lt = &((GF_ChunkOffsetBox *)s)->lazy;
+		break;
+	case GF_ISOM_BOX_TYPE_CO64:
+		p_lt = &((GF_ChunkLargeOffsetBox *)s)->lazy;
+		break;
+	default:
+		return GF_OK;
+	}
+	lt = *p_lt;
+	if (!lt) return GF_OK;
+	bs = lazy_table_bs(lt);
+	if (!bs) return GF_IO_ERR;
+	*p_lt = NULL;
+
+	//parse the box payload again, without lazy mode
+	pos = gf_bs_get_position(bs);
+	cookie = gf_bs_get_cookie(bs);
+	size = s->size;
+	gf_bs_set_cookie(bs, cookie & ~GF_ISOM_BS_COOKIE_LAZY_TABLES);
+	gf_bs_seek(bs, lt->box_pos);
+	s->size = lt->box_size;
+	e = gf_isom_box_read(s, bs);
+	s->size = size;
+	gf_bs_set_cookie(bs, cookie);
+	gf_bs_seek(bs, pos);
+	gf_isom_lazy_table_del(lt);
+	if (e) {
+		GF_LOG(GF_LOG_ERROR, GF_LOG_CONTAINER, ("[iso file] Failed to load %s table: %s\n", gf_4cc_to_str(s->type), gf_error_to_string(e)));
+	}
+	return e;
+}
+
+GF_Err stbl_check_last_sample(GF_SampleTableBox *stbl)
+{
+	GF_Err e;
+	u64 sample_offset;
+	u32 di, chunk, size;
+	if (!stbl->SampleSize || !stbl->SampleSize->sampleCount) return GF_OK;
+	if (!stbl->TimeToSample || !stbl->SampleToChunk) return GF_ISOM_INVALID_FILE;
+
+	e = stbl_GetSampleInfos(stbl, stbl->SampleSize->sampleCount, &sample_offset, &chunk, &di, NULL);
+	if (e) return e;
+	e = stbl_GetSampleDTS(stbl->TimeToSample, stbl->SampleSize->sampleCount, &sample_offset);
+	if (e) return e;
+	return stbl_GetSampleSize(stbl->SampleSize, stbl->SampleSize->sampleCount, &size);
+}
+
+GF_Err gf_isom_lazy_tables_setup(GF_ISOFile *mov)
+{
+	u32 i, j;
+	if (!mov->moov) return GF_OK;
+
+	for (i=0; i<gf_list_count(mov->moov->trackList); i++) {
+		GF_TrackBox *trak = (GF_TrackBox *)gf_list_get(mov->moov->trackList, i);
+		GF_SampleTableBox *stbl;
+		Bool has_lazy = GF_FALSE;
+		GF_Err e;
+		GF_Box *boxes[4];
+		if (!trak->Media || !trak->Media->information || !trak->Media->information->sampleTable) continue;
+		stbl = trak->Media->information->sampleTable;
+		boxes[0] = (GF_Box *) stbl->TimeToSample;
+		boxes[1] = (GF_Box *) stbl->CompositionOffset;
+		boxes[2] = (GF_Box *) stbl->SampleSize;
+		boxes[3] = (GF_Box *) stbl->ChunkOffset;
+
+		for (j=0; j<4; j++) {
+			GF_LazyTable *lt = NULL;
+			if (!boxes[j]) continue;
+			switch (boxes[j]->type) {
+			case GF_ISOM_BOX_TYPE_STTS: lt = ((GF_TimeToSampleBox *)boxes[j])->lazy; break;
+			case GF_ISOM_BOX_TYPE_CTTS: lt = ((GF_CompositionOffsetBox *)boxes[j])->lazy; break;
+			case GF_ISOM_BOX_TYPE_STSZ: lt = ((GF_SampleSizeBox *)boxes[j])->lazy; break;
+			case GF_ISOM_BOX_TYPE_STCO: lt = ((GF_ChunkOffsetBox *)boxes[j])->lazy; break;
+			case GF_ISOM_BOX_TYPE_CO64: lt = ((GF_ChunkLargeOffsetBox *)boxes[j])->lazy; break;
+			}
+			if (!lt) continue;
+			has_lazy = GF_TRUE;
+#ifndef GPAC_DISABLE_ISOM_FRAGMENTS
+			//tables of fragmented files are modified when merging fragments, load them
+			if (mov->moov->mvex) {
+				e = gf_isom_box_lazy_load(boxes[j]);
+				if (e) return e;
+				continue;
+			}
+#endif
+			lt->mov = mov;
+			lt->bs = NULL;
+		}
+		//safety check skipped when parsing the sample table
+		if (has_lazy) {
+			e = stbl_check_last_sample(stbl);
+			if (e) {
+				GF_LOG(GF_LOG_ERROR, GF_LOG_CONTAINER, ("[iso file] Invalid sample table for track %u: %s\n", i+1, gf_error_to_string(e)));
+				return e;
+			}
+		}
+	}
+	return GF_OK;
+}
+
+void stbl_lazy_stats(GF_SampleTableBox *stbl)
+{
+	u32 i;
+	if (stbl->SampleSize && stbl->SampleSize->lazy && !stbl->SampleSize->lazy->stats_done) {
+		GF_SampleSizeBox *stsz = stbl->SampleSize;
+		stsz->lazy->stats_done = GF_TRUE;
+		for (i=0; i<stsz->sampleCount; i++) {
+			u32 size;
+			s32 pos = lazy_table_fetch((GF_Box *) stsz, stsz->lazy, i, stsz->sampleCount, 4);
+			if (pos<0) break;
+			size = ((u32 *) stsz->lazy->buf)[pos];
+			if (stsz->max_size < size) stsz->max_size = size;
+			stsz->total_size += size;
+			stsz->total_samples++;
+		}
+	}
+	if (stbl->TimeToSample && stbl->TimeToSample->lazy && !stbl->TimeToSample->lazy->stats_done) {
+		GF_TimeToSampleBox *stts = stbl->TimeToSample;
+		stts->lazy->stats_done = GF_TRUE;
+		for (i=0; i<stts->nb_entries; i++) {
+			GF_SttsEntry *ent = stts_get_entry(stts, i);
+			if (!ent) break;
+			if (stts->max_ts_delta < ent->sampleDelta)
+				stts->max_ts_delta = ent->sampleDelta;
+		}
+	}
+	if (stbl->CompositionOffset && stbl->CompositionOffset->lazy && !stbl->CompositionOffset->lazy->stats_done) {
+		GF_CompositionOffsetBox *ctts = stbl->CompositionOffset;
+		ctts->lazy->stats_done = GF_TRUE;
+		for (i=0; i<ctts->nb_entries; i++) {
+			GF_DttsEntry *ent = ctts_get_entry(ctts, i);
+			if (!ent) break;
+			if (!ctts->version && (ent->decodingOffset < ctts->min_neg_cts_offset))
+				ctts->min_neg_cts_offset = ent->decodingOffset;
+
+			if (ent->decodingOffset == INT_MIN) {
+				ctts->max_cts_delta = INT_MAX;
+			} else if (ctts->max_cts_delta <= ABS(ent->decodingOffset)) {
+				ctts->max_cts_delta = ABS(ent->decodingOffset);
+			}
+		}
+	}
+}
+
+//tables with less entries are walked linearly
+#define STBL_INDEX_MIN_ENTRIES	64
+
+static GF_SampleTableIndex *stbl_index_new(u32 nb_entries, u32 entry_size, u32 *budget)
+{
+	u64 max_entries;
+	GF_SampleTableIndex *idx;
+	if (nb_entries < STBL_INDEX_MIN_ENTRIES) return NULL;
+
+	max_entries = *budget / entry_size;
+	if (max_entries < nb_entries) {
+		GF_LOG(GF_LOG_INFO, GF_LOG_CONTAINER, ("[iso file] Sample table with %u entries exceeds random access index budget, using linear lookup\n", nb_entries));
+		return NULL;
+	}
+	//leave some room for entries appended by fragments
+	if (max_entries > 2 * (u64) nb_entries) max_entries = 2 * (u64) nb_entries;
+
+	GF_SAFEALLOC(idx, GF_SampleTableIndex);
+	if (!idx) return NULL;
+	idx->max_entries = (u32) max_entries;
+	*budget -= (u32) max_entries * entry_size;
+	return idx;
+}
+
+void stbl_index_del(GF_SampleTableIndex *idx)
+{
+	if (!idx) return;
+	if (idx->first_sample) gf_free(idx->first_sample);
+	if (idx->first_dts) gf_free(idx->first_dts);
+	gf_free(idx);
+}
+
+void stbl_index_setup(GF_SampleTableBox *stbl)
+{
+	u32 budget;
+	if (!stbl || stbl->r_index_init) return;
+	stbl->r_index_init = GF_TRUE;
+
+	budget = gf_opts_get_int("core", "stbl-index");
+	if (!budget) return;
+	budget = (budget > 0x3FFFFF) ? 0xFFFFFFFF : budget * 1024;
+
+	if (stbl->TimeToSample && !stbl->TimeToSample->r_index)
+		stbl->TimeToSample->r_index = stbl_index_new(stbl->TimeToSample->nb_entries, sizeof(u32) + sizeof(u64), &budget);
+	if (stbl->SampleToChunk && !stbl->SampleToChunk->r_index && stbl->SampleSize
+		&& (stbl->SampleToChunk->nb_entries != stbl->SampleSize->sampleCount)
+	)
+		stbl->SampleToChunk->r_index = stbl_index_new(stbl->SampleToChunk->nb_entries, sizeof(u32), &budget);
+	if (stbl->CompositionOffset && !stbl->CompositionOffset->r_index)
+		stbl->CompositionOffset->r_index = stbl_index_new(stbl->CompositionOffset->nb_entries, sizeof(u32), &budget);
+}
+
+void stbl_index_reset(GF_SampleTableBox *stbl)
+{
+	if (stbl->TimeToSample && stbl->TimeToSample->r_index)
+		stbl->TimeToSample->r_index->nb_entries = 0;
+	if (stbl->SampleToChunk && stbl->SampleToChunk->r_index)
+		stbl->SampleToChunk->r_index->nb_entries = 0;
+	if (stbl->CompositionOffset && stbl->CompositionOffset->r_index)
+		stbl->CompositionOffset->r_index->nb_entries = 0;
+}
+
+//make sure the index can hold nb_entries, disables the index if over budget
+static Bool stbl_index_realloc(GF_SampleTableIndex *idx, u32 nb_entries, Bool with_dts)
+{
+	if (idx->disabled || !nb_entries) return GF_FALSE;
+	if (nb_entries > idx->max_entries) {
+		GF_LOG(GF_LOG_INFO, GF_LOG_CONTAINER, ("[iso file] Sample table grew to %u entries, exceeds random access index budget, using linear lookup\n", nb_entries));
+		idx->disabled = GF_TRUE;
+		idx->nb_entries = idx->alloc_entries = 0;
+		if (idx->first_sample) gf_free(idx->first_sample);
+		if (idx->first_dts) gf_free(idx->first_dts);
+		idx->first_sample = NULL;
+		idx->first_dts = NULL;
+		return GF_FALSE;
+	}
+	if (nb_entries <= idx->alloc_entries) return GF_TRUE;
+
+	u32 *first_sample = gf_realloc(idx->first_sample, sizeof(u32) * nb_entries);
+	if (first_sample) idx->first_sample = first_sample;
+	if (first_sample && with_dts) {
+		u64 *first_dts = gf_realloc(idx->first_dts, sizeof(u64) * nb_entries);
+		if (first_dts) idx->first_dts = first_dts;
+		else first_sample = NULL;
+	}
+	//out of memory, disable index
+	if (!first_sample) {
+		idx->max_entries = 0;
+		return stbl_index_realloc(idx, nb_entries, with_dts);
+	}
+	idx->alloc_entries = nb_entries;
+	return GF_TRUE;
+}
+
+//get the last indexed entry starting at or before the given sample - entry 0 always starts at sample 1
+static u32 stbl_index_find_sample(GF_SampleTableIndex *idx, u32 sampleNumber)
+{
+	u32 lo = 0, hi = idx->nb_entries;
+	while (hi - lo > 1) {
+		u32 mid = (lo + hi) / 2;
+		if (idx->first_sample[mid] <= sampleNumber) lo = mid;
+		else hi = mid;
+	}
+	return lo;
+}
+
+//tables are only appended to in read mode, so indexing resumes from the last indexed entry whose sample count may have changed
+static Bool stts_index_update(GF_TimeToSampleBox *stts)
+{
+	u32 i;
+	GF_SampleTableIndex *idx = stts->r_index;
+	if (idx->nb_entries > stts->nb_entries) idx->nb_entries = 0;
+	else if (idx->nb_entries && (idx->nb_entries == stts->nb_entries)) return GF_TRUE;
+	if (!stbl_index_realloc(idx, stts->nb_entries, GF_TRUE)) return GF_FALSE;
+
+	if (!idx->nb_entries) {
+		idx->first_sample[0] = 1;
+		idx->first_dts[0] = 0;
+		idx->nb_entries = 1;
+	}
+	for (i=idx->nb_entries; i<stts->nb_entries; i++) {
+		GF_SttsEntry *ent = stts_get_entry(stts, i-1);
+		u64 next;
+		if (!ent) {
+			idx->nb_entries = 0;
+			return GF_FALSE;
+		}
+		next = (u64) idx->first_sample[i-1] + ent->sampleCount;
+		//broken table, don't index
+		if (next > 0xFFFFFFFFUL) {
+			idx->nb_entries = 0;
+			return GF_FALSE;
+		}
+		idx->first_sample[i] = (u32) next;
+		idx->first_dts[i] = idx->first_dts[i-1] + (u64) ent->sampleCount * ent->sampleDelta;
+	}
+	idx->nb_entries = stts->nb_entries;
+	return GF_TRUE;
+}
+
+static Bool ctts_index_update(GF_CompositionOffsetBox *ctts)
+{
+	u32 i;
+	GF_SampleTableIndex *idx = ctts->r_index;
+	if (idx->nb_entries > ctts->nb_entries) idx->nb_entries = 0;
+	else if (idx->nb_entries && (idx->nb_entries == ctts->nb_entries)) return GF_TRUE;
+	if (!stbl_index_realloc(idx, ctts->nb_entries, GF_FALSE)) return GF_FALSE;
+
+	if (!idx->nb_entries) {
+		idx->first_sample[0] = 1;
+		idx->nb_entries = 1;
+	}
+	for (i=idx->nb_entries; i<ctts->nb_entries; i++) {
+		GF_DttsEntry *ent = ctts_get_entry(ctts, i-1);
+		u64 next;
+		if (!ent) {
+			idx->nb_entries = 0;
+			return GF_FALSE;
+		}
+		next = (u64) idx->first_sample[i-1] + ent->sampleCount;
+		if (next > 0xFFFFFFFFUL) {
+			idx->nb_entries = 0;
+			return GF_FALSE;
+		}
+		idx->first_sample[i] = (u32) next;
+	}
+	idx->nb_entries = ctts->nb_entries;
+	return GF_TRUE;
+}
+
+void GetGhostNum(GF_StscEntry *ent, u32 EntryIndex, u32 count, GF_SampleTableBox *stbl);
+
+//note: this modifies stsc->ghostNumber, callers must refresh it
+static Bool stsc_index_update(GF_SampleTableBox *stbl)
+{
+	u32 i;
+	GF_SampleToChunkBox *stsc = stbl->SampleToChunk;
+	GF_SampleTableIndex *idx = stsc->r_index;
+	if (idx->nb_entries > stsc->nb_entries) idx->nb_entries = 0;
+	else if (idx->nb_entries && (idx->nb_entries == stsc->nb_entries)) return GF_TRUE;
+	if (!stbl_index_realloc(idx, stsc->nb_entries, GF_FALSE)) return GF_FALSE;
+
+	if (!idx->nb_entries) {
+		idx->first_sample[0] = 1;
+		idx->nb_entries = 1;
+	}
+	for (i=idx->nb_entries; i<stsc->nb_entries; i++) {
+		GF_StscEntry *ent = &stsc->entries[i-1];
+		u64 next;
+		GetGhostNum(ent, i-1, stsc->nb_entries, stbl);
+		next = (u64) idx->first_sample[i-1] + (u64) stsc->ghostNumber * ent->samplesPerChunk;
+		if (next > 0xFFFFFFFFUL) {
+			idx->nb_entries = 0;
+			return GF_FALSE;
+		}
+		idx->first_sample[i] = (u32) next;
+	}
+	idx->nb_entries = stsc->nb_entries;
+	return GF_TRUE;
+}
+
 //Get the sample number
 GF_Err stbl_findEntryForTime(GF_SampleTableBox *stbl, u64 DTS, u8 useCTS, u32 *sampleNumber, u32 *prevSampleNumber)
 {
@@ -84,22 +615,49 @@ GF_Err stbl_findEntryForTime(GF_SampleTableBox *stbl, u64 DTS, u8 useCTS, u32 *s
 	}
 #endif
 
-	//look for the DTS from this entry
 	count = stbl->TimeToSample->nb_entries;
-	for (; i<count; i++) {
-		ent = &stbl->TimeToSample->entries[i];
-#if 0
-		if (useCTS) {
-			stbl_GetSampleCTS(stbl->CompositionOffset, curSampNum, &CTSOffset);
-		} else
-#endif
-		{
-			CTSOffset = 0;
+
+	//random access: the DTS is neither in the cached entry nor in the next one, use the index
+	if (stbl->TimeToSample->r_index && (i<count)) {
+		GF_TimeToSampleBox *stts = stbl->TimeToSample;
+		u64 last_dts = curDTS;
+		//entries may come from a lazy table window, don't keep pointers
+		ent = stts_get_entry(stts, i);
+		if (ent) last_dts += (u64) ent->sampleCount * ent->sampleDelta;
+		ent = (i+1<count) ? stts_get_entry(stts, i+1) : NULL;
+		if (ent) last_dts += (u64) ent->sampleCount * ent->sampleDelta;
+
+		if ((DTS > last_dts) && stts_index_update(stts)) {
+			GF_SampleTableIndex *idx = stts->r_index;
+			//last entry starting strictly before DTS
+			u32 lo = 0, hi = idx->nb_entries;
+			while (hi - lo > 1) {
+				u32 mid = (lo + hi) / 2;
+				if (idx->first_dts[mid] < DTS) lo = mid;
+				else hi = mid;
+			}
+			i = stts->r_currentEntryIndex = lo;
+			curDTS = stts->r_CurrentDTS = idx->first_dts[lo];
+			curSampNum = stts->r_FirstSampleInEntry = idx->first_sample[lo];
 		}
-		for (j=0; j<ent->sampleCount; j++) {
-			if (curDTS + CTSOffset >= DTS) goto entry_found;
-			curSampNum += 1;
-			curDTS += ent->sampleDelta;
+	}
+
+	//look for the DTS from this entry
+	CTSOffset = 0;
+	for (; i<count; i++) {
+		ent = stts_get_entry(stbl->TimeToSample, i);
+		if (!ent) return GF_ISOM_INVALID_FILE;
+		if (ent->sampleCount) {
+			//first sample in entry with DTS greater than or equal to the target
+			if (curDTS >= DTS) j = 0;
+			else if (!ent->sampleDelta) j = ent->sampleCount;
+			else {
+				u64 nb_samp = (DTS - curDTS + ent->sampleDelta - 1) / ent->sampleDelta;
+				j = (nb_samp < ent->sampleCount) ? (u32) nb_samp : ent->sampleCount;
+			}
+			curSampNum += j;
+			curDTS += (u64) j * ent->sampleDelta;
+			if (j < ent->sampleCount) goto entry_found;
 		}
 		//we're switching to the next entry, update the cache!
 		stbl->TimeToSample->r_CurrentDTS += (u64)ent->sampleCount * ent->sampleDelta;
@@ -138,6 +696,10 @@ GF_Err stbl_GetSampleSize(GF_SampleSizeBox *stsz, u32 SampleNumber, u32 *Size)
 		(*Size) = stsz->sampleSize;
 	} else if (stsz->sizes) {
 		(*Size) = stsz->sizes[SampleNumber - 1];
+	} else if (stsz->lazy) {
+		s32 pos = lazy_table_fetch((GF_Box *) stsz, stsz->lazy, SampleNumber - 1, stsz->sampleCount, 4);
+		if (pos<0) return GF_IO_ERR;
+		(*Size) = ((u32 *) stsz->lazy->buf)[pos];
 	} else {
 		(*Size) = 0;
 	}
@@ -150,6 +712,7 @@ GF_Err stbl_GetSampleSize(GF_SampleSizeBox *stsz, u32 SampleNumber, u32 *Size)
 GF_Err stbl_GetSampleCTS(GF_CompositionOffsetBox *ctts, u32 SampleNumber, s32 *CTSoffset)
 {
 	u32 i;
+	GF_DttsEntry *ent;
 
 	(*CTSoffset) = 0;
 	//test on SampleNumber is done before
@@ -162,17 +725,34 @@ GF_Err stbl_GetSampleCTS(GF_CompositionOffsetBox *ctts, u32 SampleNumber, s32 *C
 		ctts->r_currentEntryIndex = 0;
 		i = 0;
 	}
+	//random access: the sample is neither in the cached entry nor in the next one, use the index
+	if (ctts->r_index && (i < ctts->nb_entries)) {
+		u64 last = ctts->r_FirstSampleInEntry;
+		ent = ctts_get_entry(ctts, i);
+		if (ent) last += ent->sampleCount;
+		ent = (i+1 < ctts->nb_entries) ? ctts_get_entry(ctts, i+1) : NULL;
+		if (ent) last += ent->sampleCount;
+
+		if ((SampleNumber >= last) && ctts_index_update(ctts)) {
+			i = stbl_index_find_sample(ctts->r_index, SampleNumber);
+			ctts->r_currentEntryIndex = i;
+			ctts->r_FirstSampleInEntry = ctts->r_index->first_sample[i];
+		}
+	}
+	ent = NULL;
 	for (; i< ctts->nb_entries; i++) {
-		if (SampleNumber < ctts->r_FirstSampleInEntry + ctts->entries[i].sampleCount) break;
+		ent = ctts_get_entry(ctts, i);
+		if (!ent) return GF_ISOM_INVALID_FILE;
+		if (SampleNumber < ctts->r_FirstSampleInEntry + ent->sampleCount) break;
 		//update our cache
 		ctts->r_currentEntryIndex += 1;
-		ctts->r_FirstSampleInEntry += ctts->entries[i].sampleCount;
+		ctts->r_FirstSampleInEntry += ent->sampleCount;
 	}
 	//no ent, set everything to 0...
-	if (i==ctts->nb_entries) return GF_OK;
+	if (!ent || (i==ctts->nb_entries)) return GF_OK;
 	/*asked for a sample not in table - this means CTTS is 0 (that's due to out internal packing construction of CTTS)*/
-	if (SampleNumber >= ctts->r_FirstSampleInEntry + ctts->entries[i].sampleCount) return GF_OK;
-	(*CTSoffset) = ctts->entries[i].decodingOffset;
+	if (SampleNumber >= ctts->r_FirstSampleInEntry + ent->sampleCount) return GF_OK;
+	(*CTSoffset) = ent->decodingOffset;
 	return GF_OK;
 }
 
@@ -203,8 +783,26 @@ GF_Err stbl_GetSampleDTS_and_Duration(GF_TimeToSampleBox *stts, u32 SampleNumber
 		stts->r_CurrentDTS = 0;
 	}
 
+	//random access: the sample is neither in the cached entry nor in the next one, use the index
+	if (stts->r_index && (i<count)) {
+		u64 last = stts->r_FirstSampleInEntry;
+		ent = stts_get_entry(stts, i);
+		if (ent) last += ent->sampleCount;
+		ent = (i+1<count) ? stts_get_entry(stts, i+1) : NULL;
+		if (ent) last += ent->sampleCount;
+		ent = NULL;
+
+		if ((SampleNumber >= last) && stts_index_update(stts)) {
+			i = stbl_index_find_sample(stts->r_index, SampleNumber);
+			stts->r_currentEntryIndex = i;
+			stts->r_FirstSampleInEntry = stts->r_index->first_sample[i];
+			stts->r_CurrentDTS = stts->r_index->first_dts[i];
+		}
+	}
+
 	for (; i < count; i++) {
-		ent = &stts->entries[i];
+		ent = stts_get_entry(stts, i);
+		if (!ent) return GF_ISOM_INVALID_FILE;
 
 		//in our entry
 		if (ent->sampleCount + stts->r_FirstSampleInEntry >= 1 + SampleNumber) {
@@ -403,8 +1001,6 @@ GF_Err stbl_GetSampleInfos(GF_SampleTableBox *stbl, u32 sampleNumber, u64 *offse
 {
 	GF_Err e;
 	u32 i, k, offsetInChunk, size, chunk_num;
-	GF_ChunkOffsetBox *stco;
-	GF_ChunkLargeOffsetBox *co64;
 	GF_StscEntry *ent;
 
 	(*offset) = 0;
@@ -419,20 +1015,7 @@ GF_Err stbl_GetSampleInfos(GF_SampleTableBox *stbl, u32 sampleNumber, u64 *offse
 		(*descIndex) = ent->sampleDescriptionIndex;
 		(*chunkNumber) = sampleNumber;
 		if (out_ent) *out_ent = ent;
-		if ( stbl->ChunkOffset->type == GF_ISOM_BOX_TYPE_STCO) {
-			stco = (GF_ChunkOffsetBox *)stbl->ChunkOffset;
-			if (!stco->offsets) return GF_ISOM_INVALID_FILE;
-			if (stco->nb_entries < sampleNumber) return GF_ISOM_INVALID_FILE;
-
-			(*offset) = (u64) stco->offsets[sampleNumber - 1];
-		} else {
-			co64 = (GF_ChunkLargeOffsetBox *)stbl->ChunkOffset;
-			if (!co64->offsets) return GF_ISOM_INVALID_FILE;
-			if (co64->nb_entries < sampleNumber) return GF_ISOM_INVALID_FILE;
-
-			(*offset) = co64->offsets[sampleNumber - 1];
-		}
-		return GF_OK;
+		return stbl_GetChunkOffset(stbl, sampleNumber, offset);
 	}
 
 	//check our cache: if desired sample is at or above current cache entry, start from here
@@ -456,6 +1039,25 @@ GF_Err stbl_GetSampleInfos(GF_SampleTableBox *stbl, u32 sampleNumber, u64 *offse
 		k = stbl->SampleToChunk->currentChunk;
 	}
 
+	//random access: the sample is neither in the cached entry nor in the next one, use the index
+	if (stbl->SampleToChunk->r_index && (i+1 < stbl->SampleToChunk->nb_entries)) {
+		GF_SampleToChunkBox *stsc = stbl->SampleToChunk;
+		u64 last = (u64) stsc->firstSampleInCurrentChunk + (u64) (stsc->ghostNumber + 1 - k) * ent->samplesPerChunk;
+		if (i+2 < stsc->nb_entries)
+			last += (u64) (stsc->entries[i+2].firstChunk - stsc->entries[i+1].firstChunk) * stsc->entries[i+1].samplesPerChunk;
+
+		if ((sampleNumber >= last) && stsc_index_update(stbl)) {
+			i = stbl_index_find_sample(stsc->r_index, sampleNumber);
+			stsc->currentIndex = i;
+			stsc->currentChunk = 1;
+			stsc->firstSampleInCurrentChunk = stsc->r_index->first_sample[i];
+			ent = &stsc->entries[i];
+			k = 1;
+		}
+		//refresh ghost number, modified by index update
+		GetGhostNum(ent, i, stsc->nb_entries, stbl);
+	}
+
 	//first get the chunk
 	for (; i < stbl->SampleToChunk->nb_entries; i++) {
 		gf_assert(stbl->SampleToChunk->firstSampleInCurrentChunk <= sampleNumber);
@@ -533,15 +1135,9 @@ sample_found:
 	}
 	//OK, that's the size of our offset in the chunk
 	//now get the chunk
-	if ( stbl->ChunkOffset->type == GF_ISOM_BOX_TYPE_STCO) {
-		stco = (GF_ChunkOffsetBox *)stbl->ChunkOffset;
-		if (stco->nb_entries < (*chunkNumber) ) return GF_ISOM_INVALID_FILE;
-		(*offset) = (u64) stco->offsets[(*chunkNumber) - 1] + (u64) offsetInChunk;
-	} else {
-		co64 = (GF_ChunkLargeOffsetBox *)stbl->ChunkOffset;
-		if (co64->nb_entries < (*chunkNumber) ) return GF_ISOM_INVALID_FILE;
-		(*offset) = co64->offsets[(*chunkNumber) - 1] + (u64) offsetInChunk;
-	}
+	e = stbl_GetChunkOffset(stbl, *chunkNumber, offset);
+	if (e) return e;
+	(*offset) += (u64) offsetInChunk;
 	return GF_OK;
 }
 
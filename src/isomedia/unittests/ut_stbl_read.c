@@ -0,0 +1,240 @@
+#include "tests.h"
+#include <gpac/isomedia.h>
+#include <gpac/internal/isomedia_dev.h>
+
+#define STBL_TEST_FILE	"ut_stbl_read.mp4"
+#define STBL_TEST_SAMPLES	5000
+#define STBL_TEST_LOOKUPS	20000
+
+static u32 stbl_test_rand(u32 *seed)
+{
+	*seed = (*seed) * 1103515245 + 12345;
+	return (*seed >> 8) & 0xFFFFFF;
+}
+
+//random runs of durations, CTS offsets and sample descriptions, so that stts, ctts and stsc get many entries of varying length
+static Bool stbl_test_create(u32 seed, u64 *duration)
+{
+	u32 i, track, di1, di2;
+	u32 dur_run=0, cts_run=0, di_run=0, dur=0, cts=0, di=0;
+	u8 data[4];
+	GF_GenericSampleDescription udesc;
+	GF_ISOSample samp;
+	GF_ISOFile *mov = gf_isom_open(STBL_TEST_FILE, GF_ISOM_OPEN_WRITE, NULL);
+	if (!mov) return GF_FALSE;
+	track = gf_isom_new_track(mov, 1, GF_ISOM_MEDIA_VISUAL, 1000);
+	gf_isom_set_track_enabled(mov, track, GF_TRUE);
+	memset(&udesc, 0, sizeof(GF_GenericSampleDescription));
+	udesc.codec_tag = GF_4CC('u','t','s','t');
+	udesc.width = 320;
+	udesc.height = 240;
+	gf_isom_new_generic_sample_description(mov, track, NULL, NULL, &udesc, &di1);
+	gf_isom_new_generic_sample_description(mov, track, NULL, NULL, &udesc, &di2);
+
+	memset(&samp, 0, sizeof(GF_ISOSample));
+	samp.data = data;
+	for (i=0; i<STBL_TEST_SAMPLES; i++) {
+		if (!dur_run) {
+			dur_run = 1 + stbl_test_rand(&seed) % 6;
+			dur = 1 + stbl_test_rand(&seed) % 50;
+		}
+		if (!cts_run) {
+			cts_run = 1 + stbl_test_rand(&seed) % 4;
+			cts = stbl_test_rand(&seed) % 200;
+		}
+		if (!di_run) {
+			di_run = 1 + stbl_test_rand(&seed) % 10;
+			di = (di==di1) ? di2 : di1;
+		}
+		dur_run--;
+		cts_run--;
+		di_run--;
+		samp.dataLength = 1 + stbl_test_rand(&seed) % 4;
+		samp.IsRAP = (stbl_test_rand(&seed) % 8) ? RAP_NO : SAP_TYPE_1;
+		samp.CTS_Offset = cts;
+		gf_isom_add_sample(mov, track, di, &samp);
+		samp.DTS += dur;
+	}
+	*duration = samp.DTS;
+	return (gf_isom_close(mov)==GF_OK) ? GF_TRUE : GF_FALSE;
+}
+
+//the run-length index must give the same results as the linear lookup, for any access pattern
+unittest(stbl_index_random_access)
+{
+	u32 i, seed = 0x5747BEEF, nb_diff = 0;
+	u64 duration=0;
+	GF_ISOFile *lin, *idx;
+	GF_TrackBox *trak;
+
+	//in-memory config for the stbl-index option
+	gf_sys_init(GF_MemTrackerNone, "0");
+	assert_true(stbl_test_create(seed, &duration));
+
+	lin = gf_isom_open(STBL_TEST_FILE, GF_ISOM_OPEN_READ, NULL);
+	idx = gf_isom_open(STBL_TEST_FILE, GF_ISOM_OPEN_READ, NULL);
+	assert_true(lin && idx);
+	if (!lin || !idx) {
+		gf_isom_close(lin);
+		gf_isom_close(idx);
+		gf_sys_close();
+		return;
+	}
+	assert_equal(gf_isom_get_sample_count(lin, 1), STBL_TEST_SAMPLES);
+
+	//the index is set up on first access
+	gf_opts_set_key("core", "stbl-index", "0");
+	gf_isom_get_sample_info(lin, 1, 1, NULL, NULL);
+	gf_opts_set_key("core", "stbl-index", NULL);
+	gf_isom_get_sample_info(idx, 1, 1, NULL, NULL);
+
+	trak = gf_list_get(lin->moov->trackList, 0);
+	assert_true(!trak->Media->information->sampleTable->TimeToSample->r_index);
+	trak = gf_list_get(idx->moov->trackList, 0);
+	assert_not_null(trak->Media->information->sampleTable->TimeToSample->r_index);
+	assert_not_null(trak->Media->information->sampleTable->CompositionOffset->r_index);
+	assert_not_null(trak->Media->information->sampleTable->SampleToChunk->r_index);
+
+	for (i=0; i<STBL_TEST_LOOKUPS; i++) {
+		u32 type = stbl_test_rand(&seed) % 4;
+		if (type < 2) {
+			u32 di_l=0, di_i=0;
+			u64 offset_l=0, offset_i=0;
+			GF_ISOSample *s_l, *s_i;
+			//random access, or a short sequential read
+			u32 num = 1 + stbl_test_rand(&seed) % STBL_TEST_SAMPLES;
+			u32 nb_seq = type ? 1 : 1 + stbl_test_rand(&seed) % 20;
+			for (; nb_seq && (num<=STBL_TEST_SAMPLES); nb_seq--, num++) {
+				s_l = gf_isom_get_sample_info(lin, 1, num, &di_l, &offset_l);
+				s_i = gf_isom_get_sample_info(idx, 1, num, &di_i, &offset_i);
+				if (!s_l || !s_i || (s_l->DTS != s_i->DTS) || (s_l->CTS_Offset != s_i->CTS_Offset)
+					|| (s_l->IsRAP != s_i->IsRAP) || (s_l->dataLength != s_i->dataLength)
+					|| (di_l != di_i) || (offset_l != offset_i)
+				) {
+					nb_diff++;
+				}
+				if (s_l) gf_isom_sample_del(&s_l);
+				if (s_i) gf_isom_sample_del(&s_i);
+			}
+		} else if (type == 2) {
+			u64 dts = stbl_test_rand(&seed) % (duration + 100);
+			if (gf_isom_get_sample_from_dts(lin, 1, dts) != gf_isom_get_sample_from_dts(idx, 1, dts))
+				nb_diff++;
+		} else {
+			u32 num_l=0, num_i=0;
+			GF_Err e_l, e_i;
+			u64 time = stbl_test_rand(&seed) % (duration + 100);
+			GF_ISOSearchMode mode = (GF_ISOSearchMode) (1 + stbl_test_rand(&seed) % 5);
+			e_l = gf_isom_get_sample_for_media_time(lin, 1, time, NULL, mode, NULL, &num_l, NULL);
+			e_i = gf_isom_get_sample_for_media_time(idx, 1, time, NULL, mode, NULL, &num_i, NULL);
+			if ((e_l != e_i) || (num_l != num_i))
+				nb_diff++;
+		}
+	}
+	assert_equal(nb_diff, 0);
+
+	gf_isom_close(lin);
+	gf_isom_close(idx);
+	gf_file_delete(STBL_TEST_FILE);
+	gf_sys_close();
+}
+
+#define LAZY_TEST_FILE	"ut_stbl_lazy.mp4"
+#define LAZY_TEST_SAMPLES	3000
+
+static Bool lazy_test_create(u64 *data_size)
+{
+	u32 i, track, di;
+	u8 data[8];
+	GF_GenericSampleDescription udesc;
+	GF_ISOSample samp;
+	GF_ISOFile *mov = gf_isom_open(LAZY_TEST_FILE, GF_ISOM_OPEN_WRITE, NULL);
+	if (!mov) return GF_FALSE;
+	track = gf_isom_new_track(mov, 1, GF_ISOM_MEDIA_VISUAL, 1000);
+	gf_isom_set_track_enabled(mov, track, GF_TRUE);
+	memset(&udesc, 0, sizeof(GF_GenericSampleDescription));
+	udesc.codec_tag = GF_4CC('u','t','s','t');
+	gf_isom_new_generic_sample_description(mov, track, NULL, NULL, &udesc, &di);
+	memset(&samp, 0, sizeof(GF_ISOSample));
+	memset(data, 0, 8);
+	samp.data = data;
+	samp.IsRAP = SAP_TYPE_1;
+	*data_size = 0;
+	for (i=0; i<LAZY_TEST_SAMPLES; i++) {
+		samp.dataLength = 1 + i%8;
+		samp.DTS = i*10;
+		gf_isom_add_sample(mov, track, di, &samp);
+		*data_size += samp.dataLength;
+	}
+	return (gf_isom_close(mov)==GF_OK) ? GF_TRUE : GF_FALSE;
+}
+
+//overwrites size bytes of the first full box of the given type, starting skip bytes after its version and flags
+static Bool lazy_test_patch(u32 box_type, u32 skip, u32 size, u8 val)
+{
+	u32 i, file_size;
+	Bool found = GF_FALSE;
+	u8 *buf;
+	if (gf_file_load_data(LAZY_TEST_FILE, &buf, &file_size) != GF_OK) return GF_FALSE;
+	for (i=4; i+8+skip+size<=file_size; i++) {
+		if (GF_4CC(buf[i], buf[i+1], buf[i+2], buf[i+3]) != box_type) continue;
+		memset(buf + i + 8 + skip, val, size);
+		found = GF_TRUE;
+		break;
+	}
+	if (found) {
+		FILE *f = gf_fopen(LAZY_TEST_FILE, "wb");
+		if (!f || (gf_fwrite(buf, file_size, f) != file_size)) found = GF_FALSE;
+		if (f) gf_fclose(f);
+	}
+	gf_free(buf);
+	return found;
+}
+
+static GF_Err lazy_test_open(Bool lazy, u64 *data_size)
+{
+	GF_Err e;
+	u64 missing;
+	GF_ISOFile *mov = NULL;
+	if (lazy) e = gf_isom_open_progressive_lazy(LAZY_TEST_FILE, 0, 0, GF_FALSE, &mov, &missing);
+	else e = gf_isom_open_progressive(LAZY_TEST_FILE, 0, 0, GF_FALSE, &mov, &missing);
+	if (!e && mov) {
+		GF_TrackBox *trak = gf_list_get(mov->moov->trackList, 0);
+		//the sample size table must be lazy for the test to be meaningful
+		if (lazy && !trak->Media->information->sampleTable->SampleSize->lazy) e = GF_BAD_PARAM;
+		*data_size = gf_isom_get_media_data_size(mov, 1);
+	}
+	if (mov) gf_isom_close(mov);
+	return e;
+}
+
+//lazy sample size tables must behave as loaded ones for media data size and table sanity checks
+unittest(stbl_lazy_stsz)
+{
+	u64 size, lazy_size, ref_size=0;
+	GF_Err e, lazy_e;
+
+	assert_true(lazy_test_create(&ref_size));
+	size = lazy_size = 0;
+	assert_equal(lazy_test_open(GF_FALSE, &size), GF_OK);
+	assert_equal(lazy_test_open(GF_TRUE, &lazy_size), GF_OK);
+	assert_equal(size, ref_size);
+	assert_equal(lazy_size, ref_size);
+
+	//all samples empty: size table is present but total size is 0
+	assert_true(lazy_test_patch(GF_ISOM_BOX_TYPE_STSZ, 8, 4*LAZY_TEST_SAMPLES, 0));
+	size = lazy_size = 1;
+	assert_equal(lazy_test_open(GF_FALSE, &size), GF_OK);
+	assert_equal(lazy_test_open(GF_TRUE, &lazy_size), GF_OK);
+	assert_equal(size, 0);
+	assert_equal(lazy_size, 0);
+
+	//time to sample table does not cover the last sample: rejected in both modes
+	assert_true(lazy_test_patch(GF_ISOM_BOX_TYPE_STTS, 4, 4, 0));
+	e = lazy_test_open(GF_FALSE, &size);
+	lazy_e = lazy_test_open(GF_TRUE, &lazy_size);
+	assert_true(e != GF_OK);
+	assert_equal(lazy_e, e);
+
+	gf_file_delete(LAZY_TEST_FILE);
+}
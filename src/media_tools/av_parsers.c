@@ -33,6 +33,18 @@
 #include <gpac/internal/ogg.h>
 #endif
 
+//SIMD scanning of start codes and emulation prevention bytes
+#if defined(WIN32) && !defined(__GNUC__) && (defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP>=2)))
+# include <intrin.h>
+# define NALU_SCAN_SSE2
+#elif defined(__SSE2__)
+# include <emmintrin.h>
+# define NALU_SCAN_SSE2
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+# include <arm_neon.h>
+# define NALU_SCAN_NEON
+#endif
+
 //uncomment/define globally to remove all bitstream parsing logging from code (this will break inspect mode analyze=bs)
 //#define GPAC_DISABLE_AVPARSE_LOGS
 
@@ -4760,6 +4772,14 @@ u32 gf_bs_read_ue_log_idx3(GF_BitStream *bs, const char *fname, s32 idx1, s32 id
 	u32 val=0, code;
 	s32 nb_lead = -1;
 	u32 bits = 0;
+
+	if (gf_bs_read_ue_fast(bs, &val, &bits)) {
+		if (fname) {
+			gf_bs_log_idx(bs, bits, fname, val, idx1, idx2, idx3);
+		}
+		return val;
+	}
+
 	for (code=0; !code; nb_lead++) {
 		if (nb_lead>=32) {
 			break;
@@ -4865,42 +4885,61 @@ void gf_bs_write_se(GF_BitStream *bs, s32 num)
 
 #ifndef GPAC_DISABLE_AV_PARSERS
 
+/*start codes and emulation prevention bytes both begin with a pair of zero bytes, which are located 16 bytes at a time when SSE2 or NEON is available*/
+//returns the position of the first pair of zero bytes, or size if none
+static GFINLINE u32 nalu_next_zero_pair(const u8 *data, u32 size)
+{
+	u32 i = 0;
+#if defined(NALU_SCAN_SSE2)
+	const __m128i zero = _mm_setzero_si128();
+	while (i + 17 <= size) {
+		__m128i z0 = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *) (data+i)), zero);
+		__m128i z1 = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *) (data+i+1)), zero);
+		if (_mm_movemask_epi8(_mm_and_si128(z0, z1))) break;
+		i += 16;
+	}
+#elif defined(NALU_SCAN_NEON)
+	const uint8x16_t zero = vdupq_n_u8(0);
+	while (i + 17 <= size) {
+		uint8x16_t z0 = vceqq_u8(vld1q_u8(data+i), zero);
+		uint8x16_t z1 = vceqq_u8(vld1q_u8(data+i+1), zero);
+		uint64x2_t z = vreinterpretq_u64_u8(vandq_u8(z0, z1));
+		if (vgetq_lane_u64(z, 0) | vgetq_lane_u64(z, 1)) break;
+		i += 16;
+	}
+#endif
+	while (i + 1 < size) {
+		if (data[i+1]) i += 2;
+		else if (!data[i]) return i;
+		else i++;
+	}
+	return size;
+}
+
 GF_EXPORT
 u32 gf_media_nalu_next_start_code(const u8 *data, u32 data_len, u32 *sc_size)
 {
-	u32 avail = data_len;
-	const u8 *cur = data;
+	u32 pos = 0;
 
-	while (cur) {
-		u32 v, bpos;
-		u8 *next_zero = memchr(cur, 0, avail);
-		if (!next_zero) return data_len;
+	while (pos + 2 < data_len) {
+		u32 end;
+		pos += nalu_next_zero_pair(data+pos, data_len-pos);
+		end = pos + 2;
+		while ((end < data_len) && !data[end])
+			end++;
+		if (end >= data_len)
+			break;
 
-		v = 0xffffff00;
-		bpos = (u32)(next_zero - data) + 1;
-		while (1) {
-			u8 cval;
-			if (bpos == (u32)data_len)
-				return data_len;
-
-			cval = data[bpos];
-			v = ((v << 8) & 0xFFFFFF00) | ((u32)cval);
-			bpos++;
-			if (v == 0x00000001) {
+		if (data[end] == 1) {
+			//0x00000001 if more than two zeros
+			if (end - pos > 2) {
 				*sc_size = 4;
-				return bpos - 4;
+				return end - 3;
 			}
-			else if ((v & 0x00FFFFFF) == 0x00000001) {
-				*sc_size = 3;
-				return bpos - 3;
-			}
-			if (cval)
-				break;
+			*sc_size = 3;
+			return end - 2;
 		}
-		if (bpos >= data_len)
-			break;
-		cur = data + bpos;
-		avail = data_len - bpos;
+		pos = end + 1;
 	}
 	return data_len;
 }
@@ -5043,6 +5082,11 @@ u32 gf_media_nalu_emulation_bytes_remove_count(const u8 *buffer, u32 nal_size)
 
 	while (i < nal_size)
 	{
+		//no emulation prevention byte before the next pair of zero bytes
+		if (!num_zero) {
+			i += nalu_next_zero_pair(buffer+i, nal_size-i);
+			if (i >= nal_size) break;
+		}
 		/*ISO 14496-10: "Within the NAL unit, any four-byte sequence that starts with 0x000003
 		  other than the following sequences shall not occur at any byte-aligned position:
 		  \96 0x00000300
@@ -5081,6 +5125,16 @@ u32 gf_media_nalu_remove_emulation_bytes(const u8 *buffer_src, u8 *buffer_dst, u
 
 	while (i < nal_size)
 	{
+		//no emulation prevention byte before the next pair of zero bytes, copy as is
+		if (!num_zero) {
+			u32 nb_bytes = nalu_next_zero_pair(buffer_src+i, nal_size-i);
+			if (nb_bytes) {
+				if ((buffer_dst != buffer_src) || emulation_bytes_count)
+					memmove(buffer_dst + i - emulation_bytes_count, buffer_src + i, nb_bytes);
+				i += nb_bytes;
+				if (i >= nal_size) break;
+			}
+		}
 		/*ISO 14496-10: "Within the NAL unit, any four-byte sequence that starts with 0x000003
 		  other than the following sequences shall not occur at any byte-aligned position:
 		  0x00000300
@@ -119,6 +119,10 @@ struct __dash_client
 	u32 reload_count, last_update_time;
 	/*signature of last MPD*/
 	u8 lastMPDSignature[GF_SHA1_DIGEST_SIZE];
+	/*time of last manifest load or patch, for PatchLocation ttl*/
+	u32 patch_time;
+	/*set while the MPD patch is being downloaded*/
+	Bool patch_pending;
 	/*mime type of media segments (m3u8)*/
 	char *mimeTypeForM3U8Segments;
 
@@ -2355,6 +2359,28 @@ static void dash_purge_xlink(GF_MPD *new_mpd)
 	}
 }
 
+//loads a manifest file, DASH manifests are loaded without DOM
+static GF_Err gf_dash_load_manifest(GF_DashClient *dash, const char *local_url, GF_MPD *mpd, const char *base_url)
+{
+	GF_Err e;
+	GF_DOMParser *mpd_parser;
+
+	if (!dash->is_smooth) {
+		dash->patch_time = gf_sys_clock();
+		return gf_mpd_init_from_file(local_url, mpd, base_url);
+	}
+	mpd_parser = gf_xml_dom_new();
+	e = gf_xml_dom_parse(mpd_parser, local_url, NULL, NULL);
+	if (e) {
+		GF_LOG(GF_LOG_ERROR, GF_LOG_DASH, ("[DASH] Error parsing manifest %s: %s\n", local_url, gf_xml_dom_get_error(mpd_parser)));
+		e = GF_URL_ERROR;
+	} else {
+		e = gf_mpd_init_smooth_from_dom(gf_xml_dom_get_root(mpd_parser), mpd, base_url);
+	}
+	gf_xml_dom_del(mpd_parser);
+	return e;
+}
+
 static void gf_dash_mark_group_done(GF_DASH_Group *group)
 {
 	GF_LOG(GF_LOG_INFO, GF_LOG_DASH, ("[DASH] AS#%d group is done\n", 1+group->index ));
@@ -2508,13 +2534,207 @@ static void dash_check_chaining(GF_DashClient *dash, char *scheme_id, char **cha
 }
 
 
+//checks the period end time and updates the number of segments of the active representation after a manifest update
+static void gf_dash_group_check_period_end(GF_DashClient *dash, GF_DASH_Group *group, GF_MPD *new_mpd, GF_MPD_Period *period, u64 fetch_time)
+{
+	Double seg_dur;
+	Bool reset_segment_count;
+
+	group->maybe_end_of_stream = 0;
+	reset_segment_count = GF_FALSE;
+	/*compute fetchTime + minUpdatePeriod and check period end time*/
+	if (new_mpd->minimum_update_period && new_mpd->media_presentation_duration) {
+		u64 endTime = fetch_time - new_mpd->availabilityStartTime - period->start;
+		if (endTime > new_mpd->media_presentation_duration) {
+			GF_LOG(GF_LOG_DEBUG, GF_LOG_DASH, ("[DASH] Period EndTime is signaled to "LLU", less than fetch time "LLU" ! Ignoring mediaPresentationDuration\n", new_mpd->media_presentation_duration, endTime));
+			new_mpd->media_presentation_duration = 0;
+			reset_segment_count = GF_TRUE;
+		} else {
+			endTime += new_mpd->minimum_update_period;
+			if (endTime > new_mpd->media_presentation_duration) {
+				GF_LOG(GF_LOG_DEBUG, GF_LOG_DASH, ("[DASH] Period EndTime is signaled to "LLU", less than fetch time + next update "LLU" - maybe end of stream ?\n", new_mpd->availabilityStartTime, endTime));
+				group->maybe_end_of_stream = 1;
+			}
+		}
+	}
+
+	/*update number of segments in active rep*/
+	gf_dash_get_segment_duration(gf_list_get(group->adaptation_set->representations, group->active_rep_index), group->adaptation_set, group->period, new_mpd, &group->nb_segments_in_rep, &seg_dur);
+
+	if (reset_segment_count) {
+		u32 nb_segs_in_mpd_period = (u32) (dash->mpd->minimum_update_period / (1000*seg_dur) );
+		group->nb_segments_in_rep = group->download_segment_index + nb_segs_in_mpd_period;
+	}
+	/*check if number of segments are coherent ...*/
+	else if (!group->maybe_end_of_stream && new_mpd->minimum_update_period && new_mpd->media_presentation_duration) {
+		u32 nb_segs_in_mpd_period = (u32) (dash->mpd->minimum_update_period / (1000*seg_dur) );
+
+		if (group->download_segment_index + nb_segs_in_mpd_period >= group->nb_segments_in_rep) {
+			GF_LOG(GF_LOG_DEBUG, GF_LOG_DASH, ("[DASH] Period has %d segments but %d are needed until next refresh. Maybe end of stream is near ?\n", group->nb_segments_in_rep, group->download_segment_index + nb_segs_in_mpd_period));
+			group->maybe_end_of_stream = 1;
+		}
+	}
+
+	GF_LOG(GF_LOG_DEBUG, GF_LOG_DASH, ("[DASH] Updated AdaptationSet %d - %d segments\n", 1+group->index, group->nb_segments_in_rep));
+}
+
+//MPD patches are applied on the current manifest, unless the manifest differs from the document seen by the server
+static Bool gf_dash_can_patch_manifest(GF_DashClient *dash)
+{
+	u32 i=0;
+	GF_MPD_Period *period;
+	if (!dash->mpd->patch_location || (dash->mpd->type!=GF_MPD_TYPE_DYNAMIC) || dash->in_error || dash->manifest_pending)
+		return GF_FALSE;
+	//forwarding modes need the full manifest
+	if (dash->is_smooth || dash->is_m3u8 || dash->dash_io->manifest_updated || dash->split_adaptation_set)
+		return GF_FALSE;
+	//remote periods
+	while ((period = gf_list_enum(dash->mpd->periods, &i))) {
+		if (period->origin_base_url || period->broken_xlink || period->xlink_href) return GF_FALSE;
+	}
+	return GF_TRUE;
+}
+
+//resynchronizes the groups on the patched manifest: download indexes are recomputed from the current position in the updated timelines
+static void gf_dash_resync_patched_manifest(GF_DashClient *dash, GF_MPD_Period *period, GF_List *removed_periods, u64 prev_ast, u64 prev_period_dur, u64 fetch_time)
+{
+	u32 i;
+	GF_MPD *mpd = dash->mpd;
+
+	if (gf_list_find(removed_periods, period)>=0) {
+		GF_LOG(GF_LOG_WARNING, GF_LOG_DASH, ("[DASH] current active period removed by MPD patch - assuming end of active period and switching to first period\n"));
+		dash->active_period_index = 0;
+		dash->request_period_switch = 1;
+		for (i=0; i<gf_list_count(dash->groups); i++) {
+			GF_DASH_Group *group = gf_list_get(dash->groups, i);
+			gf_dash_mark_group_done(group);
+			group->adaptation_set = NULL;
+		}
+		return;
+	}
+	dash->active_period_index = gf_list_find(mpd->periods, period);
+
+	for (i=0; i<gf_list_count(dash->groups); i++) {
+		u32 timescale=0;
+		u64 duration;
+		GF_MPD_SegmentTimeline *timeline = NULL;
+		GF_MPD_Representation *rep;
+		GF_DASH_Group *group = gf_list_get(dash->groups, i);
+		if ((group->selection==GF_DASH_GROUP_NOT_SELECTABLE) || !group->adaptation_set) continue;
+
+		rep = gf_list_get(group->adaptation_set->representations, group->active_rep_index);
+		gf_mpd_resolve_segment_duration(rep, group->adaptation_set, group->period, &duration, &timescale, NULL, &timeline);
+		if (timeline) {
+#ifndef GPAC_DISABLE_LOG
+			u32 prev_idx = group->download_segment_index;
+#endif
+			group->download_segment_index = gf_dash_get_index_in_timeline(timeline, group->current_start_time+group->current_pto, group->current_timescale, timescale ? timescale : group->current_timescale);
+			GF_LOG(GF_LOG_INFO, GF_LOG_DASH, ("[DASH] Patched SegmentTimeline: New segment number %d - old %d - start time "LLD"\n", group->download_segment_index, prev_idx, group->current_start_time));
+		}
+		if (mpd->availabilityStartTime != prev_ast) {
+			s64 diff = mpd->availabilityStartTime;
+			diff -= prev_ast;
+			if (diff < 0) diff = -diff;
+			if (diff>3000)
+				gf_dash_group_timeline_setup(mpd, group, fetch_time);
+		}
+		gf_dash_group_check_period_end(dash, group, mpd, period, fetch_time);
+
+		if (!prev_period_dur && period->duration) {
+			GF_LOG(GF_LOG_INFO, GF_LOG_DASH, ("End of period upcoming, current segment index for group #%d: %d\n", 1+group->index, group->download_segment_index));
+			if (group->download_segment_index > (s32) group->nb_segments_in_rep)
+				gf_dash_mark_group_done(group);
+		}
+	}
+}
+
+//fetches the MPD patch and applies it to the current manifest, returns GF_EOS if the manifest is unchanged
+static GF_Err gf_dash_patch_manifest(GF_DashClient *dash)
+{
+	GF_Err e;
+	u32 i;
+	char *purl;
+	const char *local_url;
+	u64 prev_ast, prev_period_dur;
+	u32 prev_mup;
+	GF_DOMParser *patch_parser;
+	GF_List *removed_periods;
+	GF_MPD_Period *period;
+
+	//patch location expired, reload the full manifest
+	if (!dash->patch_pending && dash->mpd->patch_ttl && (gf_sys_clock() - dash->patch_time > dash->mpd->patch_ttl*1000))
+		return GF_NOT_SUPPORTED;
+
+	purl = gf_url_concatenate(dash->base_url, dash->mpd->patch_location);
+	if (!purl) return GF_OUT_OF_MEM;
+	e = gf_dash_download_resource(dash, &(dash->mpd_dnload), purl, 0, 0, 0, NULL);
+	if (e==GF_NOT_READY) {
+		gf_free(purl);
+		dash->manifest_pending = 1;
+		dash->patch_pending = GF_TRUE;
+		return e;
+	}
+	dash->manifest_pending = 0;
+	dash->patch_pending = GF_FALSE;
+	if (e) {
+		GF_LOG(GF_LOG_WARNING, GF_LOG_DASH, ("[DASH] Failed to fetch MPD patch %s: %s - reloading manifest\n", purl, gf_error_to_string(e)));
+		gf_free(purl);
+		return e;
+	}
+	GF_LOG(GF_LOG_DEBUG, GF_LOG_DASH, ("[DASH] MPD patch %s fetched\n", purl));
+	gf_free(purl);
+
+	local_url = dash->dash_io->get_cache_name(dash->dash_io, dash->mpd_dnload);
+	patch_parser = gf_xml_dom_new();
+	e = gf_xml_dom_parse(patch_parser, local_url, NULL, NULL);
+	if (e) {
+		GF_LOG(GF_LOG_WARNING, GF_LOG_DASH, ("[DASH] Failed to parse MPD patch: %s - reloading manifest\n", gf_xml_dom_get_error(patch_parser)));
+		gf_xml_dom_del(patch_parser);
+		return e;
+	}
+
+	//current position of each group, entries before it may be removed by the patch
+	for (i=0; i<gf_list_count(dash->groups); i++) {
+		GF_DASH_Group *group = gf_list_get(dash->groups, i);
+		if ((group->selection==GF_DASH_GROUP_NOT_SELECTABLE) || !group->adaptation_set) continue;
+		group->current_start_time = gf_dash_get_segment_start_time_with_timescale(group, NULL, &group->current_timescale, &group->current_pto);
+	}
+	period = gf_list_get(dash->mpd->periods, dash->active_period_index);
+	prev_period_dur = period ? period->duration : 0;
+	prev_ast = dash->mpd->availabilityStartTime;
+	prev_mup = dash->mpd->minimum_update_period;
+
+	removed_periods = gf_list_new();
+	e = gf_mpd_apply_patch(dash->mpd, gf_xml_dom_get_root(patch_parser), removed_periods);
+	gf_xml_dom_del(patch_parser);
+
+	if (e && (e!=GF_EOS)) {
+		GF_LOG(GF_LOG_WARNING, GF_LOG_DASH, ("[DASH] Failed to apply MPD patch: %s - reloading manifest\n", gf_error_to_string(e)));
+	}
+	//operations preceding a failure are applied, resync in all cases
+	if ((e!=GF_EOS) && period) {
+		if (!dash->mpd->minimum_update_period && (dash->mpd->type==GF_MPD_TYPE_DYNAMIC))
+			dash->mpd->minimum_update_period = prev_mup;
+		gf_dash_resync_patched_manifest(dash, period, removed_periods, prev_ast, prev_period_dur, dash_get_fetch_time(dash));
+	}
+	while (gf_list_count(removed_periods)) {
+		gf_mpd_period_free(gf_list_pop_back(removed_periods));
+	}
+	gf_list_del(removed_periods);
+	if (e) return e;
+
+	dash->patch_time = gf_sys_clock();
+	//the next full reload shall not be seen as unchanged
+	memset(dash->lastMPDSignature, 0, GF_SHA1_DIGEST_SIZE);
+	return GF_OK;
+}
+
 static GF_Err gf_dash_update_manifest(GF_DashClient *dash)
 {
 	GF_Err e;
 	Bool force_timeline_setup = GF_FALSE;
 	u32 group_idx, rep_idx, i, j;
 	u64 fetch_time=0;
-	GF_DOMParser *mpd_parser;
 	u8 signature[GF_SHA1_DIGEST_SIZE];
 	GF_MPD_Period *period=NULL, *new_period=NULL;
 	const char *local_url;
@@ -2522,7 +2742,6 @@ static GF_Err gf_dash_update_manifest(GF_DashClient *dash)
 	char * purl;
 	Double timeline_start_time=0;
 	GF_MPD *new_mpd=NULL;
-	Bool fetch_only = GF_FALSE;
 	Bool has_reps_unchanged = GF_FALSE;
 
 	//HLS: do not reload the playlist, directly update the reps
@@ -2544,6 +2763,24 @@ static GF_Err gf_dash_update_manifest(GF_DashClient *dash)
 		goto resume_mpd_parse;
 	}
 
+	//MPD patch: only fetch the changes and apply them to the current manifest
+	if (dash->patch_pending || gf_dash_can_patch_manifest(dash)) {
+		e = gf_dash_patch_manifest(dash);
+		if (e==GF_NOT_READY) return e;
+		if ((e==GF_EOS) || (e==GF_OK)) {
+			if (e==GF_EOS) {
+				dash->reload_count++;
+				GF_LOG(GF_LOG_DEBUG, GF_LOG_DASH, ("[DASH] MPD patch empty for %d consecutive reloads\n", dash->reload_count));
+			} else {
+				dash->reload_count = 0;
+			}
+			dash->last_update_time = gf_sys_clock();
+			dash->mpd_fetch_time = dash_get_fetch_time(dash);
+			return GF_OK;
+		}
+		//otherwise reload full manifest
+	}
+
 	if (!dash->mpd_dnload) {
 		local_url = purl = NULL;
 		if (!gf_list_count(dash->mpd->locations)) {
@@ -2565,7 +2802,6 @@ static GF_Err gf_dash_update_manifest(GF_DashClient *dash)
 				gf_free(dash->base_url);
 				dash->base_url = gf_strdup(purl);
 			}
-			fetch_only = 1;
 		}
 	} else {
 		local_url = dash->dash_io->get_cache_name(dash->dash_io, dash->mpd_dnload);
@@ -2694,19 +2930,8 @@ static GF_Err gf_dash_update_manifest(GF_DashClient *dash)
 
 		/* It means we have to reparse the file ... */
 		/* parse the MPD */
-		mpd_parser = gf_xml_dom_new();
-		e = gf_xml_dom_parse(mpd_parser, local_url, NULL, NULL);
-		if (e != GF_OK) {
-			gf_xml_dom_del(mpd_parser);
-			GF_LOG(GF_LOG_ERROR, GF_LOG_DASH, ("[DASH] Error - cannot update playlist: error in XML parsing %s\n", gf_error_to_string(e)));
-			return GF_NON_COMPLIANT_BITSTREAM;
-		}
 		new_mpd = gf_mpd_new();
-		if (dash->is_smooth)
-			e = gf_mpd_init_smooth_from_dom(gf_xml_dom_get_root(mpd_parser), new_mpd, purl);
-		else
-			e = gf_mpd_init_from_dom(gf_xml_dom_get_root(mpd_parser), new_mpd, purl);
-		gf_xml_dom_del(mpd_parser);
+		e = gf_dash_load_manifest(dash, local_url, new_mpd, purl);
 		if (e) {
 			GF_LOG(GF_LOG_ERROR, GF_LOG_DASH, ("[DASH] Error - cannot update playlist: error in MPD creation %s\n", gf_error_to_string(e)));
 			gf_mpd_del(new_mpd);
@@ -2725,7 +2950,8 @@ resume_mpd_parse:
 	gf_assert(new_mpd);
 
 	period = gf_list_get(dash->mpd->periods, dash->active_period_index);
-	if (fetch_only  && !period) goto exit;
+	//no active period, may happen if removed by an MPD patch
+	if (!period) goto exit;
 
 #ifndef GPAC_DISABLE_LOG
 	GF_LOG(GF_LOG_INFO, GF_LOG_DASH, ("[DASH] Updated manifest:\n"));
@@ -3426,8 +3652,6 @@ process_m3u8_manifest:
 	}
 	//good to go, switch pointers
 	for (group_idx=0; group_idx<gf_list_count(dash->groups) && new_period; group_idx++) {
-		Double seg_dur;
-		Bool reset_segment_count;
 		GF_MPD_AdaptationSet *new_as;
 		GF_DASH_Group *group = gf_list_get(dash->groups, group_idx);
 
@@ -3478,42 +3702,7 @@ process_m3u8_manifest:
 				gf_dash_group_timeline_setup(new_mpd, group, fetch_time);
 		}
 
-		group->maybe_end_of_stream = 0;
-		reset_segment_count = GF_FALSE;
-		/*compute fetchTime + minUpdatePeriod and check period end time*/
-		if (new_mpd->minimum_update_period && new_mpd->media_presentation_duration) {
-			u64 endTime = fetch_time - new_mpd->availabilityStartTime - period->start;
-			if (endTime > new_mpd->media_presentation_duration) {
-				GF_LOG(GF_LOG_DEBUG, GF_LOG_DASH, ("[DASH] Period EndTime is signaled to "LLU", less than fetch time "LLU" ! Ignoring mediaPresentationDuration\n", new_mpd->media_presentation_duration, endTime));
-				new_mpd->media_presentation_duration = 0;
-				reset_segment_count = GF_TRUE;
-			} else {
-				endTime += new_mpd->minimum_update_period;
-				if (endTime > new_mpd->media_presentation_duration) {
-					GF_LOG(GF_LOG_DEBUG, GF_LOG_DASH, ("[DASH] Period EndTime is signaled to "LLU", less than fetch time + next update "LLU" - maybe end of stream ?\n", new_mpd->availabilityStartTime, endTime));
-					group->maybe_end_of_stream = 1;
-				}
-			}
-		}
-
-		/*update number of segments in active rep*/
-		gf_dash_get_segment_duration(gf_list_get(group->adaptation_set->representations, group->active_rep_index), group->adaptation_set, group->period, new_mpd, &group->nb_segments_in_rep, &seg_dur);
-
-		if (reset_segment_count) {
-			u32 nb_segs_in_mpd_period = (u32) (dash->mpd->minimum_update_period / (1000*seg_dur) );
-			group->nb_segments_in_rep = group->download_segment_index + nb_segs_in_mpd_period;
-		}
-		/*check if number of segments are coherent ...*/
-		else if (!group->maybe_end_of_stream && new_mpd->minimum_update_period && new_mpd->media_presentation_duration) {
-			u32 nb_segs_in_mpd_period = (u32) (dash->mpd->minimum_update_period / (1000*seg_dur) );
-
-			if (group->download_segment_index + nb_segs_in_mpd_period >= group->nb_segments_in_rep) {
-				GF_LOG(GF_LOG_DEBUG, GF_LOG_DASH, ("[DASH] Period has %d segments but %d are needed until next refresh. Maybe end of stream is near ?\n", group->nb_segments_in_rep, group->download_segment_index + nb_segs_in_mpd_period));
-				group->maybe_end_of_stream = 1;
-			}
-		}
-
-		GF_LOG(GF_LOG_DEBUG, GF_LOG_DASH, ("[DASH] Updated AdaptationSet %d - %d segments\n", group_idx+1, group->nb_segments_in_rep));
+		gf_dash_group_check_period_end(dash, group, new_mpd, period, fetch_time);
 
 		if (!period->duration && new_period->duration) {
 			GF_LOG(GF_LOG_INFO, GF_LOG_DASH, ("End of period upcoming, current segment index for group #%d: %d\n", group_idx+1, group->download_segment_index));
@@ -8960,7 +9149,6 @@ GF_Err gf_dash_open(GF_DashClient *dash, const char *manifest_url)
 	char *sep_cgi = NULL;
 	char *sep_frag = NULL;
 	GF_Err e;
-	GF_DOMParser *mpd_parser=NULL;
 	Bool is_local = GF_FALSE;
 
 	if (!dash || !manifest_url) return GF_BAD_PARAM;
@@ -9129,27 +9317,11 @@ GF_Err gf_dash_open(GF_DashClient *dash, const char *manifest_url)
 		GF_LOG(GF_LOG_DEBUG, GF_LOG_DASH, ("[DASH] parsing %s manifest %s\n", dash->is_smooth ? "SmoothStreaming" : "DASH-MPD", local_url));
 
 		/* parse the MPD */
-		mpd_parser = gf_xml_dom_new();
-		e = gf_xml_dom_parse(mpd_parser, local_url, NULL, NULL);
+		e = gf_dash_load_manifest(dash, local_url, dash->mpd, manifest_url);
 
 		if (sep_cgi) sep_cgi[0] = '?';
 		if (sep_frag) sep_frag[0] = '#';
 
-		if (e != GF_OK) {
-			GF_LOG(GF_LOG_ERROR, GF_LOG_DASH, ("[DASH] Error - cannot connect service: MPD parsing problem %s\n", gf_xml_dom_get_error(mpd_parser) ));
-			gf_xml_dom_del(mpd_parser);
-			dash->dash_io->del(dash->dash_io, dash->mpd_dnload);
-			dash->mpd_dnload = NULL;
-			return GF_URL_ERROR;
-		}
-
-		if (dash->is_smooth) {
-			e = gf_mpd_init_smooth_from_dom(gf_xml_dom_get_root(mpd_parser), dash->mpd, manifest_url);
-		} else {
-			e = gf_mpd_init_from_dom(gf_xml_dom_get_root(mpd_parser), dash->mpd, manifest_url);
-		}
-		gf_xml_dom_del(mpd_parser);
-
 		if (!e && dash->split_adaptation_set)
 			gf_mpd_split_adaptation_sets(dash->mpd);
 
@@ -9228,6 +9400,7 @@ void gf_dash_close(GF_DashClient *dash)
 		gf_mpd_del(dash->mpd);
 		dash->mpd = NULL;
 	}
+	dash->patch_pending = GF_FALSE;
 	if (dash->chain_next) {
 		gf_free(dash->chain_next);
 		dash->chain_next = NULL;
@@ -10311,6 +10484,90 @@ GF_Err gf_dash_group_get_next_segment_location(GF_DashClient *dash, u32 idx, u32
 	return GF_OK;
 }
 
+GF_EXPORT
+GF_Err gf_dash_group_get_upcoming_segment(GF_DashClient *dash, u32 group_idx, u32 offset, char **url, u64 *start_range, u64 *end_range, u32 *seg_dur_ms, u32 *bandwidth)
+{
+	GF_Err e;
+	GF_MPD_Representation *rep;
+	const char *base_url;
+	u64 seg_dur=0, s_range=0, e_range=0;
+	u32 i, index, max_buffer, buffer_ahead;
+	GF_DASH_Group *group = gf_dash_get_active_group(dash, group_idx);
+
+	*url = NULL;
+	if (!group) return GF_BAD_PARAM;
+	if (group->done || (group->selection != GF_DASH_GROUP_SELECTED) || !group->timeline_setup)
+		return GF_EOS;
+
+	//only regular forward playback of single representation groups, the next download must not be a switch
+	if ((dash->speed<0) || group->nb_parts || group->base_rep_index_plus_one || group->has_pending_enhancement
+		|| group->local_files || group->force_switch_bandwidth || group->hls_next_seq_num
+		|| (dash->is_m3u8 && group->is_low_latency) || (group->llhls_switch_request>=0)
+	)
+		return GF_NOT_SUPPORTED;
+
+	rep = gf_list_get(group->adaptation_set->representations, group->active_rep_index);
+	if (!rep || rep->playback.enhancement_rep_index_plus_one) return GF_NOT_SUPPORTED;
+
+	index = group->download_segment_index + offset;
+	if (group->nb_segments_in_rep && (index >= group->nb_segments_in_rep))
+		return GF_EOS;
+
+	//segment not yet available on server
+	if (!dash->is_m3u8 && !dash->is_smooth && !group->broken_timing) {
+		GF_MPD_Type dyn_type = group->period->origin_base_url ? group->period->type : dash->mpd->type;
+		if (dyn_type==GF_MPD_TYPE_DYNAMIC) {
+			u32 ast_dur_ms;
+			u64 segment_ast = gf_dash_get_segment_availability_start_time(dash->mpd, group, index, &ast_dur_ms);
+			if (segment_ast > gf_net_get_utc())
+				return GF_EOS;
+		}
+	}
+
+	base_url = group->period->origin_base_url ? group->period->origin_base_url : dash->base_url;
+	e = gf_dash_resolve_url(dash->mpd, rep, group, base_url, GF_MPD_RESOLVE_URL_MEDIA, index, url, &s_range, &e_range, &seg_dur, NULL, NULL, NULL, NULL, NULL);
+	if (e || ! *url) {
+		if (*url) gf_free(*url);
+		*url = NULL;
+		return e ? e : GF_EOS;
+	}
+	if (strnicmp(*url, "http://", 7) && strnicmp(*url, "https://", 8)) {
+		gf_free(*url);
+		*url = NULL;
+		return GF_NOT_SUPPORTED;
+	}
+
+	//do not fetch beyond the buffer, accounting for segments already queued
+	//if the consumer has no playout buffer (file output, inspection), it is not clock-driven and only the caller window applies
+	max_buffer = MAX(group->buffer_max_ms, dash->user_buffer_ms);
+	buffer_ahead = group->buffer_occupancy_ms + (offset+1) * (u32) seg_dur;
+	for (i=0; i<group->nb_cached_segments; i++)
+		buffer_ahead += group->cached[i].duration;
+	if (seg_dur && (max_buffer >= seg_dur)) {
+		if (buffer_ahead > max_buffer) {
+			gf_free(*url);
+			*url = NULL;
+			return GF_BUFFER_TOO_SMALL;
+		}
+		//the measured download rate must deliver the queued and upcoming segments before they are played
+		if (group->backup_Bps) {
+			u64 bits = (u64) rep->bandwidth * seg_dur * (group->nb_cached_segments + offset + 1);
+			u64 deliverable = (u64) group->backup_Bps * 8 * (buffer_ahead - seg_dur);
+			if (bits > deliverable) {
+				gf_free(*url);
+				*url = NULL;
+				return GF_BUFFER_TOO_SMALL;
+			}
+		}
+	}
+
+	if (start_range) *start_range = s_range;
+	if (end_range) *end_range = e_range;
+	if (seg_dur_ms) *seg_dur_ms = (u32) seg_dur;
+	if (bandwidth) *bandwidth = rep->bandwidth;
+	return GF_OK;
+}
+
 
 GF_EXPORT
 void gf_dash_seek(GF_DashClient *dash, Double start_range)
@@ -111,6 +111,13 @@ static GFINLINE s32 gf_m2ts_time_diff_us(GF_M2TS_Time *a, GF_M2TS_Time *b)
 /************************************
  * Section-related functions
  ************************************/
+static void gf_m2ts_mux_section_del(GF_M2TS_Mux_Section *sec)
+{
+	gf_free(sec->data);
+	if (sec->packets) gf_free(sec->packets);
+	gf_free(sec);
+}
+
 void gf_m2ts_mux_table_update(GF_M2TS_Mux_Stream *stream, u8 table_id, u16 table_id_extension,
                               u8 *table_payload, u32 table_payload_length,
                               Bool use_syntax_indicator, Bool private_indicator)
@@ -131,8 +138,7 @@ void gf_m2ts_mux_table_update(GF_M2TS_Mux_Stream *stream, u8 table_id, u16 table
 			GF_M2TS_Mux_Section *sec = table->section;
 			while (sec) {
 				GF_M2TS_Mux_Section *sec2 = sec->next;
-				gf_free(sec->data);
-				gf_free(sec);
+				gf_m2ts_mux_section_del(sec);
 				sec = sec2;
 			}
 			table->version_number = (table->version_number + 1)%0x1F;
@@ -318,8 +324,7 @@ void gf_m2ts_mux_table_update_mpeg4(GF_M2TS_Mux_Stream *stream, u8 table_id, u16
 			GF_M2TS_Mux_Section *sec = table->section;
 			while (sec) {
 				GF_M2TS_Mux_Section *sec2 = sec->next;
-				gf_free(sec->data);
-				gf_free(sec);
+				gf_m2ts_mux_section_del(sec);
 				sec = sec2;
 			}
 			if (increment_version_number)
@@ -449,13 +454,13 @@ void gf_m2ts_mux_table_update_mpeg4(GF_M2TS_Mux_Stream *stream, u8 table_id, u16
 	/*MPEG-4 tables are input streams for the mux, the bitrate is updated when fetching AUs*/
 }
 
-static u32 gf_m2ts_add_adaptation(GF_M2TS_Mux_Program *prog, GF_BitStream *bs, u16 pid,
+static u32 gf_m2ts_add_adaptation(GF_M2TS_Mux_Program *prog, u8 *buf, u16 pid,
                                   Bool has_pcr, u64 pcr_time,
                                   Bool is_rap,
                                   u32 padding_length,
                                   char *af_descriptors, u32 af_descriptors_size, Bool set_discontinuity)
 {
-	u32 adaptation_length;
+	u32 adaptation_length, pos;
 
 	adaptation_length = ADAPTATION_FLAGS_LENGTH + (has_pcr?PCR_LENGTH:0) + padding_length;
 
@@ -464,22 +469,26 @@ static u32 gf_m2ts_add_adaptation(GF_M2TS_Mux_Program *prog, GF_BitStream *bs, u
 		adaptation_length += ADAPTATION_EXTENSION_LENGTH_LENGTH + ADAPTATION_EXTENSION_FLAGS_LENGTH + af_descriptors_size;
 	}
 
-	gf_bs_write_int(bs,	adaptation_length, 8);
-	gf_bs_write_int(bs,	set_discontinuity ? 1 : 0, 1);			// discontinuity indicator
-	gf_bs_write_int(bs,	is_rap, 1);		// random access indicator
-	gf_bs_write_int(bs,	0, 1);			// es priority indicator
-	gf_bs_write_int(bs,	has_pcr, 1);	// PCR_flag
-	gf_bs_write_int(bs,	0, 1);			// OPCR flag
-	gf_bs_write_int(bs,	0, 1);			// splicing point flag
-	gf_bs_write_int(bs,	0, 1);			// transport private data flag
-	gf_bs_write_int(bs,	af_descriptors_size ? 1 : 0, 1);			// adaptation field extension flag
+	buf[0] = adaptation_length;
+	buf[1] = (set_discontinuity ? 0x80 : 0)	// discontinuity indicator
+		| (is_rap ? 0x40 : 0)					// random access indicator
+		| (has_pcr ? 0x10 : 0)					// PCR_flag
+		| (af_descriptors_size ? 0x01 : 0);		// adaptation field extension flag
+	//es priority indicator, OPCR, splicing point and transport private data flags are 0
+	pos = 2;
+
 	if (has_pcr) {
 		u64 PCR_base, PCR_ext;
 		PCR_base = pcr_time/300;
-		gf_bs_write_long_int(bs, PCR_base, 33);
-		gf_bs_write_int(bs,	0, 6); // reserved
 		PCR_ext = pcr_time - PCR_base*300;
-		gf_bs_write_long_int(bs, PCR_ext, 9);
+		buf[2] = (u8) (PCR_base >> 25);
+		buf[3] = (u8) (PCR_base >> 17);
+		buf[4] = (u8) (PCR_base >> 9);
+		buf[5] = (u8) (PCR_base >> 1);
+		//6 reserved bits set to 0
+		buf[6] = (u8) ( ((PCR_base & 1) << 7) | ((PCR_ext >> 8) & 1) );
+		buf[7] = (u8) (PCR_ext & 0xFF);
+		pos += PCR_LENGTH;
 		if (prog->last_pcr > pcr_time) {
 			GF_LOG(GF_LOG_INFO, GF_LOG_CONTAINER, ("[MPEG-2 TS Muxer] PID %d: Sending PCR "LLD" earlier than previous PCR "LLD" - drift %f sec - discontinuity set\n", pid, pcr_time, prog->last_pcr, (prog->last_pcr - pcr_time) /27000000.0 ));
 		}
@@ -494,35 +503,69 @@ static u32 gf_m2ts_add_adaptation(GF_M2TS_Mux_Program *prog, GF_BitStream *bs, u
 	}
 
 	if (af_descriptors_size) {
-		gf_bs_write_int(bs,	ADAPTATION_EXTENSION_FLAGS_LENGTH + af_descriptors_size, 8);
-
-		gf_bs_write_int(bs,	0, 1);			// ltw_flag
-		gf_bs_write_int(bs,	0, 1);			// piecewise_rate_flag
-		gf_bs_write_int(bs,	0, 1);			// seamless_splice_flag
-		gf_bs_write_int(bs,	0, 1);			// af_descriptor_not_present_flag
-		gf_bs_write_int(bs,	0xF, 4);			// reserved
-
-		gf_bs_write_data(bs, af_descriptors, af_descriptors_size);
+		buf[pos] = ADAPTATION_EXTENSION_FLAGS_LENGTH + af_descriptors_size;
+		//ltw, piecewise_rate, seamless_splice and af_descriptor_not_present flags are 0, 4 reserved bits set
+		buf[pos+1] = 0x0F;
+		pos += 2;
+		memcpy(buf+pos, af_descriptors, af_descriptors_size);
+		pos += af_descriptors_size;
 	}
 
-	gf_bs_write_byte(bs, 0xFF, padding_length); // stuffing byte
+	if (padding_length) {
+		memset(buf+pos, 0xFF, padding_length); // stuffing byte
+	}
 
 	return adaptation_length + ADAPTATION_LENGTH_LENGTH;
 }
 
 //#define USE_AF_STUFFING
 
+#ifndef USE_AF_STUFFING
+//formats all TS packets of a section, stuffing according to annex C.3
+static Bool gf_m2ts_mux_section_packetize(GF_M2TS_Mux_Section *section, u16 pid)
+{
+	u32 i, offset = 0;
+
+	section->nb_packets = 1;
+	if (section->length > 183) section->nb_packets += (section->length - 183 + 183) / 184;
+	section->packets = gf_malloc(sizeof(u8) * 188 * section->nb_packets);
+	if (!section->packets) {
+		section->nb_packets = 0;
+		return GF_FALSE;
+	}
+	for (i=0; i<section->nb_packets; i++) {
+		u8 *pck = section->packets + 188*i;
+		/* no concatenations of sections in ts packets, so pointer field is 0 */
+		u32 hdr_len = i ? 4 : 5;
+		u32 size = section->length - offset;
+		if (size > 188 - hdr_len) size = 188 - hdr_len;
+
+		pck[0] = 0x47;
+		pck[1] = (i ? 0 : 0x40) | ((pid>>8) & 0x1F);
+		pck[2] = pid & 0xFF;
+		pck[3] = GF_M2TS_ADAPTATION_NONE<<4;
+		if (!i) pck[4] = 0;
+		memcpy(pck + hdr_len, section->data + offset, size);
+		if (hdr_len + size < 188)
+			memset(pck + hdr_len + size, 0xFF, 188 - hdr_len - size);
+		offset += size;
+	}
+	return GF_TRUE;
+}
+#endif
+
 static void gf_m2ts_mux_table_get_next_packet(GF_M2TS_Mux *mux, GF_M2TS_Mux_Stream *stream, char *packet)
 {
-	GF_BitStream *bs;
 	GF_M2TS_Mux_Table *table;
 	GF_M2TS_Mux_Section *section;
-	u32 payload_length, payload_start;
-	u8 adaptation_field_control = GF_M2TS_ADAPTATION_NONE;
+	u32 payload_length;
 #ifndef USE_AF_STUFFING
-	u32 padded_bytes=0;
+	u32 pck_idx;
 #else
+	GF_BitStream *bs;
+	u32 payload_start;
 	u32 padding_length = 0;
+	u8 adaptation_field_control = GF_M2TS_ADAPTATION_NONE;
 #endif
 
 	stream->table_needs_send = GF_FALSE;
@@ -535,6 +578,25 @@ static void gf_m2ts_mux_table_get_next_packet(GF_M2TS_Mux *mux, GF_M2TS_Mux_Stre
 	section = stream->current_section;
 	gf_assert(section);
 
+#ifndef USE_AF_STUFFING
+	//section packets are formatted once and repeated, only the continuity counter changes
+	if (!section->packets && !gf_m2ts_mux_section_packetize(section, stream->pid)) {
+		GF_LOG(GF_LOG_ERROR, GF_LOG_CONTAINER, ("[MPEG-2 TS Muxer] PID %d: fail to allocate packets for table id %d\n", stream->pid, table->table_id));
+		return;
+	}
+	if (!stream->current_section_offset) {
+		pck_idx = 0;
+		payload_length = 183;
+	} else {
+		pck_idx = 1 + (stream->current_section_offset - 183) / 184;
+		payload_length = 184;
+	}
+	if (payload_length > section->length - stream->current_section_offset)
+		payload_length = section->length - stream->current_section_offset;
+
+	memcpy(packet, section->packets + 188*pck_idx, 188);
+	packet[3] |= stream->continuity_counter & 0xF;
+#else
 	bs = mux->pck_bs;
 
 	if (!stream->current_section_offset) payload_length = 183;
@@ -542,11 +604,8 @@ static void gf_m2ts_mux_table_get_next_packet(GF_M2TS_Mux *mux, GF_M2TS_Mux_Stre
 
 	payload_start = payload_length;
 
-	if (section->length - stream->current_section_offset >= payload_length) {
-
-	} else  {
+	if (section->length - stream->current_section_offset < payload_length) {
 		//stuffing using adaptation field - seems not well handled by some equipments ...
-#ifdef USE_AF_STUFFING
 		/* in all the following cases, we write an adaptation field */
 		adaptation_field_control = GF_M2TS_ADAPTATION_AND_PAYLOAD;
 		/* we need at least 2 bytes for adaptation field headers (no pcr) */
@@ -557,21 +616,10 @@ static void gf_m2ts_mux_table_get_next_packet(GF_M2TS_Mux *mux, GF_M2TS_Mux_Stre
 			padding_length = payload_length - section->length + stream->current_section_offset;
 			payload_length -= padding_length;
 		}
-#else
-		//stuffing according to annex C.3
-		padded_bytes = payload_length - section->length + stream->current_section_offset;
-		payload_length = section->length - stream->current_section_offset;
-#endif
 	}
 
 	gf_assert(payload_length + stream->current_section_offset <= section->length);
 
-	//CC field shall not be incremented for if adaptation field only, rewind counter
-	if (adaptation_field_control == GF_M2TS_ADAPTATION_ONLY) {
-		if (!stream->continuity_counter) stream->continuity_counter=15;
-		else stream->continuity_counter--;
-	}
-
 	gf_bs_reassign_buffer(bs, packet, 188);
 	gf_bs_write_int(bs,	0x47, 8); // sync
 	gf_bs_write_int(bs,	0, 1);    // error indicator
@@ -587,13 +635,11 @@ static void gf_m2ts_mux_table_get_next_packet(GF_M2TS_Mux *mux, GF_M2TS_Mux_Stre
 	gf_bs_write_int(bs,	adaptation_field_control, 2);    /*we do not use adaptation field for sections */
 	gf_bs_write_int(bs,	stream->continuity_counter, 4);   /*continuity counter*/
 
-	if (stream->continuity_counter < 15) stream->continuity_counter++;
-	else stream->continuity_counter=0;
-
-#ifdef USE_AF_STUFFING
-	if (adaptation_field_control != GF_M2TS_ADAPTATION_NONE)
-		gf_m2ts_add_adaptation(stream->program, bs, stream->pid, 0, 0, 0, padding_length, NULL, 0, GF_FALSE);
-#endif
+	if (adaptation_field_control != GF_M2TS_ADAPTATION_NONE) {
+		u8 af[188];
+		u32 af_len = gf_m2ts_add_adaptation(stream->program, af, stream->pid, 0, 0, 0, padding_length, NULL, 0, GF_FALSE);
+		gf_bs_write_data(bs, af, af_len);
+	}
 
 	/*pointer field*/
 	if (!stream->current_section_offset) {
@@ -602,11 +648,13 @@ static void gf_m2ts_mux_table_get_next_packet(GF_M2TS_Mux *mux, GF_M2TS_Mux_Stre
 	}
 
 	memcpy(packet+188-payload_start, section->data + stream->current_section_offset, payload_length);
-	stream->current_section_offset += payload_length;
-#ifndef USE_AF_STUFFING
-	if (padded_bytes) memset(packet+188-payload_start+payload_length, 0xFF, padded_bytes);
 #endif
 
+	if (stream->continuity_counter < 15) stream->continuity_counter++;
+	else stream->continuity_counter=0;
+
+	stream->current_section_offset += payload_length;
+
 	if (stream->current_section_offset == section->length) {
 		stream->current_section_offset = 0;
 		stream->current_section = stream->current_section->next;
@@ -1961,14 +2009,22 @@ static u32 gf_m2ts_stream_get_pes_header_length(GF_M2TS_Mux_Stream *stream)
 	return hdr_len;
 }
 
-u32 gf_m2ts_stream_add_pes_header(GF_BitStream *bs, GF_M2TS_Mux_Stream *stream)
+static GFINLINE void gf_m2ts_write_pes_timestamp(u8 *buf, u8 prefix, u64 ts)
 {
-	u64 t, dts, cts;
-	u32 pes_len;
-	Bool use_pts, use_dts;
+	//prefix(4) ts[32..30] marker ts[29..15] marker ts[14..0] marker
+	buf[0] = (u8) ( (prefix<<4) | (((ts >> 30) & 0x7) << 1) | 1);
+	buf[1] = (u8) (ts >> 22);
+	buf[2] = (u8) ( (((ts >> 15) & 0x7F) << 1) | 1);
+	buf[3] = (u8) (ts >> 7);
+	buf[4] = (u8) ( ((ts & 0x7F) << 1) | 1);
+}
 
-	gf_bs_write_int(bs,	0x1, 24);//packet start code
-	gf_bs_write_u8(bs,	stream->mpeg2_stream_id);// stream id
+//writes the PES header in buf and returns its size
+static u32 gf_m2ts_stream_add_pes_header(u8 *buf, GF_M2TS_Mux_Stream *stream)
+{
+	u64 dts, cts;
+	u32 pes_len, pos;
+	Bool use_pts, use_dts;
 
 	/*next AU start in current PES and current AU began in previous PES, use next AU timing*/
 	if (stream->pck_offset && stream->copy_from_next_packets) {
@@ -1995,54 +2051,35 @@ u32 gf_m2ts_stream_add_pes_header(GF_BitStream *bs, GF_M2TS_Mux_Stream *stream)
 	if (use_dts) pes_len += 5;
 
 	if (pes_len>0xFFFF) pes_len = 0;
-	gf_bs_write_int(bs, pes_len, 16); // pes packet length
-
-	gf_bs_write_int(bs, 0x2, 2); // reserved
-	gf_bs_write_int(bs, 0x0, 2); // scrambling
-	gf_bs_write_int(bs, 0x0, 1); // priority
-	gf_bs_write_int(bs, stream->pck_offset ? 0 : 1, 1); // alignment indicator - we could also check start codes to see if we are aligned at slice/video packet level
-	gf_bs_write_int(bs, 0x0, 1); // copyright
-	gf_bs_write_int(bs, 0x0, 1); // original or copy
 
-	gf_bs_write_int(bs, use_pts, 1);
-	gf_bs_write_int(bs, use_dts, 1);
-	gf_bs_write_int(bs, 0x0, 6); //6 flags = 0 (ESCR, ES_rate, DSM_trick, additional_copy, PES_CRC, PES_extension)
-
-	gf_bs_write_int(bs, use_dts*5+use_pts*5, 8);
+	//packet start code and stream id
+	buf[0] = buf[1] = 0;
+	buf[2] = 1;
+	buf[3] = stream->mpeg2_stream_id;
+	buf[4] = (u8) (pes_len >> 8);
+	buf[5] = (u8) (pes_len & 0xFF);
+	//'10', no scrambling, no priority, alignment indicator - we could also check start codes to see if we are aligned at slice/video packet level - no copyright, copy
+	buf[6] = stream->pck_offset ? 0x80 : 0x84;
+	//PTS and DTS flags, other flags (ESCR, ES_rate, DSM_trick, additional_copy, PES_CRC, PES_extension) are 0
+	buf[7] = (use_pts ? 0x80 : 0) | (use_dts ? 0x40 : 0);
+	buf[8] = use_dts*5 + use_pts*5;
+	pos = 9;
 
 	if (use_pts) {
-		gf_bs_write_int(bs, use_dts ? 0x3 : 0x2, 4); // reserved '0011' || '0010'
-		t = ((cts >> 30) & 0x7);
-		gf_bs_write_long_int(bs, t, 3);
-		gf_bs_write_int(bs, 1, 1); // marker bit
-		t = ((cts >> 15) & 0x7fff);
-		gf_bs_write_long_int(bs, t, 15);
-		gf_bs_write_int(bs, 1, 1); // marker bit
-		t = cts & 0x7fff;
-		gf_bs_write_long_int(bs, t, 15);
-		gf_bs_write_int(bs, 1, 1); // marker bit
+		gf_m2ts_write_pes_timestamp(buf+pos, use_dts ? 0x3 : 0x2, cts);
+		pos += 5;
 	}
-
 	if (use_dts) {
-		gf_bs_write_int(bs, 0x1, 4); // reserved '0001'
-		t = ((dts >> 30) & 0x7);
-		gf_bs_write_long_int(bs, t, 3);
-		gf_bs_write_int(bs, 1, 1); // marker bit
-		t = ((dts >> 15) & 0x7fff);
-		gf_bs_write_long_int(bs, t, 15);
-		gf_bs_write_int(bs, 1, 1); // marker bit
-		t = dts & 0x7fff;
-		gf_bs_write_long_int(bs, t, 15);
-		gf_bs_write_int(bs, 1, 1); // marker bit
+		gf_m2ts_write_pes_timestamp(buf+pos, 0x1, dts);
+		pos += 5;
 	}
 	GF_LOG(GF_LOG_DEBUG, GF_LOG_CONTAINER, ("[MPEG-2 TS Muxer] PID %d: Adding PES header at PCR "LLD" - has PTS %d ("LLU") - has DTS %d ("LLU") - Payload length %d\n", stream->pid, gf_m2ts_get_pcr(stream)/300, use_pts, cts, use_dts, dts, pes_len));
 
-	return pes_len+4; // 4 = start code + stream_id
+	return pos;
 }
 
 void gf_m2ts_mux_pes_get_next_packet(GF_M2TS_Mux_Stream *stream, char *packet)
 {
-	GF_BitStream *bs;
 	Bool needs_pcr, first_pass;
 	u32 adaptation_field_control, payload_length, payload_to_copy, padding_length, hdr_len, pos, copy_next;
 
@@ -2187,27 +2224,12 @@ void gf_m2ts_mux_pes_get_next_packet(GF_M2TS_Mux_Stream *stream, char *packet)
 		else stream->continuity_counter--;
 	}
 
-	bs = stream->program->mux->pck_bs;
-	gf_bs_reassign_buffer(bs, packet, 188);
-
-	//small opt for formatting TS header for PES, don't use bitstream for header, slightly faster
-#if 0
-	gf_bs_write_int(bs,	0x47, 8); // sync byte
-	gf_bs_write_int(bs,	0, 1);    // error indicator
-	gf_bs_write_int(bs,	hdr_len ? 1 : 0, 1); // start ind
-	gf_bs_write_int(bs,	0, 1);	  // transport priority
-	gf_bs_write_int(bs,	stream->pid, 13); // pid
-	gf_bs_write_int(bs,	0, 2);    // scrambling
-	gf_bs_write_int(bs,	adaptation_field_control, 2);    // we do not use adaptation field for sections
-	gf_bs_write_int(bs,	stream->continuity_counter, 4);   // continuity counter
-#else
 	packet[0] = 0x47; // sync byte
 	packet[1] = (stream->pid>>8) & 0x1F; //high bits of PID
 	if (hdr_len) packet[1] |= 0x40; // start ind
 	packet[2] = stream->pid & 0xFF; //low bits of PID
 	packet[3] = (adaptation_field_control<<4) | (stream->continuity_counter & 0xF); //AF + CC
-	gf_bs_seek(bs, 4);
-#endif
+	pos = 4;
 
 	if (stream->continuity_counter < 15) stream->continuity_counter++;
 	else stream->continuity_counter=0;
@@ -2248,7 +2270,7 @@ void gf_m2ts_mux_pes_get_next_packet(GF_M2TS_Mux_Stream *stream, char *packet)
 			stream->program->nb_pck_last_pcr = stream->program->mux->tot_pck_sent;
 		}
 		is_rap = (hdr_len && (stream->curr_pck.sap_type) ) ? GF_TRUE : GF_FALSE;
-		gf_m2ts_add_adaptation(stream->program, bs, stream->pid, needs_pcr, pcr, is_rap, padding_length, hdr_len ? stream->curr_pck.mpeg2_af_descriptors : NULL, hdr_len ? stream->curr_pck.mpeg2_af_descriptors_size : 0, stream->set_initial_disc);
+		pos += gf_m2ts_add_adaptation(stream->program, (u8 *) packet+pos, stream->pid, needs_pcr, pcr, is_rap, padding_length, hdr_len ? stream->curr_pck.mpeg2_af_descriptors : NULL, hdr_len ? stream->curr_pck.mpeg2_af_descriptors_size : 0, stream->set_initial_disc);
 		stream->set_initial_disc = GF_FALSE;
 
 		if (stream->curr_pck.mpeg2_af_descriptors) {
@@ -2263,15 +2285,13 @@ void gf_m2ts_mux_pes_get_next_packet(GF_M2TS_Mux_Stream *stream, char *packet)
 	stream->pck_sap_type = 0;
 	stream->pck_sap_time = 0;
 	if (hdr_len) {
-		gf_m2ts_stream_add_pes_header(bs, stream);
+		pos += gf_m2ts_stream_add_pes_header((u8 *) packet+pos, stream);
 		if (stream->curr_pck.sap_type) {
 			stream->pck_sap_type = 1;
 			stream->pck_sap_time = stream->curr_pck.cts;
 		}
 	}
 
-	pos = (u32) gf_bs_get_position(bs);
-
 	if (adaptation_field_control == GF_M2TS_ADAPTATION_ONLY) {
 		return;
 	}
@@ -3060,8 +3080,7 @@ void gf_m2ts_mux_stream_del(GF_M2TS_Mux_Stream *st)
 		GF_M2TS_Mux_Table *tab = st->tables->next;
 		while (st->tables->section) {
 			GF_M2TS_Mux_Section *sec = st->tables->section->next;
-			gf_free(st->tables->section->data);
-			gf_free(st->tables->section);
+			gf_m2ts_mux_section_del(st->tables->section);
 			st->tables->section = sec;
 		}
 		gf_free(st->tables);
@@ -3560,13 +3579,18 @@ send_pck:
 		if (muxer->fixed_rate) {
 			GF_LOG(GF_LOG_DEBUG, GF_LOG_CONTAINER, ("[MPEG2-TS Muxer] Inserting empty packet at %d:%09d\n", time.sec, time.nanosec));
 			ret = muxer->null_pck;
+			if (muxer->pck_buffer) {
+				memcpy(muxer->pck_buffer, muxer->null_pck, 188);
+				ret = (char *) muxer->pck_buffer;
+			}
 			muxer->tot_pad_sent++;
 		}
 	} else {
+		ret = muxer->pck_buffer ? (char *) muxer->pck_buffer : muxer->dst_pck;
 		if (stream_to_process->tables) {
-			gf_m2ts_mux_table_get_next_packet(muxer, stream_to_process, muxer->dst_pck);
+			gf_m2ts_mux_table_get_next_packet(muxer, stream_to_process, ret);
 		} else {
-			gf_m2ts_mux_pes_get_next_packet(stream_to_process, muxer->dst_pck);
+			gf_m2ts_mux_pes_get_next_packet(stream_to_process, ret);
 			if (stream_to_process->pid == muxer->ref_pid) {
 				if (stream_to_process->pck_sap_type) {
 					muxer->sap_inserted = GF_TRUE;
@@ -3578,7 +3602,6 @@ send_pck:
 			}
 		}
 
-		ret = muxer->dst_pck;
 		*status = GF_M2TS_STATE_DATA;
 
 		GF_LOG(GF_LOG_DEBUG, GF_LOG_CONTAINER, ("[MPEG2-TS Muxer] Sending %s from PID %d at %d:%09d - mux time %d:%09d\n", stream_to_process->tables ? "table" : "PES", stream_to_process->pid, time.sec, time.nanosec, muxer->time.sec, muxer->time.nanosec));
@@ -3619,4 +3642,10 @@ send_pck:
 	return ret;
 }
 
+GF_EXPORT
+void gf_m2ts_mux_set_packet_buffer(GF_M2TS_Mux *muxer, u8 *buffer)
+{
+	if (muxer) muxer->pck_buffer = buffer;
+}
+
 #endif /*GPAC_DISABLE_MPEG2TS_MUX*/
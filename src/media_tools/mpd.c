@@ -100,6 +100,32 @@ static char *gf_mpd_parse_text_content(GF_XMLNode *child)
 	return NULL;
 }
 
+/*segment URLs or timeline entries parsed by the SAX loader, waiting for the parsing of their SegmentList or SegmentTimeline node*/
+typedef struct
+{
+	GF_XMLNode *node;
+	GF_List *items;
+	Bool is_timeline;
+	u64 curr_start_time;
+} GF_MPD_SAXSegments;
+
+static GF_List *gf_mpd_sax_segments_get(GF_MPD *mpd, GF_XMLNode *node)
+{
+	u32 i, count;
+	if (!mpd->sax_segments) return NULL;
+	count = gf_list_count(mpd->sax_segments);
+	for (i=0; i<count; i++) {
+		GF_List *items;
+		GF_MPD_SAXSegments *segs = gf_list_get(mpd->sax_segments, i);
+		if (segs->node != node) continue;
+		items = segs->items;
+		gf_list_rem(mpd->sax_segments, i);
+		gf_free(segs);
+		return items;
+	}
+	return NULL;
+}
+
 static u32 gf_mpd_parse_int(const char * const attr)
 {
 	return atoi(attr);
@@ -364,17 +390,41 @@ static void gf_mpd_parse_segment_base_generic(GF_MPD *mpd, GF_MPD_SegmentBase *s
 	}
 }
 
+static void gf_mpd_parse_segment_timeline_entry(GF_MPD_SegmentTimelineEntry *seg_tl_ent, const GF_XMLAttribute *att)
+{
+	if (!strcmp(att->name, "t"))
+		seg_tl_ent->start_time = gf_mpd_parse_long_int(att->value);
+	else if (!strcmp(att->name, "d"))
+		seg_tl_ent->duration = gf_mpd_parse_int(att->value);
+	else if (!strcmp(att->name, "r")) {
+		seg_tl_ent->repeat_count = gf_mpd_parse_int(att->value);
+		if (seg_tl_ent->repeat_count == (u32)-1)
+			seg_tl_ent->repeat_count--;
+	}
+	else if (!strcmp(att->name, "k"))
+		seg_tl_ent->nb_parts = gf_mpd_parse_int(att->value);
+}
+
 static GF_MPD_SegmentTimeline *gf_mpd_parse_segment_timeline(GF_MPD *mpd, GF_XMLNode *root)
 {
 	u32 i, j;
 	u64 curr_start_time = 0;
 	GF_XMLAttribute *att;
 	GF_XMLNode *child;
+	GF_List *items;
 	GF_MPD_SegmentTimeline *seg;
 	GF_SAFEALLOC(seg, GF_MPD_SegmentTimeline);
 	if (!seg) return NULL;
 	seg->entries = gf_list_new();
 
+	//entries already parsed by the SAX loader
+	items = gf_mpd_sax_segments_get(mpd, root);
+	if (items) {
+		gf_list_del(seg->entries);
+		seg->entries = items;
+		return seg;
+	}
+
 	i = 0;
 	while ( (child = gf_list_enum(root->content, &i))) {
 		if (!gf_mpd_valid_child(mpd, child)) continue;
@@ -387,17 +437,7 @@ static GF_MPD_SegmentTimeline *gf_mpd_parse_segment_timeline(GF_MPD *mpd, GF_XML
 
 			j = 0;
 			while ( (att = gf_list_enum(child->attributes, &j)) ) {
-				if (!strcmp(att->name, "t"))
-					seg_tl_ent->start_time = gf_mpd_parse_long_int(att->value);
-				else if (!strcmp(att->name, "d"))
-					seg_tl_ent->duration = gf_mpd_parse_int(att->value);
-				else if (!strcmp(att->name, "r")) {
-					seg_tl_ent->repeat_count = gf_mpd_parse_int(att->value);
-					if (seg_tl_ent->repeat_count == (u32)-1)
-						seg_tl_ent->repeat_count--;
-				}
-				else if (!strcmp(att->name, "k"))
-					seg_tl_ent->nb_parts = gf_mpd_parse_int(att->value);
+				gf_mpd_parse_segment_timeline_entry(seg_tl_ent, att);
 			}
 			if (seg_tl_ent->start_time)
 				curr_start_time = seg_tl_ent->start_time;
@@ -459,6 +499,32 @@ GF_MPD_SegmentURL *gf_mpd_segmenturl_new(const char*media, u64 start_range, u64
 }
 #endif
 
+static Bool gf_mpd_parse_segment_url_attr(GF_MPD_SegmentURL *seg, const GF_XMLAttribute *att)
+{
+	if (!strcmp(att->name, "media")) seg->media = gf_mpd_parse_string(att->value);
+	else if (!strcmp(att->name, "index")) seg->index = gf_mpd_parse_string(att->value);
+	else if (!strcmp(att->name, "mediaRange")) seg->media_range = gf_mpd_parse_byte_range(att->value);
+	else if (!strcmp(att->name, "indexRange")) seg->index_range = gf_mpd_parse_byte_range(att->value);
+	//else if (!strcmp(att->name, "hls:keyMethod")) seg->key_url = gf_mpd_parse_string(att->value);
+	else if (!strcmp(att->name, "hls:keyURL")) seg->key_url = gf_mpd_parse_string(att->value);
+	else if (!strcmp(att->name, "hls:keyIV")) {
+		GF_Err e = gf_bin128_parse(att->value, seg->key_iv);
+		if (e != GF_OK) {
+			GF_LOG(GF_LOG_WARNING, GF_LOG_DASH, ("[MPD] Cannot parse hls:keyIV\n"));
+			return GF_FALSE;
+		}
+	}
+	else if (!strcmp(att->name, "duration")) seg->duration=gf_mpd_parse_int(att->value);
+	else if (!strcmp(att->name, "t")) seg->first_tfdt = gf_mpd_parse_long_int(att->value);
+	else if (!strcmp(att->name, "n")) seg->first_pck_seq = gf_mpd_parse_int(att->value);
+	else if (!strcmp(att->name, "d")) seg->duration = gf_mpd_parse_int(att->value);
+	else if (!strcmp(att->name, "s")) seg->frag_start_offset = gf_mpd_parse_long_int(att->value);
+	else if (!strcmp(att->name, "dt")) seg->frag_tfdt = gf_mpd_parse_long_int(att->value);
+	else if (!strcmp(att->name, "f")) seg->split_first_dur = gf_mpd_parse_int(att->value);
+	else if (!strcmp(att->name, "l")) seg->split_last_dur = gf_mpd_parse_int(att->value);
+	return GF_TRUE;
+}
+
 void gf_mpd_parse_segment_url(GF_List *container, GF_XMLNode *root)
 {
 	u32 i;
@@ -471,27 +537,7 @@ void gf_mpd_parse_segment_url(GF_List *container, GF_XMLNode *root)
 
 	i = 0;
 	while ( (att = gf_list_enum(root->attributes, &i)) ) {
-		if (!strcmp(att->name, "media")) seg->media = gf_mpd_parse_string(att->value);
-		else if (!strcmp(att->name, "index")) seg->index = gf_mpd_parse_string(att->value);
-		else if (!strcmp(att->name, "mediaRange")) seg->media_range = gf_mpd_parse_byte_range(att->value);
-		else if (!strcmp(att->name, "indexRange")) seg->index_range = gf_mpd_parse_byte_range(att->value);
-		//else if (!strcmp(att->name, "hls:keyMethod")) seg->key_url = gf_mpd_parse_string(att->value);
-		else if (!strcmp(att->name, "hls:keyURL")) seg->key_url = gf_mpd_parse_string(att->value);
-		else if (!strcmp(att->name, "hls:keyIV")) {
-			GF_Err e = gf_bin128_parse(att->value, seg->key_iv);
-			if (e != GF_OK) {
-				GF_LOG(GF_LOG_WARNING, GF_LOG_DASH, ("[MPD] Cannot parse hls:keyIV\n"));
-				return;
-			}
-		}
-		else if (!strcmp(att->name, "duration")) seg->duration=gf_mpd_parse_int(att->value);
-		else if (!strcmp(att->name, "t")) seg->first_tfdt = gf_mpd_parse_long_int(att->value);
-		else if (!strcmp(att->name, "n")) seg->first_pck_seq = gf_mpd_parse_int(att->value);
-		else if (!strcmp(att->name, "d")) seg->duration = gf_mpd_parse_int(att->value);
-		else if (!strcmp(att->name, "s")) seg->frag_start_offset = gf_mpd_parse_long_int(att->value);
-		else if (!strcmp(att->name, "dt")) seg->frag_tfdt = gf_mpd_parse_long_int(att->value);
-		else if (!strcmp(att->name, "f")) seg->split_first_dur = gf_mpd_parse_int(att->value);
-		else if (!strcmp(att->name, "l")) seg->split_last_dur = gf_mpd_parse_int(att->value);
+		if (!gf_mpd_parse_segment_url_attr(seg, att)) return;
 	}
 }
 
@@ -501,6 +547,7 @@ static GF_MPD_SegmentList *gf_mpd_parse_segment_list(GF_MPD *mpd, GF_XMLNode *ro
 	GF_MPD_SegmentList *seg;
 	GF_XMLAttribute *att;
 	GF_XMLNode *child;
+	GF_List *items;
 
 	GF_SAFEALLOC(seg, GF_MPD_SegmentList);
 	if (!seg) return NULL;
@@ -518,6 +565,13 @@ static GF_MPD_SegmentList *gf_mpd_parse_segment_list(GF_MPD *mpd, GF_XMLNode *ro
 	}
 	gf_mpd_parse_multiple_segment_base(mpd, (GF_MPD_MultipleSegmentBase *)seg, root);
 
+	//segment URLs already parsed by the SAX loader
+	items = gf_mpd_sax_segments_get(mpd, root);
+	if (items) {
+		gf_list_del(seg->segment_URLs);
+		seg->segment_URLs = items;
+	}
+
 	i = 0;
 	while ( (child = gf_list_enum(root->content, &i))) {
 		if (!gf_mpd_valid_child(mpd, child)) continue;
@@ -744,6 +798,7 @@ static void gf_mpd_init_common_attributes(GF_MPD_CommonAttributes *com)
 	com->max_playout_rate = 1.0;
 }
 
+GF_EXPORT
 GF_MPD_Representation *gf_mpd_representation_new()
 {
 	GF_MPD_Representation *rep;
@@ -903,6 +958,7 @@ static GF_Err gf_mpd_parse_representation(GF_MPD *mpd, GF_List *container, GF_XM
 	return GF_OK;
 }
 
+GF_EXPORT
 GF_MPD_AdaptationSet *gf_mpd_adaptation_set_new() {
 	GF_MPD_AdaptationSet *set;
 	GF_SAFEALLOC(set, GF_MPD_AdaptationSet);
@@ -1017,6 +1073,7 @@ static GF_Err gf_mpd_parse_adaptation_set(GF_MPD *mpd, GF_List *container, GF_XM
 	return GF_OK;
 }
 
+GF_EXPORT
 GF_MPD_Period *gf_mpd_period_new() {
 	GF_MPD_Period *period;
 	GF_SAFEALLOC(period, GF_MPD_Period);
@@ -1173,6 +1230,57 @@ void gf_mpd_segment_base_free(void *_item)
 	gf_free(ptr);
 }
 
+//serialized text is flushed to the output file once above this size
+#define MPD_TEXT_FLUSH_SIZE	0x10000
+
+/*text buffer for manifest parts kept serialized across live updates*/
+typedef struct
+{
+	char *data;
+	u32 size, alloc;
+} MPDText;
+
+/*snapshot of a timeline entry or segment state, and offset of its serialized text*/
+typedef struct
+{
+	void *src;
+	u32 txt_start;
+	u32 flags;
+	u64 time, dur, offset;
+	u32 num, size;
+	const void *key;
+} MPDCacheItem;
+
+/*serialized text of a contiguous run of timeline entries or segment states, first item of the run is the oldest one
+items sharing the same text offset are merged in a single element*/
+typedef struct
+{
+	MPDCacheItem *items;
+	u32 first, count, alloc;
+	MPDText txt;
+	/*serialization context of the text*/
+	s32 indent;
+	u32 timescale, crypto_type;
+	char *base_url, *b_url;
+} MPDPrintCache;
+
+static void mpd_cache_reset(MPDPrintCache *cache)
+{
+	cache->first = cache->count = 0;
+	cache->txt.size = 0;
+}
+
+static void mpd_cache_del(void *_cache)
+{
+	MPDPrintCache *cache = (MPDPrintCache *)_cache;
+	if (!cache) return;
+	if (cache->items) gf_free(cache->items);
+	if (cache->txt.data) gf_free(cache->txt.data);
+	if (cache->base_url) gf_free(cache->base_url);
+	if (cache->b_url) gf_free(cache->b_url);
+	gf_free(cache);
+}
+
 void gf_mpd_segment_entry_free(void *_item)
 {
 	gf_free(_item);
@@ -1181,6 +1289,7 @@ void gf_mpd_segment_timeline_free(void *_item)
 {
 	GF_MPD_SegmentTimeline *ptr = (GF_MPD_SegmentTimeline *)_item;
 	gf_mpd_del_list(ptr->entries, gf_mpd_segment_entry_free, 0);
+	mpd_cache_del(ptr->print_cache);
 	gf_free(ptr);
 }
 
@@ -1339,6 +1448,7 @@ void gf_mpd_representation_free(void *_item)
 	if (ptr->m3u8_name) gf_free(ptr->m3u8_name);
 	if (ptr->m3u8_var_name) gf_free(ptr->m3u8_var_name);
 	if (ptr->m3u8_var_file) gf_fclose(ptr->m3u8_var_file);
+	mpd_cache_del(ptr->m3u8_cache);
 	if (ptr->res_url) gf_free(ptr->res_url);
 	gf_free(ptr);
 }
@@ -1366,6 +1476,7 @@ void gf_mpd_adaptation_set_free(void *_item)
 	gf_free(ptr);
 }
 
+GF_EXPORT
 void gf_mpd_period_free(void *_item)
 {
 	GF_MPD_Period *ptr = (GF_MPD_Period *)_item;
@@ -1401,6 +1512,7 @@ void gf_mpd_del(GF_MPD *mpd)
 	gf_mpd_del_list(mpd->periods, gf_mpd_period_free, 0);
 	if (mpd->profiles) gf_free(mpd->profiles);
 	if (mpd->ID) gf_free(mpd->ID);
+	if (mpd->patch_location) gf_free(mpd->patch_location);
 	if (mpd->segment_template) gf_free(mpd->segment_template);
 	gf_mpd_del_list(mpd->utc_timings, gf_mpd_descriptor_free, 0);
 	gf_mpd_del_list(mpd->essential_properties, gf_mpd_descriptor_free, 0);
@@ -1410,6 +1522,68 @@ void gf_mpd_del(GF_MPD *mpd)
 }
 
 
+//parses an attribute of the MPD element, returns GF_FALSE if the attribute is not known
+static Bool gf_mpd_parse_root_attribute(GF_MPD *mpd, GF_XMLAttribute *att)
+{
+	if (!strcmp(att->name, "id")) {
+		if (mpd->ID) gf_free(mpd->ID);
+		mpd->ID = gf_mpd_parse_string(att->value);
+	} else if (!strcmp(att->name, "profiles")) {
+		if (mpd->profiles) gf_free(mpd->profiles);
+		mpd->profiles = gf_mpd_parse_string(att->value);
+	} else if (!strcmp(att->name, "type")) {
+		if (!strcmp(att->value, "static")) mpd->type = GF_MPD_TYPE_STATIC;
+		else if (!strcmp(att->value, "dynamic")) mpd->type = GF_MPD_TYPE_DYNAMIC;
+	} else if (!strcmp(att->name, "availabilityStartTime")) {
+		mpd->availabilityStartTime = gf_mpd_parse_date(att->value);
+	} else if (!strcmp(att->name, "availabilityEndTime")) {
+		mpd->availabilityEndTime = gf_mpd_parse_date(att->value);
+	} else if (!strcmp(att->name, "publishTime")) {
+		mpd->publishTime = gf_mpd_parse_date(att->value);
+	} else if (!strcmp(att->name, "mediaPresentationDuration")) {
+		mpd->media_presentation_duration = gf_mpd_parse_duration(att->value);
+	} else if (!strcmp(att->name, "minimumUpdatePeriod")) {
+		mpd->minimum_update_period = gf_mpd_parse_duration_u32(att->value);
+	} else if (!strcmp(att->name, "minBufferTime")) {
+		mpd->min_buffer_time = gf_mpd_parse_duration_u32(att->value);
+	} else if (!strcmp(att->name, "timeShiftBufferDepth")) {
+		mpd->time_shift_buffer_depth = gf_mpd_parse_duration_u32(att->value);
+	} else if (!strcmp(att->name, "suggestedPresentationDelay")) {
+		mpd->suggested_presentation_delay = gf_mpd_parse_duration_u32(att->value);
+	} else if (!strcmp(att->name, "maxSegmentDuration")) {
+		mpd->max_segment_duration = gf_mpd_parse_duration_u32(att->value);
+	} else if (!strcmp(att->name, "maxSubsegmentDuration")) {
+		mpd->max_subsegment_duration = gf_mpd_parse_duration_u32(att->value);
+	} else if (!strcmp(att->name, "gpac:init_gen_time")) {
+		mpd->gpac_init_ntp_ms = gf_mpd_parse_long_int(att->value);
+	} else if (!strcmp(att->name, "gpac:next_gen_time")) {
+		mpd->gpac_next_ntp_ms = gf_mpd_parse_long_int(att->value);
+	} else if (!strcmp(att->name, "gpac:mpd_time")) {
+		mpd->gpac_mpd_time = gf_mpd_parse_long_int(att->value);
+	} else if (!strcmp(att->name, "segmentDuration")) {
+		mpd->segment_duration = gf_mpd_parse_duration_u32(att->value);
+	} else if (!strcmp(att->name, "template")) {
+		if (mpd->segment_template) gf_free(mpd->segment_template);
+		mpd->segment_template = gf_mpd_parse_string(att->value);
+	} else {
+		return GF_FALSE;
+	}
+	return GF_TRUE;
+}
+
+//parses a PatchLocation element
+static void gf_mpd_parse_patch_location(GF_MPD *mpd, GF_XMLNode *node)
+{
+	u32 i=0;
+	GF_XMLAttribute *att;
+	if (mpd->patch_location) gf_free(mpd->patch_location);
+	mpd->patch_location = gf_mpd_parse_text_content(node);
+	mpd->patch_ttl = 0;
+	while ((att = gf_list_enum(node->attributes, &i))) {
+		if (!strcmp(att->name, "ttl")) mpd->patch_ttl = gf_mpd_parse_int(att->value);
+	}
+}
+
 GF_EXPORT
 GF_Err gf_mpd_complete_from_dom(GF_XMLNode *root, GF_MPD *mpd, const char *default_base_url)
 {
@@ -1454,46 +1628,7 @@ GF_Err gf_mpd_complete_from_dom(GF_XMLNode *root, GF_MPD *mpd, const char *defau
 
 	i = 0;
 	while ((att = gf_list_enum(root->attributes, &i))) {
-		if (!strcmp(att->name, "id")) {
-			if (mpd->ID) gf_free(mpd->ID);
-			mpd->ID = gf_mpd_parse_string(att->value);
-		} else if (!strcmp(att->name, "profiles")) {
-			if (mpd->profiles) gf_free(mpd->profiles);
-			mpd->profiles = gf_mpd_parse_string(att->value);
-		} else if (!strcmp(att->name, "type")) {
-			if (!strcmp(att->value, "static")) mpd->type = GF_MPD_TYPE_STATIC;
-			else if (!strcmp(att->value, "dynamic")) mpd->type = GF_MPD_TYPE_DYNAMIC;
-		} else if (!strcmp(att->name, "availabilityStartTime")) {
-			mpd->availabilityStartTime = gf_mpd_parse_date(att->value);
-		} else if (!strcmp(att->name, "availabilityEndTime")) {
-			mpd->availabilityEndTime = gf_mpd_parse_date(att->value);
-		} else if (!strcmp(att->name, "publishTime")) {
-			mpd->publishTime = gf_mpd_parse_date(att->value);
-		} else if (!strcmp(att->name, "mediaPresentationDuration")) {
-			mpd->media_presentation_duration = gf_mpd_parse_duration(att->value);
-		} else if (!strcmp(att->name, "minimumUpdatePeriod")) {
-			mpd->minimum_update_period = gf_mpd_parse_duration_u32(att->value);
-		} else if (!strcmp(att->name, "minBufferTime")) {
-			mpd->min_buffer_time = gf_mpd_parse_duration_u32(att->value);
-		} else if (!strcmp(att->name, "timeShiftBufferDepth")) {
-			mpd->time_shift_buffer_depth = gf_mpd_parse_duration_u32(att->value);
-		} else if (!strcmp(att->name, "suggestedPresentationDelay")) {
-			mpd->suggested_presentation_delay = gf_mpd_parse_duration_u32(att->value);
-		} else if (!strcmp(att->name, "maxSegmentDuration")) {
-			mpd->max_segment_duration = gf_mpd_parse_duration_u32(att->value);
-		} else if (!strcmp(att->name, "maxSubsegmentDuration")) {
-			mpd->max_subsegment_duration = gf_mpd_parse_duration_u32(att->value);
-		} else if (!strcmp(att->name, "gpac:init_gen_time")) {
-			mpd->gpac_init_ntp_ms = gf_mpd_parse_long_int(att->value);
-		} else if (!strcmp(att->name, "gpac:next_gen_time")) {
-			mpd->gpac_next_ntp_ms = gf_mpd_parse_long_int(att->value);
-		} else if (!strcmp(att->name, "gpac:mpd_time")) {
-			mpd->gpac_mpd_time = gf_mpd_parse_long_int(att->value);
-		} else if (!strcmp(att->name, "segmentDuration")) {
-			mpd->segment_duration = gf_mpd_parse_duration_u32(att->value);
-		} else if (!strcmp(att->name, "template")) {
-			mpd->segment_template = gf_mpd_parse_string(att->value);
-		} else {
+		if (!gf_mpd_parse_root_attribute(mpd, att)) {
 			MPD_STORE_EXTENSION_ATTR(mpd)
 		}
 	}
@@ -1512,6 +1647,8 @@ GF_Err gf_mpd_complete_from_dom(GF_XMLNode *root, GF_MPD *mpd, const char *defau
 		} else if (!strcmp(child->name, "Location")) {
 			char *str = gf_mpd_parse_text_content(child);
 			if (str) gf_list_add(mpd->locations, str);
+		} else if (!strcmp(child->name, "PatchLocation")) {
+			gf_mpd_parse_patch_location(mpd, child);
 		} else if (!strcmp(child->name, "PrePeriod") || !strcmp(child->name, "Period")) {
 			e = gf_mpd_parse_period(mpd, child);
 			if (e) return e;
@@ -1564,6 +1701,857 @@ GF_Err gf_mpd_init_from_dom(GF_XMLNode *root, GF_MPD *mpd, const char *default_b
 	return gf_mpd_complete_from_dom(root, mpd, default_base_url);
 }
 
+/*SAX loader: builds a light DOM of the MPD, parsing SegmentURL and S elements as soon as they are found*/
+typedef struct
+{
+	GF_SAXParser *sax;
+	GF_MPD *mpd;
+	GF_XMLNode *root;
+	GF_List *stack;
+	//namespace prefix of MPD elements, NULL if none
+	const char *ns;
+	Bool index_mode;
+	//depth of the element tree ignored below a parsed segment entry
+	u32 skip_depth;
+	GF_MPD_SAXSegments *last_segs;
+	GF_Err e;
+} GF_MPD_SAXLoader;
+
+static Bool gf_mpd_sax_valid_ns(GF_MPD_SAXLoader *ldr, const char *ns)
+{
+	if (!ldr->ns && !ns) return GF_TRUE;
+	if (ldr->ns && ns && !strcmp(ldr->ns, ns)) return GF_TRUE;
+	if (ns && !strcmp(ns, "gpac")) return GF_TRUE;
+	return GF_FALSE;
+}
+
+static GF_MPD_SAXSegments *gf_mpd_sax_get_segments(GF_MPD_SAXLoader *ldr, GF_XMLNode *parent, Bool is_timeline)
+{
+	GF_MPD_SAXSegments *segs = ldr->last_segs;
+	if (segs && (segs->node == parent)) return segs;
+
+	GF_SAFEALLOC(segs, GF_MPD_SAXSegments);
+	if (!segs) return NULL;
+	segs->node = parent;
+	segs->is_timeline = is_timeline;
+	segs->items = gf_list_new();
+	gf_list_add(ldr->mpd->sax_segments, segs);
+	ldr->last_segs = segs;
+	return segs;
+}
+
+static Bool gf_mpd_sax_parse_segment(GF_MPD_SAXLoader *ldr, GF_XMLNode *parent, const char *name, const GF_XMLAttribute *attributes, u32 nb_attributes)
+{
+	u32 i;
+	GF_MPD_SAXSegments *segs;
+
+	if (!strcmp(parent->name, "SegmentList") && !strcmp(name, ldr->index_mode ? "I" : "SegmentURL")) {
+		GF_MPD_SegmentURL *seg;
+		segs = gf_mpd_sax_get_segments(ldr, parent, GF_FALSE);
+		if (!segs) return GF_FALSE;
+		GF_SAFEALLOC(seg, GF_MPD_SegmentURL);
+		if (!seg) return GF_FALSE;
+		gf_list_add(segs->items, seg);
+		for (i=0; i<nb_attributes; i++) {
+			if (!gf_mpd_parse_segment_url_attr(seg, &attributes[i])) break;
+		}
+		return GF_TRUE;
+	}
+	if (!strcmp(parent->name, "SegmentTimeline") && !strcmp(name, "S")) {
+		GF_MPD_SegmentTimelineEntry *seg_tl_ent;
+		segs = gf_mpd_sax_get_segments(ldr, parent, GF_TRUE);
+		if (!segs) return GF_FALSE;
+		GF_SAFEALLOC(seg_tl_ent, GF_MPD_SegmentTimelineEntry);
+		if (!seg_tl_ent) return GF_FALSE;
+		seg_tl_ent->start_time = segs->curr_start_time;
+		gf_list_add(segs->items, seg_tl_ent);
+		for (i=0; i<nb_attributes; i++) {
+			gf_mpd_parse_segment_timeline_entry(seg_tl_ent, &attributes[i]);
+		}
+		if (seg_tl_ent->start_time)
+			segs->curr_start_time = seg_tl_ent->start_time;
+
+		segs->curr_start_time += (u64) (seg_tl_ent->duration * (seg_tl_ent->repeat_count+1));
+		return GF_TRUE;
+	}
+	return GF_FALSE;
+}
+
+static void gf_mpd_sax_node_start(void *cbk, const char *name, const char *ns, const GF_XMLAttribute *attributes, u32 nb_attributes)
+{
+	u32 i;
+	GF_XMLNode *node, *parent;
+	GF_MPD_SAXLoader *ldr = (GF_MPD_SAXLoader *)cbk;
+
+	if (ldr->skip_depth) {
+		ldr->skip_depth++;
+		return;
+	}
+	//single root element
+	if (ldr->root && !gf_list_count(ldr->stack)) {
+		gf_xml_sax_suspend(ldr->sax, GF_TRUE);
+		return;
+	}
+	parent = gf_list_last(ldr->stack);
+	if (parent && gf_mpd_sax_valid_ns(ldr, ns) && gf_mpd_sax_parse_segment(ldr, parent, name, attributes, nb_attributes)) {
+		ldr->skip_depth = 1;
+		return;
+	}
+
+	GF_SAFEALLOC(node, GF_XMLNode);
+	if (!node) {
+		ldr->e = GF_OUT_OF_MEM;
+		gf_xml_sax_suspend(ldr->sax, GF_TRUE);
+		return;
+	}
+	node->attributes = gf_list_new();
+	node->name = gf_strdup(name);
+	if (ns) node->ns = gf_strdup(ns);
+	gf_list_add(ldr->stack, node);
+	for (i=0; i<nb_attributes; i++) {
+		GF_XMLAttribute *att;
+		GF_SAFEALLOC(att, GF_XMLAttribute);
+		if (!att) {
+			ldr->e = GF_OUT_OF_MEM;
+			gf_xml_sax_suspend(ldr->sax, GF_TRUE);
+			return;
+		}
+		att->name = gf_strdup(attributes[i].name);
+		att->value = gf_strdup(attributes[i].value);
+		gf_list_add(node->attributes, att);
+	}
+	if (ldr->root) return;
+
+	//same namespace rules as gf_mpd_complete_from_dom
+	ldr->root = node;
+	for (i=0; i<nb_attributes; i++) {
+		const GF_XMLAttribute *att = &attributes[i];
+		if (!ns && !strcmp(att->name, "xmlns")) {
+			if (!strcmp(att->value, "urn:gpac:dash:index:2023")) ldr->index_mode = GF_TRUE;
+			break;
+		}
+		if (ns && !strncmp(att->name, "xmlns:", 6) && !strcmp(att->name+6, ns)
+			&& (!strcmp(att->value, "urn:mpeg:dash:schema:mpd:2011") || !strcmp(att->value, "urn:mpeg:DASH:schema:MPD:2011"))
+		) {
+			ldr->ns = node->ns;
+			break;
+		}
+	}
+}
+
+static void gf_mpd_sax_node_end(void *cbk, const char *name, const char *ns)
+{
+	GF_XMLNode *node, *parent;
+	GF_MPD_SAXLoader *ldr = (GF_MPD_SAXLoader *)cbk;
+
+	if (ldr->skip_depth) {
+		ldr->skip_depth--;
+		return;
+	}
+	node = gf_list_pop_back(ldr->stack);
+	if (!node || strcmp(node->name, name) || (!ns && node->ns) || (ns && !node->ns) || (ns && strcmp(node->ns, ns))) {
+		GF_LOG(GF_LOG_ERROR, GF_LOG_DASH, ("[MPD] Invalid node stack: closing node is %s but %s was expected\n", name, node ? node->name : "unknown"));
+		if (node && (node != ldr->root)) gf_xml_dom_node_del(node);
+		ldr->e = GF_URL_ERROR;
+		gf_xml_sax_suspend(ldr->sax, GF_TRUE);
+		return;
+	}
+	parent = gf_list_last(ldr->stack);
+	if (!parent) return;
+	if (!parent->content) parent->content = gf_list_new();
+	gf_list_add(parent->content, node);
+}
+
+static void gf_mpd_sax_text_content(void *cbk, const char *content, Bool is_cdata)
+{
+	GF_XMLNode *node, *parent;
+	GF_MPD_SAXLoader *ldr = (GF_MPD_SAXLoader *)cbk;
+
+	if (ldr->skip_depth) return;
+	parent = gf_list_last(ldr->stack);
+	if (!parent) return;
+	GF_SAFEALLOC(node, GF_XMLNode);
+	if (!node) {
+		ldr->e = GF_OUT_OF_MEM;
+		gf_xml_sax_suspend(ldr->sax, GF_TRUE);
+		return;
+	}
+	node->type = is_cdata ? GF_XML_CDATA_TYPE : GF_XML_TEXT_TYPE;
+	node->name = gf_strdup(content);
+	if (!parent->content) parent->content = gf_list_new();
+	gf_list_add(parent->content, node);
+}
+
+GF_EXPORT
+GF_Err gf_mpd_init_from_file(const char *file, GF_MPD *mpd, const char *default_base_url)
+{
+	GF_Err e;
+	GF_MPD_SAXLoader ldr;
+	if (!file || !mpd) return GF_BAD_PARAM;
+
+	memset(&ldr, 0, sizeof(GF_MPD_SAXLoader));
+	ldr.mpd = mpd;
+	ldr.stack = gf_list_new();
+	ldr.sax = gf_xml_sax_new(gf_mpd_sax_node_start, gf_mpd_sax_node_end, gf_mpd_sax_text_content, &ldr);
+	if (!ldr.stack || !ldr.sax) {
+		e = GF_OUT_OF_MEM;
+		goto exit;
+	}
+	mpd->sax_segments = gf_list_new();
+
+	e = gf_xml_sax_parse_file(ldr.sax, file, NULL);
+	if (e<0) {
+		GF_LOG(GF_LOG_ERROR, GF_LOG_DASH, ("[MPD] Failed to parse %s: %s\n", file, gf_xml_sax_get_error(ldr.sax)));
+		e = GF_URL_ERROR;
+		goto exit;
+	}
+	e = ldr.e;
+	if (!e && (!ldr.root || gf_list_count(ldr.stack))) {
+		GF_LOG(GF_LOG_ERROR, GF_LOG_DASH, ("[MPD] Incomplete MPD document %s\n", file));
+		e = GF_URL_ERROR;
+	}
+	if (!e)
+		e = gf_mpd_init_from_dom(ldr.root, mpd, default_base_url);
+
+exit:
+	//unclosed nodes are not attached to their parent
+	while (gf_list_count(ldr.stack)) {
+		GF_XMLNode *node = gf_list_pop_back(ldr.stack);
+		if (node != ldr.root) gf_xml_dom_node_del(node);
+	}
+	gf_list_del(ldr.stack);
+	if (ldr.root) gf_xml_dom_node_del(ldr.root);
+	if (ldr.sax) gf_xml_sax_del(ldr.sax);
+
+	//entries of segment lists and timelines which were not used
+	while (gf_list_count(mpd->sax_segments)) {
+		GF_MPD_SAXSegments *segs = gf_list_pop_back(mpd->sax_segments);
+		gf_mpd_del_list(segs->items, segs->is_timeline ? gf_mpd_segment_entry_free : gf_mpd_segment_url_free, GF_FALSE);
+		gf_free(segs);
+	}
+	gf_list_del(mpd->sax_segments);
+	mpd->sax_segments = NULL;
+	return e;
+}
+
+/*MPD patch: RFC 5261 operations, using the restricted XPath selectors of ISO/IEC 23009-1 patches.
+Patches are applied on the MPD model, only the elements and attributes changing in live sessions are supported*/
+
+enum
+{
+	MPD_PATCH_ROOT=0,
+	MPD_PATCH_PERIOD,
+	MPD_PATCH_SET,
+	MPD_PATCH_REP,
+	MPD_PATCH_SEG_TEMPLATE,
+	MPD_PATCH_SEG_LIST,
+	MPD_PATCH_TIMELINE,
+	MPD_PATCH_S,
+	MPD_PATCH_LOCATION,
+	MPD_PATCH_PATCH_LOCATION,
+};
+
+//object selected by a patch operation
+typedef struct
+{
+	u32 type;
+	GF_MPD_Period *period;
+	GF_MPD_AdaptationSet *set;
+	GF_MPD_Representation *rep;
+	//SegmentTemplate or SegmentList, and its type
+	void *seg_desc;
+	u32 seg_desc_type;
+	GF_MPD_SegmentTimeline *timeline;
+	//list holding the selected object and index in this list, NULL/-1 for single child elements
+	GF_List *list;
+	s32 idx;
+	//selected attribute if any
+	const char *att_name;
+} GF_MPDPatchTarget;
+
+static const char *gf_mpd_patch_get_att(GF_XMLNode *node, const char *name)
+{
+	u32 i=0;
+	GF_XMLAttribute *att;
+	while ((att = gf_list_enum(node->attributes, &i))) {
+		if (!strcmp(att->name, name)) return att->value;
+	}
+	return NULL;
+}
+
+static const char *gf_mpd_patch_get_text(GF_XMLNode *node)
+{
+	u32 i=0;
+	GF_XMLNode *child;
+	while ((child = gf_list_enum(node->content, &i))) {
+		if (child->type == GF_XML_TEXT_TYPE) return child->name;
+	}
+	return "";
+}
+
+//gets the value of an attribute of a model object usable in selector predicates
+static const char *gf_mpd_patch_obj_att(u32 type, void *obj, const char *name, u32 name_len, char *szVal)
+{
+	if (type==MPD_PATCH_S) {
+		if ((name_len!=1) || (name[0]!='t')) return NULL;
+		sprintf(szVal, LLU, ((GF_MPD_SegmentTimelineEntry *)obj)->start_time);
+		return szVal;
+	}
+	if ((name_len!=2) || strncmp(name, "id", 2)) return NULL;
+	switch (type) {
+	case MPD_PATCH_PERIOD:
+		return ((GF_MPD_Period *)obj)->ID;
+	case MPD_PATCH_SET:
+		if (((GF_MPD_AdaptationSet *)obj)->id < 0) return NULL;
+		sprintf(szVal, "%d", ((GF_MPD_AdaptationSet *)obj)->id);
+		return szVal;
+	case MPD_PATCH_REP:
+		return ((GF_MPD_Representation *)obj)->id;
+	}
+	return NULL;
+}
+
+//checks an attribute predicate, @name='value' possibly combined with "and"
+static Bool gf_mpd_patch_check_atts(u32 type, void *obj, const char *pred, u32 len)
+{
+	const char *end = pred+len;
+	while (pred<end) {
+		const char *name, *value, *att_val;
+		u32 name_len, value_len;
+		char quote;
+		char szVal[50];
+
+		while ((pred<end) && (pred[0]==' ')) pred++;
+		if ((pred>=end) || (pred[0]!='@')) return GF_FALSE;
+		name = ++pred;
+		while ((pred<end) && (pred[0]!='=') && (pred[0]!=' ')) pred++;
+		name_len = (u32) (pred-name);
+		while ((pred<end) && (pred[0]==' ')) pred++;
+		if ((pred>=end) || (pred[0]!='=')) return GF_FALSE;
+		pred++;
+		while ((pred<end) && (pred[0]==' ')) pred++;
+		if ((pred>=end) || ((pred[0]!='\'') && (pred[0]!='"'))) return GF_FALSE;
+		quote = pred[0];
+		value = ++pred;
+		while ((pred<end) && (pred[0]!=quote)) pred++;
+		if (pred>=end) return GF_FALSE;
+		value_len = (u32) (pred-value);
+		pred++;
+
+		att_val = gf_mpd_patch_obj_att(type, obj, name, name_len, szVal);
+		if (!att_val || (strlen(att_val)!=value_len) || strncmp(att_val, value, value_len))
+			return GF_FALSE;
+
+		while ((pred<end) && (pred[0]==' ')) pred++;
+		if (pred>=end) break;
+		if (strncmp(pred, "and ", 4)) return GF_FALSE;
+		pred += 4;
+	}
+	return GF_TRUE;
+}
+
+#define MPD_PATCH_STEP_IS(_name) ((name_len==strlen(_name)) && !strncmp(name, _name, name_len))
+
+//resolves one location step (name followed by predicates) from the current target
+static GF_Err gf_mpd_patch_select_step(GF_MPD *mpd, GF_MPDPatchTarget *tgt, Bool is_root, const char *step, u32 len)
+{
+	u32 i, name_len=0, type;
+	const char *sep, *end, *name=step;
+	void *obj=NULL;
+	GF_List *list=NULL, *cands;
+
+	while ((name_len<len) && (step[name_len]!='[')) name_len++;
+	//ignore namespace prefix
+	sep = memchr(name, ':', name_len);
+	if (sep) {
+		name_len -= (u32) (sep+1-name);
+		name = sep+1;
+	}
+
+	type = tgt->type;
+	if (is_root) {
+		if (!MPD_PATCH_STEP_IS("MPD")) return GF_NOT_FOUND;
+		obj = mpd;
+		type = MPD_PATCH_ROOT;
+	} else if (tgt->type==MPD_PATCH_ROOT) {
+		if (MPD_PATCH_STEP_IS("Period")) { list = mpd->periods; type = MPD_PATCH_PERIOD; }
+		else if (MPD_PATCH_STEP_IS("Location")) { list = mpd->locations; type = MPD_PATCH_LOCATION; }
+		else if (MPD_PATCH_STEP_IS("PatchLocation")) { obj = mpd->patch_location; type = MPD_PATCH_PATCH_LOCATION; }
+		else return GF_NOT_SUPPORTED;
+	} else if ((tgt->type==MPD_PATCH_PERIOD) && MPD_PATCH_STEP_IS("AdaptationSet")) {
+		list = tgt->period->adaptation_sets;
+		type = MPD_PATCH_SET;
+	} else if ((tgt->type==MPD_PATCH_SET) && MPD_PATCH_STEP_IS("Representation")) {
+		list = tgt->set->representations;
+		type = MPD_PATCH_REP;
+	} else if ((tgt->type==MPD_PATCH_PERIOD) || (tgt->type==MPD_PATCH_SET) || (tgt->type==MPD_PATCH_REP)) {
+		GF_MPD_SegmentTemplate *tpl = tgt->rep ? tgt->rep->segment_template : tgt->set ? tgt->set->segment_template : tgt->period->segment_template;
+		GF_MPD_SegmentList *sl = tgt->rep ? tgt->rep->segment_list : tgt->set ? tgt->set->segment_list : tgt->period->segment_list;
+		if (MPD_PATCH_STEP_IS("SegmentTemplate")) { obj = tpl; type = MPD_PATCH_SEG_TEMPLATE; }
+		else if (MPD_PATCH_STEP_IS("SegmentList")) { obj = sl; type = MPD_PATCH_SEG_LIST; }
+		else return GF_NOT_SUPPORTED;
+	} else if ((tgt->type==MPD_PATCH_SEG_TEMPLATE) && MPD_PATCH_STEP_IS("SegmentTimeline")) {
+		obj = ((GF_MPD_SegmentTemplate *)tgt->seg_desc)->segment_timeline;
+		type = MPD_PATCH_TIMELINE;
+	} else if ((tgt->type==MPD_PATCH_SEG_LIST) && MPD_PATCH_STEP_IS("SegmentTimeline")) {
+		obj = ((GF_MPD_SegmentList *)tgt->seg_desc)->segment_timeline;
+		type = MPD_PATCH_TIMELINE;
+	} else if ((tgt->type==MPD_PATCH_TIMELINE) && MPD_PATCH_STEP_IS("S")) {
+		list = tgt->timeline->entries;
+		type = MPD_PATCH_S;
+	} else {
+		return GF_NOT_SUPPORTED;
+	}
+
+	cands = gf_list_new();
+	if (list) {
+		i=0;
+		while ((obj = gf_list_enum(list, &i))) gf_list_add(cands, obj);
+	} else if (obj) {
+		gf_list_add(cands, obj);
+	}
+
+	end = step+len;
+	step = name+name_len;
+	while ((step<end) && (step[0]=='[')) {
+		const char *pred = step+1;
+		char quote = 0;
+		u32 plen = 0;
+		while ((pred+plen<end) && (quote || (pred[plen]!=']'))) {
+			if (quote && (pred[plen]==quote)) quote = 0;
+			else if (!quote && ((pred[plen]=='\'') || (pred[plen]=='"'))) quote = pred[plen];
+			plen++;
+		}
+		if (pred+plen>=end) {
+			gf_list_reset(cands);
+			break;
+		}
+		//position predicate, 1-based
+		if ((pred[0]>='0') && (pred[0]<='9')) {
+			u32 pos = atoi(pred);
+			//players may reorder representations, only @id selection is reliable
+			if (type==MPD_PATCH_REP) {
+				gf_list_del(cands);
+				return GF_NOT_SUPPORTED;
+			}
+			obj = (pos>=1) ? gf_list_get(cands, pos-1) : NULL;
+			gf_list_reset(cands);
+			if (obj) gf_list_add(cands, obj);
+		}
+		//attribute predicates on single child elements are not used by patches
+		else if (!list) {
+			gf_list_reset(cands);
+		} else {
+			i=0;
+			while ((obj = gf_list_enum(cands, &i))) {
+				if (gf_mpd_patch_check_atts(type, obj, pred, plen)) continue;
+				i--;
+				gf_list_rem(cands, i);
+			}
+		}
+		step = pred+plen+1;
+	}
+	obj = gf_list_get(cands, 0);
+	gf_list_del(cands);
+	if (!obj) return GF_NOT_FOUND;
+
+	tgt->type = type;
+	tgt->list = list;
+	tgt->idx = list ? gf_list_find(list, obj) : -1;
+	switch (type) {
+	case MPD_PATCH_PERIOD: tgt->period = obj; break;
+	case MPD_PATCH_SET: tgt->set = obj; break;
+	case MPD_PATCH_REP: tgt->rep = obj; break;
+	case MPD_PATCH_SEG_TEMPLATE:
+	case MPD_PATCH_SEG_LIST:
+		tgt->seg_desc = obj;
+		tgt->seg_desc_type = type;
+		break;
+	case MPD_PATCH_TIMELINE: tgt->timeline = obj; break;
+	}
+	return GF_OK;
+}
+
+static GF_Err gf_mpd_patch_select(GF_MPD *mpd, const char *sel, GF_MPDPatchTarget *tgt)
+{
+	Bool is_root = GF_TRUE;
+	memset(tgt, 0, sizeof(GF_MPDPatchTarget));
+	tgt->idx = -1;
+	if (!sel || (sel[0]!='/')) return GF_NON_COMPLIANT_BITSTREAM;
+	sel++;
+	while (sel[0]) {
+		GF_Err e;
+		u32 len=0;
+		char quote=0;
+		//attribute, shall be the last step
+		if (sel[0]=='@') {
+			if (is_root || strchr(sel, '/') || !sel[1]) return GF_NON_COMPLIANT_BITSTREAM;
+			tgt->att_name = sel+1;
+			return GF_OK;
+		}
+		while (sel[len] && (quote || (sel[len]!='/'))) {
+			if (quote && (sel[len]==quote)) quote = 0;
+			else if (!quote && ((sel[len]=='\'') || (sel[len]=='"'))) quote = sel[len];
+			len++;
+		}
+		e = gf_mpd_patch_select_step(mpd, tgt, is_root, sel, len);
+		if (e) return e;
+		is_root = GF_FALSE;
+		sel += len;
+		if (sel[0]=='/') sel++;
+	}
+	return is_root ? GF_NON_COMPLIANT_BITSTREAM : GF_OK;
+}
+
+static u64 gf_mpd_patch_entry_end(GF_MPD_SegmentTimelineEntry *ent)
+{
+	return ent->start_time + (u64) ent->duration * (ent->repeat_count+1);
+}
+
+static void gf_mpd_patch_timeline_changed(GF_MPD_SegmentTimeline *tl)
+{
+	mpd_cache_del(tl->print_cache);
+	tl->print_cache = NULL;
+}
+
+//entries following a modified entry without gap keep following it
+static void gf_mpd_patch_timeline_shift(GF_MPD_SegmentTimeline *tl, u32 idx, u64 prev_end)
+{
+	GF_MPD_SegmentTimelineEntry *ent = gf_list_get(tl->entries, idx);
+	u64 end = gf_mpd_patch_entry_end(ent);
+	while ((ent = gf_list_get(tl->entries, ++idx))) {
+		if ((ent->start_time != prev_end) || (end == prev_end)) break;
+		prev_end = gf_mpd_patch_entry_end(ent);
+		ent->start_time = end;
+		end = gf_mpd_patch_entry_end(ent);
+	}
+	gf_mpd_patch_timeline_changed(tl);
+}
+
+//parses a patch element as a child of the target, elements of the patch may use another namespace prefix than the MPD
+static void *gf_mpd_patch_parse_node(GF_MPD *mpd, GF_MPDPatchTarget *tgt, GF_XMLNode *node, u32 type, u32 insert_idx)
+{
+	void *res = NULL;
+	const char *ns = mpd->xml_namespace;
+	mpd->xml_namespace = node->ns;
+
+	if (type==MPD_PATCH_PERIOD) {
+		u32 nb_periods = gf_list_count(mpd->periods);
+		GF_Err e = strcmp(node->name, "Period") ? GF_NOT_SUPPORTED : gf_mpd_parse_period(mpd, node);
+		//period is added at the end of the MPD by the parser
+		if (gf_list_count(mpd->periods) > nb_periods) {
+			res = gf_list_pop_back(mpd->periods);
+			if (e) {
+				gf_mpd_period_free(res);
+				res = NULL;
+			}
+		}
+	} else if (type==MPD_PATCH_TIMELINE) {
+		if (!strcmp(node->name, "SegmentTimeline"))
+			res = gf_mpd_parse_segment_timeline(mpd, node);
+	} else if (type==MPD_PATCH_S) {
+		if (!strcmp(node->name, "S")) {
+			GF_MPD_SegmentTimelineEntry *ent, *prev;
+			u32 i=0;
+			GF_XMLAttribute *att;
+			GF_SAFEALLOC(ent, GF_MPD_SegmentTimelineEntry);
+			if (ent) {
+				//no @t, starts at end of previous entry
+				prev = insert_idx ? gf_list_get(tgt->timeline->entries, insert_idx-1) : NULL;
+				if (prev) ent->start_time = gf_mpd_patch_entry_end(prev);
+				while ((att = gf_list_enum(node->attributes, &i))) {
+					gf_mpd_parse_segment_timeline_entry(ent, att);
+				}
+			}
+			res = ent;
+		}
+	} else if (type==MPD_PATCH_LOCATION) {
+		if (!strcmp(node->name, "Location"))
+			res = gf_mpd_parse_text_content(node);
+	}
+	mpd->xml_namespace = ns;
+	return res;
+}
+
+static void gf_mpd_patch_del_object(u32 type, void *obj, GF_List *removed_periods)
+{
+	if (!obj) return;
+	switch (type) {
+	case MPD_PATCH_PERIOD:
+		if (removed_periods) gf_list_add(removed_periods, obj);
+		else gf_mpd_period_free(obj);
+		break;
+	case MPD_PATCH_TIMELINE:
+		gf_mpd_segment_timeline_free(obj);
+		break;
+	default:
+		gf_free(obj);
+		break;
+	}
+}
+
+//inserts the element children of the patch operation in the target list
+static GF_Err gf_mpd_patch_insert(GF_MPD *mpd, GF_MPDPatchTarget *tgt, GF_XMLNode *op, u32 type, u32 insert_idx)
+{
+	u32 i=0, nb_items=0;
+	GF_Err e = GF_OK;
+	GF_XMLNode *child;
+
+	while ((child = gf_list_enum(op->content, &i))) {
+		void *obj;
+		if (child->type != GF_XML_NODE_TYPE) continue;
+		obj = gf_mpd_patch_parse_node(mpd, tgt, child, type, insert_idx + nb_items);
+		if (!obj) {
+			e = GF_NOT_SUPPORTED;
+			break;
+		}
+		//inserted right away so that following entries without @t start after this one
+		gf_list_insert(tgt->list, obj, insert_idx + nb_items);
+		nb_items++;
+	}
+	if (!e && !nb_items) e = GF_NON_COMPLIANT_BITSTREAM;
+	//undo the operation
+	while (e && nb_items) {
+		void *obj;
+		nb_items--;
+		obj = gf_list_get(tgt->list, insert_idx + nb_items);
+		gf_list_rem(tgt->list, insert_idx + nb_items);
+		gf_mpd_patch_del_object(type, obj, NULL);
+	}
+	if (type==MPD_PATCH_S) gf_mpd_patch_timeline_changed(tgt->timeline);
+	return e;
+}
+
+//sets or removes (value is NULL) an attribute of the target
+static GF_Err gf_mpd_patch_set_att(GF_MPD *mpd, GF_MPDPatchTarget *tgt, const char *name, const char *value)
+{
+	GF_XMLAttribute att;
+	att.name = (char *) name;
+	att.value = (char *) value;
+
+	switch (tgt->type) {
+	case MPD_PATCH_ROOT:
+		if (!value) {
+			if (!strcmp(name, "availabilityEndTime")) mpd->availabilityEndTime = 0;
+			else if (!strcmp(name, "mediaPresentationDuration")) mpd->media_presentation_duration = 0;
+			else if (!strcmp(name, "minimumUpdatePeriod")) mpd->minimum_update_period = 0;
+			else if (!strcmp(name, "timeShiftBufferDepth")) mpd->time_shift_buffer_depth = (u32) -1;
+			else if (!strcmp(name, "suggestedPresentationDelay")) mpd->suggested_presentation_delay = 0;
+			else if (!strcmp(name, "maxSegmentDuration")) mpd->max_segment_duration = 0;
+			else if (!strcmp(name, "maxSubsegmentDuration")) mpd->max_subsegment_duration = 0;
+			else return GF_NOT_SUPPORTED;
+			return GF_OK;
+		}
+		if (!gf_mpd_parse_root_attribute(mpd, &att)) return GF_NOT_SUPPORTED;
+		if (mpd->type == GF_MPD_TYPE_STATIC)
+			mpd->minimum_update_period = mpd->time_shift_buffer_depth = 0;
+		return GF_OK;
+	case MPD_PATCH_PERIOD:
+		if (!strcmp(name, "duration")) tgt->period->duration = value ? gf_mpd_parse_duration(value) : 0;
+		else if (!strcmp(name, "start")) tgt->period->start = value ? gf_mpd_parse_duration(value) : 0;
+		else return GF_NOT_SUPPORTED;
+		return GF_OK;
+	case MPD_PATCH_S:
+	{
+		GF_MPD_SegmentTimelineEntry *ent = gf_list_get(tgt->list, tgt->idx);
+		GF_MPD_SegmentTimelineEntry *prev = tgt->idx ? gf_list_get(tgt->list, tgt->idx-1) : NULL;
+		u64 prev_end = gf_mpd_patch_entry_end(ent);
+		if (value) {
+			if (strcmp(name, "t") && strcmp(name, "d") && strcmp(name, "r") && strcmp(name, "k")) return GF_NOT_SUPPORTED;
+			gf_mpd_parse_segment_timeline_entry(ent, &att);
+		}
+		else if (!strcmp(name, "t")) ent->start_time = prev ? gf_mpd_patch_entry_end(prev) : 0;
+		else if (!strcmp(name, "r")) ent->repeat_count = 0;
+		else if (!strcmp(name, "k")) ent->nb_parts = 0;
+		else return GF_NOT_SUPPORTED;
+		gf_mpd_patch_timeline_shift(tgt->timeline, tgt->idx, prev_end);
+		return GF_OK;
+	}
+	case MPD_PATCH_PATCH_LOCATION:
+		if (strcmp(name, "ttl")) return GF_NOT_SUPPORTED;
+		mpd->patch_ttl = value ? gf_mpd_parse_int(value) : 0;
+		return GF_OK;
+	}
+	return GF_NOT_SUPPORTED;
+}
+
+static GF_Err gf_mpd_patch_add(GF_MPD *mpd, GF_MPDPatchTarget *tgt, GF_XMLNode *op)
+{
+	u32 i;
+	GF_XMLNode *child;
+	const char *pos = gf_mpd_patch_get_att(op, "pos");
+	const char *type = gf_mpd_patch_get_att(op, "type");
+
+	if (type) {
+		if (type[0] != '@') return GF_NOT_SUPPORTED;
+		return gf_mpd_patch_set_att(mpd, tgt, type+1, gf_mpd_patch_get_text(op));
+	}
+	//insert as sibling of the target
+	if (pos && (!strcmp(pos, "before") || !strcmp(pos, "after"))) {
+		if (!tgt->list) return GF_NOT_SUPPORTED;
+		if ((tgt->type!=MPD_PATCH_PERIOD) && (tgt->type!=MPD_PATCH_S) && (tgt->type!=MPD_PATCH_LOCATION))
+			return GF_NOT_SUPPORTED;
+		return gf_mpd_patch_insert(mpd, tgt, op, tgt->type, tgt->idx + ((pos[0]=='a') ? 1 : 0));
+	}
+	if (pos && strcmp(pos, "append") && strcmp(pos, "prepend")) return GF_NON_COMPLIANT_BITSTREAM;
+
+	//insert as child of the target
+	if (tgt->type==MPD_PATCH_TIMELINE) {
+		tgt->list = tgt->timeline->entries;
+		return gf_mpd_patch_insert(mpd, tgt, op, MPD_PATCH_S, (pos && (pos[0]=='p')) ? 0 : gf_list_count(tgt->list));
+	}
+	if (tgt->type!=MPD_PATCH_ROOT) return GF_NOT_SUPPORTED;
+
+	//the children of MPD are not interleaved in the model, insert by element type
+	i=0;
+	while ((child = gf_list_enum(op->content, &i))) {
+		if (child->type == GF_XML_NODE_TYPE) break;
+	}
+	if (!child) return GF_NON_COMPLIANT_BITSTREAM;
+	if (!strcmp(child->name, "PatchLocation")) {
+		gf_mpd_parse_patch_location(mpd, child);
+		return GF_OK;
+	}
+	if (!strcmp(child->name, "Period")) {
+		tgt->list = mpd->periods;
+		return gf_mpd_patch_insert(mpd, tgt, op, MPD_PATCH_PERIOD, (pos && (pos[0]=='p')) ? 0 : gf_list_count(tgt->list));
+	}
+	if (!strcmp(child->name, "Location")) {
+		tgt->list = mpd->locations;
+		return gf_mpd_patch_insert(mpd, tgt, op, MPD_PATCH_LOCATION, (pos && (pos[0]=='p')) ? 0 : gf_list_count(tgt->list));
+	}
+	return GF_NOT_SUPPORTED;
+}
+
+static GF_Err gf_mpd_patch_replace(GF_MPD *mpd, GF_MPDPatchTarget *tgt, GF_XMLNode *op, GF_List *removed_periods)
+{
+	u32 i=0;
+	void *obj, *old;
+	GF_XMLNode *child;
+
+	if (tgt->att_name)
+		return gf_mpd_patch_set_att(mpd, tgt, tgt->att_name, gf_mpd_patch_get_text(op));
+
+	while ((child = gf_list_enum(op->content, &i))) {
+		if (child->type == GF_XML_NODE_TYPE) break;
+	}
+	if (!child) return GF_NON_COMPLIANT_BITSTREAM;
+
+	switch (tgt->type) {
+	case MPD_PATCH_PATCH_LOCATION:
+		if (strcmp(child->name, "PatchLocation")) return GF_NON_COMPLIANT_BITSTREAM;
+		gf_mpd_parse_patch_location(mpd, child);
+		return GF_OK;
+	case MPD_PATCH_TIMELINE:
+		obj = gf_mpd_patch_parse_node(mpd, tgt, child, MPD_PATCH_TIMELINE, 0);
+		if (!obj) return GF_NON_COMPLIANT_BITSTREAM;
+		if (tgt->seg_desc_type==MPD_PATCH_SEG_TEMPLATE)
+			((GF_MPD_SegmentTemplate *)tgt->seg_desc)->segment_timeline = obj;
+		else
+			((GF_MPD_SegmentList *)tgt->seg_desc)->segment_timeline = obj;
+		gf_mpd_segment_timeline_free(tgt->timeline);
+		return GF_OK;
+	case MPD_PATCH_PERIOD:
+	case MPD_PATCH_S:
+	case MPD_PATCH_LOCATION:
+		obj = gf_mpd_patch_parse_node(mpd, tgt, child, tgt->type, tgt->idx);
+		if (!obj) return GF_NON_COMPLIANT_BITSTREAM;
+		old = gf_list_get(tgt->list, tgt->idx);
+		gf_list_rem(tgt->list, tgt->idx);
+		gf_list_insert(tgt->list, obj, tgt->idx);
+		gf_mpd_patch_del_object(tgt->type, old, removed_periods);
+		if (tgt->type==MPD_PATCH_S) gf_mpd_patch_timeline_changed(tgt->timeline);
+		return GF_OK;
+	}
+	return GF_NOT_SUPPORTED;
+}
+
+static GF_Err gf_mpd_patch_remove(GF_MPD *mpd, GF_MPDPatchTarget *tgt, GF_List *removed_periods)
+{
+	void *obj;
+	if (tgt->att_name)
+		return gf_mpd_patch_set_att(mpd, tgt, tgt->att_name, NULL);
+
+	switch (tgt->type) {
+	case MPD_PATCH_PERIOD:
+	case MPD_PATCH_S:
+	case MPD_PATCH_LOCATION:
+		obj = gf_list_get(tgt->list, tgt->idx);
+		gf_list_rem(tgt->list, tgt->idx);
+		gf_mpd_patch_del_object(tgt->type, obj, removed_periods);
+		if (tgt->type==MPD_PATCH_S) gf_mpd_patch_timeline_changed(tgt->timeline);
+		return GF_OK;
+	case MPD_PATCH_PATCH_LOCATION:
+		gf_free(mpd->patch_location);
+		mpd->patch_location = NULL;
+		mpd->patch_ttl = 0;
+		return GF_OK;
+	}
+	return GF_NOT_SUPPORTED;
+}
+
+GF_EXPORT
+GF_Err gf_mpd_apply_patch(GF_MPD *mpd, GF_XMLNode *patch, GF_List *removed_periods)
+{
+	u32 i, nb_ops=0;
+	GF_XMLNode *op;
+	const char *mpd_id, *orig_pub_time, *pub_time;
+
+	if (!mpd || !patch) return GF_BAD_PARAM;
+	if (strcmp(patch->name, "Patch")) {
+		GF_LOG(GF_LOG_ERROR, GF_LOG_DASH, ("[MPD] Invalid patch root element %s\n", patch->name));
+		return GF_NON_COMPLIANT_BITSTREAM;
+	}
+	mpd_id = gf_mpd_patch_get_att(patch, "mpdId");
+	orig_pub_time = gf_mpd_patch_get_att(patch, "originalPublishTime");
+	pub_time = gf_mpd_patch_get_att(patch, "publishTime");
+	if (!mpd_id || !orig_pub_time || !pub_time) {
+		GF_LOG(GF_LOG_ERROR, GF_LOG_DASH, ("[MPD] Missing mpdId, originalPublishTime or publishTime in patch\n"));
+		return GF_NON_COMPLIANT_BITSTREAM;
+	}
+	if (!mpd->ID || strcmp(mpd->ID, mpd_id)) {
+		GF_LOG(GF_LOG_WARNING, GF_LOG_DASH, ("[MPD] Patch for MPD %s does not apply to MPD %s\n", mpd_id, mpd->ID ? mpd->ID : "without ID"));
+		return GF_NON_COMPLIANT_BITSTREAM;
+	}
+	if (!mpd->publishTime || (mpd->publishTime != gf_mpd_parse_date(orig_pub_time))) {
+		GF_LOG(GF_LOG_WARNING, GF_LOG_DASH, ("[MPD] Patch for MPD published at %s does not apply to MPD published at "LLU"\n", orig_pub_time, mpd->publishTime));
+		return GF_NON_COMPLIANT_BITSTREAM;
+	}
+
+	i=0;
+	while ((op = gf_list_enum(patch->content, &i))) {
+		GF_Err e;
+		GF_MPDPatchTarget tgt;
+		const char *sel;
+		if (op->type != GF_XML_NODE_TYPE) continue;
+
+		sel = gf_mpd_patch_get_att(op, "sel");
+		e = gf_mpd_patch_select(mpd, sel, &tgt);
+		if (e==GF_NOT_FOUND) {
+			GF_LOG(GF_LOG_WARNING, GF_LOG_DASH, ("[MPD] Patch selector %s not found in MPD\n", sel));
+			return e;
+		}
+		if (e) {
+		} else if (!strcmp(op->name, "add")) {
+			e = tgt.att_name ? GF_NON_COMPLIANT_BITSTREAM : gf_mpd_patch_add(mpd, &tgt, op);
+		} else if (!strcmp(op->name, "replace")) {
+			e = gf_mpd_patch_replace(mpd, &tgt, op, removed_periods);
+		} else if (!strcmp(op->name, "remove")) {
+			e = gf_mpd_patch_remove(mpd, &tgt, removed_periods);
+		} else {
+			e = GF_NOT_SUPPORTED;
+		}
+		if (e) {
+			GF_LOG(GF_LOG_WARNING, GF_LOG_DASH, ("[MPD] Failed to apply patch operation %s on %s: %s\n", op->name, sel ? sel : "none", gf_error_to_string(e) ));
+			return e;
+		}
+		nb_ops++;
+	}
+	if (!nb_ops) return GF_EOS;
+	mpd->publishTime = gf_mpd_parse_date(pub_time);
+	return GF_OK;
+}
+
 //locate codec in renditions and try to extract bandwidth (we can't really)
 static char *group_to_codecs(MasterPlaylist *pl, PlaylistElement *pe, u32 *bandwidth)
 {
@@ -2794,6 +3782,144 @@ static GFINLINE void gf_mpd_nl(FILE *out, s32 indent)
 	}
 }
 
+static Bool mpd_text_grow(MPDText *txt, u32 len)
+{
+	char *data;
+	u32 alloc;
+	if (txt->size + len < txt->alloc) return GF_TRUE;
+	alloc = MAX(2*txt->alloc, txt->size + len + 1024);
+	data = gf_realloc(txt->data, alloc);
+	if (!data) return GF_FALSE;
+	txt->data = data;
+	txt->alloc = alloc;
+	return GF_TRUE;
+}
+
+static void mpd_text_write(MPDText *txt, const char *data, u32 len)
+{
+	if (!len || !mpd_text_grow(txt, len)) return;
+	memcpy(txt->data + txt->size, data, len);
+	txt->size += len;
+}
+
+static void mpd_text_printf(MPDText *txt, const char *format, ...)
+{
+	va_list args;
+	s32 len;
+	u32 avail = txt->alloc - txt->size;
+	va_start(args, format);
+	len = vsnprintf(txt->data ? txt->data + txt->size : NULL, avail, format, args);
+	va_end(args);
+	if (len<0) return;
+	if ((u32) len >= avail) {
+		if (!mpd_text_grow(txt, (u32) len)) return;
+		va_start(args, format);
+		vsnprintf(txt->data + txt->size, len+1, format, args);
+		va_end(args);
+	}
+	txt->size += (u32) len;
+}
+
+static void mpd_text_flush(MPDText *txt, FILE *out)
+{
+	if (txt->size) gf_fwrite(txt->data, txt->size, out);
+	txt->size = 0;
+}
+
+static GFINLINE void mpd_text_lf(MPDText *txt, s32 indent)
+{
+	if (indent>=0) mpd_text_write(txt, "\n", 1);
+}
+static GFINLINE void mpd_text_nl(MPDText *txt, s32 indent)
+{
+	if (indent>=0) {
+		u32 i=(u32)indent;
+		while (i) {
+			mpd_text_write(txt, " ", 1);
+			i--;
+		}
+	}
+}
+
+static Bool mpd_cache_item_equal(MPDCacheItem *a, MPDCacheItem *b)
+{
+	if (a->src != b->src) return GF_FALSE;
+	if (a->flags != b->flags) return GF_FALSE;
+	if ((a->time != b->time) || (a->dur != b->dur) || (a->offset != b->offset)) return GF_FALSE;
+	if ((a->num != b->num) || (a->size != b->size)) return GF_FALSE;
+	if (a->key != b->key) return GF_FALSE;
+	return GF_TRUE;
+}
+
+/*drops cached items removed from the head of the source list, returns GF_FALSE if src is not the first item of a cached element*/
+static Bool mpd_cache_drop_head(MPDPrintCache *cache, void *src)
+{
+	u32 i, txt_start;
+	while ((cache->first < cache->count) && (cache->items[cache->first].src != src))
+		cache->first++;
+
+	if ((cache->first == cache->count)
+		|| (cache->first && (cache->items[cache->first].txt_start == cache->items[cache->first-1].txt_start))
+	) {
+		mpd_cache_reset(cache);
+		return GF_FALSE;
+	}
+	//compact once more than half of the text is dropped
+	txt_start = cache->items[cache->first].txt_start;
+	if (txt_start && (txt_start >= cache->txt.size/2)) {
+		memmove(cache->txt.data, cache->txt.data + txt_start, cache->txt.size - txt_start);
+		cache->txt.size -= txt_start;
+		memmove(cache->items, cache->items + cache->first, sizeof(MPDCacheItem) * (cache->count - cache->first));
+		cache->count -= cache->first;
+		cache->first = 0;
+		for (i=0; i<cache->count; i++)
+			cache->items[i].txt_start -= txt_start;
+	}
+	return GF_TRUE;
+}
+
+/*removes cached items from idx, including the start of the element idx belongs to*/
+static void mpd_cache_truncate(MPDPrintCache *cache, u32 idx)
+{
+	if (idx >= cache->count) return;
+	while ((idx > cache->first) && (cache->items[idx].txt_start == cache->items[idx-1].txt_start))
+		idx--;
+	if (idx == cache->first) {
+		mpd_cache_reset(cache);
+		return;
+	}
+	cache->txt.size = cache->items[idx].txt_start;
+	cache->count = idx;
+}
+
+static void mpd_cache_add(MPDPrintCache *cache, MPDCacheItem *item, const char *txt, u32 len, Bool new_element)
+{
+	if (cache->count == cache->alloc) {
+		MPDCacheItem *items;
+		u32 alloc = cache->alloc ? 2*cache->alloc : 64;
+		items = gf_realloc(cache->items, sizeof(MPDCacheItem) * alloc);
+		if (!items) return;
+		cache->items = items;
+		cache->alloc = alloc;
+	}
+	item->txt_start = cache->txt.size;
+	if (!new_element && (cache->count > cache->first))
+		item->txt_start = cache->items[cache->count-1].txt_start;
+	cache->items[cache->count] = *item;
+	cache->count++;
+	mpd_text_write(&cache->txt, txt, len);
+}
+
+/*writes the cached text up to the end of the cache*/
+static void mpd_cache_write(MPDPrintCache *cache, MPDText *txt, FILE *out)
+{
+	u32 txt_start;
+	if (cache->first == cache->count) return;
+	mpd_text_flush(txt, out);
+	txt_start = cache->items[cache->first].txt_start;
+	gf_fwrite(cache->txt.data + txt_start, cache->txt.size - txt_start, out);
+}
+
 /*time is given in ms*/
 void gf_mpd_print_date(FILE *out, char *name, u64 time)
 {
@@ -2903,57 +4029,144 @@ static void gf_mpd_print_segment_base(FILE *out, GF_MPD_SegmentBase *s, s32 inde
 	gf_mpd_lf(out, indent);
 }
 
-static void gf_mpd_print_segment_timeline(FILE *out, GF_MPD_SegmentTimeline *tl, s32 indent, u32 tsb_first_entry)
+/*returns 0 if se extends the S element of prev, 1 if se starts a new S element, 2 if se starts a new S element with @t*/
+static u32 gf_mpd_timeline_break(GF_MPD_SegmentTimelineEntry *prev, GF_MPD_SegmentTimelineEntry *se)
+{
+	if (se->start_time != prev->start_time + (prev->repeat_count+1) * prev->duration) return 2;
+	if (prev->duration != se->duration) return 1;
+	return 0;
+}
+
+/*prints entries [from, to[ as a single S element*/
+static void gf_mpd_print_timeline_element(MPDText *txt, GF_List *entries, u32 from, u32 to, Bool write_t, s32 indent)
+{
+	u32 i, rcount;
+	GF_MPD_SegmentTimelineEntry *se = gf_list_get(entries, from);
+
+	mpd_text_nl(txt, indent+1);
+	mpd_text_printf(txt, "<S");
+	if (write_t) mpd_text_printf(txt, " t=\""LLD"\"", se->start_time);
+	if (se->duration) mpd_text_printf(txt, " d=\"%d\"", se->duration);
+	rcount = se->repeat_count;
+	for (i=from+1; i<to; i++) {
+		se = gf_list_get(entries, i);
+		rcount += 1 + se->repeat_count;
+	}
+	if (rcount) mpd_text_printf(txt, " r=\"%d\"", rcount);
+	if (se->nb_parts) mpd_text_printf(txt, " k=\"%d\"", se->nb_parts);
+	mpd_text_printf(txt, "/>");
+	mpd_text_lf(txt, indent);
+}
+
+static void gf_mpd_timeline_cache_item(MPDCacheItem *item, GF_MPD_SegmentTimelineEntry *se, u32 brk)
+{
+	memset(item, 0, sizeof(MPDCacheItem));
+	item->src = se;
+	item->flags = brk;
+	item->time = se->start_time;
+	item->dur = se->duration;
+	item->num = se->repeat_count;
+	item->size = se->nb_parts;
+}
+
+/*writes cached S elements matching the entries starting at idx, returns index of the first entry not written*/
+static u32 gf_mpd_timeline_cache_write(MPDPrintCache *cache, GF_List *entries, u32 idx, u32 count, MPDText *txt, FILE *out)
+{
+	u32 i, nb_match=0;
+	MPDCacheItem item;
+
+	if (!mpd_cache_drop_head(cache, gf_list_get(entries, idx)))
+		return idx;
+
+	for (i=cache->first; i<cache->count; i++) {
+		GF_MPD_SegmentTimelineEntry *se;
+		if (idx+nb_match >= count) break;
+		se = gf_list_get(entries, idx+nb_match);
+		gf_mpd_timeline_cache_item(&item, se, gf_mpd_timeline_break(gf_list_get(entries, idx+nb_match-1), se));
+		if (!mpd_cache_item_equal(&cache->items[i], &item)) break;
+		nb_match++;
+	}
+	mpd_cache_truncate(cache, cache->first + nb_match);
+	nb_match = cache->count - cache->first;
+	//last cached element must still be closed by the next entry
+	while (nb_match) {
+		if ((idx+nb_match < count)
+			&& gf_mpd_timeline_break(gf_list_get(entries, idx+nb_match-1), gf_list_get(entries, idx+nb_match))
+		) {
+			break;
+		}
+		mpd_cache_truncate(cache, cache->count-1);
+		nb_match = cache->count - cache->first;
+	}
+	mpd_cache_write(cache, txt, out);
+	return idx+nb_match;
+}
+
+static void gf_mpd_print_segment_timeline(FILE *out, GF_MPD_SegmentTimeline *tl, s32 indent, u32 tsb_first_entry, Bool is_dynamic)
 {
-	u32 i, count, rcount;
-	u64 start_time=0;
-	GF_MPD_SegmentTimelineEntry *se, *prev;
+	u32 i, count, cache_next;
+	MPDText txt;
+	MPDPrintCache *cache = NULL;
 
 	gf_mpd_nl(out, indent);
 	gf_fprintf(out, "<SegmentTimeline>");
 	gf_mpd_lf(out, indent);
 
-	prev = gf_list_get(tl->entries, tsb_first_entry);
 	count = gf_list_count(tl->entries);
-	if (!prev) goto done_tl;
-
-	gf_mpd_nl(out, indent+1);
-	gf_fprintf(out, "<S");
-	gf_fprintf(out, " t=\""LLD"\"", prev->start_time);
-	if (prev->duration) gf_fprintf(out, " d=\"%d\"", prev->duration);
-	rcount = prev->repeat_count;
-	start_time = prev->start_time + (prev->repeat_count+1) * prev->duration;
-
-	for (i = tsb_first_entry+1; i<count && prev; i++) {
-		se = gf_list_get(tl->entries, i);
-		//close entry
-		if ((se->start_time != start_time) || (prev->duration!=se->duration)) {
-			if (rcount) gf_fprintf(out, " r=\"%d\"", rcount);
-			if (prev->nb_parts) gf_fprintf(out, " k=\"%d\"", prev->nb_parts);
-			gf_fprintf(out, "/>");
-			gf_mpd_lf(out, indent);
-			//start new one
-			gf_mpd_nl(out, indent+1);
-			gf_fprintf(out, "<S");
-			if (se->start_time != start_time) {
-				gf_fprintf(out, " t=\""LLD"\"", se->start_time);
-				start_time = se->start_time;
+	if (tsb_first_entry >= count) goto done_tl;
+
+	//in live, S elements closed by a following entry are kept serialized in the timeline:
+	//only the first element (purged entries) and the elements after the cached ones are printed
+	if (is_dynamic) {
+		cache = tl->print_cache;
+		if (!cache) {
+			GF_SAFEALLOC(cache, MPDPrintCache);
+			tl->print_cache = cache;
+		}
+		if (cache && (cache->indent != indent)) {
+			mpd_cache_reset(cache);
+			cache->indent = indent;
+		}
+	}
+	memset(&txt, 0, sizeof(MPDText));
+	cache_next = 0;
+	i = tsb_first_entry;
+	while (i<count) {
+		u32 next, brk, txt_start;
+		//first element always has @t
+		brk = 2;
+		if (i>tsb_first_entry) {
+			if (cache && !cache_next) {
+				i = gf_mpd_timeline_cache_write(cache, tl->entries, i, count, &txt, out);
+				cache_next = i;
+				if (i==count) break;
 			}
-			if (se->duration) gf_fprintf(out, " d=\"%d\"", se->duration);
-			rcount=0;
-		} else {
-			rcount++;
+			brk = gf_mpd_timeline_break(gf_list_get(tl->entries, i-1), gf_list_get(tl->entries, i));
+		}
+		next = i+1;
+		while ((next<count) && !gf_mpd_timeline_break(gf_list_get(tl->entries, next-1), gf_list_get(tl->entries, next)))
+			next++;
+
+		txt_start = txt.size;
+		gf_mpd_print_timeline_element(&txt, tl->entries, i, next, (brk==2) ? GF_TRUE : GF_FALSE, indent);
+
+		//element closed, keep it
+		if (cache && (i>tsb_first_entry) && (i==cache_next) && (next<count)) {
+			u32 k;
+			for (k=i; k<next; k++) {
+				MPDCacheItem item;
+				gf_mpd_timeline_cache_item(&item, gf_list_get(tl->entries, k), (k==i) ? brk : 0);
+				if (k==i)
+					mpd_cache_add(cache, &item, txt.data + txt_start, txt.size - txt_start, GF_TRUE);
+				else
+					mpd_cache_add(cache, &item, NULL, 0, GF_FALSE);
+			}
+			cache_next = next;
 		}
-		start_time += (se->repeat_count+1) * se->duration;
-		rcount += se->repeat_count;
-		prev = se;
+		i = next;
 	}
-	//close last entry
-	if (rcount) gf_fprintf(out, " r=\"%d\"", rcount);
-	if (prev->nb_parts) gf_fprintf(out, " k=\"%d\"", prev->nb_parts);
-	gf_fprintf(out, "/>");
-	gf_mpd_lf(out, indent);
-
+	mpd_text_flush(&txt, out);
+	if (txt.data) gf_free(txt.data);
 
 done_tl:
 	gf_mpd_nl(out, indent);
@@ -2961,6 +4174,7 @@ done_tl:
 	gf_mpd_lf(out, indent);
 }
 
+GF_EXPORT
 GF_MPD_SegmentTimeline *gf_mpd_segmentimeline_new(void)
 {
 	GF_MPD_SegmentTimeline *seg_tl;
@@ -2969,7 +4183,7 @@ GF_MPD_SegmentTimeline *gf_mpd_segmentimeline_new(void)
 	return seg_tl;
 }
 
-static u32 gf_mpd_print_multiple_segment_base(FILE *out, GF_MPD_MultipleSegmentBase *ms, s32 indent, Bool close_if_no_child)
+static u32 gf_mpd_print_multiple_segment_base(FILE *out, GF_MPD_MultipleSegmentBase *ms, s32 indent, Bool close_if_no_child, Bool is_dynamic)
 {
 	gf_mpd_print_segment_base_attr(out, (GF_MPD_SegmentBase *)ms);
 
@@ -2990,12 +4204,12 @@ static u32 gf_mpd_print_multiple_segment_base(FILE *out, GF_MPD_MultipleSegmentB
 	if (ms->initialization_segment) gf_mpd_print_url(out, ms->initialization_segment, "Initialization", indent+1);
 	if (ms->representation_index) gf_mpd_print_url(out, ms->representation_index, "RepresentationIndex", indent+1);
 
-	if (ms->segment_timeline) gf_mpd_print_segment_timeline(out, ms->segment_timeline, indent+1, ms->tsb_first_entry);
+	if (ms->segment_timeline) gf_mpd_print_segment_timeline(out, ms->segment_timeline, indent+1, ms->tsb_first_entry, is_dynamic);
 	if (ms->bitstream_switching_url) gf_mpd_print_url(out, ms->bitstream_switching_url, "BitstreamSwitching", indent+1);
 	return 0;
 }
 
-static void gf_mpd_print_segment_list(FILE *out, GF_MPD_SegmentList *s, s32 indent)
+static void gf_mpd_print_segment_list(FILE *out, GF_MPD_SegmentList *s, s32 indent, Bool is_dynamic)
 {
 	gf_mpd_nl(out, indent);
 	gf_fprintf(out, "<SegmentList");
@@ -3014,7 +4228,7 @@ static void gf_mpd_print_segment_list(FILE *out, GF_MPD_SegmentList *s, s32 inde
 		gf_fprintf(out, ">");
 		gf_mpd_lf(out, indent);
 	} else {
-		gf_mpd_print_multiple_segment_base(out, (GF_MPD_MultipleSegmentBase *)s, indent, GF_FALSE);
+		gf_mpd_print_multiple_segment_base(out, (GF_MPD_MultipleSegmentBase *)s, indent, GF_FALSE, is_dynamic);
 	}
 
 	if (s->segment_URLs) {
@@ -3060,7 +4274,7 @@ static void gf_mpd_print_segment_list(FILE *out, GF_MPD_SegmentList *s, s32 inde
 	gf_mpd_lf(out, indent);
 }
 
-static void gf_mpd_print_segment_template(FILE *out, GF_MPD_SegmentTemplate *s, s32 indent)
+static void gf_mpd_print_segment_template(FILE *out, GF_MPD_SegmentTemplate *s, s32 indent, Bool is_dynamic)
 {
 	gf_mpd_nl(out, indent);
 	gf_fprintf(out, "<SegmentTemplate");
@@ -3071,7 +4285,7 @@ static void gf_mpd_print_segment_template(FILE *out, GF_MPD_SegmentTemplate *s,
 	if (s->bitstream_switching) gf_fprintf(out, " bitstreamSwitching=\"%s\"", s->bitstream_switching);
 	if (s->nb_parts) gf_fprintf(out, " k=\"%d\"", s->nb_parts);
 
-	if (gf_mpd_print_multiple_segment_base(out, (GF_MPD_MultipleSegmentBase *)s, indent, GF_TRUE))
+	if (gf_mpd_print_multiple_segment_base(out, (GF_MPD_MultipleSegmentBase *)s, indent, GF_TRUE, is_dynamic))
 		return;
 
 	gf_mpd_nl(out, indent);
@@ -3385,7 +4599,7 @@ static void gf_mpd_print_dasher_segments(FILE *out, GF_List *segments, s32 inden
 	gf_mpd_lf(out, indent);
 }
 
-static void gf_mpd_print_representation(GF_MPD_Representation *rep, FILE *out, Bool write_context, s32 indent, u32 alt_mha_profile, Bool skip_mime)
+static void gf_mpd_print_representation(GF_MPD_Representation *rep, FILE *out, Bool write_context, Bool is_dynamic, s32 indent, u32 alt_mha_profile, Bool skip_mime)
 {
 	u32 child_idx = 0;
 	char *bck_codecs = NULL;
@@ -3452,11 +4666,11 @@ static void gf_mpd_print_representation(GF_MPD_Representation *rep, FILE *out, B
 	}
 	if (rep->segment_list) {
 		gf_mpd_extensible_print_nodes(out, rep->x_children, indent, &child_idx, GF_FALSE);
-		gf_mpd_print_segment_list(out, rep->segment_list, indent+1);
+		gf_mpd_print_segment_list(out, rep->segment_list, indent+1, is_dynamic);
 	}
 	if (rep->segment_template) {
 		gf_mpd_extensible_print_nodes(out, rep->x_children, indent, &child_idx, GF_FALSE);
-		gf_mpd_print_segment_template(out, rep->segment_template, indent+1);
+		gf_mpd_print_segment_template(out, rep->segment_template, indent+1, is_dynamic);
 	}
 	/*TODO
 				e = gf_mpd_parse_subrepresentation(rep->sub_representations, child);
@@ -3470,14 +4684,14 @@ static void gf_mpd_print_representation(GF_MPD_Representation *rep, FILE *out, B
 	gf_mpd_lf(out, indent);
 }
 
-static void gf_mpd_print_adaptation_set(GF_MPD_AdaptationSet *as, FILE *out, Bool write_context, s32 indent, u32 alt_mha_profile)
+static void gf_mpd_print_adaptation_set(GF_MPD_AdaptationSet *as, FILE *out, Bool write_context, Bool is_dynamic, s32 indent, u32 alt_mha_profile)
 {
 	u32 i, child_idx=0;
 	GF_MPD_Representation *rep;
 
 	if (!alt_mha_profile && as->nb_alt_mha_profiles && as->alt_mha_profiles_only) {
 		for (i=0; i<as->nb_alt_mha_profiles; i++) {
-			gf_mpd_print_adaptation_set(as, out, write_context, indent, as->alt_mha_profiles[i] + 1);
+			gf_mpd_print_adaptation_set(as, out, write_context, is_dynamic, indent, as->alt_mha_profiles[i] + 1);
 		}
 
 		return;
@@ -3556,17 +4770,17 @@ static void gf_mpd_print_adaptation_set(GF_MPD_AdaptationSet *as, FILE *out, Boo
 	}
 	if (as->segment_list) {
 		gf_mpd_extensible_print_nodes(out, as->x_children, indent, &child_idx, GF_FALSE);
-		gf_mpd_print_segment_list(out, as->segment_list, indent+1);
+		gf_mpd_print_segment_list(out, as->segment_list, indent+1, is_dynamic);
 	}
 	if (as->segment_template) {
 		gf_mpd_extensible_print_nodes(out, as->x_children, indent, &child_idx, GF_FALSE);
-		gf_mpd_print_segment_template(out, as->segment_template, indent+1);
+		gf_mpd_print_segment_template(out, as->segment_template, indent+1, is_dynamic);
 	}
 
 	i=0;
 	while ((rep = (GF_MPD_Representation *)gf_list_enum(as->representations, &i))) {
 		gf_mpd_extensible_print_nodes(out, as->x_children, indent, &child_idx, GF_FALSE);
-		gf_mpd_print_representation(rep, out, write_context, indent+1, alt_mha_profile, mime_type ? GF_TRUE : GF_FALSE);
+		gf_mpd_print_representation(rep, out, write_context, is_dynamic, indent+1, alt_mha_profile, mime_type ? GF_TRUE : GF_FALSE);
 	}
 	gf_mpd_extensible_print_nodes(out, as->x_children, indent, &child_idx, GF_TRUE);
 	gf_mpd_nl(out, indent);
@@ -3577,7 +4791,7 @@ static void gf_mpd_print_adaptation_set(GF_MPD_AdaptationSet *as, FILE *out, Boo
 
 	if (!alt_mha_profile) {
 		for (i=0; i<as->nb_alt_mha_profiles; i++) {
-			gf_mpd_print_adaptation_set(as, out, write_context, indent, as->alt_mha_profiles[i] + 1);
+			gf_mpd_print_adaptation_set(as, out, write_context, is_dynamic, indent, as->alt_mha_profiles[i] + 1);
 		}
 	}
 }
@@ -3613,17 +4827,17 @@ static void gf_mpd_print_period(GF_MPD_Period const * const period, Bool is_dyna
 	}
 	if (period->segment_list) {
 		gf_mpd_extensible_print_nodes(out, period->x_children, indent, &child_idx, GF_FALSE);
-		gf_mpd_print_segment_list(out, period->segment_list, indent+1);
+		gf_mpd_print_segment_list(out, period->segment_list, indent+1, is_dynamic);
 	}
 	if (period->segment_template) {
 		gf_mpd_extensible_print_nodes(out, period->x_children, indent, &child_idx, GF_FALSE);
-		gf_mpd_print_segment_template(out, period->segment_template, indent+1);
+		gf_mpd_print_segment_template(out, period->segment_template, indent+1, is_dynamic);
 	}
 
 	i=0;
 	while ( (as = (GF_MPD_AdaptationSet *) gf_list_enum(period->adaptation_sets, &i))) {
 		gf_mpd_extensible_print_nodes(out, period->x_children, indent, &child_idx, GF_FALSE);
-		gf_mpd_print_adaptation_set(as, out, write_context, indent+1, 0);
+		gf_mpd_print_adaptation_set(as, out, write_context, is_dynamic, indent+1, 0);
 	}
 	gf_mpd_extensible_print_nodes(out, period->x_children, indent, &child_idx, GF_TRUE);
 	gf_mpd_nl(out, indent);
@@ -3872,24 +5086,25 @@ static const char *gf_mpd_m3u8_get_init_seg(const GF_MPD_Period *period, const G
 	return url;
 }
 
-static void hls_insert_crypt_info(FILE *out, GF_MPD_Representation *rep, GF_DASH_SegmentContext *sctx, const char **last_kms)
+static const char *hls_get_kms(GF_DASH_SegmentContext *sctx)
+{
+	if (!sctx->encrypted) return "NONE";
+	if (sctx->hls_key_uri) return sctx->hls_key_uri;
+	return "URI=\"gpac:hls:key:locator:null\"";
+}
+
+static void hls_insert_crypt_info(MPDText *txt, GF_MPD_Representation *rep, GF_DASH_SegmentContext *sctx, const char **last_kms)
 {
 	if (!rep->crypto_type) return;
-	const char *kms;
-	if (!sctx->encrypted)
-		kms = "NONE";
-	else if (sctx->hls_key_uri) kms = sctx->hls_key_uri;
-	else {
-		kms = "URI=\"gpac:hls:key:locator:null\"";
-		if (!rep->def_kms_used) {
-			rep->def_kms_used = 1;
-			GF_LOG(GF_LOG_WARNING, GF_LOG_DASH, ("[HLS] Missing key URI in one or more keys - will use dummy one %s\n", kms));
-		}
+	const char *kms = hls_get_kms(sctx);
+	if (sctx->encrypted && !sctx->hls_key_uri && !rep->def_kms_used) {
+		rep->def_kms_used = 1;
+		GF_LOG(GF_LOG_WARNING, GF_LOG_DASH, ("[HLS] Missing key URI in one or more keys - will use dummy one %s\n", kms));
 	}
 
 	if (! *last_kms || strcmp(kms, *last_kms)) {
 		if (!strcmp(kms, "NONE")) {
-			gf_fprintf(out,"#EXT-X-KEY:METHOD=NONE\n");
+			mpd_text_printf(txt,"#EXT-X-KEY:METHOD=NONE\n");
 		} else {
 			char *subkms = (char *) kms;
 			while (1) {
@@ -3897,12 +5112,12 @@ static void hls_insert_crypt_info(FILE *out, GF_MPD_Representation *rep, GF_DASH
 				if (next) next[0] = 0;
 				if (rep->crypto_type==1) {
 					u32 k;
-					gf_fprintf(out,"#EXT-X-KEY:METHOD=AES-128,%s,IV=0x", subkms);
+					mpd_text_printf(txt,"#EXT-X-KEY:METHOD=AES-128,%s,IV=0x", subkms);
 					for (k=0; k<16; k++)
-						gf_fprintf(out, "%02X", sctx->hls_iv[k]);
-					gf_fprintf(out, "\n");
+						mpd_text_printf(txt, "%02X", sctx->hls_iv[k]);
+					mpd_text_printf(txt, "\n");
 				} else {
-					gf_fprintf(out,"#EXT-X-KEY:METHOD=SAMPLE-AES,%s\n", subkms);
+					mpd_text_printf(txt,"#EXT-X-KEY:METHOD=SAMPLE-AES,%s\n", subkms);
 				}
 				if (!next) break;
 				next[0] = ',';
@@ -3913,6 +5128,82 @@ static void hls_insert_crypt_info(FILE *out, GF_MPD_Representation *rep, GF_DASH
 	}
 }
 
+/*segment entries are kept serialized once they are neither the live edge nor carrying LL-HLS parts*/
+static Bool hls_entry_is_stable(const GF_MPD *mpd, GF_DASH_SegmentContext *sctx, u32 idx, u32 count)
+{
+	if (idx+1 >= count) return GF_FALSE;
+	if ((mpd->type == GF_MPD_TYPE_DYNAMIC) && sctx->llhls_mode && (idx+4 >= count)) return GF_FALSE;
+	return GF_TRUE;
+}
+
+static void hls_cache_item(MPDCacheItem *item, GF_DASH_SegmentContext *sctx)
+{
+	memset(item, 0, sizeof(MPDCacheItem));
+	item->src = sctx;
+	item->flags = sctx->encrypted;
+	item->time = sctx->time;
+	item->dur = sctx->dur;
+	item->offset = sctx->file_offset;
+	item->num = sctx->seg_num;
+	item->size = sctx->file_size;
+	item->key = sctx->hls_key_uri;
+}
+
+static MPDPrintCache *hls_cache_get(GF_MPD_Representation *rep, const char *base_url, const char *b_url)
+{
+	MPDPrintCache *cache = rep->m3u8_cache;
+	if (!cache) {
+		GF_SAFEALLOC(cache, MPDPrintCache);
+		if (!cache) return NULL;
+		rep->m3u8_cache = cache;
+	}
+	if ((cache->timescale != rep->timescale) || (cache->crypto_type != rep->crypto_type)
+		|| strcmp(cache->base_url ? cache->base_url : "", base_url ? base_url : "")
+		|| strcmp(cache->b_url ? cache->b_url : "", b_url ? b_url : "")
+	) {
+		mpd_cache_reset(cache);
+		cache->timescale = rep->timescale;
+		cache->crypto_type = rep->crypto_type;
+		if (cache->base_url) gf_free(cache->base_url);
+		cache->base_url = base_url ? gf_strdup(base_url) : NULL;
+		if (cache->b_url) gf_free(cache->b_url);
+		cache->b_url = b_url ? gf_strdup(b_url) : NULL;
+	}
+	return cache;
+}
+
+static void hls_cache_add(MPDPrintCache *cache, GF_DASH_SegmentContext *sctx, MPDText *txt, u32 txt_start)
+{
+	MPDCacheItem item;
+	hls_cache_item(&item, sctx);
+	mpd_cache_add(cache, &item, txt->data + txt_start, txt->size - txt_start, GF_TRUE);
+}
+
+/*writes cached entries matching the segments starting at idx, returns index of the first segment not written*/
+static u32 hls_cache_write(MPDPrintCache *cache, const GF_MPD *mpd, GF_MPD_Representation *rep, u32 idx, u32 count, MPDText *txt, FILE *out, const char **last_kms)
+{
+	u32 i, nb_match=0;
+	MPDCacheItem item;
+
+	if (!mpd_cache_drop_head(cache, gf_list_get(rep->state_seg_list, idx)))
+		return idx;
+
+	for (i=cache->first; i<cache->count; i++) {
+		GF_DASH_SegmentContext *sctx = gf_list_get(rep->state_seg_list, idx+nb_match);
+		if (!sctx || !hls_entry_is_stable(mpd, sctx, idx+nb_match, count)) break;
+		hls_cache_item(&item, sctx);
+		if (!mpd_cache_item_equal(&cache->items[i], &item)) break;
+		nb_match++;
+	}
+	mpd_cache_truncate(cache, cache->first + nb_match);
+	if (!nb_match) return idx;
+
+	mpd_cache_write(cache, txt, out);
+	//key signaling state after the last cached segment
+	*last_kms = (rep->crypto_type==2) ? hls_get_kms(gf_list_get(rep->state_seg_list, idx+nb_match-1)) : NULL;
+	return idx+nb_match;
+}
+
 static GF_Err gf_mpd_write_m3u8_playlist(const GF_MPD *mpd, const GF_MPD_Period *period, const GF_MPD_AdaptationSet *as, GF_MPD_Representation *rep, char *m3u8_name, u32 hls_version, Double max_part_dur_session, const char *force_base_url)
 {
 	u32 i, count;
@@ -3921,6 +5212,9 @@ static GF_Err gf_mpd_write_m3u8_playlist(const GF_MPD *mpd, const GF_MPD_Period
 	char *force_url=NULL;
 	const char *last_kms = NULL;
 	Bool close_file = GF_FALSE;
+	MPDPrintCache *cache = NULL;
+	u32 cache_next = 0;
+	MPDText txt;
 
 	if (!strcmp(m3u8_name, "std")) out = stdout;
 	else if (mpd->create_m3u8_files) {
@@ -3933,6 +5227,7 @@ static GF_Err gf_mpd_write_m3u8_playlist(const GF_MPD *mpd, const GF_MPD_Period
 		rep->m3u8_var_file = out;
 	}
 
+	memset(&txt, 0, sizeof(MPDText));
 	count = gf_list_count(rep->state_seg_list);
 	sctx = gf_list_get(rep->state_seg_list, rep->tsb_first_entry);
 
@@ -3984,12 +5279,22 @@ static GF_Err gf_mpd_write_m3u8_playlist(const GF_MPD *mpd, const GF_MPD_Period
 			}
 		}
 
+		//in live, entries after the first one are kept serialized in the representation
+		if (mpd->type == GF_MPD_TYPE_DYNAMIC)
+			cache = hls_cache_get(rep, force_base_url, NULL);
+
 		for (i=rep->tsb_first_entry; i<count; i++) {
 			Double dur;
+			u32 txt_start;
+			if (cache && (i == rep->tsb_first_entry+1)) {
+				i = cache_next = hls_cache_write(cache, mpd, rep, i, count, &txt, out, &last_kms);
+				if (i==count) break;
+			}
+			txt_start = txt.size;
 			sctx = gf_list_get(rep->state_seg_list, i);
 			gf_assert(sctx->filename);
 
-			hls_insert_crypt_info(out, rep, sctx, &last_kms);
+			hls_insert_crypt_info(&txt, rep, sctx, &last_kms);
 
 			u64 next_br_start_plus_one=0;
 			u32 next_seg_idx=0;
@@ -4022,28 +5327,26 @@ static GF_Err gf_mpd_write_m3u8_playlist(const GF_MPD *mpd, const GF_MPD_Period
 						next_seg_idx = k+1;
 					}
 
-					gf_fprintf(out, "#EXT-X-PART:DURATION=%g,URI=\"%s", dur, force_url ? force_url : sctx->filename);
+					mpd_text_printf(&txt, "#EXT-X-PART:DURATION=%g,URI=\"%s", dur, force_url ? force_url : sctx->filename);
 					if (force_url ) {
 						gf_free(force_url);
 						force_url = NULL;
 					}
 
 					if (write_br) {
-						gf_fprintf(out, "\",BYTERANGE=\""LLU"@"LLU"\"", sctx->frags[k].size, sctx->frags[k].offset );
+						mpd_text_printf(&txt, "\",BYTERANGE=\""LLU"@"LLU"\"", sctx->frags[k].size, sctx->frags[k].offset );
 						next_br_start_plus_one = 1 + sctx->frags[k].offset + sctx->frags[k].size;
 					} else {
-						gf_fprintf(out, "\"");
+						mpd_text_printf(&txt, "\"");
 					}
 
 					if (sctx->frags[k].independent)
-						gf_fprintf(out, ",INDEPENDENT=YES");
-					gf_fprintf(out, "\n");
+						mpd_text_printf(&txt, ",INDEPENDENT=YES");
+					mpd_text_printf(&txt, "\n");
 				}
 				//live edge not done yet
 				if (!sctx->llhls_mode) {
-					if (close_file)
-						gf_fclose(out);
-					return GF_OK;
+					goto exit;
 				}
 			}
 
@@ -4065,9 +5368,9 @@ static GF_Err gf_mpd_write_m3u8_playlist(const GF_MPD *mpd, const GF_MPD_Period
 						char *res = gf_mpd_resolve_subnumber(sctx->llhas_template, force_url ? force_url : sctx->filename, next_seg_idx);
 						if (force_url ) gf_free(force_url);
 						force_url = res;;
-						gf_fprintf(out, "#EXT-X-PRELOAD-HINT:TYPE=PART,URI=\"%s\"\n", force_url);
+						mpd_text_printf(&txt, "#EXT-X-PRELOAD-HINT:TYPE=PART,URI=\"%s\"\n", force_url);
 					} else if (next_br_start_plus_one)
-						gf_fprintf(out, "#EXT-X-PRELOAD-HINT:TYPE=PART,URI=\"%s\",BYTERANGE-START="LLU"\n", force_url ? force_url : sctx->filename, next_br_start_plus_one-1);
+						mpd_text_printf(&txt, "#EXT-X-PRELOAD-HINT:TYPE=PART,URI=\"%s\",BYTERANGE-START="LLU"\n", force_url ? force_url : sctx->filename, next_br_start_plus_one-1);
 
 					if (force_url) {
 						gf_free(force_url);
@@ -4107,29 +5410,34 @@ static GF_Err gf_mpd_write_m3u8_playlist(const GF_MPD *mpd, const GF_MPD_Period
 								gf_dynstrcat(&par_url, "../", NULL);
 								gf_dynstrcat(&par_url, o_name, NULL);
 							}
-							fprintf(out, "#EXT-X-RENDITION-REPORT:URI=\"%s\",LAST-MSN=%d,LAST-PART=%d\n", par_url ? par_url : o_name, o_sctx->seg_num, o_sctx->nb_frags);
+							mpd_text_printf(&txt, "#EXT-X-RENDITION-REPORT:URI=\"%s\",LAST-MSN=%d,LAST-PART=%d\n", par_url ? par_url : o_name, o_sctx->seg_num, o_sctx->nb_frags);
 							if (par_url) gf_free(par_url);
 						}
 					}
 				}
 
-				if (close_file)
-					gf_fclose(out);
-				return GF_OK;
+				goto exit;
 			}
 			dur = (Double) sctx->dur;
 			dur /= rep->timescale;
-			gf_fprintf(out,"#EXTINF:%g,\n", dur);
+			mpd_text_printf(&txt,"#EXTINF:%g,\n", dur);
 
 			if (force_base_url)
 				force_url = gf_url_concatenate(force_base_url, sctx->filename);
 
-			gf_fprintf(out,"%s\n", force_url ? force_url : sctx->filename);
+			mpd_text_printf(&txt,"%s\n", force_url ? force_url : sctx->filename);
 
 			if (force_url) {
 				gf_free(force_url);
 				force_url = NULL;
 			}
+
+			if (cache && (i>rep->tsb_first_entry) && (i==cache_next) && hls_entry_is_stable(mpd, sctx, i, count)) {
+				hls_cache_add(cache, sctx, &txt, txt_start);
+				cache_next++;
+			}
+			if (txt.size > MPD_TEXT_FLUSH_SIZE)
+				mpd_text_flush(&txt, out);
 		}
 	}
 	//byte-range in single file
@@ -4159,9 +5467,9 @@ static GF_Err gf_mpd_write_m3u8_playlist(const GF_MPD *mpd, const GF_MPD_Period
 				force_url = gf_url_concatenate(force_base_url, b_url);
 
 			if (init->byte_range) {
-				gf_fprintf(out,"#EXT-X-MAP:URI=\"%s\",BYTERANGE=\"%d@"LLU"\"\n", force_url ? force_url : b_url, (u32) (1+init->byte_range->end_range - init->byte_range->start_range), init->byte_range->start_range);
+				mpd_text_printf(&txt,"#EXT-X-MAP:URI=\"%s\",BYTERANGE=\"%d@"LLU"\"\n", force_url ? force_url : b_url, (u32) (1+init->byte_range->end_range - init->byte_range->start_range), init->byte_range->start_range);
 			} else {
-				gf_fprintf(out,"#EXT-X-MAP:URI=\"%s\"\n", force_url ? force_url : b_url);
+				mpd_text_printf(&txt,"#EXT-X-MAP:URI=\"%s\"\n", force_url ? force_url : b_url);
 			}
 
 			if (force_url) {
@@ -4170,33 +5478,52 @@ static GF_Err gf_mpd_write_m3u8_playlist(const GF_MPD *mpd, const GF_MPD_Period
 			}
 		}
 
+		if (mpd->type == GF_MPD_TYPE_DYNAMIC)
+			cache = hls_cache_get(rep, force_base_url, b_url);
+
 		for (i=rep->tsb_first_entry; i<count; i++) {
 			Double dur;
+			u32 txt_start;
+			if (cache && (i == rep->tsb_first_entry+1)) {
+				i = cache_next = hls_cache_write(cache, mpd, rep, i, count, &txt, out, &last_kms);
+				if (i==count) break;
+			}
+			txt_start = txt.size;
 			sctx = gf_list_get(rep->state_seg_list, i);
 			gf_assert(!sctx->filename);
 			gf_assert(sctx->file_size);
 
-			hls_insert_crypt_info(out, rep, sctx, &last_kms);
+			hls_insert_crypt_info(&txt, rep, sctx, &last_kms);
 
 			dur = (Double) sctx->dur;
 			dur /= rep->timescale;
-			gf_fprintf(out,"#EXTINF:%g\n", dur);
-			gf_fprintf(out,"#EXT-X-BYTERANGE:%d@"LLU"\n", sctx->file_size, sctx->file_offset);
+			mpd_text_printf(&txt,"#EXTINF:%g\n", dur);
+			mpd_text_printf(&txt,"#EXT-X-BYTERANGE:%d@"LLU"\n", sctx->file_size, sctx->file_offset);
 			if (force_base_url)
 				force_url = gf_url_concatenate(force_base_url, b_url);
 
-			gf_fprintf(out,"%s\n", force_url ? force_url : b_url);
+			mpd_text_printf(&txt,"%s\n", force_url ? force_url : b_url);
 
 			if (force_url) {
 				gf_free(force_url);
 				force_url = NULL;
 			}
+
+			if (cache && (i>rep->tsb_first_entry) && (i==cache_next) && hls_entry_is_stable(mpd, sctx, i, count)) {
+				hls_cache_add(cache, sctx, &txt, txt_start);
+				cache_next++;
+			}
+			if (txt.size > MPD_TEXT_FLUSH_SIZE)
+				mpd_text_flush(&txt, out);
 		}
 	}
 
 	if (mpd->type != GF_MPD_TYPE_DYNAMIC)
-		gf_fprintf(out,"\n#EXT-X-ENDLIST\n");
+		mpd_text_printf(&txt,"\n#EXT-X-ENDLIST\n");
 
+exit:
+	mpd_text_flush(&txt, out);
+	if (txt.data) gf_free(txt.data);
 	if (close_file)
 		gf_fclose(out);
 
@@ -4204,6 +5531,7 @@ static GF_Err gf_mpd_write_m3u8_playlist(const GF_MPD *mpd, const GF_MPD_Period
 }
 
 
+GF_EXPORT
 GF_Err gf_mpd_write_m3u8_master_playlist(GF_MPD const * const mpd, FILE *out, const char* m3u8_name, GF_MPD_Period *period, GF_M3U8WriteMode mode)
 {
 	u32 i, j, hls_version;
@@ -4504,6 +5832,7 @@ GF_Err gf_mpd_write_m3u8_master_playlist(GF_MPD const * const mpd, FILE *out, co
 
 
 
+GF_EXPORT
 GF_Err gf_mpd_write(GF_MPD const * const mpd, FILE *out, Bool compact)
 {
 	u32 i, count, child_idx;
@@ -4639,6 +5968,16 @@ GF_Err gf_mpd_write(GF_MPD const * const mpd, FILE *out, Bool compact)
 		gf_xml_dump_string(out, "<Location>", text, "</Location>");
 		gf_mpd_lf(out, indent);
 	}
+	if (mpd->patch_location) {
+		gf_mpd_extensible_print_nodes(out, mpd->x_children, indent, &child_idx, GF_FALSE);
+		gf_mpd_nl(out, indent+1);
+		if (mpd->patch_ttl)
+			gf_fprintf(out, "<PatchLocation ttl=\"%u\">", mpd->patch_ttl);
+		else
+			gf_fprintf(out, "<PatchLocation>");
+		gf_xml_dump_string(out, NULL, mpd->patch_location, "</PatchLocation>");
+		gf_mpd_lf(out, indent);
+	}
 
 	if (mpd->inject_service_desc) {
 		gf_mpd_extensible_print_nodes(out, mpd->x_children, indent, &child_idx, GF_FALSE);
@@ -6236,7 +7575,7 @@ GF_Err gf_mpd_split_adaptation_sets(GF_MPD *mpd)
 				}
 
 				//serialize
-				gf_mpd_print_adaptation_set(set, f, GF_FALSE, 0, 0);
+				gf_mpd_print_adaptation_set(set, f, GF_FALSE, GF_FALSE, 0, 0);
 				size = (u32) gf_ftell(f);
 				data = gf_malloc(size+1);
 				gf_fseek(f, 0, SEEK_SET);
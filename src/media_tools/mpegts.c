@@ -1099,6 +1099,23 @@ static GF_M2TS_MetadataDescriptor *gf_m2ts_read_metadata_descriptor(GF_BitStream
 }
 
 
+//programs with sections other than the PMT or with MPEG-4 systems streams are not split, as their events may need to declare or update other programs
+static Bool gf_m2ts_program_can_split(GF_M2TS_Demuxer *ts, GF_M2TS_Program *prog)
+{
+	u32 i, count;
+	if (!ts->split_programs || ts->raw_mode || ts->notify_pes_timing) return GF_FALSE;
+	if (prog->pmt_iod) return GF_FALSE;
+	count = gf_list_count(prog->streams);
+	for (i=0; i<count; i++) {
+		GF_M2TS_ES *es = gf_list_get(prog->streams, i);
+		if (es->flags & GF_M2TS_ES_IS_PMT) continue;
+		if (!(es->flags & GF_M2TS_ES_IS_PES)) return GF_FALSE;
+		if (es->flags & GF_M2TS_ES_IS_SL) return GF_FALSE;
+		if (es->mpeg4_es_id || (es->stream_type==GF_M2TS_SYSTEMS_MPEG4_PES)) return GF_FALSE;
+	}
+	return GF_TRUE;
+}
+
 static void gf_m2ts_process_pmt(GF_M2TS_Demuxer *ts, GF_M2TS_SECTION_ES *pmt, GF_List *sections, u8 table_id, u16 ex_table_id, u8 version_number, u8 last_section_number, u32 status)
 {
 	u32 info_length, pos, desc_len, evt_type, nb_es,i;
@@ -1129,6 +1146,9 @@ static void gf_m2ts_process_pmt(GF_M2TS_Demuxer *ts, GF_M2TS_SECTION_ES *pmt, GF
 	}
 	GF_LOG(GF_LOG_DEBUG, GF_LOG_CONTAINER, ("[MPEG-2 TS] PMT Found or updated\n"));
 
+	//packets queued before the update must be processed with the old stream setup
+	if (pmt->program->nb_pending) gf_m2ts_process_program(ts, pmt->program);
+
 	nb_sections = gf_list_count(sections);
 	if (nb_sections > 1) {
 		GF_LOG(GF_LOG_WARNING, GF_LOG_CONTAINER, ("PMT on multiple sections not supported\n"));
@@ -1770,6 +1790,8 @@ static void gf_m2ts_process_pmt(GF_M2TS_Demuxer *ts, GF_M2TS_SECTION_ES *pmt, GF
 			}
 		}
 
+		pmt->program->split = gf_m2ts_program_can_split(ts, pmt->program);
+
 		evt_type = (status&GF_M2TS_TABLE_FOUND) ? GF_M2TS_EVT_PMT_FOUND : GF_M2TS_EVT_PMT_UPDATE;
 		if (ts->on_event) ts->on_event(ts, evt_type, pmt->program);
 	} else {
@@ -2208,7 +2230,7 @@ exit:
 	pes->rap = 0;
 }
 
-static void gf_m2ts_process_pes(GF_M2TS_Demuxer *ts, GF_M2TS_PES *pes, GF_M2TS_Header *hdr, unsigned char *data, u32 data_size, GF_M2TS_AdaptationField *paf)
+static void gf_m2ts_process_pes(GF_M2TS_Demuxer *ts, GF_M2TS_PES *pes, GF_M2TS_Header *hdr, unsigned char *data, u32 data_size, GF_M2TS_AdaptationField *paf, u32 pck_number, u32 pat_number)
 {
 	u8 expect_cc;
 	Bool disc=0;
@@ -2257,12 +2279,12 @@ static void gf_m2ts_process_pes(GF_M2TS_Demuxer *ts, GF_M2TS_PES *pes, GF_M2TS_H
 		pes->before_last_pat_pn = pes->last_pat_packet_number;
 		pes->before_last_pes_start_pn = pes->pes_start_packet_number;
 
-		pes->pes_start_packet_number = ts->pck_number;
+		pes->pes_start_packet_number = pck_number;
 		pes->before_last_pcr_value = pes->program->before_last_pcr_value;
 		pes->before_last_pcr_value_pck_number = pes->program->before_last_pcr_value_pck_number;
 		pes->last_pcr_value = pes->program->last_pcr_value;
 		pes->last_pcr_value_pck_number = pes->program->last_pcr_value_pck_number;
-		pes->last_pat_packet_number = ts->last_pat_start_num;
+		pes->last_pat_packet_number = pat_number;
 	} else if (pes->pes_len && (pes->pck_data_len + data_size == pes->pes_len + 6)) {
 		/* 6 = startcode+stream_id+length*/
 		/*reassemble pes*/
@@ -2308,7 +2330,11 @@ static void gf_m2ts_process_pes(GF_M2TS_Demuxer *ts, GF_M2TS_PES *pes, GF_M2TS_H
 
 void gf_m2ts_flush_all(GF_M2TS_Demuxer *ts, Bool no_force_flush)
 {
-	u32 i;
+	u32 i, count = gf_list_count(ts->programs);
+	for (i=0; i<count; i++) {
+		GF_M2TS_Program *prog = gf_list_get(ts->programs, i);
+		if (prog->nb_pending) gf_m2ts_process_program(ts, prog);
+	}
 	for (i=0; i<GF_M2TS_MAX_STREAMS; i++) {
 		GF_M2TS_ES *stream = ts->ess[i];
 		if (stream && (stream->flags & GF_M2TS_ES_IS_PES)) {
@@ -2488,60 +2514,30 @@ static void gf_m2ts_get_adaptation_field(GF_M2TS_Demuxer *ts, GF_M2TS_Adaptation
 	GF_LOG(GF_LOG_DEBUG, GF_LOG_CONTAINER, ("[MPEG-2 TS] PID %d: Adaptation Field found: Discontinuity %d - RAP %d - PCR: "LLD"\n", pid, paf->discontinuity_indicator, paf->random_access_indicator, paf->PCR_flag ? paf->PCR_base * 300 + paf->PCR_ext : 0));
 }
 
-static GF_Err gf_m2ts_process_packet(GF_M2TS_Demuxer *ts, unsigned char *data)
+//processes adaptation field and payload of a packet, pck_number and pat_number are the packet number and the number of the last PAT packet at the time the packet was received
+static GF_Err gf_m2ts_process_packet_payload(GF_M2TS_Demuxer *ts, unsigned char *data, GF_M2TS_Header *hdr, u32 pck_number, u32 pat_number)
 {
 	GF_M2TS_ES *es;
-	GF_M2TS_Header hdr;
 	GF_M2TS_AdaptationField af, *paf;
 	u32 payload_size, af_size;
 	u32 pos = 0;
 
-	ts->pck_number++;
-
-	/* read TS packet header*/
-	hdr.sync = data[0];
-	if (hdr.sync != 0x47) {
-		GF_LOG(GF_LOG_WARNING, GF_LOG_CONTAINER, ("[MPEG-2 TS] TS Packet %d does not start with sync marker\n", ts->pck_number));
-		return GF_CORRUPTED_DATA;
-	}
-	hdr.error = (data[1] & 0x80) ? 1 : 0;
-	hdr.payload_start = (data[1] & 0x40) ? 1 : 0;
-	hdr.priority = (data[1] & 0x20) ? 1 : 0;
-	hdr.pid = ( (data[1]&0x1f) << 8) | data[2];
-	hdr.scrambling_ctrl = (data[3] >> 6) & 0x3;
-	hdr.adaptation_field = (data[3] >> 4) & 0x3;
-	hdr.continuity_counter = data[3] & 0xf;
-
-	if (hdr.error) {
-		GF_LOG(GF_LOG_WARNING, GF_LOG_CONTAINER, ("[MPEG-2 TS] TS Packet %d has error (PID could be %d)\n", ts->pck_number, hdr.pid));
-		return GF_CORRUPTED_DATA;
-	}
-//#if DEBUG_TS_PACKET
-	GF_LOG(GF_LOG_DEBUG, GF_LOG_CONTAINER, ("[MPEG-2 TS] TS Packet %d PID %d CC %d Encrypted %d\n", ts->pck_number, hdr.pid, hdr.continuity_counter, hdr.scrambling_ctrl));
-//#endif
-
-	if (hdr.scrambling_ctrl) {
-		//TODO add decyphering
-		GF_LOG(GF_LOG_WARNING, GF_LOG_CONTAINER, ("[MPEG-2 TS] TS Packet %d is scrambled - not supported\n", ts->pck_number, hdr.pid));
-		return GF_NOT_SUPPORTED;
-	}
-
 	paf = NULL;
 	payload_size = 184;
 	pos = 4;
-	switch (hdr.adaptation_field) {
+	switch (hdr->adaptation_field) {
 	/*adaptation+data*/
 	case 3:
 		af_size = data[4];
 		if (af_size>183) {
-			GF_LOG(GF_LOG_ERROR, GF_LOG_CONTAINER, ("[MPEG-2 TS] TS Packet %d AF field larger than 183  for AF type 3!\n", ts->pck_number));
+			GF_LOG(GF_LOG_ERROR, GF_LOG_CONTAINER, ("[MPEG-2 TS] TS Packet %d AF field larger than 183  for AF type 3!\n", pck_number));
 			//error
 			return GF_CORRUPTED_DATA;
 		}
 		if (ts->raw_mode==GF_M2TS_RAW_PROBE) return GF_OK;
 		paf = &af;
 		memset(paf, 0, sizeof(GF_M2TS_AdaptationField));
-		if (af_size) gf_m2ts_get_adaptation_field(ts, paf, data+5, af_size, hdr.pid);
+		if (af_size) gf_m2ts_get_adaptation_field(ts, paf, data+5, af_size, hdr->pid);
 		pos += 1+af_size;
 		payload_size = 183 - af_size;
 		break;
@@ -2549,13 +2545,13 @@ static GF_Err gf_m2ts_process_packet(GF_M2TS_Demuxer *ts, unsigned char *data)
 	case 2:
 		af_size = data[4];
 		if (af_size != 183) {
-			GF_LOG(GF_LOG_WARNING, GF_LOG_CONTAINER, ("[MPEG-2 TS] TS Packet %d AF size is %d when it must be 183 for AF type 2\n", ts->pck_number, af_size));
+			GF_LOG(GF_LOG_WARNING, GF_LOG_CONTAINER, ("[MPEG-2 TS] TS Packet %d AF size is %d when it must be 183 for AF type 2\n", pck_number, af_size));
 			return GF_CORRUPTED_DATA;
 		}
 		if (ts->raw_mode==GF_M2TS_RAW_PROBE) return GF_OK;
 		paf = &af;
 		memset(paf, 0, sizeof(GF_M2TS_AdaptationField));
-		gf_m2ts_get_adaptation_field(ts, paf, data+5, af_size, hdr.pid);
+		gf_m2ts_get_adaptation_field(ts, paf, data+5, af_size, hdr->pid);
 		payload_size = 0;
 		/*no payload and no PCR, return*/
 		if (!paf->PCR_flag)
@@ -2571,7 +2567,7 @@ static GF_Err gf_m2ts_process_packet(GF_M2TS_Demuxer *ts, unsigned char *data)
 	data += pos;
 
 	/*PAT*/
-	if (hdr.pid == GF_M2TS_PID_PAT) {
+	if (hdr->pid == GF_M2TS_PID_PAT) {
 		if (ts->raw_mode==GF_M2TS_RAW_FORWARD) {
 			GF_M2TS_TSPCK tspck;
 			memset(&tspck, 0, sizeof(GF_M2TS_TSPCK));
@@ -2579,11 +2575,11 @@ static GF_Err gf_m2ts_process_packet(GF_M2TS_Demuxer *ts, unsigned char *data)
 			ts->on_event(ts, GF_M2TS_EVT_PCK, &tspck);
 			return GF_OK;
 		}
-		gf_m2ts_gather_section(ts, ts->pat, NULL, &hdr, data, payload_size);
+		gf_m2ts_gather_section(ts, ts->pat, NULL, hdr, data, payload_size);
 		return GF_OK;
 	}
 
-	es = ts->ess[hdr.pid];
+	es = ts->ess[hdr->pid];
 	//we work in split mode
 	if (ts->raw_mode) {
 		if (ts->raw_mode==GF_M2TS_RAW_PROBE) return GF_OK;
@@ -2592,12 +2588,12 @@ static GF_Err gf_m2ts_process_packet(GF_M2TS_Demuxer *ts, unsigned char *data)
 		//process PMT table
 		if (es && (es->flags & GF_M2TS_ES_IS_PMT)) {
 			GF_M2TS_SECTION_ES *ses = (GF_M2TS_SECTION_ES *)es;
-			if (ses->sec) gf_m2ts_gather_section(ts, ses->sec, ses, &hdr, data, payload_size);
+			if (ses->sec) gf_m2ts_gather_section(ts, ses->sec, ses, hdr, data, payload_size);
 		}
 		//and forward every packet other than PAT
 		memset(&tspck, 0, sizeof(GF_M2TS_TSPCK));
 		tspck.stream = es;
-		tspck.pid = hdr.pid;
+		tspck.pid = hdr->pid;
 		tspck.data = data - pos;
 		if (paf && paf->PCR_flag) {
 			tspck.pcr_plus_one = paf->PCR_base * 300 + paf->PCR_ext;
@@ -2606,8 +2602,8 @@ static GF_Err gf_m2ts_process_packet(GF_M2TS_Demuxer *ts, unsigned char *data)
 		return GF_OK;
 	}
 
-	if (hdr.pid == GF_M2TS_PID_CAT) {
-		gf_m2ts_gather_section(ts, ts->cat, NULL, &hdr, data, payload_size);
+	if (hdr->pid == GF_M2TS_PID_CAT) {
+		gf_m2ts_gather_section(ts, ts->cat, NULL, hdr, data, payload_size);
 		return GF_OK;
 	}
 
@@ -2617,11 +2613,11 @@ static GF_Err gf_m2ts_process_packet(GF_M2TS_Demuxer *ts, unsigned char *data)
 			for(i=0; i<gf_list_count(ts->programs); i++) {
 				GF_M2TS_PES *first_pes = NULL;
 				GF_M2TS_Program *program = (GF_M2TS_Program *)gf_list_get(ts->programs,i);
-				if(program->pcr_pid != hdr.pid) continue;
+				if(program->pcr_pid != hdr->pid) continue;
 				for (j=0; j<gf_list_count(program->streams); j++) {
 					GF_M2TS_PES *pes = (GF_M2TS_PES *) gf_list_get(program->streams, j);
 					if (pes->flags & GF_M2TS_INHERIT_PCR) {
-						ts->ess[hdr.pid] = (GF_M2TS_ES *) pes;
+						ts->ess[hdr->pid] = (GF_M2TS_ES *) pes;
 						pes->flags |= GF_M2TS_FAKE_PCR | GF_M2TS_ES_IS_PCR_REUSE;
 						break;
 					}
@@ -2637,7 +2633,7 @@ static GF_Err gf_m2ts_process_packet(GF_M2TS_Demuxer *ts, unsigned char *data)
 				break;
 			}
 			if (!es)
-				es = ts->ess[hdr.pid];
+				es = ts->ess[hdr->pid];
 		}
 		if (es) {
 			GF_M2TS_PES_PCK pck;
@@ -2647,7 +2643,7 @@ static GF_Err gf_m2ts_process_packet(GF_M2TS_Demuxer *ts, unsigned char *data)
 
 			if (es->flags & GF_M2TS_FAKE_PCR) {
 				cc = es->program->pcr_cc;
-				es->program->pcr_cc = hdr.continuity_counter;
+				es->program->pcr_cc = hdr->continuity_counter;
 			}
 			else if (es->flags & GF_M2TS_ES_IS_PES) cc = ((GF_M2TS_PES*)es)->cc;
 			else if (((GF_M2TS_SECTION_ES*)es)->sec) cc = ((GF_M2TS_SECTION_ES*)es)->sec->cc;
@@ -2655,11 +2651,11 @@ static GF_Err gf_m2ts_process_packet(GF_M2TS_Demuxer *ts, unsigned char *data)
 			discontinuity = paf->discontinuity_indicator;
 			if ((cc>=0) && es->program->before_last_pcr_value) {
 				//no increment of CC if AF only packet
-				if (hdr.adaptation_field == 2) {
-					if (hdr.continuity_counter != cc) {
+				if (hdr->adaptation_field == 2) {
+					if (hdr->continuity_counter != cc) {
 						discontinuity = GF_TRUE;
 					}
-				} else if (hdr.continuity_counter != ((cc + 1) & 0xF)) {
+				} else if (hdr->continuity_counter != ((cc + 1) & 0xF)) {
 					discontinuity = GF_TRUE;
 				}
 			}
@@ -2668,11 +2664,11 @@ static GF_Err gf_m2ts_process_packet(GF_M2TS_Demuxer *ts, unsigned char *data)
 			prev_diff_in_us = (s64) (es->program->last_pcr_value /27- es->program->before_last_pcr_value/27);
 			es->program->before_last_pcr_value = es->program->last_pcr_value;
 			es->program->before_last_pcr_value_pck_number = es->program->last_pcr_value_pck_number;
-			es->program->last_pcr_value_pck_number = ts->pck_number;
+			es->program->last_pcr_value_pck_number = pck_number;
 			es->program->last_pcr_value = paf->PCR_base * 300 + paf->PCR_ext;
 			if (!es->program->last_pcr_value) es->program->last_pcr_value =  1;
 
-			GF_LOG(GF_LOG_DEBUG, GF_LOG_CONTAINER, ("[MPEG-2 TS] PID %d PCR found "LLU" ("LLU" at 90kHz) - PCR diff is %d us\n", hdr.pid, es->program->last_pcr_value, es->program->last_pcr_value/300, (s32) (es->program->last_pcr_value - es->program->before_last_pcr_value)/27 ));
+			GF_LOG(GF_LOG_DEBUG, GF_LOG_CONTAINER, ("[MPEG-2 TS] PID %d PCR found "LLU" ("LLU" at 90kHz) - PCR diff is %d us\n", hdr->pid, es->program->last_pcr_value, es->program->last_pcr_value/300, (s32) (es->program->last_pcr_value - es->program->before_last_pcr_value)/27 ));
 
 			pck.PTS = es->program->last_pcr_value;
 			pck.stream = (GF_M2TS_PES *)es;
@@ -2683,17 +2679,17 @@ static GF_Err gf_m2ts_process_packet(GF_M2TS_Demuxer *ts, unsigned char *data)
 				u64 diff = ABS(diff_in_us - prev_diff_in_us);
 
 				if ((diff_in_us<0) && (diff_in_us >= -200000)) {
-					GF_LOG(GF_LOG_WARNING, GF_LOG_CONTAINER, ("[MPEG-2 TS] PID %d new PCR, with discontinuity signaled, is less than previously received PCR (diff %d us) but not too large, trying to ignore discontinuity\n", hdr.pid, diff_in_us));
+					GF_LOG(GF_LOG_WARNING, GF_LOG_CONTAINER, ("[MPEG-2 TS] PID %d new PCR, with discontinuity signaled, is less than previously received PCR (diff %d us) but not too large, trying to ignore discontinuity\n", hdr->pid, diff_in_us));
 				}
 
 				//ignore PCR discontinuity indicator if PCR found is larger than previously received PCR and diffence between PCR before and after discontinuity indicator is smaller than 50ms
 				else if ((diff_in_us > 0) && (diff < 200000)) {
-					GF_LOG(GF_LOG_DEBUG, GF_LOG_CONTAINER, ("[MPEG-2 TS] PID %d PCR discontinuity signaled but diff is small (diff %d us - PCR diff %d vs prev PCR diff %d) - ignore it\n", hdr.pid, diff, diff_in_us, prev_diff_in_us));
+					GF_LOG(GF_LOG_DEBUG, GF_LOG_CONTAINER, ("[MPEG-2 TS] PID %d PCR discontinuity signaled but diff is small (diff %d us - PCR diff %d vs prev PCR diff %d) - ignore it\n", hdr->pid, diff, diff_in_us, prev_diff_in_us));
 				} else if (paf->discontinuity_indicator) {
-					GF_LOG(GF_LOG_DEBUG, GF_LOG_CONTAINER, ("[MPEG-2 TS] PID %d PCR discontinuity signaled (diff %d us - PCR diff %d vs prev PCR diff %d)\n", hdr.pid, diff, diff_in_us, prev_diff_in_us));
+					GF_LOG(GF_LOG_DEBUG, GF_LOG_CONTAINER, ("[MPEG-2 TS] PID %d PCR discontinuity signaled (diff %d us - PCR diff %d vs prev PCR diff %d)\n", hdr->pid, diff, diff_in_us, prev_diff_in_us));
 					pck.flags = GF_M2TS_PES_PCK_DISCONTINUITY;
 				} else {
-					GF_LOG(GF_LOG_WARNING, GF_LOG_CONTAINER, ("[MPEG-2 TS] PID %d PCR discontinuity not signaled (diff %d us - PCR diff %d vs prev PCR diff %d)\n", hdr.pid, diff, diff_in_us, prev_diff_in_us));
+					GF_LOG(GF_LOG_WARNING, GF_LOG_CONTAINER, ("[MPEG-2 TS] PID %d PCR discontinuity not signaled (diff %d us - PCR diff %d vs prev PCR diff %d)\n", hdr->pid, diff, diff_in_us, prev_diff_in_us));
 					pck.flags = GF_M2TS_PES_PCK_DISCONTINUITY;
 				}
 			}
@@ -2701,11 +2697,11 @@ static GF_Err gf_m2ts_process_packet(GF_M2TS_Demuxer *ts, unsigned char *data)
 				s64 diff_in_us = (s64) (es->program->last_pcr_value - es->program->before_last_pcr_value) / 27;
 				//if less than 200 ms before PCR loop at the last PCR, this is a PCR loop
 				if (GF_M2TS_MAX_PCR - es->program->before_last_pcr_value < 5400000 /*2*2700000*/) {
-					GF_LOG(GF_LOG_INFO, GF_LOG_CONTAINER, ("[MPEG-2 TS] PID %d PCR loop found from "LLU" to "LLU" \n", hdr.pid, es->program->before_last_pcr_value, es->program->last_pcr_value));
+					GF_LOG(GF_LOG_INFO, GF_LOG_CONTAINER, ("[MPEG-2 TS] PID %d PCR loop found from "LLU" to "LLU" \n", hdr->pid, es->program->before_last_pcr_value, es->program->last_pcr_value));
 				} else if ((diff_in_us<0) && (diff_in_us >= -200000)) {
-					GF_LOG(GF_LOG_WARNING, GF_LOG_CONTAINER, ("[MPEG-2 TS] PID %d new PCR, without discontinuity signaled, is less than previously received PCR (diff %d us) but not too large, trying to ignore discontinuity\n", hdr.pid, diff_in_us));
+					GF_LOG(GF_LOG_WARNING, GF_LOG_CONTAINER, ("[MPEG-2 TS] PID %d new PCR, without discontinuity signaled, is less than previously received PCR (diff %d us) but not too large, trying to ignore discontinuity\n", hdr->pid, diff_in_us));
 				} else {
-					GF_LOG(GF_LOG_WARNING, GF_LOG_CONTAINER, ("[MPEG-2 TS] PID %d PCR found "LLU" is less than previously received PCR "LLU" (PCR diff %g sec) but no discontinuity signaled\n", hdr.pid, es->program->last_pcr_value, es->program->before_last_pcr_value, (GF_M2TS_MAX_PCR - es->program->before_last_pcr_value + es->program->last_pcr_value) / 27000000.0));
+					GF_LOG(GF_LOG_WARNING, GF_LOG_CONTAINER, ("[MPEG-2 TS] PID %d PCR found "LLU" is less than previously received PCR "LLU" (PCR diff %g sec) but no discontinuity signaled\n", hdr->pid, es->program->last_pcr_value, es->program->before_last_pcr_value, (GF_M2TS_MAX_PCR - es->program->before_last_pcr_value + es->program->last_pcr_value) / 27000000.0));
 
 					pck.flags = GF_M2TS_PES_PCK_DISCONTINUITY;
 				}
@@ -2723,40 +2719,204 @@ static GF_Err gf_m2ts_process_packet(GF_M2TS_Demuxer *ts, unsigned char *data)
 
 	/*check for DVB reserved PIDs*/
 	if (!es) {
-		if (hdr.pid == GF_M2TS_PID_SDT_BAT_ST) {
-			gf_m2ts_gather_section(ts, ts->sdt, NULL, &hdr, data, payload_size);
+		if (hdr->pid == GF_M2TS_PID_SDT_BAT_ST) {
+			gf_m2ts_gather_section(ts, ts->sdt, NULL, hdr, data, payload_size);
 			return GF_OK;
-		} else if (hdr.pid == GF_M2TS_PID_NIT_ST) {
+		} else if (hdr->pid == GF_M2TS_PID_NIT_ST) {
 			/*ignore them, unused at application level*/
-			gf_m2ts_gather_section(ts, ts->nit, NULL, &hdr, data, payload_size);
+			gf_m2ts_gather_section(ts, ts->nit, NULL, hdr, data, payload_size);
 			return GF_OK;
-		} else if (hdr.pid == GF_M2TS_PID_EIT_ST_CIT) {
+		} else if (hdr->pid == GF_M2TS_PID_EIT_ST_CIT) {
 			/* ignore EIT messages for the moment */
-			gf_m2ts_gather_section(ts, ts->eit, NULL, &hdr, data, payload_size);
+			gf_m2ts_gather_section(ts, ts->eit, NULL, hdr, data, payload_size);
 			return GF_OK;
-		} else if (hdr.pid == GF_M2TS_PID_TDT_TOT_ST) {
-			gf_m2ts_gather_section(ts, ts->tdt_tot, NULL, &hdr, data, payload_size);
+		} else if (hdr->pid == GF_M2TS_PID_TDT_TOT_ST) {
+			gf_m2ts_gather_section(ts, ts->tdt_tot, NULL, hdr, data, payload_size);
 		} else {
 			/* ignore packet */
 		}
 	} else if (es->flags & GF_M2TS_ES_IS_SECTION) { 	/* The stream uses sections to carry its payload */
 		GF_M2TS_SECTION_ES *ses = (GF_M2TS_SECTION_ES *)es;
-		if (ses->sec) gf_m2ts_gather_section(ts, ses->sec, ses, &hdr, data, payload_size);
+		if (ses->sec) gf_m2ts_gather_section(ts, ses->sec, ses, hdr, data, payload_size);
 	} else {
 		GF_M2TS_PES *pes = (GF_M2TS_PES *)es;
 		/* regular stream using PES packets */
-		if (pes->reframe && payload_size) gf_m2ts_process_pes(ts, pes, &hdr, data, payload_size, paf);
+		if (pes->reframe && payload_size) gf_m2ts_process_pes(ts, pes, hdr, data, payload_size, paf, pck_number, pat_number);
 	}
 
 	return GF_OK;
 }
 
+//packet queued for a split program, with the demuxer state needed when processing it
+struct __m2ts_queued_pck
+{
+	GF_M2TS_Header hdr;
+	u32 pck_number, pat_number;
+	u8 data[188];
+};
+
+static GF_M2TS_Program *gf_m2ts_get_split_program(GF_M2TS_Demuxer *ts, u8 *data, u32 pid)
+{
+	u32 i, count;
+	GF_M2TS_ES *es = ts->ess[pid];
+	if (es) {
+		if ((es->flags & GF_M2TS_ES_IS_PES) && es->program->split) return es->program;
+		return NULL;
+	}
+	//PCR-only PID
+	if (!(data[3] & 0x20) || !data[4] || !(data[5] & 0x10)) return NULL;
+	count = gf_list_count(ts->programs);
+	for (i=0; i<count; i++) {
+		GF_M2TS_Program *prog = gf_list_get(ts->programs, i);
+		if (prog->pcr_pid == pid) return prog->split ? prog : NULL;
+	}
+	return NULL;
+}
+
+static void gf_m2ts_queue_packet(GF_M2TS_Program *prog, u8 *data, GF_M2TS_Header *hdr, u32 pck_number, u32 pat_number)
+{
+	struct __m2ts_queued_pck *qp;
+	if (prog->nb_pending == prog->alloc_pending) {
+		u32 new_alloc = prog->alloc_pending ? 2*prog->alloc_pending : 64;
+		qp = gf_realloc(prog->pending, sizeof(struct __m2ts_queued_pck) * new_alloc);
+		if (!qp) {
+			GF_LOG(GF_LOG_ERROR, GF_LOG_CONTAINER, ("[MPEG-2 TS] Failed to queue packet %d of program %d, dropping\n", pck_number, prog->number));
+			return;
+		}
+		prog->pending = qp;
+		prog->alloc_pending = new_alloc;
+	}
+	qp = &prog->pending[prog->nb_pending];
+	prog->nb_pending++;
+	qp->hdr = *hdr;
+	qp->pck_number = pck_number;
+	qp->pat_number = pat_number;
+	memcpy(qp->data, data, 188);
+}
+
+GF_EXPORT
+GF_Err gf_m2ts_process_program(GF_M2TS_Demuxer *ts, GF_M2TS_Program *prog)
+{
+	u32 i;
+	GF_Err e = GF_OK;
+	if (!ts || !prog) return GF_BAD_PARAM;
+	for (i=0; i<prog->nb_pending; i++) {
+		struct __m2ts_queued_pck *qp = &prog->pending[i];
+		GF_Err pck_e = gf_m2ts_process_packet_payload(ts, qp->data, &qp->hdr, qp->pck_number, qp->pat_number);
+		if (pck_e==GF_NOT_SUPPORTED) pck_e = GF_OK;
+		e |= pck_e;
+	}
+	prog->nb_pending = 0;
+	return e;
+}
+
+static GF_Err gf_m2ts_process_packet(GF_M2TS_Demuxer *ts, unsigned char *data)
+{
+	GF_M2TS_Header hdr;
+
+	ts->pck_number++;
+
+	/* read TS packet header*/
+	hdr.sync = data[0];
+	if (hdr.sync != 0x47) {
+		GF_LOG(GF_LOG_WARNING, GF_LOG_CONTAINER, ("[MPEG-2 TS] TS Packet %d does not start with sync marker\n", ts->pck_number));
+		return GF_CORRUPTED_DATA;
+	}
+	hdr.error = (data[1] & 0x80) ? 1 : 0;
+	hdr.payload_start = (data[1] & 0x40) ? 1 : 0;
+	hdr.priority = (data[1] & 0x20) ? 1 : 0;
+	hdr.pid = ( (data[1]&0x1f) << 8) | data[2];
+	hdr.scrambling_ctrl = (data[3] >> 6) & 0x3;
+	hdr.adaptation_field = (data[3] >> 4) & 0x3;
+	hdr.continuity_counter = data[3] & 0xf;
+
+	if (hdr.error) {
+		GF_LOG(GF_LOG_WARNING, GF_LOG_CONTAINER, ("[MPEG-2 TS] TS Packet %d has error (PID could be %d)\n", ts->pck_number, hdr.pid));
+		return GF_CORRUPTED_DATA;
+	}
+//#if DEBUG_TS_PACKET
+	GF_LOG(GF_LOG_DEBUG, GF_LOG_CONTAINER, ("[MPEG-2 TS] TS Packet %d PID %d CC %d Encrypted %d\n", ts->pck_number, hdr.pid, hdr.continuity_counter, hdr.scrambling_ctrl));
+//#endif
+
+	if (hdr.scrambling_ctrl) {
+		//TODO add decyphering
+		GF_LOG(GF_LOG_WARNING, GF_LOG_CONTAINER, ("[MPEG-2 TS] TS Packet %d is scrambled - not supported\n", ts->pck_number, hdr.pid));
+		return GF_NOT_SUPPORTED;
+	}
+
+	if (ts->split_programs) {
+		GF_M2TS_Program *prog = gf_m2ts_get_split_program(ts, data, hdr.pid);
+		if (prog) {
+			gf_m2ts_queue_packet(prog, data, &hdr, ts->pck_number, ts->last_pat_start_num);
+			return GF_OK;
+		}
+	}
+	return gf_m2ts_process_packet_payload(ts, data, &hdr, ts->pck_number, ts->last_pat_start_num);
+}
+
+//returns the number of packets starting with a sync byte before the first corrupted one
+static u32 gf_m2ts_check_sync(const u8 *data, u32 nb_pck, u32 pck_size)
+{
+	u32 i=0;
+	//sync bytes are one packet apart, check them 4 by 4 without branching on each one
+	while (i+4 <= nb_pck) {
+		const u8 *p = data + i*pck_size;
+		if ((p[0] ^ 0x47) | (p[pck_size] ^ 0x47) | (p[2*pck_size] ^ 0x47) | (p[3*pck_size] ^ 0x47))
+			break;
+		i += 4;
+	}
+	while ((i<nb_pck) && (data[i*pck_size] == 0x47))
+		i++;
+	return i;
+}
+
+//checks if packet would be ignored by gf_m2ts_process_packet, using the ess table as PID dispatch table
+static GFINLINE Bool gf_m2ts_can_skip_packet(GF_M2TS_Demuxer *ts, const u8 *data)
+{
+	GF_M2TS_ES *es;
+	u32 pid = ((data[1]&0x1f) << 8) | data[2];
+	//PSI and DVB tables
+	if (pid < 0x20) return GF_FALSE;
+	//error, scrambled or broken packets are reported by the regular path
+	if ((data[1] & 0x80) || (data[3] & 0xC0)) return GF_FALSE;
+	if (data[3] & 0x20) {
+		if ((data[3] & 0x10) ? (data[4] > 183) : (data[4] != 183)) return GF_FALSE;
+		//PCR, may be used by a program even if the PID is not declared
+		if (data[4] && (data[5] & 0x10)) return GF_FALSE;
+	}
+
+	es = ts->ess[pid];
+	if (!es) return GF_TRUE;
+	if (!(es->flags & GF_M2TS_ES_IS_PES)) return GF_FALSE;
+	//PES not being reframed (skip mode with reset done)
+	return ((GF_M2TS_PES *)es)->reframe ? GF_FALSE : GF_TRUE;
+}
+
+//processes a run of packets and returns the number of packets consumed, stopping at the first packet with a bad sync byte
+static u32 gf_m2ts_process_batch(GF_M2TS_Demuxer *ts, u8 *data, u32 nb_pck, u32 pck_size, GF_Err *e)
+{
+	u32 i;
+	nb_pck = gf_m2ts_check_sync(data, nb_pck, pck_size);
+	for (i=0; i<nb_pck; i++) {
+		GF_Err pck_e;
+		u8 *pck = data + i*pck_size;
+		if (gf_m2ts_can_skip_packet(ts, pck)) {
+			ts->pck_number++;
+			continue;
+		}
+		pck_e = gf_m2ts_process_packet(ts, pck);
+		if (pck_e==GF_NOT_SUPPORTED) pck_e = GF_OK;
+		*e |= pck_e;
+	}
+	return nb_pck;
+}
+
 GF_EXPORT
 GF_Err gf_m2ts_process_data(GF_M2TS_Demuxer *ts, u8 *data, u32 data_size)
 {
 	GF_Err e=GF_OK;
 	u32 pos, pck_size;
-	Bool is_align = 1;
+	Bool is_align = 1, batch;
 
 	if (ts->buffer_size) {
 		//we are sync, copy remaining bytes
@@ -2808,6 +2968,9 @@ GF_Err gf_m2ts_process_data(GF_M2TS_Demuxer *ts, u8 *data, u32 data_size)
 		return GF_OK;
 	}
 	pck_size = ts->prefix_present ? 192 : 188;
+	//batch processing discards packets of unused PIDs without parsing them
+	//not used in raw mode where all packets are forwarded, nor with debug logs so that all packets are traced
+	batch = (!ts->raw_mode && !gf_log_tool_level_on(GF_LOG_CONTAINER, GF_LOG_DEBUG)) ? GF_TRUE : GF_FALSE;
 	for (;;) {
 		/*wait for a complete packet*/
 		if (data_size < pos  + pck_size) {
@@ -2832,6 +2995,12 @@ GF_Err gf_m2ts_process_data(GF_M2TS_Demuxer *ts, u8 *data, u32 data_size)
 			}
 			return e;
 		}
+		if (batch) {
+			u32 nb_pck = (data_size - pos) / pck_size;
+			u32 nb_done = gf_m2ts_process_batch(ts, (u8 *)data + pos, nb_pck, pck_size, &e);
+			pos += nb_done * pck_size;
+			if (nb_done==nb_pck) continue;
+		}
 		/*process*/
 		GF_Err pck_e = gf_m2ts_process_packet(ts, (unsigned char *)data + pos);
 		if (pck_e==GF_NOT_SUPPORTED) pck_e = GF_OK;
@@ -2933,6 +3102,11 @@ void gf_m2ts_reset_parsers_for_program(GF_M2TS_Demuxer *ts, GF_M2TS_Program *pro
 GF_EXPORT
 void gf_m2ts_reset_parsers(GF_M2TS_Demuxer *ts)
 {
+	u32 i, count = gf_list_count(ts->programs);
+	for (i=0; i<count; i++) {
+		GF_M2TS_Program *prog = gf_list_get(ts->programs, i);
+		prog->nb_pending = 0;
+	}
 	gf_m2ts_reset_parsers_for_program(ts, NULL);
 
 	ts->pck_number = 0;
@@ -3158,6 +3332,7 @@ void gf_m2ts_demux_del(GF_M2TS_Demuxer *ts)
 		}
 		if (p->pmt_iod) gf_odf_desc_del((GF_Descriptor *)p->pmt_iod);
 		if (p->metadata_pointer_descriptor)	gf_m2ts_metadata_pointer_descriptor_del(p->metadata_pointer_descriptor);
+		if (p->pending) gf_free(p->pending);
 		gf_free(p);
 	}
 	gf_list_del(ts->programs);
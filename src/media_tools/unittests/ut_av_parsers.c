@@ -0,0 +1,173 @@
+#include "tests.h"
+#include <gpac/internal/media_dev.h>
+
+//1 second of a 50 Mbps stream at 50 fps, one slice per frame
+#define NALU_TEST_SIZE	(50000000/8)
+#define NALU_TEST_FRAMES	50
+
+static u32 nalu_test_seed = 1;
+static u32 nalu_test_rand()
+{
+	nalu_test_seed = nalu_test_seed*1103515245 + 12345;
+	return nalu_test_seed >> 8;
+}
+
+//previous byte by byte versions of the scanners
+static u32 nalu_test_next_start_code_ref(const u8 *data, u32 data_len, u32 *sc_size)
+{
+	u32 avail = data_len;
+	const u8 *cur = data;
+
+	while (cur) {
+		u32 v, bpos;
+		u8 *next_zero = memchr(cur, 0, avail);
+		if (!next_zero) return data_len;
+
+		v = 0xffffff00;
+		bpos = (u32)(next_zero - data) + 1;
+		while (1) {
+			u8 cval;
+			if (bpos == (u32)data_len)
+				return data_len;
+
+			cval = data[bpos];
+			v = ((v << 8) & 0xFFFFFF00) | ((u32)cval);
+			bpos++;
+			if (v == 0x00000001) {
+				*sc_size = 4;
+				return bpos - 4;
+			}
+			else if ((v & 0x00FFFFFF) == 0x00000001) {
+				*sc_size = 3;
+				return bpos - 3;
+			}
+			if (cval)
+				break;
+		}
+		if (bpos >= data_len)
+			break;
+		cur = data + bpos;
+		avail = data_len - bpos;
+	}
+	return data_len;
+}
+
+static u32 nalu_test_remove_emulation_bytes_ref(const u8 *src, u8 *dst, u32 nal_size)
+{
+	u32 i = 0, nb_removed = 0;
+	u8 num_zero = 0;
+	while (i < nal_size) {
+		if ((num_zero == 2) && (src[i] == 0x03) && (i + 1 < nal_size) && (src[i + 1] < 0x04)) {
+			num_zero = 0;
+			nb_removed++;
+			i++;
+		}
+		dst[i - nb_removed] = src[i];
+		if (!src[i]) num_zero++;
+		else num_zero = 0;
+		i++;
+	}
+	return nal_size - nb_removed;
+}
+
+//random payload, zero_rate out of 256 bytes forced to 0, 1 or 3 to stress start code and emulation patterns
+static void nalu_test_fill(u8 *data, u32 size, u32 zero_rate)
+{
+	u32 i;
+	for (i=0; i<size; i++) {
+		u32 r = nalu_test_rand();
+		if ((r & 0xFF) < zero_rate) {
+			r >>= 8;
+			data[i] = (r%4==3) ? 3 : ((r%4==2) ? 1 : 0);
+		} else {
+			data[i] = (r>>8) & 0xFF;
+		}
+	}
+}
+
+unittest(nalu_scan_exact)
+{
+	u32 i, nb_fail = 0;
+	u8 src[300], dst1[300], dst2[300];
+
+	for (i=0; i<200000; i++) {
+		u32 size = nalu_test_rand() % 300;
+		u32 pos1, pos2, sc1=0, sc2=0, len1, len2;
+		nalu_test_fill(src, size, (i%2) ? 200 : 20);
+
+		pos1 = nalu_test_next_start_code_ref(src, size, &sc1);
+		pos2 = gf_media_nalu_next_start_code(src, size, &sc2);
+		if ((pos1 != pos2) || (sc1 != sc2)) nb_fail++;
+
+		len1 = nalu_test_remove_emulation_bytes_ref(src, dst1, size);
+		len2 = gf_media_nalu_remove_emulation_bytes(src, dst2, size);
+		if ((len1 != len2) || memcmp(dst1, dst2, len1)) nb_fail++;
+		//in place
+		len2 = gf_media_nalu_remove_emulation_bytes(src, src, size);
+		if ((len1 != len2) || memcmp(dst1, src, len1)) nb_fail++;
+	}
+	assert_equal(nb_fail, 0);
+}
+
+typedef u32 (*nalu_test_scan)(const u8 *data, u32 data_len, u32 *sc_size);
+typedef u32 (*nalu_test_epb)(const u8 *src, u8 *dst, u32 nal_size);
+
+//splits the stream in NALs and removes emulation prevention bytes, 10 times
+static u32 nalu_test_run(u8 *data, u32 size, u8 *out, nalu_test_scan scan, nalu_test_epb epb, u64 *t_scan, u64 *t_epb)
+{
+	u32 i, nb_bytes=0;
+	*t_scan = *t_epb = 0;
+	for (i=0; i<10; i++) {
+		u32 pos = 0, sc_size = 0;
+		while (pos < size) {
+			u64 now = gf_sys_clock_high_res();
+			u32 next = scan(data+pos, size-pos, &sc_size);
+			if (next < size-pos) next += sc_size;
+			*t_scan += gf_sys_clock_high_res() - now;
+
+			now = gf_sys_clock_high_res();
+			nb_bytes += epb(data+pos, out, next);
+			*t_epb += gf_sys_clock_high_res() - now;
+			pos += next;
+		}
+	}
+	*t_scan /= 10;
+	*t_epb /= 10;
+	return nb_bytes;
+}
+
+//not a pass/fail test beyond result equality: start code and emulation prevention byte scan of a 50 Mbps stream
+unittest(nalu_scan_bench)
+{
+	u32 i, nb_bytes1, nb_bytes2;
+	u64 t_scan1, t_epb1, t_scan2, t_epb2;
+	u8 *data, *out;
+	u32 size = 0;
+
+	if (!ut_bench_enabled()) return;
+
+	data = gf_malloc(NALU_TEST_SIZE);
+	out = gf_malloc(NALU_TEST_SIZE);
+
+	//annex B stream of NALU_TEST_FRAMES slices with emulation prevention bytes
+	nalu_test_seed = 1;
+	for (i=0; i<NALU_TEST_FRAMES; i++) {
+		u32 j, nal_size = NALU_TEST_SIZE/NALU_TEST_FRAMES - 8;
+		u8 *nal;
+		memcpy(data+size, "\x00\x00\x00\x01\x02\x01", 6);
+		size += 6;
+		nal = data+size;
+		nalu_test_fill(nal, nal_size, 0);
+		for (j=2; j<nal_size; j++) {
+			if (!nal[j-2] && !nal[j-1] && (nal[j]<4)) nal[j] = 3;
+		}
+		size += nal_size;
+	}
+
+	nb_bytes1 = nalu_test_run(data, size, out, nalu_test_next_start_code_ref, nalu_test_remove_emulation_bytes_ref, &t_scan1, &t_epb1);
+	nb_bytes2 = nalu_test_run(data, size, out, gf_media_nalu_next_start_code, gf_media_nalu_remove_emulation_bytes, &t_scan2, &t_epb2);
+	assert_equal(nb_bytes1, nb_bytes2);
+	printf("(%d kB stream: start codes "LLU" us -> "LLU" us, emulation bytes "LLU" us -> "LLU" us) ", size/1000, t_scan1, t_scan2, t_epb1, t_epb2);
+	gf_free(data);
+	gf_free(out);
+}
@@ -0,0 +1,149 @@
+#include "tests.h"
+#include <gpac/mpegts.h>
+#include <gpac/constants.h>
+
+#define TSMUX_TEST_FRAMES	1500
+#define TSMUX_TEST_PACK	200
+
+typedef struct
+{
+	GF_ESInterface esi;
+	u32 nb_frames, nb_sent, frame_size, frame_dur;
+	u8 *data;
+} TSMuxTestStream;
+
+static GF_Err tsmux_test_esi_ctrl(GF_ESInterface *ifce, u32 act_type, void *param)
+{
+	GF_ESIPacket pck;
+	TSMuxTestStream *st = ifce->input_udta;
+	if (act_type != GF_ESI_INPUT_DATA_FLUSH) return GF_OK;
+	if (st->nb_sent == st->nb_frames) {
+		ifce->caps |= GF_ESI_STREAM_IS_OVER;
+		return GF_OK;
+	}
+	memset(&pck, 0, sizeof(GF_ESIPacket));
+	pck.flags = GF_ESI_DATA_AU_START | GF_ESI_DATA_AU_END | GF_ESI_DATA_HAS_CTS | GF_ESI_DATA_HAS_DTS;
+	pck.dts = pck.cts = (u64) st->nb_sent * st->frame_dur;
+	pck.duration = st->frame_dur;
+	pck.sap_type = (st->nb_sent % 25) ? 0 : 1;
+	pck.data = st->data;
+	//vary sizes to exercise stuffing and PES packing
+	pck.data_len = st->frame_size - (st->nb_sent * 37) % (st->frame_size/2);
+	st->nb_sent++;
+	return ifce->output_ctrl(ifce, GF_ESI_OUTPUT_DATA_DISPATCH, &pck);
+}
+
+static void tsmux_test_stream(TSMuxTestStream *st, u32 id, u8 stream_type, u32 codecid, u32 frame_size, u32 frame_dur, u32 nb_frames)
+{
+	u32 i;
+	memset(st, 0, sizeof(TSMuxTestStream));
+	st->esi.stream_id = id;
+	st->esi.stream_type = stream_type;
+	st->esi.codecid = codecid;
+	st->esi.timescale = 90000;
+	st->esi.input_ctrl = tsmux_test_esi_ctrl;
+	st->esi.input_udta = st;
+	st->frame_size = frame_size;
+	st->frame_dur = frame_dur;
+	st->nb_frames = nb_frames;
+	st->data = gf_malloc(frame_size);
+	for (i=0; i<frame_size; i++) st->data[i] = (u8) (i*7 + id);
+}
+
+//muxes a video and an audio stream with SDT, either copying packets in a pack buffer as done before or producing them in place
+static u64 tsmux_test_run(u32 rate, Bool in_place, u8 **out, u32 *out_size)
+{
+	u64 now;
+	u32 size=0, alloc, nb_in_pack=0, nb_empty=0;
+	u8 *buf, pack[188*TSMUX_TEST_PACK];
+	TSMuxTestStream video, audio;
+	GF_M2TS_Mux_Program *prog;
+	GF_M2TS_Mux *mux = gf_m2ts_mux_new(rate, 100, GF_FALSE);
+
+	gf_m2ts_mux_set_initial_pcr(mux, 1000);
+	gf_m2ts_mux_enable_sdt(mux, 500);
+	prog = gf_m2ts_mux_program_add(mux, 1, 100, 100, 0, GF_M2TS_MPEG4_SIGNALING_NONE, 0, GF_FALSE, 0);
+	gf_m2ts_mux_program_set_name(prog, "test", "gpac");
+	tsmux_test_stream(&video, 1, GF_STREAM_VISUAL, GF_CODECID_AVC, 8000, 3600, TSMUX_TEST_FRAMES);
+	tsmux_test_stream(&audio, 2, GF_STREAM_AUDIO, GF_CODECID_AAC_MPEG4, 400, 1920, TSMUX_TEST_FRAMES*15/8);
+	gf_m2ts_program_stream_add(prog, &video.esi, 101, GF_TRUE, GF_FALSE, GF_FALSE);
+	gf_m2ts_program_stream_add(prog, &audio.esi, 102, GF_FALSE, GF_FALSE, GF_FALSE);
+	gf_m2ts_mux_update_config(mux, GF_TRUE);
+
+	alloc = 188*1000;
+	buf = gf_malloc(alloc);
+	now = gf_sys_clock_high_res();
+	while (1) {
+		GF_M2TSMuxState status;
+		const u8 *ts_pck;
+		if (size + 188*TSMUX_TEST_PACK > alloc) {
+			alloc *= 2;
+			buf = gf_realloc(buf, alloc);
+		}
+		if (in_place) {
+			gf_m2ts_mux_set_packet_buffer(mux, buf + size);
+			ts_pck = gf_m2ts_mux_process(mux, &status, NULL);
+			if (ts_pck) size += 188;
+		} else {
+			ts_pck = gf_m2ts_mux_process(mux, &status, NULL);
+			if (ts_pck) {
+				memcpy(pack + 188*nb_in_pack, ts_pck, 188);
+				nb_in_pack++;
+			}
+			if (nb_in_pack && (!ts_pck || (nb_in_pack==TSMUX_TEST_PACK) || (status==GF_M2TS_STATE_EOS))) {
+				memcpy(buf + size, pack, 188*nb_in_pack);
+				size += 188*nb_in_pack;
+				nb_in_pack = 0;
+			}
+		}
+		if (status==GF_M2TS_STATE_EOS) break;
+		if (ts_pck) nb_empty = 0;
+		else if (nb_empty++ > 1000) break;
+	}
+	now = gf_sys_clock_high_res() - now;
+
+	gf_m2ts_mux_del(mux);
+	gf_free(video.data);
+	gf_free(audio.data);
+	*out = buf;
+	*out_size = size;
+	return now;
+}
+
+//packets produced in place must be the same as packets produced in the muxer buffer, including padding packets
+unittest(m2ts_mux_in_place)
+{
+	u32 i, size_ref, size;
+	u8 *ref, *data;
+	u32 rates[] = {0, 8000000};
+	for (i=0; i<2; i++) {
+		tsmux_test_run(rates[i], GF_FALSE, &ref, &size_ref);
+		tsmux_test_run(rates[i], GF_TRUE, &data, &size);
+		assert_true(size_ref > 188*TSMUX_TEST_FRAMES);
+		assert_equal(size, size_ref);
+		assert_equal(memcmp(data, ref, MIN(size, size_ref)), 0);
+		gf_free(ref);
+		gf_free(data);
+	}
+}
+
+//not a pass/fail test: variable and constant rate multiplex throughput
+unittest(m2ts_mux_bench)
+{
+	u32 i, size;
+	u8 *data;
+	u32 rates[] = {0, 8000000};
+
+	if (!ut_bench_enabled()) return;
+
+	for (i=0; i<2; i++) {
+		u64 t_copy, t_in_place;
+		t_copy = tsmux_test_run(rates[i], GF_FALSE, &data, &size);
+		gf_free(data);
+		t_in_place = tsmux_test_run(rates[i], GF_TRUE, &data, &size);
+		gf_free(data);
+		if (!t_copy) t_copy = 1;
+		if (!t_in_place) t_in_place = 1;
+		printf("(%s: copy "LLU" MB/s, in place "LLU" MB/s) ", rates[i] ? "cbr" : "vbr", (u64) size / t_copy, (u64) size / t_in_place);
+	}
+}
@@ -0,0 +1,584 @@
+#include "tests.h"
+#include <gpac/mpd.h>
+#include <gpac/xml.h>
+#include <gpac/network.h>
+#include <gpac/thread.h>
+
+static const char *mpd_test_manifest =
+	"<MPD xmlns=\"urn:mpeg:dash:schema:mpd:2011\" id=\"live\" type=\"dynamic\" availabilityStartTime=\"2024-01-01T00:00:00Z\" publishTime=\"2024-01-01T00:00:10Z\" minimumUpdatePeriod=\"PT2S\" minBufferTime=\"PT2S\" profiles=\"urn:mpeg:dash:profile:isoff-live:2011\">"
+	"<PatchLocation ttl=\"60\">patch.mpp?publishTime=2024-01-01T00:00:10Z</PatchLocation>"
+	"<Period id=\"p0\" start=\"PT0S\">"
+	"<AdaptationSet id=\"1\" mimeType=\"video/mp4\">"
+	"<SegmentTemplate timescale=\"1000\" media=\"v_$Time$.m4s\" initialization=\"v_init.mp4\">"
+	"<SegmentTimeline><S t=\"0\" d=\"2000\" r=\"3\"/><S d=\"1000\"/></SegmentTimeline>"
+	"</SegmentTemplate>"
+	"<Representation id=\"v1\" bandwidth=\"100000\" codecs=\"avc1.640028\" width=\"640\" height=\"360\"/>"
+	"</AdaptationSet>"
+	"</Period>"
+	"</MPD>";
+
+static const char *mpd_test_patch =
+	"<Patch xmlns=\"urn:mpeg:dash:schema:mpd-patch:2020\" mpdId=\"live\" originalPublishTime=\"2024-01-01T00:00:10Z\" publishTime=\"2024-01-01T00:00:12Z\">"
+	"<replace sel=\"/MPD/PatchLocation[1]\"><PatchLocation ttl=\"60\">patch.mpp?publishTime=2024-01-01T00:00:12Z</PatchLocation></replace>"
+	"<remove sel=\"/MPD/Period[@id='p0']/AdaptationSet[@id='1']/SegmentTemplate/SegmentTimeline/S[1]\"/>"
+	"<add sel=\"/MPD/Period[@id='p0']/AdaptationSet[@id='1']/SegmentTemplate/SegmentTimeline\"><S t=\"0\" d=\"2000\" r=\"2\"/></add>"
+	"<add sel=\"/MPD/Period[@id='p0']/AdaptationSet[@id='1']/SegmentTemplate/SegmentTimeline/S[1]\" pos=\"before\"><S t=\"0\" d=\"2000\"/></add>"
+	"<add sel=\"/MPD/Period[@id='p0']/AdaptationSet[@id='1']/SegmentTemplate/SegmentTimeline\"><S d=\"2000\"/></add>"
+	"<replace sel=\"/MPD/@minimumUpdatePeriod\">PT4S</replace>"
+	"<add sel=\"/MPD/Period[@id='p0']\" type=\"@duration\">PT30S</add>"
+	"</Patch>";
+
+static GF_XMLNode *mpd_test_parse(GF_DOMParser *parser, const char *str)
+{
+	char *dup = gf_strdup(str);
+	GF_Err e = gf_xml_dom_parse_string(parser, dup);
+	gf_free(dup);
+	if (e) return NULL;
+	return gf_xml_dom_get_root(parser);
+}
+
+static GF_MPD *mpd_test_load(void)
+{
+	GF_DOMParser *parser = gf_xml_dom_new();
+	GF_XMLNode *root = mpd_test_parse(parser, mpd_test_manifest);
+	GF_MPD *mpd = gf_mpd_new();
+	if (gf_mpd_init_from_dom(root, mpd, NULL) != GF_OK) {
+		gf_mpd_del(mpd);
+		mpd = NULL;
+	}
+	gf_xml_dom_del(parser);
+	return mpd;
+}
+
+static GF_Err mpd_test_patch_apply(GF_MPD *mpd, const char *patch_str, GF_List *removed_periods)
+{
+	GF_Err e;
+	GF_DOMParser *parser = gf_xml_dom_new();
+	GF_XMLNode *patch = mpd_test_parse(parser, patch_str);
+	e = gf_mpd_apply_patch(mpd, patch, removed_periods);
+	gf_xml_dom_del(parser);
+	return e;
+}
+
+static GF_MPD_SegmentTimeline *mpd_test_timeline(GF_MPD *mpd)
+{
+	GF_MPD_Period *period = gf_list_get(mpd->periods, 0);
+	GF_MPD_AdaptationSet *set = gf_list_get(period->adaptation_sets, 0);
+	return set->segment_template->segment_timeline;
+}
+
+unittest(mpd_patch_apply)
+{
+	GF_MPD *mpd = mpd_test_load();
+	GF_MPD_SegmentTimeline *tl;
+	GF_MPD_SegmentTimelineEntry *ent;
+
+	assert_not_null(mpd);
+	if (!mpd) return;
+	assert_equal(mpd_test_patch_apply(mpd, mpd_test_patch, NULL), GF_OK);
+	assert_equal(mpd->publishTime, gf_net_parse_date("2024-01-01T00:00:12Z"));
+	assert_equal(mpd->minimum_update_period, 4000);
+	assert_equal(mpd->patch_ttl, 60);
+	assert_equal_str(mpd->patch_location, "patch.mpp?publishTime=2024-01-01T00:00:12Z");
+	assert_equal(((GF_MPD_Period *) gf_list_get(mpd->periods, 0))->duration, 30000);
+
+	tl = mpd_test_timeline(mpd);
+	assert_equal(gf_list_count(tl->entries), 4);
+	ent = gf_list_get(tl->entries, 0);
+	assert_equal(ent->duration, 2000);
+	assert_equal(ent->repeat_count, 0);
+	ent = gf_list_get(tl->entries, 1);
+	assert_equal(ent->duration, 1000);
+	ent = gf_list_get(tl->entries, 2);
+	assert_equal(ent->repeat_count, 2);
+	//no @t, starts at the end of the previous entry
+	ent = gf_list_get(tl->entries, 3);
+	assert_equal(ent->duration, 2000);
+	assert_equal(ent->start_time, 6000);
+	gf_mpd_del(mpd);
+}
+
+//successive live refreshes applied on the same MPD structure
+unittest(mpd_patch_live)
+{
+	GF_MPD *mpd = mpd_test_load();
+	GF_MPD_SegmentTimeline *tl;
+	GF_MPD_SegmentTimelineEntry *ent;
+	GF_MPD_Period *period;
+	GF_List *removed = gf_list_new();
+
+	assert_not_null(mpd);
+	if (!mpd) return;
+	//purge the first entry, append a new one and extend it
+	assert_equal(mpd_test_patch_apply(mpd, "<Patch mpdId=\"live\" originalPublishTime=\"2024-01-01T00:00:10Z\" publishTime=\"2024-01-01T00:00:12Z\">"
+		"<remove sel=\"/MPD/Period[@id='p0']/AdaptationSet[@id='1']/SegmentTemplate/SegmentTimeline/S[@t='0']\"/>"
+		"<add sel=\"/MPD/Period[@id='p0']/AdaptationSet[@id='1']/SegmentTemplate/SegmentTimeline\"><S d=\"2000\"/></add>"
+		"<replace sel=\"/MPD/Period[@id='p0']/AdaptationSet[@id='1']/SegmentTemplate/SegmentTimeline/S[2]/@r\">1</replace>"
+		"</Patch>", NULL), GF_OK);
+	tl = mpd_test_timeline(mpd);
+	assert_equal(gf_list_count(tl->entries), 2);
+	ent = gf_list_get(tl->entries, 1);
+	assert_equal(ent->start_time, 9000);
+	assert_equal(ent->repeat_count, 1);
+
+	//the following entry keeps following a modified entry
+	assert_equal(mpd_test_patch_apply(mpd, "<Patch mpdId=\"live\" originalPublishTime=\"2024-01-01T00:00:12Z\" publishTime=\"2024-01-01T00:00:14Z\">"
+		"<replace sel=\"/MPD/Period[@id='p0']/AdaptationSet[@id='1']/SegmentTemplate/SegmentTimeline/S[@t='8000']/@d\">1500</replace>"
+		"</Patch>", NULL), GF_OK);
+	ent = gf_list_get(tl->entries, 1);
+	assert_equal(ent->start_time, 9500);
+
+	//end of period and new period, removed periods are handed back
+	assert_equal(mpd_test_patch_apply(mpd, "<Patch mpdId=\"live\" originalPublishTime=\"2024-01-01T00:00:14Z\" publishTime=\"2024-01-01T00:00:16Z\">"
+		"<add sel=\"/MPD/Period[@id='p0']\" type=\"@duration\">PT20S</add>"
+		"<add sel=\"/MPD\"><Period id=\"p1\" start=\"PT20S\"/><Period id=\"p2\" start=\"PT40S\"/></add>"
+		"<remove sel=\"/MPD/Period[2]\"/>"
+		"</Patch>", removed), GF_OK);
+	assert_equal(gf_list_count(mpd->periods), 2);
+	period = gf_list_get(mpd->periods, 0);
+	assert_equal(period->duration, 20000);
+	period = gf_list_get(mpd->periods, 1);
+	assert_equal_str(period->ID, "p2");
+	assert_equal(period->start, 40000);
+	assert_equal(gf_list_count(removed), 1);
+	period = gf_list_pop_back(removed);
+	if (period) {
+		assert_equal_str(period->ID, "p1");
+		gf_mpd_period_free(period);
+	}
+	gf_list_del(removed);
+
+	//representations are only selected by @id, other elements are not patched
+	assert_equal(mpd_test_patch_apply(mpd, "<Patch mpdId=\"live\" originalPublishTime=\"2024-01-01T00:00:16Z\" publishTime=\"2024-01-01T00:00:18Z\">"
+		"<remove sel=\"/MPD/Period[1]/AdaptationSet[1]/Representation[1]/@bandwidth\"/></Patch>", NULL), GF_NOT_SUPPORTED);
+	assert_equal(mpd_test_patch_apply(mpd, "<Patch mpdId=\"live\" originalPublishTime=\"2024-01-01T00:00:16Z\" publishTime=\"2024-01-01T00:00:18Z\">"
+		"<add sel=\"/MPD/Period[@id='p0']/AdaptationSet[@id='1']\" type=\"@lang\">en</add></Patch>", NULL), GF_NOT_SUPPORTED);
+	gf_mpd_del(mpd);
+}
+
+//patches for another MPD or MPD version must be rejected
+unittest(mpd_patch_mismatch)
+{
+	GF_MPD *mpd = mpd_test_load();
+	assert_not_null(mpd);
+	if (!mpd) return;
+	assert_equal(mpd_test_patch_apply(mpd, "<Patch mpdId=\"live\" originalPublishTime=\"2024-01-01T00:00:08Z\" publishTime=\"2024-01-01T00:00:12Z\"><remove sel=\"/MPD/PatchLocation\"/></Patch>", NULL), GF_NON_COMPLIANT_BITSTREAM);
+	assert_equal(mpd_test_patch_apply(mpd, "<Patch mpdId=\"other\" originalPublishTime=\"2024-01-01T00:00:10Z\" publishTime=\"2024-01-01T00:00:12Z\"><remove sel=\"/MPD/PatchLocation\"/></Patch>", NULL), GF_NON_COMPLIANT_BITSTREAM);
+	assert_equal(mpd_test_patch_apply(mpd, "<Patch mpdId=\"live\" originalPublishTime=\"2024-01-01T00:00:10Z\" publishTime=\"2024-01-01T00:00:12Z\"><remove sel=\"/MPD/Period[@id='p1']\"/></Patch>", NULL), GF_NOT_FOUND);
+	assert_equal(mpd_test_patch_apply(mpd, "<Patch mpdId=\"live\" originalPublishTime=\"2024-01-01T00:00:10Z\" publishTime=\"2024-01-01T00:00:12Z\"/>", NULL), GF_EOS);
+	assert_not_null(mpd->patch_location);
+	gf_mpd_del(mpd);
+}
+
+#if defined(__GLIBC__) && ((__GLIBC__ > 2) || (__GLIBC_MINOR__ >= 33))
+#include <malloc.h>
+#define mpd_test_heap_size() ((u64) mallinfo2().uordblks)
+#else
+#define mpd_test_heap_size() 0
+#endif
+
+static const char *mpd_test_vod_manifest =
+	"<?xml version=\"1.0\"?>\n"
+	"<MPD xmlns=\"urn:mpeg:dash:schema:mpd:2011\" type=\"static\" mediaPresentationDuration=\"PT10S\" minBufferTime=\"PT2S\" profiles=\"urn:mpeg:dash:profile:full:2011\">\n"
+	"<ProgramInformation><Title>sax</Title></ProgramInformation>\n"
+	"<Period id=\"p0\" duration=\"PT10S\">\n"
+	"<AdaptationSet id=\"1\" mimeType=\"video/mp4\">\n"
+	"<SegmentTemplate timescale=\"1000\" media=\"v_$Time$.m4s\" initialization=\"v_init.mp4\">\n"
+	"<SegmentTimeline><S t=\"1000\" d=\"2000\" r=\"2\"/><S d=\"1000\"><Extra/></S><S t=\"0\" d=\"500\"/><S d=\"500\" k=\"2\"/></SegmentTimeline>\n"
+	"</SegmentTemplate>\n"
+	"<Representation id=\"v1\" bandwidth=\"100000\" codecs=\"avc1.640028\" width=\"640\" height=\"360\"/>\n"
+	"</AdaptationSet>\n"
+	"<AdaptationSet id=\"2\" mimeType=\"audio/mp4\" foo=\"bar\">\n"
+	"<Representation id=\"a1\" bandwidth=\"64000\" codecs=\"mp4a.40.2\">\n"
+	"<SegmentList timescale=\"1000\" duration=\"2000\">\n"
+	"<Initialization sourceURL=\"a_init.mp4\"/>\n"
+	"<SegmentURL media=\"a_1.m4s\" mediaRange=\"0-999\"/>\n"
+	"<SegmentURL media=\"a_2.m4s\" mediaRange=\"1000-1999\" indexRange=\"1000-1099\"/>\n"
+	"<SegmentURL media=\"a_3.m4s\"/>\n"
+	"</SegmentList>\n"
+	"</Representation>\n"
+	"<Custom><SegmentURL media=\"ignored.m4s\"/></Custom>\n"
+	"</AdaptationSet>\n"
+	"</Period>\n"
+	"</MPD>\n";
+
+static Bool mpd_test_write_file(const char *name, const char *str)
+{
+	FILE *f = gf_fopen(name, "wb");
+	if (!f) return GF_FALSE;
+	gf_fwrite(str, (u32) strlen(str), f);
+	gf_fclose(f);
+	return GF_TRUE;
+}
+
+//loads an MPD through the full DOM
+static GF_MPD *mpd_test_load_dom(const char *name)
+{
+	GF_Err e;
+	GF_MPD *mpd;
+	GF_DOMParser *parser = gf_xml_dom_new();
+	if (gf_xml_dom_parse(parser, name, NULL, NULL)) {
+		gf_xml_dom_del(parser);
+		return NULL;
+	}
+	mpd = gf_mpd_new();
+	e = gf_mpd_init_from_dom(gf_xml_dom_get_root(parser), mpd, name);
+	gf_xml_dom_del(parser);
+	if (e) {
+		gf_mpd_del(mpd);
+		return NULL;
+	}
+	return mpd;
+}
+
+static GF_MPD *mpd_test_load_sax(const char *name)
+{
+	GF_MPD *mpd = gf_mpd_new();
+	if (gf_mpd_init_from_file(name, mpd, name)) {
+		gf_mpd_del(mpd);
+		return NULL;
+	}
+	return mpd;
+}
+
+//checks that both MPDs serialize identically
+static Bool mpd_test_same(GF_MPD *mpd1, GF_MPD *mpd2)
+{
+	Bool res = GF_FALSE;
+	u8 *data1=NULL, *data2=NULL;
+	u32 size1=0, size2=0;
+	gf_mpd_write_file(mpd1, "ut_mpd_out1.mpd");
+	gf_mpd_write_file(mpd2, "ut_mpd_out2.mpd");
+	gf_file_load_data("ut_mpd_out1.mpd", &data1, &size1);
+	gf_file_load_data("ut_mpd_out2.mpd", &data2, &size2);
+	if (data1 && data2 && (size1==size2) && !memcmp(data1, data2, size1))
+		res = GF_TRUE;
+	if (data1) gf_free(data1);
+	if (data2) gf_free(data2);
+	gf_file_delete("ut_mpd_out1.mpd");
+	gf_file_delete("ut_mpd_out2.mpd");
+	return res;
+}
+
+//the SAX loader shall produce the same MPD as the DOM one
+unittest(mpd_sax_load)
+{
+	GF_MPD *mpd_dom, *mpd_sax;
+	GF_MPD_Period *period;
+	GF_MPD_AdaptationSet *set;
+	GF_MPD_Representation *rep;
+	GF_MPD_SegmentTimelineEntry *ent;
+
+	assert_true(mpd_test_write_file("ut_mpd_sax.mpd", mpd_test_vod_manifest));
+	mpd_dom = mpd_test_load_dom("ut_mpd_sax.mpd");
+	mpd_sax = mpd_test_load_sax("ut_mpd_sax.mpd");
+	assert_not_null(mpd_dom);
+	assert_not_null(mpd_sax);
+
+	period = gf_list_get(mpd_sax->periods, 0);
+	set = gf_list_get(period->adaptation_sets, 0);
+	assert_equal(gf_list_count(set->segment_template->segment_timeline->entries), 4);
+	ent = gf_list_get(set->segment_template->segment_timeline->entries, 1);
+	assert_equal(ent->start_time, 7000);
+	ent = gf_list_get(set->segment_template->segment_timeline->entries, 3);
+	assert_equal(ent->start_time, 8500);
+	assert_equal(ent->nb_parts, 2);
+	set = gf_list_get(period->adaptation_sets, 1);
+	rep = gf_list_get(set->representations, 0);
+	assert_equal(gf_list_count(rep->segment_list->segment_URLs), 3);
+	assert_true(mpd_test_same(mpd_dom, mpd_sax));
+
+	gf_mpd_del(mpd_dom);
+	gf_mpd_del(mpd_sax);
+
+	//broken documents are rejected as URL errors, as done by the DOM loader of the DASH client
+	mpd_sax = gf_mpd_new();
+	assert_true(mpd_test_write_file("ut_mpd_sax.mpd", "<MPD xmlns=\"urn:mpeg:dash:schema:mpd:2011\"><Period><SegmentList><SegmentURL media=\"a.m4s\"/></Period></MPD>"));
+	assert_equal(gf_mpd_init_from_file("ut_mpd_sax.mpd", mpd_sax, NULL), GF_URL_ERROR);
+	gf_mpd_del(mpd_sax);
+	mpd_sax = gf_mpd_new();
+	assert_true(mpd_test_write_file("ut_mpd_sax.mpd", "<MPD xmlns=\"urn:mpeg:dash:schema:mpd:2011\"><Period><SegmentList><SegmentURL media=\"a.m4s\"/>"));
+	assert_equal(gf_mpd_init_from_file("ut_mpd_sax.mpd", mpd_sax, NULL), GF_URL_ERROR);
+	gf_mpd_del(mpd_sax);
+	gf_file_delete("ut_mpd_sax.mpd");
+}
+
+#define MPD_TEST_NB_SEGS	100000
+
+//heap peak sampled while a manifest is loading
+typedef struct
+{
+	volatile Bool run;
+	u64 base, peak;
+} MPDTestHeapPeak;
+
+static u32 mpd_test_heap_sample(void *par)
+{
+	MPDTestHeapPeak *hp = par;
+	while (hp->run) {
+		u64 heap = mpd_test_heap_size();
+		if (heap > hp->peak) hp->peak = heap;
+		gf_sleep(1);
+	}
+	return 0;
+}
+
+static void mpd_test_heap_peak_start(MPDTestHeapPeak *hp, GF_Thread *th)
+{
+	hp->base = hp->peak = mpd_test_heap_size();
+	hp->run = GF_TRUE;
+	gf_th_run(th, mpd_test_heap_sample, hp);
+}
+
+static u64 mpd_test_heap_peak_stop(MPDTestHeapPeak *hp, GF_Thread *th)
+{
+	u64 heap = mpd_test_heap_size();
+	hp->run = GF_FALSE;
+	gf_th_stop(th);
+	if (heap > hp->peak) hp->peak = heap;
+	return hp->peak - hp->base;
+}
+
+//not a pass/fail test beyond result equality: 100k segment URLs loaded through the DOM and through SAX
+unittest(mpd_sax_load_bench)
+{
+	u32 i;
+	u64 now, t_dom, t_sax, mem_dom, mem_sax;
+	GF_MPD *mpd_dom, *mpd_sax;
+	GF_DOMParser *parser;
+	GF_Thread *th;
+	MPDTestHeapPeak hp;
+	FILE *f;
+
+	if (!ut_bench_enabled()) return;
+
+	f = gf_fopen("ut_mpd_bench.mpd", "wb");
+	assert_not_null(f);
+	if (!f) return;
+	gf_fprintf(f, "<?xml version=\"1.0\"?>\n<MPD xmlns=\"urn:mpeg:dash:schema:mpd:2011\" type=\"static\" mediaPresentationDuration=\"PT%dS\" minBufferTime=\"PT2S\" profiles=\"urn:mpeg:dash:profile:full:2011\">\n", MPD_TEST_NB_SEGS);
+	gf_fprintf(f, "<Period><AdaptationSet mimeType=\"video/mp4\"><Representation id=\"1\" bandwidth=\"1000000\" codecs=\"avc1.640028\">\n");
+	gf_fprintf(f, "<SegmentList timescale=\"1000\" duration=\"1000\"><Initialization sourceURL=\"init.mp4\"/>\n");
+	for (i=0; i<MPD_TEST_NB_SEGS; i++)
+		gf_fprintf(f, "<SegmentURL media=\"segment_%d.m4s\" mediaRange=\"%d-%d\"/>\n", i, i*1000, i*1000+999);
+	gf_fprintf(f, "</SegmentList></Representation></AdaptationSet></Period></MPD>\n");
+	gf_fclose(f);
+
+	//memory is the heap peak during the load, sampled by a helper thread
+	th = gf_th_new("mpd_heap");
+	assert_not_null(th);
+	if (!th) return;
+	memset(&hp, 0, sizeof(MPDTestHeapPeak));
+
+	mpd_test_heap_peak_start(&hp, th);
+	now = gf_sys_clock_high_res();
+	parser = gf_xml_dom_new();
+	gf_xml_dom_parse(parser, "ut_mpd_bench.mpd", NULL, NULL);
+	mpd_dom = gf_mpd_new();
+	gf_mpd_init_from_dom(gf_xml_dom_get_root(parser), mpd_dom, NULL);
+	gf_xml_dom_del(parser);
+	t_dom = gf_sys_clock_high_res() - now;
+	mem_dom = mpd_test_heap_peak_stop(&hp, th);
+	gf_th_del(th);
+
+	th = gf_th_new("mpd_heap");
+	assert_not_null(th);
+	if (!th) {
+		gf_mpd_del(mpd_dom);
+		return;
+	}
+	mpd_test_heap_peak_start(&hp, th);
+	now = gf_sys_clock_high_res();
+	mpd_sax = mpd_test_load_sax("ut_mpd_bench.mpd");
+	t_sax = gf_sys_clock_high_res() - now;
+	mem_sax = mpd_test_heap_peak_stop(&hp, th);
+	gf_th_del(th);
+	gf_file_delete("ut_mpd_bench.mpd");
+
+	assert_not_null(mpd_sax);
+	assert_true(mpd_test_same(mpd_dom, mpd_sax));
+	printf("(%d segments: DOM "LLU" ms "LLU" kB, SAX "LLU" ms "LLU" kB) ", MPD_TEST_NB_SEGS, t_dom/1000, mem_dom/1000, t_sax/1000, mem_sax/1000);
+	gf_mpd_del(mpd_dom);
+	gf_mpd_del(mpd_sax);
+}
+
+//6 hours timeshift window of 2s segments
+//timeshift window in segments: 6 hours in benchmark mode
+#define MPD_TEST_LIVE_SEGS_BENCH	10800
+#define MPD_TEST_LIVE_SEGS	300
+#define MPD_TEST_LIVE_REPS	4
+#define MPD_TEST_LIVE_UPDATES	10
+
+//audio-like segment durations, one S element per segment
+static u32 mpd_test_live_segs = MPD_TEST_LIVE_SEGS;
+#define mpd_test_live_dur(_n) (((_n)%2) ? 1990 : 2010)
+
+static GF_MPD *mpd_test_live_new(const char *prefix)
+{
+	u32 i;
+	GF_MPD *mpd = gf_mpd_new();
+	GF_MPD_Period *period = gf_mpd_period_new();
+	mpd->periods = gf_list_new();
+	mpd->type = GF_MPD_TYPE_DYNAMIC;
+	mpd->xml_namespace = "urn:mpeg:dash:schema:mpd:2011";
+	mpd->profiles = gf_strdup("urn:mpeg:dash:profile:isoff-live:2011");
+	mpd->availabilityStartTime = 1704067200000;
+	mpd->publishTime = 1704067200000;
+	mpd->time_shift_buffer_depth = mpd_test_live_segs*2000;
+	mpd->create_m3u8_files = GF_TRUE;
+	period->ID = gf_strdup("p0");
+	gf_list_add(mpd->periods, period);
+	for (i=0; i<MPD_TEST_LIVE_REPS; i++) {
+		char szName[100];
+		GF_MPD_AdaptationSet *set = gf_mpd_adaptation_set_new();
+		GF_MPD_Representation *rep = gf_mpd_representation_new();
+		set->starts_with_sap = 1;
+		set->mime_type = gf_strdup("video/mp4");
+		GF_SAFEALLOC(set->segment_template, GF_MPD_SegmentTemplate);
+		set->segment_template->timescale = 1000;
+		set->segment_template->start_number = (u32) -1;
+		set->segment_template->media = gf_strdup("v_$RepresentationID$_$Time$.m4s");
+		set->segment_template->initialization = gf_strdup("v_$RepresentationID$_init.mp4");
+		set->segment_template->segment_timeline = gf_mpd_segmentimeline_new();
+		gf_list_add(period->adaptation_sets, set);
+
+		sprintf(szName, "%d", i+1);
+		rep->id = gf_strdup(szName);
+		rep->codecs = gf_strdup("avc1.640028");
+		rep->bandwidth = 1000000 * (i+1);
+		rep->width = 320 * (i+1);
+		rep->height = 180 * (i+1);
+		rep->timescale = rep->timescale_mpd = 1000;
+		rep->hls_max_seg_dur.num = 2010;
+		rep->hls_max_seg_dur.den = 1000;
+		rep->state_seg_list = gf_list_new();
+		sprintf(szName, "ut_mpd_%s_%d.m3u8", prefix, i+1);
+		rep->m3u8_name = gf_strdup(szName);
+		gf_list_add(set->representations, rep);
+	}
+	return mpd;
+}
+
+//appends a segment to each representation and purges segments out of the timeshift window
+static void mpd_test_live_push(GF_MPD *mpd, u32 seg_num)
+{
+	u32 i;
+	u64 time = ((u64) seg_num/2) * 4000;
+	GF_MPD_Period *period = gf_list_get(mpd->periods, 0);
+	if (seg_num%2) time += 2010;
+
+	for (i=0; i<MPD_TEST_LIVE_REPS; i++) {
+		char szName[100];
+		GF_MPD_AdaptationSet *set = gf_list_get(period->adaptation_sets, i);
+		GF_MPD_Representation *rep = gf_list_get(set->representations, 0);
+		GF_List *entries = set->segment_template->segment_timeline->entries;
+		GF_MPD_SegmentTimelineEntry *ent;
+		GF_DASH_SegmentContext *sctx;
+
+		GF_SAFEALLOC(ent, GF_MPD_SegmentTimelineEntry);
+		ent->start_time = time;
+		ent->duration = mpd_test_live_dur(seg_num);
+		gf_list_add(entries, ent);
+
+		GF_SAFEALLOC(sctx, GF_DASH_SegmentContext);
+		sctx->time = time;
+		sctx->dur = mpd_test_live_dur(seg_num);
+		sctx->seg_num = seg_num;
+		sprintf(szName, "v_%d_"LLU".m4s", i+1, time);
+		sctx->filename = gf_strdup(szName);
+		gf_list_add(rep->state_seg_list, sctx);
+
+		if (gf_list_count(entries) > mpd_test_live_segs) {
+			gf_free(gf_list_pop_front(entries));
+			sctx = gf_list_pop_front(rep->state_seg_list);
+			gf_free(sctx->filename);
+			gf_free(sctx);
+		}
+	}
+}
+
+static u64 mpd_test_live_write(GF_MPD *mpd, const char *name)
+{
+	u64 now = gf_sys_clock_high_res();
+	FILE *f = gf_fopen(name, "wb");
+	if (!f) return 0;
+	if (strstr(name, ".m3u8"))
+		gf_mpd_write_m3u8_master_playlist(mpd, f, name, gf_list_get(mpd->periods, 0), GF_M3U8_WRITE_ALL);
+	else
+		gf_mpd_write(mpd, f, GF_FALSE);
+	gf_fclose(f);
+	return gf_sys_clock_high_res() - now;
+}
+
+static Bool mpd_test_same_file(const char *name1, const char *name2)
+{
+	Bool res = GF_FALSE;
+	u8 *data1=NULL, *data2=NULL;
+	u32 size1=0, size2=0;
+	gf_file_load_data(name1, &data1, &size1);
+	gf_file_load_data(name2, &data2, &size2);
+	if (data1 && data2 && (size1==size2) && !memcmp(data1, data2, size1))
+		res = GF_TRUE;
+	if (data1) gf_free(data1);
+	if (data2) gf_free(data2);
+	gf_file_delete(name1);
+	gf_file_delete(name2);
+	return res;
+}
+
+//live MPD and HLS updates serialized from scratch or from the previous update must be identical
+static u32 mpd_test_live_run(u32 nb_segs, u64 *t_mpd_full, u64 *t_mpd_inc, u64 *t_hls_full, u64 *t_hls_inc)
+{
+	u32 i, j, nb_fail=0;
+	GF_MPD *mpd_inc;
+
+	mpd_test_live_segs = nb_segs;
+	*t_mpd_full = *t_mpd_inc = *t_hls_full = *t_hls_inc = 0;
+	mpd_inc = mpd_test_live_new("inc");
+	for (i=0; i<nb_segs; i++)
+		mpd_test_live_push(mpd_inc, i);
+	mpd_test_live_write(mpd_inc, "ut_mpd_inc.mpd");
+	mpd_test_live_write(mpd_inc, "ut_mpd_inc.m3u8");
+
+	for (i=0; i<MPD_TEST_LIVE_UPDATES; i++) {
+		u32 last = nb_segs + i;
+		GF_MPD *mpd_full = mpd_test_live_new("full");
+		for (j=last+1-nb_segs; j<=last; j++)
+			mpd_test_live_push(mpd_full, j);
+		mpd_test_live_push(mpd_inc, last);
+
+		*t_mpd_full += mpd_test_live_write(mpd_full, "ut_mpd_full.mpd");
+		*t_hls_full += mpd_test_live_write(mpd_full, "ut_mpd_full.m3u8");
+		*t_mpd_inc += mpd_test_live_write(mpd_inc, "ut_mpd_inc.mpd");
+		*t_hls_inc += mpd_test_live_write(mpd_inc, "ut_mpd_inc.m3u8");
+		gf_mpd_del(mpd_full);
+
+		if (!mpd_test_same_file("ut_mpd_full.mpd", "ut_mpd_inc.mpd")) nb_fail++;
+		for (j=0; j<MPD_TEST_LIVE_REPS; j++) {
+			char szName1[100], szName2[100];
+			sprintf(szName1, "ut_mpd_full_%d.m3u8", j+1);
+			sprintf(szName2, "ut_mpd_inc_%d.m3u8", j+1);
+			if (!mpd_test_same_file(szName1, szName2)) nb_fail++;
+		}
+	}
+	gf_mpd_del(mpd_inc);
+	gf_file_delete("ut_mpd_full.m3u8");
+	gf_file_delete("ut_mpd_inc.m3u8");
+	return nb_fail;
+}
+
+unittest(mpd_live_update)
+{
+	u64 t_mpd_full, t_mpd_inc, t_hls_full, t_hls_inc;
+	assert_equal(mpd_test_live_run(MPD_TEST_LIVE_SEGS, &t_mpd_full, &t_mpd_inc, &t_hls_full, &t_hls_inc), 0);
+}
+
+//not a pass/fail test beyond result equality: 6 hours timeshift window
+unittest(mpd_live_update_bench)
+{
+	u64 t_mpd_full, t_mpd_inc, t_hls_full, t_hls_inc;
+
+	if (!ut_bench_enabled()) return;
+
+	assert_equal(mpd_test_live_run(MPD_TEST_LIVE_SEGS_BENCH, &t_mpd_full, &t_mpd_inc, &t_hls_full, &t_hls_inc), 0);
+	printf("(%d reps, %d segments per update: MPD "LLU" us -> "LLU" us, HLS "LLU" us -> "LLU" us) ", MPD_TEST_LIVE_REPS, MPD_TEST_LIVE_SEGS_BENCH, t_mpd_full/MPD_TEST_LIVE_UPDATES, t_mpd_inc/MPD_TEST_LIVE_UPDATES, t_hls_full/MPD_TEST_LIVE_UPDATES, t_hls_inc/MPD_TEST_LIVE_UPDATES);
+}
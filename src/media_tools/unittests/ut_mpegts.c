@@ -0,0 +1,392 @@
+#include "tests.h"
+#include <gpac/mpegts.h>
+#include <gpac/filters.h>
+
+#define TS_TEST_PROGS	30
+#define TS_TEST_PCKS	60000
+
+enum
+{
+	TS_TEST_BATCH=0,
+	TS_TEST_LEGACY,
+	TS_TEST_SPLIT,
+};
+
+typedef struct
+{
+	u32 nb_pes, nb_bytes, nb_pcr;
+	u64 pcr_sum;
+	Bool all_progs;
+} TSTestStats;
+
+typedef struct
+{
+	u8 *data;
+	u32 size, alloc;
+	u8 cc[0x2000];
+} TSTestMux;
+
+static u8 *ts_test_packet(TSTestMux *mux, u32 pid, Bool pusi, Bool has_payload)
+{
+	u8 *pck;
+	if (mux->size + 188 > mux->alloc) {
+		mux->alloc = 2*mux->alloc + 188*100;
+		mux->data = gf_realloc(mux->data, mux->alloc);
+	}
+	pck = mux->data + mux->size;
+	mux->size += 188;
+	memset(pck, 0xFF, 188);
+	pck[0] = 0x47;
+	pck[1] = (pusi ? 0x40 : 0) | (pid>>8);
+	pck[2] = pid & 0xFF;
+	pck[3] = 0x10 | (mux->cc[pid] & 0xF);
+	if (has_payload) mux->cc[pid]++;
+	return pck;
+}
+
+static void ts_test_section(TSTestMux *mux, u32 pid, u8 table_id, u32 id, const u8 *payload, u32 len)
+{
+	u32 crc;
+	u8 *pck = ts_test_packet(mux, pid, GF_TRUE, GF_TRUE);
+	u8 *sec = pck+5;
+	pck[4] = 0;
+	sec[0] = table_id;
+	sec[1] = 0xB0 | ((len+9)>>8);
+	sec[2] = (len+9) & 0xFF;
+	sec[3] = id>>8;
+	sec[4] = id & 0xFF;
+	sec[5] = 0xC1;
+	sec[6] = sec[7] = 0;
+	memcpy(sec+8, payload, len);
+	crc = gf_crc_32(sec, len+8);
+	sec[len+8] = crc>>24;
+	sec[len+9] = (crc>>16) & 0xFF;
+	sec[len+10] = (crc>>8) & 0xFF;
+	sec[len+11] = crc & 0xFF;
+}
+
+static void ts_test_psi(TSTestMux *mux)
+{
+	u8 buf[180];
+	u32 i;
+	for (i=0; i<TS_TEST_PROGS; i++) {
+		buf[4*i] = 0;
+		buf[4*i+1] = i+1;
+		buf[4*i+2] = 0xE0 | ((0x100+i)>>8);
+		buf[4*i+3] = (0x100+i) & 0xFF;
+	}
+	ts_test_section(mux, 0, 0, 1, buf, 4*TS_TEST_PROGS);
+	for (i=0; i<TS_TEST_PROGS; i++) {
+		u32 pid = 0x200+i;
+		buf[0] = 0xE0 | (pid>>8);
+		buf[1] = pid & 0xFF;
+		buf[2] = 0xF0;
+		buf[3] = 0;
+		buf[4] = GF_M2TS_VIDEO_H264;
+		buf[5] = 0xE0 | (pid>>8);
+		buf[6] = pid & 0xFF;
+		buf[7] = 0xF0;
+		buf[8] = 0;
+		ts_test_section(mux, 0x100+i, 2, i+1, buf, 9);
+	}
+}
+
+//interleaves multi-packet PES for all programs, first packet of each PES carries the PCR
+static u8 *ts_test_build(u32 *size)
+{
+	u32 i, seed=1, pes_idx[TS_TEST_PROGS], pes_left[TS_TEST_PROGS];
+	TSTestMux mux;
+	memset(&mux, 0, sizeof(TSTestMux));
+	memset(pes_idx, 0, sizeof(pes_idx));
+	memset(pes_left, 0, sizeof(pes_left));
+
+	for (i=0; i<TS_TEST_PCKS; i++) {
+		u32 prog;
+		u8 *pck;
+		if (i%2000 == 0) ts_test_psi(&mux);
+
+		seed = seed * 1103515245 + 12345;
+		if ((seed>>8) % 10 == 0) {
+			ts_test_packet(&mux, 0x1FFF, GF_FALSE, GF_FALSE);
+			continue;
+		}
+		prog = (seed>>12) % TS_TEST_PROGS;
+		if (!pes_left[prog]) {
+			u64 pts = 90000 + 3600 * pes_idx[prog];
+			u64 pcr = pts - 9000;
+			pck = ts_test_packet(&mux, 0x200+prog, GF_TRUE, GF_TRUE);
+			pck[3] |= 0x20;
+			pck[4] = 7;
+			pck[5] = 0x10;
+			pck[6] = (u8) (pcr>>25);
+			pck[7] = (u8) (pcr>>17);
+			pck[8] = (u8) (pcr>>9);
+			pck[9] = (u8) (pcr>>1);
+			pck[10] = (u8) (((pcr&1)<<7) | 0x7E);
+			pck[11] = 0;
+			pck[12] = pck[13] = 0;
+			pck[14] = 1;
+			pck[15] = 0xE0;
+			pck[16] = pck[17] = 0;
+			pck[18] = 0x80;
+			pck[19] = 0x80;
+			pck[20] = 5;
+			pck[21] = 0x21 | (u8) ((pts>>29) & 0x0E);
+			pck[22] = (u8) (pts>>22);
+			pck[23] = (u8) (((pts>>14) & 0xFE) | 1);
+			pck[24] = (u8) (pts>>7);
+			pck[25] = (u8) (((pts<<1) & 0xFE) | 1);
+			memset(pck+26, pes_idx[prog] & 0xFF, 188-26);
+			pes_idx[prog]++;
+			pes_left[prog] = 1 + (seed>>16) % 20;
+		} else {
+			pck = ts_test_packet(&mux, 0x200+prog, GF_FALSE, GF_TRUE);
+			memset(pck+4, pes_left[prog], 184);
+			pes_left[prog]--;
+		}
+	}
+	*size = mux.size;
+	return mux.data;
+}
+
+static void ts_test_on_event(GF_M2TS_Demuxer *ts, u32 evt_type, void *par)
+{
+	u32 i;
+	TSTestStats *st = ts->user;
+	if (evt_type==GF_M2TS_EVT_PMT_FOUND) {
+		GF_M2TS_Program *prog = par;
+		if (!st->all_progs && (prog->number != 1)) return;
+		for (i=0; i<gf_list_count(prog->streams); i++) {
+			GF_M2TS_PES *pes = gf_list_get(prog->streams, i);
+			if (pes->flags & GF_M2TS_ES_IS_PES)
+				gf_m2ts_set_pes_framing(pes, GF_M2TS_PES_FRAMING_DEFAULT);
+		}
+	} else if (evt_type==GF_M2TS_EVT_PES_PCK) {
+		GF_M2TS_PES_PCK *pck = par;
+		st->nb_pes++;
+		st->nb_bytes += pck->data_len;
+	} else if (evt_type==GF_M2TS_EVT_PES_PCR) {
+		GF_M2TS_PES_PCK *pck = par;
+		st->nb_pcr++;
+		st->pcr_sum += pck->PTS;
+	}
+}
+
+static void ts_test_no_log(void *cbck, GF_LOG_Level level, GF_LOG_Tool tool, const char* fmt, va_list vlist)
+{
+}
+
+//demux the stream in chunks, using the regular per-packet path in legacy mode
+//in split mode, queued programs are processed one after the other after each chunk
+static u64 ts_test_demux(u8 *data, u32 size, u32 mode, Bool all_progs, TSTestStats *st)
+{
+	u64 now;
+	u32 i, pos=0;
+	gf_log_cbk prev_cbk=NULL;
+	Bool legacy = (mode==TS_TEST_LEGACY) ? GF_TRUE : GF_FALSE;
+	GF_M2TS_Demuxer *ts = gf_m2ts_demux_new();
+	ts->on_event = ts_test_on_event;
+	ts->user = st;
+	ts->split_programs = (mode==TS_TEST_SPLIT) ? GF_TRUE : GF_FALSE;
+	memset(st, 0, sizeof(TSTestStats));
+	st->all_progs = all_progs;
+	if (legacy) {
+		prev_cbk = gf_log_set_callback(NULL, ts_test_no_log);
+		gf_log_set_tool_level(GF_LOG_CONTAINER, GF_LOG_DEBUG);
+	}
+	now = gf_sys_clock_high_res();
+	while (pos<size) {
+		//odd chunk size to test packets split across calls
+		u32 len = MIN(size-pos, 188*50 + 77);
+		gf_m2ts_process_data(ts, data+pos, len);
+		pos += len;
+		for (i=0; i<gf_list_count(ts->programs); i++) {
+			GF_M2TS_Program *prog = gf_list_get(ts->programs, i);
+			if (prog->nb_pending) gf_m2ts_process_program(ts, prog);
+		}
+	}
+	now = gf_sys_clock_high_res() - now;
+	if (legacy) {
+		gf_log_set_tool_level(GF_LOG_CONTAINER, GF_LOG_WARNING);
+		gf_log_set_callback(NULL, prev_cbk);
+	}
+	gf_m2ts_demux_del(ts);
+	return now;
+}
+
+//packets of unselected programs are dropped early, events must be the same as with the regular path
+unittest(m2ts_demux_batch)
+{
+	u32 size;
+	TSTestStats st_batch, st_ref;
+	u8 *data = ts_test_build(&size);
+	ts_test_demux(data, size, TS_TEST_BATCH, GF_FALSE, &st_batch);
+	ts_test_demux(data, size, TS_TEST_LEGACY, GF_FALSE, &st_ref);
+	assert_true(st_ref.nb_pes > 0);
+	assert_true(st_ref.nb_pcr > 0);
+	assert_equal(st_batch.nb_pes, st_ref.nb_pes);
+	assert_equal(st_batch.nb_bytes, st_ref.nb_bytes);
+	assert_equal(st_batch.nb_pcr, st_ref.nb_pcr);
+	assert_true(st_batch.pcr_sum == st_ref.pcr_sum);
+	gf_free(data);
+}
+
+//programs processed separately must produce the same events as the regular path
+unittest(m2ts_demux_split)
+{
+	u32 size;
+	TSTestStats st_split, st_ref;
+	u8 *data = ts_test_build(&size);
+	ts_test_demux(data, size, TS_TEST_SPLIT, GF_TRUE, &st_split);
+	ts_test_demux(data, size, TS_TEST_BATCH, GF_TRUE, &st_ref);
+	assert_true(st_ref.nb_pes > 0);
+	assert_equal(st_split.nb_pes, st_ref.nb_pes);
+	assert_equal(st_split.nb_bytes, st_ref.nb_bytes);
+	assert_equal(st_split.nb_pcr, st_ref.nb_pcr);
+	assert_true(st_split.pcr_sum == st_ref.pcr_sum);
+	gf_free(data);
+}
+
+#define TS_TEST_FILE	"ut_m2tsdmx_nbth.ts"
+
+//per output PID packet count, size and checksum of packet data and timestamps
+typedef struct
+{
+	u32 nb_pck[TS_TEST_PROGS], nb_bytes[TS_TEST_PROGS];
+	u32 crc[TS_TEST_PROGS];
+	u32 nb_bad_pid;
+} TSDmxTestStats;
+//filter private data is freed with the session
+static TSDmxTestStats ts_dmx_stats;
+
+static GF_Err ts_sink_configure_pid(GF_Filter *filter, GF_FilterPid *pid, Bool is_remove)
+{
+	GF_FilterEvent evt;
+	if (is_remove) return GF_OK;
+	gf_filter_pid_init_play_event(pid, &evt, 0, 1.0, "UTM2TSSink");
+	gf_filter_pid_send_event(pid, &evt);
+	return GF_OK;
+}
+
+static GF_Err ts_sink_process(GF_Filter *filter)
+{
+	u32 i, nb_eos = 0, count = gf_filter_get_ipid_count(filter);
+	for (i=0; i<count; i++) {
+		u32 idx;
+		const GF_PropertyValue *p;
+		GF_FilterPacket *pck;
+		GF_FilterPid *pid = gf_filter_get_ipid(filter, i);
+		p = gf_filter_pid_get_property(pid, GF_PROP_PID_ID);
+		idx = p ? p->value.uint - 0x200 : TS_TEST_PROGS;
+		while ((pck = gf_filter_pid_get_packet(pid))) {
+			u32 size;
+			u64 cts = gf_filter_pck_get_cts(pck);
+			const u8 *data = gf_filter_pck_get_data(pck, &size);
+			if (idx < TS_TEST_PROGS) {
+				ts_dmx_stats.nb_pck[idx]++;
+				ts_dmx_stats.nb_bytes[idx] += size;
+				ts_dmx_stats.crc[idx] = ts_dmx_stats.crc[idx]*31 + (data ? gf_crc_32(data, size) : 0) + (u32) cts;
+			} else {
+				ts_dmx_stats.nb_bad_pid++;
+			}
+			gf_filter_pid_drop_packet(pid);
+		}
+		if (gf_filter_pid_is_eos(pid)) nb_eos++;
+	}
+	if (count && (nb_eos==count)) return GF_EOS;
+	return GF_OK;
+}
+
+static const GF_FilterCapability TSSinkCaps[] =
+{
+	CAP_UINT(GF_CAPS_INPUT, GF_PROP_PID_STREAM_TYPE, GF_STREAM_VISUAL),
+};
+
+static GF_FilterRegister TSSinkRegister = {
+	.name = "UTM2TSSink",
+	GF_FS_SET_DESCRIPTION("TS demuxer output test sink")
+	.max_extra_pids = (u32) -1,
+	.flags = GF_FS_REG_EXPLICIT_ONLY,
+	SETCAPS(TSSinkCaps),
+	.configure_pid = ts_sink_configure_pid,
+	.process = ts_sink_process,
+};
+
+static GF_Err ts_dmx_run(s32 nbth, TSDmxTestStats *st)
+{
+	GF_Err e;
+	char szArgs[100];
+	GF_Filter *src, *dmx, *sink;
+	GF_FilterSession *fs = gf_fs_new(0, GF_FS_SCHEDULER_LOCK_FREE, 0, NULL);
+	if (!fs) return GF_OUT_OF_MEM;
+	memset(&ts_dmx_stats, 0, sizeof(TSDmxTestStats));
+	gf_fs_add_filter_register(fs, &TSSinkRegister);
+	src = gf_fs_load_filter(fs, "fin:src="TS_TEST_FILE, &e);
+	sprintf(szArgs, "m2tsdmx:nbth=%d", nbth);
+	dmx = gf_fs_load_filter(fs, szArgs, &e);
+	sink = gf_fs_load_filter(fs, "UTM2TSSink", &e);
+	if (src && dmx && sink) {
+		gf_filter_set_source(dmx, src, NULL);
+		gf_filter_set_source(sink, dmx, NULL);
+		e = gf_fs_run(fs);
+		if (e>GF_OK) e = GF_OK;
+		if (!e) e = gf_fs_get_last_connect_error(fs);
+		if (!e) e = gf_fs_get_last_process_error(fs);
+	} else if (!e) {
+		e = GF_FILTER_NOT_FOUND;
+	}
+	gf_fs_del(fs);
+	*st = ts_dmx_stats;
+	return e;
+}
+
+//programs processed by worker threads must give the same output as sequential processing
+unittest(m2tsdmx_nbth)
+{
+	u32 i, size, nb_diff = 0, nb_empty = 0;
+	TSDmxTestStats st_ref, st_th;
+	FILE *f;
+	u8 *data = ts_test_build(&size);
+	f = gf_fopen(TS_TEST_FILE, "wb");
+	assert_not_null(f);
+	if (!f) {
+		gf_free(data);
+		return;
+	}
+	gf_fwrite(data, size, f);
+	gf_fclose(f);
+	gf_free(data);
+
+	assert_equal(ts_dmx_run(0, &st_ref), GF_OK);
+	assert_equal(ts_dmx_run(4, &st_th), GF_OK);
+	for (i=0; i<TS_TEST_PROGS; i++) {
+		if (!st_ref.nb_pck[i]) nb_empty++;
+		if ((st_ref.nb_pck[i] != st_th.nb_pck[i]) || (st_ref.nb_bytes[i] != st_th.nb_bytes[i]) || (st_ref.crc[i] != st_th.crc[i]))
+			nb_diff++;
+	}
+	assert_equal(nb_empty, 0);
+	assert_equal(nb_diff, 0);
+	assert_equal(st_ref.nb_bad_pid, 0);
+	assert_equal(st_th.nb_bad_pid, 0);
+	gf_file_delete(TS_TEST_FILE);
+}
+
+//not a pass/fail test: one program selected out of TS_TEST_PROGS
+unittest(m2ts_demux_bench)
+{
+	u32 size, nb_pck;
+	u64 t_batch, t_ref;
+	TSTestStats st;
+	u8 *data;
+
+	if (!ut_bench_enabled()) return;
+
+	data = ts_test_build(&size);
+	nb_pck = size/188;
+	t_batch = ts_test_demux(data, size, TS_TEST_BATCH, GF_FALSE, &st);
+	t_ref = ts_test_demux(data, size, TS_TEST_LEGACY, GF_FALSE, &st);
+	if (!t_batch) t_batch = 1;
+	if (!t_ref) t_ref = 1;
+	printf("(%u packets: batch "LLU" pck/s, regular "LLU" pck/s) ", nb_pck, (u64) nb_pck * 1000000 / t_batch, (u64) nb_pck * 1000000 / t_ref);
+	gf_free(data);
+}
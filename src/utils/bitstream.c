@@ -24,6 +24,7 @@
  */
 
 #include <gpac/bitstream.h>
+#include <gpac/maths.h>
 
 /*the default size for new streams allocation...*/
 #define BS_MEM_BLOCK_ALLOC_SIZE		512
@@ -524,6 +525,53 @@ bs_eof:
 	return 0;
 }
 
+/*fast path for memory read bitstreams: check that at least nb_bytes can be fetched, even if every byte is followed by an emulation prevention byte*/
+#define BS_MEM_FAST(_bs, _nb_bytes) (((_bs)->bsmode == GF_BITSTREAM_READ) && ((_bs)->position + 2*(_nb_bytes) <= (_bs)->size))
+
+/*same as BS_ReadByte in memory read mode, without end of stream checks*/
+static GFINLINE u8 bs_mem_read_byte(GF_BitStream *bs)
+{
+	u8 res = bs->original[bs->position++];
+	if (bs->remove_emul_prevention_byte) {
+		if ((bs->nb_zeros==2) && (res==0x03) && (bs->position<bs->size) && (bs->original[bs->position]<0x04)) {
+			bs->nb_zeros = 0;
+			bs->nb_removed++;
+			res = bs->original[bs->position++];
+		}
+		if (!res) bs->nb_zeros++;
+		else bs->nb_zeros = 0;
+	}
+	return res;
+}
+
+/*reads up to 32 bits using a 64-bit accumulator, state (current byte, nbBits) is kept identical to the bit-by-bit reader*/
+static GFINLINE u32 bs_mem_read_int(GF_BitStream *bs, u32 nBits)
+{
+	u32 ret, last=0, nb_left, extra;
+	u32 nb_avail = 8 - bs->nbBits;
+	//remaining bits of current byte
+	u64 acc = (bs->current & 0xFF) >> bs->nbBits;
+
+	if (nBits <= nb_avail) {
+		ret = (u32) (acc >> (nb_avail - nBits));
+		bs->nbBits += nBits;
+		bs->current <<= nBits;
+		return ret;
+	}
+	nb_left = nBits - nb_avail;
+	while (1) {
+		last = bs_mem_read_byte(bs);
+		acc = (acc<<8) | last;
+		if (nb_left <= 8) break;
+		nb_left -= 8;
+	}
+	extra = 8 - nb_left;
+	ret = (u32) (acc >> extra);
+	bs->nbBits = nb_left;
+	bs->current = last << nb_left;
+	return ret;
+}
+
 #define NO_OPTS
 
 #ifndef NO_OPTS
@@ -557,6 +605,9 @@ u32 gf_bs_read_int(GF_BitStream *bs, u32 nBits)
 	u32 ret;
 	bs->total_bits_read+= nBits;
 
+	if ((nBits<=32) && BS_MEM_FAST(bs, 5))
+		return bs_mem_read_int(bs, nBits);
+
 #ifndef NO_OPTS
 	if (nBits + bs->nbBits <= 8) {
 		bs->nbBits += nBits;
@@ -572,6 +623,64 @@ u32 gf_bs_read_int(GF_BitStream *bs, u32 nBits)
 	return ret;
 }
 
+GF_EXPORT
+Bool gf_bs_read_ue_fast(GF_BitStream *bs, u32 *val, u32 *nb_bits)
+{
+	u32 nb_avail, nb_lead, nb_code, nb_bytes=0, last=0;
+	u32 o_current, o_nbBits, o_zeros, o_removed;
+	u64 o_pos, acc;
+
+	//exp-golomb codes are at most 63 bits (8 bytes)
+	if (!BS_MEM_FAST(bs, 9)) return GF_FALSE;
+
+	o_pos = bs->position;
+	o_current = bs->current;
+	o_nbBits = bs->nbBits;
+	o_zeros = bs->nb_zeros;
+	o_removed = bs->nb_removed;
+
+	nb_avail = 8 - bs->nbBits;
+	acc = (bs->current & 0xFF) >> bs->nbBits;
+	//locate leading 1, acc is the last loaded byte once found
+	while (!acc) {
+		if (nb_bytes==5) goto fallback;
+		last = bs_mem_read_byte(bs);
+		acc = last;
+		nb_avail += 8;
+		nb_bytes++;
+	}
+	nb_lead = nb_avail - gf_get_bit_size((u32) acc);
+	if (nb_lead>=32) goto fallback;
+
+	nb_code = 2*nb_lead + 1;
+	while (nb_avail < nb_code) {
+		last = bs_mem_read_byte(bs);
+		acc = (acc<<8) | last;
+		nb_avail += 8;
+		nb_bytes++;
+	}
+	*val = (u32) ((acc >> (nb_avail - nb_code)) - 1);
+	*nb_bits = nb_code;
+
+	if (!nb_bytes) {
+		bs->nbBits += nb_code;
+		bs->current <<= nb_code;
+	} else {
+		bs->nbBits = 8 - (nb_avail - nb_code);
+		bs->current = last << bs->nbBits;
+	}
+	bs->total_bits_read += nb_code;
+	return GF_TRUE;
+
+fallback:
+	bs->position = o_pos;
+	bs->current = o_current;
+	bs->nbBits = o_nbBits;
+	bs->nb_zeros = o_zeros;
+	bs->nb_removed = o_removed;
+	return GF_FALSE;
+}
+
 GF_EXPORT
 u32 gf_bs_read_u8(GF_BitStream *bs)
 {
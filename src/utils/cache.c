@@ -779,6 +779,10 @@ GF_Err gf_cache_close_write_cache( const DownloadedCacheEntry entry, const GF_Do
 			entry->discard_on_delete = GF_TRUE;
 		}
 	}
+	//a memory entry with a failed download cannot be reused
+	else if (entry->memory_stored && !success) {
+		entry->flags |= CORRUPTED;
+	}
 	entry->write_session = NULL;
 	return e;
 }
@@ -1056,6 +1060,8 @@ Bool gf_cache_is_in_progress(const DownloadedCacheEntry entry)
 {
 	if (!entry) return GF_FALSE;
 	if (entry->writeFilePtr) return GF_TRUE;
+	//aborted memory download, nothing more will be written
+	if (entry->memory_stored && (entry->flags & CORRUPTED)) return GF_FALSE;
 	if (entry->mem_storage && entry->written_in_cache && entry->contentLength && (entry->written_in_cache<entry->contentLength))
 		return GF_TRUE;
 	return GF_FALSE;
@@ -1269,7 +1275,13 @@ Bool gf_cache_is_mem(const DownloadedCacheEntry entry)
 FILE *gf_cache_open_read(const DownloadedCacheEntry entry)
 {
 	if (!entry) return NULL;
-	if (entry->mem_storage) return NULL;
+	if (entry->memory_stored) {
+		//memory entries can only be read back once fully written
+		if (!entry->mem_storage || !entry->written_in_cache || entry->write_session
+			|| (entry->flags & (CORRUPTED|DELETED)) || gf_cache_is_in_progress(entry)
+		)
+			return NULL;
+	}
 	return gf_fopen(entry->cache_filename, "r");
 }
 
@@ -170,6 +170,24 @@ typedef struct
 	struct __gf_download_session *sess;
 } GF_SessTask;
 
+/*!idle HTTP/1.1 keep-alive connection, kept by the download manager for reuse by new sessions to the same server*/
+typedef struct
+{
+	char *server_name;
+	u16 port;
+	Bool use_ssl;
+	GF_Socket *sock;
+#ifdef GPAC_HAS_SSL
+	SSL *ssl;
+#endif
+#ifdef GPAC_HAS_HTTP2
+	u8 h2_upgrade_state;
+#endif
+	u64 idle_since;
+	//max idle time in ms
+	u32 timeout;
+} GF_DMPoolConnection;
+
 struct __gf_download_session
 {
 	/*this is always 0 and helps differenciating downloads from other interfaces (interfaceType != 0)*/
@@ -366,6 +384,12 @@ struct __gf_download_manager
 	Bool (*local_cache_url_provider_cbk)(void *udta, char *url, Bool cache_destroy);
 	void *lc_udta;
 
+	//idle keep-alive connections, oldest first, protected by cache_mx
+	GF_List *conn_pool;
+	u32 pool_max, pool_idle_ms;
+	//connection stats
+	u32 nb_connects, nb_reused, nb_evicted;
+	u64 connect_time;
 
 #ifdef GPAC_HAS_CURL
 	CURLM *curl_multi;
@@ -2462,6 +2486,138 @@ static void gf_dm_disconnect(GF_DownloadSession *sess, HTTPCloseType close_type)
 	gf_mx_v(sess->mx);
 }
 
+static void gf_dm_pool_del_connection(GF_DMPoolConnection *pc)
+{
+#ifdef GPAC_HAS_SSL
+	if (pc->ssl) {
+		SSL_shutdown(pc->ssl);
+		SSL_free(pc->ssl);
+	}
+#endif
+	if (pc->sock) gf_sk_del(pc->sock);
+	gf_free(pc->server_name);
+	gf_free(pc);
+}
+
+//closes idle connections in excess or too old, cache_mx must be held
+static void gf_dm_pool_purge(GF_DownloadManager *dm, u64 now)
+{
+	while (gf_list_count(dm->conn_pool)) {
+		GF_DMPoolConnection *pc = gf_list_get(dm->conn_pool, 0);
+		if ((gf_list_count(dm->conn_pool) <= dm->pool_max) && (now - pc->idle_since < 1000 * (u64) pc->timeout))
+			break;
+		gf_list_rem(dm->conn_pool, 0);
+		GF_LOG(GF_LOG_DEBUG, GF_LOG_HTTP, ("[Downloader] Closing idle connection to %s:%d\n", pc->server_name, pc->port));
+		dm->nb_evicted++;
+		gf_dm_pool_del_connection(pc);
+	}
+}
+
+//moves the connection of a session to the pool of idle connections, only done if the last response was fully received
+static Bool gf_dm_pool_release(GF_DownloadSession *sess)
+{
+	u64 now;
+	u32 timeout;
+	GF_DMPoolConnection *pc;
+	GF_DownloadManager *dm = sess->dm;
+
+	if (!dm || !dm->pool_max || !sess->sock || !sess->server_name || !sess->do_requests) return GF_FALSE;
+	if (sess->status != GF_NETIO_DISCONNECTED) return GF_FALSE;
+	if (sess->server_mode || sess->proxy_enabled || sess->netcap_id) return GF_FALSE;
+	if (sess->flags & GF_NETIO_SESSION_SHARE_SOCKET) return GF_FALSE;
+#ifdef GPAC_HAS_HTTP2
+	if (sess->h2_sess) return GF_FALSE;
+#endif
+#ifdef GPAC_HAS_CURL
+	if (sess->curl_hnd) return GF_FALSE;
+#endif
+
+	now = gf_sys_clock_high_res();
+	timeout = dm->pool_idle_ms;
+	//don't keep the connection longer than the keep-alive timeout announced by the server
+	if (sess->connection_timeout_ms) {
+		u32 elapsed = (u32) ((now - sess->last_fetch_time) / 1000);
+		if (elapsed >= sess->connection_timeout_ms) return GF_FALSE;
+		timeout = MIN(timeout, sess->connection_timeout_ms - elapsed);
+	}
+
+	GF_SAFEALLOC(pc, GF_DMPoolConnection);
+	if (!pc) return GF_FALSE;
+	pc->server_name = gf_strdup(sess->server_name);
+	pc->port = sess->port;
+	pc->use_ssl = (sess->flags & GF_DOWNLOAD_SESSION_USE_SSL) ? GF_TRUE : GF_FALSE;
+	pc->idle_since = now;
+	pc->timeout = timeout;
+	pc->sock = sess->sock;
+	if (sess->sock_group) gf_sk_group_unregister(sess->sock_group, sess->sock);
+	sess->sock = NULL;
+#ifdef GPAC_HAS_SSL
+	pc->ssl = sess->ssl;
+	sess->ssl = NULL;
+#endif
+#ifdef GPAC_HAS_HTTP2
+	pc->h2_upgrade_state = sess->h2_upgrade_state;
+	sess->h2_upgrade_state = 0;
+#endif
+	GF_LOG(GF_LOG_DEBUG, GF_LOG_HTTP, ("[%s] Keeping connection to %s:%d for reuse\n", sess->log_name, pc->server_name, pc->port));
+
+	gf_mx_p(dm->cache_mx);
+	gf_list_add(dm->conn_pool, pc);
+	gf_dm_pool_purge(dm, now);
+	gf_mx_v(dm->cache_mx);
+	return GF_TRUE;
+}
+
+//assigns an idle connection to the same server to the session, if any
+static Bool gf_dm_pool_acquire(GF_DownloadSession *sess)
+{
+	u32 i;
+	u64 now;
+	Bool use_ssl;
+	GF_DMPoolConnection *pc = NULL;
+	GF_DownloadManager *dm = sess->dm;
+
+	if (!dm || !dm->pool_max || !sess->server_name) return GF_FALSE;
+	if (sess->proxy_enabled || sess->netcap_id || (sess->flags & GF_NETIO_SESSION_SHARE_SOCKET)) return GF_FALSE;
+	if (!(sess->flags & GF_NETIO_SESSION_NO_PROXY) && gf_opts_get_key("core", "proxy")) return GF_FALSE;
+	use_ssl = (sess->flags & GF_DOWNLOAD_SESSION_USE_SSL) ? GF_TRUE : GF_FALSE;
+	now = gf_sys_clock_high_res();
+
+	gf_mx_p(dm->cache_mx);
+	gf_dm_pool_purge(dm, now);
+	//most recently used first
+	for (i=gf_list_count(dm->conn_pool); i>0; i--) {
+		GF_DMPoolConnection *a_pc = gf_list_get(dm->conn_pool, i-1);
+		if ((a_pc->port != sess->port) || (a_pc->use_ssl != use_ssl) || strcmp(a_pc->server_name, sess->server_name))
+			continue;
+		gf_list_rem(dm->conn_pool, i-1);
+		//expired, or closed (or unexpected data) since we last used it
+		if ((now - a_pc->idle_since >= 1000 * (u64) a_pc->timeout) || (gf_sk_probe(a_pc->sock) != GF_IP_NETWORK_EMPTY)) {
+			dm->nb_evicted++;
+			gf_dm_pool_del_connection(a_pc);
+			continue;
+		}
+		pc = a_pc;
+		dm->nb_reused++;
+		break;
+	}
+	gf_mx_v(dm->cache_mx);
+	if (!pc) return GF_FALSE;
+
+	sess->sock = pc->sock;
+#ifdef GPAC_HAS_SSL
+	sess->ssl = pc->ssl;
+#endif
+#ifdef GPAC_HAS_HTTP2
+	sess->h2_upgrade_state = pc->h2_upgrade_state;
+#endif
+	if (sess->sock_group) gf_sk_group_register(sess->sock_group, sess->sock);
+	GF_LOG(GF_LOG_INFO, GF_LOG_HTTP, ("[%s] Reusing connection to %s:%d (idle for %d ms) for URL %s\n", sess->log_name, pc->server_name, pc->port, (u32) ((now - pc->idle_since)/1000), sess->remote_path ? sess->remote_path : "undefined"));
+	gf_free(pc->server_name);
+	gf_free(pc);
+	return GF_TRUE;
+}
+
 GF_EXPORT
 void gf_dm_sess_del(GF_DownloadSession *sess)
 {
@@ -2491,6 +2647,8 @@ void gf_dm_sess_del(GF_DownloadSession *sess)
 		gf_list_del_item(sess->dm->all_sessions, sess);
 		gf_mx_v(sess->dm->cache_mx);
 	}
+	//keep connection alive for other sessions
+	gf_dm_pool_release(sess);
 
 	gf_dm_remove_cache_entry_from_session(sess);
 	sess->cache_entry = NULL;
@@ -4026,6 +4184,16 @@ static void gf_dm_connect(GF_DownloadSession *sess)
 	}
 #endif
 
+	if (!sess->sock && !sess->connect_pending && gf_dm_pool_acquire(sess)) {
+		sess->connect_time = 0;
+		sess->status = GF_NETIO_CONNECTED;
+		sess->last_error = GF_OK;
+		gf_dm_sess_notify_state(sess, GF_NETIO_CONNECTED, GF_OK);
+		if (!allow_offline)
+			gf_dm_configure_cache(sess);
+		return;
+	}
+
 	Bool register_sock = GF_FALSE;
 	if (!sess->sock) {
 		sess->sock = gf_sk_new_ex(GF_SOCK_TYPE_TCP, sess->netcap_id);
@@ -4144,6 +4312,12 @@ static void gf_dm_connect(GF_DownloadSession *sess)
 		}
 
 		sess->connect_time = (u32) (gf_sys_clock_high_res() - now);
+		if (sess->dm) {
+			gf_mx_p(sess->dm->cache_mx);
+			sess->dm->nb_connects++;
+			sess->dm->connect_time += sess->connect_time;
+			gf_mx_v(sess->dm->cache_mx);
+		}
 		GF_LOG(GF_LOG_INFO, GF_LOG_HTTP, ("[%s] Connected to %s:%d\n", sess->log_name, proxy, proxy_port));
 		gf_dm_sess_notify_state(sess, GF_NETIO_CONNECTED, GF_OK);
 	}
@@ -4642,6 +4816,10 @@ retry_cache:
 	dm->max_cache_size = gf_opts_get_int("core", "cache-size");
 	dm->allow_broken_certificate = gf_opts_get_bool("core", "broken-cert");
 
+	dm->conn_pool = gf_list_new();
+	dm->pool_max = gf_opts_get_int("core", "dm-pool");
+	dm->pool_idle_ms = gf_opts_get_int("core", "dm-pool-idle");
+
 	gf_mx_v( dm->cache_mx );
 
 #ifdef GPAC_HAS_SSL
@@ -4689,6 +4867,13 @@ void gf_dm_del(GF_DownloadManager *dm)
 	}
 	gf_list_del(dm->all_sessions);
 	dm->all_sessions = NULL;
+	while (gf_list_count(dm->conn_pool)) {
+		GF_DMPoolConnection *pc = gf_list_pop_back(dm->conn_pool);
+		gf_dm_pool_del_connection(pc);
+	}
+	gf_list_del(dm->conn_pool);
+	dm->conn_pool = NULL;
+	GF_LOG(GF_LOG_DEBUG, GF_LOG_HTTP, ("[Downloader] %d connections opened (avg connect time %d us), %d reused, %d idle connections closed\n", dm->nb_connects, dm->nb_connects ? (u32) (dm->connect_time / dm->nb_connects) : 0, dm->nb_reused, dm->nb_evicted));
 	gf_assert( dm->skip_proxy_servers );
 	while (gf_list_count(dm->skip_proxy_servers)) {
 		char *serv = (char*)gf_list_get(dm->skip_proxy_servers, 0);
@@ -7259,6 +7444,16 @@ Bool gf_dm_sess_is_regulated(GF_DownloadSession *sess)
 {
 	return sess ? sess->rate_regulated : GF_FALSE;
 }
+GF_EXPORT
+Bool gf_dm_sess_has_buffered_input(GF_DownloadSession *sess)
+{
+	if (!sess) return GF_FALSE;
+	if (sess->init_data_size || sess->remaining_data_size) return GF_TRUE;
+#ifdef GPAC_HAS_SSL
+	if (sess->ssl && SSL_pending(sess->ssl)) return GF_TRUE;
+#endif
+	return GF_FALSE;
+}
 
 
 /**
@@ -7467,6 +7662,20 @@ u32 gf_dm_get_global_rate(GF_DownloadManager *dm)
 	return 8*ret;
 }
 
+GF_EXPORT
+GF_Err gf_dm_get_connection_stats(GF_DownloadManager *dm, u32 *nb_connects, u32 *nb_reused, u32 *nb_idle, u32 *nb_evicted, u64 *connect_time)
+{
+	if (!dm) return GF_BAD_PARAM;
+	gf_mx_p(dm->cache_mx);
+	if (nb_connects) *nb_connects = dm->nb_connects;
+	if (nb_reused) *nb_reused = dm->nb_reused;
+	if (nb_idle) *nb_idle = gf_list_count(dm->conn_pool);
+	if (nb_evicted) *nb_evicted = dm->nb_evicted;
+	if (connect_time) *connect_time = dm->connect_time;
+	gf_mx_v(dm->cache_mx);
+	return GF_OK;
+}
+
 Bool gf_dm_sess_is_h2(GF_DownloadSession *sess)
 {
 #ifdef GPAC_HAS_HTTP2
@@ -7785,6 +7994,31 @@ GF_Err gf_dm_sess_send(GF_DownloadSession *sess, u8 *data, u32 size)
 	return e;
 }
 
+GF_EXPORT
+GF_Err gf_dm_sess_send_file(GF_DownloadSession *sess, FILE *file, u64 offset, u32 size, u32 *written)
+{
+	GF_Err e;
+	*written = 0;
+#ifdef GPAC_HAS_HTTP2
+	if (sess->h2_sess) return GF_NOT_SUPPORTED;
+#endif
+#ifdef GPAC_HAS_SSL
+	if (sess->ssl) return GF_NOT_SUPPORTED;
+#endif
+	//pending data from previous sends must go first
+	if (sess->async_buf_size) {
+		e = gf_dm_sess_flush_async(sess, GF_TRUE);
+		if (e) return e;
+	}
+
+	e = gf_sk_send_file(sess->sock, file, offset, size, written);
+	if (e==GF_IP_CONNECTION_CLOSED) {
+		sess_connection_closed(sess);
+		sess->status = GF_NETIO_STATE_ERROR;
+	}
+	return e;
+}
+
 void gf_dm_sess_flush_h2(GF_DownloadSession *sess)
 {
 #ifdef GPAC_HAS_HTTP2
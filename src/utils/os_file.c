@@ -1440,8 +1440,9 @@ static GF_FileIO *gf_fileio_from_blob(const char *file_name)
 	u32 blob_size, flags;
 	GF_FileIOBlob *gfio_blob;
 	GF_Err e = gf_blob_get(file_name, &blob_data, &blob_size, &flags);
-	if (e || !blob_data) return NULL;
+	if (e) return NULL;
     gf_blob_release(file_name);
+	if (!blob_data) return NULL;
 
     if (flags) {
         GF_LOG(GF_LOG_ERROR, GF_LOG_CORE, ("[Core] Attempt at creating a GFIO object on blob corrupted or in transfer, not supported !"));
@@ -158,6 +158,17 @@ typedef s32 SOCKET;
 
 #endif
 
+#ifdef GPAC_HAS_EPOLL
+#include <sys/epoll.h>
+#endif
+
+#if defined(GPAC_CONFIG_LINUX) || defined(GPAC_CONFIG_ANDROID)
+#include <sys/sendfile.h>
+#include <signal.h>
+#include <pthread.h>
+#define GPAC_HAS_SENDFILE
+#endif
+
 #endif /*WIN32||_WIN32_WCE*/
 
 #ifdef GPAC_BUILD_FOR_WINXP
@@ -423,6 +434,10 @@ struct __tag_socket
 #ifdef GPAC_HAS_POLL
 	u32 poll_idx;
 #endif
+#ifdef GPAC_HAS_EPOLL
+	//events of interest, and events signaled by the last wait on the socket group if ep_gen matches the group generation
+	u32 ep_mask, ep_events, ep_gen;
+#endif
 
 #ifndef GPAC_DISABLE_NETCAP
 	NetCapInfo *cap_info;
@@ -2856,6 +2871,83 @@ GF_Err gf_sk_send(GF_Socket *sock, const u8 *buffer, u32 length)
 
 }
 
+GF_EXPORT
+GF_Err gf_sk_send_file(GF_Socket *sock, FILE *file, u64 offset, u32 length, u32 *written)
+{
+#ifdef GPAC_HAS_SENDFILE
+	GF_Err e = GF_OK;
+	int fd;
+	off_t pos;
+	u32 count = 0;
+	sigset_t pipe_mask, old_mask;
+	struct timespec no_wait;
+
+	if (written) *written = 0;
+	if (!sock || SOCKET_INVALID(sock->socket) || !file)
+		return GF_BAD_PARAM;
+	if (!(sock->flags & GF_SOCK_IS_TCP) || (sock->flags & GF_SOCK_IS_UN))
+		return GF_NOT_SUPPORTED;
+#ifndef GPAC_DISABLE_NETCAP
+	if (sock->cap_info) return GF_NOT_SUPPORTED;
+#endif
+	if (gf_fileio_check(file)) return GF_NOT_SUPPORTED;
+	fd = fileno(file);
+	if (fd<0) return GF_NOT_SUPPORTED;
+
+	if (! (sock->flags & GF_SOCK_NON_BLOCKING)) {
+		e = poll_select(sock, GF_SK_SELECT_WRITE, sock->usec_wait, GF_FALSE);
+		if (e) return e;
+	}
+
+	//sendfile has no MSG_NOSIGNAL equivalent, block SIGPIPE for this thread while sending
+	sigemptyset(&pipe_mask);
+	sigaddset(&pipe_mask, SIGPIPE);
+	pthread_sigmask(SIG_BLOCK, &pipe_mask, &old_mask);
+
+	pos = (off_t) offset;
+	while (count < length) {
+		ssize_t res = sendfile(sock->socket, fd, &pos, length - count);
+		if (res<0) {
+			switch (LASTSOCKERROR) {
+			case EAGAIN:
+			case EINTR:
+				e = GF_IP_NETWORK_EMPTY;
+				break;
+			case ENOTCONN:
+			case ECONNRESET:
+			case EPIPE:
+				GF_LOG(GF_LOG_INFO, GF_LOG_NETWORK, ("[socket] sendfile failure: %s\n", gf_errno_str(LASTSOCKERROR)));
+				//discard the signal raised
+				no_wait.tv_sec = no_wait.tv_nsec = 0;
+				sigtimedwait(&pipe_mask, NULL, &no_wait);
+				e = GF_IP_CONNECTION_CLOSED;
+				break;
+			case EINVAL:
+			case ENOSYS:
+				//file type not supported, let caller use regular send
+				e = count ? GF_IP_NETWORK_EMPTY : GF_NOT_SUPPORTED;
+				break;
+			default:
+				GF_LOG(GF_LOG_ERROR, GF_LOG_NETWORK, ("[socket] sendfile failure: %s\n", gf_errno_str(LASTSOCKERROR)));
+				e = GF_IP_NETWORK_FAILURE;
+				break;
+			}
+			break;
+		}
+		//end of file
+		if (!res) break;
+		count += (u32) res;
+		if (written) *written = count;
+	}
+	pthread_sigmask(SIG_SETMASK, &old_mask, NULL);
+	GF_LOG(GF_LOG_DEBUG, GF_LOG_NETWORK, ("[socket] sent %u bytes from file\n", count));
+	return e;
+#else
+	if (written) *written = 0;
+	return GF_NOT_SUPPORTED;
+#endif
+}
+
 GF_Err gf_sk_select(GF_Socket *sock, GF_SockSelectMode mode)
 {
 	//the socket must be bound or connected
@@ -3593,13 +3685,23 @@ struct __tag_sock_group
 	GF_POLLFD *fds;
 #endif
 
+#ifdef GPAC_HAS_EPOLL
+	//epoll instance, -1 if not used
+	int ep_fd;
+	//incremented at each wait, only sockets with the same generation are signaled
+	u32 ep_gen;
+	u32 alloc_ep_events;
+	struct epoll_event *ep_events;
+#endif
+
 #ifndef GPAC_DISABLE_NETCAP
 	u32 nb_nfs;
 	u32 nb_socks;
 #endif
 };
 
-GF_SockGroup *gf_sk_group_new()
+GF_EXPORT
+GF_SockGroup *gf_sk_group_new_ex(Bool use_epoll)
 {
 	GF_SockGroup *tmp;
 	GF_SAFEALLOC(tmp, GF_SockGroup);
@@ -3610,18 +3712,61 @@ GF_SockGroup *gf_sk_group_new()
 #ifdef GPAC_HAS_POLL
 	tmp->last_mask = POLLIN;
 #endif
+
+#ifdef GPAC_HAS_EPOLL
+	tmp->ep_fd = -1;
+	if (use_epoll) {
+		tmp->ep_fd = epoll_create1(EPOLL_CLOEXEC);
+		if (tmp->ep_fd<0) {
+			GF_LOG(GF_LOG_WARNING, GF_LOG_NETWORK, ("[socket] cannot create epoll instance: %s, using %s\n", gf_errno_str(LASTSOCKERROR), gpac_use_poll ? "poll" : "select"));
+		}
+	}
+#else
+	if (use_epoll) {
+		GF_LOG(GF_LOG_WARNING, GF_LOG_NETWORK, ("[socket] epoll not available on this platform, using %s\n", gpac_use_poll ? "poll" : "select"));
+	}
+#endif
 	return tmp;
 }
 
+GF_EXPORT
+GF_SockGroup *gf_sk_group_new()
+{
+	return gf_sk_group_new_ex(GF_FALSE);
+}
+
+GF_EXPORT
 void gf_sk_group_del(GF_SockGroup *sg)
 {
 	gf_list_del(sg->sockets);
 #ifdef GPAC_HAS_POLL
 	if (sg->fds) gf_free(sg->fds);
+#endif
+#ifdef GPAC_HAS_EPOLL
+	if (sg->ep_fd>=0) close(sg->ep_fd);
+	if (sg->ep_events) gf_free(sg->ep_events);
 #endif
 	gf_free(sg);
 }
 
+#ifdef GPAC_HAS_EPOLL
+static void sk_group_epoll_ctl(GF_SockGroup *sg, GF_Socket *sk, int op, u32 mask)
+{
+	struct epoll_event ev;
+	memset(&ev, 0, sizeof(struct epoll_event));
+	ev.events = mask;
+	ev.data.ptr = sk;
+	if (epoll_ctl(sg->ep_fd, op, sk->socket, &ev) < 0) {
+		//socket may already be closed when unregistering
+		if (op==EPOLL_CTL_DEL) return;
+		GF_LOG(GF_LOG_WARNING, GF_LOG_NETWORK, ("[socket] epoll_ctl failed: %s\n", gf_errno_str(LASTSOCKERROR) ));
+		return;
+	}
+	sk->ep_mask = mask;
+}
+#endif
+
+GF_EXPORT
 void gf_sk_group_register(GF_SockGroup *sg, GF_Socket *sk)
 {
 	if (!sg || !sk) return;
@@ -3639,6 +3784,14 @@ void gf_sk_group_register(GF_SockGroup *sg, GF_Socket *sk)
 	}
 #endif
 
+#ifdef GPAC_HAS_EPOLL
+	if (sg->ep_fd>=0) {
+		sk->ep_gen = sk->ep_events = 0;
+		sk_group_epoll_ctl(sg, sk, EPOLL_CTL_ADD, EPOLLIN);
+		return;
+	}
+#endif
+
 #ifdef GPAC_HAS_POLL
 	if (!sg->fds && !gpac_use_poll)
 		return;
@@ -3656,6 +3809,7 @@ void gf_sk_group_register(GF_SockGroup *sg, GF_Socket *sk)
 #endif
 }
 
+GF_EXPORT
 void gf_sk_group_unregister(GF_SockGroup *sg, GF_Socket *sk)
 {
 	if (!sg || !sk) return;
@@ -3678,6 +3832,13 @@ void gf_sk_group_unregister(GF_SockGroup *sg, GF_Socket *sk)
 	}
 #endif
 
+#ifdef GPAC_HAS_EPOLL
+	if ((sg->ep_fd>=0) && (pidx>=0)) {
+		sk_group_epoll_ctl(sg, sk, EPOLL_CTL_DEL, 0);
+		sk->ep_gen = 0;
+	}
+#endif
+
 	if (!gf_list_count(sg->sockets)) {
 		gf_list_del(sg->sockets);
 		sg->sockets = NULL;
@@ -3708,6 +3869,7 @@ void gf_sk_group_unregister(GF_SockGroup *sg, GF_Socket *sk)
 #endif
 }
 
+GF_EXPORT
 GF_Err gf_sk_group_select(GF_SockGroup *sg, u32 usec_wait, GF_SockSelectMode mode)
 {
 	s32 ready;
@@ -3758,6 +3920,44 @@ GF_Err gf_sk_group_select(GF_SockGroup *sg, u32 usec_wait, GF_SockSelectMode mod
 	}
 #endif
 
+#ifdef GPAC_HAS_EPOLL
+	//events of interest are set per socket, only ready sockets are reported
+	if (sg->ep_fd>=0) {
+		s32 res;
+		u32 count = gf_list_count(sg->sockets);
+		if (count > sg->alloc_ep_events) {
+			sg->alloc_ep_events = count;
+			sg->ep_events = gf_realloc(sg->ep_events, sizeof(struct epoll_event) * count);
+			if (!sg->ep_events) {
+				sg->alloc_ep_events = 0;
+				return GF_OUT_OF_MEM;
+			}
+		}
+		sg->ep_gen++;
+		if (!sg->ep_gen) sg->ep_gen = 1;
+		res = epoll_wait(sg->ep_fd, sg->ep_events, sg->alloc_ep_events, usec_wait/1000);
+		if (res<0) {
+			switch (LASTSOCKERROR) {
+			case EAGAIN:
+			case EINTR:
+				return GF_IP_NETWORK_EMPTY;
+			default:
+				GF_LOG(GF_LOG_WARNING, GF_LOG_NETWORK, ("[socket] cannot wait on epoll: %s\n", gf_errno_str(LASTSOCKERROR) ));
+				return GF_IP_NETWORK_FAILURE;
+			}
+		}
+		if (!res)
+			return GF_IP_NETWORK_EMPTY;
+
+		for (i=0; i<(u32) res; i++) {
+			sock = sg->ep_events[i].data.ptr;
+			sock->ep_events = sg->ep_events[i].events;
+			sock->ep_gen = sg->ep_gen;
+		}
+		return GF_OK;
+	}
+#endif
+
 #ifdef GPAC_HAS_POLL
 	if (sg->fds) {
 		u32 mask = 0;
@@ -3841,6 +4041,7 @@ GF_Err gf_sk_group_select(GF_SockGroup *sg, u32 usec_wait, GF_SockSelectMode mod
 	return GF_OK;
 }
 
+GF_EXPORT
 Bool gf_sk_group_sock_is_set(GF_SockGroup *sg, GF_Socket *sk, GF_SockSelectMode mode)
 {
 	if (!sg || !sk) return GF_FALSE;
@@ -3858,6 +4059,21 @@ Bool gf_sk_group_sock_is_set(GF_SockGroup *sg, GF_Socket *sk, GF_SockSelectMode
 	}
 #endif
 
+#ifdef GPAC_HAS_EPOLL
+	if (sg->ep_fd>=0) {
+		if (sk->ep_gen != sg->ep_gen)
+			return GF_FALSE;
+		//disconnected or error, consider ready to read/write
+		if (sk->ep_events & (EPOLLHUP|EPOLLERR))
+			return GF_TRUE;
+		if ((mode!=GF_SK_SELECT_WRITE) && (sk->ep_events & EPOLLIN))
+			return GF_TRUE;
+		if ((mode!=GF_SK_SELECT_READ) && (sk->ep_events & EPOLLOUT))
+			return GF_TRUE;
+		return GF_FALSE;
+	}
+#endif
+
 #ifdef GPAC_HAS_POLL
 	if (sg->fds && sk->poll_idx) {
 		GF_POLLFD *pfd = &sg->fds[sk->poll_idx-1];
@@ -3885,6 +4101,25 @@ Bool gf_sk_group_sock_is_set(GF_SockGroup *sg, GF_Socket *sk, GF_SockSelectMode
 	return GF_FALSE;
 }
 
+GF_EXPORT
+void gf_sk_group_sock_set_mode(GF_SockGroup *sg, GF_Socket *sk, GF_SockSelectMode mode)
+{
+	if (!sg || !sk) return;
+#ifdef GPAC_HAS_EPOLL
+	if (sg->ep_fd>=0) {
+		u32 mask;
+#ifndef GPAC_DISABLE_NETCAP
+		if (sk->cap_info) return;
+#endif
+		if (mode == GF_SK_SELECT_BOTH) mask = EPOLLIN | EPOLLOUT;
+		else if (mode == GF_SK_SELECT_READ) mask = EPOLLIN;
+		else mask = EPOLLOUT;
+		if (sk->ep_mask != mask)
+			sk_group_epoll_ctl(sg, sk, EPOLL_CTL_MOD, mask);
+	}
+#endif
+}
+
 //fetch nb bytes on a socket and fill the buffer from startFrom
 //length is the allocated size of the receiving buffer
 //BytesRead is the number of bytes read from the network
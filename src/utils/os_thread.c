@@ -23,6 +23,11 @@
  *
  */
 
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+//for pthread_setaffinity_np
+#define _GNU_SOURCE
+#endif
+
 #ifdef GPAC_CONFIG_ANDROID
 #include <jni.h>
 #endif
@@ -481,6 +486,99 @@ void gf_th_set_priority(GF_Thread *t, s32 priority)
 #endif
 }
 
+GF_EXPORT
+GF_Err gf_th_set_affinity(GF_Thread *t, const u32 *cores, u32 nb_cores)
+{
+	u32 i;
+	if (!cores || !nb_cores) return GF_BAD_PARAM;
+
+#if defined(WIN32) && !defined(_WIN32_WCE)
+	DWORD_PTR mask = 0;
+	for (i=0; i<nb_cores; i++) {
+		if (cores[i] < 8*sizeof(DWORD_PTR))
+			mask |= ((DWORD_PTR) 1) << cores[i];
+	}
+	if (!mask) return GF_BAD_PARAM;
+	if (!SetThreadAffinityMask(t ? t->threadH : GetCurrentThread(), mask)) {
+		GF_LOG(GF_LOG_WARNING, GF_LOG_MUTEX, ("[Thread %s] Couldn't set CPU affinity, error %d\n", t ? t->log_name : "main", GetLastError()));
+		return GF_IO_ERR;
+	}
+	return GF_OK;
+#elif defined(GPAC_CONFIG_LINUX) && !defined(GPAC_CONFIG_ANDROID)
+	cpu_set_t cpu_set;
+	CPU_ZERO(&cpu_set);
+	for (i=0; i<nb_cores; i++) {
+		if (cores[i] < CPU_SETSIZE)
+			CPU_SET(cores[i], &cpu_set);
+	}
+	if (!CPU_COUNT(&cpu_set)) return GF_BAD_PARAM;
+	if (pthread_setaffinity_np(t ? t->threadH : pthread_self(), sizeof(cpu_set_t), &cpu_set)) {
+		GF_LOG(GF_LOG_WARNING, GF_LOG_MUTEX, ("[Thread %s] Couldn't set CPU affinity\n", t ? t->log_name : "main"));
+		return GF_IO_ERR;
+	}
+	return GF_OK;
+#else
+	return GF_NOT_SUPPORTED;
+#endif
+}
+
+GF_EXPORT
+GF_Err gf_th_get_affinity(GF_Thread *t, u32 *cores, u32 *nb_cores)
+{
+	u32 i, max_cores;
+	if (!cores || !nb_cores || !*nb_cores) return GF_BAD_PARAM;
+	max_cores = *nb_cores;
+	*nb_cores = 0;
+
+#if defined(WIN32) && !defined(_WIN32_WCE)
+	//no per-thread getter, threads inherit the process affinity
+	DWORD_PTR mask, sys_mask;
+	if (!GetProcessAffinityMask(GetCurrentProcess(), &mask, &sys_mask))
+		return GF_IO_ERR;
+	for (i=0; (i<8*sizeof(DWORD_PTR)) && (*nb_cores<max_cores); i++) {
+		if (mask & (((DWORD_PTR) 1) << i))
+			cores[(*nb_cores)++] = i;
+	}
+	return GF_OK;
+#elif defined(GPAC_CONFIG_LINUX) && !defined(GPAC_CONFIG_ANDROID)
+	cpu_set_t cpu_set;
+	CPU_ZERO(&cpu_set);
+	if (pthread_getaffinity_np(t ? t->threadH : pthread_self(), sizeof(cpu_set_t), &cpu_set))
+		return GF_IO_ERR;
+	for (i=0; (i<CPU_SETSIZE) && (*nb_cores<max_cores); i++) {
+		if (CPU_ISSET(i, &cpu_set))
+			cores[(*nb_cores)++] = i;
+	}
+	return GF_OK;
+#else
+	return GF_NOT_SUPPORTED;
+#endif
+}
+
+GF_EXPORT
+s32 gf_th_get_core_numa_node(u32 core)
+{
+#if defined(WIN32) && !defined(_WIN32_WCE)
+	UCHAR node;
+	if ((core<256) && GetNumaProcessorNode((UCHAR) core, &node) && (node != 0xFF))
+		return node;
+	return -1;
+#elif defined(GPAC_CONFIG_LINUX) && !defined(GPAC_CONFIG_ANDROID)
+	u32 i;
+	char szPath[100];
+	sprintf(szPath, "/sys/devices/system/cpu/cpu%u", core);
+	if (!gf_dir_exists(szPath)) return -1;
+	//each cpu directory contains a nodeN link to its NUMA node
+	for (i=0; i<1024; i++) {
+		sprintf(szPath, "/sys/devices/system/cpu/cpu%u/node%u", core, i);
+		if (gf_dir_exists(szPath)) return (s32) i;
+	}
+	return -1;
+#else
+	return -1;
+#endif
+}
+
 GF_EXPORT
 u32 gf_th_status(GF_Thread *t)
 {
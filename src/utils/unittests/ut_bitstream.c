@@ -0,0 +1,176 @@
+#include "tests.h"
+#include <gpac/bitstream.h>
+
+u8 gf_bs_read_bit(GF_BitStream *bs);
+
+#define BS_TEST_SIZE	4096
+#define BS_BENCH_CODES	200000
+
+static u32 bs_test_rand(u32 *seed)
+{
+	*seed = (*seed) * 1103515245 + 12345;
+	return (*seed >> 8) & 0xFFFFFF;
+}
+
+//bit-by-bit readers, used as reference for the memory fast path
+static u32 bs_ref_read_int(GF_BitStream *bs, u32 nBits)
+{
+	u32 ret = 0;
+	while (nBits--) {
+		ret <<= 1;
+		ret |= gf_bs_read_bit(bs);
+	}
+	return ret;
+}
+
+static u32 bs_ref_read_ue(GF_BitStream *bs)
+{
+	u32 nb_lead = 0;
+	while (!gf_bs_read_bit(bs)) {
+		nb_lead++;
+		if (nb_lead>=32) return 0;
+	}
+	if (!nb_lead) return 0;
+	return bs_ref_read_int(bs, nb_lead) + (1<<nb_lead) - 1;
+}
+
+static void bs_test_write_ue(GF_BitStream *bs, u32 num)
+{
+	u32 length = 1, temp = ++num;
+	while (temp != 1) {
+		temp >>= 1;
+		length += 2;
+	}
+	gf_bs_write_int(bs, 0, length >> 1);
+	gf_bs_write_int(bs, num, (length + 1) >> 1);
+}
+
+//same as gf_bs_read_ue without logging
+static u32 bs_test_read_ue(GF_BitStream *bs)
+{
+	u32 val, nb_bits;
+	if (gf_bs_read_ue_fast(bs, &val, &nb_bits))
+		return val;
+	return bs_ref_read_ue(bs);
+}
+
+static void bs_test_read_int(Bool emul_prev)
+{
+	u32 i, seed = 1;
+	u8 buf[BS_TEST_SIZE];
+	GF_BitStream *bs, *ref;
+
+	for (i=0; i<BS_TEST_SIZE; i++) {
+		buf[i] = (u8) bs_test_rand(&seed);
+		//inject start code emulation patterns
+		if (emul_prev && (i%37 == 2)) {
+			buf[i-2] = buf[i-1] = 0;
+			buf[i] = 3;
+		}
+	}
+	bs = gf_bs_new(buf, BS_TEST_SIZE, GF_BITSTREAM_READ);
+	ref = gf_bs_new(buf, BS_TEST_SIZE, GF_BITSTREAM_READ);
+	gf_bs_enable_emulation_byte_removal(bs, emul_prev);
+	gf_bs_enable_emulation_byte_removal(ref, emul_prev);
+
+	while (gf_bs_available(ref) > 8) {
+		u32 nb_bits = 1 + bs_test_rand(&seed) % 32;
+		u32 v = gf_bs_read_int(bs, nb_bits);
+		u32 r = bs_ref_read_int(ref, nb_bits);
+		if (v != r) break;
+		if (gf_bs_get_position(bs) != gf_bs_get_position(ref)) break;
+		if (gf_bs_get_bit_offset(bs) != gf_bs_get_bit_offset(ref)) break;
+	}
+	assert_true(gf_bs_available(ref) <= 8);
+	assert_equal(gf_bs_get_emulation_byte_removed(bs), gf_bs_get_emulation_byte_removed(ref));
+	//byte-aligned reads after fast path must see the same state
+	gf_bs_align(bs);
+	gf_bs_align(ref);
+	assert_equal(gf_bs_read_u8(bs), gf_bs_read_u8(ref));
+
+	gf_bs_del(bs);
+	gf_bs_del(ref);
+}
+
+unittest(bs_read_int_fast)
+{
+	bs_test_read_int(GF_FALSE);
+	bs_test_read_int(GF_TRUE);
+}
+
+static u8 *bs_test_ue_buffer(u32 nb_codes, u32 *size, u32 **vals)
+{
+	u32 i, seed = 7;
+	u8 *data;
+	GF_BitStream *bs = gf_bs_new(NULL, 0, GF_BITSTREAM_WRITE);
+	*vals = gf_malloc(sizeof(u32)*nb_codes);
+	for (i=0; i<nb_codes; i++) {
+		u32 v = bs_test_rand(&seed);
+		//mostly small values, as found in parameter sets and slice headers
+		switch (i%4) {
+		case 0: v &= 0x3; break;
+		case 1: v &= 0xF; break;
+		case 2: v &= 0xFF; break;
+		default: break;
+		}
+		(*vals)[i] = v;
+		bs_test_write_ue(bs, v);
+		//interleave with fixed-length fields
+		if (i%5==0) gf_bs_write_int(bs, i, 3);
+	}
+	gf_bs_align(bs);
+	gf_bs_get_content(bs, &data, size);
+	gf_bs_del(bs);
+	return data;
+}
+
+unittest(bs_read_ue_fast)
+{
+	u32 i, size, *vals;
+	u8 *data = bs_test_ue_buffer(10000, &size, &vals);
+	GF_BitStream *bs = gf_bs_new(data, size, GF_BITSTREAM_READ);
+	for (i=0; i<10000; i++) {
+		if (bs_test_read_ue(bs) != vals[i]) break;
+		if ((i%5==0) && (gf_bs_read_int(bs, 3) != (i&7))) break;
+	}
+	assert_equal(i, 10000);
+	assert_equal(gf_bs_available(bs), 0);
+	gf_bs_del(bs);
+	gf_free(data);
+	gf_free(vals);
+}
+
+//not a pass/fail test: compares the fast path with the bit-by-bit reader
+unittest(bs_read_ue_bench)
+{
+	u32 i, size, *vals;
+	u64 now, fast_time, ref_time, sum_fast=0, sum_ref=0;
+	u8 *data;
+	GF_BitStream *bs;
+
+	if (!ut_bench_enabled()) return;
+
+	data = bs_test_ue_buffer(BS_BENCH_CODES, &size, &vals);
+	bs = gf_bs_new(data, size, GF_BITSTREAM_READ);
+
+	now = gf_sys_clock_high_res();
+	for (i=0; i<BS_BENCH_CODES; i++) {
+		sum_fast += bs_test_read_ue(bs);
+		if (i%5==0) gf_bs_read_int(bs, 3);
+	}
+	fast_time = gf_sys_clock_high_res() - now;
+
+	gf_bs_seek(bs, 0);
+	now = gf_sys_clock_high_res();
+	for (i=0; i<BS_BENCH_CODES; i++) {
+		sum_ref += bs_ref_read_ue(bs);
+		if (i%5==0) bs_ref_read_int(bs, 3);
+	}
+	ref_time = gf_sys_clock_high_res() - now;
+
+	assert_equal(sum_fast, sum_ref);
+	printf("(%u codes: fast "LLU" us, bitwise "LLU" us) ", BS_BENCH_CODES, fast_time, ref_time);
+	gf_bs_del(bs);
+	gf_free(data);
+	gf_free(vals);
+}
@@ -0,0 +1,164 @@
+#include "tests.h"
+#include <gpac/download.h>
+#include <gpac/network.h>
+#include <gpac/thread.h>
+
+#define DM_TEST_PORT	25500
+#define DM_TEST_REQS	10
+#define DM_TEST_BODY	1000
+
+typedef struct
+{
+	GF_Socket *server;
+	u16 port;
+	Bool run;
+	//close connection after each reply, without notifying the client
+	Bool close_idle;
+	u32 nb_accepts, nb_reqs;
+} DMTestServer;
+
+typedef struct
+{
+	u32 nb_bytes;
+	Bool done;
+} DMTestClient;
+
+//minimal HTTP/1.1 server answering any request with a fixed size body
+static u32 dm_test_server_run(void *par)
+{
+	u32 i, nb_conns=0;
+	char reply[100+DM_TEST_BODY], buf[2000];
+	GF_Socket *conns[DM_TEST_REQS];
+	DMTestServer *srv = par;
+	u32 hdr_len = sprintf(reply, "HTTP/1.1 200 OK\r\nContent-Type: application/octet-stream\r\nContent-Length: %d\r\n\r\n", DM_TEST_BODY);
+	memset(reply+hdr_len, 'x', DM_TEST_BODY);
+
+	while (srv->run) {
+		GF_Socket *conn = NULL;
+		if ((nb_conns<DM_TEST_REQS) && (gf_sk_accept(srv->server, &conn) == GF_OK) && conn) {
+			gf_sk_set_block_mode(conn, GF_TRUE);
+			conns[nb_conns++] = conn;
+			srv->nb_accepts++;
+		}
+		for (i=0; i<nb_conns; i++) {
+			u32 read = 0;
+			if (!conns[i]) continue;
+			GF_Err e = gf_sk_receive_no_select(conns[i], buf, sizeof(buf)-1, &read);
+			if (e == GF_IP_CONNECTION_CLOSED) {
+				gf_sk_del(conns[i]);
+				conns[i] = NULL;
+				continue;
+			}
+			if (!read) continue;
+			buf[read] = 0;
+			if (!strstr(buf, "\r\n\r\n")) continue;
+			srv->nb_reqs++;
+			gf_sk_send(conns[i], reply, hdr_len + DM_TEST_BODY);
+			if (srv->close_idle) {
+				gf_sk_del(conns[i]);
+				conns[i] = NULL;
+			}
+		}
+		gf_sleep(1);
+	}
+	for (i=0; i<nb_conns; i++) {
+		if (conns[i]) gf_sk_del(conns[i]);
+	}
+	return 0;
+}
+
+static Bool dm_test_server_start(DMTestServer *srv, Bool close_idle)
+{
+	memset(srv, 0, sizeof(DMTestServer));
+	srv->close_idle = close_idle;
+	//binding needs an explicit port, look for a free one
+	for (srv->port=DM_TEST_PORT; srv->port<DM_TEST_PORT+100; srv->port++) {
+		srv->server = gf_sk_new(GF_SOCK_TYPE_TCP);
+		if (!srv->server) return GF_FALSE;
+		if (!gf_sk_bind(srv->server, "127.0.0.1", srv->port, NULL, 0, 0) && !gf_sk_listen(srv->server, DM_TEST_REQS))
+			break;
+		gf_sk_del(srv->server);
+		srv->server = NULL;
+	}
+	if (!srv->server) return GF_FALSE;
+	gf_sk_set_block_mode(srv->server, GF_TRUE);
+	srv->run = GF_TRUE;
+	return GF_TRUE;
+}
+
+static void dm_test_io(void *usr_cbk, GF_NETIO_Parameter *par)
+{
+	DMTestClient *cl = usr_cbk;
+	if (par->msg_type == GF_NETIO_DATA_EXCHANGE) cl->nb_bytes += par->size;
+	else if (par->msg_type == GF_NETIO_DATA_TRANSFERED) cl->done = GF_TRUE;
+}
+
+//fetches DM_TEST_REQS resources, one session at a time, returns the number of failed downloads
+static u32 dm_test_fetch(GF_DownloadManager *dm, u16 port)
+{
+	u32 i, nb_fail=0;
+	char url[100];
+	for (i=0; i<DM_TEST_REQS; i++) {
+		GF_Err e;
+		DMTestClient cl;
+		GF_DownloadSession *sess;
+		memset(&cl, 0, sizeof(DMTestClient));
+		sprintf(url, "http://127.0.0.1:%d/res%d", port, i);
+		sess = gf_dm_sess_new(dm, url, GF_NETIO_SESSION_NOT_THREADED|GF_NETIO_SESSION_NOT_CACHED|GF_NETIO_SESSION_PERSISTENT, dm_test_io, &cl, &e);
+		if (!sess) {
+			nb_fail++;
+			continue;
+		}
+		e = gf_dm_sess_process(sess);
+		if (e || !cl.done || (cl.nb_bytes != DM_TEST_BODY)) nb_fail++;
+		gf_dm_sess_del(sess);
+		//let the server process the close, if any
+		gf_sleep(5);
+	}
+	return nb_fail;
+}
+
+static u32 dm_test_run(Bool close_idle, u32 *nb_accepts, u32 *nb_connects, u32 *nb_reused, u32 *nb_evicted)
+{
+	u32 nb_fail;
+	DMTestServer srv;
+	GF_Thread *th;
+	GF_DownloadManager *dm;
+	if (!dm_test_server_start(&srv, close_idle)) return DM_TEST_REQS;
+	th = gf_th_new("dm_test_server");
+	gf_th_run(th, dm_test_server_run, &srv);
+
+	dm = gf_dm_new(NULL);
+	nb_fail = dm_test_fetch(dm, srv.port);
+	gf_dm_get_connection_stats(dm, nb_connects, nb_reused, NULL, nb_evicted, NULL);
+	gf_dm_del(dm);
+
+	srv.run = GF_FALSE;
+	gf_th_stop(th);
+	gf_th_del(th);
+	gf_sk_del(srv.server);
+	*nb_accepts = srv.nb_accepts;
+	return nb_fail;
+}
+
+//sequential sessions to the same server must share a single connection
+unittest(dm_pool_reuse)
+{
+	u32 nb_accepts, nb_connects, nb_reused, nb_evicted;
+	assert_equal(dm_test_run(GF_FALSE, &nb_accepts, &nb_connects, &nb_reused, &nb_evicted), 0);
+	assert_equal(nb_accepts, 1);
+	assert_equal(nb_connects, 1);
+	assert_equal(nb_reused, DM_TEST_REQS-1);
+	assert_equal(nb_evicted, 0);
+}
+
+//idle connections closed by the server must be detected and replaced
+unittest(dm_pool_remote_close)
+{
+	u32 nb_accepts, nb_connects, nb_reused, nb_evicted;
+	assert_equal(dm_test_run(GF_TRUE, &nb_accepts, &nb_connects, &nb_reused, &nb_evicted), 0);
+	assert_equal(nb_accepts, DM_TEST_REQS);
+	assert_equal(nb_connects, DM_TEST_REQS);
+	assert_equal(nb_reused, 0);
+	assert_equal(nb_evicted, DM_TEST_REQS-1);
+}
@@ -0,0 +1,267 @@
+#include "tests.h"
+#include <gpac/network.h>
+#ifndef WIN32
+#include <sys/resource.h>
+#endif
+
+//each client uses two descriptors, client and server side
+#define SKG_TEST_CLIENTS	50
+#define SKG_BENCH_CLIENTS	500
+#define SKG_TEST_ACTIVE	10
+#define SKG_TEST_PORT	25400
+
+typedef struct
+{
+	u32 nb_clients;
+	GF_Socket *server;
+	GF_Socket **clients;
+	GF_Socket **conns;
+} SKGTestNet;
+
+//number of clients that can be opened without exceeding the descriptor limit
+static u32 skg_test_max_clients(u32 nb_clients)
+{
+#ifndef WIN32
+	struct rlimit rl;
+	if (!getrlimit(RLIMIT_NOFILE, &rl) && (rl.rlim_cur != RLIM_INFINITY)) {
+		//keep some descriptors for the test runner
+		u32 max_clients = (rl.rlim_cur > 64) ? (u32) (rl.rlim_cur - 64) / 2 : 0;
+		if (nb_clients > max_clients) nb_clients = max_clients;
+	}
+#endif
+	return nb_clients;
+}
+
+//connects all clients on loopback, conns[i] is the server side of clients[i]
+static Bool skg_test_connect(SKGTestNet *net, u32 nb_clients)
+{
+	u32 i, j;
+	u16 port;
+	memset(net, 0, sizeof(SKGTestNet));
+	net->clients = gf_malloc(sizeof(GF_Socket *) * nb_clients);
+	net->conns = gf_malloc(sizeof(GF_Socket *) * nb_clients);
+	if (!net->clients || !net->conns) return GF_FALSE;
+	memset(net->clients, 0, sizeof(GF_Socket *) * nb_clients);
+	memset(net->conns, 0, sizeof(GF_Socket *) * nb_clients);
+	net->nb_clients = nb_clients;
+	//binding needs an explicit port, look for a free one
+	for (port=SKG_TEST_PORT; port<SKG_TEST_PORT+100; port++) {
+		net->server = gf_sk_new(GF_SOCK_TYPE_TCP);
+		if (!net->server) return GF_FALSE;
+		if (!gf_sk_bind(net->server, "127.0.0.1", port, NULL, 0, 0) && !gf_sk_listen(net->server, nb_clients))
+			break;
+		gf_sk_del(net->server);
+		net->server = NULL;
+	}
+	if (!net->server) return GF_FALSE;
+
+	for (i=0; i<nb_clients; i++) {
+		net->clients[i] = gf_sk_new(GF_SOCK_TYPE_TCP);
+		if (!net->clients[i]) return GF_FALSE;
+		if (gf_sk_connect(net->clients[i], "127.0.0.1", port, NULL)) return GF_FALSE;
+		for (j=0; j<1000; j++) {
+			if (gf_sk_accept(net->server, &net->conns[i]) == GF_OK) break;
+			gf_sleep(1);
+		}
+		if (!net->conns[i]) return GF_FALSE;
+		gf_sk_set_block_mode(net->conns[i], GF_TRUE);
+	}
+	return GF_TRUE;
+}
+
+static void skg_test_close(SKGTestNet *net)
+{
+	u32 i;
+	for (i=0; i<net->nb_clients; i++) {
+		if (net->clients[i]) gf_sk_del(net->clients[i]);
+		if (net->conns[i]) gf_sk_del(net->conns[i]);
+	}
+	if (net->server) gf_sk_del(net->server);
+	if (net->clients) gf_free(net->clients);
+	if (net->conns) gf_free(net->conns);
+}
+
+//a few clients send a request, only their connections must be signaled
+static u32 skg_test_round(SKGTestNet *net, GF_SockGroup *sg, u32 round)
+{
+	u32 i, nb_fail=0;
+	u8 buf[100];
+	u32 active[SKG_TEST_ACTIVE];
+	for (i=0; i<SKG_TEST_ACTIVE; i++) {
+		active[i] = (round*SKG_TEST_ACTIVE + i*37) % net->nb_clients;
+		gf_sk_send(net->clients[active[i]], "GET / HTTP/1.1\r\n\r\n", 18);
+	}
+	for (i=0; i<100; i++) {
+		if (gf_sk_group_select(sg, 1000, GF_SK_SELECT_READ) != GF_OK) continue;
+		if (gf_sk_group_sock_is_set(sg, net->conns[active[SKG_TEST_ACTIVE-1]], GF_SK_SELECT_READ)) break;
+	}
+	for (i=0; i<net->nb_clients; i++) {
+		u32 j;
+		Bool expected = GF_FALSE;
+		for (j=0; j<SKG_TEST_ACTIVE; j++) {
+			if (active[j]==i) expected = GF_TRUE;
+		}
+		if (gf_sk_group_sock_is_set(sg, net->conns[i], GF_SK_SELECT_READ) != expected) nb_fail++;
+	}
+	for (i=0; i<SKG_TEST_ACTIVE; i++) {
+		u32 read = 0;
+		gf_sk_receive_no_select(net->conns[active[i]], buf, 100, &read);
+		if (read != 18) nb_fail++;
+	}
+	return nb_fail;
+}
+
+static u32 skg_test_run(Bool use_epoll, u32 nb_clients, u32 nb_rounds, u64 *duration)
+{
+	u32 i, nb_fail=0;
+	u64 now;
+	SKGTestNet net;
+	GF_SockGroup *sg = gf_sk_group_new_ex(use_epoll);
+	if (!skg_test_connect(&net, nb_clients)) {
+		skg_test_close(&net);
+		gf_sk_group_del(sg);
+		return 1;
+	}
+	for (i=0; i<nb_clients; i++)
+		gf_sk_group_register(sg, net.conns[i]);
+
+	now = gf_sys_clock_high_res();
+	for (i=0; i<nb_rounds; i++)
+		nb_fail += skg_test_round(&net, sg, i);
+	if (duration) *duration = gf_sys_clock_high_res() - now;
+
+	//write interest, all connections are writable
+	for (i=0; i<nb_clients; i++)
+		gf_sk_group_sock_set_mode(sg, net.conns[i], GF_SK_SELECT_WRITE);
+	if (gf_sk_group_select(sg, 1000, GF_SK_SELECT_WRITE) != GF_OK) nb_fail++;
+	if (!gf_sk_group_sock_is_set(sg, net.conns[nb_clients/2], GF_SK_SELECT_WRITE)) nb_fail++;
+
+	for (i=0; i<nb_clients; i++)
+		gf_sk_group_unregister(sg, net.conns[i]);
+	gf_sk_group_del(sg);
+	skg_test_close(&net);
+	return nb_fail;
+}
+
+unittest(sk_group_ready)
+{
+	u32 nb_clients = skg_test_max_clients(SKG_TEST_CLIENTS);
+	assert_true(nb_clients >= SKG_TEST_ACTIVE);
+	if (nb_clients < SKG_TEST_ACTIVE) return;
+	assert_equal(skg_test_run(GF_FALSE, nb_clients, 20, NULL), 0);
+	assert_equal(skg_test_run(GF_TRUE, nb_clients, 20, NULL), 0);
+}
+
+//not a pass/fail test: few active connections among many idle ones on loopback
+unittest(sk_group_load)
+{
+	u32 nb_clients;
+	u64 t_poll=0, t_epoll=0;
+
+	if (!ut_bench_enabled()) return;
+
+	nb_clients = skg_test_max_clients(SKG_BENCH_CLIENTS);
+	if (nb_clients < SKG_TEST_ACTIVE) return;
+	skg_test_run(GF_FALSE, nb_clients, 500, &t_poll);
+	skg_test_run(GF_TRUE, nb_clients, 500, &t_epoll);
+	printf("(%d connections, %d active: poll "LLU" us/round, epoll "LLU" us/round) ", nb_clients, SKG_TEST_ACTIVE, t_poll/500, t_epoll/500);
+}
+
+#define SKF_TEST_FILE	"ut_sk_send_file.bin"
+#define SKF_TEST_SIZE	100000
+
+//reads size bytes on the client side and compares them with the expected data
+static Bool skf_test_recv(GF_Socket *sk, const u8 *expected, u32 size)
+{
+	u32 i, got=0;
+	Bool ok;
+	u8 *buf = gf_malloc(size);
+	if (!buf) return GF_FALSE;
+	for (i=0; (i<1000) && (got<size); i++) {
+		u32 read = 0;
+		gf_sk_receive(sk, buf+got, size-got, &read);
+		got += read;
+	}
+	ok = ((got==size) && !memcmp(buf, expected, size)) ? GF_TRUE : GF_FALSE;
+	gf_free(buf);
+	return ok;
+}
+
+//file IO wrapper with no data, only used to get a FILE object without descriptor
+static GF_FileIO *skf_test_gfio_open(GF_FileIO *fileio_ref, const char *url, const char *mode, GF_Err *out_error)
+{
+	*out_error = GF_OK;
+	if (!strcmp(mode, "close") || !strcmp(mode, "unref") || !strcmp(mode, "ref")) return NULL;
+	return fileio_ref;
+}
+static GF_Err skf_test_gfio_seek(GF_FileIO *fileio, u64 offset, s32 whence) { return GF_OK; }
+static u32 skf_test_gfio_read(GF_FileIO *fileio, u8 *buffer, u32 bytes) { return 0; }
+static s64 skf_test_gfio_tell(GF_FileIO *fileio) { return 0; }
+static Bool skf_test_gfio_eof(GF_FileIO *fileio) { return GF_TRUE; }
+
+//ranged zero-copy sends must not touch the file position, other files and sockets must be rejected
+unittest(sk_send_file)
+{
+	u32 i, written;
+	GF_Err e;
+	FILE *f, *mem_f;
+	GF_FileIO *gfio;
+	GF_Socket *udp;
+	SKGTestNet net;
+	u8 *data = gf_malloc(SKF_TEST_SIZE);
+	assert_not_null(data);
+	if (!data) return;
+	for (i=0; i<SKF_TEST_SIZE; i++) data[i] = (u8) (i*13 + (i>>8));
+	f = gf_fopen(SKF_TEST_FILE, "wb");
+	assert_not_null(f);
+	if (!f) {
+		gf_free(data);
+		return;
+	}
+	gf_fwrite(data, SKF_TEST_SIZE, f);
+	gf_fclose(f);
+
+	f = gf_fopen(SKF_TEST_FILE, "rb");
+	assert_true(skg_test_connect(&net, 1));
+	if (f && net.conns && net.conns[0]) {
+		gf_fseek(f, 10, SEEK_SET);
+		e = gf_sk_send_file(net.conns[0], f, 1000, 20000, &written);
+		//no zero-copy send on this platform, nothing more to check
+		if (e != GF_NOT_SUPPORTED) {
+			assert_equal(e, GF_OK);
+			assert_equal(written, 20000);
+			assert_equal(gf_ftell(f), 10);
+			assert_true(skf_test_recv(net.clients[0], data+1000, 20000));
+
+			//range past the end of file: only the available bytes are sent
+			e = gf_sk_send_file(net.conns[0], f, SKF_TEST_SIZE-500, 2000, &written);
+			assert_equal(e, GF_OK);
+			assert_equal(written, 500);
+			assert_true(skf_test_recv(net.clients[0], data+SKF_TEST_SIZE-500, 500));
+		}
+
+		//file IO wrappers have no descriptor, callers must fall back to regular sends
+		gfio = gf_fileio_new(SKF_TEST_FILE, NULL, skf_test_gfio_open, skf_test_gfio_seek, skf_test_gfio_read, NULL, skf_test_gfio_tell, skf_test_gfio_eof, NULL);
+		mem_f = gfio ? gf_fopen(gf_fileio_url(gfio), "rb") : NULL;
+		assert_not_null(mem_f);
+		if (mem_f) {
+			written = 1;
+			assert_equal(gf_sk_send_file(net.conns[0], mem_f, 0, 1000, &written), GF_NOT_SUPPORTED);
+			assert_equal(written, 0);
+			gf_fclose(mem_f);
+		}
+		if (gfio) gf_fileio_del(gfio);
+
+		//no zero-copy on datagram sockets
+		udp = gf_sk_new(GF_SOCK_TYPE_UDP);
+		if (udp) {
+			if (!gf_sk_bind(udp, "127.0.0.1", 0, "127.0.0.1", SKG_TEST_PORT, 0))
+				assert_equal(gf_sk_send_file(udp, f, 0, 1000, &written), GF_NOT_SUPPORTED);
+			gf_sk_del(udp);
+		}
+	}
+	if (f) gf_fclose(f);
+	skg_test_close(&net);
+	gf_file_delete(SKF_TEST_FILE);
+	gf_free(data);
+}